@@ -87,4 +87,13 @@ int net_shutdown_main(void);
 #ifdef CONFIG_TC_NET_SELECT
 int net_select_main(void);
 #endif
+#ifdef CONFIG_TC_NET_ZEROCOPY
+int net_zerocopy_main(void);
+#endif
+#ifdef CONFIG_TC_NET_EPOLL
+int net_epoll_main(void);
+#endif
+#ifdef CONFIG_TC_NET_ETHARP
+int net_etharp_main(void);
+#endif
 #endif /* __EXAMPLES_TESTCASE_NETWORK_TC_INTERNAL_H */
@@ -0,0 +1,380 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+// @file tc_net_epoll.c
+// @brief Test Case Example for epoll_create(), epoll_ctl() and epoll_wait() API
+#include <tinyara/config.h>
+#include <errno.h>
+#include "tc_internal.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <semaphore.h>
+#include <arpa/inet.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <pthread.h>
+
+#define PORTNUM        1130
+#define EP_MAXSOCK     (CONFIG_NSOCKET_DESCRIPTORS - 2)
+#define EP_ROUNDS      200
+
+static int g_ep_sock[EP_MAXSOCK];
+static int g_ep_nsock;
+static int g_ep_rounds;
+static sem_t g_ep_go;
+
+/**
+   * @fn                   :ep_open
+   * @brief                :opens n UDP sockets bound to consecutive loopback ports
+   * @scenario             :
+   * API's covered         :socket,bind
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :int, the number of sockets opened
+   */
+static int ep_open(int n)
+{
+	struct sockaddr_in sa;
+	int i;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+	for (i = 0; i < n; i++) {
+		g_ep_sock[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (g_ep_sock[i] < 0) {
+			break;
+		}
+		sa.sin_port = htons(PORTNUM + i);
+		bind(g_ep_sock[i], (struct sockaddr *)&sa, sizeof(sa));
+	}
+
+	g_ep_nsock = i;
+	return i;
+}
+
+/**
+   * @fn                   :ep_close
+   * @brief                :closes the sockets opened by ep_open
+   * @scenario             :
+   * API's covered         :close
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :void
+   */
+static void ep_close(void)
+{
+	int i;
+
+	for (i = 0; i < g_ep_nsock; i++) {
+		close(g_ep_sock[i]);
+	}
+	g_ep_nsock = 0;
+}
+
+/**
+   * @fn                   :ep_sender
+   * @brief                :sends one datagram to the last socket per round
+   * @scenario             :
+   * API's covered         :socket,sendto,close
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :void *
+   */
+static void *ep_sender(void *args)
+{
+	struct sockaddr_in dest;
+	int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	int i;
+
+	memset(&dest, 0, sizeof(dest));
+	dest.sin_family = AF_INET;
+	dest.sin_addr.s_addr = inet_addr("127.0.0.1");
+	dest.sin_port = htons(PORTNUM + g_ep_nsock - 1);
+
+	for (i = 0; i < g_ep_rounds; i++) {
+		sem_wait(&g_ep_go);
+		sendto(sock, "e", 1, 0, (struct sockaddr *)&dest, sizeof(dest));
+	}
+
+	close(sock);
+	return NULL;
+}
+
+/**
+   * @fn                   :ep_elapsed_us
+   * @brief                :microseconds elapsed since start
+   * @scenario             :
+   * API's covered         :
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :unsigned int
+   */
+static unsigned int ep_elapsed_us(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000 + (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+/**
+   * @fn                   :ep_wakeups
+   * @brief                :measures the wakeup cost with nsock watched sockets, poll() or epoll_wait()
+   * @scenario             :the sender thread makes the last watched socket readable once per round
+   * API's covered         :poll,epoll_create,epoll_ctl,epoll_wait,recv
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :int, the number of wakeups that reported the right socket
+   */
+static int ep_wakeups(int nsock, int use_epoll)
+{
+	struct pollfd fds[EP_MAXSOCK];
+	struct epoll_event ev;
+	struct timespec start;
+	pthread_t sender;
+	unsigned int us;
+	char buf[4];
+	int hits = 0;
+	int epfd = -1;
+	int i;
+
+	if (ep_open(nsock) != nsock) {
+		ep_close();
+		return -1;
+	}
+
+	if (use_epoll) {
+		epfd = epoll_create(nsock);
+		for (i = 0; i < nsock; i++) {
+			ev.events = EPOLLIN;
+			ev.data.fd = g_ep_sock[i];
+			epoll_ctl(epfd, EPOLL_CTL_ADD, g_ep_sock[i], &ev);
+		}
+	}
+
+	g_ep_rounds = EP_ROUNDS;
+	sem_init(&g_ep_go, 0, 0);
+	pthread_create(&sender, NULL, ep_sender, NULL);
+
+	clock_gettime(CLOCK_REALTIME, &start);
+	for (i = 0; i < EP_ROUNDS; i++) {
+		sem_post(&g_ep_go);
+		if (use_epoll) {
+			if (epoll_wait(epfd, &ev, 1, 1000) == 1 && ev.data.fd == g_ep_sock[nsock - 1]) {
+				hits++;
+			}
+		} else {
+			int j;
+
+			/* poll() needs the whole set each time */
+			for (j = 0; j < nsock; j++) {
+				fds[j].fd = g_ep_sock[j];
+				fds[j].events = POLLIN;
+			}
+			if (poll(fds, nsock, 1000) == 1 && (fds[nsock - 1].revents & POLLIN)) {
+				hits++;
+			}
+		}
+		recv(g_ep_sock[nsock - 1], buf, sizeof(buf), 0);
+	}
+	us = ep_elapsed_us(&start);
+
+	pthread_join(sender, NULL);
+	sem_destroy(&g_ep_go);
+	if (epfd >= 0) {
+		close(epfd);
+	}
+	ep_close();
+
+	printf("\n[epoll] %s, %d sockets: %u us/wakeup\n", use_epoll ? "epoll_wait" : "poll", nsock, us / EP_ROUNDS);
+	return hits;
+}
+
+/**
+   * @testcase		   :tc_net_epoll_wait_p
+   * @brief		   :
+   * @scenario		   :wakeup cost with 1 and with all available sockets watched
+   * @apicovered	   :epoll_create(), epoll_ctl(), epoll_wait()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_epoll_wait_p(void)
+{
+	int nsock[] = { 1, (EP_MAXSOCK + 1) / 2, EP_MAXSOCK };
+	int i;
+
+	for (i = 0; i < sizeof(nsock) / sizeof(nsock[0]); i++) {
+		TC_ASSERT_EQ("poll", ep_wakeups(nsock[i], 0), EP_ROUNDS);
+		TC_ASSERT_EQ("epoll_wait", ep_wakeups(nsock[i], 1), EP_ROUNDS);
+	}
+	TC_SUCCESS_RESULT();
+}
+
+/**
+   * @testcase		   :tc_net_epoll_ctl_p
+   * @brief		   :
+   * @scenario		   :level-triggered, oneshot, modify and removal on close
+   * @apicovered	   :epoll_create1(), epoll_ctl(), epoll_wait()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_epoll_ctl_p(void)
+{
+	struct sockaddr_in dest;
+	struct epoll_event ev;
+	char buf[4];
+	int epfd;
+	int sock;
+
+	TC_ASSERT_EQ("ep_open", ep_open(1), 1);
+	sock = g_ep_sock[0];
+	epfd = epoll_create1(0);
+	TC_ASSERT_GEQ("epoll_create1", epfd, 0);
+
+	ev.events = EPOLLIN;
+	ev.data.u32 = 7;
+	TC_ASSERT_EQ("epoll_ctl", epoll_ctl(epfd, EPOLL_CTL_ADD, sock, &ev), 0);
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 0), 0);
+
+	memset(&dest, 0, sizeof(dest));
+	dest.sin_family = AF_INET;
+	dest.sin_addr.s_addr = inet_addr("127.0.0.1");
+	dest.sin_port = htons(PORTNUM);
+	sendto(sock, "e", 1, 0, (struct sockaddr *)&dest, sizeof(dest));
+
+	/* level-triggered: reported until the data is read */
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 1000), 1);
+	TC_ASSERT_EQ("epoll_wait", ev.data.u32, 7);
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 0), 1);
+	recv(sock, buf, sizeof(buf), 0);
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 0), 0);
+
+	/* oneshot: reported once until re-armed */
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	TC_ASSERT_EQ("epoll_ctl", epoll_ctl(epfd, EPOLL_CTL_MOD, sock, &ev), 0);
+	sendto(sock, "e", 1, 0, (struct sockaddr *)&dest, sizeof(dest));
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 1000), 1);
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 0), 0);
+	ev.events = EPOLLIN;
+	TC_ASSERT_EQ("epoll_ctl", epoll_ctl(epfd, EPOLL_CTL_MOD, sock, &ev), 0);
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 0), 1);
+	recv(sock, buf, sizeof(buf), 0);
+
+	/* closing the socket drops the registration */
+	ep_close();
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 0), 0);
+	TC_ASSERT_EQ("epoll_ctl", epoll_ctl(epfd, EPOLL_CTL_DEL, sock, NULL), -1);
+	TC_ASSERT_EQ("epoll_ctl", errno, ENOENT);
+
+	close(epfd);
+	TC_SUCCESS_RESULT();
+}
+
+/**
+   * @testcase		   :tc_net_epoll_wait_order_p
+   * @brief		   :
+   * @scenario		   :events left over when maxevents is reached are reported in their order
+   * @apicovered	   :epoll_create1(), epoll_ctl(), epoll_wait()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_epoll_wait_order_p(void)
+{
+	struct sockaddr_in dest;
+	struct epoll_event ev;
+	int epfd;
+	int i;
+
+	TC_ASSERT_EQ("ep_open", ep_open(4), 4);
+	epfd = epoll_create1(0);
+	TC_ASSERT_GEQ("epoll_create1", epfd, 0);
+
+	for (i = 0; i < 4; i++) {
+		ev.events = EPOLLIN | EPOLLET;
+		ev.data.u32 = i;
+		TC_ASSERT_EQ("epoll_ctl", epoll_ctl(epfd, EPOLL_CTL_ADD, g_ep_sock[i], &ev), 0);
+	}
+
+	memset(&dest, 0, sizeof(dest));
+	dest.sin_family = AF_INET;
+	dest.sin_addr.s_addr = inet_addr("127.0.0.1");
+	for (i = 0; i < 4; i++) {
+		dest.sin_port = htons(PORTNUM + i);
+		sendto(g_ep_sock[0], "e", 1, 0, (struct sockaddr *)&dest, sizeof(dest));
+	}
+	/* let the stack deliver all of them */
+	usleep(100000);
+
+	for (i = 0; i < 4; i++) {
+		TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 0), 1);
+		TC_ASSERT_EQ("epoll_wait", ev.data.u32, i);
+	}
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 1, 0), 0);
+
+	close(epfd);
+	ep_close();
+	TC_SUCCESS_RESULT();
+}
+
+/**
+   * @testcase		   :tc_net_epoll_ctl_n
+   * @brief		   :
+   * @scenario		   :
+   * @apicovered	   :epoll_create(), epoll_ctl(), epoll_wait()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_epoll_ctl_n(void)
+{
+	struct epoll_event ev;
+	int epfd;
+
+	TC_ASSERT_EQ("epoll_create", epoll_create(0), -1);
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(-1, &ev, 1, 0), -1);
+
+	epfd = epoll_create(1);
+	TC_ASSERT_GEQ("epoll_create", epfd, 0);
+	ev.events = EPOLLIN;
+	TC_ASSERT_EQ("epoll_ctl", epoll_ctl(epfd, EPOLL_CTL_ADD, 0, &ev), -1);
+	TC_ASSERT_EQ("epoll_ctl", errno, EPERM);
+	TC_ASSERT_EQ("epoll_ctl", epoll_ctl(epfd, EPOLL_CTL_ADD, -1, &ev), -1);
+	TC_ASSERT_EQ("epoll_ctl", errno, EBADF);
+	TC_ASSERT_EQ("epoll_wait", epoll_wait(epfd, &ev, 0, 0), -1);
+	TC_ASSERT_EQ("epoll_wait", errno, EINVAL);
+	close(epfd);
+	TC_SUCCESS_RESULT();
+}
+
+/****************************************************************************
+ * Name: epoll()
+ ****************************************************************************/
+int net_epoll_main(void)
+{
+	tc_net_epoll_ctl_n();
+	tc_net_epoll_ctl_p();
+	tc_net_epoll_wait_order_p();
+	tc_net_epoll_wait_p();
+	return 0;
+}
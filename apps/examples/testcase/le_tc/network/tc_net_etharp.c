@@ -0,0 +1,322 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+// @file tc_net_etharp.c
+// @brief Test Case Example for the ARP table lookup
+#include <tinyara/config.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <arpa/inet.h>
+#include <net/lwip/netif.h>
+#include <net/lwip/pbuf.h>
+#include <net/lwip/netif/etharp.h>
+#include "tc_internal.h"
+
+/* 198.18.0.0/15 is reserved for benchmarks, ip_route() sends it to the default netif */
+#define ARP_BENCH_NET       0xc6120000
+#define ARP_BENCH_MAX       1024
+#define ARP_BENCH_LOOKUPS   100000
+
+/* 198.19.0.0/16 is used by the recycling test, on an interface of its own */
+#define ARP_LRU_NET         0xc6130000
+#define ARP_LRU_ENTRIES     4
+
+#if ARP_TABLE_SIZE < ARP_BENCH_MAX
+#define ARP_BENCH_ENTRIES   ARP_TABLE_SIZE
+#else
+#define ARP_BENCH_ENTRIES   ARP_BENCH_MAX
+#endif
+
+/**
+   * @fn                   :arp_bench_addr
+   * @brief                :the n-th address of the benchmark range
+   * @scenario             :
+   * API's covered         :
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :void
+   */
+static void arp_bench_addr(int n, ip_addr_t *ipaddr, struct eth_addr *ethaddr)
+{
+	ip4_addr_set_u32(ipaddr, htonl(ARP_BENCH_NET + 1 + n));
+	ethaddr->addr[0] = 0x02;
+	ethaddr->addr[1] = 0x00;
+	ethaddr->addr[2] = 0x00;
+	ethaddr->addr[3] = 0x00;
+	ethaddr->addr[4] = (u8_t)(n >> 8);
+	ethaddr->addr[5] = (u8_t)n;
+}
+
+/**
+   * @fn                   :arp_bench_lookup
+   * @brief                :looks up the first count entries in turn and reports the cost per lookup
+   * @scenario             :
+   * API's covered         :etharp_find_addr
+   * Preconditions         :count static entries were added
+   * Postconditions        :
+   * @return               :int, the number of lookups that found their entry
+   */
+static int arp_bench_lookup(struct netif *netif, int count)
+{
+	struct timespec start;
+	struct timespec end;
+	struct eth_addr ethaddr;
+	struct eth_addr *eth_ret;
+	ip_addr_t *ip_ret;
+	ip_addr_t ipaddr;
+	unsigned int ns;
+	int found = 0;
+	int i;
+
+	clock_gettime(CLOCK_REALTIME, &start);
+	sched_lock();
+	for (i = 0; i < ARP_BENCH_LOOKUPS; i++) {
+		arp_bench_addr(i % count, &ipaddr, &ethaddr);
+		if (etharp_find_addr(netif, &ipaddr, &eth_ret, &ip_ret) >= 0) {
+			found++;
+		}
+	}
+	sched_unlock();
+	clock_gettime(CLOCK_REALTIME, &end);
+
+	ns = (end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+	printf("\n[etharp] %4d entries: %u ns per lookup\n", count, ns / ARP_BENCH_LOOKUPS);
+	return found;
+}
+
+/**
+   * @testcase		   :tc_net_etharp_find_addr_p
+   * @brief		   :
+   * @scenario		   :lookup cost with the table filled to 1, 1/4, 1/2 and all of its entries
+   * @apicovered	   :etharp_add_static_entry(), etharp_find_addr(), etharp_remove_static_entry()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_etharp_find_addr_p(struct netif *netif)
+{
+	int occupancy[] = { 1, ARP_BENCH_ENTRIES / 4, ARP_BENCH_ENTRIES / 2, ARP_BENCH_ENTRIES };
+	struct eth_addr ethaddr;
+	ip_addr_t ipaddr;
+	int added = 0;
+	int removed = 0;
+	int i;
+	int j;
+
+	for (i = 0; i < sizeof(occupancy) / sizeof(occupancy[0]); i++) {
+		if (occupancy[i] < 1) {
+			continue;
+		}
+		sched_lock();
+		for (j = added; j < occupancy[i]; j++) {
+			arp_bench_addr(j, &ipaddr, &ethaddr);
+			if (etharp_add_static_entry(&ipaddr, &ethaddr) != ERR_OK) {
+				break;
+			}
+		}
+		sched_unlock();
+		added = j;
+		TC_ASSERT_EQ("etharp_add_static_entry", added, occupancy[i]);
+		TC_ASSERT_EQ("etharp_find_addr", arp_bench_lookup(netif, added), ARP_BENCH_LOOKUPS);
+	}
+
+	sched_lock();
+	for (j = 0; j < added; j++) {
+		arp_bench_addr(j, &ipaddr, &ethaddr);
+		if (etharp_remove_static_entry(&ipaddr) == ERR_OK) {
+			removed++;
+		}
+	}
+	sched_unlock();
+	TC_ASSERT_EQ("etharp_remove_static_entry", removed, added);
+	TC_SUCCESS_RESULT();
+}
+
+/**
+   * @fn                   :arp_lru_linkoutput
+   * @brief                :drops what the recycling test interface sends
+   * @scenario             :
+   * API's covered         :
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :err_t
+   */
+static err_t arp_lru_linkoutput(struct netif *netif, struct pbuf *p)
+{
+	return ERR_OK;
+}
+
+/**
+   * @fn                   :arp_lru_reply
+   * @brief                :passes an ARP reply from the n-th address of the recycling test range to netif
+   * @scenario             :a reply directed to the interface adds or refreshes a dynamic entry
+   * API's covered         :ethernet_input
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :void
+   */
+static void arp_lru_reply(struct netif *netif, int n)
+{
+	struct pbuf *p = pbuf_alloc(PBUF_RAW, SIZEOF_ETHARP_PACKET, PBUF_RAM);
+	struct eth_hdr *ethhdr;
+	struct etharp_hdr *hdr;
+	struct eth_addr ethaddr;
+	ip_addr_t ipaddr;
+
+	if (p == NULL) {
+		return;
+	}
+
+	arp_bench_addr(n, &ipaddr, &ethaddr);
+	ip4_addr_set_u32(&ipaddr, htonl(ARP_LRU_NET + 1 + n));
+
+	ethhdr = (struct eth_hdr *)p->payload;
+	ETHADDR16_COPY(&ethhdr->dest, netif->hwaddr);
+	ETHADDR16_COPY(&ethhdr->src, &ethaddr);
+	ethhdr->type = PP_HTONS(ETHTYPE_ARP);
+
+	hdr = (struct etharp_hdr *)((u8_t *)ethhdr + SIZEOF_ETH_HDR);
+	hdr->hwtype = PP_HTONS(1);	/* Ethernet */
+	hdr->proto = PP_HTONS(ETHTYPE_IP);
+	hdr->hwlen = ETHARP_HWADDR_LEN;
+	hdr->protolen = sizeof(ip_addr_t);
+	hdr->opcode = PP_HTONS(ARP_REPLY);
+	ETHADDR16_COPY(&hdr->shwaddr, &ethaddr);
+	IPADDR2_COPY(&hdr->sipaddr, &ipaddr);
+	ETHADDR16_COPY(&hdr->dhwaddr, netif->hwaddr);
+	IPADDR2_COPY(&hdr->dipaddr, &netif->ip_addr);
+
+	ethernet_input(p, netif);
+}
+
+/**
+   * @fn                   :arp_lru_find
+   * @brief                :whether the n-th address of the recycling test range has an entry
+   * @scenario             :
+   * API's covered         :etharp_find_addr
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :int
+   */
+static int arp_lru_find(struct netif *netif, int n)
+{
+	struct eth_addr *eth_ret;
+	ip_addr_t *ip_ret;
+	ip_addr_t ipaddr;
+
+	ip4_addr_set_u32(&ipaddr, htonl(ARP_LRU_NET + 1 + n));
+	return etharp_find_addr(netif, &ipaddr, &eth_ret, &ip_ret) >= 0;
+}
+
+/**
+   * @testcase		   :tc_net_etharp_recycle_p
+   * @brief		   :
+   * @scenario		   :an interface at its entry limit recycles its least recently used entry
+   * @apicovered	   :ethernet_input(), etharp_find_addr(), etharp_cleanup_netif()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_etharp_recycle_p(void)
+{
+	static struct netif netif;
+	int found[ARP_LRU_ENTRIES + 1];
+	int entries;
+	int i;
+
+	/* not added to the interface list, so that nothing routes to it */
+	memset(&netif, 0, sizeof(netif));
+	netif.hwaddr_len = ETHARP_HWADDR_LEN;
+	netif.hwaddr[0] = 0x02;
+	netif.hwaddr[5] = 0xfe;
+	netif.mtu = 1500;
+	netif.flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+	netif.output = etharp_output;
+	netif.linkoutput = arp_lru_linkoutput;
+	ip4_addr_set_u32(&netif.ip_addr, htonl(ARP_LRU_NET + 0xfffe));
+	ip4_addr_set_u32(&netif.netmask, htonl(0xffff0000));
+	netif_set_arp_max_entries(&netif, ARP_LRU_ENTRIES);
+
+	sched_lock();
+	/* fill the share of the interface, the first entry is the oldest */
+	for (i = 0; i < ARP_LRU_ENTRIES; i++) {
+		arp_lru_reply(&netif, i);
+	}
+	/* using the first one again leaves the second one least recently used */
+	arp_lru_reply(&netif, 0);
+	/* one more takes the place of the second one */
+	arp_lru_reply(&netif, ARP_LRU_ENTRIES);
+	entries = netif.arp_entries;
+	for (i = 0; i <= ARP_LRU_ENTRIES; i++) {
+		found[i] = arp_lru_find(&netif, i);
+	}
+	etharp_cleanup_netif(&netif);
+	sched_unlock();
+
+	TC_ASSERT_EQ("arp_entries", entries, ARP_LRU_ENTRIES);
+	TC_ASSERT_EQ("etharp_find_addr", found[0], 1);
+	TC_ASSERT_EQ("etharp_find_addr", found[1], 0);
+	for (i = 2; i <= ARP_LRU_ENTRIES; i++) {
+		TC_ASSERT_EQ("etharp_find_addr", found[i], 1);
+	}
+	TC_ASSERT_EQ("etharp_cleanup_netif", netif.arp_entries, 0);
+	TC_SUCCESS_RESULT();
+}
+
+/**
+   * @testcase		   :tc_net_etharp_find_addr_n
+   * @brief		   :
+   * @scenario		   :
+   * @apicovered	   :etharp_find_addr(), etharp_remove_static_entry()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_etharp_find_addr_n(struct netif *netif)
+{
+	struct eth_addr ethaddr;
+	struct eth_addr *eth_ret;
+	ip_addr_t *ip_ret;
+	ip_addr_t ipaddr;
+	s16_t ret;
+
+	arp_bench_addr(0, &ipaddr, &ethaddr);
+	sched_lock();
+	ret = etharp_find_addr(netif, &ipaddr, &eth_ret, &ip_ret);
+	sched_unlock();
+	TC_ASSERT_EQ("etharp_find_addr", ret, -1);
+	TC_ASSERT_EQ("etharp_remove_static_entry", etharp_remove_static_entry(&ipaddr), ERR_MEM);
+	TC_SUCCESS_RESULT();
+}
+
+/****************************************************************************
+ * Name: etharp_find_addr()
+ ****************************************************************************/
+int net_etharp_main(void)
+{
+	struct netif *netif = netif_default;
+
+	if (netif == NULL) {
+		printf("\n[etharp] no default interface, skipped\n");
+		return 0;
+	}
+
+	tc_net_etharp_find_addr_n(netif);
+	tc_net_etharp_find_addr_p(netif);
+	tc_net_etharp_recycle_p();
+	return 0;
+}
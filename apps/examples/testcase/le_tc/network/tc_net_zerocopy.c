@@ -0,0 +1,268 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+// @file tc_net_zerocopy.c
+// @brief Test Case Example for recv_zc(), recv_zc_release() and send_zc() API
+#include <tinyara/config.h>
+#include <errno.h>
+#include "tc_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <semaphore.h>
+#include <arpa/inet.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <pthread.h>
+#include <net/lwip/pbuf.h>
+
+#define PORTNUM        1120
+#define ZC_CHUNK       1024
+#define ZC_TOTAL_MB    4
+#define ZC_TOTAL       (ZC_TOTAL_MB * 1024 * 1024)
+
+/* send_zc() buffers in flight, so that the sender does not wait for each ACK */
+#define ZC_INFLIGHT    8
+
+static sem_t g_zc_listening;
+static sem_t g_zc_free;
+static int g_zc_sent_err;
+static int g_zc_use_zc;
+static char g_zc_txbuf[ZC_INFLIGHT][ZC_CHUNK];
+static char g_zc_rxbuf[ZC_CHUNK];
+
+/**
+   * @fn                   :zc_sent
+   * @brief                :completion function passed to send_zc()
+   * @scenario             :
+   * API's covered         :
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :void
+   */
+static void zc_sent(void *arg, int err)
+{
+	if (err != 0) {
+		g_zc_sent_err = err;
+	}
+	/* the buffer can be filled again */
+	sem_post(&g_zc_free);
+}
+
+/**
+   * @fn                   :zc_elapsed_ms
+   * @brief                :milliseconds elapsed since start
+   * @scenario             :
+   * API's covered         :
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :unsigned int
+   */
+static unsigned int zc_elapsed_ms(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/**
+   * @fn                   :zc_server
+   * @brief                :sends ZC_TOTAL bytes with send() or send_zc()
+   * @scenario             :
+   * API's covered         :socket,bind,listen,accept,send,send_zc,close
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :void *
+   */
+static void *zc_server(void *args)
+{
+	struct sockaddr_in sa;
+	int total = 0;
+	int slot = 0;
+	int ret;
+	int i;
+	int fd;
+	int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_port = htons(PORTNUM);
+	sa.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+	bind(sock, (struct sockaddr *)&sa, sizeof(sa));
+	listen(sock, 1);
+	sem_post(&g_zc_listening);
+
+	fd = accept(sock, NULL, NULL);
+	memset(g_zc_txbuf, 'z', sizeof(g_zc_txbuf));
+	while (total < ZC_TOTAL) {
+		if (g_zc_use_zc) {
+			/* wait for a buffer the peer has acknowledged; TCP completes in order */
+			sem_wait(&g_zc_free);
+			ret = send_zc(fd, g_zc_txbuf[slot], ZC_CHUNK, 0, zc_sent, NULL);
+			if (ret <= 0) {
+				sem_post(&g_zc_free);
+			}
+			slot = (slot + 1) % ZC_INFLIGHT;
+		} else {
+			ret = send(fd, g_zc_txbuf[0], ZC_CHUNK, 0);
+		}
+		if (ret <= 0) {
+			break;
+		}
+		total += ret;
+	}
+
+	if (g_zc_use_zc) {
+		/* closing with unacknowledged zero-copy data aborts the connection */
+		for (i = 0; i < ZC_INFLIGHT; i++) {
+			sem_wait(&g_zc_free);
+		}
+	}
+
+	close(fd);
+	close(sock);
+	return NULL;
+}
+
+/**
+   * @fn                   :zc_client
+   * @brief                :receives until the server closes with recv() or recv_zc()
+   * @scenario             :
+   * API's covered         :socket,connect,recv,recv_zc,recv_zc_release,close
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :int, the number of bytes received
+   */
+static int zc_client(void)
+{
+	struct sockaddr_in dest;
+	struct pbuf *p;
+	int total = 0;
+	int ret;
+	int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	memset(&dest, 0, sizeof(dest));
+	dest.sin_family = AF_INET;
+	dest.sin_addr.s_addr = inet_addr("127.0.0.1");
+	dest.sin_port = htons(PORTNUM);
+
+	sem_wait(&g_zc_listening);
+	connect(sock, (struct sockaddr *)&dest, sizeof(dest));
+
+	for (;;) {
+		if (g_zc_use_zc) {
+			ret = recv_zc(sock, &p, 0, NULL, NULL);
+			if (ret > 0) {
+				recv_zc_release(sock, p);
+			}
+		} else {
+			ret = recv(sock, g_zc_rxbuf, ZC_CHUNK, 0);
+		}
+		if (ret <= 0) {
+			break;
+		}
+		total += ret;
+	}
+
+	close(sock);
+	return total;
+}
+
+/**
+   * @fn                   :zc_transfer
+   * @brief                :transfers ZC_TOTAL bytes over loopback and reports the cost per MB
+   * @scenario             :
+   * API's covered         :
+   * Preconditions         :
+   * Postconditions        :
+   * @return               :int, the number of bytes received
+   */
+static int zc_transfer(int use_zc)
+{
+	pthread_t server;
+	struct timespec start;
+	unsigned int ms;
+	int total;
+
+	g_zc_use_zc = use_zc;
+	g_zc_sent_err = 0;
+	sem_init(&g_zc_listening, 0, 0);
+	sem_init(&g_zc_free, 0, ZC_INFLIGHT);
+
+	pthread_create(&server, NULL, zc_server, NULL);
+	clock_gettime(CLOCK_REALTIME, &start);
+	total = zc_client();
+	ms = zc_elapsed_ms(&start);
+	pthread_join(server, NULL);
+
+	/* loopback is CPU bound, so the elapsed time is the CPU cost */
+	printf("\n[zerocopy] %s: %d bytes, %u ms/MB\n", use_zc ? "recv_zc/send_zc" : "recv/send", total, ms / ZC_TOTAL_MB);
+
+	sem_destroy(&g_zc_listening);
+	sem_destroy(&g_zc_free);
+	return total;
+}
+
+/**
+   * @testcase		   :tc_net_recv_zc_p
+   * @brief		   :
+   * @scenario		   :
+   * @apicovered	   :recv_zc(), recv_zc_release(), send_zc()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_recv_zc_p(void)
+{
+	TC_ASSERT_EQ("recv", zc_transfer(0), ZC_TOTAL);
+	TC_ASSERT_EQ("recv_zc", zc_transfer(1), ZC_TOTAL);
+	TC_ASSERT_EQ("send_zc", g_zc_sent_err, 0);
+	TC_SUCCESS_RESULT();
+}
+
+/**
+   * @testcase		   :tc_net_recv_zc_n
+   * @brief		   :
+   * @scenario		   :
+   * @apicovered	   :recv_zc(), recv_zc_release(), send_zc()
+   * @precondition	   :
+   * @postcondition	   :
+   */
+static void tc_net_recv_zc_n(void)
+{
+	struct pbuf *p;
+
+	TC_ASSERT_EQ("recv_zc", recv_zc(-1, &p, 0, NULL, NULL), -1);
+	TC_ASSERT_EQ("recv_zc_release", recv_zc_release(-1, NULL), -1);
+	TC_ASSERT_EQ("send_zc", send_zc(-1, g_zc_txbuf[0], ZC_CHUNK, 0, zc_sent, NULL), -1);
+	TC_SUCCESS_RESULT();
+}
+
+/****************************************************************************
+ * Name: recv_zc()
+ ****************************************************************************/
+int net_zerocopy_main(void)
+{
+	tc_net_recv_zc_p();
+	tc_net_recv_zc_n();
+	return 0;
+}
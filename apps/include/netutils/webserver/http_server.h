@@ -41,7 +41,7 @@
  ****************************************************************************/
 
 #include <stdio.h>
-#include <mqueue.h>
+#include <pthread.h>
 #include <sys/socket.h>
 #include <sys/select.h>
 #include <netinet/in.h>
@@ -85,10 +85,8 @@
 #define HTTP_CONF_CLIENT_STACKSIZE              8192
 #define HTTP_CONF_MIN_TLS_MEMORY                80000
 #define HTTP_CONF_SOCKET_TIMEOUT_MSEC           5000
-#define HTTP_CONF_MAX_CLIENT_HANDLE             1
-#define HTTP_CONF_SERVER_MQ_MAX_MSG             10
-#define HTTP_CONF_SERVER_MQ_PRIO                50
-#define HTTP_CONF_SERVER_SIGWAKEUP              18
+#define HTTP_CONF_KEEPALIVE_TIMEOUT_MSEC        5000
+#define HTTP_CONF_SERVER_TICK_MSEC              1000
 
 #define HTTP_CONF_MAX_REQUEST_LENGTH            4096
 #define HTTP_CONF_MAX_REQUEST_LINE_LENGTH       256
@@ -99,7 +97,6 @@
 #define HTTP_CONF_MAX_VALUE_LENGTH              256
 #define HTTP_CONF_MAX_DIVIDED_PATH_LENGTH       32
 #define HTTP_CONF_MAX_SLASH_COUNT               32
-#define HTTP_CONF_MAX_QUERY_HANDLER_COUNT       64
 #define HTTP_CONF_MAX_ENTITY_LENGTH             2048
 
 #define HTTP_ERROR_400            "Bad Request"
@@ -112,6 +109,7 @@
 
 struct http_client_t;
 struct http_keyvalue_list_t;
+struct http_route_t;
 
 /**
  * @brief http server ssl config structure.
@@ -163,10 +161,7 @@ struct http_server_t {
 	int  port;
 	int  listen_fd;
 	http_server_state_t state;
-	sem_t sem_thread_sync;
 	pthread_t tid;
-	pthread_t c_tid[HTTP_CONF_MAX_CLIENT_HANDLE];
-	mqd_t msg_q;
 
 	int                       tls_init;
 #ifdef CONFIG_NET_SECURITY_TLS
@@ -181,8 +176,7 @@ struct http_server_t {
 
 	struct sockaddr_in             servaddr;
 	http_cb_t cb[4];
-	struct http_query_handler_t
-	*query_handlers[HTTP_CONF_MAX_QUERY_HANDLER_COUNT];
+	struct http_route_t *routes;
 #ifdef CONFIG_NETUTILS_WEBSOCKET
 	websocket_cb_t ws_cb;
 #endif
@@ -20,213 +20,212 @@
 #include <apps/netutils/webserver/http_server.h>
 #include <apps/netutils/webserver/http_keyvalue_list.h>
 #include <fcntl.h>
+#include <poll.h>
 
 #include "http.h"
 #include "http_client.h"
+#include "http_arch.h"
 #include "http_log.h"
 
-#define MAX_ACCEPTED_FD    20
-#define ACCEPT_TIMEOUT_MS  100
 #define HTTP_LISTENING_HANDLER_STACKSIZE (1024 * 4)
-#define HTTP_CLIENT_HANDLER_STACKSIZE    (1024 * 4)
-#define HTTPS_CLIENT_HANDLER_STACKSIZE    (1024 * 8)
+#define HTTPS_LISTENING_HANDLER_STACKSIZE (1024 * 8)
 
-int http_server_mq_flush(mqd_t msg_q)
-{
-	struct http_msg_t msg;
-	struct mq_attr mqattr;
-	struct timespec  t;
-
-	mq_getattr(msg_q, &mqattr);
-	HTTP_LOGD("msg queue flush start : [%d]\n", mqattr.mq_curmsgs);
+/* fds[0] is the listening socket, fds[i] is the socket of clients[i] */
+#define HTTP_POLL_FD_COUNT (HTTP_CONF_MAX_CLIENT + 1)
 
-	t.tv_sec = 0;
-	t.tv_nsec = 1000;
+static int http_server_elapsed_msec(unsigned int since)
+{
+	return (int)(http_client_clock() - since);
+}
 
-	while (mqattr.mq_curmsgs != 0) {
-		mq_timedreceive(msg_q, (char *)&msg, mqattr.mq_msgsize, NULL, &t);
-		if (msg.event == HTTP_CONNECT_EVENT) {
-			close(msg.data);
-		}
-		mq_getattr(msg_q, &mqattr);
+/* What the event loop waits for on the socket of a client */
+static short http_server_poll_events(struct http_client_t *client)
+{
+	if (client->out_len > 0) {
+		/* Read no more requests until the responses are sent */
+		return POLLOUT;
 	}
-
-	HTTP_LOGD("msg queue flush finish : [%d]\n", mqattr.mq_curmsgs);
-	return 0;
+#ifdef CONFIG_NET_SECURITY_TLS
+	if (client->tls_want_write) {
+		return POLLIN | POLLOUT;
+	}
+#endif
+	return POLLIN;
 }
 
-mqd_t http_server_mq_open(int port)
+static struct http_client_t *http_server_accept(struct http_server_t *server)
 {
-	struct mq_attr mqattr;
-	char msg_name[8];
-	mqd_t msg_q;
+	struct http_client_t *client;
+	struct sockaddr_in client_addr;
+	socklen_t addrlen = sizeof(struct sockaddr_in);
+	int sock_fd;
+	int flags;
+#ifdef CONFIG_NET_SECURITY_TLS
+	struct mallinfo data;
+#endif
 
-	snprintf(msg_name, 8, "mq%05d", port);
-	mqattr.mq_maxmsg = HTTP_CONF_SERVER_MQ_MAX_MSG;
-	mqattr.mq_msgsize = sizeof(struct http_msg_t);
-	mqattr.mq_flags = 0;
+	sock_fd = accept(server->listen_fd, (struct sockaddr *)&client_addr, &addrlen);
+	if (sock_fd < 0) {
+		if (errno != EWOULDBLOCK && errno != EAGAIN) {
+			HTTP_LOGE("Error: Accept client error!!\n");
+		}
+		return NULL;
+	}
 
-	if ((msg_q = mq_open(msg_name, O_RDWR | O_CREAT, 0666, &mqattr)) == (mqd_t)ERROR) {
-		msg_q = NULL;
+	HTTP_LOGD("Client %d is accepted ipaddr: %d.%d.%d.%d\n", sock_fd,
+			  (int)((client_addr.sin_addr.s_addr & 0xFF)),
+			  (int)((client_addr.sin_addr.s_addr & 0xFF00) >> 8),
+			  (int)((client_addr.sin_addr.s_addr & 0xFF0000) >> 16),
+			  (int)((client_addr.sin_addr.s_addr & 0xFF000000) >> 24));
+
+	/* A client that stops sending or reading must not stall the event loop */
+	flags = fcntl(sock_fd, F_GETFL, 0);
+	if (flags < 0 || fcntl(sock_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+		HTTP_LOGE("Error: Fail to set nonblocking\n");
+		close(sock_fd);
+		return NULL;
 	}
 
-	return msg_q;
-}
+#ifdef CONFIG_NET_SECURITY_TLS
+	if (server->tls_init) {
+		data = mallinfo();
+		if (data.fordblks < HTTP_CONF_MIN_TLS_MEMORY) {
+			HTTP_LOGE("Error: Not enough memory :: %d\n", data.fordblks);
+			close(sock_fd);
+			return NULL;
+		}
+	}
+#endif
 
-int http_server_mq_close(int port)
-{
-	char msg_name[8];
+	client = http_client_init(server, sock_fd);
+	if (client == NULL) {
+		HTTP_LOGE("Error: Cannot init client!!\n");
+		close(sock_fd);
+		return NULL;
+	}
+	client->client_ip = client_addr.sin_addr.s_addr;
 
-	snprintf(msg_name, 8, "mq%05d", port);
+#ifdef CONFIG_NET_SECURITY_TLS
+	if (server->tls_init) {
+		/* The handshake goes on in the event loop */
+		if (http_client_tls_init(client) != HTTP_OK) {
+			HTTP_LOGE("Error: Cannot initialize TLS!! Close client.. %d\n", sock_fd);
+			http_close_client(client);
+			return NULL;
+		}
+	}
+#endif
 
-	return mq_unlink(msg_name);
+	return client;
 }
 
+/*
+ * All connections are served by this thread: poll() tells which sockets
+ * have data, and each of them is handed the bytes available without
+ * waiting for the rest of the request. A response the socket has no room
+ * for is kept by the connection and sent on POLLOUT. Connections are kept
+ * open between requests until the client closes them or they make no
+ * progress for HTTP_CONF_KEEPALIVE_TIMEOUT_MSEC.
+ */
 pthread_addr_t http_server_handler(pthread_addr_t arg)
 {
-	fd_set readfds;
-	int fdcnt = 0;
-	int fdarr[MAX_ACCEPTED_FD] = {0,};
-	mqd_t msg_q;
-	struct http_msg_t msg;
-	socklen_t addrlen;
-	int sock_fd, ret, cnt, i, maxfd = 0;
-	struct timeval tv, accept_to;
-	struct sockaddr_in client_addr;
-	struct mq_attr mqattr;
 	struct http_server_t *server = (struct http_server_t *)arg;
+	struct pollfd fds[HTTP_POLL_FD_COUNT];
+	struct http_client_t *clients[HTTP_POLL_FD_COUNT];
+	struct http_client_t *client;
+	unsigned int last_sweep = http_client_clock();
+	int nfds = 1;
+	int flags;
+	int ret, result, i;
 
-	if ((msg_q = http_server_mq_open(server->port)) == NULL) {
-		HTTP_LOGE("msg queue open fail in http_server_handler %d\n" , server->port);
-		goto stop;
-	}
-
-	mq_getattr(msg_q, &mqattr);
-
-	/*
-	 * Start client accept loop
-	 */
 	HTTP_LOGD("Accepting connections on port %d began.\n", server->port);
 
-	accept_to.tv_sec = ACCEPT_TIMEOUT_MS / 1000;
-	accept_to.tv_usec = (ACCEPT_TIMEOUT_MS % 1000) * 1000;
-	if (setsockopt(server->listen_fd, SOL_SOCKET, SO_RCVTIMEO,
-				   (struct timeval *)&accept_to, sizeof(struct timeval)) < 0) {
-		HTTP_LOGE("Error: Fail to setsockopt\n");
+	/* poll() may report a connection that is gone by the time of accept() */
+	flags = fcntl(server->listen_fd, F_GETFL, 0);
+	if (flags < 0 || fcntl(server->listen_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+		HTTP_LOGE("Error: Fail to set nonblocking\n");
 	}
 
+	HTTP_MEMSET(fds, 0, sizeof(fds));
+	fds[0].fd = server->listen_fd;
+	clients[0] = NULL;
+
 	server->state = HTTP_SERVER_RUN;
 
 	while (server->state == HTTP_SERVER_RUN) {
-		addrlen = sizeof(struct sockaddr_in);
-		sock_fd = accept(*(volatile int *)&server->listen_fd,
-						 (struct sockaddr *)&client_addr,
-						 &addrlen);
-		if (sock_fd < 0 && errno != EWOULDBLOCK) {
-			HTTP_LOGE("Error: Accept client error!!\n");
-			continue;
+		/* Leave new connections in the backlog while the table is full */
+		fds[0].events = (nfds < HTTP_POLL_FD_COUNT) ? POLLIN : 0;
+
+		ret = poll(fds, nfds, HTTP_CONF_SERVER_TICK_MSEC);
+		if (ret < 0 && errno != EINTR) {
+			HTTP_LOGE("Error: poll fail %d\n", errno);
+			break;
 		}
 
-		if (sock_fd > 0) {
-			tv.tv_sec = HTTP_CONF_SOCKET_TIMEOUT_MSEC / 1000;
-			tv.tv_usec = (HTTP_CONF_SOCKET_TIMEOUT_MSEC % 1000) * 1000;
-			if (setsockopt(sock_fd, SOL_SOCKET, SO_RCVTIMEO,
-						   (struct timeval *)&tv, sizeof(struct timeval)) < 0) {
-				HTTP_LOGE("Error: Fail to setsockopt\n");
+		/* Downwards, so that moving the last entry into a hole is safe */
+		for (i = nfds - 1; ret > 0 && i > 0; i--) {
+			if (fds[i].revents == 0) {
+				continue;
+			}
+			ret--;
+
+			client = clients[i];
+			if (!(fds[i].revents & (POLLIN | POLLOUT))) {
+				result = HTTP_CLIENT_CLOSE;
+			} else if (client->out_len > 0) {
+				result = http_client_resume(client);
+			} else {
+				result = http_client_receive(client);
 			}
 
-			HTTP_LOGD("Client %d is accepted ipaddr: %d.%d.%d.%d\n", sock_fd,
-					  (int)((client_addr.sin_addr.s_addr & 0xFF)),
-					  (int)((client_addr.sin_addr.s_addr & 0xFF00) >> 8),
-					  (int)((client_addr.sin_addr.s_addr & 0xFF0000) >> 16),
-					  (int)((client_addr.sin_addr.s_addr & 0xFF000000) >> 24));
-			for (i = 0; i < MAX_ACCEPTED_FD; ++i) {
-				if (!fdarr[i]) {
-					if (sock_fd > maxfd) {
-						maxfd = sock_fd;
-					}
-					fdarr[i] = sock_fd;
-					++fdcnt;
-					break;
-				}
-				if (i + 1 == MAX_ACCEPTED_FD) {
-					HTTP_LOGE("Error: Too many request be piled\n");
+			if (result != HTTP_CLIENT_KEEP) {
+				if (result == HTTP_CLIENT_CLOSE) {
+					HTTP_LOGD("Close client %d\n", client->client_fd);
+					http_close_client(client);
+				} else {
+					/* The websocket thread owns the socket now */
+					http_client_release(client);
 				}
+				nfds--;
+				fds[i] = fds[nfds];
+				clients[i] = clients[nfds];
+			} else {
+				fds[i].events = http_server_poll_events(client);
 			}
 		}
 
-		if (fdcnt > 0) {
-			cnt = 0;
-			FD_ZERO(&readfds);
-			for (i = 0; i < MAX_ACCEPTED_FD; ++i) {
-				if (fdarr[i]) {
-					FD_SET(fdarr[i], &readfds);
-					++cnt;
-				}
-				if (cnt == fdcnt) {
-					break;
-				}
+		if (fds[0].revents & POLLIN) {
+			client = http_server_accept(server);
+			if (client != NULL) {
+				fds[nfds].fd = client->client_fd;
+				fds[nfds].events = http_server_poll_events(client);
+				fds[nfds].revents = 0;
+				clients[nfds] = client;
+				nfds++;
 			}
-			ret = select(maxfd + 1, &readfds, (fd_set *)0, (fd_set *)0, NULL);
-			if (ret > 0) {
-				cnt = 0;
-				for (i = 0; i < MAX_ACCEPTED_FD; ++i) {
-					if (fdarr[i]) {
-						if (FD_ISSET(fdarr[i], &readfds)) {
-							++cnt;
-							sock_fd = fdarr[i];
-							fdarr[i] = 0;
-							--fdcnt;
-
-							msg.event = HTTP_CONNECT_EVENT;
-							msg.data = sock_fd;
-
-							mq_getattr(msg_q, &mqattr);
-							if (mqattr.mq_curmsgs > HTTP_CONF_SERVER_MQ_MAX_MSG - 1) {
-								if (sock_fd > 0) {
-									close(sock_fd);
-								}
-								continue;
-							}
-
-							if (mq_send(msg_q, (char *)&msg, mqattr.mq_msgsize, 1) != OK) {
-								HTTP_LOGE("Send Error %d\n", getpid());
-								if (sock_fd > 0) {
-									close(sock_fd);
-								}
-								continue;
-							}
-						}
-						if (cnt == ret) {
-							break;
-						}
-					}
-				}
-			}
-		}
-	}
-stop:
-	if (msg_q >= 0) {
-		http_server_mq_flush(msg_q);
-
-		for (i = 0; i < HTTP_CONF_MAX_CLIENT_HANDLE; i++) {
-			msg.event = HTTP_STOP_EVENT;
-			msg.data = -1;
-			mq_send(msg_q, (char *)&msg, mqattr.mq_msgsize, 1);
 		}
+		fds[0].revents = 0;
 
-		mq_getattr(msg_q, &mqattr);
-
-		for (i = 0; i < HTTP_CONF_MAX_CLIENT_HANDLE;  i++) {
-			pthread_kill(server->c_tid[i], HTTP_CONF_SERVER_SIGWAKEUP);
+		if (http_server_elapsed_msec(last_sweep) < HTTP_CONF_SERVER_TICK_MSEC) {
+			continue;
 		}
-
-		mq_close(msg_q);
-
-		if (http_server_mq_close(server->port) != OK) {
-			HTTP_LOGD("mq close error %d\n", server->port);
+		last_sweep = http_client_clock();
+
+		for (i = nfds - 1; i > 0; i--) {
+			if (http_server_elapsed_msec(clients[i]->last_active) >= HTTP_CONF_KEEPALIVE_TIMEOUT_MSEC) {
+				HTTP_LOGD("Client %d is idle, close\n", clients[i]->client_fd);
+				http_close_client(clients[i]);
+				nfds--;
+				fds[i] = fds[nfds];
+				clients[i] = clients[nfds];
+			}
 		}
 	}
+
+	for (i = 1; i < nfds; i++) {
+		http_close_client(clients[i]);
+	}
+
 	HTTP_LOGD("http_server_handler stop :%d\n", server->port);
 
 	server->state = HTTP_SERVER_STOP;
@@ -237,9 +236,8 @@ stop:
 int http_server_start(struct http_server_t *server)
 {
 	pthread_attr_t attr;
-	unsigned int cli_handle_stack = HTTP_CLIENT_HANDLER_STACKSIZE;
+	unsigned int stack = HTTP_LISTENING_HANDLER_STACKSIZE;
 	int reuse = 1;
-	int i;
 
 	if (server == NULL) {
 		HTTP_LOGE("Error: Server must be initialized before start");
@@ -275,34 +273,23 @@ int http_server_start(struct http_server_t *server)
 		return HTTP_ERROR;
 	}
 
+#ifdef CONFIG_NET_SECURITY_TLS
+	if (server->tls_init) {
+		stack = HTTPS_LISTENING_HANDLER_STACKSIZE;
+	}
+#endif
+
 	pthread_attr_init(&attr);
 	pthread_attr_setschedpolicy(&attr, SCHED_RR);
-	pthread_attr_setstacksize(&attr, HTTP_LISTENING_HANDLER_STACKSIZE);
+	pthread_attr_setstacksize(&attr, stack);
 
 	if (pthread_create(&server->tid, &attr, http_server_handler, (void *)server) != 0) {
 		HTTP_LOGE("Error: Cannot create server thread!!\n");
+		close(server->listen_fd);
 		return HTTP_ERROR;
 	}
-	pthread_setname_np(server->tid, "listening webserver");
+	pthread_setname_np(server->tid, "webserver");
 	pthread_detach(server->tid);
 
-#ifdef CONFIG_NET_SECURITY_TLS
-	if (server->tls_init) {
-		cli_handle_stack = HTTPS_CLIENT_HANDLER_STACKSIZE;
-	}
-#endif
-
-	for (i = 0; i < HTTP_CONF_MAX_CLIENT_HANDLE; i++) {
-		pthread_attr_init(&attr);
-		pthread_attr_setschedpolicy(&attr, SCHED_RR);
-		pthread_attr_setstacksize(&attr, cli_handle_stack);
-		if (pthread_create(&server->c_tid[i], &attr, http_handle_client, (void *)server) != 0) {
-			HTTP_LOGE("Error: Cannot create server thread!!\n");
-			return HTTP_ERROR;
-		}
-		pthread_setname_np(server->c_tid[i], "client handler");
-		pthread_detach(server->c_tid[i]);
-	}
-
 	return HTTP_OK;
 }
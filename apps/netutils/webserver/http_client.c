@@ -17,6 +17,8 @@
  ****************************************************************************/
 
 #include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
 #include <apps/netutils/webserver/http_err.h>
 #include <apps/netutils/webserver/http_keyvalue_list.h>
 #include <apps/netutils/webclient.h>
@@ -31,89 +33,18 @@
 #include "http_arch.h"
 #include "http_log.h"
 
-#define MIN_WS_HEADER_FIELD 2
-
-pthread_addr_t http_handle_client(pthread_addr_t arg)
+unsigned int http_client_clock(void)
 {
-	struct http_server_t *server = (struct http_server_t *)arg;
-	struct http_msg_t msg;
-	int result;
-	struct http_keyvalue_list_t request_params;
-	int sock_fd;
-	struct mallinfo data;
-	struct http_client_t *p;
-	mqd_t msg_q;
-	struct mq_attr mqattr;
-
-	if ((msg_q = http_server_mq_open(server->port)) == NULL) {
-		HTTP_LOGE("msg queue open fail in http_handle_client\n");
-		return NULL;
-	}
-
-	mq_getattr(msg_q, &mqattr);
-
-	while (1) {
-		if (mq_receive(msg_q, (char *)&msg, mqattr.mq_msgsize, NULL) < 0) {
-			return NULL;
-		}
-
-		sock_fd = msg.data;
-
-		if (msg.event == HTTP_STOP_EVENT) {
-			close(sock_fd);
-			break;
-		}
-
-		data = mallinfo();
-
-		if (data.fordblks < HTTP_CONF_MIN_TLS_MEMORY * HTTP_CONF_MAX_CLIENT_HANDLE) {
-			HTTP_LOGE("Error: Not enough memory :: %d\n", data.fordblks);
-			close(sock_fd);
-			continue;
-
-		}
-
-		HTTP_LOGD("Free Mem %d\n", data.fordblks);
+	struct timespec ts;
 
-		p = http_client_init(server, sock_fd);
-
-		if (p == NULL) {
-			HTTP_LOGE("Error: Cannot init client!!\n");
-			close(sock_fd);
-			continue;
-		}
-
-		HTTP_LOGD("Client %d.\n", p->client_fd);
-
-#ifdef CONFIG_NET_SECURITY_TLS
-		if (server->tls_init) {
-			if (http_client_tls_init(p) != HTTP_OK) {
-				HTTP_LOGE("Error: Cannot initialize TLS!! Close client.. %d\n", sock_fd);
-				http_client_release(p);
-				continue;
-			}
-		}
+#ifdef CONFIG_CLOCK_MONOTONIC
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	clock_gettime(CLOCK_REALTIME, &ts);
 #endif
-		http_keyvalue_list_init(&request_params);
-		result = http_recv_and_handle_request(p, &request_params);
-		http_keyvalue_list_release(&request_params);
-
-		if (result != HTTP_OK) {
-			HTTP_LOGD("Client %d  in error case.\n", sock_fd);
-		} else {
-			HTTP_LOGD("Client %d  in normal case.\n", sock_fd);
-		}
-		http_client_release(p);
-		HTTP_LOGD("Release client....\n");
-	}
-
-	mq_close(msg_q);
-
-	HTTP_LOGD("Closed client handle %d\n", getpid());
-	return NULL;
+	return (unsigned int)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
 }
 
-
 struct http_client_t *http_client_init(struct http_server_t *server, int sock_fd)
 {
 	struct http_client_t *p = (struct http_client_t *)HTTP_MALLOC(sizeof(struct http_client_t));
@@ -125,6 +56,7 @@ struct http_client_t *http_client_init(struct http_server_t *server, int sock_fd
 
 	p->client_fd = sock_fd;
 	p->server = server;
+	p->last_active = http_client_clock();
 
 	return p;
 }
@@ -136,6 +68,15 @@ int http_client_release(struct http_client_t *client)
 		http_client_tls_release(client);
 	}
 #endif
+	if (client->req_headers.head) {
+		http_keyvalue_list_release(&client->req_headers);
+	}
+	if (client->buf) {
+		HTTP_FREE(client->buf);
+	}
+	if (client->out) {
+		HTTP_FREE(client->out);
+	}
 	HTTP_FREE(client);
 	HTTP_LOGD("Free Client\n");
 	return HTTP_OK;
@@ -366,129 +307,395 @@ int http_parse_message(char *buf, int buf_len, int *method, char *url,
 	return read_finish;
 }
 
-int http_recv_and_handle_request(struct http_client_t *client, struct http_keyvalue_list_t *request_params)
+/*
+ * Return the next complete line of the request, NUL terminated, or NULL if
+ * it has not been received entirely. Only the bytes received since the last
+ * call are scanned.
+ */
+static char *http_request_next_line(struct http_client_t *client)
 {
-	char *buf;
-	int len = 0;
-	char *body = NULL;
-	int read_finish = false;
+	struct http_request_parser_t *parser = &client->parser;
+	int start = parser->scan > parser->line ? parser->scan - 1 : parser->line;
+	int end = http_find_first_crlf(client->buf, client->buf_len, start);
+	char *line;
 
-	int method = HTTP_METHOD_UNKNOWN;
-	char url[HTTP_CONF_MAX_REQUEST_HEADER_URL_LENGTH] = { 0, };
-	int buf_len = 0;
-	int remain = HTTP_CONF_MAX_REQUEST_LENGTH;
-	int enc = HTTP_CONTENT_LENGTH;
-	struct http_req_message req;
-	int state = HTTP_REQUEST_HEADER;
-	struct http_message_len_t mlen = {0,};
-	struct sockaddr_in addr;
-	socklen_t addr_len;
+	if (end < 0) {
+		parser->scan = client->buf_len;
+		return NULL;
+	}
 
+	client->buf[end] = '\0';
+	line = client->buf + parser->line;
+	parser->line = end + 2;
+	parser->scan = end + 2;
+
+	return line;
+}
+
+static int http_request_line(struct http_client_t *client, char *line)
+{
+	struct http_request_parser_t *parser = &client->parser;
+	char *url = strchr(line, ' ');
+	char *ver = url ? strchr(url + 1, ' ') : NULL;
+	int method;
+
+	/* Check the url fits before http_separate_header() copies it */
+	if (ver == NULL || ver - url - 1 >= HTTP_CONF_MAX_REQUEST_HEADER_URL_LENGTH) {
+		HTTP_LOGE("Error: Wrong request line\n");
+		return HTTP_ERROR;
+	}
+
+	memset(client->url, 0, sizeof(client->url));
+	if (http_separate_header(line, &method, client->url, &parser->version) != HTTP_OK || method == HTTP_METHOD_UNKNOWN) {
+		return HTTP_ERROR;
+	}
+
+	HTTP_LOGD("Request Method : %d URI : %s Protocol : %d\n", method, client->url, parser->version);
+
+	/* HTTP/1.1 connections are persistent unless told otherwise */
+	client->keep_alive = (parser->version == HTTP_HTTP_VERSION_11);
 	client->ws_state = 0;
 
-	buf = HTTP_MALLOC(HTTP_CONF_MAX_REQUEST_LENGTH);
-	if (buf == NULL) {
-		HTTP_LOGE("Error: Fail to malloc buf\n");
-		close(client->client_fd);
+	client->req.req_msg = client->buf;
+	client->req.method = method;
+	client->req.client_ip = client->client_ip;
+	client->req.url = client->url;
+	client->req.headers = &client->req_headers;
+	client->req.entity = NULL;
+	client->req.query_string = NULL;
+	client->req.encoding = HTTP_CONTENT_LENGTH;
+
+	return http_keyvalue_list_init(&client->req_headers);
+}
+
+static int http_request_header(struct http_client_t *client, char *line)
+{
+	char key[HTTP_CONF_MAX_KEY_LENGTH];
+	char value[HTTP_CONF_MAX_VALUE_LENGTH];
+	char *colon = strchr(line, ':');
+
+	/* Skip what does not fit, http_separate_keyvalue() does not check */
+	if (colon == NULL || colon - line >= HTTP_CONF_MAX_KEY_LENGTH || strlen(colon) > HTTP_CONF_MAX_VALUE_LENGTH) {
+		HTTP_LOGD("Skip header : %s\n", line);
+		return HTTP_OK;
+	}
+
+	http_separate_keyvalue(line, key, value);
+	HTTP_LOGD("[HTTP Parameter] Key: %s / Value: %s\n", key, value);
+	http_keyvalue_list_add(&client->req_headers, key, value);
+
+	if (strcasecmp(key, "Connection") == 0) {
+		if (strcasecmp(value, "close") == 0) {
+			client->keep_alive = 0;
+		} else if (strcasecmp(value, "keep-alive") == 0) {
+			client->keep_alive = 1;
+		} else if (strcasecmp(value, "Upgrade") == 0) {
+			++client->ws_state;
+		}
+	} else if (strcasecmp(key, "Upgrade") == 0 && strcasecmp(value, "websocket") == 0) {
+		++client->ws_state;
+	} else if (strcasecmp(key, "Sec-WebSocket-Key") == 0) {
+		strncpy((char *)client->ws_key, value, WEBSOCKET_CLIENT_KEY_LEN);
+	} else if (strcasecmp(key, "Content-Length") == 0) {
+		client->parser.content_len = HTTP_ATOI(value);
+		if (client->parser.content_len < 0) {
+			return HTTP_ERROR;
+		}
+	} else if (strcasecmp(key, "Transfer-Encoding") == 0 && strcasecmp(value, "chunked") == 0) {
+		client->req.encoding = HTTP_CHUNKED_ENCODING;
+	}
+
+	return HTTP_OK;
+}
+
+/*
+ * Dispatch a complete request, or with chunked encoding a complete chunk,
+ * whose entity is entity_len bytes at the given offset of the buffer.
+ */
+static void http_request_dispatch(struct http_client_t *client, int entity, int entity_len)
+{
+	char saved = client->buf[entity + entity_len];
+
+	client->buf[entity + entity_len] = '\0';
+	client->req.entity = client->buf + entity;
+	http_dispatch_url(client, &client->req);
+	client->req.url = client->url;
+	client->buf[entity + entity_len] = saved;
+}
+
+/*
+ * Parse what has been received and dispatch the complete requests in it.
+ * Pipelined requests are handled in order; a partial request stays in the
+ * buffer until more data is received.
+ */
+static int http_request_process(struct http_client_t *client)
+{
+	struct http_request_parser_t *parser = &client->parser;
+	char *line;
+	int end;
+
+	for (;;) {
+		switch (parser->state) {
+		case HTTP_PARSE_REQUEST_LINE:
+			line = http_request_next_line(client);
+			if (line == NULL) {
+				return HTTP_CLIENT_KEEP;
+			}
+			if (*line == '\0') {
+				/* Tolerate empty lines between requests */
+				break;
+			}
+			if (http_request_line(client, line) != HTTP_OK) {
+				return HTTP_CLIENT_CLOSE;
+			}
+			parser->content_len = 0;
+			parser->state = HTTP_PARSE_HEADERS;
+			break;
+
+		case HTTP_PARSE_HEADERS:
+			line = http_request_next_line(client);
+			if (line == NULL) {
+				return HTTP_CLIENT_KEEP;
+			}
+			if (*line != '\0') {
+				if (http_request_header(client, line) != HTTP_OK) {
+					return HTTP_CLIENT_CLOSE;
+				}
+				break;
+			}
+			parser->body = parser->line;
+			if (client->req.encoding == HTTP_CHUNKED_ENCODING) {
+				parser->state = HTTP_PARSE_CHUNK_SIZE;
+			} else {
+				parser->state = HTTP_PARSE_BODY;
+			}
+			break;
+
+		case HTTP_PARSE_BODY:
+			end = parser->body + parser->content_len;
+			if (end > HTTP_CONF_MAX_REQUEST_LENGTH) {
+				HTTP_LOGE("Error: Request size is too large!!\n");
+				return HTTP_CLIENT_CLOSE;
+			}
+			if (client->buf_len < end) {
+				return HTTP_CLIENT_KEEP;
+			}
+			if (parser->content_len > 0 || client->req.method == HTTP_METHOD_POST || client->req.method == HTTP_METHOD_PUT) {
+				http_request_dispatch(client, parser->body, parser->content_len);
+			} else {
+				client->req.entity = NULL;
+				http_dispatch_url(client, &client->req);
+				client->req.url = client->url;
+			}
+			goto request_done;
+
+		case HTTP_PARSE_CHUNK_SIZE:
+			line = http_request_next_line(client);
+			if (line == NULL) {
+				return HTTP_CLIENT_KEEP;
+			}
+			parser->chunk_len = (int)strtol(line, NULL, 16);
+			if (parser->chunk_len < 0) {
+				return HTTP_CLIENT_CLOSE;
+			}
+			parser->state = parser->chunk_len ? HTTP_PARSE_CHUNK_DATA : HTTP_PARSE_CHUNK_TRAILER;
+			break;
+
+		case HTTP_PARSE_CHUNK_DATA:
+			end = parser->line + parser->chunk_len + 2;
+			if (end > HTTP_CONF_MAX_REQUEST_LENGTH) {
+				HTTP_LOGE("Error: Chunk size is too large!!\n");
+				return HTTP_CLIENT_CLOSE;
+			}
+			if (client->buf_len < end) {
+				return HTTP_CLIENT_KEEP;
+			}
+			http_request_dispatch(client, parser->line, parser->chunk_len);
+
+			/* Drop the chunk, the request head stays in place */
+			memmove(client->buf + parser->body, client->buf + end, client->buf_len - end);
+			client->buf_len -= end - parser->body;
+			parser->line = parser->body;
+			parser->scan = parser->body;
+			parser->state = HTTP_PARSE_CHUNK_SIZE;
+			break;
+
+		case HTTP_PARSE_CHUNK_TRAILER:
+			line = http_request_next_line(client);
+			if (line == NULL) {
+				return HTTP_CLIENT_KEEP;
+			}
+			if (*line != '\0') {
+				break;
+			}
+			/* The last call has an empty entity, as it always had */
+			http_request_dispatch(client, parser->line - 2, 0);
+			end = parser->line;
+			goto request_done;
+		}
+		continue;
+
+request_done:
+		http_keyvalue_list_release(&client->req_headers);
+		HTTP_MEMSET(&client->req_headers, 0, sizeof(client->req_headers));
+
+		if (client->ws_state >= MIN_WS_HEADER_FIELD) {
+			return HTTP_CLIENT_DETACH;
+		}
+		if (!client->keep_alive) {
+			return HTTP_CLIENT_CLOSE;
+		}
+
+		/* Keep what follows: the next pipelined request */
+		client->buf_len -= end;
+		memmove(client->buf, client->buf + end, client->buf_len);
+		HTTP_MEMSET(parser, 0, sizeof(struct http_request_parser_t));
+	}
+}
+
+#ifdef CONFIG_NETUTILS_WEBSOCKET
+static int http_client_upgrade(struct http_client_t *client)
+{
+	websocket_t *ws = NULL;
+	int flags;
+
+	ws = websocket_find_table();
+	if (ws == NULL) {
+		return HTTP_ERROR;
+	}
+
+	/* The websocket thread expects a blocking socket */
+	flags = fcntl(client->client_fd, F_GETFL, 0);
+	if (flags < 0 || fcntl(client->client_fd, F_SETFL, flags & ~O_NONBLOCK) < 0) {
+		return HTTP_ERROR;
+	}
+	memset(ws, 0, sizeof(websocket_t));
+	ws->fd = client->client_fd;
+	ws->cb = &client->server->ws_cb;
+#ifdef CONFIG_NET_SECURITY_TLS
+	if (client->server->tls_init) {
+		ws->tls_enabled = 1;
+		ws->tls_net.fd = client->tls_client_fd.fd;
+		ws->tls_ssl = (mbedtls_ssl_context *)malloc(sizeof(mbedtls_ssl_context));
+		memcpy(ws->tls_ssl, &client->tls_ssl, sizeof(mbedtls_ssl_context));
+		ws->tls_conf = &client->server->tls_conf;
+		mbedtls_ssl_set_bio(ws->tls_ssl, &ws->tls_net, mbedtls_net_send, mbedtls_net_recv, NULL);
+	}
+#endif
+	pthread_attr_init(&ws->thread_attr);
+	pthread_attr_setstacksize(&ws->thread_attr, WEBSOCKET_STACKSIZE);
+	pthread_attr_setschedpolicy(&ws->thread_attr, SCHED_RR);
+	if (pthread_create(&ws->thread_id, &ws->thread_attr,
+					   (pthread_startroutine_t)websocket_server_init,
+					   (pthread_addr_t)ws) != 0) {
+		HTTP_LOGE("Error: Cannot create websocket thread!!\n");
 		return HTTP_ERROR;
 	}
+	pthread_setname_np(ws->thread_id, "websocket handle server");
+	pthread_detach(ws->thread_id);
 
-	if (getpeername(client->client_fd, (struct sockaddr *)&addr, &addr_len) < 0) {
-		HTTP_LOGE("Error: Fail to getpeername\n");
-		goto errout;
+	return HTTP_OK;
+}
+#endif
+
+/*
+ * Close or hand over the connection only once the responses to it are
+ * sent; until then the event loop keeps it and waits for POLLOUT.
+ */
+static int http_client_finish(struct http_client_t *client, int ret)
+{
+	if (client->out_len > 0) {
+		client->out_result = ret;
+		return HTTP_CLIENT_KEEP;
+	}
+#ifdef CONFIG_NETUTILS_WEBSOCKET
+	if (ret == HTTP_CLIENT_DETACH && http_client_upgrade(client) != HTTP_OK) {
+		ret = HTTP_CLIENT_CLOSE;
+	}
+#endif
+	return ret;
+}
+
+/*
+ * Called by the event loop of the server when the socket is readable.
+ * Never waits for more data: a request received partially is kept in the
+ * buffer of the connection until the rest comes in.
+ */
+int http_client_receive(struct http_client_t *client)
+{
+	int len;
+	int ret;
+
+	if (client->buf == NULL) {
+		/* One more byte to NUL terminate the entity */
+		client->buf = HTTP_MALLOC(HTTP_CONF_MAX_REQUEST_LENGTH + 1);
+		if (client->buf == NULL) {
+			HTTP_LOGE("Error: Fail to malloc buf\n");
+			return HTTP_CLIENT_CLOSE;
+		}
+		client->buf_len = 0;
+		HTTP_MEMSET(&client->parser, 0, sizeof(struct http_request_parser_t));
+	}
+
+#ifdef CONFIG_NET_SECURITY_TLS
+	if (client->tls_handshaking) {
+		if (http_client_tls_handshake(client) != HTTP_OK) {
+			return HTTP_CLIENT_CLOSE;
+		}
+		if (client->tls_handshaking) {
+			return HTTP_CLIENT_KEEP;
+		}
+		/* Done, the first request may have come with the last flight */
 	}
-	req.req_msg = buf;
-	req.url = url;
-	req.headers = request_params;
-	req.client_ip = addr.sin_addr.s_addr;
+#endif
 
-	while (!read_finish) {
-		if (remain <= 0) {
+	do {
+		if (client->buf_len >= HTTP_CONF_MAX_REQUEST_LENGTH) {
 			HTTP_LOGE("Error: Request size is too large!!\n");
-			goto errout;
+			return HTTP_CLIENT_CLOSE;
 		}
 #ifdef CONFIG_NET_SECURITY_TLS
 		if (client->server->tls_init) {
-			len = mbedtls_ssl_read(&(client->tls_ssl), (unsigned char *)buf + buf_len, HTTP_CONF_MAX_REQUEST_LENGTH - buf_len);
+			len = mbedtls_ssl_read(&(client->tls_ssl), (unsigned char *)client->buf + client->buf_len, HTTP_CONF_MAX_REQUEST_LENGTH - client->buf_len);
+			if (len == MBEDTLS_ERR_SSL_WANT_READ || len == MBEDTLS_ERR_SSL_WANT_WRITE) {
+				break;
+			}
 		} else
 #endif
 		{
-			len = recv(client->client_fd, buf + buf_len, HTTP_CONF_MAX_REQUEST_LENGTH - buf_len, 0);
+			len = recv(client->client_fd, client->buf + client->buf_len, HTTP_CONF_MAX_REQUEST_LENGTH - client->buf_len, MSG_DONTWAIT);
+			if (len < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+				break;
+			}
 		}
 		if (len < 0) {
 			HTTP_LOGE("Error: Receive Fail %d\n", len);
-			goto errout;
+			return HTTP_CLIENT_CLOSE;
 		} else if (len == 0) {
 			HTTP_LOGD("Finish read\n");
-			goto errout;
+			return HTTP_CLIENT_CLOSE;
 		}
-		buf_len += len;
-		remain -= len;
+		client->buf_len += len;
+		client->last_active = http_client_clock();
 
-		read_finish = http_parse_message(buf, len, &method, url, &body, &enc, &state, &mlen, request_params, client, NULL, &req);
-		if (read_finish == HTTP_ERROR) {
-			goto errout;
+		ret = http_request_process(client);
+		if (ret != HTTP_CLIENT_KEEP) {
+			return http_client_finish(client, ret);
 		}
-	}
-	if (method == HTTP_METHOD_UNKNOWN) {
-		goto errout;
-	}
-
-	if (enc == HTTP_CONTENT_LENGTH) {
-		req.entity = body;
-		http_dispatch_url(client, &req);
-	}
-
-#ifdef CONFIG_NETUTILS_WEBSOCKET
-	/* open websocket */
-	if (client->ws_state >= MIN_WS_HEADER_FIELD) {
-		websocket_t *ws = NULL;
-		ws = websocket_find_table();
-		if (ws == NULL) {
-			goto errout;
-		}
-		memset(ws, 0, sizeof(websocket_t));
-		ws->fd = client->client_fd;
-		ws->cb = &client->server->ws_cb;
 #ifdef CONFIG_NET_SECURITY_TLS
-		if (client->server->tls_init) {
-			ws->tls_enabled = 1;
-			ws->tls_net.fd = client->tls_client_fd.fd;
-			ws->tls_ssl = (mbedtls_ssl_context *)malloc(sizeof(mbedtls_ssl_context));
-			memcpy(ws->tls_ssl, &client->tls_ssl, sizeof(mbedtls_ssl_context));
-			ws->tls_conf = &client->server->tls_conf;
-			mbedtls_ssl_set_bio(ws->tls_ssl, &ws->tls_net, mbedtls_net_send, mbedtls_net_recv, NULL);
-		}
-#endif
-		pthread_attr_init(&ws->thread_attr);
-		pthread_attr_setstacksize(&ws->thread_attr, WEBSOCKET_STACKSIZE);
-		pthread_attr_setschedpolicy(&ws->thread_attr, SCHED_RR);
-		if (pthread_create(&ws->thread_id, &ws->thread_attr,
-						   (pthread_startroutine_t)websocket_server_init,
-						   (pthread_addr_t)ws) != 0) {
-			HTTP_LOGE("Error: Cannot create websocket thread!!\n");
-			goto errout;
-		}
-		pthread_setname_np(ws->thread_id, "websocket handle server");
-		pthread_detach(ws->thread_id);
-	} else
+		/* Records already decrypted do not make the socket readable */
+	} while (client->server->tls_init && mbedtls_ssl_get_bytes_avail(&(client->tls_ssl)) > 0);
+#else
+	} while (0);
 #endif
-	{
-		close(client->client_fd);
-	}
 
-	HTTP_FREE(buf);
-	if (enc == HTTP_CHUNKED_ENCODING) {
-		HTTP_FREE(body);
-	}
-	return HTTP_OK;
-errout:
-	close(client->client_fd);
-	HTTP_FREE(buf);
-	if (enc == HTTP_CHUNKED_ENCODING) {
-		HTTP_FREE(body);
+	if (client->buf_len == 0) {
+		/* Nothing pending, do not hold the buffer while idle */
+		HTTP_FREE(client->buf);
+		client->buf = NULL;
 	}
-	return HTTP_ERROR;
+
+	return HTTP_CLIENT_KEEP;
 }
 
 void http_handle_file(struct http_client_t *client, int method, const char *url, char *entity)
@@ -562,10 +769,141 @@ void http_handle_file(struct http_client_t *client, int method, const char *url,
 	}
 }
 
+/*
+ * Write as much of data as the non-blocking socket takes without waiting.
+ * Returns the number of bytes written, or -1 when the connection failed.
+ */
+static int http_client_write(struct http_client_t *client, const char *data, int len)
+{
+	int sent = 0;
+	int ret;
+
+	while (sent < len) {
+#ifdef CONFIG_NET_SECURITY_TLS
+		if (client->server->tls_init) {
+			/* A record that could not be sent is retried with the same length */
+			if (client->tls_write_len == 0) {
+				client->tls_write_len = len - sent;
+			}
+			ret = mbedtls_ssl_write(&(client->tls_ssl), (const unsigned char *)data + sent, client->tls_write_len);
+			if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+				break;
+			}
+			client->tls_write_len = 0;
+		} else
+#endif
+		{
+			ret = send(client->client_fd, data + sent, len - sent, 0);
+			if (ret < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+				break;
+			}
+		}
+
+		if (ret < 0) {
+			HTTP_LOGE("Error: Send Fail %d\n", ret);
+			return -1;
+		}
+		sent += ret;
+	}
+
+	return sent;
+}
+
+/*
+ * Send data to the client, or keep what the socket has no room for until
+ * the event loop sees POLLOUT. Once something is kept, later data goes
+ * behind it so that responses are not interleaved.
+ */
+static int http_client_send(struct http_client_t *client, const char *data, int len)
+{
+	char *out;
+	int pending;
+	int ret;
+
+	if (client->out_len == 0) {
+		ret = http_client_write(client, data, len);
+		if (ret < 0) {
+			return HTTP_ERROR;
+		}
+		data += ret;
+		len -= ret;
+		if (len == 0) {
+			return HTTP_OK;
+		}
+	}
+
+	pending = client->out_len - client->out_sent;
+	out = HTTP_MALLOC(pending + len);
+	if (out == NULL) {
+		HTTP_LOGE("Error: Fail to malloc send buffer\n");
+		return HTTP_ERROR;
+	}
+	if (pending > 0) {
+		HTTP_MEMCPY(out, client->out + client->out_sent, pending);
+		HTTP_FREE(client->out);
+	}
+	HTTP_MEMCPY(out + pending, data, len);
+	client->out = out;
+	client->out_len = pending + len;
+	client->out_sent = 0;
+
+	return HTTP_OK;
+}
+
+/*
+ * Called by the event loop of the server when the socket of a client with
+ * responses pending is writable.
+ */
+int http_client_resume(struct http_client_t *client)
+{
+	int ret;
+
+	ret = http_client_write(client, client->out + client->out_sent, client->out_len - client->out_sent);
+	if (ret < 0) {
+		return HTTP_CLIENT_CLOSE;
+	}
+	if (ret > 0) {
+		client->last_active = http_client_clock();
+	}
+
+	client->out_sent += ret;
+	if (client->out_sent < client->out_len) {
+		return HTTP_CLIENT_KEEP;
+	}
+	HTTP_FREE(client->out);
+	client->out = NULL;
+	client->out_len = 0;
+	client->out_sent = 0;
+
+	ret = client->out_result;
+	client->out_result = HTTP_CLIENT_KEEP;
+	return http_client_finish(client, ret);
+}
+
+/* Append to the head of a response, never past the end of the buffer */
+static void http_response_printf(char *buf, int *buflen, const char *fmt, ...)
+{
+	va_list ap;
+	int len;
+
+	if (*buflen >= HTTP_CONF_MAX_REQUEST_LENGTH) {
+		return;
+	}
+
+	va_start(ap, fmt);
+	len = vsnprintf(buf + *buflen, HTTP_CONF_MAX_REQUEST_LENGTH - *buflen, fmt, ap);
+	va_end(ap);
+
+	if (len > 0) {
+		/* Goes past the buffer size when it did not fit */
+		*buflen += len;
+	}
+}
+
 int http_send_response(struct http_client_t *client, int status, const char *body, struct http_keyvalue_list_t *headers)
 {
 	char *buf;
-	int buflen = 0, ret, sndlen;
+	int buflen = 0, bodylen = 0, ret;
 	struct http_keyvalue_t *cur = NULL;
 
 	buf = HTTP_MALLOC(HTTP_CONF_MAX_REQUEST_LENGTH);
@@ -577,70 +915,75 @@ int http_send_response(struct http_client_t *client, int status, const char *bod
 	if (client->ws_state >= MIN_WS_HEADER_FIELD) {
 		unsigned char accept_key[WEBSOCKET_ACCEPT_KEY_LEN] = {0, };
 		websocket_create_accept_key(accept_key, WEBSOCKET_ACCEPT_KEY_LEN, client->ws_key, WEBSOCKET_CLIENT_KEY_LEN);
-		buflen = snprintf(buf, HTTP_CONF_MAX_REQUEST_LENGTH,
-						  "HTTP/1.1 101 Switching Protocols\r\n"
-						  "Upgrade: websocket\r\n"
-						  "Connection: Upgrade\r\n"
-						  "Sec-WebSocket-Accept: %s\r\n\r\n",
-						  accept_key);
+		http_response_printf(buf, &buflen,
+							 "HTTP/1.1 101 Switching Protocols\r\n"
+							 "Upgrade: websocket\r\n"
+							 "Connection: Upgrade\r\n"
+							 "Sec-WebSocket-Accept: %s\r\n\r\n",
+							 accept_key);
 	} else
 #endif
 	{
-		buflen = snprintf(buf, HTTP_CONF_MAX_REQUEST_LENGTH, "HTTP/1.1 %d %s\r\n",
-						  status, (status == 200) ? "OK" : body);
+		int has_connection = 0;
+		int has_length = 0;
+
+		if (status == 200 && body) {
+			bodylen = (int)strlen(body);
+		}
+
+		http_response_printf(buf, &buflen, "HTTP/1.1 %d %s\r\n",
+							 status, (status == 200) ? "OK" : body);
 		if (headers) {
 			cur = headers->head->next;
 			while (cur != headers->tail) {
-				buflen += snprintf(buf + buflen, HTTP_CONF_MAX_REQUEST_LENGTH - buflen,
-								   "%s: %s\r\n", cur->key, cur->value);
+				http_response_printf(buf, &buflen, "%s: %s\r\n", cur->key, cur->value);
+				if (strcasecmp(cur->key, "Connection") == 0) {
+					has_connection = 1;
+					if (strcasecmp(cur->value, "close") == 0) {
+						client->keep_alive = 0;
+					}
+				} else if (strcasecmp(cur->key, "Content-Length") == 0) {
+					has_length = 1;
+				}
 				cur = cur->next;
 			}
+		} else if (status == 200) {
+			http_response_printf(buf, &buflen, "Content-type: text/html\r\n");
 		}
 
-		if (status == 200) {
-			if (headers == NULL) {
-				buflen += snprintf(buf + buflen, HTTP_CONF_MAX_REQUEST_LENGTH - buflen,
-								   "Content-type: text/html\r\n"
-								   "Connection: close\r\n");
-				if (body) {
-					buflen += snprintf(buf + buflen,
-									   HTTP_CONF_MAX_REQUEST_LENGTH - buflen,
-									   "Content-Length: %d\r\n"
-									   "\r\n"
-									   "%s",
-									   strlen(body), body);
-				} else {
-					buflen += snprintf(buf + buflen,
-									   HTTP_CONF_MAX_REQUEST_LENGTH - buflen,
-									   "\r\n");
-				}
-			} else {
-				snprintf(buf + buflen, HTTP_CONF_MAX_REQUEST_LENGTH - buflen,
-						 "\r\n%s", body);
-			}
+		/* The connection is reused, so the client must know where the response ends */
+		if (!has_connection) {
+			http_response_printf(buf, &buflen, "Connection: %s\r\n", client->keep_alive ? "keep-alive" : "close");
 		}
+		if (!has_length) {
+			http_response_printf(buf, &buflen, "Content-Length: %d\r\n", bodylen);
+		}
+		http_response_printf(buf, &buflen, "\r\n");
 	}
 
-	sndlen = strlen(buf);
-	buflen = 0;
-	while (sndlen > 0) {
-#ifdef CONFIG_NET_SECURITY_TLS
-		if (client->server->tls_init) {
-			ret = mbedtls_ssl_write(&(client->tls_ssl), (unsigned char *)buf + buflen, sndlen);
-		} else
-#endif
-		{
-			ret = send(client->client_fd, buf + buflen, sndlen, 0);
-		}
+	if (buflen >= HTTP_CONF_MAX_REQUEST_LENGTH) {
+		HTTP_LOGE("Error: Response header is too large!!\n");
+		HTTP_FREE(buf);
+		client->keep_alive = 0;
+		return HTTP_ERROR;
+	}
 
-		if (ret < 1) {
-			HTTP_FREE(buf);
-			return HTTP_ERROR;
-		} else {
-			sndlen -= ret;
-			buflen += ret;
-		}
+	/* A body that does not fit behind the head is sent from where it is */
+	if (bodylen > 0 && bodylen < HTTP_CONF_MAX_REQUEST_LENGTH - buflen) {
+		HTTP_MEMCPY(buf + buflen, body, bodylen);
+		buflen += bodylen;
+		bodylen = 0;
+	}
+
+	ret = http_client_send(client, buf, buflen);
+	if (ret == HTTP_OK && bodylen > 0) {
+		ret = http_client_send(client, body, bodylen);
 	}
 	HTTP_FREE(buf);
-	return HTTP_OK;
+
+	if (ret != HTTP_OK) {
+		/* The response is incomplete, the connection cannot be reused */
+		client->keep_alive = 0;
+	}
+	return ret;
 }
@@ -19,7 +19,9 @@
 #ifndef __http_client_h__
 #define __http_client_h__
 
+#include <time.h>
 #include <apps/netutils/webserver/http_server.h>
+#include <apps/netutils/webserver/http_keyvalue_list.h>
 #include <apps/netutils/webclient.h>
 #include <apps/netutils/websocket.h>
 
@@ -40,15 +42,65 @@ enum {
 	HTTP_REQUEST_HEADER, HTTP_REQUEST_PARAMETERS, HTTP_REQUEST_BODY
 };
 
+/* States of the incremental request parser of the server */
+enum {
+	HTTP_PARSE_REQUEST_LINE,
+	HTTP_PARSE_HEADERS,
+	HTTP_PARSE_BODY,
+	HTTP_PARSE_CHUNK_SIZE,
+	HTTP_PARSE_CHUNK_DATA,
+	HTTP_PARSE_CHUNK_TRAILER,
+};
+
+/* Headers a websocket upgrade request carries */
+#define MIN_WS_HEADER_FIELD 2
+
+/* Results of handling the received data of a connection */
+#define HTTP_CLIENT_KEEP     0	/* Wait for more requests */
+#define HTTP_CLIENT_CLOSE    1	/* Close the connection */
+#define HTTP_CLIENT_DETACH   2	/* Upgraded, the socket is not ours anymore */
+
+/*
+ * Parser state is kept as offsets into the receive buffer, so that every
+ * byte is scanned once however the request is split into segments.
+ */
+struct http_request_parser_t {
+	int state;
+	int line;					/* Start of the current line */
+	int scan;					/* Bytes of the current line already scanned */
+	int body;					/* Start of the body */
+	int content_len;
+	int chunk_len;
+	int version;
+};
+
 struct http_client_t {
 	int client_fd;
 	struct http_server_t *server;
 	int ws_state;
 	unsigned char ws_key[WEBSOCKET_CLIENT_KEY_LEN];
 
+	/* Connection state, owned by the event loop of the server */
+	uint32_t client_ip;
+	unsigned int last_active;	/* msec, see http_client_clock() */
+	int keep_alive;
+	char *buf;					/* Receive buffer, allocated while a request is pending */
+	int buf_len;
+	struct http_request_parser_t parser;
+	struct http_req_message req;
+	struct http_keyvalue_list_t req_headers;
+	char url[HTTP_CONF_MAX_REQUEST_HEADER_URL_LENGTH];
+	char *out;					/* Response bytes the socket had no room for */
+	int out_len;
+	int out_sent;
+	int out_result;				/* What to do with the connection once out is sent */
+
 #ifdef CONFIG_NET_SECURITY_TLS
 	mbedtls_ssl_context       tls_ssl;
 	mbedtls_net_context       tls_client_fd;
+	int tls_handshaking;		/* The handshake is not complete yet */
+	int tls_want_write;			/* The handshake waits for room to send */
+	int tls_write_len;			/* Length of a record write to be retried */
 #endif
 };
 
@@ -60,9 +112,10 @@ struct http_message_len_t {
 	int content_len;
 };
 
-int   http_accept_client(struct http_server_t *server);
 void  http_close_client(struct http_client_t *client);
-void *http_handle_client(void *arg /* struct http_client_t *client */);
+int   http_client_receive(struct http_client_t *client);
+int   http_client_resume(struct http_client_t *client);
+unsigned int http_client_clock(void);
 
 struct http_client_t *http_client_init(struct http_server_t *server, int sock_fd);
 int   http_client_release(struct http_client_t *client);
@@ -74,10 +127,10 @@ int http_parse_message(char *buf, int buf_len, int *method, char *url,
 					   struct http_client_t *client,
 					   struct http_client_response_t *response,
 					   struct http_req_message *req);
-int   http_recv_and_handle_request(struct http_client_t *client, struct http_keyvalue_list_t *request_params);
 
 #ifdef CONFIG_NET_SECURITY_TLS
 int   http_client_tls_init(struct http_client_t *client);
+int   http_client_tls_handshake(struct http_client_t *client);
 int   http_client_tls_release(struct http_client_t *client);
 int   http_server_tls_release(struct http_server_t *server);
 #endif
@@ -42,16 +42,33 @@ int http_client_tls_init(struct http_client_t *client)
 	mbedtls_ssl_set_bio(&(client->tls_ssl), &(client->tls_client_fd),
 						mbedtls_net_send, mbedtls_net_recv, NULL);
 
-	/* Handshake */
+	/* The handshake goes on from the event loop as the client's data comes in */
 	HTTP_LOGD("  . Performing the SSL/TLS handshake...");
+	client->tls_handshaking = 1;
 
-	while ((result = mbedtls_ssl_handshake(&(client->tls_ssl))) != 0) {
-		if (result != MBEDTLS_ERR_SSL_WANT_READ && result != MBEDTLS_ERR_SSL_WANT_WRITE) {
-			HTTP_LOGE("Error: mbedtls_ssl_handshake returned %d\n", result);
-			return HTTP_ERROR;
-		}
+	return http_client_tls_handshake(client);
+}
+
+/*
+ * Advance the handshake as far as the data received allows, without
+ * waiting: the socket is non-blocking. tls_handshaking stays set until it
+ * is complete and tls_want_write tells the event loop to wait for room in
+ * the send buffer rather than for data.
+ */
+int http_client_tls_handshake(struct http_client_t *client)
+{
+	int result = mbedtls_ssl_handshake(&(client->tls_ssl));
+
+	client->tls_want_write = (result == MBEDTLS_ERR_SSL_WANT_WRITE);
+	if (result == MBEDTLS_ERR_SSL_WANT_READ || result == MBEDTLS_ERR_SSL_WANT_WRITE) {
+		return HTTP_OK;
+	}
+	if (result != 0) {
+		HTTP_LOGE("Error: mbedtls_ssl_handshake returned %d\n", result);
+		return HTTP_ERROR;
 	}
 
+	client->tls_handshaking = 0;
 	HTTP_LOGD("Ok\n");
 
 	return HTTP_OK;
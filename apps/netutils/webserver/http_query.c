@@ -29,101 +29,215 @@
 #include "http_arch.h"
 #include "http_log.h"
 
-static int http_compare_dq(struct http_divided_query_t *src, struct http_divided_query_t *dest, struct http_keyvalue_list_t *params_list)
+/*
+ * Routes are kept in a trie of path segments, so that dispatching a request
+ * costs one step per segment of its url instead of a comparison with every
+ * registered url. A segment starting with ':' (such as ':id') matches any
+ * segment; exact segments are preferred over it.
+ */
+
+static int http_split_query(char *query, char **segs)
 {
-	int i = 0;
+	int count = 0;
+	char *p = query;
 
-	if (src->slash_count == dest->slash_count) {
-		bool same = true;
-		for (i = 0; i < src->slash_count; i++) {
-			char *src_path = src->paths + (i * HTTP_CONF_MAX_DIVIDED_PATH_LENGTH);
-			char *dest_path = dest->paths + (i * HTTP_CONF_MAX_DIVIDED_PATH_LENGTH);
-
-			if (strcmp(src_path, dest_path) != 0) {
-				/*
-				 * Consider variable string such as ':id', ':num'
-				 */
-				if (src_path[1] != ':' && dest_path[1] != ':') {
-					same = false;
-					break;
-				} else {
-					if (params_list) {
-						if (src_path[1] == ':') {
-							HTTP_LOGD("Add Parameter : [%s: %s]\n", src_path + 2, dest_path + 1);
-							http_keyvalue_list_add(params_list, src_path + 2, dest_path + 1);
-						} else if (dest_path[1] == ':') {
-							HTTP_LOGD("Add Parameter : [%s: %s]\n", dest_path + 2, src_path + 1);
-							http_keyvalue_list_add(params_list, dest_path + 2, src_path + 1);
-						}
-					}
-				}
-			}
+	while (*p == '/') {
+		p++;
+	}
+
+	while (*p != '\0') {
+		if (count == HTTP_CONF_MAX_SLASH_COUNT) {
+			return HTTP_ERROR;
+		}
+		segs[count++] = p;
+		while (*p != '\0' && *p != '/') {
+			p++;
+		}
+		while (*p == '/') {
+			*p++ = '\0';
 		}
+	}
+
+	return count;
+}
 
-		if (same) {
-			return HTTP_OK;
+static struct http_route_t *http_route_alloc(const char *segment)
+{
+	int len = strlen(segment);
+	struct http_route_t *node = (struct http_route_t *)HTTP_MALLOC(sizeof(struct http_route_t) + len);
+
+	if (node) {
+		HTTP_MEMSET(node, 0, sizeof(struct http_route_t));
+		HTTP_MEMCPY(node->segment, segment, len + 1);
+	}
+
+	return node;
+}
+
+static struct http_route_t *http_route_child(struct http_route_t *node, const char *segment, int create)
+{
+	struct http_route_t **link;
+
+	if (segment[0] == ':') {
+		/* One variable child per node, whatever its name */
+		link = &node->param;
+		if (*link == NULL && create) {
+			*link = http_route_alloc(segment);
 		}
+		return *link;
+	}
+
+	for (link = &node->child; *link; link = &(*link)->sibling) {
+		if (strcmp((*link)->segment, segment) == 0) {
+			return *link;
+		}
+	}
+
+	if (create) {
+		*link = http_route_alloc(segment);
+	}
+
+	return *link;
+}
+
+static struct http_route_t *http_route_find(struct http_route_t *node, char **segs, int count, int method)
+{
+	struct http_route_t *found;
+	struct http_route_t *child;
+
+	if (count == 0) {
+		return node->func[method] ? node : NULL;
+	}
+
+	for (child = node->child; child; child = child->sibling) {
+		if (strcmp(child->segment, segs[0]) == 0) {
+			found = http_route_find(child, segs + 1, count - 1, method);
+			if (found) {
+				return found;
+			}
+			break;
+		}
+	}
+
+	if (node->param) {
+		return http_route_find(node->param, segs + 1, count - 1, method);
+	}
+
+	return NULL;
+}
+
+static struct http_route_t *http_route_lookup(struct http_server_t *server, const char *url_format, int create)
+{
+	char query[HTTP_CONF_MAX_URL_QUERY_LENGTH];
+	char *segs[HTTP_CONF_MAX_SLASH_COUNT];
+	struct http_route_t *node;
+	int count;
+	int i;
+
+	if (strlen(url_format) >= HTTP_CONF_MAX_URL_QUERY_LENGTH) {
+		return NULL;
+	}
+	strncpy(query, url_format, HTTP_CONF_MAX_URL_QUERY_LENGTH);
+
+	count = http_split_query(query, segs);
+	if (count < 0) {
+		return NULL;
+	}
+
+	if (server->routes == NULL && create) {
+		server->routes = http_route_alloc("");
+	}
+
+	node = server->routes;
+	for (i = 0; i < count && node; i++) {
+		node = http_route_child(node, segs[i], create);
+	}
+
+	return node;
+}
+
+static void http_route_free(struct http_route_t *node)
+{
+	struct http_route_t *next;
+
+	while (node) {
+		next = node->sibling;
+		http_route_free(node->child);
+		http_route_free(node->param);
+		HTTP_FREE(node);
+		node = next;
 	}
+}
 
-	return HTTP_ERROR;
+void http_route_release(struct http_server_t *server)
+{
+	http_route_free(server->routes);
+	server->routes = NULL;
+}
+
+/*
+ * Answer a request that no handler takes, so that a client keeping the
+ * connection open does not wait for a response. Chunked requests are
+ * dispatched once per chunk and are answered on the last, empty one.
+ */
+static void http_dispatch_error(struct http_client_t *client, struct http_req_message *req, int status, const char *phrase)
+{
+	if (client->ws_state >= MIN_WS_HEADER_FIELD) {
+		return;
+	}
+	if (req->encoding == HTTP_CHUNKED_ENCODING && req->entity && *req->entity != '\0') {
+		return;
+	}
+	if (http_send_response(client, status, phrase, NULL) == HTTP_ERROR) {
+		HTTP_LOGE("Error: Fail to send response\n");
+	}
 }
 
 int http_dispatch_url(struct http_client_t *client, struct http_req_message *req)
 {
-	int i = 0;
 	char query[HTTP_CONF_MAX_URL_QUERY_LENGTH] = {0, };
 	char params[HTTP_CONF_MAX_URL_PARAMS_LENGTH] = {0, };
-	struct http_divided_query_t dq;
-	struct http_keyvalue_list_t params_list;
+	char path[HTTP_CONF_MAX_URL_QUERY_LENGTH];
+	char *segs[HTTP_CONF_MAX_SLASH_COUNT];
+	struct http_route_t *route = NULL;
 	char *origin_url = req->url;
+	int count;
 
-	if (http_divide_query_params(req->url, query, params)) {
+	if (req->method < HTTP_METHOD_GET || req->method > HTTP_METHOD_DELETE) {
 		return HTTP_ERROR;
 	}
-	req->url = query;
-	req->query_string = params;
 
-	http_parse_query(query, &dq);
-	if (http_keyvalue_list_init(&params_list) == HTTP_ERROR) {
-		http_keyvalue_list_release(&params_list);
-		http_release_query(&dq);
+	if (http_divide_query_params(req->url, query, params)) {
+		http_dispatch_error(client, req, 400, HTTP_ERROR_400);
 		return HTTP_ERROR;
 	}
+	req->url = query;
+	req->query_string = params;
 
-	/* Parse url params */
-	if (strlen(params) > 0) {
-		http_parse_params(params, &params_list);
-	}
-
-	for (i = 0; i < HTTP_CONF_MAX_QUERY_HANDLER_COUNT; i++) {
-		struct http_query_handler_t *cur = client->server->query_handlers[i];
-
-		if (cur) {
-			if (cur->method == req->method && http_compare_dq(&cur->dq, &dq, &params_list) == HTTP_OK) {
-				cur->func(client, req);
-				req->url = origin_url;
-				http_keyvalue_list_release(&params_list);
-				http_release_query(&dq);
-				return HTTP_OK;
-			}
+	if (client->server->routes) {
+		HTTP_MEMCPY(path, query, sizeof(path));
+		count = http_split_query(path, segs);
+		if (count >= 0) {
+			route = http_route_find(client->server->routes, segs, count, req->method);
 		}
 	}
 
-	if (client->server->cb[req->method]) {
+	if (route) {
+		route->func[req->method](client, req);
+	} else if (client->server->cb[req->method]) {
 		client->server->cb[req->method](client, req);
+	} else {
+		HTTP_LOGD("No handler for %s\n", query);
+		http_dispatch_error(client, req, 404, HTTP_ERROR_404);
 	}
 
 	req->url = origin_url;
-	http_keyvalue_list_release(&params_list);
-	http_release_query(&dq);
 	return HTTP_OK;
 }
 
 int http_server_register_cb(struct http_server_t *server, int method, const char *url_format, http_cb_t func)
 {
-	int i = 0;
-	int empty_slot = 0;
-	struct http_query_handler_t *cur = NULL;
+	struct http_route_t *node;
 
 	if (server == NULL) {
 		HTTP_LOGE("Error: Server is NULL\n");
@@ -140,42 +254,20 @@ int http_server_register_cb(struct http_server_t *server, int method, const char
 		return HTTP_OK;
 	}
 
-	/* Find empty slot */
-	for (i = 0; i < HTTP_CONF_MAX_QUERY_HANDLER_COUNT; i++) {
-		if (server->query_handlers[i] == NULL) {
-			break;
-		}
-	}
-
-	if (i == HTTP_CONF_MAX_QUERY_HANDLER_COUNT) {
-		HTTP_LOGE("Error: Not exist empty dq slot!!\n");
-		return HTTP_ERROR;
-	}
-
-	empty_slot = i;
-
-	server->query_handlers[empty_slot] = (struct http_query_handler_t *)HTTP_MALLOC(sizeof(struct http_query_handler_t));
-	if (server->query_handlers[empty_slot] == NULL) {
-		HTTP_LOGE("Error : Cannot allocate dq slot!!\n");
+	node = http_route_lookup(server, url_format, 1);
+	if (node == NULL) {
+		HTTP_LOGE("Error : Cannot allocate route for %s!!\n", url_format);
 		return HTTP_ERROR;
 	}
 
-	cur = server->query_handlers[empty_slot];
-
-	HTTP_MEMSET(cur, 0, sizeof(struct http_query_handler_t));
-
-	http_parse_query(url_format, &cur->dq);
-
-	cur->method = method;
-	cur->func = func;
+	node->func[method] = func;
 
 	return HTTP_OK;
 }
 
 int http_server_deregister_cb(struct http_server_t *server, int method, const char *url_format)
 {
-	int i = 0;
-	struct http_divided_query_t dq;
+	struct http_route_t *node;
 
 	if (server == NULL) {
 		HTTP_LOGE("Error: Server is NULL\n");
@@ -192,23 +284,14 @@ int http_server_deregister_cb(struct http_server_t *server, int method, const ch
 		return HTTP_OK;
 	}
 
-	http_parse_query(url_format, &dq);
-
-	for (i = 0; i < HTTP_CONF_MAX_QUERY_HANDLER_COUNT; i++) {
-		if (server->query_handlers[i] != NULL) {
-			if (server->query_handlers[i]->method == method &&
-				http_compare_dq(&server->query_handlers[i]->dq, &dq, NULL) == HTTP_OK) {
-				http_release_query(&server->query_handlers[i]->dq);
-				HTTP_FREE(server->query_handlers[i]);
-				server->query_handlers[i] = NULL;
-				http_release_query(&dq);
-				return HTTP_OK;
-			}
-		}
+	node = http_route_lookup(server, url_format, 0);
+	if (node == NULL || node->func[method] == NULL) {
+		return HTTP_ERROR;
 	}
 
-	http_release_query(&dq);
-	return HTTP_ERROR;
+	node->func[method] = NULL;
+
+	return HTTP_OK;
 }
 
 int http_parse_query(const char *query, struct http_divided_query_t *dq)
@@ -26,10 +26,13 @@ struct http_divided_query_t {
 	char *paths;
 };
 
-struct http_query_handler_t {
-	int method;
-	struct http_divided_query_t dq;
-	http_cb_t func;
+/* A node of the route trie, one per path segment */
+struct http_route_t {
+	struct http_route_t *sibling;	/* Next exact segment under the same parent */
+	struct http_route_t *child;		/* First exact segment below */
+	struct http_route_t *param;		/* Variable segment (':name') below */
+	http_cb_t func[HTTP_METHOD_DELETE + 1];	/* Callbacks by method */
+	char segment[1];				/* The segment, without '/' */
 };
 
 /* Pre definition */
@@ -43,5 +46,6 @@ int  http_parse_params(const char *params, struct http_keyvalue_list_t *params_l
 void http_release_query(struct http_divided_query_t *dq);
 
 int  http_dispatch_url(struct http_client_t *client, struct http_req_message *req);
+void http_route_release(struct http_server_t *server);
 
 #endif
@@ -21,6 +21,7 @@
 #include <apps/netutils/webserver/http_server.h>
 
 #include "http_client.h"
+#include "http_query.h"
 #include "http_arch.h"
 #include "http_log.h"
 
@@ -45,9 +46,7 @@ struct http_server_t *http_server_init(int port)
 	p->listen_fd = -1;
 	p->tls_init = 0;
 	p->state = HTTP_SERVER_INIT;
-
-	/* Init server query handler */
-	HTTP_MEMSET(p->query_handlers, 0, sizeof(struct http_query_handler_t *) * HTTP_CONF_MAX_QUERY_HANDLER_COUNT);
+	p->routes = NULL;
 
 	return p;
 }
@@ -66,6 +65,7 @@ void http_server_release(struct http_server_t **server)
 			http_server_tls_release(*server);
 		}
 #endif
+		http_route_release(*server);
 		HTTP_FREE(*server);
 		*server = NULL;
 	}
@@ -53,6 +53,9 @@ if [ -z ${CONFIG_IOTIVITY_RELEASE} ]; then CONFIG_IOTIVITY_RELEASE=0; fi
 CONFIG_IOTIVITY_LOGGING=`extract_flags "CONFIG_IOTIVITY_LOGGING"`
 if [ -z ${CONFIG_IOTIVITY_LOGGING} ]; then CONFIG_IOTIVITY_LOGGING=0; fi
 
+CONFIG_IOTIVITY_LOG_DEFERRED=`extract_flags "CONFIG_IOTIVITY_LOG_DEFERRED"`
+if [ -z ${CONFIG_IOTIVITY_LOG_DEFERRED} ]; then CONFIG_IOTIVITY_LOG_DEFERRED=0; fi
+
 CONFIG_ENABLE_IOTIVITY_SECURED=`extract_flags "CONFIG_ENABLE_IOTIVITY_SECURED"`
 if [ -z ${CONFIG_ENABLE_IOTIVITY_SECURED} ]; then CONFIG_ENABLE_IOTIVITY_SECURED=0; fi
 
@@ -87,6 +90,8 @@ if [ ${CONFIG_ENABLE_IOTIVITY} -eq 1 ]; then
 
 	if [ ${CONFIG_IOTIVITY_LOGGING} -eq 1 ]; then OPTIONS="${OPTIONS} LOGGING=true " ; fi
 
+	if [ ${CONFIG_IOTIVITY_LOG_DEFERRED} -eq 1 ]; then OPTIONS="${OPTIONS} LOG_DEFERRED=true " ; fi
+
 	if [ ${CONFIG_DEBUG_SYMBOLS} -eq 1 ]; then OPTIONS="${OPTIONS} DEBUGSYM=True" ; fi
 
 	if [ ${CONFIG_EXAMPLES_IOTIVITY} -eq 1 ]; then OPTIONS="${OPTIONS} BUILD_SAMPLE=ON" ; fi
@@ -696,6 +696,24 @@ typedef void (*CAErrorCallback)(const CAEndpoint_t *object,
  */
 typedef void (*CANetworkMonitorCallback)(const CAEndpoint_t *info, CANetworkStatus_t status);
 
+#ifdef WITH_BWT
+/**
+ * Callback function type to receive the payload of a block-wise transfer block
+ * by block, in order, as the blocks arrive.
+ * @param[in]   endpoint    remote endpoint of the transfer.
+ * @param[in]   token       token of the transfer.
+ * @param[in]   tokenLength length of the token.
+ * @param[in]   offset      offset of the block in the payload.
+ * @param[in]   data        payload of the block.
+ * @param[in]   dataLength  length of the block.
+ * @return true if the block was consumed. It is then not kept, and the payload
+ *         passed up with the last block only holds the blocks not consumed.
+ */
+typedef bool (*CABlockStreamHandler)(const CAEndpoint_t *endpoint, const CAToken_t token,
+                                     uint8_t tokenLength, size_t offset,
+                                     const uint8_t *data, size_t dataLength);
+#endif
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -132,6 +132,16 @@ CAResult_t CAStartDiscoveryServer();
 void CARegisterHandler(CARequestCallback ReqHandler, CAResponseCallback RespHandler,
                        CAErrorCallback ErrorHandler);
 
+#ifdef WITH_BWT
+/**
+ * Register the handler receiving the blocks of incoming block-wise transfers
+ * as they arrive, instead of the whole payload with the last block.
+ * @param[in]   StreamHandler   Block stream handler, or NULL to reassemble the payload.
+ * @see     CABlockStreamHandler
+ */
+void CARegisterBlockStreamHandler(CABlockStreamHandler StreamHandler);
+#endif
+
 /**
  * Create an endpoint description.
  * @param[in]   flags                 how the adapter should be used.
@@ -224,6 +234,14 @@ CAResult_t CAGetNetworkInformation(CAEndpoint_t **info, uint32_t *size);
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Wait until there are requests or responses for CAHandleRequestResponse() to handle.
+ * @param[in]   timeoutMs    maximum time to wait in milliseconds, 0 to only check.
+ * @return   ::CA_STATUS_OK if there are, ::CA_REQUEST_TIMEOUT on timeout or
+ *           ::CA_STATUS_NOT_INITIALIZED
+ */
+CAResult_t CAWaitRequestResponse(uint32_t timeoutMs);
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
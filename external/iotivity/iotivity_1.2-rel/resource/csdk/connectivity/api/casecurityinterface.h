@@ -292,7 +292,8 @@ CAResult_t CAinitiateSslHandshake(const CAEndpoint_t *endpoint);
 CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint);
 
 /**
- * Close the TLS session using UUID
+ * Close the TLS session using UUID. The sessions kept to resume handshakes
+ * with the device are forgotten as well.
  *
  * @param[in] identity  UUID of target device
  * @param[in] idLength Byte length of 'identity'
@@ -307,6 +308,13 @@ CAResult_t CAcloseSslConnectionUsingUuid(const uint8_t *identity, size_t idLengt
  */
 void CAcloseSslConnectionAll(CATransportAdapter_t transportType);
 
+/**
+ * Forget the sessions kept to resume handshakes, so that every device goes
+ * through its credentials again on the next handshake. To be called when
+ * credentials are removed or reset.
+ */
+void CAforgetSslSessions(void);
+
 #if defined(__WITH_TLS__) || defined(__WITH_DTLS__)
 
 /**
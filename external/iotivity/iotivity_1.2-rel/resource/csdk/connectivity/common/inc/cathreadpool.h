@@ -63,6 +63,7 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
 
 /**
  * This function adds a routine to be executed by the thread pool at some future time.
+ * The routine waits in the task queue while all the worker threads are busy.
  *
  * @param thread_pool The thread pool structure.
  * @param method The routine to be executed.
@@ -81,6 +82,7 @@ CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func
 
 /**
  * This function removes a routine to be executed by the thread pool.
+ * A routine that is still queued is canceled, a running one is waited for.
  *
  * @param thread_pool The thread pool structure.
  * @param taskId An unique identifier of task.
@@ -32,56 +32,311 @@
 #if defined HAVE_WINSOCK2_H
 #include <winsock2.h>
 #endif
+#include <string.h>
+#ifdef __TIZENRT__
+#include <pthread.h>
+#endif
 #include "cathreadpool.h"
 #include "logger.h"
 #include "oic_malloc.h"
-#include "uarraylist.h"
 #include "octhread.h"
-#include "ocrandom.h"
 #include "platform_features.h"
 
 #define TAG PCF("UTHREADPOOL")
 
 /**
- * empty struct to represent the details.  This implementation has no data
- * that it needs to keep track of, so it only uses NULL for the internal value.
+ * Number of tasks that can wait for a worker. Adding a task fails when the
+ * queue is full.
  */
-typedef struct ca_thread_pool_details_t
-{
-    u_arraylist_t* threads_list;
-    oc_mutex list_lock;
-} ca_thread_pool_details_t;
+#ifndef CA_THREAD_POOL_QUEUE_SIZE
+#define CA_THREAD_POOL_QUEUE_SIZE 16
+#endif
 
+#ifdef __TIZENRT__
 /**
- * struct to wrap the pthreads callback properly.  The function pointer for
- * pthreads requires a void* return value, however u_thread_func is a void.
+ * Smallest stack size class. Workers are created with the stack size of the
+ * first task they run, rounded up to a power of two from this size, and then
+ * only take tasks that fit into that stack. When the pool is full and no
+ * worker fits a queued task, an idle worker is replaced by one that does.
  */
-typedef struct ca_thread_pool_callback_info_t
+#define CA_THREAD_POOL_MIN_STACK 1024
+#endif
+
+/**
+ * A task that is queued or running.
+ */
+typedef struct ca_thread_pool_task_t
 {
     ca_thread_func func;
-    void* data;
-} ca_thread_pool_callback_info_t;
+    void *data;
+    uint32_t taskId;
+#ifdef __TIZENRT__
+    const char *name;
+    int stackSize;
+#endif
+} ca_thread_pool_task_t;
+
+struct ca_thread_pool_details_t;
 
-typedef struct ca_thread_pool_thread_info_t
+/**
+ * A persistent worker thread. taskId is that of the task it runs, 0 while
+ * it is idle.
+ */
+typedef struct ca_thread_pool_worker_t
 {
     oc_thread thread;
+    struct ca_thread_pool_details_t *details;
     uint32_t taskId;
-} ca_thread_pool_thread_info_t;
+#ifdef __TIZENRT__
+    int stackSize;
+#endif
+} ca_thread_pool_worker_t;
+
+/**
+ * The pool: up to maxWorkers workers, created on demand and kept until the
+ * pool is freed, which take their tasks from a bounded queue shared by all
+ * of them. All fields are protected by lock. cond wakes up idle workers
+ * when a task is queued or the pool stops, doneCond wakes up
+ * ca_thread_pool_remove_task() when a task completes.
+ */
+typedef struct ca_thread_pool_details_t
+{
+    oc_mutex lock;
+    oc_cond cond;
+    oc_cond doneCond;
+    bool stop;
+    uint32_t nextTaskId;
+    ca_thread_pool_task_t queue[CA_THREAD_POOL_QUEUE_SIZE];
+    uint32_t queueLength;
+    ca_thread_pool_worker_t *workers;
+    int32_t numWorkers;
+    int32_t maxWorkers;
+#ifdef __TIZENRT__
+    oc_thread *retired;
+    int32_t numRetired;
+#endif
+} ca_thread_pool_details_t;
+
+#ifdef __TIZENRT__
+static int ca_thread_pool_stack_class(int stackSize)
+{
+    int size = CA_THREAD_POOL_MIN_STACK;
+
+    while (size < stackSize)
+    {
+        size <<= 1;
+    }
+    return size;
+}
+#define CA_THREAD_POOL_FITS(worker, task) ((task)->stackSize <= (worker)->stackSize)
+#else
+#define CA_THREAD_POOL_FITS(worker, task) ((void)(worker), (void)(task), true)
+#endif
+
+// take the first queued task the worker can run; called with the lock held
+static bool ca_thread_pool_dequeue(ca_thread_pool_details_t *details,
+                                   const ca_thread_pool_worker_t *worker,
+                                   ca_thread_pool_task_t *task)
+{
+    for (uint32_t i = 0; i < details->queueLength; i++)
+    {
+        if (CA_THREAD_POOL_FITS(worker, &details->queue[i]))
+        {
+            *task = details->queue[i];
+            details->queueLength--;
+            memmove(&details->queue[i], &details->queue[i + 1],
+                    (details->queueLength - i) * sizeof(ca_thread_pool_task_t));
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* ca_thread_pool_worker(void* data);
+
+// start a worker for the task in the given slot; called with the lock held
+static bool ca_thread_pool_start_worker(ca_thread_pool_details_t *details,
+                                        ca_thread_pool_worker_t *worker,
+                                        const ca_thread_pool_task_t *task)
+{
+    worker->details = details;
+    worker->taskId = 0;
+#ifndef __TIZENRT__
+    (void)task;
+    int thrRet = oc_thread_new(&worker->thread, ca_thread_pool_worker, worker);
+#else
+    worker->stackSize = ca_thread_pool_stack_class(task->stackSize);
+    int thrRet = oc_thread_new(&worker->thread, ca_thread_pool_worker, worker,
+                               task->name ? task->name : "IoT_Worker", worker->stackSize);
+#endif
+    if (thrRet != 0)
+    {
+        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", thrRet);
+        return false;
+    }
+    return true;
+}
+
+// start one more worker for the task; called with the lock held and fewer
+// than maxWorkers workers
+static bool ca_thread_pool_add_worker(ca_thread_pool_details_t *details,
+                                      const ca_thread_pool_task_t *task)
+{
+    if (!ca_thread_pool_start_worker(details, &details->workers[details->numWorkers], task))
+    {
+        return false;
+    }
+    details->numWorkers++;
+    OIC_LOG_V(DEBUG, TAG, "started worker %d", details->numWorkers);
+    return true;
+}
 
-// passthrough function to convert the pthreads call to a u_thread_func call
-void* ca_thread_pool_pthreads_delegate(void* data)
+#ifdef __TIZENRT__
+// a queued task that no worker can run, or NULL; called with the lock held
+static const ca_thread_pool_task_t *ca_thread_pool_find_unfit(ca_thread_pool_details_t *details)
 {
-    ca_thread_pool_callback_info_t* info = (ca_thread_pool_callback_info_t*)data;
-    info->func(info->data);
-    OICFree(info);
+    for (uint32_t i = 0; i < details->queueLength; i++)
+    {
+        int32_t w = 0;
+        while (w < details->numWorkers
+               && !CA_THREAD_POOL_FITS(&details->workers[w], &details->queue[i]))
+        {
+            w++;
+        }
+        if (w == details->numWorkers)
+        {
+            return &details->queue[i];
+        }
+    }
+    return NULL;
+}
+
+// Replace the idle worker by one that can run the task: the new thread takes
+// over the slot and the calling worker exits; its thread is joined by
+// ca_thread_pool_free(). Called with the lock held by the worker itself.
+static bool ca_thread_pool_replace_worker(ca_thread_pool_details_t *details,
+                                          ca_thread_pool_worker_t *worker,
+                                          const ca_thread_pool_task_t *task)
+{
+    oc_thread *retired = OICRealloc(details->retired,
+                                    (details->numRetired + 1) * sizeof(oc_thread));
+    if (!retired)
+    {
+        return false;
+    }
+    details->retired = retired;
+
+    oc_thread self = worker->thread;
+    int selfStack = worker->stackSize;
+    if (!ca_thread_pool_start_worker(details, worker, task))
+    {
+        worker->thread = self;
+        worker->stackSize = selfStack;
+        return false;
+    }
+    details->retired[details->numRetired++] = self;
+    OIC_LOG_V(DEBUG, TAG, "replaced worker of stack %d by one of stack %d",
+              selfStack, worker->stackSize);
+    return true;
+}
+#endif
+
+// worker loop: run queued tasks until the pool stops
+static void* ca_thread_pool_worker(void* data)
+{
+    ca_thread_pool_worker_t *worker = (ca_thread_pool_worker_t *)data;
+    ca_thread_pool_details_t *details = worker->details;
+    ca_thread_pool_task_t task;
+
+    oc_mutex_lock(details->lock);
+    while (!details->stop)
+    {
+        if (!ca_thread_pool_dequeue(details, worker, &task))
+        {
+#ifdef __TIZENRT__
+            const ca_thread_pool_task_t *unfit = ca_thread_pool_find_unfit(details);
+            if (unfit && details->numWorkers == details->maxWorkers
+                && ca_thread_pool_replace_worker(details, worker, unfit))
+            {
+                // the slot belongs to the new worker now
+                break;
+            }
+#endif
+            oc_cond_wait(details->cond, details->lock);
+            continue;
+        }
+
+        worker->taskId = task.taskId;
+        oc_mutex_unlock(details->lock);
+
+#ifdef __TIZENRT__
+        if (task.name)
+        {
+            pthread_setname_np(pthread_self(), task.name);
+        }
+#endif
+        OIC_LOG_V(DEBUG, TAG, "running taskId: %u", task.taskId);
+        task.func(task.data);
+
+        oc_mutex_lock(details->lock);
+        worker->taskId = 0;
+        oc_cond_broadcast(details->doneCond);
+    }
+    oc_mutex_unlock(details->lock);
+
     return NULL;
 }
 
-// this implementation doesn't do a thread pool, so this function is essentially
-// a no-op besides creating a valid ca_thread_pool_t object.  It was determined after
-// reading through the existing implementation that the thread-pooling was unnecessary
-// for the posix platforms.  Behavior shouldn't be changed since previously num_of_threads
-// was greater than the number of requested threads.
+// Number of idle workers that can run the task and are not about to take a
+// task that is already queued (an idle worker keeps taskId 0 until it has
+// dequeued its task); zero or less means the task would have to wait.
+// Called with the lock held.
+static int32_t ca_thread_pool_free_workers(ca_thread_pool_details_t *details,
+                                           const ca_thread_pool_task_t *task)
+{
+    int32_t idle = 0;
+
+    for (int32_t i = 0; i < details->numWorkers; i++)
+    {
+        if (0 == details->workers[i].taskId && CA_THREAD_POOL_FITS(&details->workers[i], task))
+        {
+            idle++;
+        }
+    }
+    return idle - (int32_t)details->queueLength;
+}
+
+// queue position of the task, or -1; called with the lock held
+static int32_t ca_thread_pool_find_queued(ca_thread_pool_details_t *details, uint32_t taskId)
+{
+    for (uint32_t i = 0; i < details->queueLength; i++)
+    {
+        if (details->queue[i].taskId == taskId)
+        {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+// true if a worker runs the task; called with the lock held
+static bool ca_thread_pool_is_running(ca_thread_pool_details_t *details, uint32_t taskId)
+{
+    for (int32_t i = 0; i < details->numWorkers; i++)
+    {
+        if (details->workers[i].taskId == taskId)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Workers are started on demand, up to num_of_threads, and stay in the pool
+// for the next tasks until ca_thread_pool_free(). Most tasks of the stack are
+// long running loops (adapter servers, queueing threads), so each of them
+// keeps its worker; short tasks reuse the idle workers instead of creating
+// a new thread every time.
 CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_pool)
 {
     OIC_LOG(DEBUG, TAG, "IN");
@@ -106,8 +361,9 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details = OICMalloc(sizeof(struct ca_thread_pool_details_t));
-    if(!(*thread_pool)->details)
+    ca_thread_pool_details_t *details = OICCalloc(1, sizeof(struct ca_thread_pool_details_t));
+    (*thread_pool)->details = details;
+    if(!details)
     {
         OIC_LOG(ERROR, TAG, "Failed to allocate for thread-pool details");
         OICFree(*thread_pool);
@@ -115,23 +371,16 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details->list_lock = oc_mutex_new();
+    details->workers = OICCalloc(num_of_threads, sizeof(ca_thread_pool_worker_t));
+    details->maxWorkers = num_of_threads;
+    details->nextTaskId = 1;
+    details->lock = oc_mutex_new();
+    details->cond = oc_cond_new();
+    details->doneCond = oc_cond_new();
 
-    if(!(*thread_pool)->details->list_lock)
+    if(!details->workers || !details->lock || !details->cond || !details->doneCond)
     {
-        OIC_LOG(ERROR, TAG, "Failed to create thread-pool mutex");
-        goto exit;
-    }
-
-    (*thread_pool)->details->threads_list = u_arraylist_create();
-
-    if(!(*thread_pool)->details->threads_list)
-    {
-        OIC_LOG(ERROR, TAG, "Failed to create thread-pool list");
-        if(!oc_mutex_free((*thread_pool)->details->list_lock))
-        {
-            OIC_LOG(ERROR, TAG, "Failed to free thread-pool mutex");
-        }
+        OIC_LOG(ERROR, TAG, "Failed to create thread-pool workers or sync objects");
         goto exit;
     }
 
@@ -139,7 +388,20 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
     return CA_STATUS_OK;
 
 exit:
-    OICFree((*thread_pool)->details);
+    if (details->lock)
+    {
+        oc_mutex_free(details->lock);
+    }
+    if (details->cond)
+    {
+        oc_cond_free(details->cond);
+    }
+    if (details->doneCond)
+    {
+        oc_cond_free(details->doneCond);
+    }
+    OICFree(details->workers);
+    OICFree(details);
     OICFree(*thread_pool);
     *thread_pool = NULL;
     return CA_STATUS_FAILED;
@@ -161,62 +423,49 @@ CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func
         return CA_STATUS_INVALID_PARAM;
     }
 
-    ca_thread_pool_callback_info_t* info = OICMalloc(sizeof(ca_thread_pool_callback_info_t));
-    if(!info)
-    {
-        OIC_LOG(ERROR, TAG, "Failed to allocate for memory wrapper");
-        return CA_MEMORY_ALLOC_FAILED;
-    }
+    ca_thread_pool_details_t *details = thread_pool->details;
+    ca_thread_pool_task_t task;
 
-    info->func = method;
-    info->data = data;
+    task.func = method;
+    task.data = data;
+#ifdef __TIZENRT__
+    task.name = task_name;
+    task.stackSize = stack_size;
+#endif
 
-    ca_thread_pool_thread_info_t *threadInfo =
-            (ca_thread_pool_thread_info_t *) OICCalloc(1, sizeof(ca_thread_pool_thread_info_t));
-    if (!threadInfo)
+    oc_mutex_lock(details->lock);
+    if (details->stop || CA_THREAD_POOL_QUEUE_SIZE <= details->queueLength)
     {
-        OIC_LOG(ERROR, TAG, "Memory allocation failed");
-        OICFree(info);
+        oc_mutex_unlock(details->lock);
+        OIC_LOG(ERROR, TAG, "thread-pool is stopped or its task queue is full");
         return CA_STATUS_FAILED;
     }
-    threadInfo->taskId = OCGetRandom();
-    if (taskId)
+
+    // 0 is never a task id: callers use it for "no task"
+    task.taskId = details->nextTaskId++;
+    if (0 == details->nextTaskId)
     {
-        *taskId = threadInfo->taskId;
+        details->nextTaskId = 1;
     }
 
-    oc_mutex_lock(thread_pool->details->list_lock);
-    bool addResult = u_arraylist_add(thread_pool->details->threads_list, (void*) threadInfo);
-    if (!addResult)
+    // start a worker unless one is free; with all workers busy the task
+    // waits in the queue for the first one that completes
+    if (ca_thread_pool_free_workers(details, &task) <= 0
+        && details->numWorkers < details->maxWorkers
+        && !ca_thread_pool_add_worker(details, &task))
     {
-        // Note that this is considered non-fatal.
-        oc_mutex_unlock(thread_pool->details->list_lock);
-        OIC_LOG(ERROR, TAG, "Arraylist add failed");
-        OICFree(info);
-        OICFree(threadInfo);
+        oc_mutex_unlock(details->lock);
         return CA_STATUS_FAILED;
     }
+    details->queue[details->queueLength++] = task;
+    oc_cond_broadcast(details->cond);
 
-#ifndef __TIZENRT__
-    int thrRet = oc_thread_new(&threadInfo->thread, ca_thread_pool_pthreads_delegate, info);
-#else
-    int thrRet = oc_thread_new(&threadInfo->thread, ca_thread_pool_pthreads_delegate, info,
-                               task_name, stack_size);
-#endif
-    if (thrRet != 0)
+    if (taskId)
     {
-        uint32_t index = 0;
-        if (u_arraylist_get_index(thread_pool->details->threads_list, threadInfo, &index))
-        {
-            u_arraylist_remove(thread_pool->details->threads_list, index);
-        }
-        oc_mutex_unlock(thread_pool->details->list_lock);
-        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", thrRet);
-        OICFree(info);
-        return CA_STATUS_FAILED;
+        *taskId = task.taskId;
     }
-    OIC_LOG_V(DEBUG, TAG, "created taskId: %u", threadInfo->taskId);
-    oc_mutex_unlock(thread_pool->details->list_lock);
+    OIC_LOG_V(DEBUG, TAG, "created taskId: %u", task.taskId);
+    oc_mutex_unlock(details->lock);
 
     OIC_LOG_V(DEBUG, TAG, "Out %s", __func__);
     return CA_STATUS_OK;
@@ -232,27 +481,29 @@ CAResult_t ca_thread_pool_remove_task(ca_thread_pool_t thread_pool, uint32_t tas
         return CA_STATUS_FAILED;
     }
 
-    oc_mutex_lock(thread_pool->details->list_lock);
-    for (uint32_t i = 0; i < u_arraylist_length(thread_pool->details->threads_list); ++i)
+    ca_thread_pool_details_t *details = thread_pool->details;
+
+    oc_mutex_lock(details->lock);
+    int32_t index = ca_thread_pool_find_queued(details, taskId);
+    if (0 <= index)
     {
-        ca_thread_pool_thread_info_t *threadInfo = (ca_thread_pool_thread_info_t *)
-                u_arraylist_get(thread_pool->details->threads_list, i);
-        if (threadInfo)
+        // not started yet: cancel it
+        details->queueLength--;
+        memmove(&details->queue[index], &details->queue[index + 1],
+                (details->queueLength - index) * sizeof(ca_thread_pool_task_t));
+        OIC_LOG_V(DEBUG, TAG, "canceled taskId: %u", taskId);
+    }
+    else
+    {
+        // running: wait until it returns
+        while (ca_thread_pool_is_running(details, taskId))
         {
-            if (threadInfo->taskId == taskId)
-            {
-                OIC_LOG_V(INFO, TAG, "waiting.. taskId: %u", threadInfo->taskId);
-                oc_thread_wait(threadInfo->thread);
-
-                OIC_LOG_V(DEBUG, TAG, "removed taskId: %u", threadInfo->taskId);
-                u_arraylist_remove(thread_pool->details->threads_list, i);
-                oc_thread_free(threadInfo->thread);
-                OICFree(threadInfo);
-                break;
-            }
+            OIC_LOG_V(INFO, TAG, "waiting.. taskId: %u", taskId);
+            oc_cond_wait(details->doneCond, details->lock);
         }
+        OIC_LOG_V(DEBUG, TAG, "removed taskId: %u", taskId);
     }
-    oc_mutex_unlock(thread_pool->details->list_lock);
+    oc_mutex_unlock(details->lock);
 
     OIC_LOG_V(DEBUG, TAG, "Out %s", __func__);
     return CA_STATUS_OK;
@@ -268,34 +519,44 @@ void ca_thread_pool_free(ca_thread_pool_t thread_pool)
         return;
     }
 
-    oc_mutex_lock(thread_pool->details->list_lock);
+    ca_thread_pool_details_t *details = thread_pool->details;
 
-    for (uint32_t i = 0; i < u_arraylist_length(thread_pool->details->threads_list); ++i)
+    // tasks that did not start are dropped, running ones are waited for
+    oc_mutex_lock(details->lock);
+    details->stop = true;
+    details->queueLength = 0;
+    oc_cond_broadcast(details->cond);
+    oc_mutex_unlock(details->lock);
+
+    for (int32_t i = 0; i < details->numWorkers; i++)
     {
-        ca_thread_pool_thread_info_t *threadInfo = (ca_thread_pool_thread_info_t *)
-                u_arraylist_get(thread_pool->details->threads_list, i);
-        if (threadInfo)
-        {
-            if (threadInfo->thread)
-            {
+        ca_thread_pool_worker_t *worker = &details->workers[i];
 #ifdef __TIZEN__
-                OIC_LOG_V(INFO, TAG, "canceling.. thread: %p", threadInfo->thread);
-                oc_thread_cancel(threadInfo->thread);
-#endif
-                OIC_LOG_V(INFO, TAG, "waiting.. thread: %p", threadInfo->thread);
-                oc_thread_wait(threadInfo->thread);
-                oc_thread_free(threadInfo->thread);
-            }
-            OICFree(threadInfo);
+        if (worker->taskId)
+        {
+            OIC_LOG_V(INFO, TAG, "canceling.. thread: %p", worker->thread);
+            oc_thread_cancel(worker->thread);
         }
+#endif
+        OIC_LOG_V(INFO, TAG, "waiting.. thread: %p", worker->thread);
+        oc_thread_wait(worker->thread);
+        oc_thread_free(worker->thread);
     }
+#ifdef __TIZENRT__
+    for (int32_t i = 0; i < details->numRetired; i++)
+    {
+        oc_thread_wait(details->retired[i]);
+        oc_thread_free(details->retired[i]);
+    }
+    OICFree(details->retired);
+#endif
 
-    u_arraylist_free(&(thread_pool->details->threads_list));
-
-    oc_mutex_unlock(thread_pool->details->list_lock);
-    oc_mutex_free(thread_pool->details->list_lock);
+    oc_cond_free(details->doneCond);
+    oc_cond_free(details->cond);
+    oc_mutex_free(details->lock);
 
-    OICFree(thread_pool->details);
+    OICFree(details->workers);
+    OICFree(details);
     OICFree(thread_pool);
 
     OIC_LOG_V(DEBUG, TAG, "Out %s", __func__);
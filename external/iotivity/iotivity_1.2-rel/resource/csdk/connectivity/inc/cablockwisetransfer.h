@@ -83,20 +83,36 @@ typedef struct
     size_t idLength;                   /**< length of blockData ID. */
 } CABlockDataID_t;
 
+/**
+ * Part of the received payload. The received blocks are appended to the last
+ * chunk while it has room, so the payload is never reallocated and copied as
+ * it grows. The first chunk holds one block, each next one doubles the last.
+ */
+typedef struct CABlockChunk
+{
+    struct CABlockChunk *next;          /**< next chunk of the payload. */
+    uint8_t *data;                      /**< payload bytes. */
+    size_t length;                      /**< number of bytes used in data. */
+    size_t capacity;                    /**< allocated size of data. */
+} CABlockChunk_t;
+
 /**
  * Block Data Set.
  */
-typedef struct
+typedef struct CABlockData
 {
     coap_block_t block1;                /**< block1 option. */
     coap_block_t block2;                /**< block2 option. */
     uint16_t type;                      /**< block option type. */
     CABlockDataID_t* blockDataId;       /**< ID set of CABlockData. */
     CAData_t *sentData;                 /**< sent request or response data information. */
-    CAPayload_t payload;                /**< payload buffer. */
+    CABlockChunk_t *chunksHead;         /**< received payload, first chunk. */
+    CABlockChunk_t *chunksTail;         /**< received payload, last chunk. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
     uint64_t ttl;                       /** The TTL for this blockData. */
+    bool streamed;                      /**< blocks were consumed by the stream handler. */
+    struct CABlockData *hashNext;       /**< next block data of the same ID hash. */
 } CABlockData_t;
 
 /**
@@ -126,6 +142,12 @@ typedef enum
 CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc blockSendMethod,
                                          CAReceiveThreadFunc receivedDataCallback);
 
+/**
+ * Set the handler receiving the blocks of incoming transfers.
+ * @param[in]   handler     handler, or NULL to reassemble the whole payload.
+ */
+void CASetBlockStreamHandler(CABlockStreamHandler handler);
+
 /**
  * Terminate the block-wise transfer context.
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
@@ -220,6 +242,15 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
 CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID,
                               const CAData_t *receivedData);
 
+/**
+ * Replace the payload of the last block with the payload to pass up: the
+ * reassembled payload, or none if the stream handler consumed all blocks.
+ * @param[in]   blockID     ID set of CABlockData.
+ * @param[in]   data        copy of the received last block.
+ * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAUpdateLastBlockPayload(const CABlockDataID_t *blockID, CAData_t *data);
+
 /**
  * set next block option 1.
  * @param[in]   pdu received pdu binary data.
@@ -537,7 +568,8 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID,
                                uint16_t blockType);
 
 /**
- * Get the full payload from block-wise list.
+ * Get the full payload from block-wise list. The received chunks are merged
+ * into one buffer, still owned by the block data.
  * @param[in]   blockID     ID set of CABlockData.
  * @param[out]  fullPayloadLen  received full payload length.
  * @return payload.
@@ -100,9 +100,17 @@ void CATerminateMessageHandler();
 
 /**
  * Handler for receiving request and response callback in single thread model.
+ * Handles the received messages queued so far, up to a bounded number per call.
  */
 void CAHandleRequestResponseCallbacks();
 
+/**
+ * Wait until received messages are queued for CAHandleRequestResponseCallbacks().
+ * @param[in]   timeoutMs    maximum time to wait in milliseconds, 0 to only check.
+ * @return  true if messages are pending, false on timeout.
+ */
+bool CAWaitRequestResponseCallbacks(uint32_t timeoutMs);
+
 /**
  * Setting the Callback funtion for network state change callback.
  * @param[in] nwMonitorHandler    callback for network state change.
@@ -44,8 +44,11 @@
 /** default max retransmission trying count is 4(CoAP). **/
 #define DEFAULT_RETRANSMISSION_COUNT      4
 
-/** check period is 1 sec. **/
-#define RETRANSMISSION_CHECK_PERIOD_SEC     1
+/** number of buckets of the message ID table, a power of 2. **/
+#define RETRANSMISSION_TABLE_SIZE   64
+
+/** number of remote endpoints the round-trip times are estimated for. **/
+#define RETRANSMISSION_MAX_PEERS    16
 
 /** retransmission data send method type. **/
 typedef CAResult_t (*CADataSendMethod_t)(const CAEndpoint_t *endpoint,
@@ -68,6 +71,9 @@ typedef struct
 
 } CARetransmissionConfig_t;
 
+struct CARetransmissionData;
+struct CARetransmissionPeer;
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -91,8 +97,20 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** CON messages waiting for an ACK, a min-heap on the next send time. **/
+    struct CARetransmissionData **dataHeap;
+
+    /** number of messages in dataHeap. **/
+    uint32_t dataCount;
+
+    /** allocated size of dataHeap. **/
+    uint32_t dataCapacity;
+
+    /** CON messages hashed by message ID, to match the ACK and RST. **/
+    struct CARetransmissionData *dataTable[RETRANSMISSION_TABLE_SIZE];
+
+    /** retransmission timeout estimators of the remote endpoints. **/
+    struct CARetransmissionPeer *peers;
 
 } CARetransmission_t;
 
@@ -57,7 +57,7 @@ typedef enum
 /**
  * TCP Session Information for IPv4 TCP transport
  */
-typedef struct
+typedef struct CATCPSessionInfo_t
 {
     CASecureEndpoint_t sep;             /**< secure endpoint information */
     int fd;                             /**< file descriptor info */
@@ -69,6 +69,7 @@ typedef struct
     CAProtocol_t protocol;              /**< application-level protocol */
     CATCPConnectionState_t state;       /**< current tcp session state */
     bool isClient;                      /**< Host Mode of Operation. */
+    struct CATCPSessionInfo_t *fdNext;  /**< next session in the same fd bucket */
 } CATCPSessionInfo_t;
 
 /**
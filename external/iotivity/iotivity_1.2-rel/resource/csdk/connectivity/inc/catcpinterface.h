@@ -206,11 +206,20 @@ CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint
  */
 size_t CAGetTotalLengthFromHeader(const unsigned char *recvBuffer);
 
+/**
+ * Get total length of the CoAP over TCP message at the start of a buffer.
+ *
+ * @param[in]   data        received data.
+ * @param[in]   dataLength  length of received data.
+ * @return  total data length, 0 if the header is not complete.
+ */
+size_t CAGetTotalLengthFromBuffer(const unsigned char *data, size_t dataLength);
+
 /**
  * Get session information from file descriptor index.
  *
  * @param[in]   fd      file descriptor.
- * @param[out]  index   index of array list
+ * @param[out]  index   index of array list, can be NULL.
  * @return  TCP Server Information structure.
  */
 CATCPSessionInfo_t *CAGetSessionInfoFromFD(int fd, size_t *index);
@@ -46,6 +46,12 @@
 #include "mbedtls/timing.h"
 #include "mbedtls/ssl_cookie.h"
 #endif
+#ifdef MBEDTLS_SSL_CACHE_C
+#include "mbedtls/ssl_cache.h"
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SSL_SESSION_TICKETS)
+#include "mbedtls/ssl_ticket.h"
+#endif
 #include "pkix_interface.h"
 
 #if !defined(NDEBUG) || defined(TB_LOG)
@@ -175,6 +181,28 @@
  */
 #define RETRANSMISSION_TIME 1
 
+/**
+ * @def SSL_PEER_BUCKETS
+ * @brief Number of buckets of the peer table, a power of 2
+ */
+#define SSL_PEER_BUCKETS (32)
+
+/**
+ * @def SSL_SESSION_CACHE_SIZE
+ * @brief Number of sessions kept for resumption, in each role
+ */
+#if defined (__TIZENRT__)
+#define SSL_SESSION_CACHE_SIZE (4)
+#else
+#define SSL_SESSION_CACHE_SIZE (16)
+#endif
+
+/**
+ * @def SSL_SESSION_TIMEOUT
+ * @brief Lifetime (in seconds) of the sessions and tickets issued by the server
+ */
+#define SSL_SESSION_TIMEOUT (86400)
+
 /**@def SSL_CLOSE_NOTIFY(peer, ret)
  *
  * Notifies of existing \a peer about closing TLS connection.
@@ -445,6 +473,31 @@ typedef struct TlsCallBacks
     CAPacketSendCallback sendCallback;      /**< Callback used to send data to socket layer. */
 } SslCallbacks_t;
 
+/**
+ * Identity of the peer of a session, restored when the session is resumed:
+ * an abbreviated handshake goes through neither the PSK callback nor,
+ * with session tickets, anything the identity could be looked up from.
+ */
+typedef struct SslSessionIdentity
+{
+    uint8_t master[MASTER_SECRET_LEN];  /**< master secret of the session */
+    int endpoint;                       /**< MBEDTLS_SSL_IS_CLIENT or MBEDTLS_SSL_IS_SERVER */
+    CARemoteId_t identity;
+    CARemoteId_t userId;
+    uint32_t age;                       /**< 0 if the entry is free */
+} SslSessionIdentity_t;
+
+/**
+ * Session with a server, offered again on the next connection to it.
+ */
+typedef struct SslSavedSession
+{
+    CAEndpoint_t endpoint;
+    mbedtls_ssl_session session;
+    uint32_t generation;                /**< cipher selection it was negotiated under */
+    uint32_t age;                       /**< 0 if the entry is free */
+} SslSavedSession_t;
+
 /**
  * Data structure for holding the mbedTLS interface related info.
  */
@@ -452,6 +505,7 @@ typedef struct SslContext
 {
     u_arraylist_t *peerList;         /**< peer list which holds the mapping between
                                               peer id, it's n/w address and mbedTLS context. */
+    struct SslEndPoint *peerBuckets[SSL_PEER_BUCKETS]; /**< peers hashed by address */
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context rnd;
     mbedtls_x509_crt ca;
@@ -473,6 +527,17 @@ typedef struct SslContext
     mbedtls_ssl_cookie_ctx cookieCtx;
     int timerId;
 #endif
+
+#ifdef MBEDTLS_SSL_CACHE_C
+    mbedtls_ssl_cache_context sessionCache;     /**< sessions of the server role */
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_ticket_context ticketCtx;
+#endif
+    SslSavedSession_t savedSessions[SSL_SESSION_CACHE_SIZE];   /**< sessions of the client role */
+    SslSessionIdentity_t sessionIdentities[2 * SSL_SESSION_CACHE_SIZE];
+    uint32_t sessionAge;
+    uint32_t sessionGeneration;         /**< changed with the cipher selection */
 } SslContext_t;
 
 /**
@@ -516,16 +581,30 @@ static CAsetupPkContextHandler g_setupPkContextCallback = NULL;
 static oc_mutex g_sslContextMutex = NULL;
 
 /**
- * @var g_sslCallback
- * @brief callback to deliver the TLS handshake result
+ * @var g_sslRngMutex
+ * @brief Mutex to synchronize access to the random generator, used by peers
+ *        encrypting without g_sslContextMutex.
  */
-static CAErrorCallback g_sslCallback = NULL;
+static oc_mutex g_sslRngMutex = NULL;
+
+/**
+ * @var g_sslPeerRefCount
+ * @brief References to peers held with AcquireSslPeer(), protected by
+ *        g_sslContextMutex. The context is freed only once they are released.
+ */
+static uint32_t g_sslPeerRefCount = 0;
 
 /**
- * @var g_decryptBuffer
- * @brief decrypt buffer which will be used for decryption
+ * @var g_sslPeerReleased
+ * @brief Signalled when the last reference to a peer is released.
  */
-static uint8_t *g_decryptBuffer = NULL;
+static oc_cond g_sslPeerReleased = NULL;
+
+/**
+ * @var g_sslCallback
+ * @brief callback to deliver the TLS handshake result
+ */
+static CAErrorCallback g_sslCallback = NULL;
 
 /**
  * Data structure for holding the data to be received.
@@ -551,6 +630,13 @@ typedef struct SslEndPoint
 #ifdef __WITH_DTLS__
     mbedtls_timing_delay_context timer;
 #endif // __WITH_DTLS__
+    struct SslEndPoint *hashNext;   /**< next peer of the bucket */
+    oc_mutex mutex;                 /**< held while reading or writing application data */
+    uint8_t *decryptBuffer;         /**< buffer for the decrypted data */
+    uint32_t refCount;              /**< users of the peer outside g_sslContextMutex */
+    bool removed;                   /**< removed from the peer table, deleted when released */
+    bool resumed;                   /**< handshake resumed a previous session */
+    bool offeredSession;            /**< client offered a saved session */
 } SslEndPoint_t;
 
 void CAsetPskCredentialsCallback(CAgetPskCredentialsHandler credCallback)
@@ -661,6 +747,25 @@ static int RecvCallBack(void * tep, unsigned char * data, size_t dataLen)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
     return (int)retLen;
 }
+/**
+ * Random generator of the mbedTLS configurations.
+ *
+ * Peers encrypt application data holding only their own mutex, so the
+ * generator is serialized separately.
+ *
+ * @param[in]  rnd    CTR_DRBG context
+ * @param[out]  output    random bytes
+ * @param[in]  outputLen    number of random bytes
+ *
+ * @return  0 on success, mbedTLS error code otherwise
+ */
+static int SslRandom(void * rnd, unsigned char * output, size_t outputLen)
+{
+    oc_mutex_lock(g_sslRngMutex);
+    int ret = mbedtls_ctr_drbg_random(rnd, output, outputLen);
+    oc_mutex_unlock(g_sslRngMutex);
+    return ret;
+}
 
 static int CASslExportKeysHandler(void *p_expkey,
                                 const unsigned char *ms,
@@ -1064,6 +1169,41 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
     OIC_LOG_V(WARNING, NET_SSL_TAG, "Out %s", __func__);
     return -1;
 }
+/**
+ * Compares the addresses of two endpoints. Over BLE the port is not
+ * relevant.
+ *
+ * @param[in]  first    remote address
+ * @param[in]  second    remote address
+ *
+ * @return  true if the addresses are the same
+ */
+static bool IsSamePeerAddress(const CAEndpoint_t *first, const CAEndpoint_t *second)
+{
+    return (first->adapter == second->adapter)
+        && (0 == strncmp(first->addr, second->addr, MAX_ADDR_STR_SIZE_CA))
+        && (first->port == second->port || CA_ADAPTER_GATT_BTLE == first->adapter);
+}
+
+/**
+ * Gets the bucket of the peer table holding an endpoint.
+ *
+ * @param[in]  peer    remote address
+ *
+ * @return  bucket of the peer table
+ */
+static SslEndPoint_t **GetPeerBucket(const CAEndpoint_t *peer)
+{
+    // FNV-1a, over the adapter and the address: the port is not relevant over BLE
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ (uint8_t)peer->adapter) * 16777619u;
+    for (size_t i = 0; i < MAX_ADDR_STR_SIZE_CA && peer->addr[i]; i++)
+    {
+        hash = (hash ^ (uint8_t)peer->addr[i]) * 16777619u;
+    }
+    return &g_caSslContext->peerBuckets[hash & (SSL_PEER_BUCKETS - 1)];
+}
+
 /**
  * Gets session corresponding for endpoint.
  *
@@ -1073,37 +1213,39 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
  */
 static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
 {
-    uint32_t listIndex = 0;
-    uint32_t listLength = 0;
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     VERIFY_NON_NULL_RET(peer, NET_SSL_TAG, "TLS peer is NULL", NULL);
     VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", NULL);
 
-    SslEndPoint_t *tep = NULL;
-    listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (listIndex = 0; listIndex < listLength; listIndex++)
+    SslEndPoint_t *tep = *GetPeerBucket(peer);
+    while (tep && !IsSamePeerAddress(peer, &tep->sep.endpoint))
     {
-        tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
+        tep = tep->hashNext;
+    }
 
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Compare [%s:%d] and [%s:%d] for %d adapter",
-                  peer->addr, peer->port, tep->sep.endpoint.addr, tep->sep.endpoint.port,
-                  peer->adapter);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "%s [%s:%d] for %d adapter", tep ? "Found" : "No session for",
+              peer->addr, peer->port, peer->adapter);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return tep;
+}
 
-        if((peer->adapter == tep->sep.endpoint.adapter)
-                && (0 == strncmp(peer->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA))
-                && (peer->port == tep->sep.endpoint.port || CA_ADAPTER_GATT_BTLE == peer->adapter))
-        {
-            OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-            return tep;
-        }
+/**
+ * Adds endpoint session to the list.
+ *
+ * @param[in]  tep    endpoint with session info
+ *
+ * @return  true on success
+ */
+static bool AddPeerToList(SslEndPoint_t * tep)
+{
+    if (!u_arraylist_add(g_caSslContext->peerList, (void *) tep))
+    {
+        return false;
     }
-    OIC_LOG(DEBUG, NET_SSL_TAG, "Return NULL");
-    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return NULL;
+    SslEndPoint_t **bucket = GetPeerBucket(&tep->sep.endpoint);
+    tep->hashNext = *bucket;
+    *bucket = tep;
+    return true;
 }
 
 /**
@@ -1230,6 +1372,381 @@ static void DeleteCacheList(u_arraylist_t * cacheList)
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
+/**
+ * Gets the identity record of a session.
+ *
+ * @param[in]  master    master secret of the session
+ * @param[in]  endpoint    role of the session
+ *
+ * @return  identity record or NULL
+ */
+static SslSessionIdentity_t * GetSessionIdentity(const unsigned char * master, int endpoint)
+{
+    for (size_t i = 0; i < sizeof(g_caSslContext->sessionIdentities) /
+                           sizeof(g_caSslContext->sessionIdentities[0]); i++)
+    {
+        SslSessionIdentity_t * record = &g_caSslContext->sessionIdentities[i];
+        if (0 != record->age && endpoint == record->endpoint &&
+            0 == memcmp(record->master, master, MASTER_SECRET_LEN))
+        {
+            return record;
+        }
+    }
+    return NULL;
+}
+/**
+ * Records the identity of the peer of a full handshake, for the handshakes
+ * resuming its session.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void RememberSessionIdentity(const SslEndPoint_t * tep)
+{
+    SslSessionIdentity_t * record = GetSessionIdentity(tep->ssl.session->master,
+                                                       tep->ssl.conf->endpoint);
+    if (NULL == record)
+    {
+        record = &g_caSslContext->sessionIdentities[0];
+        for (size_t i = 1; i < sizeof(g_caSslContext->sessionIdentities) /
+                               sizeof(g_caSslContext->sessionIdentities[0]); i++)
+        {
+            if (g_caSslContext->sessionIdentities[i].age < record->age)
+            {
+                record = &g_caSslContext->sessionIdentities[i];
+            }
+        }
+        memcpy(record->master, tep->ssl.session->master, MASTER_SECRET_LEN);
+        record->endpoint = tep->ssl.conf->endpoint;
+    }
+    record->identity = tep->sep.identity;
+    record->userId = tep->sep.userId;
+    record->age = ++g_caSslContext->sessionAge;
+}
+/**
+ * Restores the identity of the peer of a resumed session.
+ *
+ * @param[in,out]  tep    endpoint with session info
+ *
+ * @return  true if the session has an identity record
+ */
+static bool RestoreSessionIdentity(SslEndPoint_t * tep)
+{
+    SslSessionIdentity_t * record = GetSessionIdentity(tep->ssl.session->master,
+                                                       tep->ssl.conf->endpoint);
+    if (NULL == record)
+    {
+        return false;
+    }
+    tep->sep.identity = record->identity;
+    tep->sep.userId = record->userId;
+    record->age = ++g_caSslContext->sessionAge;
+    return true;
+}
+/**
+ * Checks that the peer of a session still has a valid credential, which the
+ * abbreviated handshake resuming the session does not: the PSK of its
+ * identity, or a certificate still accepted by the trust chain and the CRL.
+ *
+ * @param[in]  record    identity record of the session
+ * @param[in]  session    session to resume
+ *
+ * @return  true if the session can be resumed
+ */
+static bool HasSessionCredential(const SslSessionIdentity_t * record,
+                                 const mbedtls_ssl_session * session)
+{
+    const mbedtls_ssl_ciphersuite_t * suite = mbedtls_ssl_ciphersuite_from_id(session->ciphersuite);
+    if (NULL == suite || MBEDTLS_KEY_EXCHANGE_ECDH_ANON == suite->key_exchange)
+    {
+        return false;
+    }
+    if (mbedtls_ssl_ciphersuite_uses_psk(suite))
+    {
+        if (NULL == g_getCredentialsCallback)
+        {
+            return false;
+        }
+        uint8_t keyBuf[PSK_LENGTH] = {0};
+        int ret = g_getCredentialsCallback(CA_DTLS_PSK_KEY, record->identity.id,
+                                           record->identity.id_length, keyBuf, PSK_LENGTH);
+        OICClearMemory(keyBuf, sizeof(keyBuf));
+        return ret > 0;
+    }
+
+    uint32_t flags = 0;
+    return NULL != session->peer_cert &&
+           0 == mbedtls_x509_crt_verify(session->peer_cert, &g_caSslContext->ca,
+                                        &g_caSslContext->crl, NULL, &flags, NULL, NULL);
+}
+/**
+ * Gets the identity record of a session to resume, if its peer still has a
+ * valid credential.
+ *
+ * @param[in]  session    session to resume
+ * @param[in]  endpoint    role of the session
+ *
+ * @return  identity record or NULL
+ */
+static SslSessionIdentity_t * GetResumableSessionIdentity(const mbedtls_ssl_session * session,
+                                                          int endpoint)
+{
+    SslSessionIdentity_t * record = GetSessionIdentity(session->master, endpoint);
+    if (NULL != record && !HasSessionCredential(record, session))
+    {
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Credential of the session peer is no longer valid");
+        memset(record, 0, sizeof(*record));
+        record = NULL;
+    }
+    return record;
+}
+/**
+ * Frees a saved client session.
+ *
+ * @param[in]  saved    saved session
+ */
+static void FreeSavedSession(SslSavedSession_t * saved)
+{
+    mbedtls_ssl_session_free(&saved->session);
+    memset(saved, 0, sizeof(*saved));
+}
+/**
+ * Gets the client session saved for a server.
+ *
+ * @param[in]  endpoint    remote address
+ *
+ * @return  saved session or NULL
+ */
+static SslSavedSession_t * GetSavedSession(const CAEndpoint_t * endpoint)
+{
+    for (size_t i = 0; i < SSL_SESSION_CACHE_SIZE; i++)
+    {
+        SslSavedSession_t * saved = &g_caSslContext->savedSessions[i];
+        if (0 != saved->age && IsSamePeerAddress(&saved->endpoint, endpoint))
+        {
+            return saved;
+        }
+    }
+    return NULL;
+}
+/**
+ * Forgets the client session saved for a server.
+ *
+ * @param[in]  endpoint    remote address
+ */
+static void ForgetSavedSession(const CAEndpoint_t * endpoint)
+{
+    SslSavedSession_t * saved = GetSavedSession(endpoint);
+    if (NULL != saved)
+    {
+        FreeSavedSession(saved);
+    }
+}
+/**
+ * Saves the session of a client handshake, replacing the least recently
+ * used one.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void SaveClientSession(const SslEndPoint_t * tep)
+{
+    SslSavedSession_t * saved = GetSavedSession(&tep->sep.endpoint);
+    if (NULL == saved)
+    {
+        saved = &g_caSslContext->savedSessions[0];
+        for (size_t i = 1; i < SSL_SESSION_CACHE_SIZE; i++)
+        {
+            if (g_caSslContext->savedSessions[i].age < saved->age)
+            {
+                saved = &g_caSslContext->savedSessions[i];
+            }
+        }
+    }
+    FreeSavedSession(saved);
+    if (0 != mbedtls_ssl_get_session(&tep->ssl, &saved->session))
+    {
+        OIC_LOG(WARNING, NET_SSL_TAG, "Failed to save the session");
+        FreeSavedSession(saved);
+        return;
+    }
+    saved->endpoint = tep->sep.endpoint;
+    saved->generation = g_caSslContext->sessionGeneration;
+    saved->age = ++g_caSslContext->sessionAge;
+}
+/**
+ * Offers the session saved for the server to resume it. The session is not
+ * offered if the cipher selection changed or its ciphersuite is no longer
+ * allowed.
+ *
+ * @param[in]  tep    endpoint with session info
+ * @param[in]  config    client config of the endpoint
+ */
+static void OfferSavedSession(SslEndPoint_t * tep, const mbedtls_ssl_config * config)
+{
+    SslSavedSession_t * saved = GetSavedSession(&tep->sep.endpoint);
+    if (NULL == saved)
+    {
+        return;
+    }
+    if (saved->generation != g_caSslContext->sessionGeneration ||
+        NULL == GetResumableSessionIdentity(&saved->session, MBEDTLS_SSL_IS_CLIENT))
+    {
+        FreeSavedSession(saved);
+        return;
+    }
+
+    const int * suite = config->ciphersuite_list[MBEDTLS_SSL_MINOR_VERSION_3];
+    while (0 != *suite && saved->session.ciphersuite != *suite)
+    {
+        suite++;
+    }
+    if (0 == *suite)
+    {
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Ciphersuite of the saved session is not allowed");
+        return;
+    }
+
+    if (0 == mbedtls_ssl_set_session(&tep->ssl, &saved->session))
+    {
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Resuming session with [%s:%d]",
+                  tep->sep.endpoint.addr, tep->sep.endpoint.port);
+        tep->offeredSession = true;
+    }
+}
+/**
+ * Forgets the identity records of a device and the client sessions
+ * established with it.
+ *
+ * @param[in]  identity    device uuid
+ * @param[in]  idLength    length of identity
+ */
+static void ForgetSessionsOfIdentity(const uint8_t * identity, size_t idLength)
+{
+    for (size_t i = 0; i < sizeof(g_caSslContext->sessionIdentities) /
+                           sizeof(g_caSslContext->sessionIdentities[0]); i++)
+    {
+        SslSessionIdentity_t * record = &g_caSslContext->sessionIdentities[i];
+        if (0 == record->age || record->identity.id_length != idLength ||
+            0 != memcmp(record->identity.id, identity, idLength))
+        {
+            continue;
+        }
+        for (size_t j = 0; j < SSL_SESSION_CACHE_SIZE; j++)
+        {
+            SslSavedSession_t * saved = &g_caSslContext->savedSessions[j];
+            if (0 != saved->age &&
+                0 == memcmp(saved->session.master, record->master, MASTER_SECRET_LEN))
+            {
+                FreeSavedSession(saved);
+            }
+        }
+        memset(record, 0, sizeof(*record));
+    }
+}
+/**
+ * Forgets all the identity records and client sessions, so that every peer
+ * goes through a full handshake and its credentials again.
+ */
+static void ForgetAllSessions()
+{
+    for (size_t i = 0; i < SSL_SESSION_CACHE_SIZE; i++)
+    {
+        FreeSavedSession(&g_caSslContext->savedSessions[i]);
+    }
+    memset(g_caSslContext->sessionIdentities, 0, sizeof(g_caSslContext->sessionIdentities));
+}
+#ifdef MBEDTLS_SSL_CACHE_C
+/**
+ * Gets a session of the server cache, leaving out the sessions whose peer
+ * identity was forgotten or no longer has a valid credential.
+ *
+ * @param[in]  data    server session cache
+ * @param[in,out]  session    session to resume
+ *
+ * @return  0 if the session can be resumed
+ */
+static int SslCacheGet(void * data, mbedtls_ssl_session * session)
+{
+    int ret = mbedtls_ssl_cache_get(data, session);
+    if (0 == ret && NULL == GetResumableSessionIdentity(session, MBEDTLS_SSL_IS_SERVER))
+    {
+        ret = 1;
+    }
+    return ret;
+}
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SSL_SESSION_TICKETS)
+/**
+ * Parses a session ticket, leaving out the sessions whose peer identity
+ * was forgotten or no longer has a valid credential.
+ */
+static int SslTicketParse(void * ticketCtx, mbedtls_ssl_session * session,
+                          unsigned char * buf, size_t len)
+{
+    int ret = mbedtls_ssl_ticket_parse(ticketCtx, session, buf, len);
+    if (0 == ret && NULL == GetResumableSessionIdentity(session, MBEDTLS_SSL_IS_SERVER))
+    {
+        ret = MBEDTLS_ERR_SSL_SESSION_TICKET_EXPIRED;
+    }
+    return ret;
+}
+#endif
+/**
+ * Sets up session resumption: the session cache and the session tickets of
+ * the server configs.
+ *
+ * @return  0 on success or -1 on error
+ */
+static int InitSessionCache()
+{
+#ifdef MBEDTLS_SSL_CACHE_C
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_set_max_entries(&g_caSslContext->sessionCache, SSL_SESSION_CACHE_SIZE);
+#ifdef MBEDTLS_HAVE_TIME
+    mbedtls_ssl_cache_set_timeout(&g_caSslContext->sessionCache, SSL_SESSION_TIMEOUT);
+#endif
+#ifdef __WITH_TLS__
+    mbedtls_ssl_conf_session_cache(&g_caSslContext->serverTlsConf, &g_caSslContext->sessionCache,
+                                   SslCacheGet, mbedtls_ssl_cache_set);
+#endif
+#ifdef __WITH_DTLS__
+    mbedtls_ssl_conf_session_cache(&g_caSslContext->serverDtlsConf, &g_caSslContext->sessionCache,
+                                   SslCacheGet, mbedtls_ssl_cache_set);
+#endif
+#endif // MBEDTLS_SSL_CACHE_C
+
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+    if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, SslRandom,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_128_GCM,
+                                      SSL_SESSION_TIMEOUT))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+        return -1;
+    }
+#ifdef __WITH_TLS__
+    mbedtls_ssl_conf_session_tickets_cb(&g_caSslContext->serverTlsConf, mbedtls_ssl_ticket_write,
+                                        SslTicketParse, &g_caSslContext->ticketCtx);
+#endif
+#ifdef __WITH_DTLS__
+    mbedtls_ssl_conf_session_tickets_cb(&g_caSslContext->serverDtlsConf, mbedtls_ssl_ticket_write,
+                                        SslTicketParse, &g_caSslContext->ticketCtx);
+#endif
+#endif
+    return 0;
+}
+/**
+ * Frees the sessions kept for resumption.
+ */
+static void DeInitSessionCache()
+{
+#ifdef MBEDTLS_SSL_CACHE_C
+    mbedtls_ssl_cache_free(&g_caSslContext->sessionCache);
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+#endif
+    ForgetAllSessions();
+}
 /**
  * Deletes endpoint with session.
  *
@@ -1242,9 +1759,83 @@ static void DeleteSslEndPoint(SslEndPoint_t * tep)
 
     mbedtls_ssl_free(&tep->ssl);
     DeleteCacheList(tep->cacheList);
+    oc_mutex_free(tep->mutex);
+    OICFree(tep->decryptBuffer);
     OICFree(tep);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
+
+/**
+ * Removes endpoint session from the list. It is deleted once released by
+ * the users holding it outside g_sslContextMutex.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void RemoveSslPeer(SslEndPoint_t * tep)
+{
+    VERIFY_NON_NULL_VOID(tep, NET_SSL_TAG, "tep");
+    if (tep->removed)
+    {
+        return;
+    }
+    VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
+
+    SslEndPoint_t **link = GetPeerBucket(&tep->sep.endpoint);
+    while (*link && *link != tep)
+    {
+        link = &(*link)->hashNext;
+    }
+    if (*link)
+    {
+        *link = tep->hashNext;
+    }
+    uint32_t listIndex = 0;
+    if (u_arraylist_get_index(g_caSslContext->peerList, tep, &listIndex))
+    {
+        u_arraylist_remove(g_caSslContext->peerList, listIndex);
+    }
+
+    // a session the server did not resume is not offered again
+    if (tep->offeredSession && MBEDTLS_SSL_HANDSHAKE_OVER != tep->ssl.state)
+    {
+        ForgetSavedSession(&tep->sep.endpoint);
+    }
+
+    tep->removed = true;
+    if (0 == tep->refCount)
+    {
+        DeleteSslEndPoint(tep);
+    }
+}
+/**
+ * Holds an endpoint session while g_sslContextMutex is released.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void AcquireSslPeer(SslEndPoint_t * tep)
+{
+    tep->refCount++;
+    g_sslPeerRefCount++;
+}
+/**
+ * Releases an endpoint session held with AcquireSslPeer(), deleting it if
+ * it was removed in the meantime. Called with g_sslContextMutex.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void ReleaseSslPeer(SslEndPoint_t * tep)
+{
+    tep->refCount--;
+    if (0 == tep->refCount && tep->removed)
+    {
+        DeleteSslEndPoint(tep);
+    }
+    g_sslPeerRefCount--;
+    if (0 == g_sslPeerRefCount)
+    {
+        oc_cond_broadcast(g_sslPeerReleased);
+    }
+}
 /**
  * Removes endpoint session from list.
  *
@@ -1254,50 +1845,45 @@ static void RemovePeerFromList(const CAEndpoint_t * endpoint)
 {
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
     VERIFY_NON_NULL_VOID(endpoint, NET_SSL_TAG, "endpoint");
-    uint32_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (uint32_t listIndex = 0; listIndex < listLength; listIndex++)
+    SslEndPoint_t * tep = GetSslPeer(endpoint);
+    if (NULL != tep)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList,listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
-        if(0 == strncmp(endpoint->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA)
-                && (endpoint->port == tep->sep.endpoint.port))
-        {
-            u_arraylist_remove(g_caSslContext->peerList, listIndex);
-            DeleteSslEndPoint(tep);
-            return;
-        }
+        RemoveSslPeer(tep);
     }
 }
 /**
- * Deletes session list.
+ * Removes all the sessions. The ones held outside g_sslContextMutex are
+ * deleted once released.
  */
 static void DeletePeerList()
 {
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
 
-    uint32_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (uint32_t listIndex = 0; listIndex < listLength; listIndex++)
+    // from the end, as removing a peer shifts the ones after it
+    uint32_t listIndex = u_arraylist_length(g_caSslContext->peerList);
+    while (0 < listIndex--)
     {
         SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList,listIndex);
         if (NULL == tep)
         {
             continue;
         }
-        if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
+        // a held peer is being read or written by its holder
+        if (0 == tep->refCount && MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
         {
             int ret = 0;
+            oc_mutex_lock(tep->mutex);
             do
             {
                 ret = mbedtls_ssl_close_notify(&tep->ssl);
             }
             while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
+            oc_mutex_unlock(tep->mutex);
         }
-        DeleteSslEndPoint(tep);
+        RemoveSslPeer(tep);
     }
     u_arraylist_free(&g_caSslContext->peerList);
+    memset(g_caSslContext->peerBuckets, 0, sizeof(g_caSslContext->peerBuckets));
 }
 
 CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
@@ -1321,13 +1907,15 @@ CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
     }
     /* No error checking, the connection might be closed already */
     int ret = 0;
+    oc_mutex_lock(tep->mutex);
     do
     {
         ret = mbedtls_ssl_close_notify(&tep->ssl);
     }
     while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
+    oc_mutex_unlock(tep->mutex);
 
-    RemovePeerFromList(&tep->sep.endpoint);
+    RemoveSslPeer(tep);
     oc_mutex_unlock(g_sslContextMutex);
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
@@ -1347,6 +1935,9 @@ CAResult_t CAcloseSslConnectionUsingUuid(const uint8_t *identity, size_t idLengt
         return CA_STATUS_FAILED;
     }
 
+    // the device must not resume its sessions either
+    ForgetSessionsOfIdentity(identity, idLength);
+
     SslEndPoint_t* tep = GetSslPeerUsingUuid(identity, idLength);
     if (NULL == tep)
     {
@@ -1357,19 +1948,35 @@ CAResult_t CAcloseSslConnectionUsingUuid(const uint8_t *identity, size_t idLengt
 
     /* No error checking, the connection might be closed already */
     int ret = 0;
+    oc_mutex_lock(tep->mutex);
     do
     {
         ret = mbedtls_ssl_close_notify(&tep->ssl);
     }
     while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
+    oc_mutex_unlock(tep->mutex);
 
-    RemovePeerFromList(&tep->sep.endpoint);
+    RemoveSslPeer(tep);
     oc_mutex_unlock(g_sslContextMutex);
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
     return CA_STATUS_OK;
 }
 
+void CAforgetSslSessions(void)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+
+    oc_mutex_lock(g_sslContextMutex);
+    if (NULL != g_caSslContext)
+    {
+        ForgetAllSessions();
+    }
+    oc_mutex_unlock(g_sslContextMutex);
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+}
+
 void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
@@ -1410,8 +2017,7 @@ void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
         while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);*/
 
         // delete from list
-        u_arraylist_remove(g_caSslContext->peerList, i - 1);
-        DeleteSslEndPoint(tep);
+        RemoveSslPeer(tep);
     }
     oc_mutex_unlock(g_sslContextMutex);
 
@@ -1479,6 +2085,16 @@ static SslEndPoint_t * NewSslEndPoint(const CAEndpoint_t * endpoint, mbedtls_ssl
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
         return NULL;
     }
+    tep->mutex = oc_mutex_new();
+    if (NULL == tep->mutex)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "mutex initialization failed!");
+        u_arraylist_free(&tep->cacheList);
+        mbedtls_ssl_free(&tep->ssl);
+        OICFree(tep);
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return NULL;
+    }
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "New [%s role] endpoint added [%s:%d]",
             (MBEDTLS_SSL_IS_SERVER==config->endpoint ? "server" : "client"),
             endpoint->addr, endpoint->port);
@@ -1622,8 +2238,9 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
     //Load allowed SVR suites from SVR DB
     SetupCipher(config, endpoint->adapter);
 
-    ret = u_arraylist_add(g_caSslContext->peerList, (void *) tep);
-    if (!ret)
+    OfferSavedSession(tep, config);
+
+    if (!AddPeerToList(tep))
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
         DeleteSslEndPoint(tep);
@@ -1674,6 +2291,16 @@ void CAdeinitSslAdapter()
     // Clear all lists
     DeletePeerList();
 
+    // Wait for the threads reading or writing a peer outside the mutex, which
+    // still use the context. New calls meanwhile find no context.
+    SslContext_t * context = g_caSslContext;
+    g_caSslContext = NULL;
+    while (0 < g_sslPeerRefCount)
+    {
+        oc_cond_wait(g_sslPeerReleased, g_sslContextMutex);
+    }
+    g_caSslContext = context;
+
     // De-initialize mbedTLS
     mbedtls_x509_crt_free(&g_caSslContext->ca);
     mbedtls_x509_crt_free(&g_caSslContext->crt);
@@ -1688,6 +2315,7 @@ void CAdeinitSslAdapter()
     mbedtls_ssl_config_free(&g_caSslContext->serverDtlsConf);
     mbedtls_ssl_cookie_free(&g_caSslContext->cookieCtx);
 #endif // __WITH_DTLS__
+    DeInitSessionCache();
     mbedtls_ctr_drbg_free(&g_caSslContext->rnd);
     mbedtls_entropy_free(&g_caSslContext->entropy);
 #ifdef __WITH_DTLS__
@@ -1697,17 +2325,14 @@ void CAdeinitSslAdapter()
     OICFree(g_caSslContext);
     g_caSslContext = NULL;
 
-    // Delete decrypt buffer
-    if (g_decryptBuffer)
-    {
-        OICFree(g_decryptBuffer);
-        g_decryptBuffer = NULL;
-    }
-
     // Unlock tlsContext mutex and de-initialize it
     oc_mutex_unlock(g_sslContextMutex);
     oc_mutex_free(g_sslContextMutex);
     g_sslContextMutex = NULL;
+    oc_mutex_free(g_sslRngMutex);
+    g_sslRngMutex = NULL;
+    oc_cond_free(g_sslPeerReleased);
+    g_sslPeerReleased = NULL;
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s ", __func__);
 }
@@ -1725,7 +2350,7 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
     }
 
     mbedtls_ssl_conf_psk_cb(conf, GetPskCredentialsCallback, NULL);
-    mbedtls_ssl_conf_rng(conf, mbedtls_ctr_drbg_random, &g_caSslContext->rnd);
+    mbedtls_ssl_conf_rng(conf, SslRandom, &g_caSslContext->rnd);
     mbedtls_ssl_conf_curves(conf, curve[ADAPTER_CURVE_SECP256R1]);
     mbedtls_ssl_conf_min_version(conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
     mbedtls_ssl_conf_renegotiation(conf, MBEDTLS_SSL_RENEGOTIATION_DISABLED);
@@ -1806,6 +2431,19 @@ CAResult_t CAinitSslAdapter()
     {
         g_sslContextMutex = oc_mutex_new();
         VERIFY_NON_NULL_RET(g_sslContextMutex, NET_SSL_TAG, "malloc failed", CA_MEMORY_ALLOC_FAILED);
+        g_sslRngMutex = oc_mutex_new();
+        g_sslPeerReleased = oc_cond_new();
+        if (NULL == g_sslRngMutex || NULL == g_sslPeerReleased)
+        {
+            OIC_LOG(ERROR, NET_SSL_TAG, "malloc failed");
+            oc_mutex_free(g_sslContextMutex);
+            g_sslContextMutex = NULL;
+            oc_mutex_free(g_sslRngMutex);
+            g_sslRngMutex = NULL;
+            oc_cond_free(g_sslPeerReleased);
+            g_sslPeerReleased = NULL;
+            return CA_MEMORY_ALLOC_FAILED;
+        }
     }
     else
     {
@@ -1823,6 +2461,10 @@ CAResult_t CAinitSslAdapter()
         oc_mutex_unlock(g_sslContextMutex);
         oc_mutex_free(g_sslContextMutex);
         g_sslContextMutex = NULL;
+        oc_mutex_free(g_sslRngMutex);
+        g_sslRngMutex = NULL;
+        oc_cond_free(g_sslPeerReleased);
+        g_sslPeerReleased = NULL;
         return CA_MEMORY_ALLOC_FAILED;
     }
 
@@ -1837,6 +2479,10 @@ CAResult_t CAinitSslAdapter()
         oc_mutex_unlock(g_sslContextMutex);
         oc_mutex_free(g_sslContextMutex);
         g_sslContextMutex = NULL;
+        oc_mutex_free(g_sslRngMutex);
+        g_sslRngMutex = NULL;
+        oc_cond_free(g_sslPeerReleased);
+        g_sslPeerReleased = NULL;
         return CA_STATUS_FAILED;
     }
 
@@ -1910,7 +2556,7 @@ CAResult_t CAinitSslAdapter()
 #endif // __WITH_TLS__
 #ifdef __WITH_DTLS__
     mbedtls_ssl_cookie_init(&g_caSslContext->cookieCtx);
-    if (0 != mbedtls_ssl_cookie_setup(&g_caSslContext->cookieCtx, mbedtls_ctr_drbg_random,
+    if (0 != mbedtls_ssl_cookie_setup(&g_caSslContext->cookieCtx, SslRandom,
                                       &g_caSslContext->rnd))
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "Cookie setup failed!");
@@ -1954,15 +2600,14 @@ CAResult_t CAinitSslAdapter()
     g_caSslContext->timerId = -1;
 #endif
 
-    // create decrypt buffer
-    g_decryptBuffer = (uint8_t *)OICCalloc(1, TLS_MSG_BUF_LEN);
-    if (NULL == g_decryptBuffer)
+    // init session resumption
+    if (0 != InitSessionCache())
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "Decrypt buffer malloc failed");
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session cache initialization failed!");
         oc_mutex_unlock(g_sslContextMutex);
         CAdeinitSslAdapter();
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-        return CA_MEMORY_ALLOC_FAILED;
+        return CA_STATUS_FAILED;
     }
 
    oc_mutex_unlock(g_sslContextMutex);
@@ -2006,6 +2651,42 @@ SslCacheMessage_t *  NewCacheMessage(uint8_t * data, size_t dataLen)
     return message;
 }
 
+/**
+ * Writes data to an established session, holding the mutex of the session.
+ *
+ * @param[in]  tep    endpoint with session info
+ * @param[in]  data    data to write
+ * @param[in]  dataLen    length of data
+ *
+ * @return  0 on success, mbedTLS error code otherwise
+ */
+static int WriteSslPeer(SslEndPoint_t * tep, const unsigned char * data, size_t dataLen)
+{
+    int ret = 0;
+    size_t written = 0;
+
+    oc_mutex_lock(tep->mutex);
+    do
+    {
+        ret = mbedtls_ssl_write(&tep->ssl, data + written, dataLen - written);
+        if (ret < 0)
+        {
+            if (MBEDTLS_ERR_SSL_WANT_WRITE != ret)
+            {
+                OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedTLS write failed! returned -0x%x", -ret);
+                break;
+            }
+            continue;
+        }
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "mbedTLS write returned with sent bytes[%d]", ret);
+
+        written += ret;
+    } while (dataLen > written);
+    oc_mutex_unlock(tep->mutex);
+
+    return (ret < 0) ? ret : 0;
+}
+
 /* Send data via TLS connection.
  */
 CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
@@ -2049,29 +2730,25 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
 
     if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
     {
-        unsigned char *dataBuf = (unsigned char *)data;
-        size_t written = 0;
-
-        do
-        {
-            ret = mbedtls_ssl_write(&tep->ssl, dataBuf, dataLen - written);
-            if (ret < 0)
-            {
-                if (MBEDTLS_ERR_SSL_WANT_WRITE != ret)
-                {
-                    OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedTLS write failed! returned 0x%x", -ret);
-                    RemovePeerFromList(&tep->sep.endpoint);
-                    oc_mutex_unlock(g_sslContextMutex);
-                    return CA_STATUS_FAILED;
-                }
-                continue;
-            }
-            OIC_LOG_V(DEBUG, NET_SSL_TAG, "mbedTLS write returned with sent bytes[%d]", ret);
+        // Write holding the session only: sessions with other peers go on meanwhile
+        AcquireSslPeer(tep);
+        oc_mutex_unlock(g_sslContextMutex);
 
-            dataBuf += ret;
-            written += ret;
-        } while (dataLen > written);
+        ret = WriteSslPeer(tep, (unsigned char *) data, dataLen);
 
+        oc_mutex_lock(g_sslContextMutex);
+        if (0 > ret)
+        {
+            RemoveSslPeer(tep);
+        }
+        ReleaseSslPeer(tep);
+        oc_mutex_unlock(g_sslContextMutex);
+        if (0 > ret)
+        {
+            return CA_STATUS_FAILED;
+        }
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return CA_STATUS_OK;
     }
     else
     {
@@ -2104,30 +2781,10 @@ static void SendCacheMessages(SslEndPoint_t * tep)
     listLength = u_arraylist_length(tep->cacheList);
     for (listIndex = 0; listIndex < listLength;)
     {
-        int ret = 0;
         SslCacheMessage_t * msg = (SslCacheMessage_t *) u_arraylist_get(tep->cacheList, listIndex);
         if (NULL != msg && NULL != msg->data && 0 != msg->len)
         {
-            unsigned char *dataBuf = (unsigned char *)msg->data;
-            size_t written = 0;
-
-            do
-            {
-                ret = mbedtls_ssl_write(&tep->ssl, dataBuf, msg->len - written);
-                if (ret < 0)
-                {
-                    if (MBEDTLS_ERR_SSL_WANT_WRITE != ret)
-                    {
-                        OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedTLS write failed! returned -0x%x", -ret);
-                        break;
-                    }
-                    continue;
-                }
-                OIC_LOG_V(DEBUG, NET_SSL_TAG, "mbedTLS write returned with sent bytes[%d]", ret);
-
-                dataBuf += ret;
-                written += ret;
-            } while (msg->len > written);
+            WriteSslPeer(tep, msg->data, msg->len);
 
             if (u_arraylist_remove(tep->cacheList, listIndex))
             {
@@ -2157,6 +2814,92 @@ void CAsetSslHandshakeCallback(CAErrorCallback tlsHandshakeCallback)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 
+/**
+ * Reads data of an established session, holding the mutex of the session.
+ *
+ * @param[in]  peer    endpoint with session info
+ * @param[in]  data    received record
+ * @param[in]  dataLen    length of data
+ * @param[in]  recvCallback    callback of the adapter the data is passed to
+ * @param[out]  closed    set if the peer closed the connection
+ *
+ * @return  CA_STATUS_OK on success
+ */
+static CAResult_t ReadSslPeer(SslEndPoint_t * peer, uint8_t * data, uint32_t dataLen,
+                              CAPacketReceivedCallback recvCallback, bool * closed)
+{
+    CAResult_t res = CA_STATUS_OK;
+    int ret = 0;
+
+    oc_mutex_lock(peer->mutex);
+    peer->recBuf.buff = data;
+    peer->recBuf.len = dataLen;
+    peer->recBuf.loaded = 0;
+
+    if (NULL == peer->decryptBuffer)
+    {
+        peer->decryptBuffer = (uint8_t *)OICCalloc(1, TLS_MSG_BUF_LEN);
+        if (NULL == peer->decryptBuffer)
+        {
+            OIC_LOG(ERROR, NET_SSL_TAG, "Decrypt buffer malloc failed");
+            oc_mutex_unlock(peer->mutex);
+            return CA_MEMORY_ALLOC_FAILED;
+        }
+    }
+
+    // flag to read again remained data
+    bool read_more = false;
+    do
+    {
+        read_more = false;
+
+        do
+        {
+            ret = mbedtls_ssl_read(&peer->ssl, peer->decryptBuffer, TLS_MSG_BUF_LEN);
+        } while (MBEDTLS_ERR_SSL_WANT_READ == ret);
+
+        if (MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY == ret ||
+            // TinyDTLS sends fatal close_notify alert
+            (MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE == ret &&
+             MBEDTLS_SSL_ALERT_LEVEL_FATAL == peer->ssl.in_msg[0] &&
+             MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY == peer->ssl.in_msg[1]))
+        {
+            OIC_LOG(INFO, NET_SSL_TAG, "Connection was closed gracefully");
+            *closed = true;
+            break;
+        }
+
+        if (0 > ret)
+        {
+            OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedtls_ssl_read returned -0x%x", -ret);
+            //SSL_RES(peer, CA_STATUS_FAILED);
+            res = CA_STATUS_FAILED;
+            break;
+        }
+        else if (0 < ret)
+        {
+            if (CA_STATUS_OK != recvCallback(&peer->sep, peer->decryptBuffer, ret))
+            {
+                OIC_LOG(ERROR, NET_SSL_TAG, "recvCallback is failed");
+                res = CA_STATUS_FAILED;
+                break;
+            }
+
+            // check if decrypted data is remained in stream transport
+            size_t remained = mbedtls_ssl_get_bytes_avail(&peer->ssl);
+            if (0 < remained &&
+                MBEDTLS_SSL_TRANSPORT_STREAM == peer->ssl.conf->transport)
+            {
+                OIC_LOG_V(DEBUG, NET_SSL_TAG, "need to read %zu bytes more", remained);
+                read_more = true;
+            }
+        }
+    } while (read_more);
+    oc_mutex_unlock(peer->mutex);
+
+    return res;
+}
+
 /* Read data from TLS connection
  */
 CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t dataLen)
@@ -2191,19 +2934,21 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
         //Load allowed TLS suites from SVR DB
         SetupCipher(config, sep->endpoint.adapter);
 
-        ret = u_arraylist_add(g_caSslContext->peerList, (void *) peer);
-        if (!ret)
+        if (!AddPeerToList(peer))
         {
             OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
-            OICFree(peer);
+            DeleteSslEndPoint(peer);
             oc_mutex_unlock(g_sslContextMutex);
             return CA_STATUS_FAILED;
         }
     }
 
-    peer->recBuf.buff = data;
-    peer->recBuf.len = dataLen;
-    peer->recBuf.loaded = 0;
+    if (MBEDTLS_SSL_HANDSHAKE_OVER != peer->ssl.state)
+    {
+        peer->recBuf.buff = data;
+        peer->recBuf.len = dataLen;
+        peer->recBuf.loaded = 0;
+    }
 
     while (MBEDTLS_SSL_HANDSHAKE_OVER != peer->ssl.state)
     {
@@ -2233,6 +2978,10 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
             }
         }
         SSL_CHECK_FAIL(peer, ret, "Handshake error", 1, CA_STATUS_FAILED, MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE);
+        if (NULL != peer->ssl.handshake && peer->ssl.handshake->resume)
+        {
+            peer->resumed = true;
+        }
         if (MBEDTLS_SSL_CLIENT_CHANGE_CIPHER_SPEC == peer->ssl.state)
         {
             memcpy(peer->master, peer->ssl.session_negotiate->master, sizeof(peer->master));
@@ -2245,6 +2994,14 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
 
         if (MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
         {
+            // An abbreviated handshake proves the peer knows the session only
+            if (peer->resumed)
+            {
+                OIC_LOG(DEBUG, NET_SSL_TAG, "(D)TLS session was resumed");
+                ret = RestoreSessionIdentity(peer) ? 0 : -1;
+                SSL_CHECK_FAIL(peer, ret, "Identity of the resumed session is unknown", 1,
+                               CA_STATUS_FAILED, MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE);
+            }
             SSL_RES(peer, CA_STATUS_OK);
             if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
             {
@@ -2253,7 +3010,8 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
 
             int selectedCipher = peer->ssl.session->ciphersuite;
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "(D)TLS Session is connected via ciphersuite [0x%x]", selectedCipher);
-            if (MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256 != selectedCipher &&
+            if (!peer->resumed &&
+                MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256 != selectedCipher &&
                 MBEDTLS_TLS_ECDH_ANON_WITH_AES_128_CBC_SHA256 != selectedCipher)
             {
                 char uuid[UUID_LENGTH * 2 + 5] = {0};
@@ -2297,8 +3055,13 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
                 }
             }
 
+            if (!peer->resumed)
+            {
+                RememberSessionIdentity(peer);
+            }
             if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
             {
+                SaveClientSession(peer);
                 SendCacheMessages(peer);
             }
             mbedtls_ssl_config * config = (sep->endpoint.adapter == CA_ADAPTER_IP ||
@@ -2315,78 +3078,33 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
 
     if (MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
     {
-        // flag to read again remained data
-        bool read_more = false;
-        do
+        int adapterIndex = GetAdapterIndex(peer->sep.endpoint.adapter);
+        if (0 > adapterIndex || MAX_SUPPORTED_ADAPTERS <= adapterIndex)
         {
-            if (NULL == g_decryptBuffer)
-            {
-                OIC_LOG(ERROR, NET_SSL_TAG, "decrypt buffer is NULL");
-                oc_mutex_unlock(g_sslContextMutex);
-                return CA_STATUS_FAILED;
-            }
-            memset(g_decryptBuffer, 0, TLS_MSG_BUF_LEN);
-            read_more = false;
+            OIC_LOG(ERROR, NET_SSL_TAG, "Unsuported adapter");
+            RemoveSslPeer(peer);
+            oc_mutex_unlock(g_sslContextMutex);
+            return CA_STATUS_FAILED;
+        }
+        CAPacketReceivedCallback recvCallback =
+            g_caSslContext->adapterCallbacks[adapterIndex].recvCallback;
 
-            do
-            {
-                ret = mbedtls_ssl_read(&peer->ssl, g_decryptBuffer, TLS_MSG_BUF_LEN);
-            } while (MBEDTLS_ERR_SSL_WANT_READ == ret);
-
-            if (MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY == ret ||
-                // TinyDTLS sends fatal close_notify alert
-                (MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE == ret &&
-                 MBEDTLS_SSL_ALERT_LEVEL_FATAL == peer->ssl.in_msg[0] &&
-                 MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY == peer->ssl.in_msg[1]))
-            {
-                OIC_LOG(INFO, NET_SSL_TAG, "Connection was closed gracefully");
-                RemovePeerFromList(&peer->sep.endpoint);
-                oc_mutex_unlock(g_sslContextMutex);
-                return CA_STATUS_OK;
-            }
+        // Read holding the session only: sessions with other peers go on meanwhile
+        AcquireSslPeer(peer);
+        oc_mutex_unlock(g_sslContextMutex);
 
-            if (0 > ret)
-            {
-                OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedtls_ssl_read returned -0x%x", -ret);
-                //SSL_RES(peer, CA_STATUS_FAILED);
-                RemovePeerFromList(&peer->sep.endpoint);
-                oc_mutex_unlock(g_sslContextMutex);
-                return CA_STATUS_FAILED;
-            }
-            else if (0 < ret)
-            {
-                int adapterIndex = GetAdapterIndex(peer->sep.endpoint.adapter);
-                if (0 <= adapterIndex && MAX_SUPPORTED_ADAPTERS > adapterIndex)
-                {
-                    CAResult_t res;
-                    res = g_caSslContext->adapterCallbacks[adapterIndex].recvCallback(&peer->sep,
-                            g_decryptBuffer, ret);
-                    if (CA_STATUS_OK != res)
-                    {
-                        OIC_LOG(ERROR, NET_SSL_TAG, "recvCallback is failed");
-                        RemovePeerFromList(&peer->sep.endpoint);
-                        oc_mutex_unlock(g_sslContextMutex);
-                        return CA_STATUS_FAILED;
-                    }
+        bool closed = false;
+        CAResult_t res = ReadSslPeer(peer, data, dataLen, recvCallback, &closed);
 
-                    // check if decrypted data is remained in stream transport
-                    size_t remained = mbedtls_ssl_get_bytes_avail(&peer->ssl);
-                    if (0 < remained &&
-                        MBEDTLS_SSL_TRANSPORT_STREAM == peer->ssl.conf->transport)
-                    {
-                        OIC_LOG_V(DEBUG, NET_SSL_TAG, "need to read %zu bytes more", remained);
-                        read_more = true;
-                    }
-                }
-                else
-                {
-                    OIC_LOG(ERROR, NET_SSL_TAG, "Unsuported adapter");
-                    RemovePeerFromList(&peer->sep.endpoint);
-                    oc_mutex_unlock(g_sslContextMutex);
-                    return CA_STATUS_FAILED;
-                }
-            }
-        } while (read_more);
+        oc_mutex_lock(g_sslContextMutex);
+        if (CA_STATUS_OK != res || closed)
+        {
+            RemoveSslPeer(peer);
+        }
+        ReleaseSslPeer(peer);
+        oc_mutex_unlock(g_sslContextMutex);
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return res;
     }
 
     oc_mutex_unlock(g_sslContextMutex);
@@ -2525,6 +3243,8 @@ CAResult_t CAsetTlsCipherSuite(const uint32_t cipher)
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Selected cipher: 0x%x", cipher);
     }
     g_caSslContext->cipher = index;
+    // sessions negotiated before are not resumed under the new selection
+    g_caSslContext->sessionGeneration++;
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
     return CA_STATUS_OK;
@@ -2675,6 +3395,13 @@ CAResult_t CAsslGenerateOwnerPsk(const CAEndpoint_t *endpoint,
         oc_mutex_unlock(g_sslContextMutex);
         return CA_STATUS_FAILED;
     }
+    if (tep->resumed)
+    {
+        // the randoms of the key exchange are those of the full handshake
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session was resumed, no key exchange to derive from");
+        oc_mutex_unlock(g_sslContextMutex);
+        return CA_STATUS_FAILED;
+    }
 
     // keyBlockLen set up according to OIC 1.1 Security Specification Section 7.3.2
     int macKeyLen = 0;
@@ -56,13 +56,206 @@
 #define MAX_BLOCK_DATA_TIMEOUT_SECONDS   (60 * 1)  // 1 minutes.
 #define MILLISECONDS_PER_SECOND   (1000)
 
+// number of buckets of the block data table, a power of 2
+#define BLOCK_DATA_BUCKETS         (64)
+
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .receivedThreadFunc = NULL,
                                           .dataList = NULL };
 
+// block data of g_context.dataList hashed by ID, guarded by blockDataListMutex
+static CABlockData_t *g_blockDataTable[BLOCK_DATA_BUCKETS];
+
+static CABlockStreamHandler g_streamHandler = NULL;
+
 static uint32_t GetTicks(uint32_t milliSeconds);
 
+static size_t CAHashBlockID(const uint8_t *id, size_t idLength)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < idLength; i++)
+    {
+        hash ^= id[i];
+        hash *= 16777619u;
+    }
+    return hash & (BLOCK_DATA_BUCKETS - 1);
+}
+
+// called with blockDataListMutex held
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!blockID || !blockID->id)
+    {
+        return NULL;
+    }
+
+    CABlockData_t *data = g_blockDataTable[CAHashBlockID(blockID->id, blockID->idLength)];
+    while (data && !CABlockidMatches(data, blockID))
+    {
+        data = data->hashNext;
+    }
+    return data;
+}
+
+// called with blockDataListMutex held
+static void CAAddBlockDataToTable(CABlockData_t *data)
+{
+    // append, so the oldest block data of an ID is found first as in the list
+    CABlockData_t **link = &g_blockDataTable[CAHashBlockID(data->blockDataId->id,
+                                                           data->blockDataId->idLength)];
+    while (*link)
+    {
+        link = &(*link)->hashNext;
+    }
+    data->hashNext = NULL;
+    *link = data;
+}
+
+// called with blockDataListMutex held
+static void CARemoveBlockDataFromTable(CABlockData_t *data)
+{
+    CABlockData_t **link = &g_blockDataTable[CAHashBlockID(data->blockDataId->id,
+                                                           data->blockDataId->idLength)];
+    while (*link)
+    {
+        if (*link == data)
+        {
+            *link = data->hashNext;
+            data->hashNext = NULL;
+            return;
+        }
+        link = &(*link)->hashNext;
+    }
+}
+
+static void CAFreeBlockChunks(CABlockData_t *data)
+{
+    CABlockChunk_t *chunk = data->chunksHead;
+    while (chunk)
+    {
+        CABlockChunk_t *next = chunk->next;
+        OICFree(chunk->data);
+        OICFree(chunk);
+        chunk = next;
+    }
+    data->chunksHead = NULL;
+    data->chunksTail = NULL;
+}
+
+static CABlockChunk_t *CAAddBlockChunk(CABlockData_t *data, size_t capacity)
+{
+    CABlockChunk_t *chunk = (CABlockChunk_t *) OICCalloc(1, sizeof(CABlockChunk_t));
+    if (!chunk)
+    {
+        return NULL;
+    }
+
+    chunk->data = (uint8_t *) OICMalloc(capacity);
+    if (!chunk->data)
+    {
+        OICFree(chunk);
+        return NULL;
+    }
+    chunk->capacity = capacity;
+
+    if (data->chunksTail)
+    {
+        data->chunksTail->next = chunk;
+    }
+    else
+    {
+        data->chunksHead = chunk;
+    }
+    data->chunksTail = chunk;
+    return chunk;
+}
+
+static CAResult_t CAAppendBlockPayload(CABlockData_t *data, const uint8_t *payload,
+                                       size_t length)
+{
+    while (length)
+    {
+        CABlockChunk_t *chunk = data->chunksTail;
+        if (!chunk || chunk->length == chunk->capacity)
+        {
+            // start with one block and double, so small transfers stay small
+            // and large ones take few chunks
+            size_t capacity = chunk ? chunk->capacity * 2 : length;
+            chunk = CAAddBlockChunk(data, (length > capacity) ? length : capacity);
+            if (!chunk)
+            {
+                OIC_LOG(ERROR, TAG, "out of memory");
+                return CA_MEMORY_ALLOC_FAILED;
+            }
+        }
+
+        size_t copied = chunk->capacity - chunk->length;
+        if (copied > length)
+        {
+            copied = length;
+        }
+        memcpy(chunk->data + chunk->length, payload, copied);
+        chunk->length += copied;
+        payload += copied;
+        length -= copied;
+    }
+    return CA_STATUS_OK;
+}
+
+// merge the chunks into one, called with blockDataListMutex held
+static CAResult_t CAMergeBlockChunks(CABlockData_t *data)
+{
+    if (data->chunksHead == data->chunksTail)
+    {
+        return CA_STATUS_OK;
+    }
+
+    size_t length = 0;
+    for (CABlockChunk_t *chunk = data->chunksHead; chunk; chunk = chunk->next)
+    {
+        length += chunk->length;
+    }
+
+    CABlockChunk_t *merged = (CABlockChunk_t *) OICCalloc(1, sizeof(CABlockChunk_t));
+    uint8_t *buffer = (uint8_t *) OICMalloc(length);
+    if (!merged || !buffer)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        OICFree(merged);
+        OICFree(buffer);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    size_t offset = 0;
+    for (CABlockChunk_t *chunk = data->chunksHead; chunk; chunk = chunk->next)
+    {
+        memcpy(buffer + offset, chunk->data, chunk->length);
+        offset += chunk->length;
+    }
+    CAFreeBlockChunks(data);
+
+    merged->data = buffer;
+    merged->length = length;
+    merged->capacity = length;
+    data->chunksHead = merged;
+    data->chunksTail = merged;
+    return CA_STATUS_OK;
+}
+
+static void CADestroyBlockData(CABlockData_t *data)
+{
+    if (data->sentData)
+    {
+        CADestroyDataSet(data->sentData);
+    }
+    CADestroyBlockID(data->blockDataId);
+    CAFreeBlockChunks(data);
+    OICFree(data);
+}
+
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
     size_t payloadLen = 0;
@@ -112,6 +305,11 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
     return res;
 }
 
+void CASetBlockStreamHandler(CABlockStreamHandler handler)
+{
+    g_streamHandler = handler;
+}
+
 CAResult_t CATerminateBlockWiseTransfer()
 {
     OIC_LOG(DEBUG, TAG, "CATerminateBlockWiseTransfer");
@@ -776,10 +974,10 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     // if error code is 4.08, remove the stored payload and initialize block number
     if (CA_BLOCK_INCOMPLETE == status)
     {
-        OICFree(data->payload);
-        data->payload = NULL;
+        CAFreeBlockChunks(data);
         data->payloadLength = 0;
         data->receivedPayloadLen = 0;
+        data->streamed = false;
         data->block1.num = 0;
         data->block2.num = 0;
     }
@@ -801,17 +999,12 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
     }
 
     // update payload
-    size_t fullPayloadLen = 0;
-    CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
-    if (fullPayload)
+    CAResult_t res = CAUpdateLastBlockPayload(blockID, cloneData);
+    if (CA_STATUS_OK != res)
     {
-        CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
-        if (CA_STATUS_OK != res)
-        {
-            OIC_LOG(ERROR, TAG, "update has failed");
-            CADestroyDataSet(cloneData);
-            return res;
-        }
+        OIC_LOG(ERROR, TAG, "update has failed");
+        CADestroyDataSet(cloneData);
+        return res;
     }
 
     if (g_context.receivedThreadFunc)
@@ -826,6 +1019,42 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
     return CA_STATUS_OK;
 }
 
+CAResult_t CAUpdateLastBlockPayload(const CABlockDataID_t *blockID, CAData_t *data)
+{
+    VERIFY_NON_NULL(blockID, TAG, "blockID");
+    VERIFY_NON_NULL(data, TAG, "data");
+
+    size_t fullPayloadLen = 0;
+    CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
+    if (fullPayload)
+    {
+        return CAUpdatePayloadToCAData(data, fullPayload, fullPayloadLen);
+    }
+
+    // the last block was streamed already, it is not the whole payload
+    CABlockData_t *blockData = CAGetBlockDataFromBlockDataList(blockID);
+    if (blockData && blockData->streamed)
+    {
+        CAInfo_t *info = NULL;
+        if (CA_REQUEST_DATA == data->dataType && data->requestInfo)
+        {
+            info = &data->requestInfo->info;
+        }
+        else if (CA_RESPONSE_DATA == data->dataType && data->responseInfo)
+        {
+            info = &data->responseInfo->info;
+        }
+
+        if (info)
+        {
+            OICFree(info->payload);
+            info->payload = NULL;
+            info->payloadSize = 0;
+        }
+    }
+    return CA_STATUS_OK;
+}
+
 static CABlockData_t* CACheckTheExistOfBlockData(const CABlockDataID_t* blockDataID,
                                                  coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                                                  uint8_t blockType)
@@ -1963,55 +2192,64 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
                 BLOCK_SIZE(currData->block2.szx) : BLOCK_SIZE(currData->block1.szx);
     }
 
-    // memory allocation for the received block payload
     size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        bool consumed = false;
+        if (g_streamHandler)
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
+            CAToken_t token = NULL;
+            uint8_t tokenLength = 0;
+            if (receivedData->requestInfo)
             {
-                CAPayload_t prePayload = currData->payload;
+                token = receivedData->requestInfo->info.token;
+                tokenLength = receivedData->requestInfo->info.tokenLength;
+            }
+            else if (receivedData->responseInfo)
+            {
+                token = receivedData->responseInfo->info.token;
+                tokenLength = receivedData->responseInfo->info.tokenLength;
+            }
+            consumed = g_streamHandler(receivedData->remoteEndpoint, token, tokenLength,
+                                       prePayloadLen, (const uint8_t *) blockPayload,
+                                       blockPayloadLen);
+        }
 
+        if (consumed)
+        {
+            currData->streamed = true;
+        }
+        else
+        {
+            // in case the block message has the size option, allocate the
+            // memory for the rest of the total payload once
+            size_t remaining = (currData->payloadLength > prePayloadLen) ?
+                    currData->payloadLength - prePayloadLen : 0;
+            CABlockChunk_t *chunk = currData->chunksTail;
+            if (isSizeOption && remaining > blockPayloadLen
+                && (!chunk || chunk->capacity - chunk->length < remaining))
+            {
                 OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
+                if (!CAAddBlockChunk(currData, remaining))
                 {
                     OIC_LOG(ERROR, TAG, "out of memory");
                     return CA_MEMORY_ALLOC_FAILED;
                 }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
             }
 
             // update the total payload
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
-        }
-        else
-        {
-            OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
-
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
-            if (NULL == newPayload)
+            CAResult_t res = CAAppendBlockPayload(currData, (const uint8_t *) blockPayload,
+                                                  blockPayloadLen);
+            if (CA_STATUS_OK != res)
             {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return CA_MEMORY_ALLOC_FAILED;
+                return res;
             }
-
-            // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
-            currData->payload = newPayload;
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
         }
 
         // update received payload length
         currData->receivedPayloadLen += blockPayloadLen;
 
-        OIC_LOG_V(DEBUG, TAG, "updated payload: %s, len: %zu", currData->payload,
-                  currData->receivedPayloadLen);
+        OIC_LOG_V(DEBUG, TAG, "updated payload len: %zu", currData->receivedPayloadLen);
     }
 
     OIC_LOG(DEBUG, TAG, "OUT-UpdatePayloadData");
@@ -2262,17 +2500,13 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID, uint8_t block
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2287,16 +2521,12 @@ uint8_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
+        return currData->type;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2310,15 +2540,11 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return currData->sentData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2333,17 +2559,13 @@ CABlockData_t *CAUpdateDataSetFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CADestroyDataSet(currData->sentData);
-            currData->sentData = CACloneCAData(sendData);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
+        CADestroyDataSet(currData->sentData);
+        currData->sentData = CACloneCAData(sendData);
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return currData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2439,20 +2661,10 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
     VERIFY_NON_NULL_RET(blockID, TAG, "blockID", NULL);
 
     oc_mutex_lock(g_context.blockDataListMutex);
-
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     oc_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData;
 }
 
 coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockType)
@@ -2462,23 +2674,20 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockTyp
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
+        if (COAP_OPTION_BLOCK2 == blockType)
         {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else if (COAP_OPTION_BLOCK1 == blockType)
-            {
-                return &currData->block1;
-            }
+            return &currData->block2;
         }
+        else if (COAP_OPTION_BLOCK1 == blockType)
+        {
+            return &currData->block1;
+        }
+        return NULL;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2495,17 +2704,19 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        CAPayload_t payload = NULL;
+        *fullPayloadLen = 0;
+        if (CA_STATUS_OK == CAMergeBlockChunks(currData) && currData->chunksHead)
         {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
+            *fullPayloadLen = currData->chunksHead->length;
+            payload = (CAPayload_t) currData->chunksHead->data;
         }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
+        return payload;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2583,6 +2794,7 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
         oc_mutex_unlock(g_context.blockDataListMutex);
         return NULL;
     }
+    CAAddBlockDataToTable(data);
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-CreateBlockData");
@@ -2596,28 +2808,21 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        uint32_t index = 0;
+        if (!u_arraylist_get_index(g_context.dataList, currData, &index)
+            || !u_arraylist_remove(g_context.dataList, index))
         {
-            CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
-            if (!removedData)
-            {
-                OIC_LOG(ERROR, TAG, "data is NULL");
-                oc_mutex_unlock(g_context.blockDataListMutex);
-                return CA_STATUS_FAILED;
-            }
-
-            // destroy memory
-            CADestroyDataSet(removedData->sentData);
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
+            OIC_LOG(ERROR, TAG, "data is NULL");
             oc_mutex_unlock(g_context.blockDataListMutex);
-            return CA_STATUS_OK;
+            return CA_STATUS_FAILED;
         }
+        CARemoveBlockDataFromTable(currData);
+
+        // destroy memory
+        CADestroyBlockData(currData);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2637,15 +2842,10 @@ CAResult_t CARemoveAllBlockDataFromList()
         if (removedData)
         {
             // destroy memory
-            if (removedData->sentData)
-            {
-                CADestroyDataSet(removedData->sentData);
-            }
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
+            CADestroyBlockData(removedData);
         }
     }
+    memset(g_blockDataTable, 0, sizeof(g_blockDataTable));
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     return CA_STATUS_OK;
@@ -2786,16 +2986,10 @@ uint32_t GetTicks(uint32_t milliSeconds)
 void CAResetBlockDataTTL(const CABlockDataID_t *blockID)
 {
     oc_mutex_lock(g_context.blockDataListMutex);
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *blockData = CAFindBlockData(blockID);
+    if (blockData)
     {
-        CABlockData_t *blockData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(blockData, blockID))
-        {
-            blockData->ttl = GetTicks(MAX_BLOCK_DATA_TIMEOUT_SECONDS * MILLISECONDS_PER_SECOND);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return;
-        }
+        blockData->ttl = GetTicks(MAX_BLOCK_DATA_TIMEOUT_SECONDS * MILLISECONDS_PER_SECOND);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 }
@@ -2820,10 +3014,8 @@ void CACheckAndDeleteTimedOutBlockData()
             if (blockData)
             {
                 // destroy memory
-                CADestroyDataSet(blockData->sentData);
-                CADestroyBlockID(blockData->blockDataId);
-                OICFree(blockData->payload);
-                OICFree(blockData);
+                CARemoveBlockDataFromTable(blockData);
+                CADestroyBlockData(blockData);
             }
         }
     }
@@ -40,6 +40,10 @@
 #include "catcpadapter.h"
 #endif
 
+#ifdef WITH_BWT
+#include "cablockwisetransfer.h"
+#endif
+
 CAGlobals_t caglobals = { .clientFlags = 0,
                           .serverFlags = 0, };
 
@@ -494,6 +498,17 @@ CAResult_t CAHandleRequestResponse()
     return CA_STATUS_OK;
 }
 
+CAResult_t CAWaitRequestResponse(uint32_t timeoutMs)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CAWaitRequestResponseCallbacks(timeoutMs) ? CA_STATUS_OK : CA_REQUEST_TIMEOUT;
+}
+
 CAResult_t CASelectCipherSuite(const uint16_t cipher, CATransportAdapter_t adapter)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
@@ -604,6 +619,13 @@ CAResult_t CAcloseSslSession(const CAEndpoint_t *endpoint)
     return res;
 }
 
+#ifdef WITH_BWT
+void CARegisterBlockStreamHandler(CABlockStreamHandler StreamHandler)
+{
+    CASetBlockStreamHandler(StreamHandler);
+}
+#endif
+
 #ifdef TCP_ADAPTER
 void CARegisterKeepAliveHandler(CAKeepAliveConnectionCallback ConnHandler)
 {
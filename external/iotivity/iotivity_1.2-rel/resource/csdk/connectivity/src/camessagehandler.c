@@ -38,6 +38,7 @@
 #include "cainterfacecontroller.h"
 #include "caretransmission.h"
 #include "oic_string.h"
+#include "oic_time.h"
 
 #ifdef WITH_BWT
 #include "cablockwisetransfer.h"
@@ -51,6 +52,13 @@
 #define SINGLE_HANDLE
 #define MAX_THREAD_POOL_SIZE    20
 
+/**
+ * Maximum number of received messages handled by one call of
+ * CAHandleRequestResponseCallbacks(). A burst is drained in a few calls
+ * instead of one message per call, without holding the caller for long.
+ */
+#define MAX_HANDLE_MESSAGE_COUNT    32
+
 // thread pool handle
 static ca_thread_pool_t g_threadPoolHandle = NULL;
 
@@ -895,40 +903,78 @@ void CAHandleRequestResponseCallbacks()
     // #1 parse the data
     // #2 get endpoint
 
-    oc_mutex_lock(g_receiveThread.threadMutex);
+    for (uint32_t count = 0; count < MAX_HANDLE_MESSAGE_COUNT; count++)
+    {
+        oc_mutex_lock(g_receiveThread.threadMutex);
 
-    u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
+        u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
 
-    oc_mutex_unlock(g_receiveThread.threadMutex);
+        oc_mutex_unlock(g_receiveThread.threadMutex);
 
-    if (NULL == item || NULL == item->msg)
-    {
-        return;
-    }
+        if (NULL == item)
+        {
+            return;
+        }
+        if (NULL == item->msg)
+        {
+            OICFree(item);
+            continue;
+        }
 
-    // get endpoint
-    CAData_t *td = (CAData_t *) item->msg;
+        // get endpoint
+        CAData_t *td = (CAData_t *) item->msg;
 
-    if (td->requestInfo && g_requestHandler)
-    {
-        OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
-        g_requestHandler(td->remoteEndpoint, td->requestInfo);
+        if (td->requestInfo && g_requestHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "request callback : %d", td->requestInfo->info.numOptions);
+            g_requestHandler(td->remoteEndpoint, td->requestInfo);
+        }
+        else if (td->responseInfo && g_responseHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
+            g_responseHandler(td->remoteEndpoint, td->responseInfo);
+        }
+        else if (td->errorInfo && g_errorHandler)
+        {
+            OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
+            g_errorHandler(td->remoteEndpoint, td->errorInfo);
+        }
+
+        CADestroyData(item->msg, sizeof(CAData_t));
+        OICFree(item);
     }
-    else if (td->responseInfo && g_responseHandler)
+
+#endif // SINGLE_HANDLE
+#endif // SINGLE_THREAD
+}
+
+bool CAWaitRequestResponseCallbacks(uint32_t timeoutMs)
+{
+#ifdef SINGLE_THREAD
+    // nothing to wait on: messages are read by CAHandleRequestResponseCallbacks()
+    (void)timeoutMs;
+    return true;
+#else
+    bool pending = false;
+
+    if (NULL == g_receiveThread.threadMutex)
     {
-        OIC_LOG_V(DEBUG, TAG, "response callback : %d", td->responseInfo->info.numOptions);
-        g_responseHandler(td->remoteEndpoint, td->responseInfo);
+        return false;
     }
-    else if (td->errorInfo && g_errorHandler)
+
+    oc_mutex_lock(g_receiveThread.threadMutex);
+
+    // CAQueueingThreadAddData() signals threadCond for each message queued
+    if (0 == u_queue_get_size(g_receiveThread.dataQueue) && 0 < timeoutMs)
     {
-        OIC_LOG_V(DEBUG, TAG, "error callback error: %d", td->errorInfo->result);
-        g_errorHandler(td->remoteEndpoint, td->errorInfo);
+        oc_cond_wait_for(g_receiveThread.threadCond, g_receiveThread.threadMutex,
+                         (uint64_t)timeoutMs * US_PER_MS);
     }
+    pending = (0 < u_queue_get_size(g_receiveThread.dataQueue));
 
-    CADestroyData(item->msg, sizeof(CAData_t));
-    OICFree(item);
+    oc_mutex_unlock(g_receiveThread.threadMutex);
 
-#endif // SINGLE_HANDLE
+    return pending;
 #endif // SINGLE_THREAD
 }
 
@@ -1055,7 +1101,7 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
 
 #ifdef ARDUINO
     // If max retransmission queue is reached, then don't handle new request
-    if (CA_MAX_RT_ARRAY_SIZE == u_arraylist_length(g_retransmissionContext.dataList))
+    if (CA_MAX_RT_ARRAY_SIZE == g_retransmissionContext.dataCount)
     {
         OIC_LOG(ERROR, TAG, "max RT queue size reached!");
         return CA_SEND_FAILED;
@@ -1422,6 +1468,13 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
 #ifndef ARDUINO
 static void CALogPDUInfo(const CAData_t *data, const coap_pdu_t *pdu)
 {
+#ifndef OIC_SUPPORT_TIZEN_TRACE
+    // Nothing to print, skip building the analyzer buffers of every packet
+    if (!OIC_LOG_ENABLED(INFO))
+    {
+        return;
+    }
+#endif
     OIC_LOG(DEBUG, TAG, "CALogPDUInfo");
 
     VERIFY_NON_NULL_VOID(data, TAG, "data");
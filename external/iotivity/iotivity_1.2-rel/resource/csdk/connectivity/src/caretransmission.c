@@ -76,43 +76,349 @@
 #include "caremotehandler.h"
 #include "caprotocolmessage.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
 #include "oic_time.h"
 #include "ocrandom.h"
 #include "logger.h"
 
 #define TAG "OIC_CA_RETRANS"
 
-typedef struct
+typedef struct CARetransmissionData
 {
-    uint64_t timeStamp;                 /**< last sent time. microseconds */
-#ifndef SINGLE_THREAD
-    uint64_t timeout;                   /**< timeout value. microseconds */
-#endif
+    uint64_t timeStamp;                 /**< first sent time. microseconds */
+    uint64_t deadline;                  /**< next send time. microseconds */
+    uint64_t interval;                  /**< current timeout. microseconds */
+    uint64_t rto;                       /**< RTO the first timeout was drawn from */
+    uint32_t heapIndex;                 /**< index in the heap of the context */
     uint8_t triedCount;                 /**< retransmission count */
     uint16_t messageId;                 /**< coap PDU message id */
     CADataType_t dataType;              /**< data Type (Request/Response) */
     CAEndpoint_t *endpoint;             /**< remote endpoint */
     void *pdu;                          /**< coap PDU */
     uint32_t size;                      /**< coap PDU size */
+    struct CARetransmissionData *next;  /**< next data of the same message ID hash */
 } CARetransmissionData_t;
 
+/**
+ * Round-trip time estimators of a remote endpoint, after CoCoA: a strong
+ * estimator fed by the exchanges answered without retransmission and a weak
+ * one fed by those answered after one or two retransmissions.
+ */
+typedef struct CARetransmissionPeer
+{
+    CATransportAdapter_t adapter;       /**< adapter of the endpoint */
+    uint16_t port;                      /**< port of the endpoint */
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< address of the endpoint */
+    uint64_t strongSrtt;                /**< smoothed RTT, microseconds */
+    uint64_t strongRttvar;              /**< RTT variation, microseconds */
+    uint64_t weakSrtt;                  /**< smoothed RTT, microseconds */
+    uint64_t weakRttvar;                /**< RTT variation, microseconds */
+    uint64_t rto;                       /**< overall RTO, microseconds */
+    uint64_t updated;                   /**< time of the last RTO update */
+    struct CARetransmissionPeer *next;  /**< next peer */
+} CARetransmissionPeer_t;
+
 static const uint64_t USECS_PER_SEC = 1000000;
-static const uint64_t MSECS_PER_SEC = 1000;
 
-#ifndef SINGLE_THREAD
+/** bounds of the RTO, microseconds. **/
+static const uint64_t MIN_RTO_USEC = 200000;
+static const uint64_t MAX_RTO_USEC = 32000000;
+
 /**
- * @brief   timeout value is
- *          between DEFAULT_ACK_TIMEOUT_SEC and
- *          (DEFAULT_ACK_TIMEOUT_SEC * DEFAULT_RANDOM_FACTOR) second.
+ * @brief   first timeout of an exchange is
+ *          between rto and (rto * DEFAULT_RANDOM_FACTOR).
  *          DEFAULT_RANDOM_FACTOR       1.5 (CoAP)
  * @return  microseconds.
  */
-static uint64_t CAGetTimeoutValue()
+static uint64_t CAGetTimeoutValue(uint64_t rto)
+{
+    return rto + ((rto * OCGetRandomByte()) >> 9);
+}
+
+/**
+ * @brief   variable backoff factor of CoCoA: short timeouts grow faster and
+ *          long ones slower than the doubling of CoAP.
+ */
+static uint64_t CAGetNextInterval(const CARetransmissionData_t *retData)
+{
+    if (retData->rto < USECS_PER_SEC)
+    {
+        return retData->interval * 3;
+    }
+    if (retData->rto > 3 * USECS_PER_SEC)
+    {
+        return retData->interval + retData->interval / 2;
+    }
+    return retData->interval * 2;
+}
+
+static bool CAPeerMatches(const CARetransmissionPeer_t *peer, const CAEndpoint_t *endpoint)
+{
+    return peer->adapter == endpoint->adapter && peer->port == endpoint->port
+           && 0 == strncmp(peer->addr, endpoint->addr, sizeof(peer->addr));
+}
+
+static CARetransmissionPeer_t *CAFindPeer(CARetransmission_t *context,
+                                          const CAEndpoint_t *endpoint)
 {
-    return ((DEFAULT_ACK_TIMEOUT_SEC * MSECS_PER_SEC)
-            + ((MSECS_PER_SEC * OCGetRandomByte()) >> 8)) * MSECS_PER_SEC;
+    CARetransmissionPeer_t *peer = context->peers;
+    while (peer && !CAPeerMatches(peer, endpoint))
+    {
+        peer = peer->next;
+    }
+    return peer;
 }
 
+/**
+ * @brief   RTO of an endpoint, aged when it has not been updated for a while.
+ * @return  microseconds.
+ */
+static uint64_t CAGetPeerRTO(CARetransmission_t *context, const CAEndpoint_t *endpoint,
+                             uint64_t currentTime)
+{
+    uint64_t defaultRto = DEFAULT_ACK_TIMEOUT_SEC * USECS_PER_SEC;
+
+    CARetransmissionPeer_t *peer = CAFindPeer(context, endpoint);
+    if (!peer)
+    {
+        return defaultRto;
+    }
+
+    if (peer->rto < USECS_PER_SEC && currentTime - peer->updated > 16 * peer->rto)
+    {
+        peer->rto *= 2;
+        peer->updated = currentTime;
+    }
+    else if (peer->rto > 3 * USECS_PER_SEC && currentTime - peer->updated > 4 * peer->rto)
+    {
+        peer->rto = (defaultRto + peer->rto) / 2;
+        peer->updated = currentTime;
+    }
+    return peer->rto;
+}
+
+static void CAUpdateEstimator(uint64_t *srtt, uint64_t *rttvar, uint64_t rtt)
+{
+    if (!*srtt)
+    {
+        *srtt = rtt;
+        *rttvar = rtt / 2;
+        return;
+    }
+
+    // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - RTT|, SRTT = 7/8 SRTT + 1/8 RTT
+    uint64_t delta = (*srtt > rtt) ? *srtt - rtt : rtt - *srtt;
+    *rttvar = (3 * *rttvar + delta) / 4;
+    *srtt = (7 * *srtt + rtt) / 8;
+}
+
+/**
+ * @brief   feed the round-trip time of an acknowledged exchange to the
+ *          estimators of its endpoint.
+ */
+static void CAUpdatePeerRTO(CARetransmission_t *context, const CARetransmissionData_t *retData,
+                            uint64_t currentTime)
+{
+    // the RTT of exchanges retransmitted more than twice is too ambiguous
+    if (retData->triedCount > 2 || currentTime < retData->timeStamp)
+    {
+        return;
+    }
+    uint64_t rtt = currentTime - retData->timeStamp;
+
+    CARetransmissionPeer_t *peer = CAFindPeer(context, retData->endpoint);
+    if (!peer)
+    {
+        uint32_t count = 0;
+        CARetransmissionPeer_t *oldest = NULL;
+        for (CARetransmissionPeer_t *p = context->peers; p; p = p->next)
+        {
+            if (!oldest || p->updated < oldest->updated)
+            {
+                oldest = p;
+            }
+            count++;
+        }
+
+        if (count < RETRANSMISSION_MAX_PEERS)
+        {
+            peer = (CARetransmissionPeer_t *) OICMalloc(sizeof(CARetransmissionPeer_t));
+            if (!peer)
+            {
+                return;
+            }
+            peer->next = context->peers;
+            context->peers = peer;
+        }
+        else
+        {
+            // reuse the endpoint not heard from for the longest time
+            peer = oldest;
+        }
+
+        CARetransmissionPeer_t *next = peer->next;
+        memset(peer, 0, sizeof(CARetransmissionPeer_t));
+        peer->next = next;
+        peer->adapter = retData->endpoint->adapter;
+        peer->port = retData->endpoint->port;
+        OICStrcpy(peer->addr, sizeof(peer->addr), retData->endpoint->addr);
+        peer->rto = DEFAULT_ACK_TIMEOUT_SEC * USECS_PER_SEC;
+    }
+
+    uint64_t estimate = 0;
+    if (0 == retData->triedCount)
+    {
+        // strong estimator: RTO = SRTT + 4 * RTTVAR, weighs 1/2
+        CAUpdateEstimator(&peer->strongSrtt, &peer->strongRttvar, rtt);
+        estimate = peer->strongSrtt + 4 * peer->strongRttvar;
+        estimate = (estimate + peer->rto) / 2;
+    }
+    else
+    {
+        // weak estimator: RTO = SRTT + RTTVAR, weighs 1/4
+        CAUpdateEstimator(&peer->weakSrtt, &peer->weakRttvar, rtt);
+        estimate = peer->weakSrtt + peer->weakRttvar;
+        estimate = (estimate + 3 * peer->rto) / 4;
+    }
+
+    if (estimate < MIN_RTO_USEC)
+    {
+        estimate = MIN_RTO_USEC;
+    }
+    else if (estimate > MAX_RTO_USEC)
+    {
+        estimate = MAX_RTO_USEC;
+    }
+    peer->rto = estimate;
+    peer->updated = currentTime;
+}
+
+static void CAHeapSwap(CARetransmission_t *context, uint32_t a, uint32_t b)
+{
+    CARetransmissionData_t *tmp = context->dataHeap[a];
+    context->dataHeap[a] = context->dataHeap[b];
+    context->dataHeap[b] = tmp;
+    context->dataHeap[a]->heapIndex = a;
+    context->dataHeap[b]->heapIndex = b;
+}
+
+static void CAHeapUp(CARetransmission_t *context, uint32_t index)
+{
+    while (index > 0)
+    {
+        uint32_t parent = (index - 1) / 2;
+        if (context->dataHeap[parent]->deadline <= context->dataHeap[index]->deadline)
+        {
+            break;
+        }
+        CAHeapSwap(context, parent, index);
+        index = parent;
+    }
+}
+
+static void CAHeapDown(CARetransmission_t *context, uint32_t index)
+{
+    for (;;)
+    {
+        uint32_t smallest = index;
+        uint32_t left = 2 * index + 1;
+        uint32_t right = left + 1;
+
+        if (left < context->dataCount
+            && context->dataHeap[left]->deadline < context->dataHeap[smallest]->deadline)
+        {
+            smallest = left;
+        }
+        if (right < context->dataCount
+            && context->dataHeap[right]->deadline < context->dataHeap[smallest]->deadline)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        CAHeapSwap(context, index, smallest);
+        index = smallest;
+    }
+}
+
+static uint32_t CAHashMessageId(uint16_t messageId)
+{
+    return messageId & (RETRANSMISSION_TABLE_SIZE - 1);
+}
+
+static CARetransmissionData_t *CAFindRetransmissionData(CARetransmission_t *context,
+                                                        uint16_t messageId,
+                                                        CATransportAdapter_t adapter)
+{
+    CARetransmissionData_t *retData = context->dataTable[CAHashMessageId(messageId)];
+    while (retData && !(retData->messageId == messageId && retData->endpoint->adapter == adapter))
+    {
+        retData = retData->next;
+    }
+    return retData;
+}
+
+static bool CAAddRetransmissionData(CARetransmission_t *context,
+                                    CARetransmissionData_t *retData)
+{
+    if (context->dataCount == context->dataCapacity)
+    {
+        uint32_t capacity = context->dataCapacity ? context->dataCapacity * 2 : 8;
+        CARetransmissionData_t **heap = (CARetransmissionData_t **) OICRealloc(
+                context->dataHeap, capacity * sizeof(CARetransmissionData_t *));
+        if (!heap)
+        {
+            return false;
+        }
+        context->dataHeap = heap;
+        context->dataCapacity = capacity;
+    }
+
+    retData->heapIndex = context->dataCount;
+    context->dataHeap[context->dataCount++] = retData;
+    CAHeapUp(context, retData->heapIndex);
+
+    uint32_t bucket = CAHashMessageId(retData->messageId);
+    retData->next = context->dataTable[bucket];
+    context->dataTable[bucket] = retData;
+    return true;
+}
+
+static void CARemoveRetransmissionData(CARetransmission_t *context,
+                                       CARetransmissionData_t *retData)
+{
+    uint32_t index = retData->heapIndex;
+    context->dataCount--;
+    if (index != context->dataCount)
+    {
+        // move the last data to the hole and restore the heap order around it
+        CARetransmissionData_t *moved = context->dataHeap[context->dataCount];
+        CAHeapSwap(context, index, context->dataCount);
+        CAHeapUp(context, index);
+        CAHeapDown(context, moved->heapIndex);
+    }
+
+    CARetransmissionData_t **link = &context->dataTable[CAHashMessageId(retData->messageId)];
+    while (*link && *link != retData)
+    {
+        link = &(*link)->next;
+    }
+    if (*link)
+    {
+        *link = retData->next;
+    }
+}
+
+static void CADestroyRetransmissionData(CARetransmissionData_t *retData)
+{
+    CAFreeEndpoint(retData->endpoint);
+    OICFree(retData->pdu);
+    OICFree(retData);
+}
+
+#ifndef SINGLE_THREAD
 CAResult_t CARetransmissionStart(CARetransmission_t *context)
 {
     if (NULL == context)
@@ -144,41 +450,6 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 }
 #endif
 
-/**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
- * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
- */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
-{
-#ifndef SINGLE_THREAD
-    // #1. calculate timeout
-    uint32_t milliTimeoutValue = retData->timeout * 0.001;
-    uint64_t timeout = ((uint64_t) milliTimeoutValue << retData->triedCount) * MSECS_PER_SEC;
-
-    if (currentTime >= retData->timeStamp + timeout)
-    {
-#ifndef __TIZENRT__
-        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
-                  timeout, retData->triedCount);
-#endif
-        return true;
-    }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * USECS_PER_SEC;
-
-    if (currentTime >= retData->timeStamp + timeOut)
-    {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
-    }
-#endif
-    return false;
-}
-
 static void CACheckRetransmissionList(CARetransmission_t *context)
 {
     if (NULL == context)
@@ -190,66 +461,45 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
 
-    for (i = 0; i < len; i++)
+    // only the messages whose timeout has elapsed are at the top of the heap
+    while (context->dataCount > 0 && context->dataHeap[0]->deadline <= currentTime)
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
+        CARetransmissionData_t *retData = context->dataHeap[0];
 
-        if (NULL == retData)
+        // #1. if time's up, send the data.
+        if (NULL != context->dataSendMethod)
         {
-            continue;
+            OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d, tried count(%d)",
+                      retData->messageId, retData->triedCount);
+            context->dataSendMethod(retData->endpoint, retData->pdu,
+                                    retData->size, retData->dataType);
         }
 
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
-
-        if (CACheckTimeout(currentTime, retData))
-        {
-            // #2. if time's up, send the data.
-            if (NULL != context->dataSendMethod)
-            {
-                OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
-                          retData->messageId);
-                context->dataSendMethod(retData->endpoint, retData->pdu,
-                                        retData->size, retData->dataType);
-            }
+        // #2. increase the retransmission count and schedule the next send.
+        retData->triedCount++;
 
-            // #3. increase the retransmission count and update timestamp.
-            retData->timeStamp = currentTime;
-            retData->triedCount++;
-        }
-
-        // #4. if tried count is max, remove the retransmission data from list.
+        // #3. if tried count is max, remove the retransmission data.
         if (retData->triedCount >= context->config.tryingCount)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                oc_mutex_unlock(context->threadMutex);
-                return;
-            }
+            CARemoveRetransmissionData(context, retData);
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
+                      "msgid=%d", retData->messageId);
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                context->timeoutCallback(retData->endpoint, retData->pdu, retData->size);
             }
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-
-            OICFree(removedData);
-
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
+            CADestroyRetransmissionData(retData);
+            continue;
         }
+
+        retData->interval = CAGetNextInterval(retData);
+        retData->deadline = currentTime + retData->interval;
+        CAHeapDown(context, 0);
     }
 
     // mutex unlock
@@ -283,7 +533,7 @@ void CARetransmissionBaseRoutine(void *threadValue)
         // mutex lock
         oc_mutex_lock(context->threadMutex);
 
-        if (!context->isStop && u_arraylist_length(context->dataList) <= 0)
+        if (!context->isStop && 0 == context->dataCount)
         {
             // if list is empty, thread will wait
             OIC_LOG(DEBUG, TAG, "wait..there is no retransmission data.");
@@ -295,15 +545,18 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
+            // sleep until the earliest timeout, or until a message is added
+            uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+            uint64_t deadline = context->dataHeap[0]->deadline;
+            if (deadline > currentTime)
+            {
 #ifndef __TIZENRT__
-            OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
+                OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
+                          deadline - currentTime);
 #endif
-
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            oc_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+                oc_cond_wait_for(context->threadCond, context->threadMutex,
+                                 deadline - currentTime);
+            }
         }
         else
         {
@@ -369,7 +622,6 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->timeoutCallback = timeoutCallback;
     context->config = cfg;
     context->isStop = false;
-    context->dataList = u_arraylist_create();
 
     return CA_STATUS_OK;
 }
@@ -435,81 +687,52 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     }
 
     // #2. add additional information. (time stamp, retransmission count...)
-    retData->timeStamp = OICGetCurrentTime(TIME_IN_US);
-#ifndef SINGLE_THREAD
-    retData->timeout = CAGetTimeoutValue();
-#endif
     retData->triedCount = 0;
     retData->messageId = messageId;
     retData->endpoint = remoteEndpoint;
     retData->pdu = pduData;
     retData->size = size;
     retData->dataType = dataType;
-#ifndef SINGLE_THREAD
+
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
+    // #3. schedule the first retransmission from the RTO of the endpoint
+    retData->timeStamp = OICGetCurrentTime(TIME_IN_US);
+    retData->rto = CAGetPeerRTO(context, endpoint, retData->timeStamp);
+    retData->interval = CAGetTimeoutValue(retData->rto);
+    retData->deadline = retData->timeStamp + retData->interval;
 
-    // #3. add data into list
-    for (i = 0; i < len; i++)
+    // #4. add data into the heap
+    if (CAFindRetransmissionData(context, messageId, endpoint->adapter))
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
-
-        if (NULL == currData)
-        {
-            continue;
-        }
-
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
 
-            // mutex unlock
-            oc_mutex_unlock(context->threadMutex);
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
+        CADestroyRetransmissionData(retData);
+        return CA_STATUS_FAILED;
     }
 
-    bool res = u_arraylist_add(context->dataList, (void *) retData);
-    if (!res)
+    if (!CAAddRetransmissionData(context, retData))
     {
-        OIC_LOG(ERROR, TAG, "u_arraylist_add failed.");
+        OIC_LOG(ERROR, TAG, "adding retransmission data failed.");
 
         oc_mutex_unlock(context->threadMutex);
 
-        OICFree(retData);
-        OICFree(pduData);
-        OICFree(remoteEndpoint);
+        CADestroyRetransmissionData(retData);
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // notify the thread
+#ifndef SINGLE_THREAD
+    // notify the thread, the new data may time out first
     oc_cond_signal(context->threadCond);
 
     // mutex unlock
     oc_mutex_unlock(context->threadMutex);
-
 #else
-    bool res = u_arraylist_add(context->dataList, (void *) retData);
-    if (!res)
-    {
-        OIC_LOG(ERROR, TAG, "u_arraylist_add failed.");
-
-        oc_mutex_unlock(context->threadMutex);
-
-        OICFree(retData);
-        OICFree(pduData);
-        OICFree(remoteEndpoint);
-        return CA_MEMORY_ALLOC_FAILED;
-    }
+    oc_mutex_unlock(context->threadMutex);
 
     CACheckRetransmissionList(context);
 #endif
@@ -551,75 +774,38 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
 
     // mutex lock
     oc_mutex_lock(context->threadMutex);
-    uint32_t len = u_arraylist_length(context->dataList);
 
-    // find index
-    uint32_t i;
-    for (i = 0; i < len; i++)
+    CARetransmissionData_t *retData = CAFindRetransmissionData(context, messageId,
+                                                               endpoint->adapter);
+    if (retData)
     {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
-
-        if (NULL == retData)
+        // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+        // if retransmission was finish..token will be unavailable.
+        if (CA_EMPTY == code)
         {
-            continue;
-        }
+            OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
-        {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
-            {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
-            }
-
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
+            // copy PDU data
+            (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+            if ((*retransmissionPdu) == NULL)
             {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+                OIC_LOG(ERROR, TAG, "memory error");
 
                 // mutex unlock
                 oc_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            memcpy((*retransmissionPdu), retData->pdu, retData->size);
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+        // #2. learn the round-trip time and remove data
+        CAUpdatePeerRTO(context, retData, OICGetCurrentTime(TIME_IN_US));
+        CARemoveRetransmissionData(context, retData);
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+        OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
 
-            break;
-        }
+        CADestroyRetransmissionData(retData);
     }
 
     // mutex unlock
@@ -669,7 +855,23 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
     oc_mutex_free(context->threadMutex);
     context->threadMutex = NULL;
     oc_cond_free(context->threadCond);
-    u_arraylist_free(&context->dataList);
+
+    for (uint32_t i = 0; i < context->dataCount; i++)
+    {
+        CADestroyRetransmissionData(context->dataHeap[i]);
+    }
+    OICFree(context->dataHeap);
+    context->dataHeap = NULL;
+    context->dataCount = 0;
+    context->dataCapacity = 0;
+    memset(context->dataTable, 0, sizeof(context->dataTable));
+
+    while (context->peers)
+    {
+        CARetransmissionPeer_t *peer = context->peers;
+        context->peers = peer->next;
+        OICFree(peer);
+    }
 
     return CA_STATUS_OK;
 }
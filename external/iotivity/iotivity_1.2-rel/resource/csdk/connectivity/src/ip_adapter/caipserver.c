@@ -193,6 +193,45 @@ static CAIPErrorHandleCallback g_ipErrorHandler = NULL;
 
 static CAIPPacketReceivedCallback g_packetReceivedCallback = NULL;
 
+#if !defined(WSA_CMSG_DATA)
+/**
+ * Number of datagrams read by one call. recvmmsg() reads a batch of them
+ * where it is available, recvmsg() reads them one by one otherwise.
+ */
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define HAVE_RECVMMSG
+#define RECV_BATCH_SIZE 16
+#else
+#define RECV_BATCH_SIZE 1
+#endif
+
+/**
+ * Maximum number of datagrams read from a ready socket before the other
+ * sockets get their turn.
+ */
+#define RECV_MAX_DATAGRAMS 64
+
+/**
+ * Receive buffer of a datagram with its source address and packet info.
+ */
+typedef struct
+{
+    char data[COAP_MAX_PDU_SIZE];
+    struct sockaddr_storage srcAddr;
+    union
+    {
+        struct cmsghdr cmsg;
+        unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+    } cmsg;
+    struct iovec iov;
+} CAIPDatagram_t;
+
+/**
+ * RECV_BATCH_SIZE receive buffers, owned by the receive thread.
+ */
+static CAIPDatagram_t *g_datagrams = NULL;
+#endif
+
 static void CAFindReadyMessage();
 #if !defined(WSA_WAIT_EVENT_0)
 static void CASelectReturned(fd_set *readFds, int ret);
@@ -207,10 +246,23 @@ static void CAReceiveHandler(void *data)
     (void)data;
     OIC_LOG(DEBUG, TAG, "IN - CAReceiveHandler");
 
+#if !defined(WSA_CMSG_DATA)
+    g_datagrams = (CAIPDatagram_t *) OICMalloc(RECV_BATCH_SIZE * sizeof (CAIPDatagram_t));
+    if (!g_datagrams)
+    {
+        OIC_LOG(WARNING, TAG, "Failed to allocate receive buffers, reading one at a time");
+    }
+#endif
+
     while (!caglobals.ip.terminate)
     {
         CAFindReadyMessage();
     }
+
+#if !defined(WSA_CMSG_DATA)
+    OICFree(g_datagrams);
+    g_datagrams = NULL;
+#endif
 #ifndef __TIZENRT__
     if (caglobals.ip.shutdownFds[0] != OC_INVALID_SOCKET)
     {
@@ -573,59 +625,97 @@ void CADeInitializeIPGlobals()
     }
 }
 
-static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
+static void CAPassReceivedData(CATransportFlags_t flags, const unsigned char *pktinfo,
+                               const struct sockaddr_storage *srcAddr, int namelen,
+                               char *data, size_t dataLength)
 {
-    OIC_LOG(DEBUG, TAG, "IN - CAReceiveMessage");
-    char recvBuffer[COAP_MAX_PDU_SIZE] = {0};
+    CASecureEndpoint_t sep = {.endpoint = {.adapter = CA_ADAPTER_IP, .flags = flags}};
 
-    size_t len = 0;
-    int level = 0;
-    int type = 0;
-    int namelen = 0;
-    struct sockaddr_storage srcAddr = { .ss_family = 0 };
-    unsigned char *pktinfo = NULL;
-#if !defined(WSA_CMSG_DATA)
-    struct cmsghdr *cmp = NULL;
-    struct iovec iov = { .iov_base = recvBuffer, .iov_len = sizeof (recvBuffer) };
-    union control
+#ifndef __TIZENRT__
+    if (flags & CA_IPV6)
     {
-        struct cmsghdr cmsg;
-        unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
-    } cmsg;
+        /** @todo figure out correct usage for ifindex, and sin6_scope_id.*/
+        if ((flags & CA_MULTICAST) && pktinfo)
+        {
+            const struct in6_addr *addr = &(((const struct in6_pktinfo *)pktinfo)->ipi6_addr);
+            unsigned char topbits = ((const unsigned char *)addr)[0];
+            if (topbits != 0xff)
+            {
+                sep.endpoint.flags &= ~CA_MULTICAST;
+            }
+        }
+    }
+    else
+#endif
+    {
+        if ((flags & CA_MULTICAST) && pktinfo)
+        {
+            const struct in_addr *addr = &((const struct in_pktinfo *)pktinfo)->ipi_addr;
+            uint32_t host = ntohl(addr->s_addr);
+            unsigned char topbits = ((unsigned char *)&host)[3];
+            if (topbits < 224 || topbits > 239)
+            {
+                sep.endpoint.flags &= ~CA_MULTICAST;
+            }
+        }
+    }
 
-    if (flags & CA_IPV6)
+    CAConvertAddrToName(srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
+
+    if (flags & CA_SECURE)
     {
-        namelen = sizeof (struct sockaddr_in6);
-        level = IPPROTO_IPV6;
-        type = IPV6_PKTINFO;
-        len = sizeof (struct in6_pktinfo);
+#ifdef __WITH_DTLS__
+        int ret = CAdecryptSsl(&sep, (uint8_t *)data, dataLength);
+        OIC_LOG_V(INFO, TAG, "CAdecryptSsl returns [%d]", ret);
+#else
+        OIC_LOG(ERROR, TAG, "Encrypted message but no DTLS");
+#endif
     }
     else
     {
-        namelen = sizeof (struct sockaddr_in);
-        level = IPPROTO_IP;
-        type = IP_PKTINFO;
-        len = sizeof (struct in6_pktinfo);
+        if (g_packetReceivedCallback)
+        {
+            OIC_LOG(DEBUG, TAG, "call receivedCB");
+            g_packetReceivedCallback(&sep, data, dataLength);
+        }
     }
+}
 
-    struct msghdr msg = { .msg_name = &srcAddr,
-                          .msg_namelen = namelen,
-                          .msg_iov = &iov,
-                          .msg_iovlen = 1,
-                          .msg_control = &cmsg,
-                          .msg_controllen = CMSG_SPACE(len) };
+#if !defined(WSA_CMSG_DATA)
+static void CAPrepareDatagram(CAIPDatagram_t *datagram, struct msghdr *msg,
+                              CATransportFlags_t flags)
+{
+    datagram->iov.iov_base = datagram->data;
+    datagram->iov.iov_len = sizeof (datagram->data);
+
+    memset(msg, 0, sizeof (*msg));
+    msg->msg_name = &datagram->srcAddr;
+    msg->msg_namelen = (flags & CA_IPV6) ? sizeof (struct sockaddr_in6)
+                                         : sizeof (struct sockaddr_in);
+    msg->msg_iov = &datagram->iov;
+    msg->msg_iovlen = 1;
+    msg->msg_control = &datagram->cmsg;
+    msg->msg_controllen = CMSG_SPACE(sizeof (struct in6_pktinfo));
+}
 
-    ssize_t recvLen = recvmsg(fd, &msg, flags);
-    if (OC_SOCKET_ERROR == recvLen)
+static void CAPassDatagram(CAIPDatagram_t *datagram, struct msghdr *msg,
+                           CATransportFlags_t flags, size_t recvLen)
+{
+    int level = IPPROTO_IP;
+    int type = IP_PKTINFO;
+    int namelen = sizeof (struct sockaddr_in);
+    unsigned char *pktinfo = NULL;
+
+    if (flags & CA_IPV6)
     {
-        OIC_LOG_V(ERROR, TAG, "Recvfrom failed %s", strerror(errno));
-        return CA_STATUS_FAILED;
+        namelen = sizeof (struct sockaddr_in6);
+        level = IPPROTO_IPV6;
+        type = IPV6_PKTINFO;
     }
-    OIC_LOG_V(DEBUG, TAG, "recvd %u bytes from recvmsg", recvLen);
 
     if (flags & CA_MULTICAST)
     {
-        for (cmp = CMSG_FIRSTHDR(&msg); cmp != NULL; cmp = CMSG_NXTHDR(&msg, cmp))
+        for (struct cmsghdr *cmp = CMSG_FIRSTHDR(msg); cmp != NULL; cmp = CMSG_NXTHDR(msg, cmp))
         {
             if (cmp->cmsg_level == level && cmp->cmsg_type == type)
             {
@@ -633,7 +723,87 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
             }
         }
     }
+
+    CAPassReceivedData(flags, pktinfo, &datagram->srcAddr, namelen, datagram->data, recvLen);
+}
+
+static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
+{
+    OIC_LOG(DEBUG, TAG, "IN - CAReceiveMessage");
+
+    // datagrams are passed to the callback from the receive buffers, which are
+    // only reused for the next read once the callback returned.
+    CAIPDatagram_t datagram;
+    CAIPDatagram_t *datagrams = g_datagrams ? g_datagrams : &datagram;
+    unsigned int count = g_datagrams ? RECV_BATCH_SIZE : 1;
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr msgs[RECV_BATCH_SIZE];
+#else
+    struct msghdr msgs[1];
+#endif
+
+    CAResult_t res = CA_STATUS_OK;
+    size_t total = 0;
+
+    // drain the socket, but leave it for the other sockets after RECV_MAX_DATAGRAMS
+    while (total < RECV_MAX_DATAGRAMS && !caglobals.ip.terminate)
+    {
+#ifdef HAVE_RECVMMSG
+        for (unsigned int i = 0; i < count; i++)
+        {
+            CAPrepareDatagram(&datagrams[i], &msgs[i].msg_hdr, flags);
+            msgs[i].msg_len = 0;
+        }
+        int received = recvmmsg(fd, msgs, count, MSG_DONTWAIT, NULL);
+#else
+        CAPrepareDatagram(&datagrams[0], &msgs[0], flags);
+        ssize_t recvLen = recvmsg(fd, &msgs[0], MSG_DONTWAIT);
+        int received = (OC_SOCKET_ERROR == recvLen) ? -1 : 1;
+#endif
+        if (0 > received)
+        {
+            if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+            {
+                OIC_LOG_V(ERROR, TAG, "Recvfrom failed %s", strerror(errno));
+                res = total ? CA_STATUS_OK : CA_STATUS_FAILED;
+            }
+            break;
+        }
+
+        for (int i = 0; i < received; i++)
+        {
+#ifdef HAVE_RECVMMSG
+            CAPassDatagram(&datagrams[i], &msgs[i].msg_hdr, flags, msgs[i].msg_len);
+#else
+            CAPassDatagram(&datagrams[i], &msgs[i], flags, recvLen);
+#endif
+        }
+        total += received;
+
+        // a short batch means that the socket is empty
+        if ((unsigned int)received < count)
+        {
+            break;
+        }
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "recvd %zu datagrams", total);
+    OIC_LOG(DEBUG, TAG, "OUT - CAReceiveMessage");
+    return res;
+}
+
 #else // if defined(WSA_CMSG_DATA)
+
+static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
+{
+    OIC_LOG(DEBUG, TAG, "IN - CAReceiveMessage");
+    char recvBuffer[COAP_MAX_PDU_SIZE] = {0};
+
+    int level = 0;
+    int type = 0;
+    int namelen = 0;
+    struct sockaddr_storage srcAddr = { .ss_family = 0 };
+    unsigned char *pktinfo = NULL;
     union control
     {
         WSACMSGHDR cmsg;
@@ -681,62 +851,14 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
             }
         }
     }
-#endif // !defined(WSA_CMSG_DATA)
-    CASecureEndpoint_t sep = {.endpoint = {.adapter = CA_ADAPTER_IP, .flags = flags}};
 
-#ifndef __TIZENRT__
-    if (flags & CA_IPV6)
-    {
-        /** @todo figure out correct usage for ifindex, and sin6_scope_id.*/
-        if ((flags & CA_MULTICAST) && pktinfo)
-        {
-            struct in6_addr *addr = &(((struct in6_pktinfo *)pktinfo)->ipi6_addr);
-            unsigned char topbits = ((unsigned char *)addr)[0];
-            if (topbits != 0xff)
-            {
-                sep.endpoint.flags &= ~CA_MULTICAST;
-            }
-        }
-    }
-    else
-#endif
-    {
-        if ((flags & CA_MULTICAST) && pktinfo)
-        {
-            struct in_addr *addr = &((struct in_pktinfo *)pktinfo)->ipi_addr;
-            uint32_t host = ntohl(addr->s_addr);
-            unsigned char topbits = ((unsigned char *)&host)[3];
-            if (topbits < 224 || topbits > 239)
-            {
-                sep.endpoint.flags &= ~CA_MULTICAST;
-            }
-        }
-    }
-
-    CAConvertAddrToName(&srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
-
-    if (flags & CA_SECURE)
-    {
-#ifdef __WITH_DTLS__
-        int ret = CAdecryptSsl(&sep, (uint8_t *)recvBuffer, recvLen);
-        OIC_LOG_V(INFO, TAG, "CAdecryptSsl returns [%d]", ret);
-#else
-        OIC_LOG(ERROR, TAG, "Encrypted message but no DTLS");
-#endif
-    }
-    else
-    {
-        if (g_packetReceivedCallback)
-        {
-            OIC_LOG(DEBUG, TAG, "call receivedCB");
-            g_packetReceivedCallback(&sep, recvBuffer, recvLen);
-        }
-    }
+    CAPassReceivedData(flags, pktinfo, &srcAddr, namelen, recvBuffer, recvLen);
 
     OIC_LOG(DEBUG, TAG, "OUT - CAReceiveMessage");
     return CA_STATUS_OK;
 
 }
+#endif // !defined(WSA_CMSG_DATA)
 
 void CAIPPullData()
 {
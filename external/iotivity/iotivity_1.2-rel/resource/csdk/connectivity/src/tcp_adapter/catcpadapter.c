@@ -194,6 +194,24 @@ CAResult_t CATCPPacketReceivedCB(const CASecureEndpoint_t *sep, const void *data
     //totalLen filled only when header fully read and parsed
     while (0 != bufferLen)
     {
+        //pass complete messages to upper layer without copying them.
+        size_t totalLen = svritem->data ? 0 : CAGetTotalLengthFromBuffer(buffer, bufferLen);
+        if (0 < totalLen && totalLen <= bufferLen)
+        {
+            if (g_networkPacketCallback)
+            {
+                res = g_networkPacketCallback(sep, buffer, totalLen);
+                if (CA_STATUS_OK != res)
+                {
+                    OIC_LOG(ERROR, TAG, "Error parsing CoAP data");
+                    return res;
+                }
+            }
+            buffer += totalLen;
+            bufferLen -= totalLen;
+            continue;
+        }
+
         res = CAConstructCoAP(svritem, &buffer, &bufferLen);
         if (CA_STATUS_OK != res)
         {
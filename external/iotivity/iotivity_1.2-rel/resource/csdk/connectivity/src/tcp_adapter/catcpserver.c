@@ -28,6 +28,11 @@
 #else
 #include <sys/poll.h>
 #endif
+#if defined(__linux__) || (defined(__TIZENRT__) && CONFIG_NFILE_DESCRIPTORS > 0 && \
+    !defined(CONFIG_DISABLE_POLL) && defined(CONFIG_NET_LWIP))
+#include <sys/epoll.h>
+#define TCP_USE_EPOLL
+#endif
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -105,6 +110,38 @@ static CATCPErrorHandleCallback g_tcpErrorHandler = NULL;
  */
 static CATCPConnectionHandleCallback g_connectionCallback = NULL;
 
+/**
+ * Number of buckets of the fd to session table, a power of 2.
+ */
+#define TCP_SESSION_FD_BUCKETS 64
+
+/**
+ * Connected sessions by socket fd, chained through fdNext.
+ */
+static CATCPSessionInfo_t *g_sessionsByFd[TCP_SESSION_FD_BUCKETS];
+
+#ifdef TCP_USE_EPOLL
+/**
+ * Maximum number of events returned by one epoll_wait().
+ */
+#define TCP_EPOLL_EVENTS 16
+
+/**
+ * Epoll instance of the receive thread.
+ * Descriptors are registered when they are opened and removed before they are closed.
+ */
+static int g_epollFd = -1;
+#else
+/**
+ * Descriptors polled by the receive thread.
+ * They are only rebuilt when g_pollFdsDirty was set by a session change.
+ */
+static struct pollfd *g_pollFds = NULL;
+static size_t g_pollFdsCount = 0;
+static size_t g_pollFdsCapacity = 0;
+static bool g_pollFdsDirty = true;
+#endif
+
 static CAResult_t CATCPCreateMutex();
 static void CATCPDestroyMutex();
 static CAResult_t CATCPCreateCond();
@@ -112,7 +149,10 @@ static void CATCPDestroyCond();
 static CASocketFd_t CACreateAcceptSocket(int family, CASocket_t *sock);
 static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock);
 static void CAFindReadyMessage();
-static void CASelectReturned(fd_set *readFds);
+#ifndef TCP_USE_EPOLL
+static void CAPollReturned();
+#endif
+static void CAHandleReadyFd(int fd);
 static void CAReceiveMessage(int fd);
 static void CAReceiveHandler(void *data);
 static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem);
@@ -128,12 +168,149 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem);
         caglobals.tcp.TYPE.fd = OC_INVALID_SOCKET; \
     }
 
-#define CA_FD_SET(TYPE, FDS) \
-    if (caglobals.tcp.TYPE.fd != OC_INVALID_SOCKET) \
-    { \
-        FD_SET(caglobals.tcp.TYPE.fd, FDS); \
+#ifdef TCP_USE_EPOLL
+/**
+ * Register a descriptor with the epoll instance of the receive thread.
+ * An epoll_wait() in progress reports it without being woken up.
+ */
+static void CAWatchFd(int fd)
+{
+    if (OC_INVALID_SOCKET == fd)
+    {
+        return;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (0 != epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl add of %d failed: %s", fd, strerror(errno));
+    }
+}
+
+/**
+ * Remove a descriptor from the epoll instance, before it is closed.
+ */
+static void CAUnwatchFd(int fd)
+{
+    if (OC_INVALID_SOCKET == fd)
+    {
+        return;
+    }
+
+    if (0 != epoll_ctl(g_epollFd, EPOLL_CTL_DEL, fd, NULL))
+    {
+        OIC_LOG_V(DEBUG, TAG, "epoll_ctl del of %d failed: %s", fd, strerror(errno));
+    }
+}
+#endif
+
+/**
+ * Add a connected session to the fd table, called with g_mutexObjectList held.
+ */
+static void CAAddSessionFd(CATCPSessionInfo_t *svritem)
+{
+    size_t bucket = (size_t)svritem->fd & (TCP_SESSION_FD_BUCKETS - 1);
+    svritem->fdNext = g_sessionsByFd[bucket];
+    g_sessionsByFd[bucket] = svritem;
+#ifdef TCP_USE_EPOLL
+    CAWatchFd(svritem->fd);
+#else
+    g_pollFdsDirty = true;
+#endif
+}
+
+/**
+ * Remove a session from the fd table, called with g_mutexObjectList held.
+ */
+static void CARemoveSessionFd(CATCPSessionInfo_t *svritem)
+{
+    if (svritem->fd >= 0)
+    {
+        CATCPSessionInfo_t **link =
+                &g_sessionsByFd[(size_t)svritem->fd & (TCP_SESSION_FD_BUCKETS - 1)];
+        while (*link)
+        {
+            if (*link == svritem)
+            {
+                *link = svritem->fdNext;
+                svritem->fdNext = NULL;
+                break;
+            }
+            link = &(*link)->fdNext;
+        }
+#ifdef TCP_USE_EPOLL
+        CAUnwatchFd(svritem->fd);
+#endif
+    }
+#ifndef TCP_USE_EPOLL
+    g_pollFdsDirty = true;
+#endif
+}
+
+#ifndef TCP_USE_EPOLL
+static bool CAAddPollFd(int fd)
+{
+    if (OC_INVALID_SOCKET == fd)
+    {
+        return true;
+    }
+
+    if (g_pollFdsCount == g_pollFdsCapacity)
+    {
+        size_t capacity = g_pollFdsCapacity ? g_pollFdsCapacity * 2 : 8;
+        struct pollfd *fds = (struct pollfd *) OICRealloc(g_pollFds, capacity * sizeof(*fds));
+        if (!fds)
+        {
+            OIC_LOG(ERROR, TAG, "Out of memory");
+            return false;
+        }
+        g_pollFds = fds;
+        g_pollFdsCapacity = capacity;
+    }
+
+    g_pollFds[g_pollFdsCount].fd = fd;
+    g_pollFds[g_pollFdsCount].events = POLLIN;
+    g_pollFds[g_pollFdsCount].revents = 0;
+    g_pollFdsCount++;
+    return true;
+}
+
+/**
+ * Rebuild the polled descriptors, called with g_mutexObjectList held.
+ */
+static void CAUpdatePollFds()
+{
+    g_pollFdsCount = 0;
+
+    bool result = CAAddPollFd(caglobals.tcp.connectionFds[0]);
+#ifndef __TIZENRT__
+    result = result && CAAddPollFd(caglobals.tcp.shutdownFds[0]);
+#endif
+    result = result && CAAddPollFd(caglobals.tcp.ipv4.fd);
+    result = result && CAAddPollFd(caglobals.tcp.ipv4s.fd);
+    result = result && CAAddPollFd(caglobals.tcp.ipv6.fd);
+    result = result && CAAddPollFd(caglobals.tcp.ipv6s.fd);
+
+    for (size_t i = 0; result && i < TCP_SESSION_FD_BUCKETS; i++)
+    {
+        for (CATCPSessionInfo_t *svritem = g_sessionsByFd[i]; result && svritem;
+             svritem = svritem->fdNext)
+        {
+            if (CONNECTED == svritem->state)
+            {
+                result = CAAddPollFd(svritem->fd);
+            }
+        }
     }
 
+    // retry on the next iteration if some descriptors are missing
+    g_pollFdsDirty = !result;
+}
+#endif
+
 static void CATCPDestroyMutex()
 {
     if (g_mutexObjectList)
@@ -200,37 +377,20 @@ static void CAReceiveHandler(void *data)
 
 static void CAFindReadyMessage()
 {
-    fd_set readFds;
-    struct timeval timeout = { .tv_sec = caglobals.tcp.selectTimeout };
-
-    FD_ZERO(&readFds);
-    CA_FD_SET(ipv4, &readFds);
-    CA_FD_SET(ipv4s, &readFds);
-    CA_FD_SET(ipv6, &readFds);
-    CA_FD_SET(ipv6s, &readFds);
-#ifndef __TIZENRT__
-    if (OC_INVALID_SOCKET != caglobals.tcp.shutdownFds[0])
-    {
-        FD_SET(caglobals.tcp.shutdownFds[0], &readFds);
-    }
-#endif
-    if (OC_INVALID_SOCKET != caglobals.tcp.connectionFds[0])
-    {
-        FD_SET(caglobals.tcp.connectionFds[0], &readFds);
-    }
-
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-    for (size_t i = 0; i < length; i++)
+#ifdef TCP_USE_EPOLL
+    struct epoll_event events[TCP_EPOLL_EVENTS];
+    int ret = epoll_wait(g_epollFd, events, TCP_EPOLL_EVENTS,
+                         caglobals.tcp.selectTimeout * 1000);
+#else
+    oc_mutex_lock(g_mutexObjectList);
+    if (g_pollFdsDirty)
     {
-        CATCPSessionInfo_t *svritem =
-                (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-        if (svritem && 0 <= svritem->fd && CONNECTED == svritem->state)
-        {
-            FD_SET(svritem->fd, &readFds);
-        }
+        CAUpdatePollFds();
     }
+    oc_mutex_unlock(g_mutexObjectList);
 
-    int ret = select(caglobals.tcp.maxfd + 1, &readFds, NULL, NULL, &timeout);
+    int ret = poll(g_pollFds, g_pollFdsCount, caglobals.tcp.selectTimeout * 1000);
+#endif
 
     if (caglobals.tcp.terminate)
     {
@@ -239,69 +399,77 @@ static void CAFindReadyMessage()
     }
     if (0 >= ret)
     {
-        if (0 > ret)
+        if (0 > ret && EINTR != errno)
         {
-            OIC_LOG_V(FATAL, TAG, "select error %s", strerror(errno));
+            OIC_LOG_V(FATAL, TAG, "poll error %s", strerror(errno));
         }
         return;
     }
 
-    CASelectReturned(&readFds);
+#ifdef TCP_USE_EPOLL
+    for (int i = 0; i < ret; i++)
+    {
+        CAHandleReadyFd(events[i].data.fd);
+    }
+#else
+    CAPollReturned();
+#endif
 }
 
-static void CASelectReturned(fd_set *readFds)
+#ifndef TCP_USE_EPOLL
+static void CAPollReturned()
 {
-    VERIFY_NON_NULL_VOID(readFds, TAG, "readFds is NULL");
+    // g_pollFds is only rebuilt by this thread, new sessions are polled on the next call
+    for (size_t i = 0; i < g_pollFdsCount; i++)
+    {
+        if (g_pollFds[i].revents)
+        {
+            CAHandleReadyFd(g_pollFds[i].fd);
+        }
+    }
+}
+#endif
 
-    if (caglobals.tcp.ipv4.fd != -1 && FD_ISSET(caglobals.tcp.ipv4.fd, readFds))
+static void CAHandleReadyFd(int fd)
+{
+    if (fd == caglobals.tcp.ipv4.fd)
     {
         CAAcceptConnection(CA_IPV4, &caglobals.tcp.ipv4);
-        return;
     }
-    else if (caglobals.tcp.ipv4s.fd != -1 && FD_ISSET(caglobals.tcp.ipv4s.fd, readFds))
+    else if (fd == caglobals.tcp.ipv4s.fd)
     {
         CAAcceptConnection(CA_IPV4 | CA_SECURE, &caglobals.tcp.ipv4s);
-        return;
     }
-    else if (caglobals.tcp.ipv6.fd != -1 && FD_ISSET(caglobals.tcp.ipv6.fd, readFds))
+    else if (fd == caglobals.tcp.ipv6.fd)
     {
         CAAcceptConnection(CA_IPV6, &caglobals.tcp.ipv6);
-        return;
     }
-    else if (caglobals.tcp.ipv6s.fd != -1 && FD_ISSET(caglobals.tcp.ipv6s.fd, readFds))
+    else if (fd == caglobals.tcp.ipv6s.fd)
     {
         CAAcceptConnection(CA_IPV6 | CA_SECURE, &caglobals.tcp.ipv6s);
-        return;
     }
-    else if (-1 != caglobals.tcp.connectionFds[0] &&
-            FD_ISSET(caglobals.tcp.connectionFds[0], readFds))
+#ifndef TCP_USE_EPOLL
+    else if (fd == caglobals.tcp.connectionFds[0])
     {
         // new connection was created from remote device.
-        // exit the function to update read file descriptor.
         char buf[MAX_ADDR_STR_SIZE_CA] = {0};
         ssize_t len = read(caglobals.tcp.connectionFds[0], buf, sizeof (buf));
-        if (-1 == len)
+        if (-1 != len)
         {
-            return;
+            OIC_LOG_V(DEBUG, TAG, "Received new connection event with [%s]", buf);
         }
-        OIC_LOG_V(DEBUG, TAG, "Received new connection event with [%s]", buf);
+    }
+#endif
+#ifndef __TIZENRT__
+    else if (fd == caglobals.tcp.shutdownFds[0])
+    {
+        // the terminate flag is checked by the receive loop
         return;
     }
+#endif
     else
     {
-        uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-        for (size_t i = 0; i < length; i++)
-        {
-            CATCPSessionInfo_t *svritem =
-                    (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-            if (svritem && svritem->fd >= 0)
-            {
-                if (FD_ISSET(svritem->fd, readFds))
-                {
-                    CAReceiveMessage(svritem->fd);
-                }
-            }
-        }
+        CAReceiveMessage(fd);
     }
 }
 
@@ -346,6 +514,7 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
             oc_mutex_unlock(g_mutexObjectList);
             return;
         }
+        CAAddSessionFd(svritem);
         oc_mutex_unlock(g_mutexObjectList);
 
         CHECKFD(sockfd);
@@ -527,8 +696,7 @@ static void CAReceiveMessage(int fd)
     CAResult_t res = CA_STATUS_OK;
 
     //get remote device information from file descriptor.
-    size_t index = 0;
-    CATCPSessionInfo_t *svritem = CAGetSessionInfoFromFD(fd, &index);
+    CATCPSessionInfo_t *svritem = CAGetSessionInfoFromFD(fd, NULL);
     if (!svritem)
     {
         OIC_LOG(ERROR, TAG, "there is no connection information in list");
@@ -543,34 +711,9 @@ static void CAReceiveMessage(int fd)
         svritem->protocol = TLS;
 
 #ifdef __WITH_TLS__
-        size_t nbRead = 0;
-        size_t tlsLength = 0;
-
-        if (TLS_HEADER_SIZE > svritem->tlsLen)
-        {
-            nbRead = TLS_HEADER_SIZE - svritem->tlsLen;
-        }
-        else
-        {
-            //[3][4] bytes in tls header are tls payload length
-            tlsLength = TLS_HEADER_SIZE +
-                            (size_t)((svritem->tlsdata[3] << 8) | svritem->tlsdata[4]);
-            OIC_LOG_V(DEBUG, TAG, "total tls length = %u", tlsLength);
-            if (tlsLength > sizeof(svritem->tlsdata))
-            {
-                OIC_LOG_V(ERROR, TAG, "total tls length is too big (buffer size : %u)",
-                                    sizeof(svritem->tlsdata));
-                if (CA_STATUS_OK != CAcloseSslConnection(&svritem->sep.endpoint))
-                {
-                    OIC_LOG(ERROR, TAG, "Failed to close TLS session");
-                }
-                CASearchAndDeleteTCPSession(&(svritem->sep.endpoint));
-                return;
-            }
-            nbRead = tlsLength - svritem->tlsLen;
-        }
-
-        len = recv(fd, svritem->tlsdata + svritem->tlsLen, nbRead, 0);
+        // read as much as the buffer holds, it can contain several records
+        len = recv(fd, svritem->tlsdata + svritem->tlsLen,
+                   sizeof(svritem->tlsdata) - svritem->tlsLen, 0);
         if (len < 0)
         {
             OIC_LOG_V(ERROR, TAG, "recv failed %s", strerror(errno));
@@ -585,14 +728,42 @@ static void CAReceiveMessage(int fd)
         else
         {
             svritem->tlsLen += len;
-            OIC_LOG_V(DEBUG, TAG, "nb_read : %u bytes , recv() : %d bytes, svritem->tlsLen : %u bytes",
-                                nbRead, len, svritem->tlsLen);
-            if (tlsLength > 0 && tlsLength == svritem->tlsLen)
+            OIC_LOG_V(DEBUG, TAG, "recv() : %d bytes, svritem->tlsLen : %zu bytes",
+                                len, svritem->tlsLen);
+
+            size_t offset = 0;
+            while (CA_STATUS_OK == res && svritem->tlsLen - offset >= TLS_HEADER_SIZE)
             {
-                //when successfully read data - pass them to callback.
-                res = CAdecryptSsl(&svritem->sep, (uint8_t *)svritem->tlsdata, svritem->tlsLen);
-                svritem->tlsLen = 0;
+                //[3][4] bytes in tls header are tls payload length
+                size_t tlsLength = TLS_HEADER_SIZE +
+                        (size_t)((svritem->tlsdata[offset + 3] << 8) |
+                                 svritem->tlsdata[offset + 4]);
+                OIC_LOG_V(DEBUG, TAG, "total tls length = %zu", tlsLength);
+                if (tlsLength > sizeof(svritem->tlsdata))
+                {
+                    OIC_LOG_V(ERROR, TAG, "total tls length is too big (buffer size : %zu)",
+                                        sizeof(svritem->tlsdata));
+                    res = CA_RECEIVE_FAILED;
+                    break;
+                }
+                if (svritem->tlsLen - offset < tlsLength)
+                {
+                    break;
+                }
+
+                //when successfully read a record - pass it to callback.
+                svritem->protocol = TLS;
+                res = CAdecryptSsl(&svritem->sep, (uint8_t *)svritem->tlsdata + offset,
+                                   tlsLength);
                 OIC_LOG_V(INFO, TAG, "%s: CAdecryptSsl returned %d", __func__, res);
+                offset += tlsLength;
+            }
+
+            // keep the partial record for the next recv()
+            if (CA_STATUS_OK == res && offset > 0)
+            {
+                memmove(svritem->tlsdata, svritem->tlsdata + offset, svritem->tlsLen - offset);
+                svritem->tlsLen -= offset;
             }
         }
 #endif
@@ -639,6 +810,7 @@ static void CAReceiveMessage(int fd)
     }
 }
 
+#ifndef TCP_USE_EPOLL
 static ssize_t CAWakeUpForReadFdsUpdate(const char *host)
 {
     if (caglobals.tcp.connectionFds[1] != -1)
@@ -657,6 +829,7 @@ static ssize_t CAWakeUpForReadFdsUpdate(const char *host)
     }
     return -1;
 }
+#endif
 
 static CAResult_t CATCPConvertNameToAddr(int family, const char *host, uint16_t port,
                                          struct sockaddr_storage *sockaddr)
@@ -749,14 +922,19 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
     }
 
     OIC_LOG(INFO, TAG, "connect socket success");
+    oc_mutex_lock(g_mutexObjectList);
     svritem->state = CONNECTED;
+    CAAddSessionFd(svritem);
+    oc_mutex_unlock(g_mutexObjectList);
     CHECKFD(svritem->fd);
+#ifndef TCP_USE_EPOLL
     ssize_t len = CAWakeUpForReadFdsUpdate(svritem->sep.endpoint.addr);
     if (-1 == len)
     {
         OIC_LOG(ERROR, TAG, "wakeup receive thread failed");
         return CA_SOCKET_OPERATION_FAILED;
     }
+#endif
     return CA_STATUS_OK;
 }
 
@@ -936,6 +1114,15 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     }
     oc_mutex_unlock(g_mutexObjectList);
 
+#ifdef TCP_USE_EPOLL
+    g_epollFd = epoll_create(TCP_EPOLL_EVENTS);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create failed: %s", strerror(errno));
+        return CA_STATUS_FAILED;
+    }
+#endif
+
     if (caglobals.server)
     {
 #ifndef __WITH_TLS__
@@ -970,10 +1157,22 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     CHECKFD(caglobals.tcp.shutdownFds[0]);
     CHECKFD(caglobals.tcp.shutdownFds[1]);
 #endif
+#ifdef TCP_USE_EPOLL
+    // new sessions are registered right away, no connection event is needed.
+    // TizenRT only watches sockets, so its receive thread stops on the timeout.
+#ifndef __TIZENRT__
+    CAWatchFd(caglobals.tcp.shutdownFds[0]);
+#endif
+    CAWatchFd(caglobals.tcp.ipv4.fd);
+    CAWatchFd(caglobals.tcp.ipv4s.fd);
+    CAWatchFd(caglobals.tcp.ipv6.fd);
+    CAWatchFd(caglobals.tcp.ipv6s.fd);
+#else
     // create pipe for connection event
     CAInitializePipe(caglobals.tcp.connectionFds);
     CHECKFD(caglobals.tcp.connectionFds[0]);
     CHECKFD(caglobals.tcp.connectionFds[1]);
+#endif
 
     caglobals.tcp.terminate = false;
 #ifndef __TIZENRT__
@@ -1018,10 +1217,12 @@ void CATCPStopServer()
     CLOSE_SOCKET(ipv6s);
 #endif
 
+#ifndef TCP_USE_EPOLL
     close(caglobals.tcp.connectionFds[1]);
     close(caglobals.tcp.connectionFds[0]);
     caglobals.tcp.connectionFds[1] = OC_INVALID_SOCKET;
     caglobals.tcp.connectionFds[0] = OC_INVALID_SOCKET;
+#endif
 #ifndef __TIZENRT__
     if (caglobals.tcp.shutdownFds[1] != OC_INVALID_SOCKET)
     {
@@ -1035,6 +1236,19 @@ void CATCPStopServer()
         oc_cond_wait(g_condObjectList, g_mutexObjectList);
         caglobals.tcp.started = false;
     }
+#ifdef TCP_USE_EPOLL
+    if (-1 != g_epollFd)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+#else
+    OICFree(g_pollFds);
+    g_pollFds = NULL;
+    g_pollFdsCount = 0;
+    g_pollFdsCapacity = 0;
+    g_pollFdsDirty = true;
+#endif
 #ifndef __TIZENRT__
     if (caglobals.tcp.shutdownFds[0] != OC_INVALID_SOCKET)
     {
@@ -1243,6 +1457,8 @@ CAResult_t CADisconnectTCPSession(size_t index)
         return CA_STATUS_OK;
     }
 
+    CARemoveSessionFd(removedData);
+
     // close the socket and remove session info in list.
     if (removedData->fd >= 0)
     {
@@ -1359,26 +1575,32 @@ CASocketFd_t CAGetSocketFDFromEndpoint(const CAEndpoint_t *endpoint)
 
 CATCPSessionInfo_t *CAGetSessionInfoFromFD(int fd, size_t *index)
 {
+    if (0 > fd)
+    {
+        return NULL;
+    }
+
     oc_mutex_lock(g_mutexObjectList);
 
-    // check from the last item.
-    CATCPSessionInfo_t *svritem = NULL;
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-    for (size_t i = 0; i < length; i++)
+    CATCPSessionInfo_t *svritem = g_sessionsByFd[(size_t)fd & (TCP_SESSION_FD_BUCKETS - 1)];
+    while (svritem && svritem->fd != fd)
     {
-        svritem = (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
+        svritem = svritem->fdNext;
+    }
 
-        if (svritem && svritem->fd == fd)
+    if (svritem && index)
+    {
+        uint32_t i = 0;
+        if (!u_arraylist_get_index(caglobals.tcp.svrlist, svritem, &i))
         {
-            *index = i;
             oc_mutex_unlock(g_mutexObjectList);
-            return svritem;
+            return NULL;
         }
+        *index = i;
     }
 
     oc_mutex_unlock(g_mutexObjectList);
-
-    return NULL;
+    return svritem;
 }
 
 CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
@@ -1419,6 +1641,22 @@ size_t CAGetTotalLengthFromHeader(const unsigned char *recvBuffer)
     return headerLen + optPaylaodLen;
 }
 
+size_t CAGetTotalLengthFromBuffer(const unsigned char *data, size_t dataLength)
+{
+    if (NULL == data || 0 == dataLength)
+    {
+        return 0;
+    }
+
+    coap_transport_t transport = coap_get_tcp_header_type_from_initbyte(data[0] >> 4);
+    size_t headerLen = coap_get_tcp_header_length_for_transport(transport);
+    if (dataLength < headerLen)
+    {
+        return 0;
+    }
+    return CAGetTotalLengthFromHeader(data);
+}
+
 void CATCPSetErrorHandler(CATCPErrorHandleCallback errorHandleCallback)
 {
     g_tcpErrorHandler = errorHandleCallback;
@@ -18,6 +18,9 @@
  *
  ******************************************************************/
 
+#include <chrono>
+#include <iostream>
+
 #include "gtest/gtest.h"
 #include "cainterface.h"
 #include "cautilinterface.h"
@@ -26,6 +29,7 @@
 #include "cablockwisetransfer.h"
 
 #define LARGE_PAYLOAD_LENGTH    1024
+#define BULK_PAYLOAD_LENGTH     (1024 * 1024)
 
 class CABlockTransferTests : public testing::Test {
     protected:
@@ -750,3 +754,256 @@ TEST_F(CABlockTransferTests, CAUpdatePayloadToCADataWithResponse)
 
     EXPECT_STREQ((const char*) payload, (const char*) cadata.responseInfo->info.payload);
 }
+
+// feed a payload of BULK_PAYLOAD_LENGTH bytes to the block data, blockSize bytes at a time
+static void CAReceiveBulkPayload(CABlockData_t *currData, size_t blockSize, bool isSizeOption)
+{
+    uint8_t *block = (uint8_t *) malloc(blockSize);
+    ASSERT_TRUE(block != NULL);
+
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info.payload = block;
+    responseInfo.info.payloadSize = blockSize;
+
+    CAData_t cadata;
+    memset(&cadata, 0, sizeof(CAData_t));
+    cadata.type = SEND_TYPE_UNICAST;
+    cadata.responseInfo = &responseInfo;
+    cadata.dataType = CA_RESPONSE_DATA;
+
+    if (isSizeOption)
+    {
+        currData->payloadLength = BULK_PAYLOAD_LENGTH;
+    }
+
+    for (size_t offset = 0; offset < BULK_PAYLOAD_LENGTH; offset += blockSize)
+    {
+        for (size_t i = 0; i < blockSize; i++)
+        {
+            block[i] = (uint8_t) ((offset + i) % 251);
+        }
+        ASSERT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &cadata, CA_BLOCK_UNKNOWN,
+                                                    isSizeOption, COAP_OPTION_BLOCK2));
+    }
+    free(block);
+}
+
+static CABlockData_t *CACreateBulkBlockData(CAEndpoint_t *tempRep, CAToken_t token)
+{
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info.type = CA_MSG_NONCONFIRM;
+    responseInfo.info.token = token;
+    responseInfo.info.tokenLength = CA_MAX_TOKEN_LEN;
+
+    CAData_t cadata;
+    memset(&cadata, 0, sizeof(CAData_t));
+    cadata.type = SEND_TYPE_UNICAST;
+    cadata.remoteEndpoint = tempRep;
+    cadata.responseInfo = &responseInfo;
+    cadata.dataType = CA_RESPONSE_DATA;
+
+    return CACreateNewBlockData(&cadata);
+}
+
+static void CACheckBulkPayload(CABlockData_t *currData)
+{
+    size_t fullPayloadLen = 0;
+    CAPayload_t payload = CAGetPayloadFromBlockDataList(currData->blockDataId,
+                                                        &fullPayloadLen);
+    ASSERT_TRUE(payload != NULL);
+    ASSERT_EQ((size_t) BULK_PAYLOAD_LENGTH, fullPayloadLen);
+    for (size_t i = 0; i < fullPayloadLen; i++)
+    {
+        if (payload[i] != (uint8_t) (i % 251))
+        {
+            FAIL() << "wrong payload byte at " << i;
+        }
+    }
+}
+
+TEST_F(CABlockTransferTests, ReassembleBulkPayload)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    for (int sizeOption = 0; sizeOption < 2; sizeOption++)
+    {
+        CABlockData_t *currData = CACreateBulkBlockData(tempRep, tempToken);
+        ASSERT_TRUE(currData != NULL);
+
+        CAReceiveBulkPayload(currData, 64, sizeOption != 0);
+        CACheckBulkPayload(currData);
+
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(currData->blockDataId));
+    }
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+static size_t g_streamedLength = 0;
+
+static bool CAStreamTestHandler(const CAEndpoint_t *endpoint, const CAToken_t token,
+                                uint8_t tokenLength, size_t offset,
+                                const uint8_t *data, size_t dataLength)
+{
+    (void) endpoint;
+    (void) token;
+    (void) tokenLength;
+
+    bool inOrder = (offset == g_streamedLength) && (data[0] == (uint8_t) (offset % 251));
+    EXPECT_TRUE(inOrder);
+    g_streamedLength += dataLength;
+    return true;
+}
+
+TEST_F(CABlockTransferTests, StreamBulkPayload)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CABlockData_t *currData = CACreateBulkBlockData(tempRep, tempToken);
+    ASSERT_TRUE(currData != NULL);
+
+    g_streamedLength = 0;
+    CARegisterBlockStreamHandler(CAStreamTestHandler);
+    CAReceiveBulkPayload(currData, 1024, false);
+    CARegisterBlockStreamHandler(NULL);
+
+    EXPECT_EQ((size_t) BULK_PAYLOAD_LENGTH, g_streamedLength);
+    EXPECT_EQ((size_t) BULK_PAYLOAD_LENGTH, currData->receivedPayloadLen);
+
+    // the consumed blocks are not kept
+    size_t fullPayloadLen = 0;
+    EXPECT_TRUE(NULL == CAGetPayloadFromBlockDataList(currData->blockDataId, &fullPayloadLen));
+    EXPECT_EQ((size_t) 0, fullPayloadLen);
+
+    // nor is the streamed last block passed up as the payload
+    CAData_t *lastBlock = CACloneCAData(currData->sentData);
+    ASSERT_TRUE(lastBlock != NULL);
+    ASSERT_EQ(CA_STATUS_OK, CAUpdatePayloadToCAData(lastBlock, (CAPayload_t) "last", 4));
+    EXPECT_EQ(CA_STATUS_OK, CAUpdateLastBlockPayload(currData->blockDataId, lastBlock));
+    EXPECT_TRUE(NULL == lastBlock->responseInfo->info.payload);
+    EXPECT_EQ((size_t) 0, lastBlock->responseInfo->info.payloadSize);
+    CADestroyDataSet(lastBlock);
+
+    EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(currData->blockDataId));
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, LastBlockCarriesReassembledPayload)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CABlockData_t *currData = CACreateBulkBlockData(tempRep, tempToken);
+    ASSERT_TRUE(currData != NULL);
+
+    CAReceiveBulkPayload(currData, 1024, false);
+
+    CAData_t *lastBlock = CACloneCAData(currData->sentData);
+    ASSERT_TRUE(lastBlock != NULL);
+    ASSERT_EQ(CA_STATUS_OK, CAUpdatePayloadToCAData(lastBlock, (CAPayload_t) "last", 4));
+    EXPECT_EQ(CA_STATUS_OK, CAUpdateLastBlockPayload(currData->blockDataId, lastBlock));
+    ASSERT_EQ((size_t) BULK_PAYLOAD_LENGTH, lastBlock->responseInfo->info.payloadSize);
+    EXPECT_EQ(0, memcmp(lastBlock->responseInfo->info.payload,
+                        currData->chunksHead->data, BULK_PAYLOAD_LENGTH));
+    CADestroyDataSet(lastBlock);
+
+    EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(currData->blockDataId));
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, ChunksSizedFromBlockSize)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CABlockData_t *currData = CACreateBulkBlockData(tempRep, tempToken);
+    ASSERT_TRUE(currData != NULL);
+
+    uint8_t block[16] = { 0 };
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info.payload = block;
+    responseInfo.info.payloadSize = sizeof(block);
+
+    CAData_t cadata;
+    memset(&cadata, 0, sizeof(CAData_t));
+    cadata.type = SEND_TYPE_UNICAST;
+    cadata.responseInfo = &responseInfo;
+    cadata.dataType = CA_RESPONSE_DATA;
+
+    // one block, then chunks doubling in size
+    const size_t capacities[] = { 16, 32, 32, 64, 64, 64, 64 };
+    size_t chunks = 0;
+    for (size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); i++)
+    {
+        ASSERT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &cadata, CA_BLOCK_UNKNOWN,
+                                                    false, COAP_OPTION_BLOCK2));
+        EXPECT_EQ(capacities[i], currData->chunksTail->capacity);
+    }
+    for (CABlockChunk_t *chunk = currData->chunksHead; chunk; chunk = chunk->next)
+    {
+        chunks++;
+    }
+    EXPECT_EQ((size_t) 3, chunks);
+
+    EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(currData->blockDataId));
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, BulkPayloadReassemblyTime)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    const size_t blockSizes[] = { 64, 1024 };
+    for (size_t blockSize : blockSizes)
+    {
+        CABlockData_t *currData = CACreateBulkBlockData(tempRep, tempToken);
+        ASSERT_TRUE(currData != NULL);
+
+        auto start = std::chrono::steady_clock::now();
+        CAReceiveBulkPayload(currData, blockSize, false);
+        size_t fullPayloadLen = 0;
+        CAGetPayloadFromBlockDataList(currData->blockDataId, &fullPayloadLen);
+        std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+
+        std::cout << BULK_PAYLOAD_LENGTH << " bytes in " << blockSize << " byte blocks: "
+                  << elapsed.count() << " ms" << std::endl;
+        EXPECT_EQ((size_t) BULK_PAYLOAD_LENGTH, fullPayloadLen);
+
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(currData->blockDataId));
+    }
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
@@ -0,0 +1,126 @@
+/* *****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "gtest/gtest.h"
+#include "cacommon.h"
+#include "caipinterface.h"
+#include "caipnwmonitor.h"
+#include "cathreadpool.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// number of datagrams sent by the benchmark
+#define BENCHMARK_DATAGRAMS 50000
+
+// datagrams sent at once, few enough not to overflow the socket buffer
+#define BENCHMARK_BURST 64
+
+static std::atomic<size_t> g_receivedDatagrams(0);
+
+static CAResult_t CountDatagramCB(const CASecureEndpoint_t *sep,
+                                  const void *data, uint32_t dataLength)
+{
+    (void)sep;
+    (void)data;
+    (void)dataLength;
+    g_receivedDatagrams++;
+    return CA_STATUS_OK;
+}
+
+static void AdapterStateCB(CATransportAdapter_t adapter, CANetworkStatus_t status)
+{
+    (void)adapter;
+    (void)status;
+}
+
+class CAIPServerTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &m_threadPool));
+        ASSERT_EQ(CA_STATUS_OK, CAIPStartNetworkMonitor(AdapterStateCB, CA_ADAPTER_IP));
+        caglobals.ip.ipv4enabled = true;
+        g_receivedDatagrams = 0;
+        CAIPSetPacketReceiveCallback(CountDatagramCB);
+        ASSERT_EQ(CA_STATUS_OK, CAIPStartServer(m_threadPool));
+    }
+
+    virtual void TearDown()
+    {
+        CAIPStopServer();
+        CAIPSetPacketReceiveCallback(NULL);
+        CAIPStopNetworkMonitor(CA_ADAPTER_IP);
+        ca_thread_pool_free(m_threadPool);
+    }
+
+    ca_thread_pool_t m_threadPool = NULL;
+};
+
+// Sends datagrams to the IPv4 unicast socket over loopback and reports how
+// many datagrams per second the receive thread passes to the adapter.
+TEST_F(CAIPServerTest, ReceiveThroughputOnLoopback)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_NE(-1, fd);
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(caglobals.ip.u4.port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // CoAP NON GET with message ID 1
+    const unsigned char datagram[] = { 0x50, 0x01, 0x00, 0x01 };
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(30);
+
+    // send bursts and wait for each of them to be received
+    for (size_t sent = 0; sent < BENCHMARK_DATAGRAMS; )
+    {
+        for (size_t i = 0; i < BENCHMARK_BURST && sent < BENCHMARK_DATAGRAMS; i++, sent++)
+        {
+            ASSERT_EQ((ssize_t)sizeof(datagram),
+                      sendto(fd, datagram, sizeof(datagram), 0,
+                             (struct sockaddr *)&addr, sizeof(addr)));
+        }
+        while (g_receivedDatagrams < sent && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    close(fd);
+
+    size_t received = g_receivedDatagrams;
+    std::cout << "received " << received << " datagrams in " << elapsed / 1000 << " ms, "
+              << (elapsed ? received * 1000000 / elapsed : 0) << " datagrams/s" << std::endl;
+
+    EXPECT_EQ((size_t)BENCHMARK_DATAGRAMS, received);
+}
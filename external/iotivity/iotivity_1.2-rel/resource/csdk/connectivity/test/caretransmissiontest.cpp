@@ -0,0 +1,155 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "cainterface.h"
+#include "cacommon.h"
+#include "cathreadpool.h"
+#include "caretransmission.h"
+
+// CoAP header: version 1, no token, GET or empty code
+static void CAMakeHeader(uint8_t *pdu, CAMessageType_t type, uint16_t messageId)
+{
+    pdu[0] = 0x40 | (type << 4);
+    pdu[1] = (CA_MSG_CONFIRM == type) ? 0x01 : 0x00;
+    pdu[2] = (uint8_t) (messageId >> 8);
+    pdu[3] = (uint8_t) (messageId & 0xFF);
+}
+
+static std::atomic<int> g_sentCount(0);
+static std::atomic<int> g_timeoutCount(0);
+
+static CAResult_t CACountSend(const CAEndpoint_t *, const void *, uint32_t, CADataType_t)
+{
+    g_sentCount++;
+    return CA_STATUS_OK;
+}
+
+static void CACountTimeout(const CAEndpoint_t *, const void *, uint32_t)
+{
+    g_timeoutCount++;
+}
+
+class CARetransmissionTests : public testing::Test {
+    protected:
+    virtual void SetUp()
+    {
+        g_sentCount = 0;
+        g_timeoutCount = 0;
+
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &m_threadPool));
+
+        // a single retransmission, then the timeout callback
+        CARetransmissionConfig_t config = { CA_ADAPTER_IP, 1 };
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&m_context, m_threadPool,
+                                                           CACountSend, CACountTimeout,
+                                                           &config));
+
+        memset(&m_endpoint, 0, sizeof(CAEndpoint_t));
+        m_endpoint.adapter = CA_ADAPTER_IP;
+        m_endpoint.port = 5683;
+        strncpy(m_endpoint.addr, "127.0.0.1", sizeof(m_endpoint.addr));
+    }
+
+    virtual void TearDown()
+    {
+        CARetransmissionDestroy(&m_context);
+        ca_thread_pool_free(m_threadPool);
+    }
+
+    void send(uint16_t messageId)
+    {
+        uint8_t pdu[4];
+        CAMakeHeader(pdu, CA_MSG_CONFIRM, messageId);
+        EXPECT_EQ(CA_STATUS_OK, CARetransmissionSentData(&m_context, &m_endpoint,
+                                                         CA_REQUEST_DATA, pdu, sizeof(pdu)));
+    }
+
+    void acknowledge(uint16_t messageId)
+    {
+        uint8_t pdu[4];
+        CAMakeHeader(pdu, CA_MSG_ACKNOWLEDGE, messageId);
+        void *retransmissionPdu = NULL;
+        EXPECT_EQ(CA_STATUS_OK, CARetransmissionReceivedData(&m_context, &m_endpoint, pdu,
+                                                             sizeof(pdu), &retransmissionPdu));
+        free(retransmissionPdu);
+    }
+
+    ca_thread_pool_t m_threadPool;
+    CARetransmission_t m_context;
+    CAEndpoint_t m_endpoint;
+};
+
+TEST_F(CARetransmissionTests, AckRemovesMessage)
+{
+    for (uint16_t id = 0; id < 100; id++)
+    {
+        send(id);
+    }
+    EXPECT_EQ(100u, m_context.dataCount);
+
+    // a duplicate message ID is refused
+    uint8_t pdu[4];
+    CAMakeHeader(pdu, CA_MSG_CONFIRM, 10);
+    EXPECT_EQ(CA_STATUS_FAILED, CARetransmissionSentData(&m_context, &m_endpoint,
+                                                         CA_REQUEST_DATA, pdu, sizeof(pdu)));
+
+    for (uint16_t id = 0; id < 100; id += 2)
+    {
+        acknowledge(id);
+    }
+    EXPECT_EQ(50u, m_context.dataCount);
+
+    // an unknown ACK changes nothing
+    acknowledge(1000);
+    EXPECT_EQ(50u, m_context.dataCount);
+}
+
+TEST_F(CARetransmissionTests, FastPeerTimesOutSooner)
+{
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionStart(&m_context));
+
+    // immediate ACKs bring the RTO of the endpoint well below the 2 seconds default
+    for (uint16_t id = 0; id < 20; id++)
+    {
+        send(id);
+        acknowledge(id);
+    }
+    EXPECT_EQ(0, g_sentCount);
+
+    auto start = std::chrono::steady_clock::now();
+    send(100);
+    while (0 == g_timeoutCount
+           && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(1, g_sentCount);
+    EXPECT_EQ(1, g_timeoutCount);
+    EXPECT_LT(elapsed.count(), 1.5);
+
+    CARetransmissionStop(&m_context);
+}
@@ -0,0 +1,334 @@
+/* *****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "gtest/gtest.h"
+#include "catcpservertest.h"
+#include "cacommon.h"
+#include "catcpinterface.h"
+#include "cathreadpool.h"
+#include "uarraylist.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// TLS application data record type and version
+#define RECORD_TYPE 0x17
+#define RECORD_MAJOR 0x03
+#define RECORD_MINOR 0x03
+
+// more sessions than fd table buckets
+#define SESSION_COUNT 100
+
+typedef std::vector<uint8_t> Record;
+
+static std::mutex g_recordsMutex;
+static std::vector<Record> g_records;
+static size_t g_connected = 0;
+static size_t g_disconnected = 0;
+
+extern "C" CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data,
+                                   uint32_t dataLen)
+{
+    (void)sep;
+    std::lock_guard<std::mutex> lock(g_recordsMutex);
+    g_records.push_back(Record(data, data + dataLen));
+    return CA_STATUS_OK;
+}
+
+extern "C" CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
+{
+    (void)endpoint;
+    return CA_STATUS_OK;
+}
+
+extern "C" void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
+{
+    (void)transportType;
+}
+
+static void ConnectionChangedCB(const CAEndpoint_t *endpoint, bool isConnected, bool isClient)
+{
+    (void)endpoint;
+    (void)isClient;
+    std::lock_guard<std::mutex> lock(g_recordsMutex);
+    if (isConnected)
+    {
+        g_connected++;
+    }
+    else
+    {
+        g_disconnected++;
+    }
+}
+
+static Record MakeRecord(size_t length, uint8_t seed)
+{
+    Record record;
+    record.push_back(RECORD_TYPE);
+    record.push_back(RECORD_MAJOR);
+    record.push_back(RECORD_MINOR);
+    record.push_back((uint8_t)(length >> 8));
+    record.push_back((uint8_t)length);
+    for (size_t i = 0; i < length; i++)
+    {
+        record.push_back((uint8_t)(seed + i));
+    }
+    return record;
+}
+
+// waits up to 5 seconds for the condition, checked with g_recordsMutex held
+template <typename Condition>
+static bool WaitFor(Condition condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_recordsMutex);
+            if (condition())
+            {
+                return true;
+            }
+        }
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+class CATCPServerTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &m_threadPool));
+        g_records.clear();
+        g_connected = 0;
+        g_disconnected = 0;
+
+        caglobals.server = true;
+        caglobals.tcp.ipv4.fd = -1;
+        caglobals.tcp.ipv4s.fd = -1;
+        caglobals.tcp.ipv6.fd = -1;
+        caglobals.tcp.ipv6s.fd = -1;
+        caglobals.tcp.ipv4.port = 0;
+        caglobals.tcp.ipv4s.port = 0;
+        caglobals.tcp.ipv6.port = 0;
+        caglobals.tcp.ipv6s.port = 0;
+        caglobals.tcp.selectTimeout = 1;
+        caglobals.tcp.listenBacklog = SESSION_COUNT;
+        CATCPSetConnectionChangedCallback(ConnectionChangedCB);
+        ASSERT_EQ(CA_STATUS_OK, CATCPStartServer(m_threadPool));
+    }
+
+    virtual void TearDown()
+    {
+        for (int fd : m_clients)
+        {
+            close(fd);
+        }
+        CATCPStopServer();
+        CATCPSetConnectionChangedCallback(NULL);
+        ca_thread_pool_free(m_threadPool);
+    }
+
+    // connects to the secure IPv4 accept socket
+    int Connect()
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        EXPECT_NE(-1, fd);
+
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(caglobals.tcp.ipv4s.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(0, connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+
+        m_clients.push_back(fd);
+        return fd;
+    }
+
+    static void Send(int fd, const uint8_t *data, size_t length)
+    {
+        while (length > 0)
+        {
+            ssize_t len = send(fd, data, length, 0);
+            ASSERT_LT(0, len);
+            data += len;
+            length -= (size_t)len;
+        }
+    }
+
+    ca_thread_pool_t m_threadPool = NULL;
+    std::vector<int> m_clients;
+};
+
+TEST_F(CATCPServerTest, DecryptsEveryRecordOfOneRead)
+{
+    std::vector<Record> records = { MakeRecord(1, 1), MakeRecord(300, 2),
+                                    MakeRecord(0, 3), MakeRecord(2000, 4) };
+    Record data;
+    for (const Record &record : records)
+    {
+        data.insert(data.end(), record.begin(), record.end());
+    }
+
+    int fd = Connect();
+    Send(fd, data.data(), data.size());
+
+    ASSERT_TRUE(WaitFor([&] { return g_records.size() >= records.size(); }));
+    EXPECT_EQ(records, g_records);
+}
+
+TEST_F(CATCPServerTest, KeepsRecordsSplitAcrossReads)
+{
+    std::vector<Record> records = { MakeRecord(100, 1), MakeRecord(50, 2), MakeRecord(700, 3) };
+    Record data;
+    for (const Record &record : records)
+    {
+        data.insert(data.end(), record.begin(), record.end());
+    }
+
+    // splits inside the first header, inside the first payload and inside the last header
+    const size_t splits[] = { 3, 60, 105 + 55 + 2, data.size() };
+
+    int fd = Connect();
+    size_t offset = 0;
+    for (size_t split : splits)
+    {
+        Send(fd, data.data() + offset, split - offset);
+        offset = split;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    ASSERT_TRUE(WaitFor([&] { return g_records.size() >= records.size(); }));
+    EXPECT_EQ(records, g_records);
+}
+
+TEST_F(CATCPServerTest, ReceivesRecordOfBufferSize)
+{
+    size_t maxLength = sizeof(((CATCPSessionInfo_t *)NULL)->tlsdata) - 5;
+    std::vector<Record> records = { MakeRecord(maxLength, 1), MakeRecord(10, 2) };
+    Record data;
+    for (const Record &record : records)
+    {
+        data.insert(data.end(), record.begin(), record.end());
+    }
+
+    int fd = Connect();
+    Send(fd, data.data(), data.size());
+
+    ASSERT_TRUE(WaitFor([&] { return g_records.size() >= records.size(); }));
+    EXPECT_EQ(records, g_records);
+}
+
+TEST_F(CATCPServerTest, ClosesSessionOnOversizedRecord)
+{
+    Record header = { RECORD_TYPE, RECORD_MAJOR, RECORD_MINOR, 0xFF, 0xFF };
+
+    int fd = Connect();
+    ASSERT_TRUE(WaitFor([] { return 1 == g_connected; }));
+    Send(fd, header.data(), header.size());
+
+    ASSERT_TRUE(WaitFor([] { return 1 == g_disconnected; }));
+    EXPECT_TRUE(g_records.empty());
+    EXPECT_EQ(0u, u_arraylist_length((u_arraylist_t *)caglobals.tcp.svrlist));
+}
+
+TEST_F(CATCPServerTest, FindsSessionsByFd)
+{
+    for (size_t i = 0; i < SESSION_COUNT; i++)
+    {
+        Connect();
+    }
+    ASSERT_TRUE(WaitFor([] { return SESSION_COUNT == g_connected; }));
+
+    u_arraylist_t *svrlist = (u_arraylist_t *)caglobals.tcp.svrlist;
+    ASSERT_EQ((uint32_t)SESSION_COUNT, u_arraylist_length(svrlist));
+
+    for (size_t i = 0; i < SESSION_COUNT; i++)
+    {
+        CATCPSessionInfo_t *svritem = (CATCPSessionInfo_t *)u_arraylist_get(svrlist, i);
+        size_t index = SIZE_MAX;
+        EXPECT_EQ(svritem, CAGetSessionInfoFromFD(svritem->fd, &index));
+        EXPECT_EQ(i, index);
+        EXPECT_EQ(svritem, CAGetSessionInfoFromFD(svritem->fd, NULL));
+    }
+    EXPECT_EQ(NULL, CAGetSessionInfoFromFD(-1, NULL));
+    EXPECT_EQ(NULL, CAGetSessionInfoFromFD(m_clients[0], NULL));
+
+    // the server forgets the sessions whose client went away
+    std::vector<int> clients;
+    std::vector<uint16_t> closedPorts;
+    for (size_t i = 0; i < SESSION_COUNT; i++)
+    {
+        if (i % 2)
+        {
+            clients.push_back(m_clients[i]);
+            continue;
+        }
+        struct sockaddr_in addr = {};
+        socklen_t addrlen = sizeof(addr);
+        ASSERT_EQ(0, getsockname(m_clients[i], (struct sockaddr *)&addr, &addrlen));
+        closedPorts.push_back(ntohs(addr.sin_port));
+        close(m_clients[i]);
+    }
+    m_clients = clients;
+
+    std::vector<int> removedFds;
+    for (size_t i = 0; i < SESSION_COUNT; i++)
+    {
+        CATCPSessionInfo_t *svritem = (CATCPSessionInfo_t *)u_arraylist_get(svrlist, i);
+        if (std::find(closedPorts.begin(), closedPorts.end(), svritem->sep.endpoint.port)
+                != closedPorts.end())
+        {
+            removedFds.push_back(svritem->fd);
+        }
+    }
+    ASSERT_EQ(closedPorts.size(), removedFds.size());
+
+    ASSERT_TRUE(WaitFor([] { return SESSION_COUNT / 2 == g_disconnected; }));
+    for (int fd : removedFds)
+    {
+        EXPECT_EQ(NULL, CAGetSessionInfoFromFD(fd, NULL));
+    }
+
+    ASSERT_EQ((uint32_t)(SESSION_COUNT / 2), u_arraylist_length(svrlist));
+    for (size_t i = 0; i < SESSION_COUNT / 2; i++)
+    {
+        CATCPSessionInfo_t *svritem = (CATCPSessionInfo_t *)u_arraylist_get(svrlist, i);
+        size_t index = SIZE_MAX;
+        EXPECT_EQ(svritem, CAGetSessionInfoFromFD(svritem->fd, &index));
+        EXPECT_EQ(i, index);
+    }
+}
@@ -0,0 +1,54 @@
+/* *****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * The TCP server tested by catcpserver_test.cpp is built from catcpservertest.c
+ * under these names, so that it does not clash with the server of the library.
+ * The TLS records it receives are passed to the test instead of the TLS adapter.
+ */
+
+#ifndef CA_TCP_SERVER_TEST_H_
+#define CA_TCP_SERVER_TEST_H_
+
+#define CACheckPayloadLengthFromHeader CACheckPayloadLengthFromHeaderTest
+#define CACleanData CACleanDataTest
+#define CAConnectTCPSession CAConnectTCPSessionTest
+#define CAConstructCoAP CAConstructCoAPTest
+#define CADisconnectTCPSession CADisconnectTCPSessionTest
+#define CAGetSessionInfoFromFD CAGetSessionInfoFromFDTest
+#define CAGetSocketFDFromEndpoint CAGetSocketFDFromEndpointTest
+#define CAGetTCPInterfaceInformation CAGetTCPInterfaceInformationTest
+#define CAGetTCPSessionInfoFromEndpoint CAGetTCPSessionInfoFromEndpointTest
+#define CAGetTotalLengthFromBuffer CAGetTotalLengthFromBufferTest
+#define CAGetTotalLengthFromHeader CAGetTotalLengthFromHeaderTest
+#define CASearchAndDeleteTCPSession CASearchAndDeleteTCPSessionTest
+#define CATCPDisconnectAll CATCPDisconnectAllTest
+#define CATCPSendData CATCPSendDataTest
+#define CATCPSetConnectionChangedCallback CATCPSetConnectionChangedCallbackTest
+#define CATCPSetErrorHandler CATCPSetErrorHandlerTest
+#define CATCPSetPacketReceiveCallback CATCPSetPacketReceiveCallbackTest
+#define CATCPStartServer CATCPStartServerTest
+#define CATCPStopServer CATCPStopServerTest
+
+#define CAcloseSslConnection CAcloseSslConnectionTCPServerTest
+#define CAcloseSslConnectionAll CAcloseSslConnectionAllTCPServerTest
+#define CAdecryptSsl CAdecryptSslTCPServerTest
+
+#endif /* CA_TCP_SERVER_TEST_H_ */
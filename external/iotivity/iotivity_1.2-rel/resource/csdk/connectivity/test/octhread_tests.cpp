@@ -569,3 +569,168 @@ TEST(ConditionTests, TC_07_WAITDURATION)
 
     oc_cond_free(sharedCond);
 }
+
+typedef struct _tagPoolFunc
+{
+    oc_mutex mutex;
+    volatile bool release;
+    volatile int runs;
+} _pool_struct;
+
+void poolFunc(void *context)
+{
+    _pool_struct* pData = (_pool_struct*) context;
+
+    while (!pData->release)
+    {
+        usleep(MINIMAL_LOOP_SLEEP * USECS_PER_MSEC);
+    }
+
+    oc_mutex_lock(pData->mutex);
+    pData->runs++;
+    oc_mutex_unlock(pData->mutex);
+}
+
+// runs of the pool tasks once at least 'runs' are done, or after a timeout
+static int waitForRuns(_pool_struct *pData, int runs)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        oc_mutex_lock(pData->mutex);
+        int done = pData->runs;
+        oc_mutex_unlock(pData->mutex);
+        if (done >= runs)
+        {
+            return done;
+        }
+        usleep(MINIMAL_LOOP_SLEEP * USECS_PER_MSEC);
+    }
+    return pData->runs;
+}
+
+TEST(ThreadPoolTests, TC_01_REUSE)
+{
+    ca_thread_pool_t mythreadpool;
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &mythreadpool));
+
+    _pool_struct pData = {0, true, 0};
+    pData.mutex = oc_mutex_new();
+
+    // one worker runs all the tasks, one after the other; removing a task
+    // that has not started would cancel it, so wait for the runs first
+    uint32_t taskIds[3];
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK,
+                  ca_thread_pool_add_task(mythreadpool, poolFunc, &pData, &taskIds[i]));
+    }
+    EXPECT_EQ(3, waitForRuns(&pData, 3));
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_NE(0u, taskIds[i]);
+        EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_remove_task(mythreadpool, taskIds[i]));
+    }
+
+    ca_thread_pool_free(mythreadpool);
+    oc_mutex_free(pData.mutex);
+}
+
+typedef struct _tagPoolRendezvous
+{
+    oc_mutex mutex;
+    oc_cond cond;
+    int started;
+    int expected;
+    bool met;
+    bool giveUp;
+} _pool_rendezvous;
+
+// blocks until 'expected' tasks run at the same time, or the test gives up
+void rendezvousFunc(void *context)
+{
+    _pool_rendezvous *pData = (_pool_rendezvous *) context;
+
+    oc_mutex_lock(pData->mutex);
+    if (++pData->started == pData->expected)
+    {
+        pData->met = true;
+        oc_cond_broadcast(pData->cond);
+    }
+    while (!pData->met && !pData->giveUp)
+    {
+        oc_cond_wait(pData->cond, pData->mutex);
+    }
+    oc_mutex_unlock(pData->mutex);
+}
+
+TEST(ThreadPoolTests, TC_03_BLOCKING)
+{
+    ca_thread_pool_t mythreadpool;
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &mythreadpool));
+
+    _pool_rendezvous pData = {oc_mutex_new(), oc_cond_new(), 0, 2, false, false};
+
+    // both tasks block until the other one runs: added back to back, they
+    // must get a worker each, although the first worker looks idle until it
+    // has taken the first task
+    uint32_t taskIds[2];
+    for (int i = 0; i < 2; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK,
+                  ca_thread_pool_add_task(mythreadpool, rendezvousFunc, &pData, &taskIds[i]));
+    }
+
+    oc_mutex_lock(pData.mutex);
+    while (!pData.met)
+    {
+        if (OC_WAIT_TIMEDOUT == oc_cond_wait_for(pData.cond, pData.mutex, USECS_PER_SEC))
+        {
+            break;
+        }
+    }
+    EXPECT_TRUE(pData.met);
+    EXPECT_EQ(2, pData.started);
+    pData.giveUp = true;
+    oc_cond_broadcast(pData.cond);
+    oc_mutex_unlock(pData.mutex);
+
+    for (int i = 0; i < 2; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_remove_task(mythreadpool, taskIds[i]));
+    }
+
+    ca_thread_pool_free(mythreadpool);
+    oc_cond_free(pData.cond);
+    oc_mutex_free(pData.mutex);
+}
+
+TEST(ThreadPoolTests, TC_02_CANCEL)
+{
+    ca_thread_pool_t mythreadpool;
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &mythreadpool));
+
+    _pool_struct pData = {0, false, 0};
+    pData.mutex = oc_mutex_new();
+
+    // the second task waits for the worker held by the first one
+    uint32_t runningId = 0;
+    uint32_t queuedId = 0;
+    EXPECT_EQ(CA_STATUS_OK,
+              ca_thread_pool_add_task(mythreadpool, poolFunc, &pData, &runningId));
+    EXPECT_EQ(CA_STATUS_OK,
+              ca_thread_pool_add_task(mythreadpool, poolFunc, &pData, &queuedId));
+    EXPECT_NE(runningId, queuedId);
+
+    // cancel the queued task, then let the running one complete
+    usleep(MINIMAL_EXTRA_SLEEP * USECS_PER_MSEC);
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_remove_task(mythreadpool, queuedId));
+    pData.release = true;
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_remove_task(mythreadpool, runningId));
+    EXPECT_EQ(1, pData.runs);
+
+    ca_thread_pool_free(mythreadpool);
+    oc_mutex_free(pData.mutex);
+}
@@ -20,6 +20,9 @@
 
 #include "gtest/gtest.h"
 #include "time.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #define CAcloseSslConnection CAcloseSslConnectionTest
 #define CAdecryptSsl CAdecryptSslTest
@@ -69,6 +72,7 @@
 #endif //HAVE_WINDOWS_H
 #include "platform_features.h"
 #include "logger.h"
+#include "oic_string.h"
 
 #define MBED_TLS_DEBUG_LEVEL (4) // Verbose
 
@@ -3237,3 +3241,301 @@ TEST(TLSAdaper, Test_ParseChain)
     EXPECT_EQ(10, ret + errNum);
 }
 
+
+/* **************************
+ *
+ *
+ * Session resumption test
+ *
+ *
+ * *************************/
+
+// The adapter is both the client and the server of the connection: records
+// sent to the server address are received from the client address and back.
+#define LOOPBACK_CLIENT_PORT 5683
+#define LOOPBACK_SERVER_PORT 5684
+#define LOOPBACK_QUEUE_LEN 16
+#define LOOPBACK_HANDSHAKES 20
+
+typedef struct
+{
+    uint16_t port;
+    uint8_t data[TLS_MSG_BUF_LEN];
+    size_t len;
+} LoopbackPacket_t;
+
+static LoopbackPacket_t loopbackQueue[LOOPBACK_QUEUE_LEN];
+static size_t loopbackQueueLen = 0;
+static char loopbackMsg[256] = {0};
+static size_t loopbackMsgLen = 0;
+static bool loopbackPskRemoved = false;
+
+static void LoopbackEndpoint(CAEndpoint_t * endpoint, uint16_t port)
+{
+    memset(endpoint, 0, sizeof(*endpoint));
+    endpoint->adapter = CA_ADAPTER_TCP;
+    endpoint->flags = CA_SECURE;
+    endpoint->port = port;
+    OICStrcpy(endpoint->addr, sizeof(endpoint->addr), "127.0.0.1");
+}
+
+static ssize_t LoopbackSendCB(CAEndpoint_t * endpoint, const void * buf, size_t buflen)
+{
+    if (LOOPBACK_QUEUE_LEN == loopbackQueueLen || sizeof(loopbackQueue[0].data) < buflen)
+    {
+        return -1;
+    }
+    LoopbackPacket_t * packet = &loopbackQueue[loopbackQueueLen++];
+    packet->port = endpoint->port;
+    memcpy(packet->data, buf, buflen);
+    packet->len = buflen;
+    return buflen;
+}
+
+static CAResult_t LoopbackReceivedCB(const CASecureEndpoint_t *, const void * data,
+                                     size_t dataLength)
+{
+    loopbackMsgLen = dataLength < sizeof(loopbackMsg) ? dataLength : sizeof(loopbackMsg);
+    memcpy(loopbackMsg, data, loopbackMsgLen);
+    return CA_STATUS_OK;
+}
+
+static int32_t GetLoopbackPskCredentials(CADtlsPskCredType_t type, const unsigned char *, size_t,
+                                         unsigned char * result, size_t resultLength)
+{
+    if (NULL == result || UUID_LENGTH > resultLength ||
+        (loopbackPskRemoved && CA_DTLS_PSK_KEY == type))
+    {
+        return -1;
+    }
+    memcpy(result, IDENTITY, UUID_LENGTH);
+    return UUID_LENGTH;
+}
+
+static void LoopbackPskOnly(bool * list)
+{
+    list[0] = true;
+}
+
+// Delivers the queued records until both sides are done
+static void LoopbackPump()
+{
+    LoopbackPacket_t packet;
+    while (0 < loopbackQueueLen)
+    {
+        packet = loopbackQueue[0];
+        loopbackQueueLen--;
+        memmove(&loopbackQueue[0], &loopbackQueue[1], loopbackQueueLen * sizeof(loopbackQueue[0]));
+
+        CASecureEndpoint_t sep;
+        memset(&sep, 0, sizeof(sep));
+        LoopbackEndpoint(&sep.endpoint, LOOPBACK_SERVER_PORT == packet.port ?
+                         LOOPBACK_CLIENT_PORT : LOOPBACK_SERVER_PORT);
+        CAdecryptSsl(&sep, packet.data, packet.len);
+    }
+}
+
+// Connects the client to the server, returns the number of resumed sides
+static int LoopbackHandshake(bool resume, bool * identityKept)
+{
+    CAEndpoint_t clientAddr;
+    CAEndpoint_t serverAddr;
+    LoopbackEndpoint(&clientAddr, LOOPBACK_CLIENT_PORT);
+    LoopbackEndpoint(&serverAddr, LOOPBACK_SERVER_PORT);
+
+    if (!resume)
+    {
+        // the cipher selection changed, the saved session is not offered
+        oc_mutex_lock(g_sslContextMutex);
+        g_caSslContext->sessionGeneration++;
+        oc_mutex_unlock(g_sslContextMutex);
+    }
+
+    if (CA_STATUS_OK != CAinitiateSslHandshake(&serverAddr))
+    {
+        return -1;
+    }
+    LoopbackPump();
+
+    int resumed = -1;
+    oc_mutex_lock(g_sslContextMutex);
+    SslEndPoint_t * client = GetSslPeer(&serverAddr);
+    SslEndPoint_t * server = GetSslPeer(&clientAddr);
+    if (NULL != client && NULL != server &&
+        MBEDTLS_SSL_HANDSHAKE_OVER == client->ssl.state &&
+        MBEDTLS_SSL_HANDSHAKE_OVER == server->ssl.state)
+    {
+        resumed = (client->resumed ? 1 : 0) + (server->resumed ? 1 : 0);
+        *identityKept = (UUID_LENGTH == server->sep.identity.id_length &&
+                         0 == memcmp(server->sep.identity.id, IDENTITY, UUID_LENGTH));
+    }
+    oc_mutex_unlock(g_sslContextMutex);
+
+    // the session carries data both ways
+    loopbackMsgLen = 0;
+    if (CA_STATUS_OK != CAencryptSsl(&serverAddr, (void *) GET_REQUEST, sizeof(GET_REQUEST)))
+    {
+        resumed = -1;
+    }
+    LoopbackPump();
+    if (sizeof(GET_REQUEST) != loopbackMsgLen || 0 != memcmp(loopbackMsg, GET_REQUEST, loopbackMsgLen))
+    {
+        resumed = -1;
+    }
+
+    CAcloseSslConnection(&serverAddr);
+    LoopbackPump();
+    return resumed;
+}
+
+static void LoopbackInit()
+{
+    EXPECT_EQ(CA_STATUS_OK, CAinitSslAdapter());
+    CAsetSslAdapterCallbacks(LoopbackReceivedCB, LoopbackSendCB, CA_ADAPTER_TCP);
+    CAsetPskCredentialsCallback(GetLoopbackPskCredentials);
+    CAsetCredentialTypesCallback(LoopbackPskOnly);
+    oc_mutex_lock(g_sslContextMutex);
+    CAsetTlsCipherSuite(MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256);
+    oc_mutex_unlock(g_sslContextMutex);
+}
+
+// Handshake rate of full and resumed handshakes over loopback
+TEST(TLSAdaper, Test_SessionResumption)
+{
+    LoopbackInit();
+
+    bool identityKept = false;
+    int fullCount = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOOPBACK_HANDSHAKES; i++)
+    {
+        fullCount += (0 == LoopbackHandshake(false, &identityKept) && identityKept) ? 1 : 0;
+    }
+    std::chrono::duration<double> full = std::chrono::steady_clock::now() - start;
+
+    // the last full handshake saved the session
+    int resumedCount = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOOPBACK_HANDSHAKES; i++)
+    {
+        identityKept = false;
+        resumedCount += (2 == LoopbackHandshake(true, &identityKept) && identityKept) ? 1 : 0;
+    }
+    std::chrono::duration<double> resumed = std::chrono::steady_clock::now() - start;
+
+    printf("full handshakes: %.1f/s, resumed handshakes: %.1f/s\n",
+           LOOPBACK_HANDSHAKES / full.count(), LOOPBACK_HANDSHAKES / resumed.count());
+
+    EXPECT_EQ(LOOPBACK_HANDSHAKES, fullCount);
+    EXPECT_EQ(LOOPBACK_HANDSHAKES, resumedCount);
+
+    // sessions of a removed device are not resumed
+    oc_mutex_lock(g_sslContextMutex);
+    ForgetSessionsOfIdentity(IDENTITY, UUID_LENGTH);
+    oc_mutex_unlock(g_sslContextMutex);
+    EXPECT_EQ(0, LoopbackHandshake(true, &identityKept));
+
+    CAdeinitSslAdapter();
+}
+
+#ifdef MBEDTLS_SSL_CACHE_C
+// Looks the session the client saved for the server up in the server cache
+static int LoopbackServerCacheGet(const CAEndpoint_t * serverAddr)
+{
+    int ret = -1;
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+
+    oc_mutex_lock(g_sslContextMutex);
+    SslSavedSession_t * saved = GetSavedSession(serverAddr);
+    if (NULL != saved)
+    {
+        session.ciphersuite = saved->session.ciphersuite;
+        session.compression = saved->session.compression;
+        session.id_len = saved->session.id_len;
+        memcpy(session.id, saved->session.id, saved->session.id_len);
+        ret = SslCacheGet(&g_caSslContext->sessionCache, &session);
+    }
+    oc_mutex_unlock(g_sslContextMutex);
+
+    mbedtls_ssl_session_free(&session);
+    return ret;
+}
+#endif
+
+// Sessions are resumed only while the peer keeps a credential
+TEST(TLSAdaper, Test_SessionResumptionCredentials)
+{
+    LoopbackInit();
+
+    CAEndpoint_t serverAddr;
+    LoopbackEndpoint(&serverAddr, LOOPBACK_SERVER_PORT);
+    bool identityKept = false;
+    EXPECT_EQ(0, LoopbackHandshake(false, &identityKept));
+    EXPECT_EQ(2, LoopbackHandshake(true, &identityKept));
+
+#ifdef MBEDTLS_SSL_CACHE_C
+    // the server cache leaves out the session once the PSK is removed
+    EXPECT_EQ(0, LoopbackServerCacheGet(&serverAddr));
+    loopbackPskRemoved = true;
+    EXPECT_NE(0, LoopbackServerCacheGet(&serverAddr));
+#else
+    loopbackPskRemoved = true;
+#endif
+
+    // and the client does not offer it, falling back to a full handshake
+    EXPECT_EQ(-1, LoopbackHandshake(true, &identityKept));
+    oc_mutex_lock(g_sslContextMutex);
+    EXPECT_TRUE(NULL == GetSavedSession(&serverAddr));
+    oc_mutex_unlock(g_sslContextMutex);
+    loopbackPskRemoved = false;
+
+    // no session is resumed once the credentials are reset
+    EXPECT_EQ(0, LoopbackHandshake(false, &identityKept));
+    EXPECT_EQ(2, LoopbackHandshake(true, &identityKept));
+    CAforgetSslSessions();
+    EXPECT_EQ(0, LoopbackHandshake(true, &identityKept));
+
+    CAdeinitSslAdapter();
+}
+
+// Deinit waits for a peer held outside the context mutex, as by a reading thread
+TEST(TLSAdaper, Test_DeinitWaitsForHeldPeer)
+{
+    LoopbackInit();
+
+    CAEndpoint_t serverAddr;
+    LoopbackEndpoint(&serverAddr, LOOPBACK_SERVER_PORT);
+    ASSERT_EQ(CA_STATUS_OK, CAinitiateSslHandshake(&serverAddr));
+    LoopbackPump();
+
+    oc_mutex_lock(g_sslContextMutex);
+    SslEndPoint_t * client = GetSslPeer(&serverAddr);
+    ASSERT_TRUE(NULL != client);
+    AcquireSslPeer(client);
+    oc_mutex_unlock(g_sslContextMutex);
+
+    std::atomic<bool> done(false);
+    std::thread deinit([&done]()
+    {
+        CAdeinitSslAdapter();
+        done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(done);
+
+    // the held peer and the context are still valid
+    oc_mutex_lock(client->mutex);
+    EXPECT_EQ(MBEDTLS_SSL_HANDSHAKE_OVER, client->ssl.state);
+    oc_mutex_unlock(client->mutex);
+
+    oc_mutex_lock(g_sslContextMutex);
+    EXPECT_TRUE(client->removed);
+    RemoveSslPeer(client);
+    ReleaseSslPeer(client);
+    oc_mutex_unlock(g_sslContextMutex);
+
+    deinit.join();
+    EXPECT_TRUE(done);
+    loopbackQueueLen = 0;
+}
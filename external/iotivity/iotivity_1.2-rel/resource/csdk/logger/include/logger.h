@@ -64,6 +64,11 @@ extern "C"
 // Max buffer size used in variable argument log function
 #define MAX_LOG_V_BUFFER_SIZE (256)
 
+// The deferred backend needs OCLogv to be a function
+#if defined(__TIZEN__) || defined(ARDUINO)
+#undef OC_LOG_DEFERRED
+#endif
+
 // Log levels
 #ifdef __TIZEN__
 typedef enum {
@@ -97,19 +102,44 @@ typedef enum {
 #endif // __TIZEN__
 
 #ifdef SET_LOG_DEBUG
-#define IF_OC_PRINT_LOG_LEVEL(level) if (DEBUG <= (level))
+#define OC_LOG_LEVEL_SET(level) (DEBUG <= (level))
 #elif defined(SET_LOG_INFO)
-#define IF_OC_PRINT_LOG_LEVEL(level) if (INFO <= (level))
+#define OC_LOG_LEVEL_SET(level) (INFO <= (level))
 #elif defined(SET_LOG_ERROR)
-#define IF_OC_PRINT_LOG_LEVEL(level) if (ERROR <= (level) && INFO_PRIVATE != (level))
+#define OC_LOG_LEVEL_SET(level) (ERROR <= (level) && INFO_PRIVATE != (level))
 #elif defined(SET_LOG_WARNING)
-#define IF_OC_PRINT_LOG_LEVEL(level) if (WARNING <= (level) && INFO_PRIVATE != (level))
+#define OC_LOG_LEVEL_SET(level) (WARNING <= (level) && INFO_PRIVATE != (level))
 #elif defined(SET_LOG_FATAL)
-#define IF_OC_PRINT_LOG_LEVEL(level) if (FATAL <= (level) && INFO_PRIVATE != (level))
+#define OC_LOG_LEVEL_SET(level) (FATAL <= (level) && INFO_PRIVATE != (level))
 #else
-#define IF_OC_PRINT_LOG_LEVEL(level) if (DEBUG <= (level))
+#define OC_LOG_LEVEL_SET(level) (DEBUG <= (level))
+#endif
+
+/**
+ * Minimum level logged by a module, DEBUG unless the module defines it before including
+ * this header (or redefines it after its includes), e.g.
+ *
+ *     #define OIC_LOG_MIN_LEVEL WARNING
+ *
+ * It is evaluated where the log macros are used, so log calls of a constant level below it
+ * compile to nothing and their arguments are never evaluated.
+ */
+#ifndef OIC_LOG_MIN_LEVEL
+#define OIC_LOG_MIN_LEVEL DEBUG
 #endif
 
+// Severity of a level, the _LITE and INFO_PRIVATE levels count as DEBUG and INFO.
+#define OC_LOG_SEVERITY(level) \
+    (DEBUG_LITE == (level) ? DEBUG : \
+     ((INFO_LITE == (level) || INFO_PRIVATE == (level)) ? INFO : (level)))
+
+// True if a level is compiled in, folded to a constant for a constant level.
+// Compared as int: LogLevel may be unsigned, and the minimum DEBUG is 0.
+#define OC_LOG_LEVEL_COMPILED(level) \
+    (OC_LOG_LEVEL_SET(level) && (int)OC_LOG_SEVERITY(level) >= (int)OIC_LOG_MIN_LEVEL)
+
+#define IF_OC_PRINT_LOG_LEVEL(level) if (OC_LOG_LEVEL_COMPILED(level))
+
 #define IF_OC_PRINT_PRIVATE_LOG_LEVEL(level) \
     if (false == OCGetPrivateLogLevel() || (true == OCGetPrivateLogLevel() && INFO_PRIVATE != (level))) \
 
@@ -129,6 +159,14 @@ void OCSetLogLevel(LogLevel level, bool hidePrivateLogEntries);
  */
 bool OCGetPrivateLogLevel(void);
 
+/**
+ * Check the level set by OCSetLogLevel, so that callers can skip preparing log arguments.
+ *
+ * @param level   - log level.
+ * @return  true if a log of that level is printed.
+ */
+bool OCLogIsEnabled(LogLevel level);
+
 #ifdef __TIZEN__
 /**
  * Output the contents of the specified buffer (in hex) with the specified priority level.
@@ -201,6 +239,30 @@ void OCPrintCALogBuffer(LogLevel level, const char *tag, const uint8_t *buffer,
     void OCPrintCALogBuffer(LogLevel level, const char *tag, const uint8_t *buffer,
                             uint16_t bufferSize, uint8_t isHeader);
 
+#ifdef OC_LOG_DEFERRED
+    /**
+     * Record a variable argument list log in binary form, to be formatted by OCLogFlush.
+     * The arguments are copied, but tag and format are kept by reference and must be
+     * string literals, as passed by the OIC_LOG macros. Logs whose format is not supported
+     * or whose strings are too long to copy are formatted immediately, after the recorded
+     * ones. WARNING and higher levels flush the recorded logs, as does a full buffer.
+     *
+     * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+     * @param tag    - Module name
+     * @param format - variadic log string
+     */
+    void OCLogvDeferred(LogLevel level, const char * tag, const char * format, ...)
+#if defined(__GNUC__)
+    __attribute__ ((format(printf, 3, 4)))
+#endif
+    ;
+#endif
+
+    /**
+     * Format and output the logs recorded by OCLogvDeferred, if any.
+     */
+    void OCLogFlush(void);
+
 #else  // For arduino platforms
     /**
      * Initialize the serial logger for Arduino
@@ -249,6 +311,8 @@ void OCPrintCALogBuffer(LogLevel level, const char *tag, const uint8_t *buffer,
 #ifdef TB_LOG
 
 #ifdef __TIZEN__
+#define OIC_LOG_ENABLED(level) OC_LOG_LEVEL_COMPILED(level)
+
 #define OIC_LOG(level,tag,mes) \
     do { \
         IF_OC_PRINT_LOG_LEVEL((level)) \
@@ -289,6 +353,8 @@ void OCPrintCALogBuffer(LogLevel level, const char *tag, const uint8_t *buffer,
 #define OIC_LOG_INIT()    OCLogInit()
 
 #ifdef ARDUINO
+#define OIC_LOG_ENABLED(level) OC_LOG_LEVEL_COMPILED(level)
+
 #define OIC_LOG_BUFFER(level, tag, buffer, bufferSize) \
     do { \
         IF_OC_PRINT_LOG_LEVEL((level)) \
@@ -313,15 +379,26 @@ void OCPrintCALogBuffer(LogLevel level, const char *tag, const uint8_t *buffer,
 #define OIC_LOG_V(level, tag, ...)
 
 #else // NO ARDUINO
+// The runtime level is checked before the arguments are evaluated.
+#define OIC_LOG_ENABLED(level) (OC_LOG_LEVEL_COMPILED(level) && OCLogIsEnabled((level)))
+
+#ifdef OC_LOG_DEFERRED
+#define OC_LOG_WRITE(level, tag, logStr)  OCLogvDeferred((level), (tag), "%s", (logStr))
+#define OC_LOG_WRITE_V(level, tag, ...)   OCLogvDeferred((level), (tag), __VA_ARGS__)
+#else
+#define OC_LOG_WRITE(level, tag, logStr)  OCLog((level), (tag), (logStr))
+#define OC_LOG_WRITE_V(level, tag, ...)   OCLogv((level), (tag), __VA_ARGS__)
+#endif
+
 #define OIC_LOG_BUFFER(level, tag, buffer, bufferSize) \
     do { \
-        IF_OC_PRINT_LOG_LEVEL((level)) \
+        if (OIC_LOG_ENABLED((level))) \
             OCLogBuffer((level), (tag), (buffer), (bufferSize)); \
     } while(0)
 
 #define OIC_LOG_CA_BUFFER(level, tag, buffer, bufferSize, isHeader) \
     do { \
-        IF_OC_PRINT_LOG_LEVEL((level)) \
+        if (OIC_LOG_ENABLED((level))) \
             OCPrintCALogBuffer((level), (tag), (buffer), (bufferSize), (isHeader)); \
     } while(0)
 
@@ -329,20 +406,21 @@ void OCPrintCALogBuffer(LogLevel level, const char *tag, const uint8_t *buffer,
 #define OIC_LOG_SHUTDOWN()     OCLogShutdown()
 #define OIC_LOG(level, tag, logStr) \
     do { \
-        IF_OC_PRINT_LOG_LEVEL((level)) \
-            OCLog((level), (tag), (logStr)); \
+        if (OIC_LOG_ENABLED((level))) \
+            OC_LOG_WRITE((level), (tag), (logStr)); \
     } while(0)
 
 // Define variable argument log function for Linux, Android, and Win32
 #define OIC_LOG_V(level, tag, ...) \
     do { \
-        IF_OC_PRINT_LOG_LEVEL((level)) \
-            OCLogv((level), (tag), __VA_ARGS__); \
+        if (OIC_LOG_ENABLED((level))) \
+            OC_LOG_WRITE_V((level), (tag), __VA_ARGS__); \
     } while(0)
 
 #endif // ARDUINO
 #endif // __TIZEN__
 #else // NO TB_LOG
+#define OIC_LOG_ENABLED(level) (false)
 #define OIC_LOG_CONFIG(ctx)
 #define OIC_LOG_SHUTDOWN()
 #define OIC_LOG(level, tag, logStr)
@@ -55,6 +55,13 @@
 #include "string.h"
 #include "logger_types.h"
 
+#ifdef OC_LOG_DEFERRED
+#include <stddef.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#endif
+
 // log level
 LogLevel g_level = DEBUG;
 // privacy log
@@ -64,6 +71,13 @@ bool g_hidePrivateLogEntries = false;
 static oc_log_ctx_t *logCtx = 0;
 #endif
 
+#ifdef OC_LOG_DEFERRED
+// Lines of OCLogBuffer and OCPrintCALogBuffer are kept in order with the deferred logs
+#define OC_LOG_LINE OCLogvDeferred
+#else
+#define OC_LOG_LINE OCLogv
+#endif
+
 #if defined(_MSC_VER)
 #define LINE_BUFFER_SIZE (16 * 2) + 16 + 1  // Show 16 bytes, 2 chars/byte, spaces between bytes, null termination
 #define S_LINE_BUFFER_SIZE (50 * 2) + 50 + 1  // Show 50 bytes, 2 chars/byte, spaces between bytes, null termination
@@ -151,7 +165,7 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
         // Output 16 values per line
         if (((i+1)%16) == 0)
         {
-            OCLogv(level, tag, "%s", lineBuffer);
+            OC_LOG_LINE(level, tag, "%s", lineBuffer);
             memset(lineBuffer, 0, sizeof lineBuffer);
             lineIndex = 0;
         }
@@ -159,7 +173,7 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
     // Output last values in the line, if any
     if (bufferSize % 16)
     {
-        OCLogv(level, tag, "%s", lineBuffer);
+        OC_LOG_LINE(level, tag, "%s", lineBuffer);
     }
 }
 
@@ -186,11 +200,11 @@ void OCPrintCALogBuffer(LogLevel level, const char *tag, const uint8_t *buffer,
         {
             if (1 == isHeader)
             {
-                OCLogv(level, tag, "| Analyzer(Header) | %s", lineBuffer);
+                OC_LOG_LINE(level, tag, "| Analyzer(Header) | %s", lineBuffer);
             }
             else
             {
-                OCLogv(level, tag, "| Analyzer(Body) | %s", lineBuffer);
+                OC_LOG_LINE(level, tag, "| Analyzer(Body) | %s", lineBuffer);
             }
             memset(lineBuffer, 0, sizeof lineBuffer);
             lineIndex = 0;
@@ -201,11 +215,11 @@ void OCPrintCALogBuffer(LogLevel level, const char *tag, const uint8_t *buffer,
     {
         if (1 == isHeader)
         {
-            OCLogv(level, tag, "| Analyzer(Header) | %s", lineBuffer);
+            OC_LOG_LINE(level, tag, "| Analyzer(Header) | %s", lineBuffer);
         }
         else
         {
-            OCLogv(level, tag, "| Analyzer(Body) | %s", lineBuffer);
+            OC_LOG_LINE(level, tag, "| Analyzer(Body) | %s", lineBuffer);
         }
     }
 }
@@ -221,6 +235,20 @@ bool OCGetPrivateLogLevel()
     return g_hidePrivateLogEntries;
 }
 
+bool OCLogIsEnabled(LogLevel level)
+{
+    if (g_level > level && ERROR != level && WARNING != level && FATAL != level)
+    {
+        return false;
+    }
+
+    if (true == g_hidePrivateLogEntries && INFO_PRIVATE == level)
+    {
+        return false;
+    }
+    return true;
+}
+
 #ifndef __TIZEN__
 void OCLogConfig(oc_log_ctx_t *ctx)
 {
@@ -234,6 +262,7 @@ void OCLogInit()
 
 void OCLogShutdown()
 {
+    OCLogFlush();
 #if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)|| defined(__TIZENRT__)
     if (logCtx && logCtx->destroy)
     {
@@ -252,17 +281,7 @@ void OCLogShutdown()
  */
 void OCLogv(LogLevel level, const char * tag, const char * format, ...)
 {
-    if (!format || !tag) {
-        return;
-    }
-
-    if (g_level > level && ERROR != level && WARNING != level && FATAL != level)
-    {
-        return;
-    }
-
-    if (true == g_hidePrivateLogEntries && INFO_PRIVATE == level)
-    {
+    if (!format || !tag || !OCLogIsEnabled(level)) {
         return;
     }
 
@@ -274,31 +293,53 @@ void OCLogv(LogLevel level, const char * tag, const char * format, ...)
     OCLog(level, tag, buffer);
 }
 
-/**
- * Output a log string with the specified priority level.
- * Only defined for Linux and Android
- *
- * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
- * @param tag    - Module name
- * @param logStr - log string
- */
-void OCLog(LogLevel level, const char * tag, const char * logStr)
+typedef struct
 {
-    if (!logStr || !tag)
-    {
-       return;
-    }
+    int min;
+    int sec;
+    int ms;
+} OCLogTime;
 
-    if (g_level > level && ERROR != level && WARNING != level && FATAL != level)
+static void OCLogGetTime(OCLogTime *when)
+{
+    when->min = 0;
+    when->sec = 0;
+    when->ms = 0;
+#if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
+    struct timespec now = { .tv_sec = 0, .tv_nsec = 0 };
+    clockid_t clk = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+    clk = CLOCK_REALTIME_COARSE;
+#endif
+    if (!clock_gettime(clk, &now))
     {
-        return;
+        when->min = (now.tv_sec / 60) % 60;
+        when->sec = now.tv_sec % 60;
+        when->ms = now.tv_nsec / 1000000;
     }
-
-    if (true == g_hidePrivateLogEntries && INFO_PRIVATE == level)
+#elif defined(_WIN32)
+    SYSTEMTIME systemTime = {0};
+    GetLocalTime(&systemTime);
+    when->min = (int)systemTime.wMinute;
+    when->sec = (int)systemTime.wSecond;
+    when->ms  = (int)systemTime.wMilliseconds;
+#else
+    struct timeval now;
+    if (!gettimeofday(&now, NULL))
     {
-        return;
+        when->min = (now.tv_sec / 60) % 60;
+        when->sec = now.tv_sec % 60;
+        when->ms = now.tv_usec / 1000;
     }
+#endif
+}
 
+/**
+ * Write a log string, stamped with the given time or the current one if NULL.
+ */
+static void OCLogWrite(LogLevel level, const char *tag, const char *logStr,
+                       const OCLogTime *when)
+{
     switch(level)
     {
         case DEBUG_LITE:
@@ -315,6 +356,7 @@ void OCLog(LogLevel level, const char * tag, const char * logStr)
     }
 
    #ifdef __ANDROID__
+       (void)when;
 
    #ifdef ADB_SHELL
        printf("%s: %s: %s\n", LEVEL[level], tag, logStr);
@@ -330,40 +372,422 @@ void OCLog(LogLevel level, const char * tag, const char * logStr)
        }
        else
        {
-           int min = 0;
-           int sec = 0;
-           int ms = 0;
-   #if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
-           struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
-           clockid_t clk = CLOCK_REALTIME;
-   #ifdef CLOCK_REALTIME_COARSE
-           clk = CLOCK_REALTIME_COARSE;
-   #endif
-           if (!clock_gettime(clk, &when))
+           OCLogTime now;
+           if (!when)
            {
-               min = (when.tv_sec / 60) % 60;
-               sec = when.tv_sec % 60;
-               ms = when.tv_nsec / 1000000;
+               OCLogGetTime(&now);
+               when = &now;
            }
-   #elif defined(_WIN32)
-           SYSTEMTIME systemTime = {0};
-           GetLocalTime(&systemTime);
-           min = (int)systemTime.wMinute;
-           sec = (int)systemTime.wSecond;
-           ms  = (int)systemTime.wMilliseconds;
-   #else
-           struct timeval now;
-           if (!gettimeofday(&now, NULL))
-           {
-               min = (now.tv_sec / 60) % 60;
-               sec = now.tv_sec % 60;
-               ms = now.tv_usec * 1000;
-           }
-   #endif
-           printf("%02d:%02d.%03d %s: %s: %s\n", min, sec, ms, LEVEL[level], tag, logStr);
+           printf("%02d:%02d.%03d %s: %s: %s\n", when->min, when->sec, when->ms,
+                  LEVEL[level], tag, logStr);
        }
    #endif
-   }
+}
+
+/**
+ * Output a log string with the specified priority level.
+ * Only defined for Linux and Android
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+ * @param tag    - Module name
+ * @param logStr - log string
+ */
+void OCLog(LogLevel level, const char * tag, const char * logStr)
+{
+    if (!logStr || !tag || !OCLogIsEnabled(level))
+    {
+       return;
+    }
+
+    OCLogWrite(level, tag, logStr, NULL);
+}
+
+#ifdef OC_LOG_DEFERRED
+// Number of logs recorded before they are flushed
+#ifndef OC_LOG_DEFERRED_ENTRIES
+#define OC_LOG_DEFERRED_ENTRIES (32)
+#endif
+
+// Arguments of a log, including '*' widths and precisions
+#define OC_LOG_DEFERRED_MAX_ARGS (8)
+
+// Bytes for the string arguments of a log, logs with longer strings are formatted immediately
+#define OC_LOG_DEFERRED_STRINGS (96)
+
+// Offset of a NULL string argument
+#define OC_LOG_DEFERRED_NULL_STRING ((unsigned long long)-1)
+
+typedef union
+{
+    long long i;
+    unsigned long long u;  // or offset of a string argument in OCLogEntry.strings
+    double d;
+    const void *p;
+} OCLogArg;
+
+typedef struct
+{
+    LogLevel level;
+    const char *tag;
+    const char *format;
+    OCLogTime when;
+    OCLogArg args[OC_LOG_DEFERRED_MAX_ARGS];
+    char strings[OC_LOG_DEFERRED_STRINGS];
+} OCLogEntry;
+
+/**
+ * Conversion specification of a format string, from the '%' to the conversion character.
+ */
+typedef struct
+{
+    const char *start;      // the '%'
+    size_t prefixLength;    // '%', flags, width and precision
+    size_t length;          // whole specification
+    int stars;              // '*' widths and precisions
+    char lengthModifier;    // 'H' for hh, 'l', 'q' for ll, 'h', 'j', 'z', 't', 'L' or 0
+    char conversion;
+} OCLogSpec;
+
+static OCLogEntry g_deferredLogs[OC_LOG_DEFERRED_ENTRIES];
+static size_t g_deferredHead = 0;
+static size_t g_deferredCount = 0;
+
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t g_deferredLock = PTHREAD_MUTEX_INITIALIZER;
+#define OC_LOG_DEFERRED_LOCK()   pthread_mutex_lock(&g_deferredLock)
+#define OC_LOG_DEFERRED_UNLOCK() pthread_mutex_unlock(&g_deferredLock)
+#else
+#define OC_LOG_DEFERRED_LOCK()
+#define OC_LOG_DEFERRED_UNLOCK()
+#endif
+
+/**
+ * Parse the conversion specification at spec->start.
+ *
+ * @return false if it is not supported by the deferred backend.
+ */
+static bool OCLogParseSpec(OCLogSpec *spec)
+{
+    const char *p = spec->start + 1;
+    spec->stars = 0;
+    spec->lengthModifier = 0;
+
+    while (*p && strchr("-+ #0'", *p))
+    {
+        p++;
+    }
+    if ('*' == *p)
+    {
+        spec->stars++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9')
+    {
+        p++;
+    }
+    if ('.' == *p)
+    {
+        p++;
+        if ('*' == *p)
+        {
+            spec->stars++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+        {
+            p++;
+        }
+    }
+    spec->prefixLength = p - spec->start;
+
+    if (('h' == p[0] && 'h' == p[1]) || ('l' == p[0] && 'l' == p[1]))
+    {
+        spec->lengthModifier = ('h' == p[0]) ? 'H' : 'q';
+        p += 2;
+    }
+    else if (*p && strchr("hljztLq", *p))
+    {
+        spec->lengthModifier = *p++;
+    }
+
+    spec->conversion = *p;
+    if (!*p || !strchr("diouxXcsp%eEfFgGaA", *p))
+    {
+        return false;
+    }
+    spec->length = p + 1 - spec->start;
+    return true;
+}
+
+/**
+ * Copy the arguments of a log into an entry.
+ *
+ * @return false if the format is not supported by the deferred backend or the
+ *         strings do not fit in the entry.
+ */
+static bool OCLogRecordArgs(OCLogEntry *entry, va_list args)
+{
+    size_t numArgs = 0;
+    size_t stringsUsed = 0;
+
+    for (const char *p = strchr(entry->format, '%'); p; p = strchr(p, '%'))
+    {
+        OCLogSpec spec = { .start = p };
+        if (!OCLogParseSpec(&spec))
+        {
+            return false;
+        }
+        p += spec.length;
+        if ('%' == spec.conversion)
+        {
+            continue;
+        }
+        if (numArgs + spec.stars + 1 > OC_LOG_DEFERRED_MAX_ARGS)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < spec.stars; i++)
+        {
+            entry->args[numArgs++].i = va_arg(args, int);
+        }
+
+        OCLogArg *arg = &entry->args[numArgs++];
+        switch (spec.conversion)
+        {
+            case 'd':
+            case 'i':
+                switch (spec.lengthModifier)
+                {
+                    case 'H': arg->i = (signed char)va_arg(args, int); break;
+                    case 'h': arg->i = (short)va_arg(args, int); break;
+                    case 'l': arg->i = va_arg(args, long); break;
+                    case 'q': arg->i = va_arg(args, long long); break;
+                    case 'j': arg->i = va_arg(args, intmax_t); break;
+                    case 'z': arg->i = (long long)va_arg(args, size_t); break;
+                    case 't': arg->i = va_arg(args, ptrdiff_t); break;
+                    default:  arg->i = va_arg(args, int); break;
+                }
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                switch (spec.lengthModifier)
+                {
+                    case 'H': arg->u = (unsigned char)va_arg(args, unsigned int); break;
+                    case 'h': arg->u = (unsigned short)va_arg(args, unsigned int); break;
+                    case 'l': arg->u = va_arg(args, unsigned long); break;
+                    case 'q': arg->u = va_arg(args, unsigned long long); break;
+                    case 'j': arg->u = va_arg(args, uintmax_t); break;
+                    case 'z': arg->u = va_arg(args, size_t); break;
+                    case 't': arg->u = (unsigned long long)va_arg(args, ptrdiff_t); break;
+                    default:  arg->u = va_arg(args, unsigned int); break;
+                }
+                break;
+            case 'c':
+                arg->i = va_arg(args, int);
+                break;
+            case 's':
+            {
+                const char *str = va_arg(args, const char *);
+                if (!str)
+                {
+                    arg->u = OC_LOG_DEFERRED_NULL_STRING;
+                    break;
+                }
+                size_t space = sizeof(entry->strings) - stringsUsed;
+                size_t length = strnlen(str, space);
+                if (length == space)
+                {
+                    return false;
+                }
+                memcpy(&entry->strings[stringsUsed], str, length + 1);
+                arg->u = stringsUsed;
+                stringsUsed += length + 1;
+                break;
+            }
+            case 'p':
+                arg->p = va_arg(args, void *);
+                break;
+            default:
+                if ('L' == spec.lengthModifier)
+                {
+                    arg->d = (double)va_arg(args, long double);
+                }
+                else
+                {
+                    arg->d = va_arg(args, double);
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+/**
+ * Format a recorded log into buffer.
+ */
+static void OCLogFormatEntry(const OCLogEntry *entry, char *buffer, size_t bufferSize)
+{
+    size_t used = 0;
+    size_t nextArg = 0;
+    const char *p = entry->format;
+
+    while (*p && used < bufferSize - 1)
+    {
+        if ('%' != *p)
+        {
+            buffer[used++] = *p++;
+            continue;
+        }
+
+        OCLogSpec spec = { .start = p };
+        OCLogParseSpec(&spec);
+        p += spec.length;
+        if ('%' == spec.conversion)
+        {
+            buffer[used++] = '%';
+            continue;
+        }
+
+        // Drop the length modifier, integers are recorded as long long and reals as double
+        char conversion[24];
+        if (spec.prefixLength > sizeof(conversion) - 4)
+        {
+            spec.prefixLength = sizeof(conversion) - 4;
+        }
+        memcpy(conversion, spec.start, spec.prefixLength);
+        size_t length = spec.prefixLength;
+        if (strchr("diouxX", spec.conversion))
+        {
+            conversion[length++] = 'l';
+            conversion[length++] = 'l';
+        }
+        conversion[length++] = spec.conversion;
+        conversion[length] = '\0';
+
+        int width = (spec.stars > 0) ? (int)entry->args[nextArg++].i : 0;
+        int precision = (spec.stars > 1) ? (int)entry->args[nextArg++].i : 0;
+        const OCLogArg *arg = &entry->args[nextArg++];
+        char *out = &buffer[used];
+        size_t size = bufferSize - used;
+
+#define OC_LOG_FORMAT_ARG(value) \
+        (0 == spec.stars ? snprintf(out, size, conversion, (value)) : \
+         1 == spec.stars ? snprintf(out, size, conversion, width, (value)) : \
+                           snprintf(out, size, conversion, width, precision, (value)))
+
+        int written = 0;
+        switch (spec.conversion)
+        {
+            case 'd':
+            case 'i':
+                written = OC_LOG_FORMAT_ARG(arg->i);
+                break;
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                written = OC_LOG_FORMAT_ARG(arg->u);
+                break;
+            case 'c':
+                written = OC_LOG_FORMAT_ARG((int)arg->i);
+                break;
+            case 's':
+                written = OC_LOG_FORMAT_ARG((OC_LOG_DEFERRED_NULL_STRING == arg->u) ?
+                                            "(null)" : &entry->strings[arg->u]);
+                break;
+            case 'p':
+                written = OC_LOG_FORMAT_ARG(arg->p);
+                break;
+            default:
+                written = OC_LOG_FORMAT_ARG(arg->d);
+                break;
+        }
+#undef OC_LOG_FORMAT_ARG
+
+        if (written > 0)
+        {
+            used += ((size_t)written < size) ? (size_t)written : size - 1;
+        }
+    }
+    buffer[used] = '\0';
+}
+
+/**
+ * Output the recorded logs, with the lock held.
+ */
+static void OCLogFlushLocked(void)
+{
+    char buffer[MAX_LOG_V_BUFFER_SIZE];
+    while (g_deferredCount > 0)
+    {
+        const OCLogEntry *entry = &g_deferredLogs[g_deferredHead];
+        OCLogFormatEntry(entry, buffer, sizeof(buffer));
+        OCLogWrite(entry->level, entry->tag, buffer, &entry->when);
+        g_deferredHead = (g_deferredHead + 1) % OC_LOG_DEFERRED_ENTRIES;
+        g_deferredCount--;
+    }
+}
+
+void OCLogvDeferred(LogLevel level, const char * tag, const char * format, ...)
+{
+    if (!format || !tag || !OCLogIsEnabled(level))
+    {
+        return;
+    }
+
+    OC_LOG_DEFERRED_LOCK();
+    if (OC_LOG_DEFERRED_ENTRIES == g_deferredCount)
+    {
+        OCLogFlushLocked();
+    }
+
+    OCLogEntry *entry =
+        &g_deferredLogs[(g_deferredHead + g_deferredCount) % OC_LOG_DEFERRED_ENTRIES];
+    entry->level = level;
+    entry->tag = tag;
+    entry->format = format;
+    OCLogGetTime(&entry->when);
+
+    va_list args;
+    va_start(args, format);
+    bool recorded = OCLogRecordArgs(entry, args);
+    va_end(args);
+
+    if (recorded)
+    {
+        g_deferredCount++;
+    }
+    if (!recorded || WARNING == level || ERROR == level || FATAL == level)
+    {
+        OCLogFlushLocked();
+    }
+
+    if (!recorded)
+    {
+        // Format it now, after the logs recorded before it
+        char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
+        va_start(args, format);
+        vsnprintf(buffer, sizeof buffer - 1, format, args);
+        va_end(args);
+        OCLogWrite(level, tag, buffer, &entry->when);
+    }
+    OC_LOG_DEFERRED_UNLOCK();
+}
+
+void OCLogFlush(void)
+{
+    OC_LOG_DEFERRED_LOCK();
+    OCLogFlushLocked();
+    OC_LOG_DEFERRED_UNLOCK();
+}
+#else
+void OCLogFlush(void)
+{
+}
+#endif // OC_LOG_DEFERRED
 #endif //__TIZEN__
 #endif //ARDUINO
 #ifdef ARDUINO
@@ -34,6 +34,7 @@ extern "C" {
 #include <stdio.h>
 #include <string.h>
 
+#include <chrono>
 #include <iostream>
 #include <stdint.h>
 using namespace std;
@@ -364,3 +365,168 @@ TEST(LoggerTest, LogBuffer) {
         EXPECT_STREQ(stdFileMD5, testFileMD5);
     }
 }
+
+static int g_evaluated = 0;
+
+static int evaluate(int value) {
+    g_evaluated++;
+    return value;
+}
+
+TEST(LoggerTest, DisabledLevelSkipsArguments) {
+    const char *tag = "DisabledLevel";
+    const int count = 1000000;
+    uint8_t buffer[64] = {0};
+
+    OCSetLogLevel(WARNING, false);
+    g_evaluated = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        OIC_LOG_V(DEBUG, tag, "request %d", evaluate(i));
+        OIC_LOG_V(INFO, tag, "request %d", evaluate(i));
+        OIC_LOG_BUFFER(DEBUG, tag, buffer, sizeof buffer);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    OCSetLogLevel(DEBUG, false);
+
+    EXPECT_EQ(0, g_evaluated);
+    std::cout << "3 disabled logs: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / count
+              << " ns" << std::endl;
+}
+
+#ifdef OC_LOG_DEFERRED
+//-----------------------------------------------------------------------------
+//  Deferred backend, the logs are captured through a log context
+//-----------------------------------------------------------------------------
+#include <climits>
+#include <stdarg.h>
+#include <string>
+#include <vector>
+
+static vector<string> g_written;
+
+static size_t captureWrite(oc_log_ctx_t *ctx, const int level, const char *logStr) {
+    (void)ctx;
+    (void)level;
+    g_written.push_back(logStr);
+    return strlen(logStr);
+}
+
+class DeferredLoggerTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        OCLogFlush();
+        memset(&m_ctx, 0, sizeof(m_ctx));
+        m_ctx.write_level = captureWrite;
+        OCLogConfig(&m_ctx);
+        OCSetLogLevel(DEBUG, false);
+        g_written.clear();
+    }
+
+    virtual void TearDown() {
+        OCLogFlush();
+        OCLogConfig(NULL);
+    }
+
+    oc_log_ctx_t m_ctx;
+};
+
+static string format(const char *format, ...) {
+    char buffer[MAX_LOG_V_BUFFER_SIZE];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer) - 1, format, args);
+    va_end(args);
+    return buffer;
+}
+
+TEST_F(DeferredLoggerTest, StarWidthAndPrecision) {
+    const char *tag = "Deferred";
+    OIC_LOG_V(DEBUG, tag, "[%*d] [%-8.*s] [%*.*f]", 6, -42, 3, "abcdef", 9, 3, 3.14159);
+    EXPECT_TRUE(g_written.empty());
+
+    OCLogFlush();
+    ASSERT_EQ(1u, g_written.size());
+    EXPECT_EQ(format("[%*d] [%-8.*s] [%*.*f]", 6, -42, 3, "abcdef", 9, 3, 3.14159),
+              g_written[0]);
+}
+
+TEST_F(DeferredLoggerTest, LengthModifiers) {
+    const char *tag = "Deferred";
+    signed char c = -3;
+    unsigned char uc = 250;
+    short h = -1234;
+    long long ll = LLONG_MIN;
+    unsigned long long ull = ULLONG_MAX;
+    size_t z = SIZE_MAX;
+    ssize_t sz = -5;
+    OIC_LOG_V(DEBUG, tag, "%hhd %hhu %hd %lld", c, uc, h, ll);
+    OIC_LOG_V(DEBUG, tag, "%llu %llx %zu %zd", ull, ull, z, sz);
+    EXPECT_TRUE(g_written.empty());
+
+    OCLogFlush();
+    ASSERT_EQ(2u, g_written.size());
+    EXPECT_EQ(format("%hhd %hhu %hd %lld", c, uc, h, ll), g_written[0]);
+    EXPECT_EQ(format("%llu %llx %zu %zd", ull, ull, z, sz), g_written[1]);
+}
+
+TEST_F(DeferredLoggerTest, NullStringAndPercent) {
+    const char *tag = "Deferred";
+    const char *null = NULL;
+    OIC_LOG_V(DEBUG, tag, "%s|%d%%|%s", null, 100, "end");
+    EXPECT_TRUE(g_written.empty());
+
+    OCLogFlush();
+    ASSERT_EQ(1u, g_written.size());
+    EXPECT_EQ("(null)|100%|end", g_written[0]);
+}
+
+TEST_F(DeferredLoggerTest, LongStringsFormattedImmediately) {
+    const char *tag = "Deferred";
+    string longStr(150, 'x');
+    OIC_LOG(DEBUG, tag, "first");
+    OIC_LOG(DEBUG, tag, longStr.c_str());
+
+    // the recorded log is flushed first, the long one is not truncated
+    ASSERT_EQ(2u, g_written.size());
+    EXPECT_EQ("first", g_written[0]);
+    EXPECT_EQ(longStr, g_written[1]);
+
+    // two strings that fit one by one but not together
+    string half(60, 'y');
+    OIC_LOG_V(DEBUG, tag, "%s %s", half.c_str(), half.c_str());
+    ASSERT_EQ(3u, g_written.size());
+    EXPECT_EQ(half + " " + half, g_written[2]);
+}
+
+TEST_F(DeferredLoggerTest, AnalyzerLinesNotTruncated) {
+    const char *tag = "Deferred";
+    uint8_t buffer[50];
+    for (int i = 0; i < (int)(sizeof buffer); i++) {
+        buffer[i] = i;
+    }
+    OCPrintCALogBuffer(INFO, tag, buffer, sizeof buffer, 1);
+    OCLogFlush();
+
+    string line = "| Analyzer(Header) | ";
+    for (int i = 0; i < (int)(sizeof buffer); i++) {
+        line += format("%02X ", buffer[i]);
+    }
+    ASSERT_EQ(1u, g_written.size());
+    EXPECT_EQ(line, g_written[0]);
+}
+
+TEST_F(DeferredLoggerTest, WarningFlushesRecordedLogs) {
+    const char *tag = "Deferred";
+    OIC_LOG(DEBUG, tag, "debug");
+    OIC_LOG_V(INFO, tag, "info %d", 1);
+    EXPECT_TRUE(g_written.empty());
+
+    OIC_LOG(WARNING, tag, "warning");
+    ASSERT_EQ(3u, g_written.size());
+    EXPECT_EQ("debug", g_written[0]);
+    EXPECT_EQ("info 1", g_written[1]);
+    EXPECT_EQ("warning", g_written[2]);
+}
+#endif // OC_LOG_DEFERRED
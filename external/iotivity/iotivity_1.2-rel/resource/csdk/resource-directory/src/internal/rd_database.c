@@ -99,6 +99,68 @@ static const uint8_t bind_index_value = 1;
     "FOREIGN KEY("XSTR(LINK_ID)") REFERENCES RD_DEVICE_LINK_LIST("XSTR(OC_RSRVD_INS)") " \
     "ON DELETE CASCADE);"
 
+// Indexes for the rt and if filters of discovery, for the lookups of the types
+// and interfaces of a link, and for the cascaded deletes of a device.
+#define RD_INDEXES \
+    "create index if not exists RD_LINK_RT_VALUE on RD_LINK_RT(" \
+    XSTR(OC_RSRVD_RESOURCE_TYPE) ");" \
+    "create index if not exists RD_LINK_RT_LINK_ID on RD_LINK_RT(LINK_ID);" \
+    "create index if not exists RD_LINK_IF_VALUE on RD_LINK_IF(" \
+    XSTR(OC_RSRVD_INTERFACE) ");" \
+    "create index if not exists RD_LINK_IF_LINK_ID on RD_LINK_IF(LINK_ID);" \
+    "create index if not exists RD_DEVICE_LINK_LIST_DEVICE_ID on RD_DEVICE_LINK_LIST(DEVICE_ID);"
+
+/**
+ * Statements prepared on first use and kept until the database is closed.
+ */
+typedef enum
+{
+    RD_INSERT_DEVICE = 0,
+    RD_INSERT_LINK,
+    RD_INSERT_RT,
+    RD_INSERT_IF,
+    RD_DELETE_DEVICE,
+    RD_STATEMENT_COUNT
+} RDStatement;
+
+static const char *gRDStatementSql[RD_STATEMENT_COUNT] =
+{
+    "INSERT INTO RD_DEVICE_LIST VALUES(?,?,?,?)",
+    "INSERT INTO RD_DEVICE_LINK_LIST VALUES(?,?,?,?,?,?,?,?)",
+    "INSERT INTO RD_LINK_RT VALUES(?, ?)",
+    "INSERT INTO RD_LINK_IF VALUES(?, ?)",
+    "DELETE FROM RD_DEVICE_LIST WHERE "XSTR(OC_RSRVD_DEVICE_ID)" = ?"
+};
+
+static sqlite3_stmt *gRDStatements[RD_STATEMENT_COUNT];
+
+static int prepareStatement(RDStatement statement, sqlite3_stmt **stmt)
+{
+    if (!gRDStatements[statement])
+    {
+        int res = sqlite3_prepare_v2(gRDDB, gRDStatementSql[statement], -1,
+                                     &gRDStatements[statement], NULL);
+        if (SQLITE_OK != res)
+        {
+            return res;
+        }
+    }
+
+    *stmt = gRDStatements[statement];
+    // the result of the last step was already checked by its caller
+    sqlite3_reset(*stmt);
+    return sqlite3_clear_bindings(*stmt);
+}
+
+static void finalizeStatements()
+{
+    for (size_t i = 0; i < RD_STATEMENT_COUNT; i++)
+    {
+        sqlite3_finalize(gRDStatements[i]);
+        gRDStatements[i] = NULL;
+    }
+}
+
 static void errorCallback(void *arg, int errCode, const char *errMsg)
 {
     OC_UNUSED(arg);
@@ -109,6 +171,12 @@ static void errorCallback(void *arg, int errCode, const char *errMsg)
 
 OCStackResult OCRDDatabaseInit(const char *path)
 {
+    if (gRDDB)
+    {
+        // Kept open with its statements until OCRDDatabaseClose.
+        return OC_STACK_OK;
+    }
+
     if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
     {
         OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
@@ -119,6 +187,7 @@ OCStackResult OCRDDatabaseInit(const char *path)
     {
         OIC_LOG(DEBUG, TAG, "RD database file did not open, as no table exists.");
         OIC_LOG(DEBUG, TAG, "RD creating new table.");
+        sqlite3_close(gRDDB);
         sqlRet = sqlite3_open_v2(!path ? RD_PATH : path, &gRDDB,
                                  SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
         if (SQLITE_OK == sqlRet)
@@ -138,91 +207,89 @@ OCStackResult OCRDDatabaseInit(const char *path)
         }
     }
 
-    if (sqlRet == SQLITE_OK)
+    if (sqlRet != SQLITE_OK)
     {
-        sqlite3_stmt *stmt = 0;
-        VERIFY_SQLITE(sqlite3_prepare_v2 (gRDDB, "PRAGMA foreign_keys = ON;", -1, &stmt, NULL));
+        OIC_LOG_V(ERROR, TAG, "RD database did not open: %s", sqlite3_errmsg(gRDDB));
+        sqlite3_close(gRDDB);
+        gRDDB = NULL;
+        return OC_STACK_ERROR;
+    }
 
-        if (SQLITE_DONE != sqlite3_step(stmt))
-        {
-            sqlite3_finalize(stmt);
-            return OC_STACK_ERROR;
-        }
+    // also added to the databases created without them
+    VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_INDEXES, NULL, NULL, NULL));
 
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+    sqlite3_stmt *stmt = 0;
+    VERIFY_SQLITE(sqlite3_prepare_v2 (gRDDB, "PRAGMA foreign_keys = ON;", -1, &stmt, NULL));
+
+    if (SQLITE_DONE != sqlite3_step(stmt))
+    {
+        sqlite3_finalize(stmt);
+        return OC_STACK_ERROR;
     }
 
+    VERIFY_SQLITE(sqlite3_finalize(stmt));
+
     return OC_STACK_OK;
 }
 
 OCStackResult OCRDDatabaseClose()
 {
     CHECK_DATABASE_INIT;
+    finalizeStatements();
     VERIFY_SQLITE(sqlite3_close_v2(gRDDB));
+    gRDDB = NULL;
     return OC_STACK_OK;
 }
 
-static int storeResourceType(char **link, size_t size, uint8_t rowid)
+static int storeResourceType(char **link, size_t size, int64_t rowid)
 {
     int res = 1;
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
 
-    const char *insertRT = "INSERT INTO RD_LINK_RT VALUES(?, ?)";
     sqlite3_stmt *stmtRT = 0;
 
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertRT, strlen(insertRT) + 1, &stmtRT, NULL));
+        VERIFY_SQLITE(prepareStatement(RD_INSERT_RT, &stmtRT));
         if (link[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmtRT, rt_value_index, link[i],
                     strlen(link[i])+1, SQLITE_STATIC));
 
-            VERIFY_SQLITE(sqlite3_bind_int(stmtRT, rt_link_id_index, rowid));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmtRT, rt_link_id_index, rowid));
         }
         if (SQLITE_DONE != sqlite3_step(stmtRT))
         {
-            sqlite3_finalize(stmtRT);
             return res;
         }
     }
 
-    VERIFY_SQLITE(sqlite3_finalize(stmtRT));
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
     res = SQLITE_OK;
 
     return res;
 }
 
 
-static int storeInterfaceType(char **link, size_t size, uint8_t rowid)
+static int storeInterfaceType(char **link, size_t size, int64_t rowid)
 {
     int res = 1;
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
-
-    const char *insertIF = "INSERT INTO RD_LINK_IF VALUES(?, ?)";
     sqlite3_stmt *stmtIF = 0;
 
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertIF, strlen(insertIF) + 1, &stmtIF, NULL));
+        VERIFY_SQLITE(prepareStatement(RD_INSERT_IF, &stmtIF));
 
         if (link[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmtIF, if_value_index, link[i], strlen(link[i])+1, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_int(stmtIF, if_link_id_index, rowid));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmtIF, if_link_id_index, rowid));
         }
         if (SQLITE_DONE != sqlite3_step(stmtIF))
         {
-            res = sqlite3_finalize(stmtIF);
             return res;
         }
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmtIF));
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
     res = SQLITE_OK;
 
     return res;
@@ -237,13 +304,11 @@ static int storeLinkPayload(OCRepPayload *rdPayload, int64_t rowid)
 
     if (OCRepPayloadGetPropObjectArray(rdPayload, OC_RSRVD_LINKS, &links, dimensions))
     {
-        const char *insertDeviceLLList = "INSERT INTO RD_DEVICE_LINK_LIST VALUES(?,?,?,?,?,?,?,?)";
         sqlite3_stmt *stmt = 0;
 
         for (size_t i = 0; i < dimensions[0]; i++)
         {
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceLLList, strlen(insertDeviceLLList) + 1, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
+            VERIFY_SQLITE(prepareStatement(RD_INSERT_LINK, &stmt));
 
             OCRepPayload *link = links[i];
             char *uri = NULL;
@@ -266,10 +331,11 @@ static int storeLinkPayload(OCRepPayload *rdPayload, int64_t rowid)
             char **mediaType = NULL;
             if (OCRepPayloadGetStringArray(link, OC_RSRVD_MEDIA_TYPE, &mediaType, mtDim))
             {
-                VERIFY_SQLITE(sqlite3_bind_text(stmt, mt_index, mediaType[0], mtDim[0], SQLITE_STATIC));
+                VERIFY_SQLITE(sqlite3_bind_text(stmt, mt_index, mediaType[0],
+                        strlen(mediaType[0]), SQLITE_STATIC));
             }
 
-            VERIFY_SQLITE(sqlite3_bind_int(stmt, d_index, rowid));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmt, d_index, rowid));
 
             size_t rtDim[MAX_REP_ARRAY_DEPTH] = {0};
             char **rt = NULL;
@@ -281,10 +347,8 @@ static int storeLinkPayload(OCRepPayload *rdPayload, int64_t rowid)
 
             if (SQLITE_DONE != sqlite3_step(stmt))
             {
-                sqlite3_finalize(stmt);
                 return res;
             }
-            VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
 
             int64_t ins = sqlite3_last_insert_rowid(gRDDB);
             VERIFY_SQLITE(storeResourceType(rt, rtDim[0], ins));
@@ -311,23 +375,50 @@ static int storeLinkPayload(OCRepPayload *rdPayload, int64_t rowid)
 
         }
 
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
         res = SQLITE_OK;
     }
     return res;
 }
 
+static int deleteDevice(const char *deviceId)
+{
+    sqlite3_stmt *stmt = 0;
+    VERIFY_SQLITE(prepareStatement(RD_DELETE_DEVICE, &stmt));
+
+    VERIFY_SQLITE(sqlite3_bind_text(stmt, bind_index_value, deviceId, strlen(deviceId) + 1,
+            SQLITE_STATIC));
+
+    if (SQLITE_DONE != sqlite3_step(stmt))
+    {
+        return SQLITE_ERROR;
+    }
+    return SQLITE_OK;
+}
+
 OCStackResult OCRDDatabaseStoreResources(OCRepPayload *payload, const OCDevAddr *address)
 {
     CHECK_DATABASE_INIT;
 
+    // The device, its links and their types and interfaces are written in
+    // one transaction, instead of one per row.
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
-    const char *insertDeviceList = "INSERT INTO RD_DEVICE_LIST VALUES(?,?,?,?)";
     sqlite3_stmt *stmt = 0;
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceList, strlen(insertDeviceList) + 1, &stmt, NULL));
 
     char *deviceid = NULL;
     if (OCRepPayloadGetPropString(payload, OC_RSRVD_DEVICE_ID, &deviceid))
+    {
+        // A device publishing again replaces what it published before.
+        if (SQLITE_OK != deleteDevice(deviceid))
+        {
+            sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
+            OICFree(deviceid);
+            return OC_STACK_ERROR;
+        }
+    }
+
+    VERIFY_SQLITE(prepareStatement(RD_INSERT_DEVICE, &stmt));
+
+    if (deviceid)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, device_index, deviceid, strlen(deviceid) + 1, SQLITE_STATIC));
     }
@@ -345,18 +436,19 @@ OCStackResult OCRDDatabaseStoreResources(OCRepPayload *payload, const OCDevAddr
 
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
-        sqlite3_finalize(stmt);
+        sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
+        OICFree(deviceid);
         return OC_STACK_ERROR;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
 
     int64_t rowid = sqlite3_last_insert_rowid(gRDDB);
     if (rowid)
     {
         VERIFY_SQLITE(storeLinkPayload(payload, rowid));
     }
+
+    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
+
     OICFree(deviceid);
     return OC_STACK_OK;
 }
@@ -366,19 +458,11 @@ OCStackResult OCRDDatabaseDeleteDevice(const char *deviceId)
     CHECK_DATABASE_INIT;
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
 
-    sqlite3_stmt *stmt = 0;
-    char *delDevice = "DELETE FROM RD_DEVICE_LIST WHERE "XSTR(OC_RSRVD_DEVICE_ID)" = ?";
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delDevice, strlen(delDevice) + 1, &stmt, NULL));
-
-    VERIFY_SQLITE(sqlite3_bind_text(stmt, 1, deviceId, strlen(deviceId) + 1, SQLITE_STATIC));
-
-    if (SQLITE_DONE != sqlite3_step(stmt))
+    if (SQLITE_OK != deleteDevice(deviceId))
     {
         sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
-        sqlite3_finalize(stmt);
         return OC_STACK_ERROR;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
 
     return OC_STACK_OK;
@@ -171,3 +171,98 @@ TEST_F(RDDatabaseTests, PublishDatabase)
     EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDeleteDevice(deviceId));
     EXPECT_EQ(OC_STACK_OK, OCRDDatabaseClose());
 }
+
+#define BENCHMARK_DEVICES 200
+#define BENCHMARK_LINKS 5
+#define BENCHMARK_RESOURCE_TYPES 50
+
+static OCRepPayload *createSyntheticDevice(int device)
+{
+    char value[64];
+    OCRepPayload *repPayload = OCRepPayloadCreate();
+    snprintf(value, sizeof(value), "%08x-0000-0000-0000-000000000000", device);
+    OCRepPayloadSetPropString(repPayload, OC_RSRVD_DEVICE_ID, value);
+    OCRepPayloadSetPropInt(repPayload, OC_RSRVD_DEVICE_TTL, 86400);
+
+    const OCRepPayload *linkArr[BENCHMARK_LINKS];
+    size_t dim[MAX_REP_ARRAY_DEPTH] = {1, 0, 0};
+    for (int i = 0; i < BENCHMARK_LINKS; i++)
+    {
+        OCRepPayload *link = OCRepPayloadCreate();
+        snprintf(value, sizeof(value), "/a/resource%d", i);
+        OCRepPayloadSetPropString(link, OC_RSRVD_HREF, value);
+        snprintf(value, sizeof(value), "core.type%d",
+                 (device * BENCHMARK_LINKS + i) % BENCHMARK_RESOURCE_TYPES);
+        const char *rt[] = { value };
+        OCRepPayloadSetStringArray(link, OC_RSRVD_RESOURCE_TYPE, rt, dim);
+        const char *itf[] = { OC_RSRVD_INTERFACE_DEFAULT };
+        OCRepPayloadSetStringArray(link, OC_RSRVD_INTERFACE, itf, dim);
+        const char *mt[] = { DEFAULT_MESSAGE_TYPE };
+        OCRepPayloadSetStringArray(link, OC_RSRVD_MEDIA_TYPE, mt, dim);
+        OCRepPayload *policy = OCRepPayloadCreate();
+        OCRepPayloadSetPropInt(policy, OC_RSRVD_BITMAP, OC_DISCOVERABLE);
+        OCRepPayloadSetPropObjectAsOwner(link, OC_RSRVD_POLICY, policy);
+        linkArr[i] = link;
+    }
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {BENCHMARK_LINKS, 0, 0};
+    OCRepPayloadSetPropObjectArray(repPayload, OC_RSRVD_LINKS, linkArr, dimensions);
+    for (int i = 0; i < BENCHMARK_LINKS; i++)
+    {
+        OCRepPayloadDestroy((OCRepPayload *)linkArr[i]);
+    }
+    return repPayload;
+}
+
+// Publishes synthetic devices twice, as after a reboot of the RD, then
+// discovers them by resource type, and reports the rates of both.
+TEST_F(RDDatabaseTests, PublishAndDiscoveryBenchmark)
+{
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseInit(NULL));
+    OCDevAddr address;
+    address.port = 54321;
+    OICStrcpy(address.addr, MAX_ADDR_STR_SIZE, "192.168.1.1");
+
+    OCRepPayload *devices[BENCHMARK_DEVICES];
+    for (int i = 0; i < BENCHMARK_DEVICES; i++)
+    {
+        devices[i] = createSyntheticDevice(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = 0; i < BENCHMARK_DEVICES; i++)
+        {
+            EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(devices[i], &address));
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    std::cout << "published " << 2 * BENCHMARK_DEVICES << " devices in " << elapsed / 1000
+              << " ms, " << (elapsed ? 2 * BENCHMARK_DEVICES * 1000000LL / elapsed : 0)
+              << " devices/s" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_RESOURCE_TYPES; i++)
+    {
+        char rt[32];
+        snprintf(rt, sizeof(rt), "core.type%d", i);
+        OCDiscoveryPayload *discPayload = OCDiscoveryPayloadCreate();
+        EXPECT_EQ(OC_STACK_OK, OCRDDatabaseCheckResources(NULL, rt, discPayload));
+        EXPECT_TRUE(discPayload->resources != NULL);
+        OCDiscoveryPayloadDestroy(discPayload);
+    }
+    elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    std::cout << "discovered " << BENCHMARK_RESOURCE_TYPES << " resource types in "
+              << elapsed / 1000 << " ms" << std::endl;
+
+    char deviceId[64];
+    for (int i = 0; i < BENCHMARK_DEVICES; i++)
+    {
+        snprintf(deviceId, sizeof(deviceId), "%08x-0000-0000-0000-000000000000", i);
+        EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDeleteDevice(deviceId));
+        OCRepPayloadDestroy(devices[i]);
+    }
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseClose());
+}
@@ -51,6 +51,21 @@ OCStackResult DeInitACLResource();
  */
 const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr);
 
+/**
+ * This method is used by PolicyEngine to index the whole ACL.
+ *
+ * @return the first ACE of the ACL, NULL if it is empty.
+ */
+const OicSecAce_t* GetACLAces(void);
+
+/**
+ * Get the version of the ACL, changed whenever ACEs are added or removed,
+ * so that data derived from the ACEs can be dropped when they change.
+ *
+ * @return version of the ACL.
+ */
+uint32_t GetACLVersion(void);
+
 /**
  * This function converts ACL data into CBOR format.
  *
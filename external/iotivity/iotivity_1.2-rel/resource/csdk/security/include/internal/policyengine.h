@@ -28,6 +28,7 @@
 #include "amsmgr.h"
 #include <stdlib.h>
 #include <stdint.h>
+#include <time.h>
 
 typedef struct AmsMgrContext AmsMgrContext_t;
 
@@ -110,4 +111,16 @@ void SetPolicyEngineState(PEContext_t *context, const PEState_t state);
 
 typedef OCStackResult (*GetSvrRownerId_t)(OicUuid_t *rowner);
 
+/**
+ * Source of the current time, which the validity periods of the ACEs are checked against.
+ */
+typedef time_t (*PETimeSource_t)(void);
+
+/**
+ * Set the source of the time of the requests checked by CheckPermission().
+ *
+ * @param timeSource returns the current time, NULL to use time().
+ */
+void SetPolicyEngineTimeSource(PETimeSource_t timeSource);
+
 #endif //IOTVT_SRM_PE_H
@@ -27,6 +27,10 @@
 #include "cJSON.h"
 #endif
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Persistent Storage status definition
 typedef enum
 {
@@ -152,4 +156,8 @@ void DeinitPersistentStorageInterface(void);
 OCStackResult setSecurePSI(const unsigned char *key, const OCPersistentStorage *psPlain,
         const OCPersistentStorage *psEnc, const OCPersistentStorage *psRescue);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif //IOTVT_SRM_PSI_H
@@ -160,6 +160,23 @@ struct IotvtICalRecur
  */
 IotvtICalResult_t IsRequestWithinValidTime(const char *period, const char *recur);
 
+/**
+ * Same as IsRequestWithinValidTime(), for a period and a recurrence rule
+ * parsed beforehand with ParsePeriod() and ParseRecur(), so that a rule
+ * checked on every request is parsed only once.
+ *
+ * @param period parsed period.
+ * @param recur parsed recurrence rule, NULL if there is none.
+ * @param requestTime time of the request.
+ *
+ * @return ::IOTVTICAL_VALID_ACCESS, if the request is within valid time period
+ * ::IOTVTICAL_INVALID_ACCESS, if the request is not within valid time period
+ * ::IOTVTICAL_INVALID_PARAMETER, if parameter are invalid
+ */
+IotvtICalResult_t IsRequestWithinParsedTime(const IotvtICalPeriod_t *period,
+                                            const IotvtICalRecur_t *recur,
+                                            time_t requestTime);
+
 /**
  * Parses periodStr and populate struct IotvtICalPeriod_t.
  *
@@ -61,6 +61,8 @@ static const uint8_t ACL_RESOURCE_MAP_SIZE = 3;
 static const uint16_t CBOR_SIZE = 2048*8;
 
 static OicSecAcl_t *gAcl = NULL;
+// Changed whenever the ACEs of gAcl change, see GetACLVersion()
+static uint32_t gAclVersion = 0;
 static OCResourceHandle gAclHandle = NULL;
 
 void FreeRsrc(OicSecRsrc_t *rsrc)
@@ -1449,6 +1451,8 @@ OCStackResult RemoveACE(const OicUuid_t * subject, const char * resource)
 
     if (deleteFlag)
     {
+        gAclVersion++;
+
         // In case of unit test do not update persistant storage.
         if (memcmp(subject->id, &WILDCARD_SUBJECT_B64_ID, sizeof(subject->id)) == 0)
         {
@@ -1788,6 +1792,7 @@ static OCStackResult RemoveAllAce(void)
             LL_DELETE(gAcl->aces, aceItem);
             FreeACE(aceItem);
         }
+        gAclVersion++;
 
         //Generate empty ACL payload
         ret = AclToCBORPayload(gAcl, &payload, &size);
@@ -1814,6 +1819,7 @@ static OCStackResult RemoveAllAce(void)
                 {
                     DeleteACLList(gAcl);
                     gAcl = originAcl;
+                    gAclVersion++;
                 }
                 else
                 {
@@ -1972,6 +1978,7 @@ static OCEntityHandlerResult HandleACLPostRequest(const OCEntityHandlerRequest *
                     {
                         OIC_LOG(DEBUG, TAG, "Appending new ACE..");
                         LL_PREPEND(gAcl->aces, insertAce);
+                        gAclVersion++;
                     }
                     else
                     {
@@ -2118,6 +2125,7 @@ static OCStackResult CreateACLResource()
 OCStackResult SetDefaultACL(OicSecAcl_t *acl)
 {
     gAcl = acl;
+    gAclVersion++;
     return OC_STACK_OK;
 }
 
@@ -2330,6 +2338,7 @@ OCStackResult InitACLResource()
         // TODO Needs to update persistent storage
     }
     VERIFY_NON_NULL(TAG, gAcl, FATAL);
+    gAclVersion++;
 
     // Instantiate 'oic.sec.acl'
     ret = CreateACLResource();
@@ -2351,6 +2360,7 @@ OCStackResult DeInitACLResource()
     {
         DeleteACLList(gAcl);
         gAcl = NULL;
+        gAclVersion++;
     }
     return ret;
 }
@@ -2404,6 +2414,16 @@ const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **
     return NULL;
 }
 
+const OicSecAce_t* GetACLAces(void)
+{
+    return gAcl ? gAcl->aces : NULL;
+}
+
+uint32_t GetACLVersion(void)
+{
+    return gAclVersion;
+}
+
 void printACL(const OicSecAcl_t* acl)
 {
     OIC_LOG(INFO, TAG, "Print ACL:");
@@ -2508,6 +2528,7 @@ OCStackResult AppendACL2(const OicSecAcl_t* acl)
     {
         gAcl->aces = acl->aces;
     }
+    gAclVersion++;
 
     printACL(gAcl);
 
@@ -2732,6 +2753,7 @@ OCStackResult UpdateDefaultSecProvACE()
                     LL_DELETE(gAcl->aces, ace);
                     FreeACE(ace);
                     isRemoved = true;
+                    gAclVersion++;
                 }
             }
         }
@@ -2748,6 +2770,7 @@ OCStackResult UpdateDefaultSecProvACE()
             if (secDefaultAce)
             {
                 LL_APPEND(gAcl->aces, secDefaultAce);
+                gAclVersion++;
 
                 size_t size = 0;
                 uint8_t *payload = NULL;
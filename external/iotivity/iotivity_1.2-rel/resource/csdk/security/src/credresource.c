@@ -1235,6 +1235,17 @@ static bool UpdatePersistentStorage(const OicSecCred_t *cred)
     return ret;
 }
 
+/**
+ * Forget the (D)TLS sessions kept for resumption once credentials are
+ * removed, as resuming a session skips the credential of the peer.
+ */
+static void ForgetResumableSessions(void)
+{
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    CAforgetSslSessions();
+#endif
+}
+
 /**
  * Compare function used LL_SORT for sorting credentials.
  *
@@ -1519,6 +1530,7 @@ OCStackResult RemoveCredential(const OicUuid_t *subject)
 
     if (deleteFlag)
     {
+        ForgetResumableSessions();
         if (UpdatePersistentStorage(gCred))
         {
             ret = OC_STACK_RESOURCE_DELETED;
@@ -1557,6 +1569,7 @@ OCStackResult RemoveCredentialByCredId(uint16_t credId)
 
     if (deleteFlag)
     {
+        ForgetResumableSessions();
         if (UpdatePersistentStorage(gCred))
         {
             ret = OC_STACK_RESOURCE_DELETED;
@@ -1579,6 +1592,7 @@ OCStackResult RemoveAllCredentials(void)
 {
     DeleteCredList(gCred);
     gCred = GetCredDefault();
+    ForgetResumableSessions();
 
     if (!UpdatePersistentStorage(gCred))
     {
@@ -2339,6 +2353,7 @@ OCStackResult DeInitCredResource()
     OCStackResult result = OCDeleteResource(gCredHandle);
     DeleteCredList(gCred);
     gCred = NULL;
+    ForgetResumableSessions();
     return result;
 }
 
@@ -378,17 +378,40 @@ IotvtICalResult_t IsRequestWithinValidTime(const char *periodStr, const char *re
     IotvtICalRecur_t recur = {.freq=0};
     IotvtICalResult_t ret = IOTVTICAL_INVALID_ACCESS;
 
-    time_t rawTime = time(0);
-    IotvtICalDateTime_t *currentTime = localtime(&rawTime);
-
     ret  = ParsePeriod(periodStr, &period);
     if (ret != IOTVTICAL_SUCCESS)
     {
         return ret;
     }
 
+    if (NULL != recurStr)
+    {
+        ret = ParseRecur(recurStr, &recur);
+        if (ret != IOTVTICAL_SUCCESS)
+        {
+            return ret;
+        }
+    }
+
+    return IsRequestWithinParsedTime(&period, (NULL != recurStr) ? &recur : NULL, time(0));
+}
+
+IotvtICalResult_t IsRequestWithinParsedTime(const IotvtICalPeriod_t *parsedPeriod,
+                                            const IotvtICalRecur_t *recur,
+                                            time_t requestTime)
+{
+    if (NULL == parsedPeriod)
+    {
+        return IOTVTICAL_INVALID_PARAMETER;
+    }
+
+    IotvtICalPeriod_t period = *parsedPeriod;
+    IotvtICalResult_t ret = IOTVTICAL_INVALID_ACCESS;
+
+    IotvtICalDateTime_t *currentTime = localtime(&requestTime);
+
     //If recur is NULL then the access time is between period's startDateTime and endDateTime
-    if (NULL == recurStr)
+    if (NULL == recur)
     {
         ret = ValidatePeriod(&period, currentTime);
     }
@@ -398,13 +421,9 @@ IotvtICalResult_t IsRequestWithinValidTime(const char *periodStr, const char *re
     //is computed from period's startDate and the last instance is computed from
     //"UNTIL". If "UNTIL" is not specified then the recurrence goes for forever.
     //Eg, RRULE: FREQ=DAILY; UNTIL=20150703; BYDAY=MO, WE, FR
-    if (NULL != recurStr)
+    if (NULL != recur)
     {
-        ret = ParseRecur(recurStr, &recur);
-        if (ret != IOTVTICAL_SUCCESS)
-        {
-            return ret;
-        }
+        IotvtICalDateTime_t until = recur->until;
 
         if ((0 <= DiffSecs(&period.startDateTime, currentTime))&&
            (0 <= DiffSecs(currentTime, &period.endDateTime)) &&
@@ -414,19 +433,19 @@ IotvtICalResult_t IsRequestWithinValidTime(const char *periodStr, const char *re
             ret = IOTVTICAL_VALID_ACCESS;
 
             //"UNTIL" is an optional parameter of RRULE, checking if until present in recur
-            if (0 != memcmp(&recur.until, &emptyDT, sizeof(IotvtICalDateTime_t)))
+            if (0 != memcmp(&until, &emptyDT, sizeof(IotvtICalDateTime_t)))
             {
-                if(0 > DiffDays(currentTime, &recur.until))
+                if(0 > DiffDays(currentTime, &until))
                 {
                     ret = IOTVTICAL_INVALID_ACCESS;
                 }
             }
 
             //"BYDAY" is an optional parameter of RRULE, checking if byday present in recur
-            if (NO_WEEKDAY != recur.byDay)
+            if (NO_WEEKDAY != recur->byDay)
             {
 
-                int isValidWD = (0x1 << currentTime->tm_wday) & recur.byDay; //Valid weekdays
+                int isValidWD = (0x1 << currentTime->tm_wday) & recur->byDay; //Valid weekdays
                 if (!isValidWD)
                 {
                     ret = IOTVTICAL_INVALID_ACCESS;
@@ -21,6 +21,7 @@
 
 #include "utlist.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
 #include "policyengine.h"
 #include "amsmgr.h"
 #include "resourcemanager.h"
@@ -39,6 +40,39 @@
 
 #define TAG "OIC_SRM_PE"
 
+// Source of the time of the requests, time() when NULL
+static PETimeSource_t g_peTimeSource = NULL;
+
+void SetPolicyEngineTimeSource(PETimeSource_t timeSource)
+{
+    g_peTimeSource = timeSource;
+}
+
+#ifndef WITH_ARDUINO
+static time_t GetRequestTime(void)
+{
+    return g_peTimeSource ? g_peTimeSource() : time(NULL);
+}
+
+/**
+ * Same as IsRequestWithinValidTime(), at the given time of the request.
+ */
+static bool IsRequestWithinValidTimeAt(const char *periodStr, const char *recurStr,
+                                       time_t requestTime)
+{
+    IotvtICalPeriod_t period = {.startDateTime={.tm_sec=0}};
+    IotvtICalRecur_t recur = {.freq=0};
+
+    if (NULL == periodStr || IOTVTICAL_SUCCESS != ParsePeriod(periodStr, &period)
+        || (NULL != recurStr && IOTVTICAL_SUCCESS != ParseRecur(recurStr, &recur)))
+    {
+        return false;
+    }
+    return IOTVTICAL_VALID_ACCESS == IsRequestWithinParsedTime(&period,
+                                         (NULL != recurStr) ? &recur : NULL, requestTime);
+}
+#endif
+
 uint16_t GetPermissionFromCAMethod_t(const CAMethod_t method)
 {
     uint16_t perm = 0;
@@ -425,13 +459,14 @@ static bool IsAccessWithinValidTime(const OicSecAce_t *ace)
         return false;
     }
 
+    time_t requestTime = GetRequestTime();
     OicSecValidity_t* validity =  NULL;
     LL_FOREACH(ace->validities, validity)
     {
         for(size_t i = 0; i < validity->recurrenceLen; i++)
         {
-            if (IOTVTICAL_VALID_ACCESS ==  IsRequestWithinValidTime(validity->period,
-                validity->recurrences[i]))
+            if (IsRequestWithinValidTimeAt(validity->period, validity->recurrences[i],
+                                           requestTime))
             {
                 OIC_LOG(INFO, TAG, "Access request is in allowed time period");
                 return true;
@@ -474,73 +509,637 @@ static bool IsAccessWithinValidTime(const OicSecAce_t *ace)
 }
 
 
+/** Buckets of the subject index, a power of 2. */
+#define ACE_INDEX_SUBJECT_BUCKETS   (16)
+
+/** Minimum buckets of the resource index, a power of 2. */
+#define ACE_INDEX_MIN_HREF_BUCKETS  (16)
+
+/** Entries of the decision cache, a power of 2. */
+#define PE_DECISION_CACHE_SIZE      (32)
+
+#ifndef WITH_ARDUINO
 /**
- * Find ACLs containing context->subject.
- * Search each ACL for requested resource.
- * If resource found, check for context->permission and period validity.
- * If the ACL is not found locally and AMACL for the resource is found
- * then sends the request to AMS service for the ACL.
- * Set context->retVal to result from first ACL found which contains
- * correct subject AND resource.
+ * Period and recurrence rule of an ACE, parsed once when the ACE is indexed.
  */
-static void ProcessAccessRequest(PEContext_t *context)
+typedef struct IndexedValidTime
 {
-    OIC_LOG(DEBUG, TAG, "Entering ProcessAccessRequest()");
-    if (NULL != context)
+    IotvtICalPeriod_t period;
+    IotvtICalRecur_t recur;
+    bool hasRecur;                  // a NULL recurrence rule checks the period only
+    bool parsed;
+} IndexedValidTime_t;
+#endif
+
+/**
+ * ACE of the index.
+ */
+typedef struct IndexedAce
+{
+    const OicSecAce_t *ace;
+#ifndef WITH_ARDUINO
+    IndexedValidTime_t *validTimes;
+    size_t validTimeCount;
+#endif
+} IndexedAce_t;
+
+/**
+ * Positions of the ACEs of a subject listing a resource.
+ */
+typedef struct AcePositions
+{
+    size_t *positions;
+    size_t count;
+    size_t capacity;
+} AcePositions_t;
+
+/**
+ * ACEs of a subject, in the order of the ACL.
+ */
+typedef struct AceSubjectEntry
+{
+    OicUuid_t subject;
+    IndexedAce_t *aces;
+    size_t aceCount;
+    size_t aceCapacity;
+    AcePositions_t wildcard;        // ACEs listing WILDCARD_RESOURCE_URI
+    struct AceSubjectEntry *next;
+} AceSubjectEntry_t;
+
+/**
+ * ACEs of a subject listing a resource href.
+ */
+typedef struct AceHrefEntry
+{
+    const AceSubjectEntry_t *subject;
+    const char *href;               // owned by the ACL
+    AcePositions_t aces;
+    struct AceHrefEntry *next;
+} AceHrefEntry_t;
+
+/**
+ * A result of ProcessAccessRequest().
+ */
+typedef struct PEDecision
+{
+    OicUuid_t subject;
+    char *resource;
+    uint16_t permission;
+    SRMAccessResponse_t retVal;
+} PEDecision_t;
+
+/**
+ * Index of the ACL by subject and resource href, rebuilt when the version
+ * of the ACL changes. The decisions are dropped at the same time.
+ */
+typedef struct AceIndex
+{
+    bool valid;
+    uint32_t aclVersion;
+    AceSubjectEntry_t *subjects[ACE_INDEX_SUBJECT_BUCKETS];
+    AceHrefEntry_t **hrefs;
+    size_t hrefBuckets;
+    PEDecision_t decisions[PE_DECISION_CACHE_SIZE];
+} AceIndex_t;
+
+static AceIndex_t g_aceIndex;
+
+static uint32_t HashBytes(uint32_t hash, const void *data, size_t len)
+{
+    // FNV-1a
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t HashSubject(const OicUuid_t *subject)
+{
+    return HashBytes(2166136261u, subject->id, sizeof(subject->id));
+}
+
+static uint32_t HashHref(const AceSubjectEntry_t *subject, const char *href)
+{
+    return HashBytes(HashBytes(2166136261u, &subject, sizeof(subject)), href, strlen(href));
+}
+
+static void ClearDecisions(void)
+{
+    for (size_t i = 0; i < PE_DECISION_CACHE_SIZE; i++)
+    {
+        OICFree(g_aceIndex.decisions[i].resource);
+        g_aceIndex.decisions[i].resource = NULL;
+    }
+}
+
+static void FreeAceIndex(void)
+{
+    for (size_t i = 0; i < ACE_INDEX_SUBJECT_BUCKETS; i++)
+    {
+        while (g_aceIndex.subjects[i])
+        {
+            AceSubjectEntry_t *entry = g_aceIndex.subjects[i];
+            g_aceIndex.subjects[i] = entry->next;
+#ifndef WITH_ARDUINO
+            for (size_t j = 0; j < entry->aceCount; j++)
+            {
+                OICFree(entry->aces[j].validTimes);
+            }
+#endif
+            OICFree(entry->aces);
+            OICFree(entry->wildcard.positions);
+            OICFree(entry);
+        }
+    }
+
+    for (size_t i = 0; i < g_aceIndex.hrefBuckets; i++)
+    {
+        while (g_aceIndex.hrefs[i])
+        {
+            AceHrefEntry_t *entry = g_aceIndex.hrefs[i];
+            g_aceIndex.hrefs[i] = entry->next;
+            OICFree(entry->aces.positions);
+            OICFree(entry);
+        }
+    }
+    OICFree(g_aceIndex.hrefs);
+    g_aceIndex.hrefs = NULL;
+    g_aceIndex.hrefBuckets = 0;
+
+    ClearDecisions();
+    g_aceIndex.valid = false;
+}
+
+static bool AddAcePosition(AcePositions_t *list, size_t position)
+{
+    // an ACE listing a resource twice is kept once
+    if (list->count && list->positions[list->count - 1] == position)
+    {
+        return true;
+    }
+    if (list->count == list->capacity)
+    {
+        size_t capacity = list->capacity ? list->capacity * 2 : 4;
+        size_t *positions = (size_t *)OICRealloc(list->positions, capacity * sizeof(size_t));
+        if (!positions)
+        {
+            return false;
+        }
+        list->positions = positions;
+        list->capacity = capacity;
+    }
+    list->positions[list->count++] = position;
+    return true;
+}
+
+static AceSubjectEntry_t *FindAceSubject(const OicUuid_t *subject)
+{
+    AceSubjectEntry_t *entry =
+        g_aceIndex.subjects[HashSubject(subject) & (ACE_INDEX_SUBJECT_BUCKETS - 1)];
+
+    while (entry && memcmp(&entry->subject, subject, sizeof(OicUuid_t)))
+    {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+static AceHrefEntry_t *FindAceHref(const AceSubjectEntry_t *subject, const char *href)
+{
+    AceHrefEntry_t *entry = g_aceIndex.hrefs[HashHref(subject, href) & (g_aceIndex.hrefBuckets - 1)];
+
+    while (entry && (entry->subject != subject || strcmp(entry->href, href)))
+    {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+#ifndef WITH_ARDUINO
+/**
+ * Parse the periods and recurrence rules of an ACE. A rule that does not
+ * parse never grants access, as in IsRequestWithinValidTime().
+ */
+static bool CompileValidTimes(IndexedAce_t *indexed)
+{
+    const OicSecValidity_t *validity = NULL;
+    size_t count = 0;
+
+    LL_FOREACH(indexed->ace->validities, validity)
+    {
+        count += validity->recurrences ? validity->recurrenceLen : 0;
+    }
+    if (!count)
+    {
+        return true;
+    }
+
+    indexed->validTimes = (IndexedValidTime_t *)OICCalloc(count, sizeof(IndexedValidTime_t));
+    if (!indexed->validTimes)
+    {
+        return false;
+    }
+
+    LL_FOREACH(indexed->ace->validities, validity)
+    {
+        for (size_t i = 0; validity->recurrences && i < validity->recurrenceLen; i++)
+        {
+            IndexedValidTime_t *validTime = &indexed->validTimes[indexed->validTimeCount++];
+            validTime->hasRecur = (NULL != validity->recurrences[i]);
+            validTime->parsed = (NULL != validity->period)
+                && (IOTVTICAL_SUCCESS == ParsePeriod(validity->period, &validTime->period))
+                && (!validTime->hasRecur
+                    || IOTVTICAL_SUCCESS == ParseRecur(validity->recurrences[i], &validTime->recur));
+        }
+    }
+    return true;
+}
+#endif
+
+static bool IndexAce(const OicSecAce_t *ace)
+{
+    AceSubjectEntry_t *entry = FindAceSubject(&ace->subjectuuid);
+    if (!entry)
+    {
+        entry = (AceSubjectEntry_t *)OICCalloc(1, sizeof(AceSubjectEntry_t));
+        if (!entry)
+        {
+            return false;
+        }
+        memcpy(&entry->subject, &ace->subjectuuid, sizeof(OicUuid_t));
+        size_t bucket = HashSubject(&ace->subjectuuid) & (ACE_INDEX_SUBJECT_BUCKETS - 1);
+        entry->next = g_aceIndex.subjects[bucket];
+        g_aceIndex.subjects[bucket] = entry;
+    }
+
+    if (entry->aceCount == entry->aceCapacity)
+    {
+        size_t capacity = entry->aceCapacity ? entry->aceCapacity * 2 : 4;
+        IndexedAce_t *aces = (IndexedAce_t *)OICRealloc(entry->aces,
+                                                        capacity * sizeof(IndexedAce_t));
+        if (!aces)
+        {
+            return false;
+        }
+        entry->aces = aces;
+        entry->aceCapacity = capacity;
+    }
+
+    size_t position = entry->aceCount++;
+    IndexedAce_t *indexed = &entry->aces[position];
+    memset(indexed, 0, sizeof(IndexedAce_t));
+    indexed->ace = ace;
+#ifndef WITH_ARDUINO
+    if (!CompileValidTimes(indexed))
+    {
+        return false;
+    }
+#endif
+
+    const OicSecRsrc_t *rsrc = NULL;
+    LL_FOREACH(ace->resources, rsrc)
     {
-        const OicSecAce_t *currentAce = NULL;
-        OicSecAce_t *savePtr = NULL;
+        if (NULL == rsrc->href)
+        {
+            continue;
+        }
+        if (0 == strcmp(WILDCARD_RESOURCE_URI, rsrc->href))
+        {
+            if (!AddAcePosition(&entry->wildcard, position))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        AceHrefEntry_t *href = FindAceHref(entry, rsrc->href);
+        if (!href)
+        {
+            href = (AceHrefEntry_t *)OICCalloc(1, sizeof(AceHrefEntry_t));
+            if (!href)
+            {
+                return false;
+            }
+            href->subject = entry;
+            href->href = rsrc->href;
+            size_t bucket = HashHref(entry, rsrc->href) & (g_aceIndex.hrefBuckets - 1);
+            href->next = g_aceIndex.hrefs[bucket];
+            g_aceIndex.hrefs[bucket] = href;
+        }
+        if (!AddAcePosition(&href->aces, position))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Rebuild the index if the ACL changed since it was built.
+ *
+ * @return true if the index can be used, false if the ACL must be scanned.
+ */
+static bool UpdateAceIndex(void)
+{
+    uint32_t version = GetACLVersion();
+    if (g_aceIndex.valid && g_aceIndex.aclVersion == version)
+    {
+        return true;
+    }
+
+    FreeAceIndex();
+    g_aceIndex.aclVersion = version;
+
+    const OicSecAce_t *aces = GetACLAces();
+    const OicSecAce_t *ace = NULL;
+    size_t hrefCount = 0;
+    LL_FOREACH(aces, ace)
+    {
+        const OicSecRsrc_t *rsrc = NULL;
+        LL_FOREACH(ace->resources, rsrc)
+        {
+            hrefCount++;
+        }
+    }
+
+    g_aceIndex.hrefBuckets = ACE_INDEX_MIN_HREF_BUCKETS;
+    while (g_aceIndex.hrefBuckets < hrefCount)
+    {
+        g_aceIndex.hrefBuckets *= 2;
+    }
+    g_aceIndex.hrefs = (AceHrefEntry_t **)OICCalloc(g_aceIndex.hrefBuckets,
+                                                    sizeof(AceHrefEntry_t *));
+    VERIFY_NON_NULL(TAG, g_aceIndex.hrefs, ERROR);
+
+    LL_FOREACH(aces, ace)
+    {
+        VERIFY_SUCCESS(TAG, IndexAce(ace), ERROR);
+    }
+    g_aceIndex.valid = true;
+    return true;
+
+exit:
+    OIC_LOG(ERROR, TAG, "Failed to index the ACL, falling back to scans");
+    FreeAceIndex();
+    return false;
+}
+
+/**
+ * Check whether the ACE is getting accessed within its valid time periods,
+ * using the rules parsed by the index. See IsAccessWithinValidTime().
+ */
+static bool IsIndexedAccessWithinValidTime(const IndexedAce_t *indexed)
+{
+#ifndef WITH_ARDUINO
+    if (NULL == indexed->ace->validities)
+    {
+        return true;
+    }
 
-        // Start out assuming subject not found.
-        context->retVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
+    //periods & recurrences rules are paired.
+    if (NULL == indexed->ace->validities->recurrences)
+    {
+        return false;
+    }
 
-        char *strUuid = NULL;
-        if (OC_STACK_OK == ConvertUuidToStr(&context->subject, &strUuid))
+    time_t requestTime = GetRequestTime();
+    for (size_t i = 0; i < indexed->validTimeCount; i++)
+    {
+        const IndexedValidTime_t *validTime = &indexed->validTimes[i];
+        if (validTime->parsed && IOTVTICAL_VALID_ACCESS ==
+            IsRequestWithinParsedTime(&validTime->period,
+                                      validTime->hasRecur ? &validTime->recur : NULL,
+                                      requestTime))
         {
-            OIC_LOG_V(DEBUG, TAG, "%s: subject : %s" ,__func__, strUuid);
-            OICFree(strUuid);
+            OIC_LOG(INFO, TAG, "Access request is in allowed time period");
+            return true;
+        }
+    }
+    OIC_LOG(ERROR, TAG, "Access request is in invalid time period");
+    return false;
+#else
+    OC_UNUSED(indexed);
+    return true;
+#endif
+}
+
+/**
+ * Same as ScanAccessRequest(), with the ACEs of the subject listing the
+ * resource taken from the index.
+ *
+ * @return true if the result does not depend on the time of the request,
+ *         and can be cached.
+ */
+static bool ProcessIndexedAccessRequest(PEContext_t *context)
+{
+    bool cacheable = true;
+
+    // Start out assuming subject not found.
+    context->retVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
+
+    const AceSubjectEntry_t *subject = FindAceSubject(&context->subject);
+    if (!subject || !subject->aceCount)
+    {
+        OIC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
+        return cacheable;
+    }
+
+    // The ACEs listing the resource, or the wildcard resource, are checked in
+    // the order of the ACL.
+    static const AcePositions_t noAces = { NULL, 0, 0 };
+    const AceHrefEntry_t *href = FindAceHref(subject, context->resource);
+    const AcePositions_t *named = href ? &href->aces : &noAces;
+    const AcePositions_t *wildcard = &subject->wildcard;
+    size_t i = 0;
+    size_t j = 0;
+    size_t position = 0;
+    SRMAccessResponse_t retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
+
+    while (i < named->count || j < wildcard->count)
+    {
+        if (j == wildcard->count
+            || (i < named->count && named->positions[i] <= wildcard->positions[j]))
+        {
+            position = named->positions[i++];
+            if (j < wildcard->count && wildcard->positions[j] == position)
+            {
+                j++;
+            }
         }
         else
         {
-            OIC_LOG(ERROR, TAG, "Can't convert subject uuid to string");
+            position = wildcard->positions[j++];
+        }
+
+        const IndexedAce_t *indexed = &subject->aces[position];
+        if (indexed->ace->validities)
+        {
+            cacheable = false;
+        }
+
+        // Found the resource, so it's down to valid period & permission.
+        retVal = ACCESS_DENIED_INVALID_PERIOD;
+        if (IsIndexedAccessWithinValidTime(indexed))
+        {
+            retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
+            if (IsPermissionAllowingRequest(indexed->ace->permission, context->permission))
+            {
+                context->retVal = ACCESS_GRANTED;
+                return cacheable;
+            }
         }
+    }
+
+    // As with the scan, the result is the one of the last ACE of the subject.
+    if (position + 1 == subject->aceCount && (named->count || wildcard->count))
+    {
+        context->retVal = retVal;
+    }
+    else
+    {
+        context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
+    }
+    return cacheable;
+}
+
+static PEDecision_t *GetDecisionSlot(const PEContext_t *context)
+{
+    uint32_t hash = HashSubject(&context->subject);
+    hash = HashBytes(hash, context->resource, strlen(context->resource));
+    hash = HashBytes(hash, &context->permission, sizeof(context->permission));
+    return &g_aceIndex.decisions[hash & (PE_DECISION_CACHE_SIZE - 1)];
+}
+
+static bool FindDecision(PEContext_t *context)
+{
+    const PEDecision_t *decision = GetDecisionSlot(context);
+
+    if (decision->resource
+        && decision->permission == context->permission
+        && 0 == memcmp(&decision->subject, &context->subject, sizeof(OicUuid_t))
+        && 0 == strcmp(decision->resource, context->resource))
+    {
+        context->retVal = decision->retVal;
+        return true;
+    }
+    return false;
+}
+
+static void StoreDecision(const PEContext_t *context)
+{
+    PEDecision_t *decision = GetDecisionSlot(context);
+    char *resource = OICStrdup(context->resource);
+
+    if (!resource)
+    {
+        return;
+    }
+    OICFree(decision->resource);
+    memcpy(&decision->subject, &context->subject, sizeof(OicUuid_t));
+    decision->resource = resource;
+    decision->permission = context->permission;
+    decision->retVal = context->retVal;
+}
+
+/**
+ * Find ACLs containing context->subject.
+ * Search each ACL for requested resource.
+ * If resource found, check for context->permission and period validity.
+ * Set context->retVal to result from first ACL found which contains
+ * correct subject AND resource.
+ *
+ * Used when the ACL could not be indexed.
+ */
+static void ScanAccessRequest(PEContext_t *context)
+{
+    const OicSecAce_t *currentAce = NULL;
+    OicSecAce_t *savePtr = NULL;
+
+    // Start out assuming subject not found.
+    context->retVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
 
-        // Loop through all ACLs with a matching Subject searching for the right
-        // ACL for this request.
-        do
+    // Loop through all ACLs with a matching Subject searching for the right
+    // ACL for this request.
+    do
+    {
+        OIC_LOG_V(DEBUG, TAG, "%s: getting ACE..." ,__func__);
+        currentAce = GetACLResourceData(&context->subject, &savePtr);
+
+        if (NULL != currentAce)
         {
-            OIC_LOG_V(DEBUG, TAG, "%s: getting ACE..." ,__func__);
-            currentAce = GetACLResourceData(&context->subject, &savePtr);
+            // Found the subject, so how about resource?
+            OIC_LOG_V(DEBUG, TAG, "%s:found ACE matching subject" ,__func__);
 
-            if (NULL != currentAce)
+            // Subject was found, so err changes to Rsrc not found for now.
+            context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
+            OIC_LOG_V(DEBUG, TAG, "%s:Searching for resource..." ,__func__);
+            if (IsResourceInAce(context->resource, currentAce))
             {
-                // Found the subject, so how about resource?
-                OIC_LOG_V(DEBUG, TAG, "%s:found ACE matching subject" ,__func__);
+                OIC_LOG_V(INFO, TAG, "%s:found matching resource in ACE" ,__func__);
 
-                // Subject was found, so err changes to Rsrc not found for now.
-                context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
-                OIC_LOG_V(DEBUG, TAG, "%s:Searching for resource..." ,__func__);
-                if (IsResourceInAce(context->resource, currentAce))
+                // Found the resource, so it's down to valid period & permission.
+                context->retVal = ACCESS_DENIED_INVALID_PERIOD;
+                if (IsAccessWithinValidTime(currentAce))
                 {
-                    OIC_LOG_V(INFO, TAG, "%s:found matching resource in ACE" ,__func__);
-
-                    // Found the resource, so it's down to valid period & permission.
-                    context->retVal = ACCESS_DENIED_INVALID_PERIOD;
-                    if (IsAccessWithinValidTime(currentAce))
+                    context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
+                    if (IsPermissionAllowingRequest(currentAce->permission, context->permission))
                     {
-                        context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
-                        if (IsPermissionAllowingRequest(currentAce->permission, context->permission))
-                        {
-                            context->retVal = ACCESS_GRANTED;
-                        }
+                        context->retVal = ACCESS_GRANTED;
                     }
                 }
             }
+        }
+        else
+        {
+            OIC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
+        }
+    } while ((NULL != currentAce) && (ACCESS_GRANTED != context->retVal));
+}
+
+/**
+ * Find ACLs containing context->subject.
+ * Search each ACL for requested resource.
+ * If resource found, check for context->permission and period validity.
+ * If the ACL is not found locally and AMACL for the resource is found
+ * then sends the request to AMS service for the ACL.
+ * Set context->retVal to result from first ACL found which contains
+ * correct subject AND resource.
+ */
+static void ProcessAccessRequest(PEContext_t *context)
+{
+    OIC_LOG(DEBUG, TAG, "Entering ProcessAccessRequest()");
+    if (NULL != context)
+    {
+        if (OIC_LOG_ENABLED(DEBUG))
+        {
+            char *strUuid = NULL;
+            if (OC_STACK_OK == ConvertUuidToStr(&context->subject, &strUuid))
+            {
+                OIC_LOG_V(DEBUG, TAG, "%s: subject : %s" ,__func__, strUuid);
+                OICFree(strUuid);
+            }
             else
             {
-                OIC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
+                OIC_LOG(ERROR, TAG, "Can't convert subject uuid to string");
             }
-        } while ((NULL != currentAce) && (ACCESS_GRANTED != context->retVal));
+        }
+
+        if (!UpdateAceIndex())
+        {
+            ScanAccessRequest(context);
+        }
+        else if (FindDecision(context))
+        {
+            OIC_LOG_V(DEBUG, TAG, "%s:found cached decision" ,__func__);
+        }
+        else if (ProcessIndexedAccessRequest(context))
+        {
+            StoreDecision(context);
+        }
 
         if (IsAccessGranted(context->retVal))
         {
@@ -702,5 +1301,6 @@ void DeInitPolicyEngine(PEContext_t *context)
         SetPolicyEngineState(context, STOPPED);
         OICFree(context->amsMgrContext);
     }
+    FreeAceIndex();
     return;
 }
@@ -32,6 +32,7 @@
 #include "ocpayloadcbor.h"
 #include "ocstack.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
 #include "payload_logging.h"
 #include "resourcemanager.h"
 #include "secureresourcemanager.h"
@@ -51,14 +52,112 @@
 #else
 const size_t DB_FILE_SIZE_BLOCK = 1023;
 #endif
+
+/*
+ * The SVR database is stored as a log of records, one per secure virtual
+ * resource:
+ *
+ *   ---------------------------------------------------------------
+ *   | name length | name | payload length | payload | checksum   |
+ *   |  1 byte     |      |  4 bytes (BE)  |         | 4 bytes(BE)|
+ *   ---------------------------------------------------------------
+ *
+ * after a header:
+ *
+ *   -------------------------------------------------
+ *   | PS_SEGMENT_MAGIC | generation   | base size    |
+ *   |  6 bytes         | 4 bytes (BE) | 4 bytes (BE) |
+ *   -------------------------------------------------
+ *
+ * An update appends the record of the updated resource, an empty payload
+ * deletes the resource, and the last record of a resource is the valid one.
+ * A record torn by a failed append does not match its checksum and is dropped
+ * with whatever follows it.
+ *
+ * When the records replaced by later ones make up most of the file, the valid
+ * records are written as a new database of the next generation. A storage
+ * setting alternatePath gets them written into the other of two files,
+ * SVR_DB_DAT_FILE_NAME and alternatePath. The base size is the size of that
+ * new database: a file whose records end before it was torn while written and
+ * is ignored. The database is the complete file of the highest generation, so
+ * a power loss while compacting leaves the previous one. Without alternatePath,
+ * open handlers may map every path to the same file, so SVR_DB_DAT_FILE_NAME
+ * alone is read and rewritten in place.
+ *
+ * A database in the former format, a single CBOR map of all the resources,
+ * is read from SVR_DB_DAT_FILE_NAME only. It is newer than the other file,
+ * which provisioning a new database leaves behind, and it is migrated on the
+ * first update by writing the other file and then this one.
+ */
+static const uint8_t PS_SEGMENT_MAGIC[] = { 'O', 'I', 'C', 'P', 'S', 0x01 };
+
+// Size of the database header
+#define PS_HEADER_SIZE (sizeof(PS_SEGMENT_MAGIC) + 4 + 4)
+
+// Size of the record header and trailer, without the name and payload
+#define PS_RECORD_OVERHEAD (1 + 4 + 4)
+
+// Bytes of replaced records tolerated before the file is compacted
+#define PS_COMPACT_SLACK 1024
+
+typedef struct PSRecord
+{
+    char *name;
+    uint8_t *data;
+    size_t size;
+    struct PSRecord *next;
+} PSRecord;
+
+typedef struct
+{
+    int slot;               // file holding the database, -1 when there is none
+    uint32_t generation;    // highest generation found in either file
+    bool legacy;            // the database is in the former format
+    bool torn;              // the last append to the database was torn
+} PSSlotState;
+
 //the Secure Virtual Database file size
 static size_t g_svrDbFileSize = 0;
 //mutex for the Secure Virtual Database
 static oc_mutex g_mutexDb = NULL;
 
+// Resources of the Secure Virtual Database, read once from the storage
+static PSRecord *g_psRecords = NULL;
+// Storage the records were read from, NULL when they are not read yet
+static const OCPersistentStorage *g_psLoaded = NULL;
+// File of the storage holding the records
+static PSSlotState g_psSlot = { -1, 0, false, false };
+// Set when the file must be rewritten before records are appended to it
+static bool g_psNeedsCompaction = false;
+
 // Persistent Storage status
 static PSStatus_t g_psStatus = PS_NO_EXTERNAL_DB_SET;
 
+static void FreePSRecords(PSRecord **records)
+{
+    while (*records)
+    {
+        PSRecord *record = *records;
+        *records = record->next;
+        OICFree(record->name);
+        OICFree(record->data);
+        OICFree(record);
+    }
+}
+
+// called with g_mutexDb held
+static void DropPSCache(void)
+{
+    FreePSRecords(&g_psRecords);
+    g_psLoaded = NULL;
+    g_psSlot.slot = -1;
+    g_psSlot.generation = 0;
+    g_psSlot.legacy = false;
+    g_psSlot.torn = false;
+    g_psNeedsCompaction = false;
+    g_svrDbFileSize = 0;
+}
+
 /**
  * Update the Persistent Storage Database size.
  */
@@ -82,7 +181,10 @@ OCStackResult InitPersistentStorageInterface(void)
         }
     }
 
-    UpdateSizePSI(0);
+    // the database is read again from the storage registered now
+    oc_mutex_lock(g_mutexDb);
+    DropPSCache();
+    oc_mutex_unlock(g_mutexDb);
 
     return OC_STACK_OK;
 }
@@ -92,201 +194,739 @@ OCStackResult InitPersistentStorageInterface(void)
  */
 void DeinitPersistentStorageInterface(void)
 {
-    g_svrDbFileSize = 0;
+    if (g_mutexDb)
+    {
+        oc_mutex_lock(g_mutexDb);
+        DropPSCache();
+        oc_mutex_unlock(g_mutexDb);
+    }
     oc_mutex_free(g_mutexDb);
     g_mutexDb = NULL;
 }
 
 /**
- * Gets the database size
- *
- * @param ps            is a pointer to OCPersistentStorage for the Virtual Resource(s).
- *
- * @return size_t - total size of the database
+ * Whether the storage opens a file distinct from the database for alternatePath.
  */
-static size_t GetPSIDatabaseSizeWithoutCaching(const OCPersistentStorage *ps)
+static bool HasPSAlternate(const OCPersistentStorage *ps)
 {
-    if (!ps)
+    return ps->alternatePath && strcmp(ps->alternatePath, SVR_DB_DAT_FILE_NAME);
+}
+
+static const char *GetPSFileName(const OCPersistentStorage *ps, int slot)
+{
+    return slot ? ps->alternatePath : SVR_DB_DAT_FILE_NAME;
+}
+
+static bool IsPSEncrypted(const OCPersistentStorage *ps)
+{
+#ifdef __SECURE_PSI__
+    // the file is encrypted as a whole
+    return psiIsKeySet() && ps->encrypt && ps->decrypt;
+#else
+    (void)ps;
+    return false;
+#endif // __SECURE_PSI__
+}
+
+static PSRecord *FindPSRecord(PSRecord *records, const char *name)
+{
+    while (records && strcmp(records->name, name))
     {
-        return 0;
+        records = records->next;
     }
-    size_t size = 0;
-    char buffer[DB_FILE_SIZE_BLOCK];  // can not initialize with declaration
-                                      // but maybe not needed to initialize
-    FILE *fp = ps->open(SVR_DB_DAT_FILE_NAME, "rb");
-    if (fp)
+    return records;
+}
+
+/**
+ * Set the payload of a resource in a list of records, an empty payload
+ * removes the resource.
+ */
+static OCStackResult SetPSRecord(PSRecord **records, const char *name,
+                                 const uint8_t *data, size_t size)
+{
+    PSRecord **link = records;
+    while (*link && strcmp((*link)->name, name))
+    {
+        link = &(*link)->next;
+    }
+
+    if (!data || !size)
     {
-        size_t bytesRead = 0;
-        do
+        PSRecord *record = *link;
+        if (record)
         {
-            bytesRead = ps->read(buffer, 1, DB_FILE_SIZE_BLOCK, fp);
-            size += bytesRead;
-        } while (bytesRead);
-        ps->close(fp);
+            *link = record->next;
+            OICFree(record->name);
+            OICFree(record->data);
+            OICFree(record);
+        }
+        return OC_STACK_OK;
+    }
+
+    uint8_t *copy = (uint8_t *)OICMalloc(size);
+    if (!copy)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    memcpy(copy, data, size);
+
+    PSRecord *record = *link;
+    if (!record)
+    {
+        record = (PSRecord *)OICCalloc(1, sizeof(PSRecord));
+        if (!record || !(record->name = OICStrdup(name)))
+        {
+            OICFree(record);
+            OICFree(copy);
+            return OC_STACK_NO_MEMORY;
+        }
+        *link = record;
+    }
+    OICFree(record->data);
+    record->data = copy;
+    record->size = size;
+    return OC_STACK_OK;
+}
+
+static uint32_t GetPSRecordChecksum(const uint8_t *start, size_t len)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= start[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static size_t GetPSRecordSize(const char *name, size_t size)
+{
+    return PS_RECORD_OVERHEAD + strlen(name) + size;
+}
+
+static void PutUint32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+static uint32_t GetUint32(const uint8_t *in)
+{
+    return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+}
+
+/**
+ * Encode a record into out, which has GetPSRecordSize() bytes.
+ */
+static void EncodePSRecord(uint8_t *out, const char *name, const uint8_t *data, size_t size)
+{
+    const uint8_t *start = out;
+    size_t nameLen = strlen(name);
+
+    *out++ = (uint8_t)nameLen;
+    memcpy(out, name, nameLen);
+    out += nameLen;
+    PutUint32(out, (uint32_t)size);
+    out += 4;
+    if (size)
+    {
+        memcpy(out, data, size);
+        out += size;
+    }
+    PutUint32(out, GetPSRecordChecksum(start, out - start));
+}
+
+/**
+ * Size of the database holding only the valid records.
+ */
+static size_t GetPSCompactSize(const PSRecord *records)
+{
+    size_t size = PS_HEADER_SIZE;
+
+    for (; records; records = records->next)
+    {
+        size += GetPSRecordSize(records->name, records->size);
     }
     return size;
 }
 
+/**
+ * Read the records of a database in the former format, a CBOR map of byte strings.
+ */
+static OCStackResult ParseLegacyPSImage(const uint8_t *image, size_t imageSize,
+                                        PSRecord **records)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    CborParser parser;  // will be initialized in |cbor_parser_init|
+    CborValue cbor;     // will be initialized in |cbor_parser_init|
+    CborValue map;
+    char *name = NULL;
+    uint8_t *data = NULL;
+
+    CborError cborFindResult = cbor_parser_init(image, imageSize, 0, &parser, &cbor);
+    VERIFY_SUCCESS(TAG, CborNoError == cborFindResult && cbor_value_is_map(&cbor), ERROR);
+    cborFindResult = cbor_value_enter_container(&cbor, &map);
+    VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+
+    while (cbor_value_is_valid(&map))
+    {
+        size_t len = 0;
+        VERIFY_SUCCESS(TAG, cbor_value_is_text_string(&map), ERROR);
+        cborFindResult = cbor_value_dup_text_string(&map, &name, &len, &map);
+        VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+
+        // the name of a record is at most UINT8_MAX long
+        if (cbor_value_is_byte_string(&map) && len <= UINT8_MAX)
+        {
+            cborFindResult = cbor_value_dup_byte_string(&map, &data, &len, NULL);
+            VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+            ret = SetPSRecord(records, name, data, len);
+            VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+            ret = OC_STACK_ERROR;
+            OICFree(data);
+            data = NULL;
+        }
+        OICFree(name);
+        name = NULL;
+
+        cborFindResult = cbor_value_advance(&map);
+        VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+    }
+    ret = OC_STACK_OK;
+
+exit:
+    OICFree(name);
+    OICFree(data);
+    return ret;
+}
 
 /**
- * Gets the the Persistent Storage Database size
+ * Read the records of a database, in either format.
  *
- * @param ps - pointer of OCPersistentStorage for the Secure Virtual Resource(s)
+ * @param state - set to the generation of the database, whether it is in
+ *                the former format and whether its last record was torn
  *
- * @return size_t - total size of the SVR database
+ * @return OC_STACK_INCONSISTENT_DB when the database was torn while written
  */
-static size_t GetPSIDatabaseSize(const OCPersistentStorage *ps)
+static OCStackResult ParsePSImage(const uint8_t *image, size_t imageSize,
+                                  PSRecord **records, PSSlotState *state)
 {
-    OIC_LOG_V(DEBUG, TAG, "%s IN", __func__);
-
-    if (!ps)
+    state->generation = 0;
+    state->legacy = false;
+    state->torn = false;
+    if (imageSize < sizeof(PS_SEGMENT_MAGIC)
+        || memcmp(image, PS_SEGMENT_MAGIC, sizeof(PS_SEGMENT_MAGIC)))
+    {
+        OIC_LOG(DEBUG, TAG, "SVR database is a single CBOR map");
+        state->legacy = true;
+        return ParseLegacyPSImage(image, imageSize, records);
+    }
+    if (imageSize < PS_HEADER_SIZE)
     {
-        return 0;
+        return OC_STACK_INCONSISTENT_DB;
     }
+    state->generation = GetUint32(image + sizeof(PS_SEGMENT_MAGIC));
+    size_t baseSize = GetUint32(image + sizeof(PS_SEGMENT_MAGIC) + 4);
 
-    if (!g_svrDbFileSize)
+    size_t pos = PS_HEADER_SIZE;
+    char name[UINT8_MAX + 1];
+    while (pos < imageSize)
     {
-        size_t size = 0;
-        char buffer[DB_FILE_SIZE_BLOCK];  // can not initialize with declaration
-                                          // but maybe not needed to initialize
-        FILE *fp = ps->open(SVR_DB_DAT_FILE_NAME, "rb");
-        if (fp)
+        const uint8_t *start = image + pos;
+        size_t remaining = imageSize - pos;
+
+        size_t nameLen = start[0];
+        if (remaining < PS_RECORD_OVERHEAD + nameLen)
         {
-            size_t bytesRead = 0;
-            do
-            {
-                bytesRead = ps->read(buffer, 1, DB_FILE_SIZE_BLOCK, fp);
-                size += bytesRead;
-            } while (bytesRead);
-            ps->close(fp);
+            break;
         }
-        else
+        size_t size = GetUint32(start + 1 + nameLen);
+        if (remaining - PS_RECORD_OVERHEAD - nameLen < size)
         {
-            OIC_LOG_V(ERROR, TAG, "%s: File open failed.", __func__);
+            break;
+        }
+        size_t len = 1 + nameLen + 4 + size;
+        if (GetUint32(start + len) != GetPSRecordChecksum(start, len))
+        {
+            break;
         }
 
-        UpdateSizePSI(size);
+        memcpy(name, start + 1, nameLen);
+        name[nameLen] = '\0';
+        OCStackResult ret = SetPSRecord(records, name, start + 1 + nameLen + 4, size);
+        if (OC_STACK_OK != ret)
+        {
+            return ret;
+        }
+        pos += len + 4;
     }
-    else
+
+    if (pos < baseSize)
     {
-        OIC_LOG_V(DEBUG, TAG, "%s get size from cache", __func__);
+        OIC_LOG_V(WARNING, TAG, "SVR database of generation %u is incomplete",
+                  state->generation);
+        return OC_STACK_INCONSISTENT_DB;
     }
-
-    OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
-
-    return g_svrDbFileSize;
+    if (pos < imageSize)
+    {
+        OIC_LOG_V(WARNING, TAG, "Dropped %zu bytes of torn records", imageSize - pos);
+        state->torn = true;
+    }
+    return OC_STACK_OK;
 }
 
-#ifdef __SECURE_PSI__
-static OCStackResult getPlaintextFromDB(const OCPersistentStorage *ps, uint8_t **pt,
-        size_t *pt_len)
+/**
+ * Read a whole database file, decrypted if needed.
+ *
+ * @param fileSize - set to the size of the file as stored
+ */
+static OCStackResult ReadPSImage(const OCPersistentStorage *ps, const char *fileName,
+                                 uint8_t **image, size_t *imageSize, size_t *fileSize)
 {
-    OIC_LOG(DEBUG, TAG, "getPlaintextFromDB");
     OCStackResult ret = OC_STACK_ERROR;
+    uint8_t *fsData = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+    size_t bytesRead = 0;
 
-    uint8_t *plaintext = NULL;
+    *image = NULL;
+    *imageSize = 0;
+    *fileSize = 0;
 
-    FILE *fp = NULL;
-    fp = ps->open(SVR_DB_DAT_FILE_NAME, "rb");
-    if (NULL == fp)
+    FILE *fp = ps->open(fileName, "rb");
+    if (!fp)
     {
-        OIC_LOG(ERROR, TAG, "ps->open() Failed");
+        OIC_LOG_V(DEBUG, TAG, "%s: %s cannot be opened", __func__, fileName);
         return OC_STACK_ERROR;
     }
 
-    // Get fileSize of plaintext
-    char buffer[DB_FILE_SIZE_BLOCK];
-    size_t bytesRead = 0;
-    size_t fileSize = 0;
     do
     {
-        bytesRead = ps->read(buffer, 1, DB_FILE_SIZE_BLOCK, fp);
-        fileSize += bytesRead;
+        if (capacity - size < DB_FILE_SIZE_BLOCK)
+        {
+            capacity = capacity ? capacity * 2 : 4 * DB_FILE_SIZE_BLOCK;
+            uint8_t *grown = (uint8_t *)OICRealloc(fsData, capacity);
+            VERIFY_NON_NULL(TAG, grown, ERROR);
+            fsData = grown;
+        }
+        bytesRead = ps->read(fsData + size, 1, DB_FILE_SIZE_BLOCK, fp);
+        size += bytesRead;
     } while (bytesRead);
+    OIC_LOG_V(DEBUG, TAG, "File Read Size: %zu", size);
 
-    // Get plaintext
-    ret = OC_STACK_NO_MEMORY;
-    plaintext = (uint8_t*)OICCalloc(1, fileSize);
-    VERIFY_NON_NULL(TAG, plaintext, ERROR);
+    *fileSize = size;
+#ifdef __SECURE_PSI__
+    if (size && IsPSEncrypted(ps))
+    {
+        OIC_LOG(DEBUG, TAG, "ps->decrypt !");
+
+        unsigned char *plainData = NULL;
+        size_t plainSize = 0;
 
+        if (0 != ps->decrypt(fsData, size, &plainData, &plainSize))
+        {
+            OIC_LOG(ERROR, TAG, "ps->decrypt() Failed");
+            goto exit;
+        }
+        OICFree(fsData);
+        fsData = plainData;
+        size = plainSize;
+    }
+#endif // __SECURE_PSI__
+
+    *image = fsData;
+    *imageSize = size;
+    fsData = NULL;
+    ret = OC_STACK_OK;
+
+exit:
     ps->close(fp);
-    fp = ps->open(SVR_DB_DAT_FILE_NAME, "rb");
-    if (NULL == fp)
+    OICFree(fsData);
+    return ret;
+}
+
+/**
+ * Read the records of the database of a storage, from the complete file of
+ * the highest generation.
+ *
+ * @param state - set to the file holding the database, -1 if there is none,
+ *                and to the highest generation found, also on failure
+ * @param fileSize - set to the size of that file as stored
+ *
+ * @return OC_STACK_INCONSISTENT_DB when there are files but none is complete
+ */
+static OCStackResult LoadPSRecords(const OCPersistentStorage *ps, PSRecord **records,
+                                   PSSlotState *state, size_t *fileSize)
+{
+    OCStackResult ret = OC_STACK_OK;
+    bool found = false;
+    uint32_t loadedGeneration = 0;
+
+    state->slot = -1;
+    state->generation = 0;
+    state->legacy = false;
+    state->torn = false;
+    *fileSize = 0;
+
+    int slots = HasPSAlternate(ps) ? 2 : 1;
+    for (int slot = 0; slot < slots; slot++)
     {
-        OIC_LOG(ERROR, TAG, "ps->open() Failed");
-        return OC_STACK_ERROR;
+        uint8_t *image = NULL;
+        size_t imageSize = 0;
+        size_t slotFileSize = 0;
+        PSRecord *slotRecords = NULL;
+        PSSlotState slotState = { slot, 0, false, false };
+
+        if (OC_STACK_OK != ReadPSImage(ps, GetPSFileName(ps, slot), &image, &imageSize,
+                                       &slotFileSize)
+            || !imageSize)
+        {
+            OICFree(image);
+            continue;
+        }
+        found = true;
+
+        OCStackResult res = ParsePSImage(image, imageSize, &slotRecords, &slotState);
+        OICFree(image);
+        if (slotState.generation > state->generation)
+        {
+            state->generation = slotState.generation;
+        }
+
+        bool newer = false;
+        if (slotState.legacy)
+        {
+            // the former format is only read from the first file, and wins
+            newer = (0 == slot);
+        }
+        else
+        {
+            newer = (state->slot < 0)
+                    || (!state->legacy && slotState.generation > loadedGeneration);
+        }
+
+        if (OC_STACK_OK == res && newer)
+        {
+            FreePSRecords(records);
+            *records = slotRecords;
+            slotRecords = NULL;
+            state->slot = slot;
+            state->legacy = slotState.legacy;
+            state->torn = slotState.torn;
+            loadedGeneration = slotState.generation;
+            *fileSize = slotFileSize;
+        }
+        else if (OC_STACK_NO_MEMORY == res)
+        {
+            ret = res;
+        }
+        FreePSRecords(&slotRecords);
     }
 
-    if (fileSize != ps->read(plaintext, 1, fileSize, fp))
+    if (OC_STACK_OK == ret && found && state->slot < 0)
     {
-        OIC_LOG_V(ERROR, TAG, "ps->read() Failed");
-        ret = OC_STACK_ERROR;
-        goto exit;
+        OIC_LOG(ERROR, TAG, "No complete SVR database");
+        ret = OC_STACK_INCONSISTENT_DB;
+    }
+    if (OC_STACK_OK != ret)
+    {
+        FreePSRecords(records);
+        state->slot = -1;
+    }
+    return ret;
+}
+
+/**
+ * Read the records of the registered storage, unless they are cached already.
+ * Called with g_mutexDb held.
+ */
+static OCStackResult LoadPSCache(const OCPersistentStorage *ps)
+{
+    if (g_psLoaded == ps)
+    {
+        return OC_STACK_OK;
+    }
+    DropPSCache();
+
+    size_t fileSize = 0;
+    OCStackResult ret = LoadPSRecords(ps, &g_psRecords, &g_psSlot, &fileSize);
+    if (OC_STACK_OK == ret)
+    {
+        // no database yet is created by the first update
+        g_psLoaded = ps;
+        g_svrDbFileSize = fileSize;
+        // a database in the former format or with a torn record is not appended to
+        g_psNeedsCompaction = g_psSlot.legacy || g_psSlot.torn;
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "Failed to read the SVR database");
+    }
+    return ret;
+}
+
+/**
+ * Write the records as a database of the next generation into the file not
+ * holding the database, or over the database without an alternate file.
+ *
+ * @param state - updated to the file written on success
+ * @param fileSize - set to the size of the file as stored
+ */
+static OCStackResult WritePSSlot(const OCPersistentStorage *ps, const PSRecord *records,
+                                 PSSlotState *state, size_t *fileSize)
+{
+    OCStackResult ret = OC_STACK_SVR_DB_NOT_EXIST;
+    uint8_t *ciphertext = NULL;
+    FILE *fp = NULL;
+    size_t written = 0;
+    int slot = (HasPSAlternate(ps) && 0 == state->slot) ? 1 : 0;
+    uint32_t generation = state->generation + 1;
+
+    size_t size = GetPSCompactSize(records);
+    uint8_t *image = (uint8_t *)OICMalloc(size);
+    if (!image)
+    {
+        return OC_STACK_NO_MEMORY;
     }
 
-    *pt = plaintext;
-    *pt_len = fileSize;
+    uint8_t *out = image;
+    memcpy(out, PS_SEGMENT_MAGIC, sizeof(PS_SEGMENT_MAGIC));
+    out += sizeof(PS_SEGMENT_MAGIC);
+    PutUint32(out, generation);
+    PutUint32(out + 4, (uint32_t)size);
+    out += 8;
+    for (const PSRecord *record = records; record; record = record->next)
+    {
+        EncodePSRecord(out, record->name, record->data, record->size);
+        out += GetPSRecordSize(record->name, record->size);
+    }
+
+    const uint8_t *payload = image;
+#ifdef __SECURE_PSI__
+    if (IsPSEncrypted(ps))
+    {
+        OIC_LOG(DEBUG, TAG, "ps->encrypt !");
+
+        size_t ct_len = 0;
+
+        if (0 != ps->encrypt(image, size, &ciphertext, &ct_len))
+        {
+            OIC_LOG(ERROR, TAG, "ps->encrypt() Failed");
+            ret = OC_STACK_ERROR;
+            goto exit;
+        }
+
+        payload = ciphertext;
+        size = ct_len;
+    }
+#endif // __SECURE_PSI__
+
+    OIC_LOG_V(DEBUG, TAG, "Writing generation %u in %s: %zu", generation,
+              GetPSFileName(ps, slot), size);
+
+    fp = ps->open(GetPSFileName(ps, slot), "wb");
+    VERIFY_NON_NULL(TAG, fp, ERROR);
+
+    written = ps->write(payload, 1, size, fp);
     ps->close(fp);
 
-    return OC_STACK_OK;
+    if (size == written)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Written %zu bytes into SVR database file", size);
+        state->slot = slot;
+        state->generation = generation;
+        state->legacy = false;
+        state->torn = false;
+        *fileSize = written;
+        ret = OC_STACK_OK;
+    }
+    else
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed writing %zu in the database", written);
+        // the file of this generation is torn, the next attempt is newer
+        state->generation = generation;
+    }
+
 exit:
-    OICFree(plaintext);
+    OICFree(ciphertext);
+    OICFree(image);
+    return ret;
+}
+
+/**
+ * Write the records as a new database, replacing the one of the storage only
+ * once complete when the storage has an alternate file.
+ *
+ * @param state - the file holding the database, updated on success
+ * @param fileSize - set to the size of the file as stored
+ */
+static OCStackResult StorePSRecords(const OCPersistentStorage *ps, const PSRecord *records,
+                                    PSSlotState *state, size_t *fileSize)
+{
+    bool legacy = state->legacy;
+    OCStackResult ret = WritePSSlot(ps, records, state, fileSize);
+    if (OC_STACK_OK == ret && legacy && 0 != state->slot)
+    {
+        // the first file in the former format would still be read first
+        ret = WritePSSlot(ps, records, state, fileSize);
+    }
+    return ret;
+}
+
+/**
+ * Rewrite the database with the valid records only. Called with g_mutexDb held.
+ */
+static OCStackResult CompactPSDatabase(const OCPersistentStorage *ps)
+{
+    size_t fileSize = 0;
+    OCStackResult ret = StorePSRecords(ps, g_psRecords, &g_psSlot, &fileSize);
+    if (OC_STACK_OK == ret)
+    {
+        g_svrDbFileSize = fileSize;
+    }
+    g_psNeedsCompaction = (OC_STACK_OK != ret);
+    return ret;
+}
+
+/**
+ * Store the update of one resource, already applied to the records.
+ * Called with g_mutexDb held.
+ */
+static OCStackResult AppendPSRecord(const OCPersistentStorage *ps, const char *name,
+                                    const uint8_t *data, size_t size)
+{
+    size_t recordSize = GetPSRecordSize(name, size);
+    size_t compactSize = GetPSCompactSize(g_psRecords);
+    if (IsPSEncrypted(ps) || g_psNeedsCompaction || g_psSlot.slot < 0
+        || g_svrDbFileSize + recordSize > 2 * compactSize + PS_COMPACT_SLACK)
+    {
+        return CompactPSDatabase(ps);
+    }
+
+    uint8_t *record = (uint8_t *)OICMalloc(recordSize);
+    if (!record)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+    EncodePSRecord(record, name, data, size);
+
+    size_t written = 0;
+    FILE *fp = ps->open(GetPSFileName(ps, g_psSlot.slot), "ab");
     if (fp)
     {
+        written = ps->write(record, 1, recordSize, fp);
         ps->close(fp);
     }
-    return ret;
+    OICFree(record);
+
+    if (written != recordSize)
+    {
+        // the torn record would hide the ones appended after it
+        OIC_LOG(WARNING, TAG, "Failed appending to the SVR database, rewriting it");
+        return CompactPSDatabase(ps);
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "Appended %zu bytes for %s into SVR database file", recordSize, name);
+    g_svrDbFileSize += recordSize;
+    return OC_STACK_OK;
+}
+
+/**
+ * Encode the records as a CBOR map of byte strings, the former format of the
+ * database.
+ */
+static OCStackResult EncodeLegacyPSImage(const PSRecord *records, uint8_t **payload, size_t *size)
+{
+    int64_t cborEncoderResult = CborNoError;
+    size_t len = 255;
+    // This added '255' is arbitrary value that is added to cover the map addition and ending
+    for (const PSRecord *record = records; record; record = record->next)
+    {
+        len += GetPSRecordSize(record->name, record->size);
+    }
+
+    uint8_t *outPayload = (uint8_t *) OICCalloc(1, len);
+    VERIFY_NON_NULL(TAG, outPayload, ERROR);
+    CborEncoder encoder;  // will be initialized in |cbor_parser_init|
+    cbor_encoder_init(&encoder, outPayload, len, 0);
+    CborEncoder secRsrc;  // will be initialized in |cbor_encoder_create_map|
+    cborEncoderResult |= cbor_encoder_create_map(&encoder, &secRsrc, CborIndefiniteLength);
+    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
+
+    for (const PSRecord *record = records; record; record = record->next)
+    {
+        cborEncoderResult |= cbor_encode_text_string(&secRsrc, record->name, strlen(record->name));
+        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
+        cborEncoderResult |= cbor_encode_byte_string(&secRsrc, record->data, record->size);
+        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
+    }
+
+    cborEncoderResult |= cbor_encoder_close_container(&encoder, &secRsrc);
+    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
+
+    *size = cbor_encoder_get_buffer_size(&encoder, outPayload);
+    *payload = outPayload;
+    return OC_STACK_OK;
+
+exit:
+    OICFree(outPayload);
+    return OC_STACK_ERROR;
 }
 
+#ifdef __SECURE_PSI__
 static OCStackResult OTEncrypt(const OCPersistentStorage *psForPlain,
         const OCPersistentStorage *psForEncrypted)
 {
     OIC_LOG(DEBUG, TAG, "OTEncrypt()");
 
-    uint8_t *plaintext = NULL;
-    size_t pt_len = 0;
-    OCStackResult ret = getPlaintextFromDB(psForPlain, &plaintext, &pt_len);
-    if (OC_STACK_OK != ret)
-    {
-        OIC_LOG(ERROR, TAG, "getPlaintextFromDB() Failed");
-        return ret;
-    }
+    PSRecord *records = NULL;
+    PSRecord *encrypted = NULL;
+    PSSlotState plainState;
+    PSSlotState encState;
+    size_t fileSize = 0;
 
-    // Encrypt plaintext
-    uint8_t *ciphertext = NULL;
-    size_t ct_len = 0;
-    if (0 != psForEncrypted->encrypt(plaintext, pt_len, &ciphertext, &ct_len))
+    OCStackResult ret = LoadPSRecords(psForPlain, &records, &plainState, &fileSize);
+    if (OC_STACK_OK != ret || plainState.slot < 0)
     {
-        OIC_LOG(ERROR, TAG, "psForEncrypted->encrypt() Failed");
-        OICFree(plaintext);
+        OIC_LOG(ERROR, TAG, "Failed to read the plain DB");
+        FreePSRecords(&records);
         return OC_STACK_ERROR;
     }
-    OICFree(plaintext);
 
-    // Write Ciphertext
-    FILE *fp2 = psForEncrypted->open(SVR_DB_DAT_FILE_NAME, "wb");
-    if (NULL == fp2)
+    // the plain DB replaces the encrypted one, written as a newer generation
+    LoadPSRecords(psForEncrypted, &encrypted, &encState, &fileSize);
+    FreePSRecords(&encrypted);
+
+    ret = StorePSRecords(psForEncrypted, records, &encState, &fileSize);
+    FreePSRecords(&records);
+    if (OC_STACK_OK != ret)
     {
-        OIC_LOG(ERROR, TAG, "psForEncrypted->open() Failed");
-        OICFree(ciphertext);
-        return OC_STACK_ERROR;
+        OIC_LOG(ERROR, TAG, "Failed to write the encrypted DB");
+        return ret;
     }
 
-    if (ct_len != psForEncrypted->write(ciphertext, 1, ct_len, fp2))
+    if (g_mutexDb)
     {
-        OIC_LOG(ERROR, TAG, "psForEncrypted->write() Failed");
-        OICFree(ciphertext);
-        return OC_STACK_ERROR;
+        // the encrypted storage may be the one read already
+        oc_mutex_lock(g_mutexDb);
+        DropPSCache();
+        oc_mutex_unlock(g_mutexDb);
     }
-    psForEncrypted->close(fp2);
 
     // Remove plain DB
     if (psForPlain->unlink)
     {
         psForPlain->unlink(SVR_DB_DAT_FILE_NAME);
+        if (HasPSAlternate(psForPlain))
+        {
+            psForPlain->unlink(psForPlain->alternatePath);
+        }
     }
 
-    OICFree(ciphertext);
     return OC_STACK_OK;
 }
 
@@ -375,67 +1015,38 @@ OCStackResult WritePSIDatabase(const uint8_t *payload, size_t size)
     OIC_LOG_V(DEBUG, TAG, "%s IN", __func__);
 
     if (!payload || !size || !g_mutexDb)
-    {
-        OIC_LOG_V(ERROR, TAG, "%s: %s is NULL",
-                   __func__, !payload ? "payload" : !size ? "size" : "mutex");
-        OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
-        return OC_STACK_INVALID_PARAM;
-    }
-
-    OCPersistentStorage *ps = NULL;
-    FILE *fp = NULL;
-    OCStackResult ret = OC_STACK_SVR_DB_NOT_EXIST;
-
-    ps = SRMGetPersistentStorageHandler();
-    VERIFY_NON_NULL(TAG, ps, ERROR);
-
-#ifdef __SECURE_PSI__
-    if (psiIsKeySet() && ps->encrypt && ps->decrypt)
-    {
-        OIC_LOG(DEBUG, TAG, "ps->encrypt !");
-
-        uint8_t *ciphertext = NULL;
-        size_t ct_len = 0;
-
-        if (0 != ps->encrypt(payload, size, &ciphertext, &ct_len))
-        {
-            OIC_LOG(ERROR, TAG, "ps->encrypt() Failed");
-            ret = OC_STACK_ERROR;
-            goto exit;
-        }
-
-        payload = ciphertext;
-        size = ct_len;
+    {
+        OIC_LOG_V(ERROR, TAG, "%s: %s is NULL",
+                   __func__, !payload ? "payload" : !size ? "size" : "mutex");
+        OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
+        return OC_STACK_INVALID_PARAM;
     }
-#endif // __SECURE_PSI__
 
-    OIC_LOG_V(DEBUG, TAG, "Writing in the file: %zu", size);
+    OCStackResult ret = OC_STACK_SVR_DB_NOT_EXIST;
+    PSRecord *records = NULL;
+    PSSlotState state;
+    OCPersistentStorage *ps = SRMGetPersistentStorageHandler();
+    VERIFY_NON_NULL(TAG, ps, ERROR);
 
-    fp = ps->open(SVR_DB_DAT_FILE_NAME, "wb");
-    VERIFY_NON_NULL(TAG, fp, ERROR);
+    ret = ParsePSImage(payload, size, &records, &state);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
 
     oc_mutex_lock(g_mutexDb);
-    g_svrDbFileSize = ps->write(payload, 1, size, fp);
-    ps->close(fp);
-    oc_mutex_unlock(g_mutexDb);
-
-#ifdef __SECURE_PSI__
-    if (psiIsKeySet() && ps->encrypt && ps->decrypt)
-    {
-        OICFree((uint8_t*)payload);
-    }
-#endif // __SECURE_PSI__
-    if (size == g_svrDbFileSize)
-    {
-        OIC_LOG_V(DEBUG, TAG, "Written %zu bytes into SVR database file", size);
-        ret = OC_STACK_OK;
-    }
-    else
+    // the whole database is replaced, written as a newer generation
+    LoadPSCache(ps);
+    FreePSRecords(&g_psRecords);
+    g_psRecords = records;
+    g_psLoaded = ps;
+    records = NULL;
+    ret = CompactPSDatabase(ps);
+    if (OC_STACK_OK != ret)
     {
-        OIC_LOG_V(ERROR, TAG, "Failed writing %zu in the database", g_svrDbFileSize);
+        DropPSCache();
     }
+    oc_mutex_unlock(g_mutexDb);
 
 exit:
+    FreePSRecords(&records);
     OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
     return ret;
 }
@@ -462,75 +1073,38 @@ OCStackResult GetSecureVirtualDatabaseFromPS2(OCPersistentStorage* ps, const cha
         return OC_STACK_INVALID_PARAM;
     }
 
-    FILE *fp = NULL;
-    uint8_t *fsData = NULL;
     size_t fileSize = 0;
+    PSRecord *records = NULL;
+    PSSlotState state;
     OCStackResult ret = OC_STACK_ERROR;
 
-    fileSize = GetPSIDatabaseSizeWithoutCaching(ps);
-    OIC_LOG_V(DEBUG, TAG, "File Read Size: %zu", fileSize);
-    if (fileSize)
-    {
-        fsData = (uint8_t *) OICCalloc(1, fileSize + 1);
-        VERIFY_NON_NULL(TAG, fsData, ERROR);
+    // this storage is not the registered one, it is read without caching
+    ret = LoadPSRecords(ps, &records, &state, &fileSize);
+    VERIFY_SUCCESS(TAG, OC_STACK_OK == ret && state.slot >= 0, ERROR);
+
+    ret = OC_STACK_ERROR;
 
-        fp = ps->open(SVR_DB_DAT_FILE_NAME, "rb");
-        VERIFY_NON_NULL(TAG, fp, ERROR);
-        if (ps->read(fsData, 1, fileSize, fp) == fileSize)
+    if (rsrcName)
+    {
+        PSRecord *record = FindPSRecord(records, rsrcName);
+        // in case of |else (...)|, svr_data not found
+        if (record)
         {
-#ifdef __SECURE_PSI__
-            if (ps->encrypt && ps->decrypt)
-            {
-                OIC_LOG(DEBUG, TAG, "ps->decrypt !");
-
-                unsigned char *plainData = NULL;
-                size_t plainSize = 0;
-
-                if (0 != ps->decrypt(fsData, fileSize, &plainData, &plainSize))
-                {
-                    OIC_LOG(ERROR, TAG, "ps->decrypt() Failed");
-                    ret = OC_STACK_ERROR;
-                    goto exit;
-                }
-                OICFree(fsData);
-                fsData = plainData;
-                fileSize = plainSize;
-            }
-#endif // __SECURE_PSI__
-            if (rsrcName)
-            {
-                CborParser parser;  // will be initialized in |cbor_parser_init|
-                CborValue cbor;     // will be initialized in |cbor_parser_init|
-                cbor_parser_init(fsData, fileSize, 0, &parser, &cbor);
-                CborValue cborValue = {0};
-                CborError cborFindResult = cbor_value_map_find_value(&cbor, rsrcName, &cborValue);
-                if (CborNoError == cborFindResult && cbor_value_is_byte_string(&cborValue))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&cborValue, data, size, NULL);
-                    VERIFY_SUCCESS(TAG, CborNoError==cborFindResult, ERROR);
-                    ret = OC_STACK_OK;
-                }
-                // in case of |else (...)|, svr_data not found
-            }
-            // return everything in case rsrcName is NULL
-            else
-            {
-                *size = fileSize;
-                *data = (uint8_t *) OICCalloc(1, fileSize);
-                VERIFY_NON_NULL(TAG, *data, ERROR);
-                memcpy(*data, fsData, fileSize);
-                ret = OC_STACK_OK;
-            }
+            *data = record->data;
+            *size = record->size;
+            record->data = NULL;
+            ret = OC_STACK_OK;
         }
     }
+    // return everything in case rsrcName is NULL
+    else
+    {
+        ret = EncodeLegacyPSImage(records, data, size);
+    }
     OIC_LOG_V(DEBUG, TAG, "Out %s", __func__);
 
 exit:
-    if (fp)
-    {
-        ps->close(fp);
-    }
-    OICFree(fsData);
+    FreePSRecords(&records);
     return ret;
 }
 
@@ -558,85 +1132,44 @@ OCStackResult GetSecureVirtualDatabaseFromPS(const char *rsrcName, uint8_t **dat
         return OC_STACK_INVALID_PARAM;
     }
 
-    FILE *fp = NULL;
-    uint8_t *fsData = NULL;
-    size_t fileSize = 0;
     OCStackResult ret = OC_STACK_ERROR;
 
     OCPersistentStorage *ps = SRMGetPersistentStorageHandler();
     VERIFY_NON_NULL(TAG, ps, ERROR);
 
-    fileSize = GetPSIDatabaseSize(ps);
-    OIC_LOG_V(DEBUG, TAG, "File Read Size: %zu", fileSize);
-    if (fileSize)
+    oc_mutex_lock(g_mutexDb);
+    ret = LoadPSCache(ps);
+    if (OC_STACK_OK == ret)
     {
-        fsData = (uint8_t *) OICCalloc(1, fileSize);
-        VERIFY_NON_NULL(TAG, fsData, ERROR);
-
-        fp = ps->open(SVR_DB_DAT_FILE_NAME, "rb");
-        VERIFY_NON_NULL(TAG, fp, ERROR);
-        if (ps->read(fsData, 1, fileSize, fp) == fileSize)
+        ret = OC_STACK_ERROR;
+        if (rsrcName)
         {
-#ifdef __SECURE_PSI__
-            if (psiIsKeySet() && ps->encrypt && ps->decrypt)
-            {
-                OIC_LOG(DEBUG, TAG, "ps->decrypt !");
-
-                unsigned char *plainData = NULL;
-                size_t plainSize = 0;
-
-                if (0 != ps->decrypt(fsData, fileSize, &plainData, &plainSize))
-                {
-                    OIC_LOG(ERROR, TAG, "ps->decrypt() Failed");
-                    ret = OC_STACK_ERROR;
-                    goto exit;
-                }
-                OICFree(fsData);
-                fsData = plainData;
-                fileSize = plainSize;
-            }
-#endif // __SECURE_PSI__
-            if (rsrcName)
+            const PSRecord *record = FindPSRecord(g_psRecords, rsrcName);
+            // in case of |else (...)|, svr_data not found
+            if (record && (*data = (uint8_t *) OICMalloc(record->size)))
             {
-                CborParser parser;  // will be initialized in |cbor_parser_init|
-                CborValue cbor;     // will be initialized in |cbor_parser_init|
-                cbor_parser_init(fsData, fileSize, 0, &parser, &cbor);
-                CborValue cborValue = {0};
-                CborError cborFindResult = cbor_value_map_find_value(&cbor, rsrcName, &cborValue);
-                if (CborNoError == cborFindResult && cbor_value_is_byte_string(&cborValue))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&cborValue, data, size, NULL);
-                    VERIFY_SUCCESS(TAG, CborNoError==cborFindResult, ERROR);
-                    ret = OC_STACK_OK;
-                }
-                // in case of |else (...)|, svr_data not found
-            }
-            // return everything in case rsrcName is NULL
-            else
-            {
-                *size = fileSize;
-                *data = (uint8_t *) OICCalloc(1, fileSize);
-                VERIFY_NON_NULL(TAG, *data, ERROR);
-                memcpy(*data, fsData, fileSize);
+                memcpy(*data, record->data, record->size);
+                *size = record->size;
                 ret = OC_STACK_OK;
             }
         }
+        // return everything in case rsrcName is NULL
+        else if (g_psRecords)
+        {
+            ret = EncodeLegacyPSImage(g_psRecords, data, size);
+        }
     }
+    oc_mutex_unlock(g_mutexDb);
     OIC_LOG(DEBUG, TAG, "GetSecureVirtualDatabaseFromPS OUT");
 
 exit:
-    if (fp)
-    {
-        ps->close(fp);
-    }
-    OICFree(fsData);
     return ret;
 }
 
 /**
  * Updates the Secure Virtual Resource(s) into the Persistent Storage.
- * This function stores cbor-payload of each resource by appending resource name,
- * and empty payload implies deleting the value
+ * Only the record of the updated resource is written, and empty payload
+ * implies deleting the value
  *
  * @param rsrcName - pointer of character string for the SVR name (e.g. "acl")
  * @param psPayload - pointer of the updated Secure Virtual Resource(s)
@@ -647,243 +1180,40 @@ exit:
 OCStackResult UpdateSecureResourceInPS(const char *rsrcName, const uint8_t *psPayload, size_t psSize)
 {
     OIC_LOG(DEBUG, TAG, "UpdateSecureResourceInPS IN");
-    if (!rsrcName)
+    if (!rsrcName || !*rsrcName || strlen(rsrcName) > UINT8_MAX || !g_mutexDb)
     {
         return OC_STACK_INVALID_PARAM;
     }
-
-    size_t dbSize = 0;
-    size_t outSize = 0;
-    uint8_t *dbData = NULL;
-    uint8_t *outPayload = NULL;
-
-    uint8_t *aclCbor = NULL;
-    uint8_t *pstatCbor = NULL;
-    uint8_t *doxmCbor = NULL;
-    uint8_t *amaclCbor = NULL;
-    uint8_t *svcCbor = NULL;
-    uint8_t *credCbor = NULL;
-    uint8_t *pconfCbor = NULL;
-    uint8_t *resetPfCbor = NULL;
-    uint8_t *crlCbor = NULL;
-
-    int64_t cborEncoderResult = CborNoError;
-    OCStackResult ret = GetSecureVirtualDatabaseFromPS(NULL, &dbData, &dbSize);
-    if (dbData && dbSize)
+    if (!psPayload)
     {
-        size_t aclCborLen = 0;
-        size_t pstatCborLen = 0;
-        size_t doxmCborLen = 0;
-        size_t amaclCborLen = 0;
-        size_t svcCborLen = 0;
-        size_t credCborLen = 0;
-        size_t pconfCborLen = 0;
-        size_t resetPfCborLen = 0;
-        size_t crlCborLen = 0;
-
-        // Gets each secure virtual resource from persistent storage
-        // this local scoping intended, for destroying large cbor instances after use
-        {
-            CborParser parser;  // will be initialized in |cbor_parser_init|
-            CborValue cbor;     // will be initialized in |cbor_parser_init|
-            cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
-            CborValue curVal = {0};
-            CborError cborFindResult = CborNoError;
+        psSize = 0;
+    }
 
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_ACL_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &aclCbor, &aclCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding ACL Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PSTAT_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &pstatCbor, &pstatCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PSTAT Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_DOXM_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &doxmCbor, &doxmCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult,  "Failed Finding DOXM Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_AMACL_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &amaclCbor, &amaclCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding AMACL Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_SVC_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &svcCbor, &svcCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding SVC Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRED_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &credCbor, &credCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding CRED Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PCONF_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &pconfCbor, &pconfCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PCONF Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_RESET_PF_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &resetPfCbor, &resetPfCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding Reset Profile Name Value.");
-            }
-            int64_t cborFindCrlResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRL_NAME, &curVal);
-            if (CborNoError == cborFindCrlResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindCrlResult = cbor_value_dup_byte_string(&curVal, &crlCbor, &crlCborLen, NULL);
-                if (CborNoError != cborFindCrlResult && CborErrorOutOfMemory != cborFindCrlResult)
-                {
-                    OIC_LOG(ERROR, TAG, "Failed Finding optional CRL Name Value.");
-                }
-                else
-                {
-                    OIC_LOG(INFO, TAG, "Successfully Finding optional CRL Name Value.");
-                }
-            }
-        }
+    OCStackResult ret = OC_STACK_SVR_DB_NOT_EXIST;
+    OCPersistentStorage *ps = SRMGetPersistentStorageHandler();
+    VERIFY_NON_NULL(TAG, ps, ERROR);
 
-        // Updates the added |psPayload| with the existing secure virtual resource(s)
-        // this local scoping intended, for destroying large cbor instances after use
+    oc_mutex_lock(g_mutexDb);
+    ret = LoadPSCache(ps);
+    if (OC_STACK_OK == ret)
+    {
+        bool exists = (NULL != FindPSRecord(g_psRecords, rsrcName));
+        ret = SetPSRecord(&g_psRecords, rsrcName, psPayload, psSize);
+        if (OC_STACK_OK == ret && (psSize || exists))
         {
-            size_t size = aclCborLen + pstatCborLen + doxmCborLen + amaclCborLen
-                        + svcCborLen + credCborLen + pconfCborLen + resetPfCborLen + crlCborLen
-                        + psSize + 255;
-            // This added '255' is arbitrary value that is added to cover the name of the resource, map addition and ending
-
-            outPayload = (uint8_t *) OICCalloc(1, size);
-            VERIFY_NON_NULL(TAG, outPayload, ERROR);
-            CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-            cbor_encoder_init(&encoder, outPayload, size, 0);
-            CborEncoder secRsrc;  // will be initialized in |cbor_encoder_create_map|
-            cborEncoderResult |= cbor_encoder_create_map(&encoder, &secRsrc, CborIndefiniteLength);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
-
-            if (psPayload && psSize)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, rsrcName, strlen(rsrcName));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, psPayload, psSize);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
-            }
-            if (strcmp(OIC_JSON_ACL_NAME, rsrcName) && aclCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_ACL_NAME, strlen(OIC_JSON_ACL_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, aclCbor, aclCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Value.");
-            }
-            if (strcmp(OIC_JSON_PSTAT_NAME, rsrcName) && pstatCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_PSTAT_NAME, strlen(OIC_JSON_PSTAT_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, pstatCbor, pstatCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Value.");
-            }
-            if (strcmp(OIC_JSON_DOXM_NAME, rsrcName) && doxmCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_DOXM_NAME, strlen(OIC_JSON_DOXM_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Doxm Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, doxmCbor, doxmCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Doxm Value.");
-            }
-            if (strcmp(OIC_JSON_AMACL_NAME, rsrcName) && amaclCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_AMACL_NAME, strlen(OIC_JSON_AMACL_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Amacl Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, amaclCbor, amaclCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Amacl Value.");
-            }
-            if (strcmp(OIC_JSON_SVC_NAME, rsrcName) && svcCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_SVC_NAME, strlen(OIC_JSON_SVC_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding SVC Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, svcCbor, svcCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding SVC Value.");
-            }
-            if (strcmp(OIC_JSON_CRED_NAME, rsrcName) && credCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_CRED_NAME, strlen(OIC_JSON_CRED_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Cred Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, credCbor, credCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Cred Value.");
-            }
-            if (strcmp(OIC_JSON_PCONF_NAME, rsrcName) && pconfCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_PCONF_NAME, strlen(OIC_JSON_PCONF_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Pconf Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, pconfCbor, pconfCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Pconf Value.");
-            }
-            if (strcmp(OIC_JSON_RESET_PF_NAME, rsrcName) && resetPfCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_RESET_PF_NAME, strlen(OIC_JSON_RESET_PF_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, resetPfCbor, resetPfCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Value.");
-            }
-            if (strcmp(OIC_JSON_CRL_NAME, rsrcName) && crlCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_CRL_NAME, strlen(OIC_JSON_CRL_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Crl Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, crlCbor, crlCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Crl Value.");
-            }
-
-            cborEncoderResult |= cbor_encoder_close_container(&encoder, &secRsrc);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-            outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+            ret = AppendPSRecord(ps, rsrcName, psPayload, psSize);
         }
     }
-    else if (psPayload && psSize)
+    if (OC_STACK_OK != ret)
     {
-        size_t size = psSize + 255;
-        // This added '255' is arbitrary value that is added to cover the name of the resource, map addition and ending
-
-        outPayload = (uint8_t *) OICCalloc(1, size);
-        VERIFY_NON_NULL(TAG, outPayload, ERROR);
-        CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-        cbor_encoder_init(&encoder, outPayload, size, 0);
-        CborEncoder secRsrc;  // will be initialized in |cbor_encoder_create_map|
-        cborEncoderResult |= cbor_encoder_create_map(&encoder, &secRsrc, CborIndefiniteLength);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
-
-        cborEncoderResult |= cbor_encode_text_string(&secRsrc, rsrcName, strlen(rsrcName));
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
-        cborEncoderResult |= cbor_encode_byte_string(&secRsrc, psPayload, psSize);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
-
-        cborEncoderResult |= cbor_encoder_close_container(&encoder, &secRsrc);
-        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-        outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+        // the records may not match the file anymore
+        DropPSCache();
     }
-
-    ret = WritePSIDatabase(outPayload, outSize);
+    oc_mutex_unlock(g_mutexDb);
 
     OIC_LOG(DEBUG, TAG, "UpdateSecureResourceInPS OUT");
 
 exit:
-    OICFree(dbData);
-    OICFree(outPayload);
-    OICFree(aclCbor);
-    OICFree(pstatCbor);
-    OICFree(doxmCbor);
-    OICFree(amaclCbor);
-    OICFree(svcCbor);
-    OICFree(credCbor);
-    OICFree(pconfCbor);
-    OICFree(resetPfCbor);
-    OICFree(crlCbor);
     return ret;
 }
 
@@ -898,42 +1228,23 @@ OCStackResult ResetSecureResourceInPS(void)
 {
     OIC_LOG(DEBUG, TAG, "ResetSecureResourceInPS IN");
 
-    size_t dbSize = 0;
-    size_t outSize = 0;
-    uint8_t *dbData = NULL;
-    uint8_t *outPayload = NULL;
-
     uint8_t *aclCbor = NULL;
     uint8_t *credCbor = NULL;
     uint8_t *pstatCbor = NULL;
     uint8_t *doxmCbor = NULL;
     uint8_t *resetPfCbor = NULL;
+    PSRecord *records = NULL;
 
-    int64_t cborEncoderResult = CborNoError;
-    OCStackResult ret = GetSecureVirtualDatabaseFromPS(NULL, &dbData, &dbSize);
+    size_t resetPfCborLen = 0;
+    OCStackResult ret = GetSecureVirtualDatabaseFromPS(OIC_JSON_RESET_PF_NAME, &resetPfCbor,
+                                                       &resetPfCborLen);
 
-    if(dbData && dbSize)
+    if (resetPfCbor && resetPfCborLen)
     {
         size_t aclCborLen = 0;
         size_t credCborLen = 0;
         size_t pstatCborLen = 0;
         size_t doxmCborLen = 0;
-        size_t resetPfCborLen = 0;
-
-        // Gets the reset profile from persistent storage
-        {
-            CborParser parser;  // will be initialized in |cbor_parser_init|
-            CborValue cbor;     // will be initialized in |cbor_parser_init|
-            cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
-            CborValue curVal = {0};
-            CborError cborFindResult = CborNoError;
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_RESET_PF_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &resetPfCbor, &resetPfCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding Reset Profile Name Value.");
-            }
-        }
 
         // Gets each secure virtual resource from the reset profile
         {
@@ -968,51 +1279,35 @@ OCStackResult ResetSecureResourceInPS(void)
             }
         }
 
+        // The database keeps the reset resources and the reset profile only
+        ret = SetPSRecord(&records, OIC_JSON_ACL_NAME, aclCbor, aclCborLen);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+        ret = SetPSRecord(&records, OIC_JSON_CRED_NAME, credCbor, credCborLen);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+        ret = SetPSRecord(&records, OIC_JSON_PSTAT_NAME, pstatCbor, pstatCborLen);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+        ret = SetPSRecord(&records, OIC_JSON_DOXM_NAME, doxmCbor, doxmCborLen);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+        ret = SetPSRecord(&records, OIC_JSON_RESET_PF_NAME, resetPfCbor, resetPfCborLen);
+        VERIFY_SUCCESS(TAG, OC_STACK_OK == ret, ERROR);
+
+        ret = OC_STACK_SVR_DB_NOT_EXIST;
+        OCPersistentStorage *ps = SRMGetPersistentStorageHandler();
+        VERIFY_NON_NULL(TAG, ps, ERROR);
+
+        oc_mutex_lock(g_mutexDb);
+        // the reset database is written as a newer generation
+        LoadPSCache(ps);
+        FreePSRecords(&g_psRecords);
+        g_psRecords = records;
+        g_psLoaded = ps;
+        records = NULL;
+        ret = CompactPSDatabase(ps);
+        if (OC_STACK_OK != ret)
         {
-            size_t size = aclCborLen + credCborLen + pstatCborLen + doxmCborLen + resetPfCborLen + 255;
-            // This added '255' is arbitrary value added to cover the name of the resource, map addition, and ending
-
-            outPayload = (uint8_t *) OICCalloc(1, size);
-            VERIFY_NON_NULL(TAG, outPayload, ERROR);
-            CborEncoder encoder;
-            cbor_encoder_init(&encoder, outPayload, size, 0);
-            CborEncoder secRsrc;
-            cborEncoderResult |= cbor_encoder_create_map(&encoder, &secRsrc, CborIndefiniteLength);
-
-            cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_ACL_NAME, strlen(OIC_JSON_ACL_NAME));
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Name.");
-            cborEncoderResult |= cbor_encode_byte_string(&secRsrc, aclCbor, aclCborLen);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding ACL Value.");
-
-            if (credCborLen)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_CRED_NAME, strlen(OIC_JSON_CRED_NAME));
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding CRED Name.");
-                cborEncoderResult |= cbor_encode_byte_string(&secRsrc, credCbor, credCborLen);
-                VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding CRED Value.");
-            }
-
-            cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_PSTAT_NAME, strlen(OIC_JSON_PSTAT_NAME));
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Name.");
-            cborEncoderResult |= cbor_encode_byte_string(&secRsrc, pstatCbor, pstatCborLen);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PSTAT Value.");
-
-            cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_DOXM_NAME, strlen(OIC_JSON_DOXM_NAME));
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding DOXM Name.");
-            cborEncoderResult |= cbor_encode_byte_string(&secRsrc, doxmCbor, doxmCborLen);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding DOXM Value.");
-
-            cborEncoderResult |= cbor_encode_text_string(&secRsrc, OIC_JSON_RESET_PF_NAME, strlen(OIC_JSON_RESET_PF_NAME));
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Name.");
-            cborEncoderResult |= cbor_encode_byte_string(&secRsrc, resetPfCbor, resetPfCborLen);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Reset Profile Value.");
-
-            cborEncoderResult |= cbor_encoder_close_container(&encoder, &secRsrc);
-            VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Array.");
-            outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+            DropPSCache();
         }
-
-        ret = WritePSIDatabase(outPayload, outSize);
+        oc_mutex_unlock(g_mutexDb);
     }
 
     SRMDeInitSecureResources();
@@ -1020,8 +1315,7 @@ OCStackResult ResetSecureResourceInPS(void)
     OIC_LOG(DEBUG, TAG, "ResetSecureResourceINPS OUT");
 
 exit:
-    OICFree(dbData);
-    OICFree(outPayload);
+    FreePSRecords(&records);
     OICFree(aclCbor);
     OICFree(credCbor);
     OICFree(pstatCbor);
@@ -1042,68 +1336,39 @@ OCStackResult CreateResetProfile(void)
 {
     OIC_LOG(DEBUG, TAG, "CreateResetProfile IN");
 
-    size_t dbSize = 0;
-    uint8_t *dbData = NULL;
-
     uint8_t *aclCbor = NULL;
     uint8_t *credCbor = NULL;
     uint8_t *pstatCbor = NULL;
     uint8_t *doxmCbor = NULL;
     uint8_t *resetPfCbor = NULL;
 
+    size_t aclCborLen = 0;
+    size_t credCborLen = 0;
+    size_t pstatCborLen = 0;
+    size_t doxmCborLen = 0;
+    size_t resetPfCborLen = 0;
+
     OCStackResult ret = OC_STACK_ERROR;
     int64_t cborEncoderResult = CborNoError;
-    ret = GetSecureVirtualDatabaseFromPS(NULL, &dbData, &dbSize);
-    if (dbData && dbSize)
-    {
-        size_t aclCborLen = 0;
-        size_t credCborLen = 0;
-        size_t pstatCborLen = 0;
-        size_t doxmCborLen = 0;
-        size_t resetPfCborLen = 0;
-
-        {
-            CborParser parser;
-            CborValue cbor;
-            cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
-            CborValue curVal = {0};
-            CborError cborFindResult = CborNoError;
 
-            // abort if reset profile exists
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_RESET_PF_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                OIC_LOG(DEBUG, TAG, "Reset Profile already exists!!");
-                OICFree(dbData);
-                return ret;
-            }
+    // abort if reset profile exists
+    if (OC_STACK_OK == GetSecureVirtualDatabaseFromPS(OIC_JSON_RESET_PF_NAME, &resetPfCbor,
+                                                      &resetPfCborLen))
+    {
+        OIC_LOG(DEBUG, TAG, "Reset Profile already exists!!");
+        OICFree(resetPfCbor);
+        return ret;
+    }
 
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_ACL_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &aclCbor, &aclCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding ACL Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRED_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &credCbor, &credCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding CRED Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PSTAT_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &pstatCbor, &pstatCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult, "Failed Finding PSTAT Name Value.");
-            }
-            cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_DOXM_NAME, &curVal);
-            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&curVal))
-            {
-                cborFindResult = cbor_value_dup_byte_string(&curVal, &doxmCbor, &doxmCborLen, NULL);
-                VERIFY_CBOR_SUCCESS(TAG, cborFindResult,  "Failed Finding DOXM Name Value.");
-            }
-        }
+    // the resources are read from the cached database, the missing ones are left empty
+    GetSecureVirtualDatabaseFromPS(OIC_JSON_ACL_NAME, &aclCbor, &aclCborLen);
+    GetSecureVirtualDatabaseFromPS(OIC_JSON_CRED_NAME, &credCbor, &credCborLen);
+    GetSecureVirtualDatabaseFromPS(OIC_JSON_PSTAT_NAME, &pstatCbor, &pstatCborLen);
+    GetSecureVirtualDatabaseFromPS(OIC_JSON_DOXM_NAME, &doxmCbor, &doxmCborLen);
 
+    if (aclCborLen || credCborLen || pstatCborLen || doxmCborLen)
+    {
+        ret = OC_STACK_OK;
         {
             size_t size = aclCborLen + credCborLen + pstatCborLen + doxmCborLen + 255;
             resetPfCbor = (uint8_t *) OICCalloc(1, size);
@@ -1150,7 +1415,6 @@ OCStackResult CreateResetProfile(void)
     OIC_LOG(DEBUG, TAG, "CreateResetProfile OUT");
 
 exit:
-    OICFree(dbData);
     OICFree(aclCbor);
     OICFree(credCbor);
     OICFree(pstatCbor);
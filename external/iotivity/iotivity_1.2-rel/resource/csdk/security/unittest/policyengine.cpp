@@ -19,6 +19,7 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include "gtest/gtest.h"
+#include <time.h>
 #include "ocstack.h"
 #include "cainterface.h"
 #include "srmresourcestrings.h"
@@ -34,6 +35,11 @@ extern "C" {
 
 #include "policyengine.h"
 #include "doxmresource.h"
+#include "aclresource.h"
+#include "security_internals.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "utlist.h"
 
 // test parameters
 PEContext_t g_peContext;
@@ -108,6 +114,163 @@ TEST(PolicyEngineCore, CheckDevOwnerRequest)
     }
 }
 
+#define PE_UT_ACE_COUNT      (500)
+#define PE_UT_SUBJECT_COUNT  (50)
+
+static OicUuid_t PEUtSubject(int subject)
+{
+    OicUuid_t uuid = OicUuid_t();
+    snprintf((char *)uuid.id, sizeof(uuid.id), "Subject%03d", subject);
+    return uuid;
+}
+
+static void PEUtResource(int ace, char *resource, size_t size)
+{
+    snprintf(resource, size, "/a/res%d", ace);
+}
+
+static void PEUtAddAce(OicSecAcl_t *acl, const OicUuid_t *subject, const char *href,
+                       uint16_t permission)
+{
+    OicSecAce_t *ace = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+    ASSERT_TRUE(NULL != ace);
+    OicSecRsrc_t *rsrc = (OicSecRsrc_t *)OICCalloc(1, sizeof(OicSecRsrc_t));
+    ASSERT_TRUE(NULL != rsrc);
+    rsrc->href = OICStrdup(href);
+    LL_APPEND(ace->resources, rsrc);
+    memcpy(&ace->subjectuuid, subject, sizeof(OicUuid_t));
+    ace->permission = permission;
+    LL_APPEND(acl->aces, ace);
+}
+
+/**
+ * ACL of PE_UT_ACE_COUNT ACEs spread over PE_UT_SUBJECT_COUNT subjects, each
+ * granting read access to one resource, and one ACE granting read access to
+ * /a/public for the wildcard subject.
+ */
+static OicSecAcl_t *PEUtCreateAcl(int skippedAce)
+{
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    char resource[MAX_URI_LENGTH];
+
+    for (int i = 0; acl && i < PE_UT_ACE_COUNT - 1; i++)
+    {
+        if (i != skippedAce)
+        {
+            OicUuid_t subject = PEUtSubject(i % PE_UT_SUBJECT_COUNT);
+            PEUtResource(i, resource, sizeof(resource));
+            PEUtAddAce(acl, &subject, resource, PERMISSION_READ);
+        }
+    }
+    if (acl)
+    {
+        PEUtAddAce(acl, &WILDCARD_SUBJECT_ID, "/a/public", PERMISSION_READ);
+    }
+    return acl;
+}
+
+// The ACL set by the tests is freed with DeInitACLResource().
+TEST(PolicyEngineCore, CheckPermissionIndexedAcl)
+{
+    OicSecAcl_t *acl = PEUtCreateAcl(-1);
+    ASSERT_TRUE(NULL != acl);
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+    g_peContext.resourceType = NOT_A_SVR_RESOURCE;
+
+    char resource[MAX_URI_LENGTH];
+    OicUuid_t subject = PEUtSubject(7);
+    OicUuid_t other = PEUtSubject(8);
+    OicUuid_t unknown = PEUtSubject(PE_UT_SUBJECT_COUNT);
+    PEUtResource(7 + PE_UT_SUBJECT_COUNT * 3, resource, sizeof(resource));
+
+    // twice, the second answer coming from the decision cache
+    for (int i = 0; i < 2; i++)
+    {
+        EXPECT_EQ(ACCESS_GRANTED,
+                  CheckPermission(&g_peContext, &subject, resource, PERMISSION_READ));
+        EXPECT_FALSE(IsAccessGranted(
+                  CheckPermission(&g_peContext, &subject, resource, PERMISSION_WRITE)));
+        EXPECT_FALSE(IsAccessGranted(
+                  CheckPermission(&g_peContext, &other, resource, PERMISSION_READ)));
+        EXPECT_EQ(ACCESS_GRANTED,
+                  CheckPermission(&g_peContext, &unknown, "/a/public", PERMISSION_READ));
+        EXPECT_FALSE(IsAccessGranted(
+                  CheckPermission(&g_peContext, &unknown, resource, PERMISSION_READ)));
+    }
+
+    // the cached decisions are dropped with the ACL
+    OicSecAcl_t *updatedAcl = PEUtCreateAcl(7 + PE_UT_SUBJECT_COUNT * 3);
+    ASSERT_TRUE(NULL != updatedAcl);
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(updatedAcl));
+    DeleteACLList(acl);
+    EXPECT_FALSE(IsAccessGranted(
+              CheckPermission(&g_peContext, &subject, resource, PERMISSION_READ)));
+
+    DeInitACLResource();
+}
+
+// time of the requests checked by the policy engine
+static time_t g_peUtNow = 0;
+
+static time_t PEUtGetTime(void)
+{
+    return g_peUtNow;
+}
+
+static time_t PEUtLocalTime(int hour, int min, int sec)
+{
+    struct tm local = {};
+    local.tm_year = 2016 - 1900;
+    local.tm_mon = 5;
+    local.tm_mday = 15;
+    local.tm_hour = hour;
+    local.tm_min = min;
+    local.tm_sec = sec;
+    local.tm_isdst = -1;
+    return mktime(&local);
+}
+
+TEST(PolicyEngineCore, CheckPermissionValidityNotCached)
+{
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    ASSERT_TRUE(NULL != acl);
+    OicUuid_t subject = PEUtSubject(PE_UT_SUBJECT_COUNT + 1);
+    PEUtAddAce(acl, &subject, "/a/timed", PERMISSION_READ);
+
+    // daily, from 10:00 until 11:00
+    OicSecValidity_t *validity = (OicSecValidity_t *)OICCalloc(1, sizeof(OicSecValidity_t));
+    ASSERT_TRUE(NULL != validity);
+    validity->period = OICStrdup("20160101T100000/20160101T110000");
+    ASSERT_TRUE(NULL != validity->period);
+    validity->recurrences = (char **)OICCalloc(1, sizeof(char *));
+    ASSERT_TRUE(NULL != validity->recurrences);
+    validity->recurrences[0] = OICStrdup("FREQ=DAILY");
+    validity->recurrenceLen = 1;
+    acl->aces->validities = validity;
+
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+    g_peContext.resourceType = NOT_A_SVR_RESOURCE;
+    SetPolicyEngineTimeSource(PEUtGetTime);
+
+    g_peUtNow = PEUtLocalTime(10, 30, 0);
+    EXPECT_EQ(ACCESS_GRANTED,
+              CheckPermission(&g_peContext, &subject, "/a/timed", PERMISSION_READ));
+    EXPECT_EQ(ACCESS_GRANTED,
+              CheckPermission(&g_peContext, &subject, "/a/timed", PERMISSION_READ));
+
+    // the ACL is unchanged, but the period is over
+    g_peUtNow = PEUtLocalTime(11, 0, 1);
+    EXPECT_FALSE(IsAccessGranted(
+              CheckPermission(&g_peContext, &subject, "/a/timed", PERMISSION_READ)));
+
+    g_peUtNow = PEUtLocalTime(9, 59, 59);
+    EXPECT_FALSE(IsAccessGranted(
+              CheckPermission(&g_peContext, &subject, "/a/timed", PERMISSION_READ)));
+
+    SetPolicyEngineTimeSource(NULL);
+    DeInitACLResource();
+}
+
 TEST(PolicyEngineCore, DeInitPolicyEngine)
 {
     DeInitPolicyEngine(&g_peContext);
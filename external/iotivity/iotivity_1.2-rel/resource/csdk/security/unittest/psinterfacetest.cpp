@@ -0,0 +1,423 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "cbor.h"
+#include "ocstack.h"
+#include "cainterface.h"
+#include "oic_malloc.h"
+#include "psinterface.h"
+#include "secureresourcemanager.h"
+#include "srmresourcestrings.h"
+#include "srmtestcommon.h"
+
+#define TAG "SRM-PSI-UT"
+
+// files of the test storage are kept apart from the SVR database of the other tests
+#define PSI_TEST_FILE_PREFIX "psitest_"
+
+#define PSI_TEST_ALT_FILE_NAME "oic_svr_db_alt.dat"
+
+#define PSI_HEADER_SIZE 14
+
+static FILE *g_psiTornFile = NULL;
+static bool g_psiTearRewrites = false;
+static std::vector<std::string> g_psiOpened;
+
+static std::string GetTestFileName(const char *path)
+{
+    return std::string(PSI_TEST_FILE_PREFIX) + path;
+}
+
+static FILE *PsiOpen(const char *path, const char *mode)
+{
+    g_psiOpened.push_back(path);
+    FILE *fp = fopen(GetTestFileName(path).c_str(), mode);
+    // a rewrite stopping halfway, as on a power loss
+    if (fp && g_psiTearRewrites && 'w' == mode[0])
+    {
+        g_psiTornFile = fp;
+    }
+    return fp;
+}
+
+static size_t PsiWrite(const void *ptr, size_t size, size_t nmemb, FILE *stream)
+{
+    if (stream == g_psiTornFile)
+    {
+        return fwrite(ptr, size, nmemb / 2, stream);
+    }
+    return fwrite(ptr, size, nmemb, stream);
+}
+
+static int PsiClose(FILE *fp)
+{
+    if (fp == g_psiTornFile)
+    {
+        g_psiTornFile = NULL;
+    }
+    return fclose(fp);
+}
+
+static int PsiUnlink(const char *path)
+{
+    return unlink(GetTestFileName(path).c_str());
+}
+
+static OCPersistentStorage g_psiStorage = { PsiOpen, fread, PsiWrite, PsiClose, PsiUnlink,
+                                            NULL, NULL, PSI_TEST_ALT_FILE_NAME };
+
+// a storage without an alternate file, whose open may map every path to one file
+static OCPersistentStorage g_psiSingleStorage = { PsiOpen, fread, PsiWrite, PsiClose, PsiUnlink };
+
+static std::vector<uint8_t> ReadTestFile(const char *path)
+{
+    std::vector<uint8_t> content;
+    FILE *fp = fopen(GetTestFileName(path).c_str(), "rb");
+    if (fp)
+    {
+        uint8_t buf[256];
+        size_t len = 0;
+        while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        {
+            content.insert(content.end(), buf, buf + len);
+        }
+        fclose(fp);
+    }
+    return content;
+}
+
+static void WriteTestFile(const char *path, const std::vector<uint8_t> &content)
+{
+    FILE *fp = fopen(GetTestFileName(path).c_str(), "wb");
+    ASSERT_TRUE(NULL != fp);
+    EXPECT_EQ(content.size(), fwrite(content.data(), 1, content.size(), fp));
+    fclose(fp);
+}
+
+static uint32_t GetUint32At(const std::vector<uint8_t> &content, size_t pos)
+{
+    return ((uint32_t)content[pos] << 24) | ((uint32_t)content[pos + 1] << 16)
+           | ((uint32_t)content[pos + 2] << 8) | content[pos + 3];
+}
+
+static uint32_t GetGeneration(const std::vector<uint8_t> &content)
+{
+    return GetUint32At(content, 6);
+}
+
+static uint32_t GetBaseSize(const std::vector<uint8_t> &content)
+{
+    return GetUint32At(content, 10);
+}
+
+static bool IsRecordFormat(const std::vector<uint8_t> &content)
+{
+    static const uint8_t magic[] = { 'O', 'I', 'C', 'P', 'S', 0x01 };
+    return content.size() >= PSI_HEADER_SIZE
+           && 0 == memcmp(content.data(), magic, sizeof(magic));
+}
+
+static std::string GetResource(const char *name)
+{
+    uint8_t *data = NULL;
+    size_t size = 0;
+    std::string value;
+    if (OC_STACK_OK == GetSecureVirtualDatabaseFromPS(name, &data, &size))
+    {
+        value.assign((const char *)data, size);
+    }
+    OICFree(data);
+    return value;
+}
+
+static OCStackResult SetResource(const char *name, const std::string &value)
+{
+    return UpdateSecureResourceInPS(name, (const uint8_t *)value.data(), value.size());
+}
+
+class PSInterfaceTest : public testing::Test
+{
+    protected:
+        virtual void SetUp()
+        {
+            RemoveTestFiles();
+
+            // a database in the former format, a CBOR map of the resources
+            uint8_t *doxm = NULL;
+            uint8_t *pstat = NULL;
+            size_t doxmSize = 0;
+            size_t pstatSize = 0;
+            ASSERT_TRUE(ReadCBORFile("oic_unittest.dat", OIC_JSON_DOXM_NAME, &doxm, &doxmSize));
+            ASSERT_TRUE(ReadCBORFile("oic_unittest.dat", OIC_JSON_PSTAT_NAME, &pstat, &pstatSize));
+            m_doxm.assign((const char *)doxm, doxmSize);
+            m_pstat.assign((const char *)pstat, pstatSize);
+            OICFree(doxm);
+            OICFree(pstat);
+
+            std::vector<uint8_t> legacy(m_doxm.size() + m_pstat.size() + 64);
+            CborEncoder encoder;
+            CborEncoder map;
+            cbor_encoder_init(&encoder, legacy.data(), legacy.size(), 0);
+            ASSERT_EQ(CborNoError, cbor_encoder_create_map(&encoder, &map, 2));
+            ASSERT_EQ(CborNoError, cbor_encode_text_string(&map, OIC_JSON_DOXM_NAME,
+                                                           strlen(OIC_JSON_DOXM_NAME)));
+            ASSERT_EQ(CborNoError, cbor_encode_byte_string(&map, (const uint8_t *)m_doxm.data(),
+                                                           m_doxm.size()));
+            ASSERT_EQ(CborNoError, cbor_encode_text_string(&map, OIC_JSON_PSTAT_NAME,
+                                                           strlen(OIC_JSON_PSTAT_NAME)));
+            ASSERT_EQ(CborNoError, cbor_encode_byte_string(&map, (const uint8_t *)m_pstat.data(),
+                                                           m_pstat.size()));
+            ASSERT_EQ(CborNoError, cbor_encoder_close_container(&encoder, &map));
+            legacy.resize(cbor_encoder_get_buffer_size(&encoder, legacy.data()));
+            WriteTestFile(SVR_DB_DAT_FILE_NAME, legacy);
+
+            ASSERT_EQ(OC_STACK_OK, InitPersistentStorageInterface());
+            ASSERT_EQ(OC_STACK_OK, SRMRegisterPersistentStorageHandler(&g_psiStorage));
+        }
+
+        virtual void TearDown()
+        {
+            g_psiTearRewrites = false;
+            g_psiOpened.clear();
+            DeinitPersistentStorageInterface();
+            RemoveTestFiles();
+        }
+
+        // drop the records read by the interface, as on a restart
+        void Reload()
+        {
+            DeinitPersistentStorageInterface();
+            ASSERT_EQ(OC_STACK_OK, InitPersistentStorageInterface());
+        }
+
+        static void RemoveTestFiles()
+        {
+            PsiUnlink(SVR_DB_DAT_FILE_NAME);
+            PsiUnlink(PSI_TEST_ALT_FILE_NAME);
+        }
+
+        std::string m_doxm;
+        std::string m_pstat;
+};
+
+TEST_F(PSInterfaceTest, ReadsLegacyDatabase)
+{
+    EXPECT_EQ(m_doxm, GetResource(OIC_JSON_DOXM_NAME));
+    EXPECT_EQ(m_pstat, GetResource(OIC_JSON_PSTAT_NAME));
+    EXPECT_EQ("", GetResource("test"));
+
+    // reading does not rewrite the database
+    EXPECT_FALSE(IsRecordFormat(ReadTestFile(SVR_DB_DAT_FILE_NAME)));
+    EXPECT_TRUE(ReadTestFile(PSI_TEST_ALT_FILE_NAME).empty());
+}
+
+TEST_F(PSInterfaceTest, MigratesLegacyDatabaseOnUpdate)
+{
+    ASSERT_EQ(OC_STACK_OK, SetResource("test", "abc"));
+
+    // the other file first, so the former database is replaced only once it is written
+    std::vector<uint8_t> alt = ReadTestFile(PSI_TEST_ALT_FILE_NAME);
+    ASSERT_TRUE(IsRecordFormat(alt));
+    EXPECT_EQ(1u, GetGeneration(alt));
+    EXPECT_EQ(alt.size(), GetBaseSize(alt));
+
+    std::vector<uint8_t> db = ReadTestFile(SVR_DB_DAT_FILE_NAME);
+    ASSERT_TRUE(IsRecordFormat(db));
+    EXPECT_EQ(2u, GetGeneration(db));
+    EXPECT_EQ(db.size(), GetBaseSize(db));
+
+    Reload();
+    EXPECT_EQ(m_doxm, GetResource(OIC_JSON_DOXM_NAME));
+    EXPECT_EQ(m_pstat, GetResource(OIC_JSON_PSTAT_NAME));
+    EXPECT_EQ("abc", GetResource("test"));
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_EQ(OC_STACK_OK, GetSecureVirtualDatabaseFromPS2(&g_psiStorage, "test", &data, &size));
+    EXPECT_EQ(std::string("abc"), std::string((const char *)data, size));
+    OICFree(data);
+}
+
+TEST_F(PSInterfaceTest, AppendsRecordOnUpdate)
+{
+    ASSERT_EQ(OC_STACK_OK, SetResource("test", "abc"));
+    std::vector<uint8_t> base = ReadTestFile(SVR_DB_DAT_FILE_NAME);
+
+    ASSERT_EQ(OC_STACK_OK, SetResource("test", "defg"));
+    std::vector<uint8_t> db = ReadTestFile(SVR_DB_DAT_FILE_NAME);
+    ASSERT_TRUE(IsRecordFormat(db));
+    EXPECT_EQ(2u, GetGeneration(db));
+    EXPECT_EQ(base.size(), GetBaseSize(db));
+
+    // name length, name, payload length, payload and checksum of the record
+    const uint8_t expected[] = { 4, 't', 'e', 's', 't', 0, 0, 0, 4, 'd', 'e', 'f', 'g' };
+    ASSERT_EQ(base.size() + sizeof(expected) + 4, db.size());
+    EXPECT_EQ(0, memcmp(db.data(), base.data(), base.size()));
+    EXPECT_EQ(0, memcmp(db.data() + base.size(), expected, sizeof(expected)));
+
+    uint32_t checksum = 2166136261u;
+    for (size_t i = 0; i < sizeof(expected); i++)
+    {
+        checksum = (checksum ^ expected[i]) * 16777619u;
+    }
+    EXPECT_EQ(checksum, GetUint32At(db, base.size() + sizeof(expected)));
+
+    // an empty payload deletes the resource, with a record of no payload
+    ASSERT_EQ(OC_STACK_OK, UpdateSecureResourceInPS("test", NULL, 0));
+    EXPECT_EQ(db.size() + 1 + 4 + 4 + 4, ReadTestFile(SVR_DB_DAT_FILE_NAME).size());
+
+    Reload();
+    EXPECT_EQ("", GetResource("test"));
+    EXPECT_EQ(m_doxm, GetResource(OIC_JSON_DOXM_NAME));
+}
+
+TEST_F(PSInterfaceTest, DropsTornRecord)
+{
+    ASSERT_EQ(OC_STACK_OK, SetResource("test", "abc"));
+    ASSERT_EQ(OC_STACK_OK, SetResource("test", "defg"));
+
+    // the last append stopped before its checksum
+    std::vector<uint8_t> db = ReadTestFile(SVR_DB_DAT_FILE_NAME);
+    db.resize(db.size() - 2);
+    WriteTestFile(SVR_DB_DAT_FILE_NAME, db);
+
+    Reload();
+    EXPECT_EQ("abc", GetResource("test"));
+    EXPECT_EQ(m_doxm, GetResource(OIC_JSON_DOXM_NAME));
+
+    // the next update is not appended after the torn record
+    ASSERT_EQ(OC_STACK_OK, SetResource("other", "x"));
+    std::vector<uint8_t> alt = ReadTestFile(PSI_TEST_ALT_FILE_NAME);
+    ASSERT_TRUE(IsRecordFormat(alt));
+    EXPECT_EQ(3u, GetGeneration(alt));
+    EXPECT_EQ(alt.size(), GetBaseSize(alt));
+
+    Reload();
+    EXPECT_EQ("abc", GetResource("test"));
+    EXPECT_EQ("x", GetResource("other"));
+}
+
+TEST_F(PSInterfaceTest, CompactsIntoOtherFile)
+{
+    ASSERT_EQ(OC_STACK_OK, SetResource("test", "abc"));
+
+    // replaced records grow the file until it is rewritten
+    std::string value;
+    for (char fill = 'a'; fill <= 'z'; fill++)
+    {
+        value.assign(2048, fill);
+        ASSERT_EQ(OC_STACK_OK, SetResource("blob", value));
+        if (!ReadTestFile(PSI_TEST_ALT_FILE_NAME).empty()
+            && 3u == GetGeneration(ReadTestFile(PSI_TEST_ALT_FILE_NAME)))
+        {
+            break;
+        }
+    }
+
+    std::vector<uint8_t> alt = ReadTestFile(PSI_TEST_ALT_FILE_NAME);
+    ASSERT_EQ(3u, GetGeneration(alt));
+    EXPECT_EQ(alt.size(), GetBaseSize(alt));
+    EXPECT_GT(ReadTestFile(SVR_DB_DAT_FILE_NAME).size(), alt.size());
+
+    Reload();
+    EXPECT_EQ(value, GetResource("blob"));
+    EXPECT_EQ("abc", GetResource("test"));
+    EXPECT_EQ(m_pstat, GetResource(OIC_JSON_PSTAT_NAME));
+}
+
+TEST_F(PSInterfaceTest, KeepsDatabaseWhenCompactionIsTorn)
+{
+    ASSERT_EQ(OC_STACK_OK, SetResource("test", "abc"));
+
+    // the rewrite of the grown file is torn
+    g_psiTearRewrites = true;
+    std::string stored;
+    std::string value;
+    OCStackResult ret = OC_STACK_OK;
+    for (char fill = 'a'; fill <= 'z' && OC_STACK_OK == ret; fill++)
+    {
+        value.assign(2048, fill);
+        ret = SetResource("blob", value);
+        if (OC_STACK_OK == ret)
+        {
+            stored = value;
+        }
+    }
+    ASSERT_NE(OC_STACK_OK, ret);
+    ASSERT_FALSE(stored.empty());
+
+    std::vector<uint8_t> alt = ReadTestFile(PSI_TEST_ALT_FILE_NAME);
+    ASSERT_TRUE(IsRecordFormat(alt));
+    EXPECT_LT(alt.size(), GetBaseSize(alt));
+
+    Reload();
+    EXPECT_EQ(stored, GetResource("blob"));
+    EXPECT_EQ("abc", GetResource("test"));
+    EXPECT_EQ(m_doxm, GetResource(OIC_JSON_DOXM_NAME));
+
+    // the next rewrite replaces the torn file
+    g_psiTearRewrites = false;
+    value.assign(16, '0');
+    ASSERT_EQ(OC_STACK_OK, SetResource("blob", value));
+    alt = ReadTestFile(PSI_TEST_ALT_FILE_NAME);
+    EXPECT_EQ(alt.size(), GetBaseSize(alt));
+    EXPECT_LT(2u, GetGeneration(alt));
+
+    Reload();
+    EXPECT_EQ(value, GetResource("blob"));
+    EXPECT_EQ("abc", GetResource("test"));
+}
+
+TEST_F(PSInterfaceTest, RewritesInPlaceWithoutAlternateFile)
+{
+    g_psiOpened.clear();
+    ASSERT_EQ(OC_STACK_OK, SRMRegisterPersistentStorageHandler(&g_psiSingleStorage));
+    ASSERT_EQ(OC_STACK_OK, SetResource("test", "abc"));
+
+    // the former database is migrated over itself
+    std::vector<uint8_t> db = ReadTestFile(SVR_DB_DAT_FILE_NAME);
+    ASSERT_TRUE(IsRecordFormat(db));
+    EXPECT_EQ(1u, GetGeneration(db));
+    EXPECT_EQ(db.size(), GetBaseSize(db));
+
+    std::string value;
+    for (char fill = 'a'; fill <= 'z'; fill++)
+    {
+        value.assign(2048, fill);
+        ASSERT_EQ(OC_STACK_OK, SetResource("blob", value));
+    }
+    EXPECT_LT(1u, GetGeneration(ReadTestFile(SVR_DB_DAT_FILE_NAME)));
+
+    Reload();
+    EXPECT_EQ(value, GetResource("blob"));
+    EXPECT_EQ("abc", GetResource("test"));
+    EXPECT_EQ(m_doxm, GetResource(OIC_JSON_DOXM_NAME));
+
+    for (size_t i = 0; i < g_psiOpened.size(); i++)
+    {
+        EXPECT_EQ(SVR_DB_DAT_FILE_NAME, g_psiOpened[i]);
+    }
+    EXPECT_TRUE(ReadTestFile(PSI_TEST_ALT_FILE_NAME).empty());
+}
@@ -111,8 +111,14 @@ typedef struct ClientCB {
      * can be explicitly cancelled.*/
     uint32_t TTL;
 
+    /** Position in the heap of the callbacks with a TTL.*/
+    size_t timeoutIndex;
+
     /** next node in this list.*/
     struct ClientCB    *next;
+
+    /** previous node in this list.*/
+    struct ClientCB    *prev;
 } ClientCB;
 
 /**
@@ -165,6 +171,7 @@ void DeleteClientCB(ClientCB *cbNode);
  * @param[in] requestUri   Uri to search for.
  *
  * @brief You can search by token OR by handle, but not both.
+ * The callbacks past their TTL are deleted first.
  *
  * @return address of the node if found, otherwise NULL
  */
@@ -187,6 +194,15 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
 OCStackResult InsertResourceTypeFilter(ClientCB * cbNode, char * resourceTypeName);
 #endif // WITH_PRESENCE
 
+/** @ingroup ocstack
+ *
+ * This method is used to change the time to live of a cb node.
+ *
+ * @param[in] cbNode    Address to client callback node.
+ * @param[in] ttl       time to live in coap_ticks, 0 to keep the callback.
+ */
+void SetClientCBTTL(ClientCB *cbNode, uint32_t ttl);
+
 /** @ingroup ocstack
  *
  * This method is used to clear the cbList.
@@ -0,0 +1,117 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+/**
+ * @file
+ *
+ * This file contains a hash map from short keys (tokens, request handles,
+ * observation ids) to the stack's nodes, so that an incoming message finds
+ * its server request, client callback or observer without scanning a list.
+ *
+ * The map uses open addressing and copies the keys, so nothing is owned by
+ * it. A key can map to several values: lookups return them in the order they
+ * were added, like the scans of the lists did.
+ */
+
+#ifndef OC_KEY_MAP_H_
+#define OC_KEY_MAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "octypes.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Longest key of a map, the size of a CoAP token or of a pointer. */
+#define OC_KEY_MAP_MAX_KEY_LENGTH (8)
+
+/**
+ * Slot of a map, empty when value is NULL.
+ */
+typedef struct
+{
+    void *value;
+    uint8_t keyLength;
+    uint8_t key[OC_KEY_MAP_MAX_KEY_LENGTH];
+} OCKeyMapSlot;
+
+/**
+ * Map, zero initialized when empty.
+ */
+typedef struct
+{
+    OCKeyMapSlot *slots;
+    size_t size;
+    size_t count;
+} OCKeyMap;
+
+/**
+ * Add a value to a map.
+ *
+ * @param map          Map.
+ * @param key          Key of the value.
+ * @param keyLength    Length of the key, at most ::OC_KEY_MAP_MAX_KEY_LENGTH.
+ * @param value        Value, not NULL.
+ *
+ * @return ::OC_STACK_OK, ::OC_STACK_INVALID_PARAM or ::OC_STACK_NO_MEMORY.
+ */
+OCStackResult OCKeyMapAdd(OCKeyMap *map, const void *key, uint8_t keyLength, void *value);
+
+/**
+ * Find the first value added with a key.
+ *
+ * @param map          Map.
+ * @param key          Key of the value.
+ * @param keyLength    Length of the key.
+ *
+ * @return the value, or NULL if no value has this key.
+ */
+void *OCKeyMapFind(const OCKeyMap *map, const void *key, uint8_t keyLength);
+
+/**
+ * Remove a value added with a key.
+ *
+ * @param map          Map.
+ * @param key          Key of the value.
+ * @param keyLength    Length of the key.
+ * @param value        Value to remove.
+ *
+ * @return true if the value was in the map.
+ */
+bool OCKeyMapRemove(OCKeyMap *map, const void *key, uint8_t keyLength, const void *value);
+
+/**
+ * Remove all values and release the memory of a map.
+ *
+ * @param map          Map.
+ */
+void OCKeyMapClear(OCKeyMap *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OC_KEY_MAP_H_
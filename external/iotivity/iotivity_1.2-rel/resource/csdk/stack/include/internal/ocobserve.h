@@ -91,6 +91,12 @@ typedef struct ResourceObserver
     /** next node in this list.*/
     struct ResourceObserver *next;
 
+    /** previous node in this list.*/
+    struct ResourceObserver *prev;
+
+    /** next observer of the same resource.*/
+    struct ResourceObserver *resourceNext;
+
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
@@ -99,6 +105,8 @@ typedef struct ResourceObserver
 #ifdef WITH_PRESENCE
 /**
  * Create an observe response and send to all observers in the observe list.
+ * The entity handler is called once per query and accept format of the
+ * observers and the encoded response is sent to all the observers having them.
  *
  * @param method          RESTful method.
  * @param resPtr          Observed resource.
@@ -113,6 +121,8 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
 #else
 /**
  * Create an observe response and send to all observers in the observe list.
+ * The entity handler is called once per query and accept format of the
+ * observers and the encoded response is sent to all the observers having them.
  *
  * @param method RESTful method.
  * @param resPtr Observed resource.
@@ -201,6 +211,13 @@ OCStackResult AddObserver (const char         *resUri,
   */
 OCStackResult DeleteObserverUsingDevAddr(const OCDevAddr *devAddr);
 
+/**
+ * Delete all observers of a resource, when the resource is deleted.
+ *
+ * @param resource Observed resource.
+ */
+void DeleteObserversUsingResource(OCResource *resource);
+
 /**
  * Search the list of observers for the specified token.
  *
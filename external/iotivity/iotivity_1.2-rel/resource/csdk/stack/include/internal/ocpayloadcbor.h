@@ -33,6 +33,54 @@ OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType type,
 
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size);
 
+/**
+ * Parse a payload like OCParsePayload, but build a representation in a single
+ * arena sized from the CBOR, with its strings pointing into the arena.
+ * OCPayloadDestroy frees the arena at once. Other payload types are parsed
+ * like OCParsePayload does.
+ *
+ * The representation can still be changed with the OCRepPayload functions,
+ * the memory they allocate is freed with it, but memory it points to must not
+ * be freed or taken over by the caller.
+ *
+ * @param outPayload    Set to the parsed payload.
+ * @param type          Type of the payload.
+ * @param payload       CBOR to parse.
+ * @param payloadSize   Size of the CBOR.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCParsePayloadInArena(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize);
+
+/** Arena holding a parsed representation, see OCParsePayloadInArena. */
+typedef struct OCPayloadArena OCPayloadArena;
+
+/** Size of an allocation from an arena, rounded up to keep 64-bit values aligned. */
+#define OC_PAYLOAD_ARENA_SIZE(size) ((((size) != 0 ? (size) : 1) + 7) & ~(size_t)7)
+
+/**
+ * Create a representation at the start of a new arena, destroying it frees the arena.
+ *
+ * @param size  Size of the arena beyond the representation, the sum of the
+ *              OC_PAYLOAD_ARENA_SIZE of the allocations it will hold.
+ *
+ * @return the representation, its arena member points to the arena.
+ */
+OCRepPayload* OCRepPayloadCreateWithArena(size_t size);
+
+/**
+ * Allocate zeroed memory from an arena.
+ *
+ * @return the memory, NULL if the arena is exhausted.
+ */
+void* OCPayloadArenaAlloc(OCPayloadArena* arena, size_t size);
+
+/**
+ * Create a representation in an arena, freed with the arena.
+ */
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena);
+
 #ifdef __cplusplus
 }
 #endif
@@ -186,6 +186,12 @@ typedef struct OCResource {
     /** Points to next resource in list.*/
     struct OCResource *next;
 
+    /** Points to next resource in the same bucket of the URI index.*/
+    struct OCResource *uriNext;
+
+    /** Points to next resource in the same bucket of the handle index.*/
+    struct OCResource *handleNext;
+
     /** Relative path on the device; will be combined with base url to create fully qualified path.*/
     char *uri;
 
@@ -225,6 +231,9 @@ typedef struct OCResource {
     /** Sequence number for observable resources. Per the CoAP standard it is a 24 bit value.*/
     uint32_t sequenceNum;
 
+    /** Observers of this resource; linked list through ResourceObserver::resourceNext.*/
+    struct ResourceObserver *observersHead;
+
     /** Pointer of ActionSet which to support group action.*/
     OCActionSet *actionsetHead;
 
@@ -0,0 +1,134 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the indexes of the resource list: resources by URI and
+ * by handle, for the request dispatch and the handle checks, and resources by
+ * resource type and by interface, for the filtered discovery.
+ *
+ * The indexes are maintained by the resource list of ocstack.c: a resource
+ * is added when it is created, its types and interfaces when they are bound,
+ * and it is removed from all of them when it is deleted.
+ */
+
+#ifndef OC_RESOURCE_INDEX_H_
+#define OC_RESOURCE_INDEX_H_
+
+#include "ocresource.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Add a resource to the URI and handle indexes. The URI of the resource must
+ * be set and must not change while the resource is indexed. If the indexes
+ * cannot be allocated, they are dropped until OCResourceIndexTerminate(), see
+ * OCResourceIndexUsable().
+ *
+ * @param resource     Resource to add.
+ */
+void OCResourceIndexAdd(OCResource *resource);
+
+/**
+ * Check that the URI and handle indexes hold every resource.
+ *
+ * @return false if an allocation of the indexes failed: OCResourceIndexFindUri()
+ *         and OCResourceIndexContains() cannot be used and the resource list
+ *         must be scanned instead.
+ */
+bool OCResourceIndexUsable();
+
+/**
+ * Remove a resource from all the indexes. Nothing is done for the indexes
+ * the resource is not in.
+ *
+ * @param resource     Resource to remove.
+ */
+void OCResourceIndexRemove(OCResource *resource);
+
+/**
+ * Find a resource by URI.
+ *
+ * @param uri          URI of the resource.
+ *
+ * @return the resource, or NULL if no resource has this URI.
+ */
+OCResource *OCResourceIndexFindUri(const char *uri);
+
+/**
+ * Check that a handle is one of an existing resource. The handle is not
+ * dereferenced, so it can be a stale one.
+ *
+ * @param resource     Handle of the resource.
+ *
+ * @return true if the resource exists.
+ */
+bool OCResourceIndexContains(const OCResource *resource);
+
+/**
+ * Record that a resource type was bound to a resource.
+ *
+ * @param resource     Resource.
+ * @param name         Name of the resource type.
+ */
+void OCResourceIndexAddType(OCResource *resource, const char *name);
+
+/**
+ * Record that an interface was bound to a resource.
+ *
+ * @param resource     Resource.
+ * @param name         Name of the interface.
+ */
+void OCResourceIndexAddInterface(OCResource *resource, const char *name);
+
+/**
+ * Get the resources of a resource type, in the order the type was bound.
+ *
+ * @param name         Name of the resource type.
+ * @param resources    Set to the resources, valid until the next change of the
+ *                     resource list.
+ * @param count        Set to the number of resources.
+ *
+ * @return false if the index is not usable (an allocation failed) and the
+ *         resource list must be scanned instead.
+ */
+bool OCResourceIndexFindType(const char *name, OCResource * const **resources, size_t *count);
+
+/**
+ * Get the resources of an interface, in the order the interface was bound.
+ * See OCResourceIndexFindType().
+ */
+bool OCResourceIndexFindInterface(const char *name, OCResource * const **resources,
+                                  size_t *count);
+
+/**
+ * Release all the indexes. Called once all the resources are deleted.
+ */
+void OCResourceIndexTerminate();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OC_RESOURCE_INDEX_H_
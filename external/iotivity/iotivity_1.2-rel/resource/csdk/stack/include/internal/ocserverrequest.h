@@ -37,6 +37,25 @@
  */
 typedef OCStackResult (* OCEHResponseHandler)(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Observer that gets a copy of the notification sent for another observer of the
+ * same resource, with the same query and accept format.
+ */
+typedef struct OCObserveTarget
+{
+    /** Remote endpoint address.*/
+    OCDevAddr devAddr;
+
+    /** Token of the observe request.*/
+    uint8_t token[CA_MAX_TOKEN_LEN];
+
+    /** token length of the observe request.*/
+    uint8_t tokenLength;
+
+    /** qos of the notification sent to this observer.*/
+    OCQualityOfService qos;
+} OCObserveTarget;
+
 /**
  * following structure will be created in occoap and passed up the stack on the server side.
  */
@@ -99,12 +118,21 @@ typedef struct OCServerRequest
     /** Linked list; for multiple server request.*/
     struct OCServerRequest * next;
 
+    /** Previous server request of the list.*/
+    struct OCServerRequest * prev;
+
     /** Flag indicating slow response.*/
     uint8_t slowFlag;
 
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
+    /** Other observers the notification is sent to, with the same encoded payload.*/
+    OCObserveTarget *observeTargets;
+
+    /** Number of observeTargets.*/
+    uint16_t numObserveTargets;
+
     /** Payload Size.*/
     size_t payloadSize;
 
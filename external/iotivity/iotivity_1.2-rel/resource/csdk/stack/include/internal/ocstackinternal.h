@@ -367,6 +367,20 @@ OCStackResult ParseRequestUri(const char *fullUri,
  */
 void FixUpClientResponse(OCClientResponse *cr);
 
+/**
+ * Parse a payload received in a request or a response, into an arena when
+ * enabled with OCSetPayloadArena.
+ *
+ * @param outPayload    Set to the parsed payload.
+ * @param type          Type of the payload.
+ * @param payload       CBOR to parse.
+ * @param payloadSize   Size of the CBOR.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCParseReceivedPayload(OCPayload **outPayload, OCPayloadType type,
+                                     const uint8_t *payload, size_t payloadSize);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
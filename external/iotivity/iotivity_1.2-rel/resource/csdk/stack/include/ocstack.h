@@ -127,6 +127,22 @@ OCStackResult OCStopMulticastServer();
  */
 OCStackResult OCProcess();
 
+/**
+ * This function blocks until incoming requests or responses are waiting for
+ * OCProcess(), or until the timeout expires. Use it instead of sleeping
+ * between OCProcess() calls, so that messages are handled as they arrive.
+ * It does not touch the stack state and may be called without the lock
+ * the application holds around OCProcess().
+ *
+ * @param timeout       Maximum time to wait in milliseconds, 0 to only check.
+ *                      OCProcess() should still be called at least every
+ *                      second or so for presence and keep-alive processing.
+ *
+ * @return ::OC_STACK_OK if there is work for OCProcess(), ::OC_STACK_TIMEOUT
+ *         on timeout, some other value upon failure.
+ */
+OCStackResult OCProcessWait(uint32_t timeout);
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -292,6 +308,36 @@ OCStackResult OCStopPresence();
  */
 OCStackResult OCSetDefaultDeviceEntityHandler(OCDeviceEntityHandler entityHandler, void* callbackParameter);
 
+/**
+ * This function sets whether the representations received in requests and
+ * responses are parsed into a single arena, freed at once, instead of one
+ * allocation per string and value.
+ *
+ * Entity handlers and response callbacks can still read them and change them
+ * with the OCRepPayload functions, but must not free or take over memory
+ * they point to.
+ *
+ * @param enabled            true to parse received representations into arenas.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCSetPayloadArena(bool enabled);
+
+#ifdef WITH_BWT
+/**
+ * This function sets the handler receiving the payload of incoming block-wise
+ * transfers as the blocks arrive, instead of reassembling it in memory first.
+ *
+ * @param streamHandler      Block stream handler. If NULL is passed the payload
+ *                           is reassembled again.
+ * @param callbackParameter  Parameter passed back when streamHandler is called.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCSetBlockStreamHandler(OCBlockStreamHandler streamHandler,
+                                      void *callbackParameter);
+#endif
+
 /**
  * This function sets device information.
  *
@@ -1130,6 +1130,14 @@ typedef struct {
     /**Persistent Storage Handler for Decryption.*/
     int (* decrypt)(const unsigned char *ct, size_t size,
             unsigned char**pt, size_t *pt_len);
+
+    /**
+     * Path passed to the open handler for a second SVR database file, which it must open
+     * as a file distinct from the database. When set, the database is rewritten into
+     * the other file, so a power loss while rewriting keeps the previous one.
+     * When NULL, the database is rewritten in place.
+     */
+    const char *alternatePath;
 } OCPersistentStorage;
 
 /**
@@ -1399,6 +1407,8 @@ typedef struct OCRepPayload
     OCStringLL* interfaces;
     OCRepPayloadValue* values;
     struct OCRepPayload* next;
+    /** Arena the payload was parsed into, NULL if it is allocated on the heap. */
+    struct OCPayloadArena* arena;
 } OCRepPayload;
 
 // used inside a discovery payload
@@ -1727,6 +1737,28 @@ typedef OCEntityHandlerResult (*OCEntityHandler)
 typedef OCEntityHandlerResult (*OCDeviceEntityHandler)
 (OCEntityHandlerFlag flag, OCEntityHandlerRequest * entityHandlerRequest, char* uri, void* callbackParam);
 
+#ifdef WITH_BWT
+/**
+ * Block stream handler. Receives the payload of incoming block-wise transfers
+ * block by block, in order, as the blocks arrive.
+ *
+ * @param devAddr          Address of the remote device.
+ * @param token            Token of the transfer.
+ * @param tokenLength      Length of the token.
+ * @param offset           Offset of the block in the payload.
+ * @param data             Payload of the block.
+ * @param dataLength       Length of the block.
+ * @param callbackParam    Parameter passed to OCSetBlockStreamHandler.
+ *
+ * @return true if the block was consumed. The request or response of the
+ *         transfer then comes without the consumed blocks in its payload.
+ */
+typedef bool (*OCBlockStreamHandler)(const OCDevAddr *devAddr, const uint8_t *token,
+                                     uint8_t tokenLength, size_t offset,
+                                     const uint8_t *data, size_t dataLength,
+                                     void *callbackParam);
+#endif
+
 //#ifdef DIRECT_PAIRING
 /**
  * Callback function definition of direct-pairing
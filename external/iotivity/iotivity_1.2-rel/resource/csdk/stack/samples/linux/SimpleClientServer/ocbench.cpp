@@ -0,0 +1,241 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// Request/response benchmark: discovers the /a/light resource of ocserver
+// (or any server hosting it) and sends GET requests to it, keeping up to
+// -w of them outstanding, from a loop that waits with OCProcessWait().
+// Reports the requests per second and the 50th/99th percentile latency.
+
+#include "iotivity_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <vector>
+#include <getopt.h>
+#include "ocstack.h"
+#include "logger.h"
+#include "ocpayload.h"
+
+#define TAG "ocbench"
+
+#define MAX_WINDOW          64
+#define DISCOVERY_TIMEOUT_MS 5000
+
+static const char *BENCH_RESOURCE = "/a/light";
+
+static OCDevAddr g_serverAddr;
+static OCConnectivityType g_connType = CT_ADAPTER_IP;
+static bool g_discovered = false;
+
+static int g_requests = 1000;
+static int g_window = 1;
+static int g_sent = 0;
+static int g_answered = 0;
+static int g_errors = 0;
+static std::vector<double> g_latency;
+
+static double nowMs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void printUsage()
+{
+    OIC_LOG(INFO, TAG, "Usage : ocbench -n <requests> -w <window>");
+    OIC_LOG(INFO, TAG, "-n : number of GET requests (default 1000)");
+    OIC_LOG_V(INFO, TAG, "-w : requests outstanding at a time (default 1, max %d)", MAX_WINDOW);
+}
+
+static bool sendGet();
+
+static OCStackApplicationResult getCB(void *ctx, OCDoHandle /*handle*/,
+                                      OCClientResponse *clientResponse)
+{
+    double *sentAt = (double *) ctx;
+
+    g_answered++;
+    if (clientResponse && clientResponse->result == OC_STACK_OK)
+    {
+        g_latency.push_back(nowMs() - *sentAt);
+    }
+    else
+    {
+        g_errors++;
+    }
+    delete sentAt;
+
+    // keep the window full
+    if (g_sent < g_requests)
+    {
+        sendGet();
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+static bool sendGet()
+{
+    OCCallbackData cbData;
+    double *sentAt = new double(nowMs());
+
+    cbData.cb = getCB;
+    cbData.context = sentAt;
+    cbData.cd = NULL;
+
+    g_sent++;
+    if (OCDoRequest(NULL, OC_REST_GET, BENCH_RESOURCE, &g_serverAddr, NULL,
+                    g_connType, OC_LOW_QOS, &cbData, NULL, 0) != OC_STACK_OK)
+    {
+        OIC_LOG(ERROR, TAG, "OCDoRequest failed");
+        delete sentAt;
+        g_answered++;
+        g_errors++;
+        return false;
+    }
+    return true;
+}
+
+static OCStackApplicationResult discoveryCB(void * /*ctx*/, OCDoHandle /*handle*/,
+                                            OCClientResponse *clientResponse)
+{
+    if (!clientResponse || g_discovered)
+    {
+        return OC_STACK_KEEP_TRANSACTION;
+    }
+
+    OCDiscoveryPayload *payload = (OCDiscoveryPayload *) clientResponse->payload;
+    for (OCResourcePayload *resource = payload ? payload->resources : NULL;
+         resource; resource = resource->next)
+    {
+        if (resource->uri && strcmp(resource->uri, BENCH_RESOURCE) == 0)
+        {
+            g_serverAddr = clientResponse->devAddr;
+            g_connType = clientResponse->connType;
+            g_discovered = true;
+            OIC_LOG_V(INFO, TAG, "%s found @ %s:%d", BENCH_RESOURCE,
+                      g_serverAddr.addr, g_serverAddr.port);
+            break;
+        }
+    }
+    return OC_STACK_KEEP_TRANSACTION;
+}
+
+// Process until done() or the deadline: handle messages as soon as they arrive
+template <typename Pred>
+static bool pump(Pred done, double deadline)
+{
+    while (!done())
+    {
+        if (OCProcess() != OC_STACK_OK)
+        {
+            OIC_LOG(ERROR, TAG, "OCStack process error");
+            return false;
+        }
+        if (nowMs() > deadline)
+        {
+            return false;
+        }
+        OCProcessWait(100);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:w:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                g_requests = atoi(optarg);
+                break;
+            case 'w':
+                g_window = atoi(optarg);
+                break;
+            default:
+                printUsage();
+                return -1;
+        }
+    }
+    if (g_requests < 1 || g_window < 1 || g_window > MAX_WINDOW)
+    {
+        printUsage();
+        return -1;
+    }
+
+    if (OCInit1(OC_CLIENT, OC_DEFAULT_FLAGS, OC_DEFAULT_FLAGS) != OC_STACK_OK)
+    {
+        OIC_LOG(ERROR, TAG, "OCStack init error");
+        return -1;
+    }
+
+    OCCallbackData cbData;
+    cbData.cb = discoveryCB;
+    cbData.context = NULL;
+    cbData.cd = NULL;
+    if (OCDoRequest(NULL, OC_REST_DISCOVER, "/oic/res", NULL, NULL, CT_ADAPTER_IP,
+                    OC_LOW_QOS, &cbData, NULL, 0) != OC_STACK_OK)
+    {
+        OIC_LOG(ERROR, TAG, "discovery request failed");
+        OCStop();
+        return -1;
+    }
+    if (!pump([] { return g_discovered; }, nowMs() + DISCOVERY_TIMEOUT_MS))
+    {
+        OIC_LOG_V(ERROR, TAG, "%s not discovered", BENCH_RESOURCE);
+        OCStop();
+        return -1;
+    }
+
+    g_latency.reserve(g_requests);
+    double start = nowMs();
+    for (int i = 0; i < g_window && g_sent < g_requests; i++)
+    {
+        sendGet();
+    }
+    pump([] { return g_answered >= g_requests; }, start + g_requests * 1000.0);
+    double elapsed = nowMs() - start;
+
+    printf("requests %d, window %d, errors %d, %.1f sec\n",
+           g_answered, g_window, g_errors, elapsed / 1000.0);
+    if (!g_latency.empty())
+    {
+        std::sort(g_latency.begin(), g_latency.end());
+        size_t count = g_latency.size();
+        printf("%.1f requests/sec\n", count * 1000.0 / elapsed);
+        printf("latency p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+               g_latency[count / 2], g_latency[(count * 99) / 100], g_latency[count - 1]);
+    }
+
+    if (OCStop() != OC_STACK_OK)
+    {
+        OIC_LOG(ERROR, TAG, "OCStack stop error");
+    }
+    return g_errors ? -1 : 0;
+}
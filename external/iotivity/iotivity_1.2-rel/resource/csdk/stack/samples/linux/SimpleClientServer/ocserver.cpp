@@ -1153,6 +1153,8 @@ int main(int argc, char* argv[])
             OIC_LOG(ERROR, TAG, "OCStack process error");
             return 0;
         }
+        // sleep until the next request arrives instead of spinning
+        OCProcessWait(100);
     }
 
     if (observeThreadStarted)
@@ -23,6 +23,7 @@
 #include "logger.h"
 #include "trace.h"
 #include "oic_malloc.h"
+#include "ockeymap.h"
 #include <string.h>
 
 #ifdef HAVE_SYS_TIME_H
@@ -41,6 +42,144 @@
 
 struct ClientCB *cbList = NULL;
 
+/** Callbacks by token, by handle and by address, for the lookups of cbList. */
+static OCKeyMap g_cbByToken;
+static OCKeyMap g_cbByHandle;
+static OCKeyMap g_cbByNode;
+
+/** Min-heap of the callbacks having a TTL, the earliest one first. */
+static ClientCB **g_timeoutHeap = NULL;
+static size_t g_timeoutCount = 0;
+static size_t g_timeoutCapacity = 0;
+
+static void TimeoutHeapSwap(size_t i, size_t j)
+{
+    ClientCB *tmp = g_timeoutHeap[i];
+    g_timeoutHeap[i] = g_timeoutHeap[j];
+    g_timeoutHeap[j] = tmp;
+    g_timeoutHeap[i]->timeoutIndex = i;
+    g_timeoutHeap[j]->timeoutIndex = j;
+}
+
+static void TimeoutHeapUp(size_t i)
+{
+    while (i > 0 && g_timeoutHeap[i]->TTL < g_timeoutHeap[(i - 1) / 2]->TTL)
+    {
+        TimeoutHeapSwap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void TimeoutHeapDown(size_t i)
+{
+    for (;;)
+    {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < g_timeoutCount && g_timeoutHeap[left]->TTL < g_timeoutHeap[smallest]->TTL)
+        {
+            smallest = left;
+        }
+        if (right < g_timeoutCount && g_timeoutHeap[right]->TTL < g_timeoutHeap[smallest]->TTL)
+        {
+            smallest = right;
+        }
+        if (smallest == i)
+        {
+            return;
+        }
+        TimeoutHeapSwap(i, smallest);
+        i = smallest;
+    }
+}
+
+static OCStackResult TimeoutHeapPush(ClientCB *cbNode)
+{
+    if (g_timeoutCount == g_timeoutCapacity)
+    {
+        size_t capacity = g_timeoutCapacity ? g_timeoutCapacity * 2 : 16;
+        ClientCB **heap = (ClientCB **) OICRealloc(g_timeoutHeap, capacity * sizeof(ClientCB *));
+        if (!heap)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+        g_timeoutHeap = heap;
+        g_timeoutCapacity = capacity;
+    }
+
+    cbNode->timeoutIndex = g_timeoutCount;
+    g_timeoutHeap[g_timeoutCount++] = cbNode;
+    TimeoutHeapUp(cbNode->timeoutIndex);
+    return OC_STACK_OK;
+}
+
+static void TimeoutHeapRemove(ClientCB *cbNode)
+{
+    size_t i = cbNode->timeoutIndex;
+
+    g_timeoutCount--;
+    if (i != g_timeoutCount)
+    {
+        TimeoutHeapSwap(i, g_timeoutCount);
+        TimeoutHeapUp(i);
+        TimeoutHeapDown(i);
+    }
+}
+
+static OCStackResult AddClientCBToIndexes(ClientCB *cbNode)
+{
+    OCStackResult result = OCKeyMapAdd(&g_cbByToken, cbNode->token, cbNode->tokenLength, cbNode);
+    if (OC_STACK_OK == result)
+    {
+        result = OCKeyMapAdd(&g_cbByHandle, &cbNode->handle, sizeof(cbNode->handle), cbNode);
+        if (OC_STACK_OK == result)
+        {
+            result = OCKeyMapAdd(&g_cbByNode, &cbNode, sizeof(cbNode), cbNode);
+            if (OC_STACK_OK == result)
+            {
+                result = cbNode->TTL ? TimeoutHeapPush(cbNode) : OC_STACK_OK;
+                if (OC_STACK_OK == result)
+                {
+                    return OC_STACK_OK;
+                }
+                OCKeyMapRemove(&g_cbByNode, &cbNode, sizeof(cbNode), cbNode);
+            }
+            OCKeyMapRemove(&g_cbByHandle, &cbNode->handle, sizeof(cbNode->handle), cbNode);
+        }
+        OCKeyMapRemove(&g_cbByToken, cbNode->token, cbNode->tokenLength, cbNode);
+    }
+    return result;
+}
+
+static void RemoveClientCBFromIndexes(ClientCB *cbNode)
+{
+    OCKeyMapRemove(&g_cbByToken, cbNode->token, cbNode->tokenLength, cbNode);
+    OCKeyMapRemove(&g_cbByHandle, &cbNode->handle, sizeof(cbNode->handle), cbNode);
+    OCKeyMapRemove(&g_cbByNode, &cbNode, sizeof(cbNode), cbNode);
+    if (cbNode->TTL)
+    {
+        TimeoutHeapRemove(cbNode);
+    }
+}
+
+/*
+ * Delete the callbacks past their time to live. Presence and observe
+ * callbacks have no TTL and are not in the heap.
+ */
+static void DeleteTimedOutCBs()
+{
+    coap_tick_t now;
+    coap_ticks(&now);
+
+    while (g_timeoutCount && g_timeoutHeap[0]->TTL < now)
+    {
+        OIC_LOG(INFO, TAG, "Deleting timed-out callback");
+        DeleteClientCB(g_timeoutHeap[0]);
+    }
+}
+
 OCStackResult
 AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
              CAToken_t token, uint8_t tokenLength,
@@ -105,9 +244,15 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
             }
             cbNode->requestUri = requestUri;    // I own it now
             cbNode->devAddr = devAddr;          // I own it now
+            if (OC_STACK_OK != AddClientCBToIndexes(cbNode))
+            {
+                OICFree(cbNode);
+                *clientCB = NULL;
+                goto exit;
+            }
             OIC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
             OIC_TRACE_MARK(%s:AddClientCB:uri:%s, TAG, requestUri);
-            LL_APPEND(cbList, cbNode);
+            DL_APPEND(cbList, cbNode);
             *clientCB = cbNode;
         }
     }
@@ -158,7 +303,8 @@ void DeleteClientCB(ClientCB * cbNode)
     OIC_TRACE_BEGIN(%s:DeleteClientCB, TAG);
     if (cbNode)
     {
-        LL_DELETE(cbList, cbNode);
+        DL_DELETE(cbList, cbNode);
+        RemoveClientCBFromIndexes(cbNode);
         OIC_LOG (INFO, TAG, "Deleting token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
         OIC_TRACE_BUFFER("OIC_RI_CLIENTCB:DeleteClientCB:token",
@@ -202,66 +348,23 @@ void DeleteClientCB(ClientCB * cbNode)
     OIC_TRACE_END();
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence or observe
- * callback with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckAndDeleteTimedOutCB(ClientCB* cbNode)
-{
-    if (!cbNode)
-    {
-        return;
-    }
-    if (cbNode->TTL == 0)
-    {
-        return;
-    }
-    coap_tick_t now;
-    coap_ticks(&now);
-
-    if (cbNode->TTL < now)
-    {
-        OIC_LOG(INFO, TAG, "Deleting timed-out callback");
-        DeleteClientCB(cbNode);
-    }
-}
-
 ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
                       OCDoHandle handle, const char * requestUri)
 {
     ClientCB* out = NULL;
 
+    DeleteTimedOutCBs();
+
     if (token && tokenLength <= CA_MAX_TOKEN_LEN && tokenLength > 0)
     {
-        OIC_LOG (INFO, TAG,  "Looking for token");
-        OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        LL_FOREACH(cbList, out)
-        {
-            /* de-annotate below line if want to see all token in cbList */
-            //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if (memcmp(out->token, token, tokenLength) == 0)
-            {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        OIC_LOG (DEBUG, TAG,  "Looking for token");
+        OIC_LOG_BUFFER(DEBUG, TAG, (const uint8_t *)token, tokenLength);
+        out = (ClientCB *) OCKeyMapFind(&g_cbByToken, token, tokenLength);
     }
     else if (handle)
     {
-        OIC_LOG (INFO, TAG,  "Looking for handle");
-        LL_FOREACH(cbList, out)
-        {
-            if (out->handle == handle)
-            {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        OIC_LOG (DEBUG, TAG,  "Looking for handle");
+        out = (ClientCB *) OCKeyMapFind(&g_cbByHandle, &handle, sizeof(handle));
     }
     else if (requestUri)
     {
@@ -272,12 +375,16 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
             //OIC_LOG_V(INFO, TAG, "%s", out->requestUri);
             if (out->requestUri && strcmp(out->requestUri, requestUri ) == 0)
             {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
+                break;
             }
-            CheckAndDeleteTimedOutCB(out);
         }
     }
+
+    if (out)
+    {
+        OIC_LOG(DEBUG, TAG, "Found in callback list");
+        return out;
+    }
     OIC_LOG(INFO, TAG, "Callback Not found !!");
     return NULL;
 }
@@ -305,6 +412,34 @@ OCStackResult InsertResourceTypeFilter(ClientCB * cbNode, char * resourceTypeNam
 }
 #endif // WITH_PRESENCE
 
+void SetClientCBTTL(ClientCB *cbNode, uint32_t ttl)
+{
+    if (!cbNode)
+    {
+        return;
+    }
+
+    if (cbNode->TTL && ttl)
+    {
+        cbNode->TTL = ttl;
+        TimeoutHeapUp(cbNode->timeoutIndex);
+        TimeoutHeapDown(cbNode->timeoutIndex);
+        return;
+    }
+
+    if (cbNode->TTL)
+    {
+        TimeoutHeapRemove(cbNode);
+    }
+    cbNode->TTL = ttl;
+    if (ttl && OC_STACK_OK != TimeoutHeapPush(cbNode))
+    {
+        // without a place in the heap, the callback is kept until it is cancelled
+        OIC_LOG(ERROR, TAG, "Failed to set the TTL of the callback");
+        cbNode->TTL = 0;
+    }
+}
+
 void DeleteClientCBList()
 {
     ClientCB* out;
@@ -314,20 +449,21 @@ void DeleteClientCBList()
         DeleteClientCB(out);
     }
     cbList = NULL;
+
+    OCKeyMapClear(&g_cbByToken);
+    OCKeyMapClear(&g_cbByHandle);
+    OCKeyMapClear(&g_cbByNode);
+    OICFree(g_timeoutHeap);
+    g_timeoutHeap = NULL;
+    g_timeoutCount = 0;
+    g_timeoutCapacity = 0;
 }
 
 void FindAndDeleteClientCB(ClientCB * cbNode)
 {
-    ClientCB* tmp;
-    if (cbNode)
+    // the node can be a stale one, only its address is compared
+    if (cbNode && OCKeyMapFind(&g_cbByNode, &cbNode, sizeof(cbNode)))
     {
-        LL_FOREACH(cbList, tmp)
-        {
-            if (cbNode == tmp)
-            {
-                DeleteClientCB(tmp);
-                break;
-            }
-        }
+        DeleteClientCB(cbNode);
     }
 }
@@ -0,0 +1,199 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+
+#include "iotivity_config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ockeymap.h"
+#include "oic_malloc.h"
+#include "logger.h"
+
+#define TAG "OIC_RI_KEY_MAP"
+
+/** Initial number of slots, a power of 2. */
+#define KEY_MAP_MIN_SIZE   (16)
+
+static size_t hashKey(const uint8_t *key, uint8_t keyLength)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    hash ^= keyLength;
+    hash *= 16777619u;
+    for (uint8_t i = 0; i < keyLength; i++)
+    {
+        hash ^= key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool slotHasKey(const OCKeyMapSlot *slot, const void *key, uint8_t keyLength)
+{
+    return slot->keyLength == keyLength && memcmp(slot->key, key, keyLength) == 0;
+}
+
+static void insertSlot(OCKeyMapSlot *slots, size_t size, const OCKeyMapSlot *slot)
+{
+    size_t i = hashKey(slot->key, slot->keyLength) & (size - 1);
+
+    // after the values with the same key, which keeps them in order
+    while (slots[i].value)
+    {
+        i = (i + 1) & (size - 1);
+    }
+    slots[i] = *slot;
+}
+
+static OCStackResult resize(OCKeyMap *map, size_t size)
+{
+    OCKeyMapSlot *slots = (OCKeyMapSlot *)OICCalloc(size, sizeof(OCKeyMapSlot));
+    if (!slots)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to grow the map");
+        return OC_STACK_NO_MEMORY;
+    }
+
+    // Start after an empty slot: no run of slots wraps around it, so the
+    // values of a key are added back in their order.
+    size_t start = 0;
+    while (start < map->size && map->slots[start].value)
+    {
+        start++;
+    }
+    for (size_t n = 0; n < map->size; n++)
+    {
+        OCKeyMapSlot *slot = &map->slots[(start + n) & (map->size - 1)];
+        if (slot->value)
+        {
+            insertSlot(slots, size, slot);
+        }
+    }
+
+    OICFree(map->slots);
+    map->slots = slots;
+    map->size = size;
+    return OC_STACK_OK;
+}
+
+OCStackResult OCKeyMapAdd(OCKeyMap *map, const void *key, uint8_t keyLength, void *value)
+{
+    if (!map || (!key && keyLength) || keyLength > OC_KEY_MAP_MAX_KEY_LENGTH || !value)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    // keep at least half of the slots empty, so the probe sequences stay short
+    if ((map->count + 1) * 2 > map->size)
+    {
+        OCStackResult result = resize(map, map->size ? map->size * 2 : KEY_MAP_MIN_SIZE);
+        if (OC_STACK_OK != result)
+        {
+            return result;
+        }
+    }
+
+    OCKeyMapSlot slot = { .value = value, .keyLength = keyLength };
+    if (keyLength)
+    {
+        memcpy(slot.key, key, keyLength);
+    }
+    insertSlot(map->slots, map->size, &slot);
+    map->count++;
+    return OC_STACK_OK;
+}
+
+void *OCKeyMapFind(const OCKeyMap *map, const void *key, uint8_t keyLength)
+{
+    if (!map || !map->slots || (!key && keyLength) || keyLength > OC_KEY_MAP_MAX_KEY_LENGTH)
+    {
+        return NULL;
+    }
+
+    size_t i = hashKey((const uint8_t *)key, keyLength) & (map->size - 1);
+    while (map->slots[i].value)
+    {
+        if (slotHasKey(&map->slots[i], key, keyLength))
+        {
+            return map->slots[i].value;
+        }
+        i = (i + 1) & (map->size - 1);
+    }
+    return NULL;
+}
+
+bool OCKeyMapRemove(OCKeyMap *map, const void *key, uint8_t keyLength, const void *value)
+{
+    if (!map || !map->slots || (!key && keyLength) || keyLength > OC_KEY_MAP_MAX_KEY_LENGTH ||
+        !value)
+    {
+        return false;
+    }
+
+    size_t mask = map->size - 1;
+    size_t i = hashKey((const uint8_t *)key, keyLength) & mask;
+    while (map->slots[i].value != value || !slotHasKey(&map->slots[i], key, keyLength))
+    {
+        if (!map->slots[i].value)
+        {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Move back the following slots that can no longer be reached from their
+    // home slot, so no deleted marker is needed.
+    size_t j = i;
+    for (;;)
+    {
+        j = (j + 1) & mask;
+        if (!map->slots[j].value)
+        {
+            break;
+        }
+
+        size_t home = hashKey(map->slots[j].key, map->slots[j].keyLength) & mask;
+        bool reachable = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!reachable)
+        {
+            map->slots[i] = map->slots[j];
+            i = j;
+        }
+    }
+    map->slots[i].value = NULL;
+    map->count--;
+    return true;
+}
+
+void OCKeyMapClear(OCKeyMap *map)
+{
+    if (!map)
+    {
+        return;
+    }
+
+    OICFree(map->slots);
+    map->slots = NULL;
+    map->size = 0;
+    map->count = 0;
+}
@@ -29,6 +29,7 @@
 #include "oic_string.h"
 #include "ocpayload.h"
 #include "ocserverrequest.h"
+#include "ockeymap.h"
 #include "logger.h"
 
 #include <coap/utlist.h>
@@ -43,6 +44,13 @@
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
 static struct ResourceObserver * g_serverObsList = NULL;
+
+/** Observers by token and by observation id, for the lookups of g_serverObsList. */
+static OCKeyMap g_observersByToken;
+static OCKeyMap g_observersById;
+
+static void CheckTimedOutObservers();
+
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -98,14 +106,20 @@ static OCQualityOfService DetermineObserverQoS(OCMethod method,
 
 /**
  * Create a get request and pass to entityhandler to notify specific observer.
+ * The response is also sent to the other observers of the group, if any.
  *
  * @param observer Observer that need to be notified.
  * @param qos Quality of service of resource.
+ * @param targets Other observers getting the same response, owned by the request
+ *                once it is created and freed otherwise.
+ * @param numTargets Number of targets.
  *
  * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-static OCStackResult SendObserveNotification(ResourceObserver *observer,
-                                             OCQualityOfService qos)
+static OCStackResult SendObserveNotificationToGroup(ResourceObserver *observer,
+                                                    OCQualityOfService qos,
+                                                    OCObserveTarget *targets,
+                                                    uint16_t numTargets)
 {
     OCStackResult result = OC_STACK_ERROR;
     OCServerRequest * request = NULL;
@@ -119,44 +133,197 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
                               observer->resUri, 0, observer->acceptFormat,
                               &observer->devAddr);
 
-    if (request)
-    {
-        request->observeResult = OC_STACK_OK;
+    if (!request)
+    {
+        OICFree(targets);
+        return result;
+    }
+
+    request->observeTargets = targets;
+    request->numObserveTargets = numTargets;
+    request->observeResult = OC_STACK_OK;
+    if (result == OC_STACK_OK)
+    {
+        result = FormOCEntityHandlerRequest(
+                    &ehRequest,
+                    (OCRequestHandle) request->requestId,
+                    request->method,
+                    &request->devAddr,
+                    (OCResourceHandle) observer->resource,
+                    request->query,
+                    PAYLOAD_TYPE_REPRESENTATION,
+                    request->payload,
+                    request->payloadSize,
+                    request->numRcvdVendorSpecificHeaderOptions,
+                    request->rcvdVendorSpecificHeaderOptions,
+                    OC_OBSERVE_NO_OPTION,
+                    0,
+                    request->coapID);
         if (result == OC_STACK_OK)
         {
-            result = FormOCEntityHandlerRequest(
-                        &ehRequest,
-                        (OCRequestHandle) request->requestId,
-                        request->method,
-                        &request->devAddr,
-                        (OCResourceHandle) observer->resource,
-                        request->query,
-                        PAYLOAD_TYPE_REPRESENTATION,
-                        request->payload,
-                        request->payloadSize,
-                        request->numRcvdVendorSpecificHeaderOptions,
-                        request->rcvdVendorSpecificHeaderOptions,
-                        OC_OBSERVE_NO_OPTION,
-                        0,
-                        request->coapID);
-            if (result == OC_STACK_OK)
+            ehResult = observer->resource->entityHandler(OC_REQUEST_FLAG, &ehRequest,
+                                observer->resource->entityHandlerCallbackParam);
+            if (ehResult == OC_EH_ERROR)
             {
-                ehResult = observer->resource->entityHandler(OC_REQUEST_FLAG, &ehRequest,
-                                    observer->resource->entityHandlerCallbackParam);
-                if (ehResult == OC_EH_ERROR)
-                {
-                    FindAndDeleteServerRequest(request);
-                }
-                // Reset Observer TTL.
-                observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                FindAndDeleteServerRequest(request);
             }
-            OCPayloadDestroy(ehRequest.payload);
+            // Reset Observer TTL.
+            observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
         }
+        OCPayloadDestroy(ehRequest.payload);
     }
 
     return result;
 }
 
+/**
+ * Create a get request and pass to entityhandler to notify specific observer.
+ *
+ * @param observer Observer that need to be notified.
+ * @param qos Quality of service of resource.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendObserveNotification(ResourceObserver *observer,
+                                             OCQualityOfService qos)
+{
+    return SendObserveNotificationToGroup(observer, qos, NULL, 0);
+}
+
+/**
+ * Observers of a resource that get the same notification: the entity handler
+ * is called for the first one and the response is sent to the others too.
+ */
+typedef struct
+{
+    ResourceObserver *observer;
+    OCQualityOfService qos;
+    OCObserveTarget *targets;
+    uint16_t numTargets;
+} ObserverGroup;
+
+static bool IsSameNotification(const ResourceObserver *a, const ResourceObserver *b)
+{
+    return a->acceptFormat == b->acceptFormat &&
+           strcmp(a->query ? a->query : "", b->query ? b->query : "") == 0;
+}
+
+/**
+ * Notify the observers of a resource, calling the entity handler once per
+ * group of observers with the same query and accept format.
+ *
+ * @param method RESTful method.
+ * @param resPtr Observed resource.
+ * @param numObs Number of observers of the resource.
+ * @param qos Quality of service of resource.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendGroupedObserverNotification(OCMethod method, OCResource *resPtr,
+                                                     uint16_t numObs, OCQualityOfService qos)
+{
+    OCStackResult result = OC_STACK_OK;
+    uint16_t numGroups = 0;
+    ResourceObserver *observer = NULL;
+
+    ObserverGroup *groups = (ObserverGroup *) OICCalloc(numObs, sizeof(ObserverGroup));
+    uint16_t *groupOf = (uint16_t *) OICMalloc(numObs * sizeof(uint16_t));
+    if (!groups || !groupOf)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to group observers, notifying one by one");
+        OICFree(groups);
+        OICFree(groupOf);
+
+        for (observer = resPtr->observersHead; observer; observer = observer->resourceNext)
+        {
+            if (OC_STACK_OK != SendObserveNotification(observer,
+                                    DetermineObserverQoS(method, observer, qos)))
+            {
+                result = OC_STACK_ERROR;
+            }
+        }
+        return result;
+    }
+
+    // The number of groups is small, so a linear search is enough.
+    uint16_t i = 0;
+    for (observer = resPtr->observersHead; observer; observer = observer->resourceNext, i++)
+    {
+        uint16_t g = 0;
+        while (g < numGroups && !IsSameNotification(groups[g].observer, observer))
+        {
+            g++;
+        }
+        if (g == numGroups)
+        {
+            groups[numGroups++].observer = observer;
+        }
+        else
+        {
+            groups[g].numTargets++;
+        }
+        groupOf[i] = g;
+    }
+
+    for (uint16_t g = 0; g < numGroups; g++)
+    {
+        if (groups[g].numTargets)
+        {
+            groups[g].targets = (OCObserveTarget *) OICCalloc(groups[g].numTargets,
+                                                              sizeof(OCObserveTarget));
+        }
+        groups[g].numTargets = 0;
+    }
+
+    i = 0;
+    for (observer = resPtr->observersHead; observer; observer = observer->resourceNext, i++)
+    {
+        ObserverGroup *group = &groups[groupOf[i]];
+        OCQualityOfService observerQos = DetermineObserverQoS(method, observer, qos);
+
+        if (group->observer == observer)
+        {
+            group->qos = observerQos;
+        }
+        else if (group->targets)
+        {
+            OCObserveTarget *target = &group->targets[group->numTargets++];
+            target->devAddr = observer->devAddr;
+            target->tokenLength = observer->tokenLength;
+            memcpy(target->token, observer->token, observer->tokenLength);
+            target->qos = observerQos;
+
+            // Reset Observer TTL.
+            observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+        }
+        else
+        {
+            // could not allocate the targets of the group, notify it alone
+            if (OC_STACK_OK != SendObserveNotification(observer, observerQos))
+            {
+                result = OC_STACK_ERROR;
+            }
+        }
+    }
+
+    for (uint16_t g = 0; g < numGroups; g++)
+    {
+        OIC_LOG_V(INFO, TAG, "Notifying %d observers with one entity handler call",
+                  groups[g].numTargets + 1);
+        // the request owns the targets once it is created
+        if (OC_STACK_OK != SendObserveNotificationToGroup(groups[g].observer, groups[g].qos,
+                                                          groups[g].targets,
+                                                          groups[g].numTargets))
+        {
+            result = OC_STACK_ERROR;
+        }
+    }
+
+    OICFree(groups);
+    OICFree(groupOf);
+    return result;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr, uint32_t maxAge,
         OCPresenceTrigger trigger, OCResourceType *resourceType, OCQualityOfService qos)
@@ -172,67 +339,73 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     }
 
     OCStackResult result = OC_STACK_ERROR;
-    ResourceObserver * resourceObserver = g_serverObsList;
-    uint8_t numObs = 0;
-    OCServerRequest * request = NULL;
-    OCEntityHandlerRequest ehRequest = {0};
-    OCEntityHandlerResult ehResult = OC_EH_ERROR;
+    ResourceObserver * resourceObserver = NULL;
+    uint16_t numObs = 0;
     bool observeErrorFlag = false;
 
-    // Find clients that are observing this resource
-    while (resourceObserver)
+    // Only the observers of this resource are visited
+    for (resourceObserver = resPtr->observersHead; resourceObserver;
+         resourceObserver = resourceObserver->resourceNext)
     {
-        if (resourceObserver->resource == resPtr)
-        {
-            numObs++;
+        numObs++;
+    }
+
+    if (numObs == 0)
+    {
+        OIC_LOG(INFO, TAG, "Resource has no observers");
+        return OC_STACK_NO_OBSERVERS;
+    }
+
 #ifdef WITH_PRESENCE
-            if (method != OC_REST_PRESENCE)
-            {
+    if (method != OC_REST_PRESENCE)
+    {
 #endif
-                qos = DetermineObserverQoS(method, resourceObserver, qos);
-                result = SendObserveNotification(resourceObserver, qos);
+        result = SendGroupedObserverNotification(method, resPtr, numObs, qos);
+        observeErrorFlag = (result != OC_STACK_OK);
 #ifdef WITH_PRESENCE
-            }
-            else
+    }
+    else
+    {
+        for (resourceObserver = resPtr->observersHead; resourceObserver;
+             resourceObserver = resourceObserver->resourceNext)
+        {
+            OCServerRequest * request = NULL;
+            OCEntityHandlerResponse ehResponse = {0};
+
+            //This is effectively the implementation for the presence entity handler.
+            OIC_LOG(DEBUG, TAG, "This notification is for Presence");
+            result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                    0, resPtr->sequenceNum, qos, resourceObserver->query,
+                    NULL, NULL,
+                    resourceObserver->token, resourceObserver->tokenLength,
+                    resourceObserver->resUri, 0, resourceObserver->acceptFormat,
+                    &resourceObserver->devAddr);
+
+            if (result == OC_STACK_OK)
             {
-                OCEntityHandlerResponse ehResponse = {0};
+                OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
+                        resPtr->sequenceNum, maxAge, trigger,
+                        resourceType ? resourceType->resourcetypename : NULL);
 
-                //This is effectively the implementation for the presence entity handler.
-                OIC_LOG(DEBUG, TAG, "This notification is for Presence");
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
-                        NULL, NULL,
-                        resourceObserver->token, resourceObserver->tokenLength,
-                        resourceObserver->resUri, 0, resourceObserver->acceptFormat,
-                        &resourceObserver->devAddr);
+                if (!presenceResBuf)
+                {
+                    return OC_STACK_NO_MEMORY;
+                }
 
                 if (result == OC_STACK_OK)
                 {
-                    OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
-                            resPtr->sequenceNum, maxAge, trigger,
-                            resourceType ? resourceType->resourcetypename : NULL);
-
-                    if (!presenceResBuf)
-                    {
-                        return OC_STACK_NO_MEMORY;
-                    }
-
-                    if (result == OC_STACK_OK)
-                    {
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)presenceResBuf;
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request->requestId;
-                        ehResponse.resourceHandle = (OCResourceHandle) resPtr;
-                        OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
-                                resourceObserver->resUri);
-                        result = OCDoResponse(&ehResponse);
-                    }
-
-                    OCPresencePayloadDestroy(presenceResBuf);
+                    ehResponse.ehResult = OC_EH_OK;
+                    ehResponse.payload = (OCPayload*)presenceResBuf;
+                    ehResponse.persistentBufferFlag = 0;
+                    ehResponse.requestHandle = (OCRequestHandle) request->requestId;
+                    ehResponse.resourceHandle = (OCResourceHandle) resPtr;
+                    OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
+                            resourceObserver->resUri);
+                    result = OCDoResponse(&ehResponse);
                 }
+
+                OCPresencePayloadDestroy(presenceResBuf);
             }
-#endif
 
             // Since we are in a loop, set an error flag to indicate at least one error occurred.
             if (result != OC_STACK_OK)
@@ -240,15 +413,10 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
                 observeErrorFlag = true;
             }
         }
-        resourceObserver = resourceObserver->next;
     }
+#endif
 
-    if (numObs == 0)
-    {
-        OIC_LOG(INFO, TAG, "Resource has no observers");
-        result = OC_STACK_NO_OBSERVERS;
-    }
-    else if (observeErrorFlag)
+    if (observeErrorFlag)
     {
         OIC_LOG(ERROR, TAG, "Observer notification error");
         result = OC_STACK_ERROR;
@@ -256,6 +424,67 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     return result;
 }
 
+/**
+ * Send the payload of a list notification to an observer, and to the other
+ * observers of the list getting the same encoded payload.
+ *
+ * @param observer Observer that need to be notified.
+ * @param qos Quality of service of the notification.
+ * @param targets Other observers getting the same response, owned by the request
+ *                once it is created and freed otherwise.
+ * @param numTargets Number of targets.
+ * @param payload Payload of the notification.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendListNotificationToGroup(ResourceObserver *observer,
+                                                 OCQualityOfService qos,
+                                                 OCObserveTarget *targets,
+                                                 uint16_t numTargets,
+                                                 const OCRepPayload *payload)
+{
+    OCServerRequest * request = NULL;
+    OCStackResult result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                                            0, observer->resource->sequenceNum, qos,
+                                            observer->query, NULL, NULL,
+                                            observer->token, observer->tokenLength,
+                                            observer->resUri, 0, observer->acceptFormat,
+                                            &observer->devAddr);
+    if (!request)
+    {
+        OICFree(targets);
+        return result;
+    }
+
+    request->observeTargets = targets;
+    request->numObserveTargets = numTargets;
+    request->observeResult = OC_STACK_OK;
+    if (result == OC_STACK_OK)
+    {
+        OCEntityHandlerResponse ehResponse = {0};
+        ehResponse.ehResult = OC_EH_OK;
+        ehResponse.payload = (OCPayload*)OCRepPayloadCreate();
+        if (!ehResponse.payload)
+        {
+            FindAndDeleteServerRequest(request);
+            return OC_STACK_NO_MEMORY;
+        }
+        memcpy(ehResponse.payload, payload, sizeof(*payload));
+        ehResponse.persistentBufferFlag = 0;
+        ehResponse.requestHandle = (OCRequestHandle) request->requestId;
+        ehResponse.resourceHandle = (OCResourceHandle) observer->resource;
+        result = OCDoResponse(&ehResponse);
+        OICFree(ehResponse.payload);
+    }
+
+    // already deleted when the response was sent
+    FindAndDeleteServerRequest(request);
+
+    // Reset Observer TTL.
+    observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+    return result;
+}
+
 OCStackResult SendListObserverNotification (OCResource * resource,
         OCObservationId  *obsIdList, uint8_t numberOfIds,
         const OCRepPayload *payload,
@@ -268,84 +497,107 @@ OCStackResult SendListObserverNotification (OCResource * resource,
         return OC_STACK_INVALID_PARAM;
     }
 
-    uint8_t numIds = numberOfIds;
     ResourceObserver *observer = NULL;
     uint8_t numSentNotification = 0;
-    OCServerRequest * request = NULL;
+    uint8_t numObs = 0;
     OCStackResult result = OC_STACK_ERROR;
     bool observeErrorFlag = false;
 
     OIC_LOG(INFO, TAG, "Entering SendListObserverNotification");
-    while(numIds)
+    if (!numberOfIds)
+    {
+        return OC_STACK_OK;
+    }
+
+    ResourceObserver **observers = (ResourceObserver **) OICCalloc(numberOfIds,
+                                                                  sizeof(ResourceObserver *));
+    if (!observers)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    for (uint8_t i = 0; i < numberOfIds; i++)
     {
-        observer = GetObserverUsingId (*obsIdList);
-        if (observer)
+        observer = GetObserverUsingId(obsIdList[i]);
+        // Found observer - verify if it matches the resource handle
+        if (observer && observer->resource == resource)
+        {
+            observers[numObs++] = observer;
+        }
+    }
+
+    // The payload is the same for every observer of the list, so it is encoded
+    // once per accept format: the response made for the first observer with a
+    // format is also sent to the others as observe targets.
+    for (uint8_t i = 0; i < numObs; i++)
+    {
+        ResourceObserver *first = observers[i];
+        if (!first)
+        {
+            continue;
+        }
+
+        uint8_t numTargets = 0;
+        for (uint8_t j = i + 1; j < numObs; j++)
         {
-            // Found observer - verify if it matches the resource handle
-            if (observer->resource == resource)
+            if (observers[j] && observers[j]->acceptFormat == first->acceptFormat)
             {
-                qos = DetermineObserverQoS(OC_REST_GET, observer, qos);
+                numTargets++;
+            }
+        }
 
+        OCObserveTarget *targets = NULL;
+        if (numTargets)
+        {
+            targets = (OCObserveTarget *) OICCalloc(numTargets, sizeof(OCObserveTarget));
+            if (!targets)
+            {
+                // the others are notified alone
+                numTargets = 0;
+            }
+        }
 
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resource->sequenceNum, qos, observer->query,
-                        NULL, NULL, observer->token, observer->tokenLength,
-                        observer->resUri, 0, observer->acceptFormat,
-                        &observer->devAddr);
+        for (uint8_t j = i + 1, t = 0; j < numObs && t < numTargets; j++)
+        {
+            observer = observers[j];
+            if (observer && observer->acceptFormat == first->acceptFormat)
+            {
+                OCObserveTarget *target = &targets[t++];
+                target->devAddr = observer->devAddr;
+                target->tokenLength = observer->tokenLength;
+                memcpy(target->token, observer->token, observer->tokenLength);
+                target->qos = DetermineObserverQoS(OC_REST_GET, observer, qos);
 
-                if (request)
-                {
-                    request->observeResult = OC_STACK_OK;
-                    if (result == OC_STACK_OK)
-                    {
-                        OCEntityHandlerResponse ehResponse = {0};
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)OCRepPayloadCreate();
-                        if (!ehResponse.payload)
-                        {
-                            FindAndDeleteServerRequest(request);
-                            continue;
-                        }
-                        memcpy(ehResponse.payload, payload, sizeof(*payload));
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request->requestId;
-                        ehResponse.resourceHandle = (OCResourceHandle) resource;
-                        result = OCDoResponse(&ehResponse);
-                        if (result == OC_STACK_OK)
-                        {
-                            OIC_LOG_V(INFO, TAG, "Observer id %d notified.", *obsIdList);
-
-                            // Increment only if OCDoResponse is successful
-                            numSentNotification++;
-
-                            OICFree(ehResponse.payload);
-                            FindAndDeleteServerRequest(request);
-                        }
-                        else
-                        {
-                            OIC_LOG_V(INFO, TAG, "Error notifying observer id %d.", *obsIdList);
-                        }
-                        // Reset Observer TTL.
-                        observer->TTL =
-                                GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
-                    }
-                    else
-                    {
-                        FindAndDeleteServerRequest(request);
-                    }
-                }
-                // Since we are in a loop, set an error flag to indicate
-                // at least one error occurred.
-                if (result != OC_STACK_OK)
-                {
-                    observeErrorFlag = true;
-                }
+                // Reset Observer TTL.
+                observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                observers[j] = NULL;
             }
         }
-        obsIdList++;
-        numIds--;
+
+        // the request owns the targets once it is created
+        result = SendListNotificationToGroup(first,
+                                             DetermineObserverQoS(OC_REST_GET, first, qos),
+                                             targets, numTargets, payload);
+        if (result == OC_STACK_OK)
+        {
+            OIC_LOG_V(INFO, TAG, "Observer id %d and %d others notified.",
+                      first->observeId, numTargets);
+
+            // Increment only if OCDoResponse is successful
+            numSentNotification += numTargets + 1;
+        }
+        else
+        {
+            OIC_LOG_V(INFO, TAG, "Error notifying observer id %d.", first->observeId);
+
+            // Since we are in a loop, set an error flag to indicate
+            // at least one error occurred.
+            observeErrorFlag = true;
+        }
     }
 
+    OICFree(observers);
+
     if (numSentNotification == numberOfIds && !observeErrorFlag)
     {
         return OC_STACK_OK;
@@ -368,6 +620,9 @@ OCStackResult GenerateObserverId (OCObservationId *observationId)
     OIC_LOG(INFO, TAG, "Entering GenerateObserverId");
     VERIFY_NON_NULL (observationId);
 
+    // the lookups no longer walk the list, check the TTLs when an observer comes
+    CheckTimedOutObservers();
+
     do
     {
         *observationId = OCGetRandomByte();
@@ -444,7 +699,21 @@ OCStackResult AddObserver (const char         *resUri,
             obsNode->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
         }
 
-        LL_APPEND (g_serverObsList, obsNode);
+        if (OC_STACK_OK != OCKeyMapAdd(&g_observersByToken, obsNode->token,
+                                       obsNode->tokenLength, obsNode))
+        {
+            goto exit;
+        }
+        if (OC_STACK_OK != OCKeyMapAdd(&g_observersById, &obsNode->observeId,
+                                       sizeof(obsNode->observeId), obsNode))
+        {
+            OCKeyMapRemove(&g_observersByToken, obsNode->token, obsNode->tokenLength, obsNode);
+            goto exit;
+        }
+
+        DL_APPEND (g_serverObsList, obsNode);
+        obsNode->resourceNext = resHandle->observersHead;
+        resHandle->observersHead = obsNode;
 
         return OC_STACK_OK;
     }
@@ -454,6 +723,7 @@ exit:
     {
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
+        OICFree(obsNode->token);
         OICFree(obsNode);
     }
     return OC_STACK_NO_MEMORY;
@@ -484,43 +754,46 @@ static void CheckTimedOutObserver(ResourceObserver* observer)
     }
 }
 
+static void CheckTimedOutObservers()
+{
+    ResourceObserver *out = NULL;
+    ResourceObserver *tmp = NULL;
+
+    LL_FOREACH_SAFE (g_serverObsList, out, tmp)
+    {
+        CheckTimedOutObserver(out);
+    }
+}
+
 ResourceObserver* GetObserverUsingId (const OCObservationId observeId)
 {
     ResourceObserver *out = NULL;
 
     if (observeId)
     {
-        LL_FOREACH (g_serverObsList, out)
-        {
-            if (out->observeId == observeId)
-            {
-                return out;
-            }
-            CheckTimedOutObserver(out);
-        }
+        out = (ResourceObserver *) OCKeyMapFind(&g_observersById, &observeId,
+                                                sizeof(observeId));
     }
-    OIC_LOG(INFO, TAG, "Observer node not found!!");
-    return NULL;
+    if (!out)
+    {
+        OIC_LOG(INFO, TAG, "Observer node not found!!");
+    }
+    return out;
 }
 
 ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLength)
 {
     if (token)
     {
-        OIC_LOG(INFO, TAG, "Looking for token");
-        OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
+        OIC_LOG(DEBUG, TAG, "Looking for token");
+        OIC_LOG_BUFFER(DEBUG, TAG, (const uint8_t *)token, tokenLength);
 
-        ResourceObserver *out = NULL;
-        LL_FOREACH (g_serverObsList, out)
+        ResourceObserver *out = (ResourceObserver *) OCKeyMapFind(&g_observersByToken, token,
+                                                                  tokenLength);
+        if (out)
         {
-            /* de-annotate below line if want to see all token in cbList */
-            //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if ((memcmp(out->token, token, tokenLength) == 0))
-            {
-                OIC_LOG(INFO, TAG, "Found in observer list");
-                return out;
-            }
-            CheckTimedOutObserver(out);
+            OIC_LOG(DEBUG, TAG, "Found in observer list");
+            return out;
         }
     }
     else
@@ -532,6 +805,29 @@ ResourceObserver* GetObserverUsingToken (const CAToken_t token, uint8_t tokenLen
     return NULL;
 }
 
+/*
+ * Remove an observer from the observer list, from its indexes and from the
+ * observers of its resource. The observer is not freed.
+ */
+static void UnlinkObserver(ResourceObserver *observer)
+{
+    DL_DELETE (g_serverObsList, observer);
+    OCKeyMapRemove(&g_observersByToken, observer->token, observer->tokenLength, observer);
+    OCKeyMapRemove(&g_observersById, &observer->observeId, sizeof(observer->observeId),
+                   observer);
+
+    ResourceObserver **link = &observer->resource->observersHead;
+
+    while (*link && *link != observer)
+    {
+        link = &(*link)->resourceNext;
+    }
+    if (*link)
+    {
+        *link = observer->resourceNext;
+    }
+}
+
 OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
 {
     if (!token)
@@ -544,7 +840,7 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
     {
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
-        LL_DELETE (g_serverObsList, obsNode);
+        UnlinkObserver(obsNode);
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
         OICFree(obsNode->token);
@@ -580,6 +876,26 @@ OCStackResult DeleteObserverUsingDevAddr(const OCDevAddr *devAddr)
     return OC_STACK_OK;
 }
 
+void DeleteObserversUsingResource(OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    while (resource->observersHead)
+    {
+        ResourceObserver *obsNode = resource->observersHead;
+        OIC_LOG_V(INFO, TAG, "deleting observer id  %u of deleted resource",
+                  obsNode->observeId);
+        UnlinkObserver(obsNode);
+        OICFree(obsNode->resUri);
+        OICFree(obsNode->query);
+        OICFree(obsNode->token);
+        OICFree(obsNode);
+    }
+}
+
 void DeleteObserverList()
 {
     ResourceObserver *out = NULL;
@@ -592,6 +908,8 @@ void DeleteObserverList()
         }
     }
     g_serverObsList = NULL;
+    OCKeyMapClear(&g_observersByToken);
+    OCKeyMapClear(&g_observersById);
 }
 
 /*
@@ -30,12 +30,91 @@
 #include "oic_string.h"
 #include "ocstackinternal.h"
 #include "ocresource.h"
+#include "ocpayloadcbor.h"
 #include "logger.h"
 
 #define TAG "OIC_RI_PAYLOAD"
 #define CSV_SEPARATOR ','
 
-static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val);
+struct OCPayloadArena
+{
+    OCRepPayload* root;     // representation whose destruction frees the arena
+    size_t size;
+    size_t used;
+    bool mixed;             // heap memory was attached to the representations
+    uint8_t* data;
+};
+
+static void OCFreeRepPayloadValueContents(const OCPayloadArena* arena, OCRepPayloadValue* val);
+static void OCFreeOCStringLLInArena(const OCPayloadArena* arena, OCStringLL* ll);
+
+/**
+ * Free memory of a representation unless it belongs to its arena.
+ */
+static void OCPayloadArenaFree(const OCPayloadArena* arena, void* ptr)
+{
+    if (arena && (uint8_t*)ptr >= arena->data && (uint8_t*)ptr < arena->data + arena->size)
+    {
+        return;
+    }
+    OICFree(ptr);
+}
+
+/**
+ * Note that heap memory is attached to a representation, so that destroying
+ * the arena looks for it.
+ */
+static void OCPayloadArenaSetMixed(const OCRepPayload* payload)
+{
+    if (payload->arena)
+    {
+        payload->arena->mixed = true;
+    }
+}
+
+OCRepPayload* OCRepPayloadCreateWithArena(size_t size)
+{
+    size_t headerSize = OC_PAYLOAD_ARENA_SIZE(sizeof(OCPayloadArena));
+    size_t rootSize = OC_PAYLOAD_ARENA_SIZE(sizeof(OCRepPayload));
+
+    OCPayloadArena* arena = (OCPayloadArena*)OICCalloc(1, headerSize + rootSize + size);
+    if (!arena)
+    {
+        return NULL;
+    }
+    arena->data = (uint8_t*)arena + headerSize;
+    arena->size = rootSize + size;
+
+    arena->root = OCRepPayloadCreateInArena(arena);
+    return arena->root;
+}
+
+void* OCPayloadArenaAlloc(OCPayloadArena* arena, size_t size)
+{
+    size = OC_PAYLOAD_ARENA_SIZE(size);
+    if (!arena || size > arena->size - arena->used)
+    {
+        return NULL;
+    }
+
+    void* ptr = arena->data + arena->used;
+    arena->used += size;
+    return ptr;
+}
+
+OCRepPayload* OCRepPayloadCreateInArena(OCPayloadArena* arena)
+{
+    OCRepPayload* payload = (OCRepPayload*)OCPayloadArenaAlloc(arena, sizeof(OCRepPayload));
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    payload->base.type = PAYLOAD_TYPE_REPRESENTATION;
+    payload->arena = arena;
+
+    return payload;
+}
 
 void OCPayloadDestroy(OCPayload* payload)
 {
@@ -86,6 +165,8 @@ void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
         return;
     }
 
+    OCPayloadArenaSetMixed(parent);
+
     while(parent->next)
     {
         parent = parent->next;
@@ -213,7 +294,7 @@ exit:
     return;
 }
 
-static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
+static void OCFreeRepPayloadValueContents(const OCPayloadArena* arena, OCRepPayloadValue* val)
 {
     if (!val)
     {
@@ -224,12 +305,12 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
     {
         if (val->str != NULL)
         {
-            OICFree(val->str);
+            OCPayloadArenaFree(arena, val->str);
         }
     }
     else if (val->type == OCREP_PROP_BYTE_STRING)
     {
-        OICFree(val->ocByteStr.bytes);
+        OCPayloadArenaFree(arena, val->ocByteStr.bytes);
     }
     else if (val->type == OCREP_PROP_OBJECT)
     {
@@ -245,16 +326,16 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
             case OCREP_PROP_BOOL:
                 // Since this is a union, iArray will
                 // point to all of the above
-                OICFree(val->arr.iArray);
+                OCPayloadArenaFree(arena, val->arr.iArray);
                 break;
             case OCREP_PROP_STRING:
                 if (val->arr.strArray != NULL) 
                 {
                     for(size_t i = 0; i < dimTotal; ++i)
                     {
-                        OICFree(val->arr.strArray[i]);
+                        OCPayloadArenaFree(arena, val->arr.strArray[i]);
                     }
-                    OICFree(val->arr.strArray);
+                    OCPayloadArenaFree(arena, val->arr.strArray);
                 }
                 break;
             case OCREP_PROP_BYTE_STRING:
@@ -264,10 +345,10 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
                     {
                         if (val->arr.ocByteStrArray[i].bytes)
                         {
-                            OICFree(val->arr.ocByteStrArray[i].bytes);
+                            OCPayloadArenaFree(arena, val->arr.ocByteStrArray[i].bytes);
                         }
                     }
-                    OICFree(val->arr.ocByteStrArray);
+                    OCPayloadArenaFree(arena, val->arr.ocByteStrArray);
                 }
                 break;
             case OCREP_PROP_OBJECT: // This case is the temporary fix for string input
@@ -277,7 +358,7 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
                     {
                         OCRepPayloadDestroy(val->arr.objArray[i]);
                     }
-                    OICFree(val->arr.objArray);
+                    OCPayloadArenaFree(arena, val->arr.objArray);
                 }
                 break;
             case OCREP_PROP_NULL:
@@ -289,17 +370,17 @@ static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val)
     }
 }
 
-static void OCFreeRepPayloadValue(OCRepPayloadValue* val)
+static void OCFreeRepPayloadValue(const OCPayloadArena* arena, OCRepPayloadValue* val)
 {
     if (!val)
     {
         return;
     }
 
-    OICFree(val->name);
-    OCFreeRepPayloadValueContents(val);
-    OCFreeRepPayloadValue(val->next);
-    OICFree(val);
+    OCPayloadArenaFree(arena, val->name);
+    OCFreeRepPayloadValueContents(arena, val);
+    OCFreeRepPayloadValue(arena, val->next);
+    OCPayloadArenaFree(arena, val);
 }
 static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
 {
@@ -329,7 +410,7 @@ static OCRepPayloadValue* OCRepPayloadValueClone (OCRepPayloadValue* source)
         destIter->next = (OCRepPayloadValue*) OICCalloc(1, sizeof(OCRepPayloadValue));
         if (!destIter->next)
         {
-            OCFreeRepPayloadValue (headOfClone);
+            OCFreeRepPayloadValue (NULL, headOfClone);
             return NULL;
         }
 
@@ -351,6 +432,8 @@ static OCRepPayloadValue* OCRepPayloadFindAndSetValue(OCRepPayload* payload, con
         return NULL;
     }
 
+    OCPayloadArenaSetMixed(payload);
+
     OCRepPayloadValue* val = payload->values;
     if (val == NULL)
     {
@@ -374,7 +457,7 @@ static OCRepPayloadValue* OCRepPayloadFindAndSetValue(OCRepPayload* payload, con
     {
         if (0 == strcmp(val->name, name))
         {
-            OCFreeRepPayloadValueContents(val);
+            OCFreeRepPayloadValueContents(payload->arena, val);
             val->type = type;
             return val;
         }
@@ -415,6 +498,8 @@ bool OCRepPayloadAddResourceTypeAsOwner(OCRepPayload* payload, char* resourceTyp
         return false;
     }
 
+    OCPayloadArenaSetMixed(payload);
+
     if (payload->types)
     {
         OCStringLL* cur = payload->types;
@@ -456,6 +541,8 @@ bool OCRepPayloadAddInterfaceAsOwner(OCRepPayload* payload, char* iface)
         return false;
     }
 
+    OCPayloadArenaSetMixed(payload);
+
     if (payload->interfaces)
     {
         OCStringLL* cur = payload->interfaces;
@@ -490,7 +577,8 @@ bool OCRepPayloadSetUri(OCRepPayload* payload, const char*  uri)
     {
         return false;
     }
-    OICFree(payload->uri);
+    OCPayloadArenaSetMixed(payload);
+    OCPayloadArenaFree(payload->arena, payload->uri);
     payload->uri = OICStrdup(uri);
     return payload->uri != NULL;
 }
@@ -1396,16 +1484,21 @@ bool OCRepPayloadGetPropObjectArray(const OCRepPayload* payload, const char* nam
     return true;
 }
 
-void OCFreeOCStringLL(OCStringLL* ll)
+static void OCFreeOCStringLLInArena(const OCPayloadArena* arena, OCStringLL* ll)
 {
     if (!ll)
     {
         return;
     }
 
-    OCFreeOCStringLL(ll->next);
-    OICFree(ll->value);
-    OICFree(ll);
+    OCFreeOCStringLLInArena(arena, ll->next);
+    OCPayloadArenaFree(arena, ll->value);
+    OCPayloadArenaFree(arena, ll);
+}
+
+void OCFreeOCStringLL(OCStringLL* ll)
+{
+    OCFreeOCStringLLInArena(NULL, ll);
 }
 
 OCStringLL* CloneOCStringLL (OCStringLL* ll)
@@ -1623,12 +1716,30 @@ void OCRepPayloadDestroy(OCRepPayload* payload)
         return;
     }
 
-    OICFree(payload->uri);
-    OCFreeOCStringLL(payload->types);
-    OCFreeOCStringLL(payload->interfaces);
-    OCFreeRepPayloadValue(payload->values);
+    OCPayloadArena* arena = payload->arena;
+    if (arena && !arena->mixed)
+    {
+        // Nothing but the arena to free, and only with its root
+        if (arena->root == payload)
+        {
+            OICFree(arena);
+        }
+        return;
+    }
+
+    OCPayloadArenaFree(arena, payload->uri);
+    OCFreeOCStringLLInArena(arena, payload->types);
+    OCFreeOCStringLLInArena(arena, payload->interfaces);
+    OCFreeRepPayloadValue(arena, payload->values);
     OCRepPayloadDestroy(payload->next);
-    OICFree(payload);
+    if (!arena)
+    {
+        OICFree(payload);
+    }
+    else if (arena->root == payload)
+    {
+        OICFree(arena);
+    }
 }
 
 OCDiscoveryPayload* OCDiscoveryPayloadCreate()
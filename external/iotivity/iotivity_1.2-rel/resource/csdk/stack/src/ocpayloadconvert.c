@@ -42,15 +42,11 @@
 #define LINKS_MAP_LEN 4
 
 // Functions all return either a CborError, or a negative version of the OC_STACK return values
-static int64_t OCConvertPayloadHelper(OCPayload *payload, uint8_t *outPayload, size_t *size);
-static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload *payload, uint8_t *outPayload,
-        size_t *size);
-static int64_t OCConvertRepPayload(OCRepPayload *payload, uint8_t *outPayload, size_t *size);
+static int64_t OCConvertPayloadHelper(OCPayload *payload, CborEncoder *encoder);
+static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload *payload, CborEncoder *encoder);
+static int64_t OCConvertRepPayload(OCRepPayload *payload, CborEncoder *encoder);
 static int64_t OCConvertRepMap(CborEncoder *map, const OCRepPayload *payload);
-static int64_t OCConvertPresencePayload(OCPresencePayload *payload, uint8_t *outPayload,
-        size_t *size);
-static int64_t OCConvertSecurityPayload(OCSecurityPayload *payload, uint8_t *outPayload,
-        size_t *size);
+static int64_t OCConvertPresencePayload(OCPresencePayload *payload, CborEncoder *encoder);
 static int64_t OCConvertSingleRepPayload(CborEncoder *parent, const OCRepPayload *payload);
 static int64_t OCConvertArray(CborEncoder *parent, const OCRepPayloadValueArray *valArray);
 
@@ -59,6 +55,52 @@ static int64_t AddTextStringToMap(CborEncoder *map, const char *key, size_t keyl
 static int64_t ConditionalAddTextStringToMap(CborEncoder *map, const char *key, size_t keylen,
         const char *value);
 
+/**
+ * Encode a payload into buffer. When buffer is too small, tinycbor keeps
+ * counting the bytes without writing them, so a single pass gives either
+ * the encoding or its exact size.
+ *
+ * @param size      set to the encoded size, or to the size needed on
+ *                  CborErrorOutOfMemory.
+ */
+static int64_t OCEncodePayload(OCPayload *payload, uint8_t *buffer, size_t bufferSize,
+                               size_t *size)
+{
+    if (PAYLOAD_TYPE_SECURITY == payload->type)
+    {
+        // already encoded
+        OCSecurityPayload *securityPayload = (OCSecurityPayload *)payload;
+        *size = securityPayload->payloadSize;
+        if (securityPayload->payloadSize > bufferSize)
+        {
+            return CborErrorOutOfMemory;
+        }
+        if (securityPayload->payloadSize)
+        {
+            memcpy(buffer, securityPayload->securityData, securityPayload->payloadSize);
+        }
+        return CborNoError;
+    }
+
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder, buffer, bufferSize, 0);
+
+    int64_t err = OCConvertPayloadHelper(payload, &encoder);
+    if (err == CborErrorOutOfMemory)
+    {
+        *size = bufferSize + cbor_encoder_get_extra_bytes_needed(&encoder);
+    }
+    else if (err != CborNoError)
+    {
+        OIC_LOG_V(ERROR, TAG, "Convert Payload failed : %s", cbor_error_string(err));
+    }
+    else
+    {
+        *size = cbor_encoder_get_buffer_size(&encoder, buffer);
+    }
+    return err;
+}
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size)
 {
     // TinyCbor Version 47a78569c0 or better on master is required for the re-allocation
@@ -71,57 +113,36 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     int64_t err;
     uint8_t *out = NULL;
-    size_t curSize = INIT_SIZE;
+    uint8_t initial[INIT_SIZE];
+    size_t curSize = 0;
 
     VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
     VERIFY_PARAM_NON_NULL(TAG, size, "size parameter is NULL");
 
     OIC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
-    if (PAYLOAD_TYPE_SECURITY == payload->type)
-    {
-        size_t securityPayloadSize = ((OCSecurityPayload *)payload)->payloadSize;
-        if (securityPayloadSize > 0)
-        {
-            out = (uint8_t *)OICCalloc(1, ((OCSecurityPayload *)payload)->payloadSize);
-            VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate security payload");
-        }
-    }
-    if (out == NULL)
+
+    // Most payloads fit the buffer on the stack and are encoded once. For the
+    // others this pass only counts the bytes past the buffer, and the payload
+    // is then encoded once into a buffer of the exact size.
+    err = OCEncodePayload(payload, initial, sizeof(initial), &curSize);
+    ret = OC_STACK_NO_MEMORY;
+
+    if (err == CborNoError)
     {
-        out = (uint8_t *)OICCalloc(1, curSize);
+        out = (uint8_t *)OICMalloc(curSize ? curSize : 1);
         VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+        memcpy(out, initial, curSize);
     }
-    err = OCConvertPayloadHelper(payload, out, &curSize);
-    ret = OC_STACK_NO_MEMORY;
-
-    if (err == CborErrorOutOfMemory)
+    else if (err == CborErrorOutOfMemory)
     {
-        // reallocate "out" and try again!
-        uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-        memset(out2, 0, curSize);
-        out = out2;
-        err = OCConvertPayloadHelper(payload, out, &curSize);
-        while (err == CborErrorOutOfMemory)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            memset(out2, 0, curSize);
-            out = out2;
-            err = OCConvertPayloadHelper(payload, out, &curSize);
-        }
+        out = (uint8_t *)OICMalloc(curSize);
+        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+        err = OCEncodePayload(payload, out, curSize, &curSize);
     }
 
     if (err == CborNoError)
     {
-        if (curSize < INIT_SIZE && PAYLOAD_TYPE_SECURITY != payload->type)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-        }
-
         *size = curSize;
         *outPayload = out;
         OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : ", *size);
@@ -130,59 +151,29 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
     }
 
     //TODO: Proper conversion from CborError to OCStackResult.
-    ret = (OCStackResult)-err;
+    ret = (err == CborErrorOutOfMemory) ? OC_STACK_NO_MEMORY : (OCStackResult)-err;
 
 exit:
     OICFree(out);
     return ret;
 }
 
-static int64_t OCConvertPayloadHelper(OCPayload* payload, uint8_t* outPayload, size_t* size)
+static int64_t OCConvertPayloadHelper(OCPayload* payload, CborEncoder* encoder)
 {
     switch(payload->type)
     {
         case PAYLOAD_TYPE_DISCOVERY:
-            return OCConvertDiscoveryPayload((OCDiscoveryPayload*)payload, outPayload, size);
+            return OCConvertDiscoveryPayload((OCDiscoveryPayload*)payload, encoder);
         case PAYLOAD_TYPE_REPRESENTATION:
-            return OCConvertRepPayload((OCRepPayload*)payload, outPayload, size);
+            return OCConvertRepPayload((OCRepPayload*)payload, encoder);
         case PAYLOAD_TYPE_PRESENCE:
-            return OCConvertPresencePayload((OCPresencePayload*)payload, outPayload, size);
-        case PAYLOAD_TYPE_SECURITY:
-            return OCConvertSecurityPayload((OCSecurityPayload*)payload, outPayload, size);
+            return OCConvertPresencePayload((OCPresencePayload*)payload, encoder);
         default:
             OIC_LOG_V(INFO,TAG, "ConvertPayload default %d", payload->type);
             return CborErrorUnknownType;
     }
 }
 
-static int64_t checkError(int64_t err, CborEncoder* encoder, uint8_t* outPayload, size_t* size)
-{
-    if (err == CborErrorOutOfMemory)
-    {
-        *size += cbor_encoder_get_extra_bytes_needed(encoder);
-        return err;
-    }
-    else if (err != CborNoError)
-    {
-        OIC_LOG_V(ERROR, TAG, "Convert Payload failed : %s", cbor_error_string(err));
-        return err;
-    }
-    else
-    {
-        *size = cbor_encoder_get_buffer_size(encoder, outPayload);
-        return err;
-    }
-}
-
-static int64_t OCConvertSecurityPayload(OCSecurityPayload* payload, uint8_t* outPayload,
-        size_t* size)
-{
-    memcpy(outPayload, payload->securityData, payload->payloadSize);
-    *size = payload->payloadSize;
-
-    return CborNoError;
-}
-
 static int64_t OCStringLLJoin(CborEncoder *map, char *type, OCStringLL *val)
 {
     uint16_t count = 0;
@@ -208,14 +199,10 @@ static int64_t OCStringLLJoin(CborEncoder *map, char *type, OCStringLL *val)
     return err;
 }
 
-static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload *payload, uint8_t *outPayload,
-                                         size_t *size)
+static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload *payload, CborEncoder *encoder)
 {
-    CborEncoder encoder;
     int64_t err = CborNoError;
 
-    cbor_encoder_init(&encoder, outPayload, *size, 0);
-
     /*
     The format for the payload is "modelled" as JSON.
 
@@ -246,7 +233,7 @@ static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload *payload, uint8_t *o
 
     // Open the main root array
     CborEncoder rootArray;
-    err |= cbor_encoder_create_array(&encoder, &rootArray, 1);
+    err |= cbor_encoder_create_array(encoder, &rootArray, 1);
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed creating discovery root array");
 
     while (payload && payload->resources)
@@ -395,11 +382,11 @@ static int64_t OCConvertDiscoveryPayload(OCDiscoveryPayload *payload, uint8_t *o
     }
 
     // Close the final root array.
-    err |= cbor_encoder_close_container(&encoder, &rootArray);
+    err |= cbor_encoder_close_container(encoder, &rootArray);
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed closing root array");
 
 exit:
-    return checkError(err, &encoder, outPayload, size);
+    return err;
 }
 
 static int64_t OCConvertArrayItem(CborEncoder *array, const OCRepPayloadValueArray *valArray,
@@ -582,13 +569,10 @@ exit:
     return err;
 }
 
-static int64_t OCConvertRepPayload(OCRepPayload *payload, uint8_t *outPayload, size_t *size)
+static int64_t OCConvertRepPayload(OCRepPayload *payload, CborEncoder *encoder)
 {
-    CborEncoder encoder;
     int64_t err = CborNoError;
 
-    cbor_encoder_init(&encoder, outPayload, *size, 0);
-
     size_t arrayCount = 0;
     for (OCRepPayload *temp = payload; temp; temp = temp->next)
     {
@@ -597,14 +581,14 @@ static int64_t OCConvertRepPayload(OCRepPayload *payload, uint8_t *outPayload, s
     CborEncoder rootArray;
     if (arrayCount > 1)
     {
-        err |= cbor_encoder_create_array(&encoder, &rootArray, arrayCount);
+        err |= cbor_encoder_create_array(encoder, &rootArray, arrayCount);
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed adding rep root map");
     }
 
-    while (payload != NULL && (err == CborNoError))
+    while (payload != NULL)
     {
         CborEncoder rootMap;
-        err |= cbor_encoder_create_map(((arrayCount == 1)? &encoder: &rootArray),
+        err |= cbor_encoder_create_map(((arrayCount == 1)? encoder: &rootArray),
                                             &rootMap, CborIndefiniteLength);
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed creating root map");
 
@@ -634,30 +618,27 @@ static int64_t OCConvertRepPayload(OCRepPayload *payload, uint8_t *outPayload, s
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting rep payload");
 
         // Close main array
-        err |= cbor_encoder_close_container(((arrayCount == 1) ? &encoder: &rootArray),
+        err |= cbor_encoder_close_container(((arrayCount == 1) ? encoder: &rootArray),
                 &rootMap);
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed closing root map");
         payload = payload->next;
     }
     if (arrayCount > 1)
     {
-        err |= cbor_encoder_close_container(&encoder, &rootArray);
+        err |= cbor_encoder_close_container(encoder, &rootArray);
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed closing root array");
     }
 
 exit:
-    return checkError(err, &encoder, outPayload, size);
+    return err;
 }
 
-static int64_t OCConvertPresencePayload(OCPresencePayload *payload, uint8_t *outPayload,
-        size_t *size)
+static int64_t OCConvertPresencePayload(OCPresencePayload *payload, CborEncoder *encoder)
 {
     int64_t err = CborNoError;
-    CborEncoder encoder;
 
-    cbor_encoder_init(&encoder, outPayload, *size, 0);
     CborEncoder map;
-    err |= cbor_encoder_create_map(&encoder, &map, CborIndefiniteLength);
+    err |= cbor_encoder_create_map(encoder, &map, CborIndefiniteLength);
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed creating presence map");
 
     // Sequence Number
@@ -687,22 +668,23 @@ static int64_t OCConvertPresencePayload(OCPresencePayload *payload, uint8_t *out
     }
 
     // Close Map
-    err |= cbor_encoder_close_container(&encoder, &map);
+    err |= cbor_encoder_close_container(encoder, &map);
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed closing presence map");
 
 exit:
-    return checkError(err, &encoder, outPayload, size);
+    return err;
 }
 
 static int64_t AddTextStringToMap(CborEncoder* map, const char* key, size_t keylen,
         const char* value)
 {
     int64_t err = cbor_encode_text_string(map, key, keylen);
-    if (CborNoError != err)
+    if (CborNoError != err && CborErrorOutOfMemory != err)
     {
         return err;
     }
-    return cbor_encode_text_string(map, value, strlen(value));
+    // keep counting the value when out of memory
+    return err | cbor_encode_text_string(map, value, strlen(value));
 }
 
 static int64_t ConditionalAddTextStringToMap(CborEncoder* map, const char* key, size_t keylen,
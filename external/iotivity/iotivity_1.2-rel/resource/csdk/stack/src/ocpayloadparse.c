@@ -40,13 +40,14 @@
 #define TAG "OIC_RI_PAYLOADPARSE"
 
 static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *arrayVal);
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent, bool isRoot);
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal);
+static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent,
+        bool isRoot, OCPayloadArena *arena);
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal, bool inArena);
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseSecurityPayload(OCPayload **outPayload, const uint8_t *payload, size_t size);
 
-OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
-        const uint8_t *payload, size_t payloadSize)
+static OCStackResult OCParsePayloadInternal(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize, bool inArena)
 {
     OCStackResult result = OC_STACK_MALFORMED_RESPONSE;
     CborError err;
@@ -69,7 +70,7 @@ OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
             result = OCParseDiscoveryPayload(outPayload, &rootValue);
             break;
         case PAYLOAD_TYPE_REPRESENTATION:
-            result = OCParseRepPayload(outPayload, &rootValue);
+            result = OCParseRepPayload(outPayload, &rootValue, inArena);
             break;
         case PAYLOAD_TYPE_PRESENCE:
             result = OCParsePresencePayload(outPayload, &rootValue);
@@ -89,6 +90,18 @@ exit:
     return result;
 }
 
+OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize)
+{
+    return OCParsePayloadInternal(outPayload, payloadType, payload, payloadSize, false);
+}
+
+OCStackResult OCParsePayloadInArena(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize)
+{
+    return OCParsePayloadInternal(outPayload, payloadType, payload, payloadSize, true);
+}
+
 static OCStackResult OCParseSecurityPayload(OCPayload** outPayload, const uint8_t *payload,
         size_t size)
 {
@@ -121,7 +134,90 @@ static char* InPlaceStringTrim(char* str)
     return str;
 }
 
-static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resource)
+/**
+ * Copy a text or byte string into an arena, with a terminating zero.
+ */
+static CborError OCArenaDupString(OCPayloadArena *arena, const CborValue *value, void **buffer,
+        size_t *len)
+{
+    CborError err = cbor_value_calculate_string_length(value, len);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+
+    size_t bufferSize = *len + 1;
+    *buffer = OCPayloadArenaAlloc(arena, bufferSize);
+    if (!*buffer)
+    {
+        return CborErrorOutOfMemory;
+    }
+    if (cbor_value_is_text_string(value))
+    {
+        return cbor_value_copy_text_string(value, (char *)*buffer, &bufferSize, NULL);
+    }
+    return cbor_value_copy_byte_string(value, (uint8_t *)*buffer, &bufferSize, NULL);
+}
+
+/**
+ * Duplicate a text string, into the arena if there is one.
+ */
+static CborError OCParseDupTextString(OCPayloadArena *arena, const CborValue *value, char **str)
+{
+    size_t len = 0;
+    if (arena)
+    {
+        return OCArenaDupString(arena, value, (void **)str, &len);
+    }
+    return cbor_value_dup_text_string(value, str, &len, NULL);
+}
+
+/**
+ * Duplicate a byte string, into the arena if there is one.
+ */
+static CborError OCParseDupByteString(OCPayloadArena *arena, const CborValue *value,
+        OCByteString *byteStr)
+{
+    if (arena)
+    {
+        return OCArenaDupString(arena, value, (void **)&byteStr->bytes, &byteStr->len);
+    }
+    return cbor_value_dup_byte_string(value, &byteStr->bytes, &byteStr->len, NULL);
+}
+
+/**
+ * Append the strings of an arena string, split at spaces, to a list in the arena.
+ */
+static CborError OCArenaAddStringLL(OCPayloadArena *arena, OCStringLL **resource, char *input)
+{
+    OCStringLL **tail = resource;
+    while (*tail)
+    {
+        tail = &(*tail)->next;
+    }
+
+    char *savePtr = NULL;
+    char *curPtr = strtok_r(input, " ", &savePtr);
+    while (curPtr)
+    {
+        char *trimmed = InPlaceStringTrim(curPtr);
+        if (trimmed && strlen(trimmed) > 0)
+        {
+            *tail = (OCStringLL *)OCPayloadArenaAlloc(arena, sizeof(OCStringLL));
+            if (!*tail)
+            {
+                return CborErrorOutOfMemory;
+            }
+            (*tail)->value = trimmed;
+            tail = &(*tail)->next;
+        }
+        curPtr = strtok_r(NULL, " ", &savePtr);
+    }
+    return CborNoError;
+}
+
+static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resource,
+        OCPayloadArena *arena)
 {
     CborValue val;
     CborError err = cbor_value_map_find_value(map, type, &val);
@@ -134,11 +230,15 @@ static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resour
         VERIFY_CBOR_SUCCESS(TAG, err, "to enter container");
         while (cbor_value_is_text_string(&txtStr))
         {
-            size_t len = 0;
             char *input = NULL;
-            err = cbor_value_dup_text_string(&txtStr, &input, &len, NULL);
+            err = OCParseDupTextString(arena, &txtStr, &input);
             VERIFY_CBOR_SUCCESS(TAG, err, "to find StringLL value.");
-            if (input)
+            if (input && arena)
+            {
+                err = OCArenaAddStringLL(arena, resource, input);
+                VERIFY_CBOR_SUCCESS(TAG, err, "to add StringLL value.");
+            }
+            else if (input)
             {
                 char *savePtr = NULL;
                 char *curPtr = strtok_r(input, " ", &savePtr);
@@ -226,7 +326,7 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *
             err = cbor_value_map_find_value(&rootMap, OC_RSRVD_RESOURCE_TYPE, &curVal);
             if (cbor_value_is_valid(&curVal))
             {
-                err = OCParseStringLL(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->type);
+                err = OCParseStringLL(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->type, NULL);
                 VERIFY_CBOR_SUCCESS(TAG, err, "to find resource type");
             }
 
@@ -234,7 +334,7 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *
             err = cbor_value_map_find_value(&rootMap, OC_RSRVD_INTERFACE, &curVal);
             if (cbor_value_is_valid(&curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_INTERFACE, &temp->iface);
+                err =  OCParseStringLL(&rootMap, OC_RSRVD_INTERFACE, &temp->iface, NULL);
                 VERIFY_CBOR_SUCCESS(TAG, err, "to find interface");
             }
 
@@ -271,11 +371,11 @@ static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *
                 VERIFY_CBOR_SUCCESS(TAG, err, "to find href value");
 
                 // ResourceTypes
-                err =  OCParseStringLL(&resourceMap, OC_RSRVD_RESOURCE_TYPE, &resource->types);
+                err =  OCParseStringLL(&resourceMap, OC_RSRVD_RESOURCE_TYPE, &resource->types, NULL);
                 VERIFY_CBOR_SUCCESS(TAG, err, "to find resource type tag/value");
 
                 // Interface Types
-                err =  OCParseStringLL(&resourceMap, OC_RSRVD_INTERFACE, &resource->interfaces);
+                err =  OCParseStringLL(&resourceMap, OC_RSRVD_INTERFACE, &resource->interfaces, NULL);
                 if (CborNoError != err)
                 {
                     if (!OCResourcePayloadAddStringLL(&resource->interfaces, OC_RSRVD_INTERFACE_LL))
@@ -506,14 +606,14 @@ static size_t arrayStep(size_t dimensions[MAX_REP_ARRAY_DEPTH], size_t elementNu
 }
 
 static CborError OCParseArrayFillArray(const CborValue *parent,
-        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray)
+        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray,
+        OCPayloadArena *arena)
 {
     CborValue insideArray;
 
     size_t i = 0;
     char *tempStr = NULL;
     OCByteString ocByteStr = { .bytes = NULL, .len = 0};
-    size_t tempLen = 0;
     OCRepPayload *tempPl = NULL;
 
     size_t newdim[MAX_REP_ARRAY_DEPTH];
@@ -539,7 +639,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_DOUBLE:
@@ -562,7 +662,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((double*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((double*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_BOOL:
@@ -573,39 +673,38 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((bool*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((bool*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = cbor_value_dup_text_string(&insideArray, &tempStr, &tempLen, NULL);
+                        err = OCParseDupTextString(arena, &insideArray, &tempStr);
                         ((char**)targetArray)[i] = tempStr;
                         tempStr = NULL;
                     }
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((char**)targetArray)[arrayStep(dimensions, i)]));
+                            &(((char**)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_BYTE_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = cbor_value_dup_byte_string(&insideArray, &(ocByteStr.bytes),
-                                &(ocByteStr.len), NULL);
+                        err = OCParseDupByteString(arena, &insideArray, &ocByteStr);
                         ((OCByteString*)targetArray)[i] = ocByteStr;
                     }
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                                &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]));
+                                &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_OBJECT:
                     if (dimensions[1] == 0)
                     {
-                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false);
+                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false, arena);
                         ((OCRepPayload**)targetArray)[i] = tempPl;
                         tempPl = NULL;
                         noAdvance = true;
@@ -613,7 +712,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]));
+                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 default:
@@ -635,9 +734,84 @@ exit:
     return err;
 }
 
-static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *container)
+/**
+ * Add a parsed value to a payload, taking ownership of its contents.
+ *
+ * In an arena the value is appended after @p tail without looking for an
+ * existing value of the same name, keys of a CBOR map being unique.
+ */
+static bool OCParseSetValue(OCRepPayload *payload, OCRepPayloadValue ***tail,
+        OCRepPayloadValue *value, OCPayloadArena *arena)
+{
+    if (arena)
+    {
+        OCRepPayloadValue *node = (OCRepPayloadValue *)OCPayloadArenaAlloc(arena,
+                sizeof(OCRepPayloadValue));
+        if (!node)
+        {
+            return false;
+        }
+        *node = *value;
+        node->next = NULL;
+        **tail = node;
+        *tail = &node->next;
+        return true;
+    }
+
+    switch (value->type)
+    {
+        case OCREP_PROP_NULL:
+            return OCRepPayloadSetNull(payload, value->name);
+        case OCREP_PROP_INT:
+            return OCRepPayloadSetPropInt(payload, value->name, value->i);
+        case OCREP_PROP_DOUBLE:
+            return OCRepPayloadSetPropDouble(payload, value->name, value->d);
+        case OCREP_PROP_BOOL:
+            return OCRepPayloadSetPropBool(payload, value->name, value->b);
+        case OCREP_PROP_STRING:
+            return OCRepPayloadSetPropStringAsOwner(payload, value->name, value->str);
+        case OCREP_PROP_BYTE_STRING:
+            return OCRepPayloadSetPropByteStringAsOwner(payload, value->name,
+                    &value->ocByteStr);
+        case OCREP_PROP_OBJECT:
+            return OCRepPayloadSetPropObjectAsOwner(payload, value->name, value->obj);
+        case OCREP_PROP_ARRAY:
+            break;
+        default:
+            return false;
+    }
+
+    switch (value->arr.type)
+    {
+        case OCREP_PROP_INT:
+            return OCRepPayloadSetIntArrayAsOwner(payload, value->name, value->arr.iArray,
+                    value->arr.dimensions);
+        case OCREP_PROP_DOUBLE:
+            return OCRepPayloadSetDoubleArrayAsOwner(payload, value->name, value->arr.dArray,
+                    value->arr.dimensions);
+        case OCREP_PROP_BOOL:
+            return OCRepPayloadSetBoolArrayAsOwner(payload, value->name, value->arr.bArray,
+                    value->arr.dimensions);
+        case OCREP_PROP_STRING:
+            return OCRepPayloadSetStringArrayAsOwner(payload, value->name, value->arr.strArray,
+                    value->arr.dimensions);
+        case OCREP_PROP_BYTE_STRING:
+            return OCRepPayloadSetByteStringArrayAsOwner(payload, value->name,
+                    value->arr.ocByteStrArray, value->arr.dimensions);
+        case OCREP_PROP_OBJECT:
+            return OCRepPayloadSetPropObjectArrayAsOwner(payload, value->name,
+                    value->arr.objArray, value->arr.dimensions);
+        default:
+            OIC_LOG(ERROR, TAG, "Invalid Array type in Parse Array");
+            return false;
+    }
+}
+
+static CborError OCParseArray(OCRepPayload *out, OCRepPayloadValue ***tail, char *name,
+        CborValue *container, OCPayloadArena *arena)
 {
     void *arr = NULL;
+    OCRepPayloadValue value = { .name = name, .type = OCREP_PROP_ARRAY };
 
     OCRepPayloadPropType type = OCREP_PROP_NULL;
     size_t dimensions[MAX_REP_ARRAY_DEPTH] = { 0 };
@@ -650,7 +824,8 @@ static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *co
 
     if (type == OCREP_PROP_NULL)
     {
-        res = OCRepPayloadSetNull(out, name);
+        value.type = OCREP_PROP_NULL;
+        res = OCParseSetValue(out, tail, &value, arena);
         err = (CborError) !res;
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting value");
         container = container + 1;
@@ -659,40 +834,31 @@ static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *co
 
     dimTotal = calcDimTotal(dimensions);
     allocSize = getAllocSize(type);
-    arr = OICCalloc(dimTotal, allocSize);
+    if (arena)
+    {
+        arr = OCPayloadArenaAlloc(arena, dimTotal * allocSize);
+    }
+    else
+    {
+        arr = OICCalloc(dimTotal, allocSize);
+    }
     VERIFY_PARAM_NON_NULL(TAG, arr, "Array Parse allocation failed");
 
-    res = OCParseArrayFillArray(container, dimensions, type, arr);
+    err = OCParseArrayFillArray(container, dimensions, type, arr, arena);
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed parse array");
 
-    switch (type)
-    {
-        case OCREP_PROP_INT:
-            res = OCRepPayloadSetIntArrayAsOwner(out, name, (int64_t *)arr, dimensions);
-            break;
-        case OCREP_PROP_DOUBLE:
-            res = OCRepPayloadSetDoubleArrayAsOwner(out, name, (double *)arr, dimensions);
-            break;
-        case OCREP_PROP_BOOL:
-            res = OCRepPayloadSetBoolArrayAsOwner(out, name, (bool *)arr, dimensions);
-            break;
-        case OCREP_PROP_STRING:
-            res = OCRepPayloadSetStringArrayAsOwner(out, name, (char **)arr, dimensions);
-            break;
-        case OCREP_PROP_BYTE_STRING:
-            res = OCRepPayloadSetByteStringArrayAsOwner(out, name, (OCByteString *)arr, dimensions);
-            break;
-        case OCREP_PROP_OBJECT:
-            res = OCRepPayloadSetPropObjectArrayAsOwner(out, name, (OCRepPayload**)arr, dimensions);
-            break;
-        default:
-            OIC_LOG(ERROR, TAG, "Invalid Array type in Parse Array");
-            break;
-    }
+    value.arr.type = type;
+    memcpy(value.arr.dimensions, dimensions, sizeof(dimensions));
+    value.arr.iArray = (int64_t *)arr;
+    res = OCParseSetValue(out, tail, &value, arena);
     err = (CborError) !res;
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting array parameter");
     return CborNoError;
 exit:
+    if (arena)
+    {
+        return err;
+    }
     if (type == OCREP_PROP_STRING)
     {
         for(size_t i = 0; i < dimTotal; ++i)
@@ -718,7 +884,8 @@ exit:
     return err;
 }
 
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap, bool isRoot)
+static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap,
+        bool isRoot, OCPayloadArena *arena)
 {
     CborError err = CborUnknownError;
     char *name = NULL;
@@ -730,7 +897,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
     {
         if (!*outPayload)
         {
-            *outPayload = OCRepPayloadCreate();
+            *outPayload = arena ? OCRepPayloadCreateInArena(arena) : OCRepPayloadCreate();
             if (!*outPayload)
             {
                 return CborErrorOutOfMemory;
@@ -738,8 +905,12 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
         }
 
         OCRepPayload *curPayload = *outPayload;
+        OCRepPayloadValue **tail = &curPayload->values;
+        while (*tail)
+        {
+            tail = &(*tail)->next;
+        }
 
-        size_t len = 0;
         CborValue repMap;
         err = cbor_value_enter_container(objMap, &repMap);
         VERIFY_CBOR_SUCCESS(TAG, err, "Failed entering repMap");
@@ -748,7 +919,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
         {
             if (cbor_value_is_text_string(&repMap))
             {
-                err = cbor_value_dup_text_string(&repMap, &name, &len, NULL);
+                err = OCParseDupTextString(arena, &repMap, &name);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed finding tag name in the map");
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing rootMap");
@@ -759,68 +930,60 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                     (0 == strcmp(OC_RSRVD_INTERFACE, name))))
                 {
                     err = cbor_value_advance(&repMap);
-                    OICFree(name);
+                    if (!arena)
+                    {
+                        OICFree(name);
+                    }
                     name = NULL;
                     continue;
                 }
             }
+            OCRepPayloadValue value = { .name = name };
             CborType type = cbor_value_get_type(&repMap);
             switch (type)
             {
                 case CborNullType:
-                    res = OCRepPayloadSetNull(curPayload, name);
+                    value.type = OCREP_PROP_NULL;
+                    res = OCParseSetValue(curPayload, &tail, &value, arena);
                     break;
                 case CborIntegerType:
-                    {
-                        int64_t intval = 0;
-                        err = cbor_value_get_int64(&repMap, &intval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
-                        res = OCRepPayloadSetPropInt(curPayload, name, intval);
-                    }
+                    value.type = OCREP_PROP_INT;
+                    err = cbor_value_get_int64(&repMap, &value.i);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
+                    res = OCParseSetValue(curPayload, &tail, &value, arena);
                     break;
                 case CborDoubleType:
-                    {
-                        double doubleval = 0;
-                        err = cbor_value_get_double(&repMap, &doubleval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
-                        res = OCRepPayloadSetPropDouble(curPayload, name, doubleval);
-                    }
+                    value.type = OCREP_PROP_DOUBLE;
+                    err = cbor_value_get_double(&repMap, &value.d);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
+                    res = OCParseSetValue(curPayload, &tail, &value, arena);
                     break;
                 case CborBooleanType:
-                    {
-                        bool boolval = false;
-                        err = cbor_value_get_boolean(&repMap, &boolval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
-                        res = OCRepPayloadSetPropBool(curPayload, name, boolval);
-                    }
+                    value.type = OCREP_PROP_BOOL;
+                    err = cbor_value_get_boolean(&repMap, &value.b);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
+                    res = OCParseSetValue(curPayload, &tail, &value, arena);
                     break;
                 case CborTextStringType:
-                    {
-                        char *strval = NULL;
-                        err = cbor_value_dup_text_string(&repMap, &strval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
-                        res = OCRepPayloadSetPropStringAsOwner(curPayload, name, strval);
-                    }
+                    value.type = OCREP_PROP_STRING;
+                    err = OCParseDupTextString(arena, &repMap, &value.str);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
+                    res = OCParseSetValue(curPayload, &tail, &value, arena);
                     break;
                 case CborByteStringType:
-                    {
-                        uint8_t* bytestrval = NULL;
-                        err = cbor_value_dup_byte_string(&repMap, &bytestrval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
-                        OCByteString tmp = {.bytes = bytestrval, .len = len};
-                        res = OCRepPayloadSetPropByteStringAsOwner(curPayload, name, &tmp);
-                    }
+                    value.type = OCREP_PROP_BYTE_STRING;
+                    err = OCParseDupByteString(arena, &repMap, &value.ocByteStr);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
+                    res = OCParseSetValue(curPayload, &tail, &value, arena);
                     break;
                 case CborMapType:
-                    {
-                        OCRepPayload *pl = NULL;
-                        err = OCParseSingleRepPayload(&pl, &repMap, false);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
-                        res = OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
-                    }
+                    value.type = OCREP_PROP_OBJECT;
+                    err = OCParseSingleRepPayload(&value.obj, &repMap, false, arena);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
+                    res = OCParseSetValue(curPayload, &tail, &value, arena);
                     break;
                 case CborArrayType:
-                    err = OCParseArray(curPayload, name, &repMap);
+                    err = OCParseArray(curPayload, &tail, name, &repMap, arena);
                     break;
                 default:
                     OIC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", repMap.type);
@@ -837,7 +1000,10 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advance repMap");
             }
-            OICFree(name);
+            if (!arena)
+            {
+                OICFree(name);
+            }
             name = NULL;
         }
         if (cbor_value_is_container(objMap))
@@ -849,24 +1015,198 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
     }
 
 exit:
-    OICFree(name);
-    OCRepPayloadDestroy(*outPayload);
+    if (!arena)
+    {
+        OICFree(name);
+        OCRepPayloadDestroy(*outPayload);
+    }
     *outPayload = NULL;
     return err;
 }
 
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
+static CborError OCArenaMeasureMap(const CborValue *map, bool isRoot, size_t *size);
+
+/**
+ * Add to @p size the arena space needed for the contents of a value.
+ */
+static CborError OCArenaMeasureValue(const CborValue *value, bool inArray, size_t *size)
+{
+    CborError err = CborNoError;
+    size_t len = 0;
+
+    switch (cbor_value_get_type(value))
+    {
+        case CborTextStringType:
+        case CborByteStringType:
+            err = cbor_value_calculate_string_length(value, &len);
+            *size += OC_PAYLOAD_ARENA_SIZE(len + 1);
+            break;
+        case CborMapType:
+            err = OCArenaMeasureMap(value, false, size);
+            break;
+        case CborArrayType:
+            {
+                // only the outermost array is allocated, for all its dimensions
+                if (!inArray)
+                {
+                    OCRepPayloadPropType type = OCREP_PROP_NULL;
+                    size_t dimensions[MAX_REP_ARRAY_DEPTH] = { 0 };
+                    if (CborNoError != OCParseArrayFindDimensionsAndType(value, dimensions, &type))
+                    {
+                        // parsing fails on the same array
+                        break;
+                    }
+                    len = calcDimTotal(dimensions) * getAllocSize(type);
+                    *size += OC_PAYLOAD_ARENA_SIZE(len);
+                }
+                CborValue element;
+                err = cbor_value_enter_container(value, &element);
+                while (CborNoError == err && !cbor_value_at_end(&element))
+                {
+                    err = OCArenaMeasureValue(&element, true, size);
+                    if (CborNoError == err)
+                    {
+                        err = cbor_value_advance(&element);
+                    }
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    return err;
+}
+
+/**
+ * Add to @p size the arena space needed for the resource types or interfaces
+ * of a payload, as split by OCParseStringLL.
+ */
+static CborError OCArenaMeasureStringLL(const CborValue *value, size_t *size)
+{
+    CborError err = CborNoError;
+    size_t len = 0;
+
+    if (cbor_value_is_text_string(value))
+    {
+        err = cbor_value_calculate_string_length(value, &len);
+        *size += OC_PAYLOAD_ARENA_SIZE(len + 1) +
+                 (len / 2 + 1) * OC_PAYLOAD_ARENA_SIZE(sizeof(OCStringLL));
+    }
+    else if (cbor_value_is_array(value))
+    {
+        CborValue element;
+        err = cbor_value_enter_container(value, &element);
+        while (CborNoError == err && !cbor_value_at_end(&element))
+        {
+            err = OCArenaMeasureStringLL(&element, size);
+            if (CborNoError == err)
+            {
+                err = cbor_value_advance(&element);
+            }
+        }
+    }
+    return err;
+}
+
+/**
+ * Add to @p size an upper bound of the arena space needed to parse a map,
+ * counting every item of the map as a named value.
+ */
+static CborError OCArenaMeasureMap(const CborValue *map, bool isRoot, size_t *size)
+{
+    CborValue item;
+    bool isStringLL = false;
+
+    *size += OC_PAYLOAD_ARENA_SIZE(sizeof(OCRepPayload));
+    CborError err = cbor_value_enter_container(map, &item);
+    while (CborNoError == err && !cbor_value_at_end(&item))
+    {
+        if (isStringLL)
+        {
+            err = OCArenaMeasureStringLL(&item, size);
+        }
+        isStringLL = false;
+        if (isRoot && cbor_value_is_text_string(&item))
+        {
+            bool isType = false;
+            bool isInterface = false;
+            cbor_value_text_string_equals(&item, OC_RSRVD_RESOURCE_TYPE, &isType);
+            cbor_value_text_string_equals(&item, OC_RSRVD_INTERFACE, &isInterface);
+            isStringLL = isType || isInterface;
+        }
+        *size += OC_PAYLOAD_ARENA_SIZE(sizeof(OCRepPayloadValue));
+        if (CborNoError == err)
+        {
+            err = OCArenaMeasureValue(&item, false, size);
+        }
+        if (CborNoError == err)
+        {
+            err = cbor_value_advance(&item);
+        }
+    }
+    return err;
+}
+
+/**
+ * Create the arena for a representation, sized from the CBOR.
+ *
+ * @return the representation at the start of the arena.
+ */
+static OCRepPayload *OCParseCreateArena(const CborValue *root)
+{
+    size_t size = 0;
+    CborError err = CborNoError;
+
+    if (cbor_value_is_array(root))
+    {
+        CborValue item;
+        err = cbor_value_enter_container(root, &item);
+        while (CborNoError == err && !cbor_value_at_end(&item))
+        {
+            if (cbor_value_is_map(&item))
+            {
+                err = OCArenaMeasureMap(&item, true, &size);
+            }
+            if (CborNoError == err)
+            {
+                err = cbor_value_advance(&item);
+            }
+        }
+    }
+    else if (cbor_value_is_map(root))
+    {
+        err = OCArenaMeasureMap(root, true, &size);
+    }
+    if (CborNoError != err)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to measure the representation");
+        return NULL;
+    }
+
+    return OCRepPayloadCreateWithArena(size);
+}
+
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root, bool inArena)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     CborError err;
     OCRepPayload *temp = NULL;
     OCRepPayload *rootPayload = NULL;
     OCRepPayload *curPayload = NULL;
+    OCRepPayload *arenaRoot = NULL;
+    OCPayloadArena *arena = NULL;
     CborValue rootMap = *root;
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "Invalid Parameter outPayload");
     VERIFY_PARAM_NON_NULL(TAG, root, "Invalid Parameter root");
 
     *outPayload = NULL;
+    if (inArena)
+    {
+        arenaRoot = OCParseCreateArena(root);
+        ret = OC_STACK_NO_MEMORY;
+        VERIFY_PARAM_NON_NULL(TAG, arenaRoot, "Failed allocating arena");
+        arena = arenaRoot->arena;
+    }
     if (cbor_value_is_array(root))
     {
         err = cbor_value_enter_container(root, &rootMap);
@@ -874,7 +1214,14 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
     }
     while (cbor_value_is_valid(&rootMap))
     {
-        temp = OCRepPayloadCreate();
+        if (!arena)
+        {
+            temp = OCRepPayloadCreate();
+        }
+        else
+        {
+            temp = rootPayload ? OCRepPayloadCreateInArena(arena) : arenaRoot;
+        }
         ret = OC_STACK_NO_MEMORY;
         VERIFY_PARAM_NON_NULL(TAG, temp, "Failed allocating memory");
 
@@ -892,8 +1239,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
             VERIFY_CBOR_SUCCESS(TAG, err, "to find href tag");
             if (cbor_value_is_text_string(&curVal))
             {
-                size_t len = 0;
-                err = cbor_value_dup_text_string(&curVal, &temp->uri, &len, NULL);
+                err = OCParseDupTextString(arena, &curVal, &temp->uri);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find uri");
             }
         }
@@ -903,7 +1249,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
         {
             if (CborNoError == cbor_value_map_find_value(&rootMap, OC_RSRVD_RESOURCE_TYPE, &curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->types);
+                err =  OCParseStringLL(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->types, arena);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find rt type tag/value");
             }
         }
@@ -913,14 +1259,14 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
         {
             if (CborNoError == cbor_value_map_find_value(&rootMap, OC_RSRVD_INTERFACE, &curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_INTERFACE, &temp->interfaces);
+                err =  OCParseStringLL(&rootMap, OC_RSRVD_INTERFACE, &temp->interfaces, arena);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find interfaces tag/value");
             }
         }
 
         if (cbor_value_is_map(&rootMap))
         {
-            err = OCParseSingleRepPayload(&temp, &rootMap, true);
+            err = OCParseSingleRepPayload(&temp, &rootMap, true, arena);
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed to parse single rep payload");
         }
 
@@ -941,12 +1287,23 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed to advance single rep payload");
         }
     }
+    if (arena && !rootPayload)
+    {
+        OCRepPayloadDestroy(arenaRoot);
+    }
     *outPayload = (OCPayload *)rootPayload;
     return OC_STACK_OK;
 
 exit:
-    OCRepPayloadDestroy(temp);
-    OCRepPayloadDestroy(rootPayload);
+    if (arena)
+    {
+        OCRepPayloadDestroy(arenaRoot);
+    }
+    else
+    {
+        OCRepPayloadDestroy(temp);
+        OCRepPayloadDestroy(rootPayload);
+    }
     OIC_LOG(ERROR, TAG, "CBOR error in ParseRepPayload");
     return ret;
 }
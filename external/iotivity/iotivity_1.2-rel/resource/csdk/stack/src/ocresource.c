@@ -39,6 +39,7 @@
 
 #include "ocresource.h"
 #include "ocresourcehandler.h"
+#include "ocresourceindex.h"
 #include "ocobserve.h"
 #include "occollection.h"
 #include "oic_malloc.h"
@@ -561,17 +562,25 @@ OCResource *FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    OCResource *pointer = NULL;
+    if (OCResourceIndexUsable())
     {
-        if (strcmp(resourceUri, pointer->uri) == 0)
+        pointer = OCResourceIndexFindUri(resourceUri);
+    }
+    else
+    {
+        // the index could not be allocated, scan the list
+        pointer = headResource;
+        while (pointer && strcmp(resourceUri, pointer->uri) != 0)
         {
-            return pointer;
+            pointer = pointer->next;
         }
-        pointer = pointer->next;
     }
-    OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
-    return NULL;
+    if (!pointer)
+    {
+        OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
+    }
+    return pointer;
 }
 
 OCStackResult DetermineResourceHandling (const OCServerRequest *request,
@@ -808,6 +817,38 @@ static bool includeThisResourceInResponse(OCResource *resource,
            resourceMatchesRTFilter(resource, resourceTypeFilter);
 }
 
+/*
+ * Get the resources that can match the filters from the resource type or the
+ * interface index, the shorter of the two when both filters are present.
+ * Returns false if every resource has to be checked: no filter that the
+ * indexes can answer (oic.if.ll and oic.if.baseline match all the resources),
+ * or the indexes are not usable.
+ */
+static bool getDiscoveryCandidates(const char *interfaceFilter, const char *resourceTypeFilter,
+                                   OCResource * const **resources, size_t *count)
+{
+    OCResource * const *ifResources = NULL;
+    size_t ifCount = 0;
+    bool byType = resourceTypeFilter && *resourceTypeFilter;
+    bool byInterface = interfaceFilter && *interfaceFilter &&
+                       0 != strcmp(interfaceFilter, OC_RSRVD_INTERFACE_LL) &&
+                       0 != strcmp(interfaceFilter, OC_RSRVD_INTERFACE_DEFAULT);
+
+    if (byType && !OCResourceIndexFindType(resourceTypeFilter, resources, count))
+    {
+        return false;
+    }
+    if (byInterface &&
+        OCResourceIndexFindInterface(interfaceFilter, &ifResources, &ifCount) &&
+        (!byType || ifCount < *count))
+    {
+        *resources = ifResources;
+        *count = ifCount;
+        return true;
+    }
+    return byType;
+}
+
 OCStackResult SendNonPersistantDiscoveryResponse(OCServerRequest *request, OCResource *resource,
                                 OCPayload *discoveryPayload, OCEntityHandlerResult ehResult)
 {
@@ -1012,6 +1053,24 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
 #ifdef MQ_BROKER
         prop = (OC_MQ_BROKER_URI == virtualUriInRequest) ? OC_MQ_BROKER : prop;
 #endif
+        OCResource * const *candidates = NULL;
+        size_t candidateCount = 0;
+        if (getDiscoveryCandidates(interfaceQuery, resourceTypeQuery,
+                                   &candidates, &candidateCount))
+        {
+            // Only the resources having the resource type or the interface asked for,
+            // the scan of the whole list below is skipped
+            resource = NULL;
+            for (size_t i = 0; i < candidateCount && discoveryResult == OC_STACK_OK; i++)
+            {
+                if (includeThisResourceInResponse(candidates[i], interfaceQuery,
+                                                  resourceTypeQuery))
+                {
+                    discoveryResult = BuildVirtualResourceResponse(candidates[i], discPayload,
+                                                                   &request->devAddr);
+                }
+            }
+        }
         for (; resource && discoveryResult == OC_STACK_OK; resource = resource->next)
         {
             // This case will handle when no resource type and it is oic.if.ll.
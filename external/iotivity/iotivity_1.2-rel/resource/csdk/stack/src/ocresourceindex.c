@@ -0,0 +1,417 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+
+#include <string.h>
+#include <stdint.h>
+
+#include "ocresourceindex.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "logger.h"
+
+#define TAG "OIC_RI_RESOURCE_INDEX"
+
+/** Initial number of buckets of the URI and handle indexes, a power of 2. */
+#define RESOURCE_INDEX_MIN_BUCKETS   (16)
+
+/** Number of buckets of the resource type and interface indexes. */
+#define NAME_INDEX_BUCKETS           (32)
+
+/**
+ * Resources having a resource type or an interface.
+ */
+typedef struct OCResourceNameEntry
+{
+    char *name;
+    OCResource **resources;
+    size_t count;
+    size_t capacity;
+    struct OCResourceNameEntry *next;
+} OCResourceNameEntry;
+
+/**
+ * Hash table of resources chained through one of their next pointers,
+ * resized to keep about one resource per bucket.
+ */
+typedef struct
+{
+    OCResource **buckets;
+    size_t size;
+    size_t count;
+} OCResourceTable;
+
+static OCResourceTable g_uriIndex;
+static OCResourceTable g_handleIndex;
+
+static OCResourceNameEntry *g_typeIndex[NAME_INDEX_BUCKETS];
+static OCResourceNameEntry *g_interfaceIndex[NAME_INDEX_BUCKETS];
+
+/** Cleared when the URI and handle indexes could not be allocated; lookups then scan the list. */
+static bool g_tablesValid = true;
+
+/** Cleared when an allocation of the name indexes failed; discovery then scans the list. */
+static bool g_namesValid = true;
+
+static size_t hashString(const char *str)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    while (*str)
+    {
+        hash ^= (uint8_t)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static size_t hashPointer(const void *ptr)
+{
+    uintptr_t value = (uintptr_t)ptr;
+
+    return (size_t)(value ^ (value >> 7) ^ (value >> 15));
+}
+
+static size_t uriHash(const OCResource *resource)
+{
+    return hashString(resource->uri);
+}
+
+static OCResource **uriNext(OCResource *resource)
+{
+    return &resource->uriNext;
+}
+
+static size_t handleHash(const OCResource *resource)
+{
+    return hashPointer(resource);
+}
+
+static OCResource **handleNext(OCResource *resource)
+{
+    return &resource->handleNext;
+}
+
+typedef size_t (*ResourceHashFunc)(const OCResource *resource);
+typedef OCResource **(*ResourceNextFunc)(OCResource *resource);
+
+static void tableResize(OCResourceTable *table, size_t size,
+                        ResourceHashFunc hash, ResourceNextFunc next)
+{
+    OCResource **buckets = (OCResource **)OICCalloc(size, sizeof(OCResource *));
+    if (!buckets)
+    {
+        // keep the current buckets, only the chains get longer
+        OIC_LOG(WARNING, TAG, "Failed to grow the resource index");
+        return;
+    }
+
+    for (size_t i = 0; i < table->size; i++)
+    {
+        OCResource *resource = table->buckets[i];
+        while (resource)
+        {
+            OCResource *following = *next(resource);
+            size_t bucket = hash(resource) & (size - 1);
+            *next(resource) = buckets[bucket];
+            buckets[bucket] = resource;
+            resource = following;
+        }
+    }
+
+    OICFree(table->buckets);
+    table->buckets = buckets;
+    table->size = size;
+}
+
+static bool tableAdd(OCResourceTable *table, OCResource *resource,
+                     ResourceHashFunc hash, ResourceNextFunc next)
+{
+    if (table->count >= table->size)
+    {
+        tableResize(table, table->size ? table->size * 2 : RESOURCE_INDEX_MIN_BUCKETS,
+                    hash, next);
+    }
+    if (!table->buckets)
+    {
+        return false;
+    }
+
+    size_t bucket = hash(resource) & (table->size - 1);
+    *next(resource) = table->buckets[bucket];
+    table->buckets[bucket] = resource;
+    table->count++;
+    return true;
+}
+
+static void tableRemove(OCResourceTable *table, OCResource *resource,
+                        ResourceHashFunc hash, ResourceNextFunc next)
+{
+    if (!table->buckets)
+    {
+        return;
+    }
+
+    OCResource **link = &table->buckets[hash(resource) & (table->size - 1)];
+    while (*link)
+    {
+        if (*link == resource)
+        {
+            *link = *next(resource);
+            *next(resource) = NULL;
+            table->count--;
+            return;
+        }
+        link = next(*link);
+    }
+}
+
+static void tableFree(OCResourceTable *table)
+{
+    OICFree(table->buckets);
+    table->buckets = NULL;
+    table->size = 0;
+    table->count = 0;
+}
+
+static OCResourceNameEntry *nameFind(OCResourceNameEntry **index, const char *name)
+{
+    OCResourceNameEntry *entry = index[hashString(name) % NAME_INDEX_BUCKETS];
+
+    while (entry && strcmp(entry->name, name) != 0)
+    {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+static void nameAdd(OCResourceNameEntry **index, OCResource *resource, const char *name)
+{
+    if (!g_namesValid || !name)
+    {
+        return;
+    }
+
+    OCResourceNameEntry *entry = nameFind(index, name);
+    if (!entry)
+    {
+        entry = (OCResourceNameEntry *)OICCalloc(1, sizeof(OCResourceNameEntry));
+        if (!entry || !(entry->name = OICStrdup(name)))
+        {
+            OICFree(entry);
+            goto error;
+        }
+        size_t bucket = hashString(name) % NAME_INDEX_BUCKETS;
+        entry->next = index[bucket];
+        index[bucket] = entry;
+    }
+
+    if (entry->count == entry->capacity)
+    {
+        size_t capacity = entry->capacity ? entry->capacity * 2 : 4;
+        OCResource **resources = (OCResource **)OICRealloc(entry->resources,
+                                                           capacity * sizeof(OCResource *));
+        if (!resources)
+        {
+            goto error;
+        }
+        entry->resources = resources;
+        entry->capacity = capacity;
+    }
+    entry->resources[entry->count++] = resource;
+    return;
+
+error:
+    OIC_LOG(ERROR, TAG, "Failed to index a resource type or interface, falling back to scans");
+    g_namesValid = false;
+}
+
+static void nameRemove(OCResourceNameEntry **index, OCResource *resource, const char *name)
+{
+    OCResourceNameEntry **link = &index[hashString(name) % NAME_INDEX_BUCKETS];
+
+    while (*link && strcmp((*link)->name, name) != 0)
+    {
+        link = &(*link)->next;
+    }
+
+    OCResourceNameEntry *entry = *link;
+    if (!entry)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < entry->count; i++)
+    {
+        if (entry->resources[i] == resource)
+        {
+            entry->count--;
+            memmove(&entry->resources[i], &entry->resources[i + 1],
+                    (entry->count - i) * sizeof(OCResource *));
+            break;
+        }
+    }
+
+    if (!entry->count)
+    {
+        *link = entry->next;
+        OICFree(entry->resources);
+        OICFree(entry->name);
+        OICFree(entry);
+    }
+}
+
+static void nameFreeAll(OCResourceNameEntry **index)
+{
+    for (size_t i = 0; i < NAME_INDEX_BUCKETS; i++)
+    {
+        while (index[i])
+        {
+            OCResourceNameEntry *entry = index[i];
+            index[i] = entry->next;
+            OICFree(entry->resources);
+            OICFree(entry->name);
+            OICFree(entry);
+        }
+    }
+}
+
+static bool nameGet(OCResourceNameEntry **index, const char *name,
+                    OCResource * const **resources, size_t *count)
+{
+    if (!g_namesValid || !name || !resources || !count)
+    {
+        return false;
+    }
+
+    OCResourceNameEntry *entry = nameFind(index, name);
+    *resources = entry ? entry->resources : NULL;
+    *count = entry ? entry->count : 0;
+    return true;
+}
+
+void OCResourceIndexAdd(OCResource *resource)
+{
+    if (!g_tablesValid || !resource || !resource->uri)
+    {
+        return;
+    }
+
+    if (!tableAdd(&g_uriIndex, resource, uriHash, uriNext) ||
+        !tableAdd(&g_handleIndex, resource, handleHash, handleNext))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to index a resource, falling back to scans");
+        g_tablesValid = false;
+        tableFree(&g_uriIndex);
+        tableFree(&g_handleIndex);
+    }
+}
+
+bool OCResourceIndexUsable()
+{
+    return g_tablesValid;
+}
+
+void OCResourceIndexRemove(OCResource *resource)
+{
+    if (!resource)
+    {
+        return;
+    }
+
+    if (resource->uri)
+    {
+        tableRemove(&g_uriIndex, resource, uriHash, uriNext);
+    }
+    tableRemove(&g_handleIndex, resource, handleHash, handleNext);
+
+    for (OCResourceType *type = resource->rsrcType; type; type = type->next)
+    {
+        nameRemove(g_typeIndex, resource, type->resourcetypename);
+    }
+    for (OCResourceInterface *iface = resource->rsrcInterface; iface; iface = iface->next)
+    {
+        nameRemove(g_interfaceIndex, resource, iface->name);
+    }
+}
+
+OCResource *OCResourceIndexFindUri(const char *uri)
+{
+    if (!uri || !g_uriIndex.buckets)
+    {
+        return NULL;
+    }
+
+    OCResource *resource = g_uriIndex.buckets[hashString(uri) & (g_uriIndex.size - 1)];
+    while (resource && strcmp(uri, resource->uri) != 0)
+    {
+        resource = resource->uriNext;
+    }
+    return resource;
+}
+
+bool OCResourceIndexContains(const OCResource *resource)
+{
+    if (!resource || !g_handleIndex.buckets)
+    {
+        return false;
+    }
+
+    // compare the pointers only: the handle can be a stale one
+    OCResource *pointer = g_handleIndex.buckets[hashPointer(resource) & (g_handleIndex.size - 1)];
+    while (pointer && pointer != resource)
+    {
+        pointer = pointer->handleNext;
+    }
+    return pointer != NULL;
+}
+
+void OCResourceIndexAddType(OCResource *resource, const char *name)
+{
+    nameAdd(g_typeIndex, resource, name);
+}
+
+void OCResourceIndexAddInterface(OCResource *resource, const char *name)
+{
+    nameAdd(g_interfaceIndex, resource, name);
+}
+
+bool OCResourceIndexFindType(const char *name, OCResource * const **resources, size_t *count)
+{
+    return nameGet(g_typeIndex, name, resources, count);
+}
+
+bool OCResourceIndexFindInterface(const char *name, OCResource * const **resources,
+                                  size_t *count)
+{
+    return nameGet(g_interfaceIndex, name, resources, count);
+}
+
+void OCResourceIndexTerminate()
+{
+    tableFree(&g_uriIndex);
+    tableFree(&g_handleIndex);
+    nameFreeAll(g_typeIndex);
+    nameFreeAll(g_interfaceIndex);
+    g_tablesValid = true;
+    g_namesValid = true;
+}
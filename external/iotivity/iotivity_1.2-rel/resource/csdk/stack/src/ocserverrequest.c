@@ -38,6 +38,7 @@
 
 #include <coap/utlist.h>
 #include <coap/pdu.h>
+#include "ockeymap.h"
 
 // Module Name
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
@@ -47,6 +48,11 @@
 static struct OCServerRequest * serverRequestList = NULL;
 static struct OCServerResponse * serverResponseList = NULL;
 
+/** Server requests by token, by handle and by address, for the lookups of serverRequestList. */
+static OCKeyMap g_requestsByToken;
+static OCKeyMap g_requestsByHandle;
+static OCKeyMap g_requestsByNode;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
@@ -100,8 +106,14 @@ static void DeleteServerRequest(OCServerRequest * serverRequest)
 {
     if(serverRequest)
     {
-        LL_DELETE(serverRequestList, serverRequest);
+        DL_DELETE(serverRequestList, serverRequest);
+        OCKeyMapRemove(&g_requestsByToken, serverRequest->requestToken,
+                       serverRequest->tokenLength, serverRequest);
+        OCKeyMapRemove(&g_requestsByHandle, &serverRequest->requestId,
+                       sizeof(serverRequest->requestId), serverRequest);
+        OCKeyMapRemove(&g_requestsByNode, &serverRequest, sizeof(serverRequest), serverRequest);
         OICFree(serverRequest->requestToken);
+        OICFree(serverRequest->observeTargets);
         OICFree(serverRequest);
         serverRequest = NULL;
         OIC_LOG(INFO, TAG, "Server Request Removed!!");
@@ -177,6 +189,79 @@ static OCStackResult OCSendResponse(const CAEndpoint_t *object, CAResponseInfo_t
     return OC_STACK_OK;
 }
 
+/**
+ * Send a response to an endpoint. With presence, a response to the default
+ * adapter is sent on all the adapters.
+ *
+ * @param endpoint CA remote endpoint, its adapter is changed with presence.
+ * @param responseInfo CA response info.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendResponseToEndpoint(CAEndpoint_t *endpoint,
+                                            CAResponseInfo_t *responseInfo)
+{
+#ifdef WITH_PRESENCE
+    CATransportAdapter_t CAConnTypes[] = {
+                            CA_ADAPTER_IP,
+                            CA_ADAPTER_GATT_BTLE,
+                            CA_ADAPTER_RFCOMM_BTEDR,
+                            CA_ADAPTER_NFC
+#ifdef RA_ADAPTER
+                            , CA_ADAPTER_REMOTE_ACCESS
+#endif
+                            , CA_ADAPTER_TCP
+                        };
+
+    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+
+    CATransportAdapter_t adapter = endpoint->adapter;
+    // Default adapter, try to send response out on all adapters.
+    if (adapter == CA_DEFAULT_ADAPTER)
+    {
+        adapter =
+            (CATransportAdapter_t)(
+                CA_ADAPTER_IP           |
+                CA_ADAPTER_GATT_BTLE    |
+                CA_ADAPTER_RFCOMM_BTEDR |
+                CA_ADAPTER_NFC
+#ifdef RA_ADAP
+                | CA_ADAPTER_REMOTE_ACCESS
+#endif
+                | CA_ADAPTER_TCP
+            );
+    }
+
+    OCStackResult result = OC_STACK_OK;
+    OCStackResult tempResult = OC_STACK_OK;
+
+    for(size_t i = 0; i < size; i++ )
+    {
+        endpoint->adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
+        if(endpoint->adapter)
+        {
+            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
+            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
+            tempResult = OCSendResponse(endpoint, responseInfo);
+        }
+        if(OC_STACK_OK != tempResult)
+        {
+            result = tempResult;
+        }
+    }
+    return result;
+#else
+
+    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
+    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", endpoint->addr);
+    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", endpoint->adapter);
+    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo->result);
+    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo->info.resourceUri);
+
+    return OCSendResponse(endpoint, responseInfo);
+#endif
+}
+
 //-------------------------------------------------------------------------------------------------
 // Internal APIs
 //-------------------------------------------------------------------------------------------------
@@ -198,21 +283,16 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
         return NULL;
     }
 
-    OCServerRequest * out = NULL;
-    OIC_LOG(INFO, TAG,"Get server request with token");
-    OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
+    OIC_LOG(DEBUG, TAG,"Get server request with token");
+    OIC_LOG_BUFFER(DEBUG, TAG, (const uint8_t *)token, tokenLength);
 
-    OIC_LOG(INFO, TAG,"Found token");
-    LL_FOREACH (serverRequestList, out)
+    OCServerRequest * out = (OCServerRequest *) OCKeyMapFind(&g_requestsByToken, token,
+                                                             tokenLength);
+    if (!out)
     {
-        OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->requestToken, tokenLength);
-        if(memcmp(out->requestToken, token, tokenLength) == 0)
-        {
-            return out;
-        }
+        OIC_LOG(INFO, TAG, "Server Request not found!!");
     }
-    OIC_LOG(INFO, TAG, "Server Request not found!!");
-    return NULL;
+    return out;
 }
 
 /**
@@ -224,16 +304,13 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
  */
 OCServerRequest * GetServerRequestUsingHandle (const OCRequestHandle handle)
 {
-    OCServerRequest * out = NULL;
-    LL_FOREACH (serverRequestList, out)
+    OCServerRequest * out = (OCServerRequest *) OCKeyMapFind(&g_requestsByHandle, &handle,
+                                                             sizeof(handle));
+    if (!out)
     {
-        if(out->requestId == handle)
-        {
-            return out;
-        }
+        OIC_LOG(ERROR, TAG, "Server Request not found!!");
     }
-    OIC_LOG(ERROR, TAG, "Server Request not found!!");
-    return NULL;
+    return out;
 }
 
 /**
@@ -335,14 +412,35 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
 
     serverRequest->devAddr = *devAddr;
 
+    if (OC_STACK_OK != OCKeyMapAdd(&g_requestsByToken, serverRequest->requestToken,
+                                   serverRequest->tokenLength, serverRequest))
+    {
+        goto exit;
+    }
+    if (OC_STACK_OK != OCKeyMapAdd(&g_requestsByHandle, &serverRequest->requestId,
+                                   sizeof(serverRequest->requestId), serverRequest))
+    {
+        goto exit;
+    }
+    if (OC_STACK_OK != OCKeyMapAdd(&g_requestsByNode, &serverRequest, sizeof(serverRequest),
+                                   serverRequest))
+    {
+        goto exit;
+    }
+
     *request = serverRequest;
     OIC_LOG(INFO, TAG, "Server Request Added!!");
-    LL_APPEND (serverRequestList, serverRequest);
+    DL_APPEND (serverRequestList, serverRequest);
     return OC_STACK_OK;
 
 exit:
     if (serverRequest)
     {
+        // removing a value that was not added does nothing
+        OCKeyMapRemove(&g_requestsByToken, serverRequest->requestToken,
+                       serverRequest->tokenLength, serverRequest);
+        OCKeyMapRemove(&g_requestsByHandle, &serverRequest->requestId,
+                       sizeof(serverRequest->requestId), serverRequest);
         OICFree(serverRequest->requestToken);
         OICFree(serverRequest);
         serverRequest = NULL;
@@ -380,7 +478,7 @@ OCStackResult FormOCEntityHandlerRequest(
 
         if(payload && payloadSize)
         {
-            if(OCParsePayload(&entityHandlerRequest->payload, payloadType,
+            if(OCParseReceivedPayload(&entityHandlerRequest->payload, payloadType,
                         payload, payloadSize) != OC_STACK_OK)
             {
                 return OC_STACK_ERROR;
@@ -407,17 +505,11 @@ OCStackResult FormOCEntityHandlerRequest(
  */
 void FindAndDeleteServerRequest(OCServerRequest * serverRequest)
 {
-    OCServerRequest* tmp;
-    if(serverRequest)
+    // the request can be a stale one, only its address is compared
+    if(serverRequest &&
+       OCKeyMapFind(&g_requestsByNode, &serverRequest, sizeof(serverRequest)))
     {
-        LL_FOREACH(serverRequestList, tmp)
-        {
-            if (serverRequest == tmp)
-            {
-                DeleteServerRequest(tmp);
-                return;
-            }
-        }
+        DeleteServerRequest(serverRequest);
     }
 }
 
@@ -680,64 +772,28 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         }
     }
 
-#ifdef WITH_PRESENCE
-    CATransportAdapter_t CAConnTypes[] = {
-                            CA_ADAPTER_IP,
-                            CA_ADAPTER_GATT_BTLE,
-                            CA_ADAPTER_RFCOMM_BTEDR,
-                            CA_ADAPTER_NFC
-#ifdef RA_ADAPTER
-                            , CA_ADAPTER_REMOTE_ACCESS
-#endif
-                            , CA_ADAPTER_TCP
-                        };
-
-    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+    result = SendResponseToEndpoint(&responseEndpoint, &responseInfo);
 
-    CATransportAdapter_t adapter = responseEndpoint.adapter;
-    // Default adapter, try to send response out on all adapters.
-    if (adapter == CA_DEFAULT_ADAPTER)
+    // The other observers of the group get the same encoded payload; only the
+    // endpoint, the token and the message type differ. CA copies the message
+    // when it is queued, so the buffers can be reused for the next observer.
+    for (uint16_t i = 0; i < serverRequest->numObserveTargets; i++)
     {
-        adapter =
-            (CATransportAdapter_t)(
-                CA_ADAPTER_IP           |
-                CA_ADAPTER_GATT_BTLE    |
-                CA_ADAPTER_RFCOMM_BTEDR |
-                CA_ADAPTER_NFC
-#ifdef RA_ADAP
-                | CA_ADAPTER_REMOTE_ACCESS
-#endif
-                | CA_ADAPTER_TCP
-            );
-    }
+        OCObserveTarget *target = &serverRequest->observeTargets[i];
 
-    result = OC_STACK_OK;
-    OCStackResult tempResult = OC_STACK_OK;
+        CopyDevAddrToEndpoint(&target->devAddr, &responseEndpoint);
+        memcpy(responseInfo.info.token, target->token, target->tokenLength);
+        responseInfo.info.tokenLength = target->tokenLength;
+        responseInfo.info.type = (target->qos == OC_HIGH_QOS) ? CA_MSG_CONFIRM
+                                                               : CA_MSG_NONCONFIRM;
+        // To assign new messageId in CA.
+        responseInfo.info.messageId = 0;
 
-    for(size_t i = 0; i < size; i++ )
-    {
-        responseEndpoint.adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
-        if(responseEndpoint.adapter)
+        if (OC_STACK_OK != SendResponseToEndpoint(&responseEndpoint, &responseInfo))
         {
-            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
-            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
-            tempResult = OCSendResponse(&responseEndpoint, &responseInfo);
-        }
-        if(OC_STACK_OK != tempResult)
-        {
-            result = tempResult;
+            result = OC_STACK_ERROR;
         }
     }
-#else
-
-    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
-    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint.addr);
-    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint.adapter);
-    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo.result);
-    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo.info.resourceUri);
-
-    result = OCSendResponse(&responseEndpoint, &responseInfo);
-#endif
 
     OICFree(responseInfo.info.payload);
     OICFree(responseInfo.info.options);
@@ -44,6 +44,7 @@
 #include "ocstack.h"
 #include "ocstackinternal.h"
 #include "ocresourcehandler.h"
+#include "ocresourceindex.h"
 #include "occlientcb.h"
 #include "ocobserve.h"
 #include "ocrandom.h"
@@ -133,12 +134,17 @@ static uint32_t PresenceTimeOut[] = {50, 75, 85, 95, 100};
 #endif
 
 static OCMode myStackMode;
+static bool gPayloadArena = false;
 #ifdef RA_ADAPTER
 //TODO: revisit this design
 static bool gRASetInfo = false;
 #endif
 OCDeviceEntityHandler defaultDeviceHandler;
 void* defaultDeviceHandlerCallbackParameter = NULL;
+#ifdef WITH_BWT
+static OCBlockStreamHandler gBlockStreamHandler = NULL;
+static void *gBlockStreamHandlerParameter = NULL;
+#endif
 static const char COAP_TCP_SCHEME[] = "coap+tcp:";
 static const char COAPS_TCP_SCHEME[] = "coaps+tcp:";
 static const char CORESPEC[] = "core";
@@ -1503,7 +1509,7 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                 // In case of error, still want application to receive the error message.
                 if (OCResultToSuccess(response.result) || PAYLOAD_TYPE_REPRESENTATION == type)
                 {
-                    if(OC_STACK_OK != OCParsePayload(&response.payload,
+                    if(OC_STACK_OK != OCParseReceivedPayload(&response.payload,
                             type,
                             responseInfo->info.payload,
                             responseInfo->info.payloadSize))
@@ -1628,8 +1634,8 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                 else
                 {
                     // To keep discovery callbacks active.
-                    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
-                                            MILLISECONDS_PER_SECOND);
+                    SetClientCBTTL(cbNode, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                    MILLISECONDS_PER_SECOND));
                 }
             }
 
@@ -3360,6 +3366,17 @@ OCStackResult OCProcess()
     return OC_STACK_OK;
 }
 
+OCStackResult OCProcessWait(uint32_t timeout)
+{
+    if (stackState == OC_STACK_UNINITIALIZED)
+    {
+        OIC_LOG(ERROR, TAG, "OCProcessWait has failed. ocstack is not initialized");
+        return OC_STACK_ERROR;
+    }
+
+    return CAResultToOCResult(CAWaitRequestResponse(timeout));
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OCStartPresence(const uint32_t ttl)
 {
@@ -3450,6 +3467,51 @@ OCStackResult OCSetDefaultDeviceEntityHandler(OCDeviceEntityHandler entityHandle
     return OC_STACK_OK;
 }
 
+OCStackResult OCSetPayloadArena(bool enabled)
+{
+    gPayloadArena = enabled;
+
+    return OC_STACK_OK;
+}
+
+#ifdef WITH_BWT
+static bool HandleCABlockStream(const CAEndpoint_t *endpoint, const CAToken_t token,
+                                uint8_t tokenLength, size_t offset,
+                                const uint8_t *data, size_t dataLength)
+{
+    OCBlockStreamHandler streamHandler = gBlockStreamHandler;
+    if (!streamHandler || !endpoint)
+    {
+        return false;
+    }
+
+    OCDevAddr devAddr;
+    CopyEndpointToDevAddr(endpoint, &devAddr);
+    return streamHandler(&devAddr, (const uint8_t *) token, tokenLength, offset,
+                         data, dataLength, gBlockStreamHandlerParameter);
+}
+
+OCStackResult OCSetBlockStreamHandler(OCBlockStreamHandler streamHandler,
+                                      void *callbackParameter)
+{
+    gBlockStreamHandlerParameter = callbackParameter;
+    gBlockStreamHandler = streamHandler;
+    CARegisterBlockStreamHandler(streamHandler ? HandleCABlockStream : NULL);
+
+    return OC_STACK_OK;
+}
+#endif
+
+OCStackResult OCParseReceivedPayload(OCPayload **outPayload, OCPayloadType type,
+                                     const uint8_t *payload, size_t payloadSize)
+{
+    if (gPayloadArena)
+    {
+        return OCParsePayloadInArena(outPayload, type, payload, payloadSize);
+    }
+    return OCParsePayload(outPayload, type, payload, payloadSize);
+}
+
 OCStackResult OCCreateResource(OCResourceHandle *handle,
         const char *resourceTypeName,
         const char *resourceInterfaceName,
@@ -3504,21 +3566,12 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    if (OCResourceIndexUsable() ? OCResourceIndexFindUri(uri) != NULL
+                                : FindResourceByUri(uri) != NULL)
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
@@ -3538,6 +3591,7 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         result = OC_STACK_NO_MEMORY;
         goto exit;
     }
+    OCResourceIndexAdd(pointer);
 
     // Set properties.  Set OC_ACTIVE
     pointer->resourceProperties = (OCResourceProperty) (resourceProperties
@@ -4477,17 +4531,18 @@ void insertResource(OCResource *resource)
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
+    if (OCResourceIndexUsable())
+    {
+        return OCResourceIndexContains(resource) ? resource : NULL;
+    }
 
-    while (pointer)
+    // the index could not be allocated, scan the list
+    OCResource *pointer = headResource;
+    while (pointer && pointer != resource)
     {
-        if (pointer == resource)
-        {
-            return resource;
-        }
         pointer = pointer->next;
     }
-    return NULL;
+    return pointer;
 }
 
 void deleteAllResources()
@@ -4522,6 +4577,8 @@ void deleteAllResources()
     deleteResource((OCResource *) presenceResource.handle);
     memset(&presenceResource, 0, sizeof(presenceResource));
 #endif // WITH_PRESENCE
+
+    OCResourceIndexTerminate();
 }
 
 OCStackResult deleteResource(OCResource *resource)
@@ -4579,6 +4636,8 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            DeleteObserversUsingResource(temp);
+            OCResourceIndexRemove(temp);
             deleteResourceElements(temp);
             OICFree(temp);
             return OC_STACK_OK;
@@ -4735,6 +4794,7 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
         }
     }
     resourceType->next = NULL;
+    OCResourceIndexAddType(resource, resourceType->resourcetypename);
 
     OIC_LOG_V(INFO, TAG, "Added type %s to %s", resourceType->resourcetypename, resource->uri);
 }
@@ -4860,6 +4920,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
             previous->next = newInterface;
         }
     }
+    OCResourceIndexAddInterface(resource, newInterface->name);
 }
 
 OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
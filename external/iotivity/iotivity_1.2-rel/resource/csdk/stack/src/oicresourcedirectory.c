@@ -70,16 +70,65 @@ static void errorCallback(void *arg, int errCode, const char *errMsg)
     OIC_LOG_V(ERROR, TAG, "SQLLite Error: %s : %d", errMsg, errCode);
 }
 
+/**
+ * Discovery statements, prepared on first use and kept with the database handle.
+ */
+typedef enum
+{
+    RD_SELECT_LINKS_BY_RT = 0,
+    RD_SELECT_LINKS_BY_IF,
+    RD_SELECT_LINK_RT,
+    RD_SELECT_LINK_IF,
+    RD_SELECT_DEVICE,
+    RD_STATEMENT_COUNT
+} RDStatement;
+
+// rt and if are compared with = rather than LIKE so that their indexes are used,
+// they are matched exactly by the discovery of local resources too.
+static const char *gRDStatementSql[RD_STATEMENT_COUNT] =
+{
+    "SELECT * FROM RD_DEVICE_LINK_LIST INNER JOIN RD_LINK_RT ON "     "RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID WHERE RD_LINK_RT.rt = ? ",
+    "SELECT * FROM RD_DEVICE_LINK_LIST INNER JOIN RD_LINK_IF ON "     "RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID WHERE RD_LINK_IF.if = ? ",
+    "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=?",
+    "SELECT if FROM RD_LINK_IF WHERE LINK_ID=?",
+    "SELECT di, address FROM RD_DEVICE_LIST INNER JOIN RD_DEVICE_LINK_LIST ON "     "RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=?"
+};
+
+static sqlite3_stmt *gRDStatements[RD_STATEMENT_COUNT];
+
+static int prepareStatement(RDStatement statement, sqlite3_stmt **stmt)
+{
+    if (!gRDStatements[statement])
+    {
+        int res = sqlite3_prepare_v2(gRDDB, gRDStatementSql[statement], -1,
+                                     &gRDStatements[statement], NULL);
+        if (SQLITE_OK != res)
+        {
+            return res;
+        }
+    }
+
+    *stmt = gRDStatements[statement];
+    sqlite3_reset(*stmt);
+    return sqlite3_clear_bindings(*stmt);
+}
+
 static OCStackResult initializeDatabase(const char *path)
 {
+    if (gRDDB)
+    {
+        return OC_STACK_OK;
+    }
+
     if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
     {
         OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
     }
 
-    sqlite3_open_v2(!path ? RD_PATH : path, &gRDDB, SQLITE_OPEN_READONLY, NULL);
-    if (!gRDDB)
+    if (SQLITE_OK != sqlite3_open_v2(!path ? RD_PATH : path, &gRDDB, SQLITE_OPEN_READONLY, NULL))
     {
+        sqlite3_close(gRDDB);
+        gRDDB = NULL;
         return OC_STACK_ERROR;
     }
     return OC_STACK_OK;
@@ -132,10 +181,7 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
     if (resourceType)
     {
         sqlite3_stmt *stmt = 0;
-        const char *input = "SELECT * FROM RD_DEVICE_LINK_LIST INNER JOIN RD_LINK_RT ON " \
-        "RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID WHERE RD_LINK_RT.rt LIKE ? ";
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, -1, &stmt, NULL));
+        VERIFY_SQLITE(prepareStatement(RD_SELECT_LINKS_BY_RT, &stmt));
         VERIFY_SQLITE(sqlite3_bind_text(stmt, 1, resourceType, strlen(resourceType) + 1, SQLITE_STATIC));
 
         int res = sqlite3_step (stmt);
@@ -156,8 +202,7 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
             VERIFY_SQLITE(res);
 
             sqlite3_stmt *stmtRT = 0;
-            const char *rt = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=?";
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, -1, &stmtRT, NULL));
+            VERIFY_SQLITE(prepareStatement(RD_SELECT_LINK_RT, &stmtRT));
             VERIFY_SQLITE(sqlite3_bind_int(stmtRT, 1, id));
             while (SQLITE_ROW == sqlite3_step(stmtRT))
             {
@@ -166,8 +211,7 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
             }
 
             sqlite3_stmt *stmtIF = 0;
-            const char *itf = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=?";
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, -1, &stmtIF, NULL));
+            VERIFY_SQLITE(prepareStatement(RD_SELECT_LINK_IF, &stmtIF));
             VERIFY_SQLITE(sqlite3_bind_int(stmtIF, 1, id));
             while (SQLITE_ROW == sqlite3_step(stmtIF))
             {
@@ -178,11 +222,8 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
             resourcePayload->bitmap = bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE);
             resourcePayload->secure = (bitmap & OC_SECURE) != 0;
 
-            const char *address = "SELECT di, address FROM RD_DEVICE_LIST INNER JOIN RD_DEVICE_LINK_LIST ON " \
-            "RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=?";
-
             sqlite3_stmt *stmt1 = 0;
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, address, -1, &stmt1, NULL));
+            VERIFY_SQLITE(prepareStatement(RD_SELECT_DEVICE, &stmt1));
             VERIFY_SQLITE(sqlite3_bind_int(stmt1, 1, deviceId));
             // TODO: Right now, we have a bug where discovery payload can only send one device information.
             res = sqlite3_step(stmt1);
@@ -194,16 +235,15 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
                 (discPayload)->baseURI = OICStrdup((char *)address);
                 (discPayload)->sid = OICStrdup((char *)di);
             }
+            // release the read lock until the statement is used again
+            sqlite3_reset(stmt1);
             OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
         }
     }
     if (interfaceType)
     {
         sqlite3_stmt *stmt = 0;
-        const char *input = "SELECT * FROM RD_DEVICE_LINK_LIST INNER JOIN RD_LINK_IF ON " \
-        "RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID WHERE RD_LINK_IF.if LIKE ? ";
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, -1, &stmt, NULL));
+        VERIFY_SQLITE(prepareStatement(RD_SELECT_LINKS_BY_IF, &stmt));
         VERIFY_SQLITE(sqlite3_bind_text(stmt, 1, interfaceType, strlen(interfaceType) + 1, SQLITE_STATIC));
 
         int res = sqlite3_step (stmt);
@@ -223,8 +263,7 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
             VERIFY_SQLITE(sqlite3_reset(stmt));
 
             sqlite3_stmt *stmtRT = 0;
-            const char *rt = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=?";
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, -1, &stmtRT, NULL));
+            VERIFY_SQLITE(prepareStatement(RD_SELECT_LINK_RT, &stmtRT));
             VERIFY_SQLITE(sqlite3_bind_int(stmtRT, 1, id));
             while (SQLITE_ROW == sqlite3_step(stmtRT))
             {
@@ -233,8 +272,7 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
             }
 
             sqlite3_stmt *stmtIF = 0;
-            const char *itf = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=?";
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, -1, &stmtIF, NULL));
+            VERIFY_SQLITE(prepareStatement(RD_SELECT_LINK_IF, &stmtIF));
             VERIFY_SQLITE(sqlite3_bind_int(stmtIF, 1, id));
             while (SQLITE_ROW == sqlite3_step (stmtIF))
             {
@@ -245,11 +283,8 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
             resourcePayload->bitmap = bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE);
             resourcePayload->secure = ((bitmap & OC_SECURE) != 0);
 
-            const char *address = "SELECT di, address FROM RD_DEVICE_LIST INNER JOIN RD_DEVICE_LINK_LIST ON " \
-            "RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=?";
-
             sqlite3_stmt *stmt1 = 0;
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, address, -1, &stmt1, NULL));
+            VERIFY_SQLITE(prepareStatement(RD_SELECT_DEVICE, &stmt1));
             VERIFY_SQLITE(sqlite3_bind_int(stmt1, 1, deviceId));
 
             res = sqlite3_step(stmt1);
@@ -261,6 +296,8 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
                 (discPayload)->baseURI = OICStrdup((char *)address);
                 (discPayload)->sid = OICStrdup((char *)di);
             }
+            // release the read lock until the statement is used again
+            sqlite3_reset(stmt1);
             OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
         }
     }
@@ -26,6 +26,7 @@ extern "C"
     #include "ocpayloadcbor.h"
     #include "logger.h"
     #include "oic_malloc.h"
+    #include "oic_string.h"
 }
 
 #include "gtest/gtest.h"
@@ -44,7 +45,9 @@ extern "C"
 #include <stdio.h>
 #include <string.h>
 
+#include <chrono>
 #include <iostream>
+#include <string>
 #include <stdint.h>
 
 #include "gtest_helper.h"
@@ -222,3 +225,385 @@ TEST_F(CborByteStringTest, ByteStringArrayConvertParseTest )
 
     OCPayloadDestroy((OCPayload*)payload_out);
 }
+
+static OCDiscoveryPayload* CreateDiscoveryPayload(size_t resourceCount)
+{
+    OCDiscoveryPayload* payload = OCDiscoveryPayloadCreate();
+    payload->sid = OICStrdup("88b7c7f0-4b51-4e0a-9faa-cfb439fd7f49");
+
+    for (size_t i = 0; i < resourceCount; i++)
+    {
+        char uri[32];
+        snprintf(uri, sizeof(uri), "/a/light/%zu", i);
+
+        OCResourcePayload* res = (OCResourcePayload*)OICCalloc(1, sizeof(OCResourcePayload));
+        res->uri = OICStrdup(uri);
+        OCResourcePayloadAddStringLL(&res->types, "core.light");
+        OCResourcePayloadAddStringLL(&res->interfaces, "oic.if.baseline");
+        res->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+        res->port = 5683;
+        OCDiscoveryPayloadAddNewResource(payload, res);
+    }
+    return payload;
+}
+
+static OCRepPayload* CreateRepPayload(size_t valueCount)
+{
+    OCRepPayload* payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, "/a/sensor");
+
+    for (size_t i = 0; i < valueCount; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "value%zu", i);
+        OCRepPayloadSetPropInt(payload, name, (int64_t)i);
+    }
+    return payload;
+}
+
+// size of the buffer on the stack OCConvertPayload encodes into first
+#define ENCODE_INIT_SIZE 255
+
+static void CheckEncodedSize(OCPayload* payload, size_t* outSize = NULL)
+{
+    uint8_t* cbor = NULL;
+    size_t cborSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload(payload, &cbor, &cborSize));
+    if (outSize)
+    {
+        *outSize = cborSize;
+    }
+
+    // encoded into a buffer of the exact size: one CBOR item, nothing after it
+    CborParser parser;
+    CborValue value;
+    ASSERT_EQ(CborNoError, cbor_parser_init(cbor, cborSize, 0, &parser, &value));
+    EXPECT_EQ(CborNoError, cbor_value_advance(&value));
+    EXPECT_EQ(cbor + cborSize, cbor_value_get_next_byte(&value));
+
+    OICFree(cbor);
+}
+
+TEST(CborEncodeTest, DiscoveryPayloadEncodedSize)
+{
+    OCDiscoveryPayload* payload = CreateDiscoveryPayload(100);
+    CheckEncodedSize((OCPayload*)payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborEncodeTest, RepPayloadEncodedSize)
+{
+    OCRepPayload* payload = CreateRepPayload(100);
+    CheckEncodedSize((OCPayload*)payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborEncodeTest, SmallRepPayloadEncodedSize)
+{
+    OCRepPayload* payload = CreateRepPayload(2);
+    size_t cborSize = 0;
+    CheckEncodedSize((OCPayload*)payload, &cborSize);
+    EXPECT_LT(cborSize, (size_t)ENCODE_INIT_SIZE);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborEncodeTest, LargeRepPayloadEncodedSize)
+{
+    OCRepPayload* payload = CreateRepPayload(2);
+    std::string text(4 * ENCODE_INIT_SIZE, 'x');
+    OCRepPayloadSetPropString(payload, "text", text.c_str());
+
+    size_t cborSize = 0;
+    CheckEncodedSize((OCPayload*)payload, &cborSize);
+    EXPECT_GT(cborSize, (size_t)ENCODE_INIT_SIZE);
+
+    // encoded once into the exact size, still parses back whole
+    uint8_t* cbor = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &cbor, &cborSize));
+    OCPayload* parsed = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&parsed, PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize));
+    char* parsedText = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropString((OCRepPayload*)parsed, "text", &parsedText));
+    EXPECT_STREQ(text.c_str(), parsedText);
+
+    OICFree(parsedText);
+    OCPayloadDestroy(parsed);
+    OICFree(cbor);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborEncodeTest, BatchedRepPayloadEncodedSize)
+{
+    // a small batch fitting the initial buffer, and a large one past it
+    const size_t counts[] = { 2, 50 };
+    for (size_t count : counts)
+    {
+        OCRepPayload* payload = CreateRepPayload(count);
+        OCRepPayloadAppend(payload, CreateRepPayload(count));
+        OCRepPayloadAppend(payload, CreateRepPayload(count));
+
+        size_t cborSize = 0;
+        CheckEncodedSize((OCPayload*)payload, &cborSize);
+        if (count > 2)
+        {
+            EXPECT_GT(cborSize, (size_t)ENCODE_INIT_SIZE);
+        }
+
+        uint8_t* cbor = NULL;
+        ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &cbor, &cborSize));
+        OCPayload* parsed = NULL;
+        ASSERT_EQ(OC_STACK_OK, OCParsePayload(&parsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cbor, cborSize));
+        size_t reps = 0;
+        for (OCRepPayload* rep = (OCRepPayload*)parsed; rep; rep = rep->next)
+        {
+            int64_t value = 0;
+            EXPECT_TRUE(OCRepPayloadGetPropInt(rep, "value1", &value));
+            EXPECT_EQ(1, value);
+            reps++;
+        }
+        EXPECT_EQ((size_t)3, reps);
+
+        OCPayloadDestroy(parsed);
+        OICFree(cbor);
+        OCPayloadDestroy((OCPayload*)payload);
+    }
+}
+
+static void BenchmarkEncode(const char* name, OCPayload* payload)
+{
+    const int iterations = 1000;
+    size_t cborSize = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        uint8_t* cbor = NULL;
+        ASSERT_EQ(OC_STACK_OK, OCConvertPayload(payload, &cbor, &cborSize));
+        OICFree(cbor);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << cborSize << " bytes, "
+              << elapsed.count() / iterations << " us per encoding" << std::endl;
+}
+
+TEST(CborEncodeTest, DiscoveryPayloadEncodeTime)
+{
+    OCDiscoveryPayload* payload = CreateDiscoveryPayload(100);
+    BenchmarkEncode("discovery, 100 resources", (OCPayload*)payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborEncodeTest, RepPayloadEncodeTime)
+{
+    OCRepPayload* payload = CreateRepPayload(100);
+    BenchmarkEncode("representation, 100 values", (OCPayload*)payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+static OCRepPayload* CreateNestedRepPayload()
+{
+    OCRepPayload* payload = CreateRepPayload(10);
+    OCRepPayloadAddResourceType(payload, "core.light core.brightlight");
+    OCRepPayloadAddInterface(payload, "oic.if.baseline");
+    OCRepPayloadSetPropString(payload, "name", "light");
+    OCRepPayloadSetPropDouble(payload, "level", 0.5);
+    OCRepPayloadSetPropBool(payload, "power", true);
+    OCRepPayloadSetNull(payload, "none");
+
+    uint8_t bytes[] = { 0x00, 0x01, 0x02, 0x03 };
+    OCByteString byteString = { bytes, sizeof(bytes) };
+    OCRepPayloadSetPropByteString(payload, "bytes", byteString);
+
+    OCRepPayload* child = OCRepPayloadCreate();
+    OCRepPayloadSetPropString(child, "state", "on");
+    OCRepPayloadSetPropInt(child, "count", 3);
+    OCRepPayloadSetPropObject(payload, "child", child);
+
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = { 2, 3, 0 };
+    const char* strings[] = { "a", "bb", "ccc", "dddd", "", "f" };
+    OCRepPayloadSetStringArray(payload, "strings", strings, dimensions);
+
+    int64_t ints[] = { 1, 2, 3, 4, 5, 6 };
+    OCRepPayloadSetIntArray(payload, "ints", ints, dimensions);
+
+    size_t byteDimensions[MAX_REP_ARRAY_DEPTH] = { 2, 0, 0 };
+    OCByteString byteStrings[] = { byteString, { bytes, 1 } };
+    OCRepPayloadSetByteStringArray(payload, "byteStrings", byteStrings, byteDimensions);
+
+    const OCRepPayload* children[] = { child, child };
+    OCRepPayloadSetPropObjectArray(payload, "children", children, byteDimensions);
+    OCRepPayloadDestroy(child);
+
+    OCRepPayload* next = CreateRepPayload(3);
+    OCRepPayloadSetUri(next, "/a/next");
+    OCRepPayloadAppend(payload, next);
+    return payload;
+}
+
+static void CheckArenaParse(OCRepPayload* payload)
+{
+    uint8_t* cbor = NULL;
+    size_t cborSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &cbor, &cborSize));
+
+    OCPayload* heap = NULL;
+    OCPayload* arena = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&heap, PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize));
+    EXPECT_EQ(OC_STACK_OK, OCParsePayloadInArena(&arena, PAYLOAD_TYPE_REPRESENTATION,
+                cbor, cborSize));
+    ASSERT_TRUE(heap != NULL);
+    ASSERT_TRUE(arena != NULL);
+    EXPECT_TRUE(((OCRepPayload*)heap)->arena == NULL);
+    EXPECT_TRUE(((OCRepPayload*)arena)->arena != NULL);
+
+    // both parse the same representation
+    uint8_t* heapCbor = NULL;
+    uint8_t* arenaCbor = NULL;
+    size_t heapSize = 0;
+    size_t arenaSize = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload(heap, &heapCbor, &heapSize));
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload(arena, &arenaCbor, &arenaSize));
+    ASSERT_EQ(heapSize, arenaSize);
+    EXPECT_EQ(0, memcmp(heapCbor, arenaCbor, heapSize));
+
+    OICFree(heapCbor);
+    OICFree(arenaCbor);
+    OCPayloadDestroy(heap);
+    OCPayloadDestroy(arena);
+    OICFree(cbor);
+}
+
+TEST(CborArenaTest, ParseRepPayload)
+{
+    OCRepPayload* payload = CreateRepPayload(100);
+    CheckArenaParse(payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborArenaTest, ParseNestedRepPayload)
+{
+    OCRepPayload* payload = CreateNestedRepPayload();
+    CheckArenaParse(payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborArenaTest, ChangeParsedRepPayload)
+{
+    OCRepPayload* payload = CreateNestedRepPayload();
+    uint8_t* cbor = NULL;
+    size_t cborSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &cbor, &cborSize));
+    OCPayloadDestroy((OCPayload*)payload);
+
+    OCPayload* parsed = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayloadInArena(&parsed, PAYLOAD_TYPE_REPRESENTATION,
+                cbor, cborSize));
+    OICFree(cbor);
+
+    OCRepPayload* rep = (OCRepPayload*)parsed;
+    EXPECT_TRUE(OCRepPayloadIsNull(rep, "none"));
+    EXPECT_TRUE(OCRepPayloadSetPropString(rep, "name", "lamp"));
+    EXPECT_TRUE(OCRepPayloadSetPropInt(rep, "strings", 1));
+    EXPECT_TRUE(OCRepPayloadSetPropInt(rep, "added", 7));
+    EXPECT_TRUE(OCRepPayloadSetUri(rep, "/a/lamp"));
+    EXPECT_TRUE(OCRepPayloadAddResourceType(rep, "core.lamp"));
+
+    OCRepPayload* child = OCRepPayloadCreate();
+    OCRepPayloadSetPropString(child, "state", "off");
+    EXPECT_TRUE(OCRepPayloadSetPropObjectAsOwner(rep, "child", child));
+
+    char* name = NULL;
+    int64_t value = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropString(rep, "name", &name));
+    EXPECT_STREQ("lamp", name);
+    EXPECT_TRUE(OCRepPayloadGetPropInt(rep, "strings", &value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(OCRepPayloadGetPropInt(rep, "added", &value));
+    EXPECT_EQ(7, value);
+    EXPECT_STREQ("/a/lamp", rep->uri);
+    OICFree(name);
+
+    OCPayloadDestroy(parsed);
+}
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+// OICMalloc and friends are the C library functions, these count their calls
+static bool g_countAllocations = false;
+static size_t g_allocations = 0;
+
+extern "C" void* malloc(size_t size) __THROW
+{
+    g_allocations += g_countAllocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) __THROW
+{
+    g_allocations += g_countAllocations;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) __THROW
+{
+    g_allocations += g_countAllocations;
+    return __libc_realloc(ptr, size);
+}
+
+static size_t CountParseAllocations(const uint8_t* cbor, size_t cborSize, bool inArena)
+{
+    OCPayload* parsed = NULL;
+    g_allocations = 0;
+    g_countAllocations = true;
+    OCStackResult result = inArena ?
+        OCParsePayloadInArena(&parsed, PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize) :
+        OCParsePayload(&parsed, PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize);
+    g_countAllocations = false;
+
+    EXPECT_EQ(OC_STACK_OK, result);
+    OCPayloadDestroy(parsed);
+    return g_allocations;
+}
+
+static void CheckParseAllocations(const char* name, OCRepPayload* payload)
+{
+    uint8_t* cbor = NULL;
+    size_t cborSize = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, &cbor, &cborSize));
+
+    size_t heap = CountParseAllocations(cbor, cborSize, false);
+    size_t arena = CountParseAllocations(cbor, cborSize, true);
+    EXPECT_EQ(1u, arena);
+    EXPECT_LT(arena, heap);
+
+    std::cout << name << ": " << cborSize << " bytes, " << heap << " allocations on the heap, "
+              << arena << " in an arena" << std::endl;
+    OICFree(cbor);
+}
+
+TEST(CborArenaTest, RepPayloadParseAllocations)
+{
+    OCRepPayload* payload = CreateRepPayload(100);
+    CheckParseAllocations("representation, 100 values", payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborArenaTest, SmallRepPayloadParseAllocations)
+{
+    OCRepPayload* payload = CreateRepPayload(2);
+    CheckParseAllocations("representation, 2 values", payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+
+TEST(CborArenaTest, NestedRepPayloadParseAllocations)
+{
+    OCRepPayload* payload = CreateNestedRepPayload();
+    CheckParseAllocations("nested representation", payload);
+    OCPayloadDestroy((OCPayload*)payload);
+}
+#endif // __GLIBC__
@@ -24,6 +24,9 @@ extern "C"
     #include "ocpayload.h"
     #include "ocstack.h"
     #include "ocstackinternal.h"
+    #include "ocresourcehandler.h"
+    #include "ocresourceindex.h"
+    #include "ocobserve.h"
     #include "logger.h"
     #include "oic_malloc.h"
     #include "oic_string.h"
@@ -48,6 +51,8 @@ extern "C"
 
 #include <iostream>
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 #include "gtest_helper.h"
 
@@ -651,6 +656,22 @@ TEST(StackStop, StackStopRepeated)
     EXPECT_EQ(OC_STACK_ERROR, OCStop());
 }
 
+TEST(StackProcess, ProcessWaitWithoutInit)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_ERROR, OCProcessWait(0));
+}
+
+TEST(StackProcess, ProcessWaitTimeout)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT));
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+    EXPECT_EQ(OC_STACK_TIMEOUT, OCProcessWait(0));
+    EXPECT_EQ(OC_STACK_TIMEOUT, OCProcessWait(10));
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackResource, DISABLED_UpdateResourceNullURI)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -2029,6 +2050,329 @@ TEST(StackResource, MultipleResourcesDiscovery)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResource, ResourceIndexFollowsCreateAndDelete)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle1;
+    OCResourceHandle handle2;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1, "core.led", "core.rw", "/a/led1",
+                                            0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle2, "core.led", "core.r", "/a/led2",
+                                            0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handle2, "core.brightled"));
+
+    EXPECT_EQ(handle1, (OCResourceHandle) FindResourceByUri("/a/led1"));
+    EXPECT_EQ(handle2, (OCResourceHandle) FindResourceByUri("/a/led2"));
+
+    OCResource * const *resources = NULL;
+    size_t count = 0;
+    EXPECT_TRUE(OCResourceIndexFindType("core.led", &resources, &count));
+    EXPECT_EQ(2u, count);
+    EXPECT_TRUE(OCResourceIndexFindType("core.brightled", &resources, &count));
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ(handle2, (OCResourceHandle) resources[0]);
+    EXPECT_TRUE(OCResourceIndexFindInterface("core.rw", &resources, &count));
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ(handle1, (OCResourceHandle) resources[0]);
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle2));
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led2"));
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCDeleteResource(handle2));
+    EXPECT_TRUE(OCResourceIndexFindType("core.brightled", &resources, &count));
+    EXPECT_EQ(0u, count);
+    EXPECT_TRUE(OCResourceIndexFindType("core.led", &resources, &count));
+    EXPECT_EQ(1u, count);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+// Cost of finding the resource of a request and the resources of an rt query
+// as the number of resources grows.
+TEST(StackResource, ResourceIndexScaling)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    const int LOOKUPS = 100000;
+    const int TYPES = 10;
+    const int counts[] = { 10, 100, 500, 1000 };
+    std::vector<std::string> uris;
+    char name[MAX_URI_LENGTH];
+
+    for (int count : counts)
+    {
+        while ((int) uris.size() < count)
+        {
+            int n = uris.size();
+            char rt[32];
+            snprintf(name, sizeof(name), "/a/bench/%d", n);
+            snprintf(rt, sizeof(rt), "core.bench%d", n % TYPES);
+            OCResourceHandle handle;
+            ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, rt, "oic.if.baseline", name,
+                                                    entityHandler, NULL, OC_DISCOVERABLE));
+            uris.push_back(name);
+        }
+
+        int found = 0;
+        uint64_t start = OICGetCurrentTime(TIME_IN_US);
+        for (int i = 0; i < LOOKUPS; i++)
+        {
+            found += FindResourceByUri(uris[(i * 7) % count].c_str()) ? 1 : 0;
+        }
+        uint64_t dispatch = OICGetCurrentTime(TIME_IN_US) - start;
+        EXPECT_EQ(LOOKUPS, found);
+
+        size_t matched = 0;
+        start = OICGetCurrentTime(TIME_IN_US);
+        for (int i = 0; i < LOOKUPS; i++)
+        {
+            OCResource * const *resources = NULL;
+            size_t n = 0;
+            snprintf(name, sizeof(name), "core.bench%d", i % TYPES);
+            ASSERT_TRUE(OCResourceIndexFindType(name, &resources, &n));
+            matched += n;
+        }
+        uint64_t filter = OICGetCurrentTime(TIME_IN_US) - start;
+        EXPECT_EQ((size_t) count * (LOOKUPS / TYPES), matched);
+
+        std::cout << count << " resources: "
+                  << dispatch * 1000 / LOOKUPS << " ns per URI lookup, "
+                  << filter * 1000 / LOOKUPS << " ns per rt filter" << std::endl;
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static int g_notifyCalls = 0;
+
+OCEntityHandlerResult notifyEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void* /*callbackParam*/)
+{
+    g_notifyCalls++;
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(payload, "power", g_notifyCalls);
+
+    OCEntityHandlerResponse response = {};
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) payload;
+    OCStackResult result = OCDoResponse(&response);
+    OCRepPayloadDestroy(payload);
+
+    return (result == OC_STACK_OK) ? OC_EH_OK : OC_EH_ERROR;
+}
+
+static void addTestObserver(OCResourceHandle handle, uint8_t id, const char *query)
+{
+    uint8_t token[] = { 0x4f, 0x42, 0x53, id };
+    OCDevAddr devAddr = {};
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.flags = OC_IP_USE_V4;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+    devAddr.port = 50000 + id;
+
+    EXPECT_EQ(OC_STACK_OK, AddObserver("/a/notify", query, id, (CAToken_t) token,
+                                       sizeof(token), (OCResource *) handle, OC_LOW_QOS,
+                                       OC_FORMAT_CBOR, &devAddr));
+}
+
+TEST(StackNotify, EntityHandlerCalledOncePerObserverGroup)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline",
+                                            "/a/notify", notifyEntityHandler, NULL,
+                                            OC_DISCOVERABLE | OC_OBSERVABLE));
+
+    EXPECT_EQ(OC_STACK_NO_OBSERVERS, OCNotifyAllObservers(handle, OC_NA_QOS));
+
+    addTestObserver(handle, 1, NULL);
+    addTestObserver(handle, 2, NULL);
+    addTestObserver(handle, 3, "if=oic.if.baseline");
+    addTestObserver(handle, 4, NULL);
+
+    g_notifyCalls = 0;
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_NA_QOS));
+    EXPECT_EQ(2, g_notifyCalls);
+
+    uint8_t token[] = { 0x4f, 0x42, 0x53, 3 };
+    EXPECT_EQ(OC_STACK_OK, DeleteObserverUsingToken((CAToken_t) token, sizeof(token)));
+    g_notifyCalls = 0;
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_NA_QOS));
+    EXPECT_EQ(1, g_notifyCalls);
+
+    // the observers go with the resource
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle));
+    EXPECT_EQ(NULL, GetObserverUsingId(1));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+// Cost of a notification of all the observers of a resource as the number of
+// observers grows.
+TEST(StackNotify, NotifyScaling)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline",
+                                            "/a/notify", notifyEntityHandler, NULL,
+                                            OC_DISCOVERABLE | OC_OBSERVABLE));
+
+    const int NOTIFICATIONS = 20;
+    const int counts[] = { 1, 10, 100 };
+    int observers = 0;
+
+    for (int count : counts)
+    {
+        while (observers < count)
+        {
+            addTestObserver(handle, ++observers, NULL);
+        }
+
+        g_notifyCalls = 0;
+        uint64_t start = OICGetCurrentTime(TIME_IN_US);
+        for (int i = 0; i < NOTIFICATIONS; i++)
+        {
+            EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_NA_QOS));
+        }
+        uint64_t elapsed = OICGetCurrentTime(TIME_IN_US) - start;
+        EXPECT_EQ(NOTIFICATIONS, g_notifyCalls);
+
+        std::cout << count << " observers: "
+                  << elapsed / NOTIFICATIONS << " us per notification, "
+                  << g_notifyCalls / NOTIFICATIONS << " entity handler call" << std::endl;
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static int g_deletedCallbacks = 0;
+
+static void countDeletedCallback(void * /*context*/)
+{
+    g_deletedCallbacks++;
+}
+
+static ClientCB *addTestClientCB(uint32_t id, uint32_t ttl)
+{
+    OCCallbackData cbData = {};
+    cbData.cb = asyncDoResourcesCallback;
+    cbData.cd = countDeletedCallback;
+
+    CAToken_t token = (CAToken_t) OICCalloc(1, CA_MAX_TOKEN_LEN);
+    memcpy(token, &id, sizeof(id));
+    OCDoHandle handle = (OCDoHandle) OICMalloc(sizeof(uint8_t));
+
+    ClientCB *cbNode = NULL;
+    EXPECT_EQ(OC_STACK_OK, AddClientCB(&cbNode, &cbData, token, CA_MAX_TOKEN_LEN, &handle,
+                                       OC_REST_GET, NULL, OICStrdup("/a/light"), NULL, ttl));
+    return cbNode;
+}
+
+TEST(StackClientCB, TimedOutCallbackIsDeleted)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT);
+
+    g_deletedCallbacks = 0;
+    ClientCB *expired = addTestClientCB(1, 1);
+    ClientCB *alive = addTestClientCB(2, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                  MILLISECONDS_PER_SECOND));
+    ASSERT_TRUE(expired != NULL);
+    ASSERT_TRUE(alive != NULL);
+    OCDoHandle expiredHandle = expired->handle;
+
+    uint32_t id = 2;
+    uint8_t token[CA_MAX_TOKEN_LEN] = {};
+    memcpy(token, &id, sizeof(id));
+    EXPECT_EQ(alive, GetClientCB((CAToken_t) token, sizeof(token), NULL, NULL));
+    EXPECT_EQ(1, g_deletedCallbacks);
+    EXPECT_EQ(NULL, GetClientCB(NULL, 0, expiredHandle, NULL));
+
+    EXPECT_EQ(alive, GetClientCB(NULL, 0, alive->handle, NULL));
+    FindAndDeleteClientCB(alive);
+    EXPECT_EQ(2, g_deletedCallbacks);
+    EXPECT_EQ(NULL, GetClientCB((CAToken_t) token, sizeof(token), NULL, NULL));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+// Cost of matching a response to its callback and a response of the
+// application to its server request with many requests outstanding.
+TEST(StackClientCB, OutstandingRequestScaling)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    InitStack(OC_CLIENT_SERVER);
+
+    const int LOOKUPS = 100000;
+    const int counts[] = { 10, 100, 1000 };
+    std::vector<OCServerRequest *> requests;
+    uint32_t ttl = GetTicks(MAX_CB_TIMEOUT_SECONDS * MILLISECONDS_PER_SECOND);
+    OCDevAddr devAddr = {};
+    devAddr.adapter = OC_ADAPTER_IP;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+
+    for (int count : counts)
+    {
+        while ((int) requests.size() < count)
+        {
+            uint32_t id = requests.size();
+            ASSERT_TRUE(addTestClientCB(id, ttl) != NULL);
+
+            OCServerRequest *request = NULL;
+            uint8_t token[CA_MAX_TOKEN_LEN] = {};
+            memcpy(token, &id, sizeof(id));
+            ASSERT_EQ(OC_STACK_OK, AddServerRequest(&request, 0, 0, 0, OC_REST_GET, 0, 0,
+                                                    OC_LOW_QOS, NULL, NULL, NULL,
+                                                    (CAToken_t) token, sizeof(token),
+                                                    (char *) "/a/light", 0, OC_FORMAT_CBOR,
+                                                    &devAddr));
+            requests.push_back(request);
+        }
+
+        int found = 0;
+        uint64_t start = OICGetCurrentTime(TIME_IN_US);
+        for (int i = 0; i < LOOKUPS; i++)
+        {
+            uint32_t id = (i * 7) % count;
+            uint8_t token[CA_MAX_TOKEN_LEN] = {};
+            memcpy(token, &id, sizeof(id));
+            found += GetClientCB((CAToken_t) token, sizeof(token), NULL, NULL) ? 1 : 0;
+        }
+        uint64_t client = OICGetCurrentTime(TIME_IN_US) - start;
+        EXPECT_EQ(LOOKUPS, found);
+
+        found = 0;
+        start = OICGetCurrentTime(TIME_IN_US);
+        for (int i = 0; i < LOOKUPS; i++)
+        {
+            OCServerRequest *request = requests[(i * 7) % count];
+            found += (GetServerRequestUsingHandle(request->requestId) == request) ? 1 : 0;
+        }
+        uint64_t server = OICGetCurrentTime(TIME_IN_US) - start;
+        EXPECT_EQ(LOOKUPS, found);
+
+        std::cout << count << " outstanding requests: "
+                  << client * 1000 / LOOKUPS << " ns per callback lookup, "
+                  << server * 1000 / LOOKUPS << " ns per server request lookup" << std::endl;
+    }
+
+    for (OCServerRequest *request : requests)
+    {
+        FindAndDeleteServerRequest(request);
+    }
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackPayload, CloneByteString)
 {
     uint8_t bytes[] = { 0, 1, 2, 3 };
@@ -0,0 +1,181 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of AttributeMap, the container holding
+ * the attributes of an OCRepresentation.
+ */
+
+#ifndef OC_ATTRIBUTEMAP_H_
+#define OC_ATTRIBUTEMAP_H_
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <AttributeValue.h>
+
+namespace OC
+{
+    /**
+     * Map from attribute name to value, kept sorted by name in a single vector.
+     *
+     * A representation has few attributes and is built once and read many times,
+     * so this replaces the std::map node allocations with one allocation, and
+     * lookups with a binary search over contiguous memory.  Iteration is in name
+     * order as with std::map, but inserting or erasing an attribute invalidates
+     * the iterators and references to the other attributes.
+     *
+     * This is a template only so that its members are instantiated once
+     * OCRepresentation, which AttributeValue holds by value, is complete.
+     */
+    template<typename T>
+    class BasicAttributeMap
+    {
+        public:
+            typedef std::string key_type;
+            typedef T mapped_type;
+            typedef std::pair<std::string, T> value_type;
+            typedef typename std::vector<value_type>::size_type size_type;
+            typedef typename std::vector<value_type>::iterator iterator;
+            typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+            iterator begin() { return m_items.begin(); }
+            const_iterator begin() const { return m_items.begin(); }
+            const_iterator cbegin() const { return m_items.cbegin(); }
+            iterator end() { return m_items.end(); }
+            const_iterator end() const { return m_items.end(); }
+            const_iterator cend() const { return m_items.cend(); }
+
+            size_type size() const { return m_items.size(); }
+            bool empty() const { return m_items.empty(); }
+            void clear() { m_items.clear(); }
+
+            /**
+             * Allocate room for the given number of attributes, so that
+             * filling the map from a payload allocates once.
+             */
+            void reserve(size_type count) { m_items.reserve(count); }
+
+            iterator find(const std::string& key)
+            {
+                iterator it = lower_bound(key);
+                return (it != m_items.end() && it->first == key) ? it : m_items.end();
+            }
+
+            const_iterator find(const std::string& key) const
+            {
+                const_iterator it = lower_bound(key);
+                return (it != m_items.end() && it->first == key) ? it : m_items.end();
+            }
+
+            size_type count(const std::string& key) const
+            {
+                return find(key) != end() ? 1 : 0;
+            }
+
+            T& operator[](const std::string& key)
+            {
+                iterator it = lower_bound(key);
+                if (it == m_items.end() || it->first != key)
+                {
+                    it = m_items.emplace(it, key, T());
+                }
+                return it->second;
+            }
+
+            T& operator[](std::string&& key)
+            {
+                iterator it = lower_bound(key);
+                if (it == m_items.end() || it->first != key)
+                {
+                    it = m_items.emplace(it, std::move(key), T());
+                }
+                return it->second;
+            }
+
+            /**
+             * Set the value of an attribute, moving both the name and the value
+             * into the map when they are rvalues.
+             */
+            template<typename K, typename V>
+            void assign(K&& key, V&& value)
+            {
+                iterator it = lower_bound(key);
+                if (it != m_items.end() && it->first == key)
+                {
+                    it->second = std::forward<V>(value);
+                }
+                else
+                {
+                    m_items.emplace(it, std::forward<K>(key), std::forward<V>(value));
+                }
+            }
+
+            size_type erase(const std::string& key)
+            {
+                iterator it = find(key);
+                if (it == m_items.end())
+                {
+                    return 0;
+                }
+                m_items.erase(it);
+                return 1;
+            }
+
+            bool operator==(const BasicAttributeMap& rhs) const
+            {
+                return m_items == rhs.m_items;
+            }
+
+            bool operator!=(const BasicAttributeMap& rhs) const
+            {
+                return !(*this == rhs);
+            }
+
+        private:
+            struct KeyLess
+            {
+                bool operator()(const value_type& item, const std::string& key) const
+                {
+                    return item.first < key;
+                }
+            };
+
+            iterator lower_bound(const std::string& key)
+            {
+                return std::lower_bound(m_items.begin(), m_items.end(), key, KeyLess());
+            }
+
+            const_iterator lower_bound(const std::string& key) const
+            {
+                return std::lower_bound(m_items.begin(), m_items.end(), key, KeyLess());
+            }
+
+            std::vector<value_type> m_items;
+    };
+
+    typedef BasicAttributeMap<AttributeValue> AttributeMap;
+} // namespace OC
+
+#endif // OC_ATTRIBUTEMAP_H_
@@ -0,0 +1,163 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef OC_CALLBACK_EXECUTOR_H_
+#define OC_CALLBACK_EXECUTOR_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OC
+{
+    /**
+     * Runs the application callbacks of the stack (responses, notifications,
+     * timer expiries) on a shared pool of threads instead of a new thread per
+     * callback.
+     *
+     * Callbacks posted with the same strand key run one after the other, in
+     * the order they were posted; callbacks of different strands run in
+     * parallel. The pool keeps 'threads' threads; when a callback is ready
+     * and all of them are busy, one more thread is started, up to maxThreads
+     * in all, which stops again after THREAD_LINGER without work. So a
+     * callback that blocks on another one (a synchronous call made from a
+     * callback) does not starve the pool unless maxThreads callbacks wait
+     * like that at once.
+     *
+     * Posting never blocks: the thread processing the stack posts with the
+     * stack lock held, which the callbacks may need to make progress.
+     * Instead, a droppable callback (an observe notification) replaces the
+     * oldest one still waiting once its strand has maxPending of them, and
+     * once maxQueued callbacks wait in all, further ones are rejected.
+     */
+    class CallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        static const size_t DEFAULT_THREADS = 4;
+        static const size_t DEFAULT_PENDING = 16;
+        static const size_t DEFAULT_MAX_THREADS = 16;
+        static const size_t DEFAULT_QUEUED = 256;
+        static const std::chrono::seconds THREAD_LINGER;
+
+        /**
+         * The executor shared by the whole process. It lives until the
+         * process exits, like the detached threads it replaces.
+         */
+        static CallbackExecutor& getInstance();
+
+        CallbackExecutor(size_t threads = DEFAULT_THREADS,
+                         size_t maxPending = DEFAULT_PENDING,
+                         size_t maxThreads = DEFAULT_MAX_THREADS,
+                         size_t maxQueued = DEFAULT_QUEUED);
+        ~CallbackExecutor();
+
+        CallbackExecutor(const CallbackExecutor&) = delete;
+        CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+        /**
+         * Set the number of threads kept (at least 1), the droppable
+         * callbacks a strand keeps, the number of threads never exceeded
+         * (at least 'threads') and the callbacks waiting in all (0 for no
+         * limit). Threads are started on demand, so this can be called after
+         * callbacks were posted.
+         */
+        void configure(size_t threads, size_t maxPending,
+                       size_t maxThreads = DEFAULT_MAX_THREADS,
+                       size_t maxQueued = DEFAULT_QUEUED);
+
+        /**
+         * Run task on any thread of the pool.
+         *
+         * @return false if the task was rejected, maxQueued tasks waiting.
+         */
+        bool post(Task task);
+
+        /**
+         * Run task after the tasks posted before with the same strand key.
+         *
+         * @param strand     key of the strand, usually the callback context.
+         * @param task       callback to run.
+         * @param droppable  true if the task can be dropped when the strand
+         *                   has too many of them waiting.
+         *
+         * @return false if the task was dropped or rejected, maxQueued tasks
+         *         waiting.
+         */
+        bool post(const void* strand, Task task, bool droppable = false);
+
+        /** Number of droppable tasks dropped since the executor started. */
+        size_t dropped() const;
+
+        /** Number of tasks rejected since the executor started. */
+        size_t rejected() const;
+
+    private:
+        struct Item
+        {
+            Task task;
+            bool droppable;
+        };
+
+        struct Strand
+        {
+            std::deque<Item> items;
+            size_t droppable;
+        };
+
+        bool full() const;
+        bool reject(bool droppable);
+        void schedule(const void* strand);
+        void addThread();
+        void run();
+        void retire();
+
+    private:
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cond;
+        // ready strands, each runs on one thread at a time; nullptr keys the
+        // plain tasks of m_tasks
+        std::deque<const void*> m_ready;
+        std::deque<Task> m_tasks;
+        std::map<const void*, Strand> m_strands;
+        // running threads, and the stopped extra ones still to be joined
+        std::list<std::thread> m_threads;
+        std::vector<std::thread> m_finished;
+        size_t m_keptThreads;
+        size_t m_maxThreads;
+        size_t m_maxPending;
+        size_t m_maxQueued;
+        // tasks waiting in m_tasks and in the strands
+        size_t m_queued;
+        size_t m_idle;
+        size_t m_dropped;
+        size_t m_rejected;
+        bool m_stop;
+    };
+}
+
+#endif // OC_CALLBACK_EXECUTOR_H_
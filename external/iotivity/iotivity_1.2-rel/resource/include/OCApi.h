@@ -170,6 +170,21 @@ namespace OC
         /** pointer to save key. */
         unsigned char*              key;
 
+        /** threads kept to run the client callbacks, more are started while
+            all of them are busy, see CallbackExecutor. */
+        size_t                     callbackThreads = 4;
+
+        /** threads never exceeded to run the client callbacks. */
+        size_t                     callbackMaxThreads = 16;
+
+        /** observe notifications kept per observation while the application
+            is busy, the oldest ones are dropped beyond. 0 keeps all of them. */
+        size_t                     callbackQueueSize = 16;
+
+        /** client callbacks waiting in all, further ones are rejected (and
+            logged). 0 keeps all of them. */
+        size_t                     callbackQueueLimit = 256;
+
         public:
             PlatformConfig()
                 : serviceType(ServiceType::InProc),
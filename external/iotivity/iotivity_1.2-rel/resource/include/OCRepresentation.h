@@ -34,6 +34,7 @@
 #include <map>
 
 #include <AttributeValue.h>
+#include <AttributeMap.h>
 #include <StringConstants.h>
 
 #ifdef __ANDROID__
@@ -67,8 +68,12 @@ namespace OC
 
             const std::vector<OCRepresentation>& representations() const;
 
+            std::vector<OCRepresentation>& representations();
+
             void addRepresentation(const OCRepresentation& rep);
 
+            void addRepresentation(OCRepresentation&& rep);
+
             const OCRepresentation& operator[](int index) const
             {
                 return m_reps[index];
@@ -127,6 +132,8 @@ namespace OC
 
             void addChild(const OCRepresentation&);
 
+            void addChild(OCRepresentation&&);
+
             void clearChildren();
 
             const std::vector<OCRepresentation>& getChildren() const;
@@ -164,17 +171,24 @@ namespace OC
             template <typename T>
             void setValue(const std::string& str, const T& val)
             {
-                m_values[str] = val;
+                m_values.assign(str, val);
             }
 
             // using R-value(or universal ref depending) to move string and vector<uint8_t>
             template <typename T>
             void setValue(const std::string& str, T&& val)
             {
-                m_values[str] = std::forward<T>(val);
+                m_values.assign(str, std::forward<T>(val));
+            }
+
+            // moves the attribute name as well, for names built only to be set
+            template <typename T>
+            void setValue(std::string&& str, T&& val)
+            {
+                m_values.assign(std::move(str), std::forward<T>(val));
             }
 
-            const std::map<std::string, AttributeValue>& getValues() const {
+            const AttributeMap& getValues() const {
                 return m_values;
             }
 
@@ -276,6 +290,38 @@ namespace OC
                 }
             }
 
+            /**
+             *  Move the attribute value associated with the supplied name out
+             *  of the representation, which no longer holds the attribute
+             *  afterwards.  Unlike getValue, strings, vectors and nested
+             *  representations are not copied.
+             *
+             *  @param str Name of the attribute
+             *  @param val Value of the attribute
+             *  @return The moveValue method returns true if the attribute was
+             *        found in the representation with the type of val.
+             *        Otherwise it returns false and leaves the representation
+             *        unchanged.
+             */
+            template <typename T>
+            bool moveValue(const std::string& str, T& val)
+            {
+                auto x = m_values.find(str);
+
+                if (x != m_values.end())
+                {
+                    T* stored = boost::get<T>(&x->second);
+                    if (stored)
+                    {
+                        val = std::move(*stored);
+                        m_values.erase(str);
+                        return true;
+                    }
+                }
+                val = T();
+                return false;
+            }
+
             std::string getValueToString(const std::string& key) const;
             bool hasAttribute(const std::string& str) const;
 
@@ -396,10 +442,10 @@ namespace OC
 
                 private:
                     AttributeItem(const std::string& name,
-                            std::map<std::string, AttributeValue>& vals);
+                            AttributeMap& vals);
                     AttributeItem(const AttributeItem&) = default;
                     std::string m_attrName;
-                    std::map<std::string, AttributeValue>& m_values;
+                    AttributeMap& m_values;
             };
 
             // Iterator to allow iteration via STL containers/methods
@@ -426,11 +472,11 @@ namespace OC
                     reference operator*();
                     pointer operator->();
                 private:
-                    iterator(std::map<std::string, AttributeValue>::iterator&& itr,
-                            std::map<std::string, AttributeValue>& vals)
+                    iterator(AttributeMap::iterator&& itr,
+                            AttributeMap& vals)
                         : m_iterator(std::move(itr)),
                         m_item(m_iterator != vals.end() ? m_iterator->first:"", vals){}
-                    std::map<std::string, AttributeValue>::iterator m_iterator;
+                    AttributeMap::iterator m_iterator;
                     AttributeItem m_item;
             };
 
@@ -459,11 +505,11 @@ namespace OC
                     const_reference operator*() const;
                     const_pointer operator->() const;
                 private:
-                    const_iterator(std::map<std::string, AttributeValue>::const_iterator&& itr,
-                            std::map<std::string, AttributeValue>& vals)
+                    const_iterator(AttributeMap::const_iterator&& itr,
+                            AttributeMap& vals)
                         : m_iterator(std::move(itr)),
                         m_item(m_iterator != vals.end() ? m_iterator->first: "", vals){}
-                    std::map<std::string, AttributeValue>::const_iterator m_iterator;
+                    AttributeMap::const_iterator m_iterator;
                     AttributeItem m_item;
             };
 
@@ -520,7 +566,7 @@ namespace OC
         private:
             std::string m_uri;
             std::vector<OCRepresentation> m_children;
-            mutable std::map<std::string, AttributeValue> m_values;
+            mutable AttributeMap m_values;
             std::vector<std::string> m_resourceTypes;
             std::vector<std::string> m_interfaces;
             std::vector<std::string> m_dataModelVersions;
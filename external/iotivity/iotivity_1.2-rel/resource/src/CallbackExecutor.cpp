@@ -0,0 +1,322 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "CallbackExecutor.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "logger.h"
+
+#define TAG "OIC_CALLBACK_EXECUTOR"
+
+namespace OC
+{
+    const size_t CallbackExecutor::DEFAULT_THREADS;
+    const size_t CallbackExecutor::DEFAULT_PENDING;
+    const size_t CallbackExecutor::DEFAULT_MAX_THREADS;
+    const size_t CallbackExecutor::DEFAULT_QUEUED;
+    const std::chrono::seconds CallbackExecutor::THREAD_LINGER(10);
+
+    CallbackExecutor& CallbackExecutor::getInstance()
+    {
+        // never destroyed: callbacks may still run while the process exits
+        static CallbackExecutor* instance = new CallbackExecutor();
+        return *instance;
+    }
+
+    CallbackExecutor::CallbackExecutor(size_t threads, size_t maxPending,
+                                       size_t maxThreads, size_t maxQueued)
+        : m_keptThreads(threads ? threads : 1),
+          m_maxThreads(std::max(maxThreads, m_keptThreads)),
+          m_maxPending(maxPending),
+          m_maxQueued(maxQueued),
+          m_queued(0),
+          m_idle(0),
+          m_dropped(0),
+          m_rejected(0),
+          m_stop(false)
+    {
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        std::list<std::thread> threads;
+        std::vector<std::thread> finished;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            // no thread stops on its own any more, the lists are final
+            threads.swap(m_threads);
+            finished.swap(m_finished);
+        }
+        m_cond.notify_all();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        for (auto& thread : finished)
+        {
+            thread.join();
+        }
+    }
+
+    void CallbackExecutor::configure(size_t threads, size_t maxPending,
+                                     size_t maxThreads, size_t maxQueued)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_keptThreads = threads ? threads : 1;
+        m_maxThreads = std::max(maxThreads, m_keptThreads);
+        m_maxPending = maxPending;
+        m_maxQueued = maxQueued;
+    }
+
+    bool CallbackExecutor::post(Task task)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (full())
+        {
+            return reject(false);
+        }
+
+        m_tasks.push_back(std::move(task));
+        m_queued++;
+        schedule(nullptr);
+        return true;
+    }
+
+    bool CallbackExecutor::post(const void* strand, Task task, bool droppable)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // a strand is in the map while it has tasks queued or running
+        auto it = m_strands.find(strand);
+        bool active = it != m_strands.end();
+
+        // a notification replaces the oldest one of its strand rather than
+        // being dropped itself
+        if (droppable && active && it->second.droppable
+            && ((m_maxPending && it->second.droppable >= m_maxPending) || full()))
+        {
+            Strand& s = it->second;
+            for (auto item = s.items.begin(); item != s.items.end(); ++item)
+            {
+                if (item->droppable)
+                {
+                    s.items.erase(item);
+                    s.droppable--;
+                    m_queued--;
+                    m_dropped++;
+                    break;
+                }
+            }
+            OIC_LOG(DEBUG, TAG, "callback queue full, dropped the oldest notification");
+        }
+        else if (full())
+        {
+            return reject(droppable);
+        }
+
+        if (!active)
+        {
+            it = m_strands.insert(std::make_pair(strand, Strand{ {}, 0 })).first;
+        }
+
+        Strand& s = it->second;
+        s.items.push_back(Item{ std::move(task), droppable });
+        m_queued++;
+        if (droppable)
+        {
+            s.droppable++;
+        }
+
+        if (!active)
+        {
+            schedule(strand);
+        }
+        return true;
+    }
+
+    size_t CallbackExecutor::dropped() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_dropped;
+    }
+
+    size_t CallbackExecutor::rejected() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_rejected;
+    }
+
+    // called with m_mutex held
+    bool CallbackExecutor::full() const
+    {
+        return m_maxQueued && m_queued >= m_maxQueued;
+    }
+
+    // called with m_mutex held
+    bool CallbackExecutor::reject(bool droppable)
+    {
+        if (droppable)
+        {
+            m_dropped++;
+            OIC_LOG(DEBUG, TAG, "callback queue full, dropped a notification");
+        }
+        else
+        {
+            m_rejected++;
+            OIC_LOG(ERROR, TAG, "callback queue full, rejected a callback");
+        }
+        return false;
+    }
+
+    // called with m_mutex held
+    void CallbackExecutor::schedule(const void* strand)
+    {
+        m_ready.push_back(strand);
+
+        // every idle thread takes one of the ready strands: wake one up if
+        // some are left for this strand, otherwise start another thread, or
+        // leave the strand to the first thread that is done at maxThreads
+        if (m_idle >= m_ready.size())
+        {
+            m_cond.notify_one();
+        }
+        else if (m_threads.size() < m_maxThreads)
+        {
+            addThread();
+        }
+    }
+
+    // called with m_mutex held
+    void CallbackExecutor::addThread()
+    {
+        if (m_stop)
+        {
+            return;
+        }
+
+        // reap the extra threads that stopped meanwhile
+        for (auto& thread : m_finished)
+        {
+            thread.join();
+        }
+        m_finished.clear();
+
+        try
+        {
+            m_threads.push_back(std::thread(&CallbackExecutor::run, this));
+        }
+        catch (std::exception& e)
+        {
+            // the callback runs when one of the existing threads is free
+            OIC_LOG_V(ERROR, TAG, "failed to start a callback thread: %s", e.what());
+        }
+    }
+
+    void CallbackExecutor::run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (!m_stop)
+        {
+            if (m_ready.empty())
+            {
+                m_idle++;
+                bool timedOut = m_cond.wait_for(lock, THREAD_LINGER) == std::cv_status::timeout;
+                m_idle--;
+
+                // the threads started beyond the kept ones stop when idle
+                if (timedOut && !m_stop && m_ready.empty() && m_threads.size() > m_keptThreads)
+                {
+                    retire();
+                    return;
+                }
+                continue;
+            }
+
+            const void* strand = m_ready.front();
+            m_ready.pop_front();
+
+            Task task;
+            if (!strand)
+            {
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            else
+            {
+                Strand& s = m_strands[strand];
+                Item& item = s.items.front();
+                if (item.droppable)
+                {
+                    s.droppable--;
+                }
+                task = std::move(item.task);
+                s.items.pop_front();
+            }
+            m_queued--;
+
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch (std::exception& e)
+            {
+                OIC_LOG_V(ERROR, TAG, "exception in callback: %s", e.what());
+            }
+            task = nullptr;
+            lock.lock();
+
+            // the next task of the strand runs after this one
+            if (strand)
+            {
+                auto it = m_strands.find(strand);
+                if (it->second.items.empty())
+                {
+                    m_strands.erase(it);
+                }
+                else
+                {
+                    m_ready.push_back(strand);
+                }
+            }
+        }
+    }
+
+    // called with m_mutex held by the thread that stops; the thread is
+    // joined by the next addThread() or by the destructor
+    void CallbackExecutor::retire()
+    {
+        for (auto it = m_threads.begin(); it != m_threads.end(); ++it)
+        {
+            if (it->get_id() == std::this_thread::get_id())
+            {
+                m_finished.push_back(std::move(*it));
+                m_threads.erase(it);
+                break;
+            }
+        }
+        OIC_LOG(DEBUG, TAG, "stopped an idle callback thread");
+    }
+}
@@ -25,6 +25,7 @@
 #include "OCResource.h"
 #include "ocpayload.h"
 #include <OCSerialization.h>
+#include "CallbackExecutor.h"
 #include "logger.h"
 #ifdef TCP_ADAPTER
 #include "oickeepalive.h"
@@ -76,6 +77,9 @@ namespace OC
                 throw InitializeException(OC::InitException::STACK_INIT_ERROR, result);
             }
 
+            // responses are only read, to build OCRepresentations
+            OCSetPayloadArena(true);
+
             if (false == m_threadRun)
             {
                 m_threadRun = true;
@@ -111,6 +115,9 @@ namespace OC
 
     void InProcClientWrapper::listeningFunc()
     {
+        // Longest wait for messages, so that presence and keep-alive still run
+        const uint32_t processWaitMs = 100;
+
         while(m_threadRun)
         {
             OCStackResult result;
@@ -130,8 +137,13 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Wait without the lock until messages are queued for OCProcess()
+            OCStackResult waitResult = OCProcessWait(processWaitMs);
+            if (OC_STACK_OK != waitResult && OC_STACK_TIMEOUT != waitResult)
+            {
+                // the stack is not running: do not spin
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -151,21 +163,22 @@ namespace OC
         oc.setPayload(clientResponse->payload);
         //OCPayloadDestroy(clientResponse->payload);
 
-        std::vector<OCRepresentation>::const_iterator it = oc.representations().begin();
+        std::vector<OCRepresentation>::iterator it = oc.representations().begin();
         if (it == oc.representations().end())
         {
             return OCRepresentation();
         }
 
         // first one is considered the root, everything else is considered a child of this one.
-        OCRepresentation root = *it;
+        // The container is discarded, so the representations are moved out of it.
+        OCRepresentation root = std::move(*it);
         root.setDevAddr(clientResponse->devAddr);
         root.setUri(clientResponse->resourceUri);
         ++it;
 
         std::for_each(it, oc.representations().end(),
-                [&root](const OCRepresentation& repItr)
-                {root.addChild(repItr);});
+                [&root](OCRepresentation& repItr)
+                {root.addChild(std::move(repItr));});
         return root;
     }
 
@@ -213,8 +226,8 @@ namespace OC
 
             for(auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                CallbackExecutor::getInstance().post(context,
+                        std::bind(context->callback, resource));
             }
         }
         catch (std::exception &e)
@@ -262,16 +275,16 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                CallbackExecutor::getInstance().post(context,
+                        std::bind(context->callback, resource));
             }
             return OC_STACK_KEEP_TRANSACTION;
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
         std::string resourceURI = clientResponse->resourceUri;
-        std::thread exec(context->errorCallback, resourceURI, result);
-        exec.detach();
+        CallbackExecutor::getInstance().post(context,
+                std::bind(context->errorCallback, resourceURI, result));
         return OC_STACK_KEEP_TRANSACTION;
     }
 
@@ -407,8 +420,8 @@ namespace OC
                                     reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
 
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-            std::thread exec(context->callback, container.Resources());
-            exec.detach();
+            CallbackExecutor::getInstance().post(context,
+                    std::bind(context->callback, container.Resources()));
         }
         catch (std::exception &e)
         {
@@ -479,8 +492,8 @@ namespace OC
 
              //send the error callback
             std::string uri = clientResponse->resourceUri;
-            std::thread exec(context->errorCallback, uri, result);
-            exec.detach();
+            CallbackExecutor::getInstance().post(context,
+                    std::bind(context->errorCallback, uri, result));
             return OC_STACK_KEEP_TRANSACTION;
         }
 
@@ -506,8 +519,8 @@ namespace OC
                             reinterpret_cast<OCDiscoveryPayload*>(clientResponse->payload));
 
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-            std::thread exec(context->callback, container.Resources());
-            exec.detach();
+            CallbackExecutor::getInstance().post(context,
+                    std::bind(context->callback, container.Resources()));
         }
         catch (std::exception &e)
         {
@@ -585,9 +598,8 @@ namespace OC
                     << clientResponse->result
                     << std::flush;
 
-            std::thread exec(context->callback, clientResponse->result,
-                             resourceURI, nullptr);
-            exec.detach();
+            CallbackExecutor::getInstance().post(context,
+                    std::bind(context->callback, clientResponse->result, resourceURI, nullptr));
 
             return OC_STACK_DELETE_TRANSACTION;
         }
@@ -608,9 +620,9 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, clientResponse->result,
-                                 resourceURI, resource);
-                exec.detach();
+                CallbackExecutor::getInstance().post(context,
+                        std::bind(context->callback, clientResponse->result, resourceURI,
+                                  resource));
             }
         }
         catch (std::exception &e)
@@ -681,8 +693,8 @@ namespace OC
         {
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            CallbackExecutor::getInstance().post(context,
+                    std::bind(context->callback, std::move(rep)));
         }
         catch(OC::OCException& e)
         {
@@ -819,19 +831,15 @@ namespace OC
                                             createdUri);
                 for (auto resource : container.Resources())
                 {
-                    std::thread exec(context->callback, result,
-                                     createdUri,
-                                     resource);
-                    exec.detach();
+                    CallbackExecutor::getInstance().post(context,
+                            std::bind(context->callback, result, createdUri, resource));
                 }
             }
             else
             {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-                std::thread exec(context->callback, result,
-                                 createdUri,
-                                 nullptr);
-                exec.detach();
+                CallbackExecutor::getInstance().post(context,
+                        std::bind(context->callback, result, createdUri, nullptr));
             }
         }
         catch (std::exception &e)
@@ -910,8 +918,8 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        CallbackExecutor::getInstance().post(context,
+                std::bind(context->callback, serverHeaderOptions, std::move(rep), result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -985,8 +993,8 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        CallbackExecutor::getInstance().post(context,
+                std::bind(context->callback, serverHeaderOptions, std::move(attrs), result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1186,8 +1194,8 @@ namespace OC
         parseServerHeaderOptions(clientResponse, serverHeaderOptions);
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        CallbackExecutor::getInstance().post(context,
+                std::bind(context->callback, serverHeaderOptions, clientResponse->result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1260,9 +1268,12 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        // notifications of an observation are delivered in order; while the
+        // application is busy, the oldest ones give way to the new ones
+        bool droppable = result == OC_STACK_OK && sequenceNumber <= MAX_SEQUENCE_NUMBER;
+        CallbackExecutor::getInstance().post(context,
+                std::bind(context->callback, serverHeaderOptions, std::move(attrs),
+                          result, sequenceNumber), droppable);
         if (sequenceNumber == MAX_SEQUENCE_NUMBER + 1)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -1373,11 +1384,9 @@ namespace OC
         std::string url = clientResponse->devAddr.addr;
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
-
+        CallbackExecutor::getInstance().post(context,
+                std::bind(context->callback, clientResponse->result, clientResponse->sequenceNumber,
+                          url));
         return OC_STACK_KEEP_TRANSACTION;
     }
 
@@ -1564,8 +1573,7 @@ namespace OC
             else {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                CallbackExecutor::getInstance().post(std::bind(callback, dpDeviceList));
                 result = OC_STACK_OK;
             }
         }
@@ -1604,8 +1612,7 @@ namespace OC
             else {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                CallbackExecutor::getInstance().post(std::bind(callback, dpDeviceList));
                 result = OC_STACK_OK;
             }
         }
@@ -1625,8 +1632,8 @@ namespace OC
             static_cast<ClientCallbackContext::DirectPairingContext*>(ctx);
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, cloneDevice(peer), result);
-        exec.detach();
+        CallbackExecutor::getInstance().post(context,
+                std::bind(context->callback, cloneDevice(peer), result));
     }
 
     OCStackResult InProcClientWrapper::DoDirectPairing(std::shared_ptr<OCDirectPairing> peer,
@@ -1676,8 +1683,8 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, result, attrs);
-        exec.detach();
+        CallbackExecutor::getInstance().post(context,
+                std::bind(context->callback, result, std::move(attrs)));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -299,6 +299,9 @@ namespace OC
             throw InitializeException(OC::InitException::STACK_INIT_ERROR, result);
         }
 
+        // requests and responses are only read, to build OCRepresentations
+        OCSetPayloadArena(true);
+
         if (false == m_threadRun)
         {
             m_threadRun = true;
@@ -329,6 +332,9 @@ namespace OC
 
     void InProcServerWrapper::processFunc()
     {
+        // Longest wait for messages, so that presence and keep-alive still run
+        const uint32_t processWaitMs = 100;
+
         auto cLock = m_csdkLock.lock();
         while(cLock && m_threadRun)
         {
@@ -345,7 +351,13 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Wait without the lock until messages are queued for OCProcess()
+            OCStackResult waitResult = OCProcessWait(processWaitMs);
+            if (OC_STACK_OK != waitResult && OC_STACK_TIMEOUT != waitResult)
+            {
+                // the stack is not running: do not spin
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -42,6 +42,7 @@
 #include "OCApi.h"
 #include "OCException.h"
 #include "OCUtilities.h"
+#include "CallbackExecutor.h"
 #include "ocpayload.h"
 
 #include "logger.h"
@@ -158,6 +159,11 @@ namespace OC
     {
         OIC_LOG(INFO, TAG, "init");
 
+        CallbackExecutor::getInstance().configure(config.callbackThreads,
+                                                  config.callbackQueueSize,
+                                                  config.callbackMaxThreads,
+                                                  config.callbackQueueLimit);
+
         switch(config.mode)
         {
             case ModeType::Server:
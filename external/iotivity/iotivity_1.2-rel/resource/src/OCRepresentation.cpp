@@ -70,7 +70,7 @@ namespace OC
             cur.setPayload(pl);
 
             pl = pl->next;
-            this->addRepresentation(cur);
+            this->addRepresentation(std::move(cur));
         }
     }
 
@@ -97,10 +97,20 @@ namespace OC
         return m_reps;
     }
 
+    std::vector<OCRepresentation>& MessageContainer::representations()
+    {
+        return m_reps;
+    }
+
     void MessageContainer::addRepresentation(const OCRepresentation& rep)
     {
         m_reps.push_back(rep);
     }
+
+    void MessageContainer::addRepresentation(OCRepresentation&& rep)
+    {
+        m_reps.push_back(std::move(rep));
+    }
 }
 
 namespace OC
@@ -194,7 +204,7 @@ namespace OC
         }
 
         template<typename T>
-        void copy_to_array(T item, void* array, size_t pos)
+        void copy_to_array(const T& item, void* array, size_t pos)
         {
             ((T*)array)[pos] = item;
         }
@@ -224,49 +234,25 @@ namespace OC
     }
 
     template<>
-    void get_payload_array::copy_to_array(int item, void* array, size_t pos)
+    void get_payload_array::copy_to_array(const int& item, void* array, size_t pos)
     {
         ((int64_t*)array)[pos] = item;
     }
 
 #if !(defined(_MSC_VER) || defined(__APPLE__))
     template<>
-    void get_payload_array::copy_to_array(std::_Bit_reference br, void* array, size_t pos)
+    void get_payload_array::copy_to_array(const std::_Bit_reference& br, void* array, size_t pos)
     {
         ((bool*)array)[pos] = static_cast<bool>(br);
     }
 #endif
 
-    template<>
-    void get_payload_array::copy_to_array(std::string item, void* array, size_t pos)
-    {
-        ((char**)array)[pos] = OICStrdup(item.c_str());
-    }
-
-    template<>
-    void get_payload_array::copy_to_array(std::string& item, void* array, size_t pos)
-    {
-        ((char**)array)[pos] = OICStrdup(item.c_str());
-    }
-
     template<>
     void get_payload_array::copy_to_array(const std::string& item, void* array, size_t pos)
     {
         ((char**)array)[pos] = OICStrdup(item.c_str());
     }
 
-    template<>
-    void get_payload_array::copy_to_array(OCByteString item, void *array, size_t pos)
-    {
-        ((OCByteString *)array)[pos] = item;
-    }
-
-    template<>
-    void get_payload_array::copy_to_array(OCByteString &item, void *array, size_t pos)
-    {
-        ((OCByteString *)array)[pos] = item;
-    }
-
     template<>
     void get_payload_array::copy_to_array(const OCByteString &item, void *array, size_t pos)
     {
@@ -274,7 +260,7 @@ namespace OC
     }
 
     template<>
-    void get_payload_array::copy_to_array(OC::OCRepresentation item, void* array, size_t pos)
+    void get_payload_array::copy_to_array(const OC::OCRepresentation& item, void* array, size_t pos)
     {
         ((OCRepPayload**)array)[pos] = item.getPayload();
     }
@@ -344,6 +330,8 @@ namespace OC
 
         for(auto& val : *this)
         {
+            // strings, binary data and nested representations are read in place
+            const AttributeValue& value = m_values[val.attrname()];
             switch(val.type())
             {
                 case AttributeType::Null:
@@ -361,22 +349,25 @@ namespace OC
                     break;
                 case AttributeType::String:
                     OCRepPayloadSetPropString(root, val.attrname().c_str(),
-                            static_cast<std::string>(val).c_str());
+                            boost::get<std::string>(value).c_str());
                     break;
                 case AttributeType::OCByteString:
                     OCRepPayloadSetPropByteString(root, val.attrname().c_str(), val.getValue<OCByteString>());
                     break;
                 case AttributeType::OCRepresentation:
                     OCRepPayloadSetPropObjectAsOwner(root, val.attrname().c_str(),
-                            static_cast<OCRepresentation>(val).getPayload());
+                            boost::get<OCRepresentation>(value).getPayload());
                     break;
                 case AttributeType::Vector:
                     getPayloadArray(root, val);
                     break;
                 case AttributeType::Binary:
-                    OCRepPayloadSetPropByteString(root, val.attrname().c_str(),
-                            OCByteString{const_cast<uint8_t*>(val.getValue<std::vector<uint8_t>>().data()),
-                            val.getValue<std::vector<uint8_t>>().size()});
+                    {
+                        const std::vector<uint8_t>& bytes =
+                            boost::get<std::vector<uint8_t>>(value);
+                        OCRepPayloadSetPropByteString(root, val.attrname().c_str(),
+                                OCByteString{const_cast<uint8_t*>(bytes.data()), bytes.size()});
+                    }
                     break;
                 default:
                     throw std::logic_error(std::string("Getpayload: Not Implemented") +
@@ -477,7 +468,7 @@ namespace OC
             {
                 val[i] = payload_array_helper_copy<T>(i, pl);
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else if (depth == 2)
         {
@@ -491,7 +482,7 @@ namespace OC
                             i * pl->arr.dimensions[1] + j, pl);
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else if (depth == 3)
         {
@@ -512,7 +503,7 @@ namespace OC
                     }
                 }
             }
-            this->setValue(std::string(pl->name), val);
+            this->setValue(std::string(pl->name), std::move(val));
         }
         else
         {
@@ -569,6 +560,13 @@ namespace OC
 
         OCRepPayloadValue* val = pl->values;
 
+        size_t count = 0;
+        for (const OCRepPayloadValue* cur = val; cur; cur = cur->next)
+        {
+            ++count;
+        }
+        m_values.reserve(m_values.size() + count);
+
         while(val)
         {
             switch(val->type)
@@ -592,7 +590,7 @@ namespace OC
                     {
                         OCRepresentation cur;
                         cur.setPayload(val->obj);
-                        setValue<OCRepresentation>(val->name, cur);
+                        setValue<OCRepresentation>(val->name, std::move(cur));
                     }
                     break;
                 case OCREP_PROP_ARRAY:
@@ -618,6 +616,11 @@ namespace OC
         m_children.push_back(rep);
     }
 
+    void OCRepresentation::addChild(OCRepresentation&& rep)
+    {
+        m_children.push_back(std::move(rep));
+    }
+
     void OCRepresentation::clearChildren()
     {
         m_children.clear();
@@ -844,7 +847,7 @@ namespace OC
 namespace OC
 {
     OCRepresentation::AttributeItem::AttributeItem(const std::string& name,
-            std::map<std::string, AttributeValue>& vals):
+            AttributeMap& vals):
             m_attrName(name), m_values(vals){}
 
     OCRepresentation::AttributeItem OCRepresentation::operator[](const std::string& key)
@@ -0,0 +1,241 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <vector>
+#include <gtest/gtest.h>
+#include <CallbackExecutor.h>
+
+namespace OC
+{
+    namespace test
+    {
+        namespace CallbackExecutorTests
+        {
+            using namespace OC;
+
+            TEST(CallbackExecutorTest, StrandRunsInOrder)
+            {
+                std::vector<int> order;
+                std::promise<void> done;
+                int strand;
+                {
+                    CallbackExecutor executor(4, 0, CallbackExecutor::DEFAULT_MAX_THREADS, 0);
+
+                    for (int i = 0; i < 1000; i++)
+                    {
+                        executor.post(&strand, [&order, i]() { order.push_back(i); });
+                    }
+                    executor.post(&strand, [&done]() { done.set_value(); });
+                    done.get_future().wait();
+                }
+
+                ASSERT_EQ(1000u, order.size());
+                for (int i = 0; i < 1000; i++)
+                {
+                    EXPECT_EQ(i, order[i]);
+                }
+            }
+
+            TEST(CallbackExecutorTest, DropsOldestNotifications)
+            {
+                std::vector<int> delivered;
+                std::promise<void> release;
+                std::shared_future<void> released = release.get_future().share();
+                std::promise<void> done;
+                int strand;
+
+                CallbackExecutor executor(1, 4);
+
+                // hold the strand while the notifications come in
+                executor.post(&strand, [released]() { released.wait(); });
+                for (int i = 0; i < 10; i++)
+                {
+                    executor.post(&strand, [&delivered, i]() { delivered.push_back(i); }, true);
+                }
+                executor.post(&strand, [&done]() { done.set_value(); });
+                release.set_value();
+                done.get_future().wait();
+
+                EXPECT_EQ(6u, executor.dropped());
+                EXPECT_EQ((std::vector<int>{ 6, 7, 8, 9 }), delivered);
+            }
+
+            TEST(CallbackExecutorTest, RunsTasksOfDifferentStrandsInParallel)
+            {
+                std::promise<void> release;
+                std::shared_future<void> released = release.get_future().share();
+                std::promise<void> done;
+                int strand1;
+                int strand2;
+
+                CallbackExecutor executor(2, 0);
+
+                // the second strand must not wait for the blocked first one
+                executor.post(&strand1, [released]() { released.wait(); });
+                executor.post(&strand2, [&done]() { done.set_value(); });
+
+                EXPECT_EQ(std::future_status::ready,
+                          done.get_future().wait_for(std::chrono::seconds(5)));
+                release.set_value();
+            }
+
+            TEST(CallbackExecutorTest, BlockingCallbackDoesNotStallPool)
+            {
+                std::promise<void> answered;
+                std::promise<bool> done;
+                int strand1;
+                int strand2;
+
+                CallbackExecutor executor(1, 0);
+
+                // a callback waits for another one, as a synchronous call made
+                // from a callback does: the only thread kept is busy with it
+                executor.post(&strand1, [&]()
+                {
+                    executor.post(&strand2, [&answered]() { answered.set_value(); });
+                    done.set_value(answered.get_future().wait_for(std::chrono::seconds(5))
+                                   == std::future_status::ready);
+                });
+
+                EXPECT_TRUE(done.get_future().get());
+            }
+
+            TEST(CallbackExecutorTest, ThreadsBoundedByMaxThreads)
+            {
+                const int STRANDS = 8;
+                std::mutex mutex;
+                std::condition_variable cond;
+                int running = 0;
+                int mostRunning = 0;
+                int finished = 0;
+                bool released = false;
+                int strands[STRANDS];
+
+                CallbackExecutor executor(1, 0, 2, 0);
+
+                for (int i = 0; i < STRANDS; i++)
+                {
+                    executor.post(&strands[i], [&]()
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        mostRunning = std::max(mostRunning, ++running);
+                        cond.notify_all();
+                        cond.wait(lock, [&released]() { return released; });
+                        running--;
+                        finished++;
+                        cond.notify_all();
+                    });
+                }
+
+                std::unique_lock<std::mutex> lock(mutex);
+                EXPECT_TRUE(cond.wait_for(lock, std::chrono::seconds(5),
+                                          [&running]() { return running == 2; }));
+                // a third thread would have been started by now
+                EXPECT_FALSE(cond.wait_for(lock, std::chrono::milliseconds(100),
+                                           [&running]() { return running > 2; }));
+                released = true;
+                cond.notify_all();
+                EXPECT_TRUE(cond.wait_for(lock, std::chrono::seconds(5),
+                                          [&finished]() { return finished == STRANDS; }));
+                EXPECT_EQ(2, mostRunning);
+            }
+
+            TEST(CallbackExecutorTest, RejectsBeyondMaxQueued)
+            {
+                std::promise<void> started;
+                std::promise<void> release;
+                std::shared_future<void> released = release.get_future().share();
+                std::atomic<int> delivered(0);
+                std::promise<void> done;
+                int strand1;
+                int strand2;
+                int strand3;
+
+                CallbackExecutor executor(1, 0, 1, 4);
+
+                // hold the only thread, its task is not waiting any more
+                executor.post(&strand1, [&started, released]()
+                {
+                    started.set_value();
+                    released.wait();
+                });
+                started.get_future().wait();
+
+                auto notification = [&delivered, &done]()
+                {
+                    if (++delivered == 3)
+                    {
+                        done.set_value();
+                    }
+                };
+                for (int i = 0; i < 3; i++)
+                {
+                    EXPECT_TRUE(executor.post(&strand2, notification, true));
+                }
+                EXPECT_TRUE(executor.post([]() {}));
+
+                // a notification replaces one of its strand, others are refused
+                EXPECT_TRUE(executor.post(&strand2, notification, true));
+                EXPECT_FALSE(executor.post(&strand3, []() {}, true));
+                EXPECT_FALSE(executor.post(&strand3, []() {}));
+                EXPECT_FALSE(executor.post([]() {}));
+                EXPECT_EQ(2u, executor.dropped());
+                EXPECT_EQ(2u, executor.rejected());
+
+                release.set_value();
+                done.get_future().wait();
+                EXPECT_EQ(3, delivered);
+            }
+
+            TEST(CallbackExecutorTest, DeliversAllNotifications)
+            {
+                const int STRANDS = 8;
+                const int NOTIFICATIONS = 10000;
+                std::atomic<int> delivered(0);
+                std::promise<void> done;
+                int strands[STRANDS];
+
+                CallbackExecutor executor(CallbackExecutor::DEFAULT_THREADS, 0,
+                                          CallbackExecutor::DEFAULT_MAX_THREADS, 0);
+
+                for (int i = 0; i < NOTIFICATIONS; i++)
+                {
+                    executor.post(&strands[i % STRANDS], [&delivered, &done]()
+                    {
+                        if (++delivered == NOTIFICATIONS)
+                        {
+                            done.set_value();
+                        }
+                    }, true);
+                }
+                done.get_future().wait();
+
+                EXPECT_EQ(NOTIFICATIONS, delivered);
+                EXPECT_EQ(0u, executor.dropped());
+            }
+        }
+    }
+}
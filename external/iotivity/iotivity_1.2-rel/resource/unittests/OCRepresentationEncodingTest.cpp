@@ -28,6 +28,39 @@
 #include <oic_malloc.h>
 #include <oic_string.h>
 #include "payload_logging.h"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Counts the C++ allocations of the representation code, see RoundTripAllocations
+static bool g_countAllocations = false;
+static size_t g_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    g_allocations += g_countAllocations;
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
 
 bool operator==(const OCByteString& lhs, const OCByteString& rhs)
 {
@@ -1608,4 +1641,69 @@ namespace OCRepresentationEncodingTest
         OCRepPayloadDestroy(repPayload);
         OCPayloadDestroy(cparsed);
     }
+
+    // Counts the allocations of OCRepresentation on the path of a request from a client
+    // to the application of the server: OCPayload -> OCRepresentation, then a copy.
+    // Attributes used to be map nodes, one allocation or more each.
+    TEST(RepresentationEncoding, RoundTripAllocations)
+    {
+        OC::OCRepresentation sub;
+        sub.setValue("state", std::string("on"));
+        sub.setValue("count", 3);
+
+        OC::OCRepresentation rep;
+        rep.setUri("/a/light");
+        rep.addResourceType("core.light");
+        rep.addResourceInterface("oic.if.baseline");
+        for (int i = 0; i < 10; i++)
+        {
+            rep.setValue("int" + std::to_string(i), i);
+            rep.setValue("str" + std::to_string(i), std::string("string value ") + std::to_string(i));
+        }
+        rep.setValue("level", 0.5);
+        rep.setValue("power", true);
+        rep.setValue("child", sub);
+        rep.setValue("names", std::vector<std::string>{"first name", "second name", "third name"});
+
+        OCRepPayload *repPayload = rep.getPayload();
+        uint8_t *cborData = NULL;
+        size_t cborSize = 0;
+        OCPayload *cparsed = NULL;
+        ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)repPayload, &cborData, &cborSize));
+        ASSERT_EQ(OC_STACK_OK, OCParsePayload(&cparsed, PAYLOAD_TYPE_REPRESENTATION,
+                    cborData, cborSize));
+
+        OC::OCRepresentation parsed;
+        g_allocations = 0;
+        g_countAllocations = true;
+        {
+            OC::MessageContainer mc;
+            mc.setPayload(cparsed);
+            parsed = std::move(mc.representations()[0]);
+        }
+        g_countAllocations = false;
+        size_t parseAllocations = g_allocations;
+
+        g_allocations = 0;
+        g_countAllocations = true;
+        OC::OCRepresentation copy(parsed);
+        g_countAllocations = false;
+        size_t copyAllocations = g_allocations;
+
+        std::cout << rep.size() << " attributes: " << parseAllocations
+                  << " allocations from the payload, " << copyAllocations << " for a copy"
+                  << std::endl;
+        EXPECT_LT(parseAllocations, rep.size());
+        EXPECT_LT(copyAllocations, rep.size());
+
+        EXPECT_EQ(rep.size(), parsed.size());
+        EXPECT_EQ("string value 9", parsed.getValue<std::string>("str9"));
+        EXPECT_EQ(3, parsed.getValue<OC::OCRepresentation>("child").getValue<int>("count"));
+        EXPECT_EQ(3u, parsed.getValue<std::vector<std::string>>("names").size());
+        EXPECT_EQ(parsed, copy);
+
+        OICFree(cborData);
+        OCRepPayloadDestroy(repPayload);
+        OCPayloadDestroy(cparsed);
+    }
 }
@@ -1445,6 +1445,69 @@ namespace OCRepresentationTest
         }
     }
 
+    // attributes are kept sorted by name, whatever the order they are set in
+    TEST(OCRepresentationAttributes, SortedByName)
+    {
+        OCRepresentation rep;
+        rep.setValue("ccc", 3);
+        rep.setValue("a", 1);
+        rep.setValue("bb", std::string("two"));
+        rep.setValue("a", 11);
+        rep.setNULL("d");
+
+        EXPECT_EQ(4u, rep.size());
+        vector<string> names;
+        for (const auto& cur : rep)
+        {
+            names.push_back(cur.attrname());
+        }
+        EXPECT_EQ((vector<string>{"a", "bb", "ccc", "d"}), names);
+        EXPECT_EQ(11, rep.getValue<int>("a"));
+
+        EXPECT_TRUE(rep.erase("bb"));
+        EXPECT_FALSE(rep.erase("bb"));
+        EXPECT_FALSE(rep.hasAttribute("bb"));
+        EXPECT_EQ(3, rep.getValue<int>("ccc"));
+        EXPECT_TRUE(rep.isNULL("d"));
+        EXPECT_EQ(3u, rep.getValues().size());
+    }
+
+    TEST(OCRepresentationAttributes, SetValueMoves)
+    {
+        OCRepresentation sub;
+        sub.setUri("sub rep URI");
+        sub.setValue("string", std::string(100, 's'));
+
+        vector<string> strv {std::string(100, 'a'), std::string(100, 'b')};
+        const char* data = strv[0].data();
+
+        OCRepresentation rep;
+        rep.setValue(std::string("strv"), std::move(strv));
+        rep.setValue("sub", std::move(sub));
+
+        const vector<string>& stored =
+            boost::get<vector<string>>(rep.getValues().find("strv")->second);
+        EXPECT_EQ(data, stored[0].data());
+        EXPECT_EQ("sub rep URI", rep.getValue<OCRepresentation>("sub").getUri());
+    }
+
+    TEST(OCRepresentationAttributes, MoveValue)
+    {
+        OCRepresentation rep;
+        rep.setValue("string", std::string(100, 's'));
+        rep.setValue("int", 5);
+
+        std::string str;
+        EXPECT_FALSE(rep.moveValue("int", str));
+        EXPECT_TRUE(rep.hasAttribute("int"));
+        EXPECT_FALSE(rep.moveValue("missing", str));
+
+        EXPECT_TRUE(rep.moveValue("string", str));
+        EXPECT_EQ(std::string(100, 's'), str);
+        EXPECT_FALSE(rep.hasAttribute("string"));
+        EXPECT_EQ(1u, rep.size());
+    }
+
     TEST(OCRepresentationHostTest, ValidHost)
     {
         OCDevAddr addr = {OC_DEFAULT_ADAPTER, OC_IP_USE_V6};
@@ -34,6 +34,121 @@
         } \
     }
 
+#define NS_PROVIDER_TOPIC_SUB_BUCKETS 256
+
+typedef struct _NSTopicSubIndexEntry
+{
+    NSCacheTopicSubData * data;
+    struct _NSTopicSubIndexEntry * next;
+
+} NSTopicSubIndexEntry;
+
+// The (consumer id, topic name) pairs of the consumer topic list, hashed so that
+// sending a topic message does not walk the list once per subscriber.
+static NSTopicSubIndexEntry * NSTopicSubIndex[NS_PROVIDER_TOPIC_SUB_BUCKETS];
+
+// Cleared when an entry could not be allocated, the list is walked then.
+static bool NSTopicSubIndexComplete = true;
+
+static bool NSIsConsumerTopicCache(NSCacheType type)
+{
+    return type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME ||
+            type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID;
+}
+
+static uint32_t NSTopicSubHash(const char * cId, const char * topicName)
+{
+    // FNV-1a over the consumer id and the topic name
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < NS_UUID_STRING_SIZE && cId[i]; i++)
+    {
+        hash = (hash ^ (uint8_t) cId[i]) * 16777619u;
+    }
+
+    hash = (hash ^ '/') * 16777619u;
+
+    for (; *topicName; topicName++)
+    {
+        hash = (hash ^ (uint8_t) *topicName) * 16777619u;
+    }
+
+    return hash & (NS_PROVIDER_TOPIC_SUB_BUCKETS - 1);
+}
+
+static bool NSIsSameTopicSub(NSCacheTopicSubData * data, const char * cId, const char * topicName)
+{
+    return (strncmp(data->id, cId, NS_UUID_STRING_SIZE) == 0) &&
+            (strcmp(data->topicName, topicName) == 0);
+}
+
+static void NSTopicSubIndexAdd(NSCacheTopicSubData * data)
+{
+    NSTopicSubIndexEntry * entry =
+            (NSTopicSubIndexEntry *) OICMalloc(sizeof(NSTopicSubIndexEntry));
+
+    if (!entry)
+    {
+        NS_LOG(ERROR, "Fail to index consumer topic, lookups walk the list");
+        NSTopicSubIndexComplete = false;
+        return;
+    }
+
+    uint32_t bucket = NSTopicSubHash(data->id, data->topicName);
+    entry->data = data;
+    entry->next = NSTopicSubIndex[bucket];
+    NSTopicSubIndex[bucket] = entry;
+}
+
+static void NSTopicSubIndexRemove(NSCacheTopicSubData * data)
+{
+    NSTopicSubIndexEntry ** iter = &NSTopicSubIndex[NSTopicSubHash(data->id, data->topicName)];
+
+    while (*iter)
+    {
+        if ((*iter)->data == data)
+        {
+            NSTopicSubIndexEntry * del = *iter;
+            *iter = del->next;
+            NSOICFree(del);
+            return;
+        }
+
+        iter = &(*iter)->next;
+    }
+}
+
+static NSCacheTopicSubData * NSProviderFindConsumerTopic(NSCacheElement * conTopicList,
+        const char * cId, const char * topicName)
+{
+    if (NSTopicSubIndexComplete)
+    {
+        NSTopicSubIndexEntry * entry = NSTopicSubIndex[NSTopicSubHash(cId, topicName)];
+
+        for (; entry; entry = entry->next)
+        {
+            if (NSIsSameTopicSub(entry->data, cId, topicName))
+            {
+                return entry->data;
+            }
+        }
+
+        return NULL;
+    }
+
+    for (NSCacheElement * iter = conTopicList; iter; iter = iter->next)
+    {
+        NSCacheTopicSubData * curr = (NSCacheTopicSubData *) iter->data;
+
+        if (NSIsSameTopicSub(curr, cId, topicName))
+        {
+            return curr;
+        }
+    }
+
+    return NULL;
+}
+
 NSCacheList * NSProviderStorageCreate()
 {
     pthread_mutex_lock(&NSCacheMutex);
@@ -217,23 +332,17 @@ NSResult NSProviderStorageWrite(NSCacheList * list, NSCacheElement * newObj)
 
         NS_PROVIDER_DELETE_REGISTERED_TOPIC_DATA(it, topicData, newObj);
     }
-    else if (type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME)
-    {
-        NS_LOG(DEBUG, "Type is REGITSTER TOPIC");
-
-        NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, topicData->topicName);
-
-        NS_PROVIDER_DELETE_REGISTERED_TOPIC_DATA(it, topicData, newObj);
-    }
-    else if (type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID)
+    else if (NSIsConsumerTopicCache(type))
     {
-        NS_LOG(DEBUG, "Type is REGITSTER TOPIC");
+        NS_LOG(DEBUG, "Type is CONSUMER TOPIC");
 
+        // other consumers may have subscribed to the same topic
         NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, topicData->id);
+        NSCacheTopicSubData * it = NSProviderFindConsumerTopic(list->head,
+                topicData->id, topicData->topicName);
 
         NS_PROVIDER_DELETE_REGISTERED_TOPIC_DATA(it, topicData, newObj);
+        NSTopicSubIndexAdd(topicData);
     }
 
     if (list->head == NULL)
@@ -264,6 +373,11 @@ NSResult NSProviderStorageDestroy(NSCacheList * list)
         iter = next;
     }
 
+    if (NSIsConsumerTopicCache(type))
+    {
+        NSTopicSubIndexComplete = true;
+    }
+
     NSOICFree(list);
     return NS_OK;
 }
@@ -398,10 +512,10 @@ NSResult NSProviderDeleteCacheData(NSCacheType type, void * data)
         NSOICFree(topicData->topicName);
         NSOICFree(topicData);
     }
-    else if (type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME ||
-            type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID)
+    else if (NSIsConsumerTopicCache(type))
     {
         NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) data;
+        NSTopicSubIndexRemove(topicData);
         NSOICFree(topicData->topicName);
         NSOICFree(topicData);
     }
@@ -577,23 +691,10 @@ bool NSProviderIsTopicSubScribed(NSCacheElement * conTopicList, char * cId, char
         return false;
     }
 
-    NSCacheElement * iter = conTopicList;
-
-    while (iter)
-    {
-        NSCacheTopicSubData * curr = (NSCacheTopicSubData *) iter->data;
-
-        if ( (strcmp(curr->id, cId) == 0) && (strcmp(curr->topicName, topicName) == 0) )
-        {
-            pthread_mutex_unlock(&NSCacheMutex);
-            return true;
-        }
-
-        iter = iter->next;
-    }
+    bool isSubscribed = NSProviderFindConsumerTopic(conTopicList, cId, topicName) != NULL;
 
     pthread_mutex_unlock(&NSCacheMutex);
-    return false;
+    return isSubscribed;
 }
 
 NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
@@ -22,6 +22,61 @@
 #include "NSProviderListener.h"
 #include "NSProviderSystem.h"
 
+#define NS_OBSERVER_BATCH_INITIAL_SIZE 16
+
+// Observers a message or a sync is sent to, grown with the number of subscribers.
+typedef struct
+{
+    OCObservationId * ids;
+    size_t count;
+    size_t size;
+
+} NSObserverBatch;
+
+static bool NSAddObserverToBatch(NSObserverBatch * batch, OCObservationId id)
+{
+    if (batch->count == batch->size)
+    {
+        size_t size = batch->size ? batch->size * 2 : NS_OBSERVER_BATCH_INITIAL_SIZE;
+        OCObservationId * ids = (OCObservationId *) OICRealloc(batch->ids,
+                size * sizeof(OCObservationId));
+
+        if (!ids)
+        {
+            NS_LOG(ERROR, "Fail to grow observer batch");
+            return false;
+        }
+
+        batch->ids = ids;
+        batch->size = size;
+    }
+
+    batch->ids[batch->count++] = id;
+    return true;
+}
+
+static OCStackResult NSNotifyObserverBatch(OCResourceHandle rHandle, NSObserverBatch * batch,
+        OCRepPayload * payload)
+{
+    OCStackResult result = OC_STACK_OK;
+
+    // The stack takes up to UINT8_MAX observers per call, and encodes the
+    // payload once per call for the observers sharing an accept format.
+    for (size_t i = 0; i < batch->count; i += UINT8_MAX)
+    {
+        size_t count = batch->count - i < UINT8_MAX ? batch->count - i : UINT8_MAX;
+        OCStackResult ret = OCNotifyListOfObservers(rHandle, batch->ids + i, (uint8_t) count,
+                payload, OC_LOW_QOS);
+
+        if (ret != OC_STACK_OK)
+        {
+            result = ret;
+        }
+    }
+
+    return result;
+}
+
 NSResult NSSetMessagePayload(NSMessage *msg, OCRepPayload** msgPayload)
 {
     NS_LOG(DEBUG, "NSSetMessagePayload - IN");
@@ -108,8 +163,8 @@ NSResult NSSendNotification(NSMessage *msg)
     NS_LOG(DEBUG, "NSSendMessage - IN");
 
     OCResourceHandle rHandle;
-    OCObservationId obArray[255] = { 0, };
-    int obCount = 0, i;
+    NSObserverBatch batch = { NULL, 0, 0 };
+    size_t i;
 
     if (NSPutMessageResource(msg, &rHandle) != NS_OK)
     {
@@ -141,6 +196,12 @@ NSResult NSSendNotification(NSMessage *msg)
     }
 
     NSCacheElement * it = consumerSubList->head;
+    bool isTopicMessage = msg->topic && (msg->topic)[0] != '\0';
+
+    if (isTopicMessage)
+    {
+        NS_LOG_V(DEBUG, "this is topic message: %s", msg->topic);
+    }
 
     while (it)
     {
@@ -152,40 +213,19 @@ NSResult NSSendNotification(NSMessage *msg)
         NS_LOG_V(DEBUG, "subData->cloud_syncId = %d", subData->remote_syncObId);
         NS_LOG_V(DEBUG, "subData->isWhite = %d", subData->isWhite);
 
-        if (subData->isWhite)
+        // the topic subscription is looked up once for the local and remote observers
+        if (subData->isWhite && (!isTopicMessage ||
+                NSProviderIsTopicSubScribed(consumerTopicList->head, subData->id, msg->topic)))
         {
-            if(subData->messageObId != 0)
+            if (subData->messageObId != 0)
             {
-                if (msg->topic && (msg->topic)[0] != '\0')
-                {
-                    NS_LOG_V(DEBUG, "this is topic message: %s", msg->topic);
-
-                    if (NSProviderIsTopicSubScribed(consumerTopicList->head, subData->id, msg->topic))
-                    {
-                        obArray[obCount++] = subData->messageObId;
-                    }
-                }
-                else
-                {
-                    obArray[obCount++] = subData->messageObId;
-                }
+                NSAddObserverToBatch(&batch, subData->messageObId);
             }
 
 #if (defined WITH_CLOUD)
             if (subData->remote_messageObId != 0)
             {
-                if (msg->topic && (msg->topic)[0] != '\0')
-                {
-                    NS_LOG_V(DEBUG, "this is topic message via remote server: %s", msg->topic);
-                    if (NSProviderIsTopicSubScribed(consumerTopicList->head, subData->id, msg->topic))
-                    {
-                        obArray[obCount++] = subData->remote_messageObId;
-                    }
-                }
-                else
-                {
-                    obArray[obCount++] = subData->remote_messageObId;
-                }
+                NSAddObserverToBatch(&batch, subData->remote_messageObId);
             }
 #endif
 
@@ -193,37 +233,36 @@ NSResult NSSendNotification(NSMessage *msg)
         it = it->next;
     }
 
-    for (i = 0; i < obCount; ++i)
+    for (i = 0; i < batch.count; ++i)
     {
         NS_LOG(DEBUG, "-------------------------------------------------------message\n");
-        NS_LOG_V(DEBUG, "SubScription WhiteList[%d] = %d", i, obArray[i]);
+        NS_LOG_V(DEBUG, "SubScription WhiteList[%d] = %d", (int) i, batch.ids[i]);
         NS_LOG(DEBUG, "-------------------------------------------------------message\n");
     }
 
-    if (!obCount)
+    if (!batch.count)
     {
         NS_LOG(ERROR, "observer count is zero");
+        NSOICFree(batch.ids);
         OCRepPayloadDestroy(payload);
         msg->extraInfo = NULL;
         return NS_ERROR;
     }
 
-    OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray, obCount, payload,
-            OC_LOW_QOS);
+    OCStackResult ocstackResult = NSNotifyObserverBatch(rHandle, &batch, payload);
 
     NS_LOG_V(DEBUG, "Message ocstackResult = %d", ocstackResult);
 
+    NSOICFree(batch.ids);
+    OCRepPayloadDestroy(payload);
+    msg->extraInfo = NULL;
+
     if (ocstackResult != OC_STACK_OK)
     {
         NS_LOG(ERROR, "fail to send message");
-        OCRepPayloadDestroy(payload);
-        msg->extraInfo = NULL;
         return NS_ERROR;
     }
 
-    OCRepPayloadDestroy(payload);
-    msg->extraInfo = NULL;
-
     NS_LOG(DEBUG, "NSSendMessage - OUT");
     return NS_OK;
 }
@@ -232,9 +271,8 @@ NSResult NSSendSync(NSSyncInfo *sync)
 {
     NS_LOG(DEBUG, "NSSendSync - IN");
 
-    OCObservationId obArray[255] = { 0, };
-    int obCount = 0;
-    int i;
+    NSObserverBatch batch = { NULL, 0, 0 };
+    size_t i;
 
     OCResourceHandle rHandle;
     if (NSPutSyncResource(sync, &rHandle) != NS_OK)
@@ -259,13 +297,13 @@ NSResult NSSendSync(NSSyncInfo *sync)
         {
             if (subData->syncObId != 0)
             {
-                obArray[obCount++] = subData->syncObId;
+                NSAddObserverToBatch(&batch, subData->syncObId);
             }
 
 #if (defined WITH_CLOUD)
             if (subData->remote_syncObId != 0)
             {
-                obArray[obCount++] = subData->remote_syncObId;
+                NSAddObserverToBatch(&batch, subData->remote_syncObId);
             }
 #endif
         }
@@ -276,6 +314,7 @@ NSResult NSSendSync(NSSyncInfo *sync)
     if (NSSetSyncPayload(sync, &payload) != NS_OK)
     {
         NS_LOG(ERROR, "Failed to allocate payload");
+        NSOICFree(batch.ids);
         return NS_ERROR;
     }
 
@@ -299,26 +338,26 @@ NSResult NSSendSync(NSSyncInfo *sync)
     }
 #endif
 
-    for (i = 0; i < obCount; ++i)
+    for (i = 0; i < batch.count; ++i)
     {
         NS_LOG(DEBUG, "-------------------------------------------------------message\n");
-        NS_LOG_V(DEBUG, "Sync WhiteList[%d] = %d", i, obArray[i]);
+        NS_LOG_V(DEBUG, "Sync WhiteList[%d] = %d", (int) i, batch.ids[i]);
         NS_LOG(DEBUG, "-------------------------------------------------------message\n");
     }
 
-    OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray,
-            obCount, payload, OC_LOW_QOS);
+    OCStackResult ocstackResult = NSNotifyObserverBatch(rHandle, &batch, payload);
 
     NS_LOG_V(DEBUG, "Sync ocstackResult = %d", ocstackResult);
+
+    NSOICFree(batch.ids);
+    OCRepPayloadDestroy(payload);
+
     if (ocstackResult != OC_STACK_OK)
     {
         NS_LOG(ERROR, "fail to send Sync");
-        OCRepPayloadDestroy(payload);
         return NS_ERROR;
     }
 
-    OCRepPayloadDestroy(payload);
-
     NS_LOG(DEBUG, "NSSendSync - OUT");
     return NS_OK;
 }
@@ -0,0 +1,294 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <HippoMocks/hippomocks.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "NSProviderMemoryCache.h"
+#include "NSProviderNotification.h"
+
+NSResult NSSendNotification(NSMessage *msg);
+
+// set by the test to make the allocations of NSProviderMemoryCache.c fail
+extern bool NSCacheTestFailMalloc;
+}
+
+namespace
+{
+    const int g_consumerCount = 1000;
+    const int g_topicCount = 50;
+    const int g_topicsPerConsumer = 5;
+
+    std::string consumerId(int i)
+    {
+        char id[NS_UUID_STRING_SIZE];
+        snprintf(id, sizeof(id), "00000000-0000-0000-0000-%012d", i);
+        return id;
+    }
+
+    std::string topicName(int i)
+    {
+        return "TOPIC" + std::to_string(i);
+    }
+
+    NSCacheList * createList(NSCacheType type)
+    {
+        NSCacheList * list = NSProviderStorageCreate();
+        if (list)
+        {
+            list->cacheType = type;
+        }
+        return list;
+    }
+
+    NSResult writeSubscriber(NSCacheList * list, const std::string & id, int obId)
+    {
+        NSCacheSubData * subData = (NSCacheSubData *) OICCalloc(1, sizeof(NSCacheSubData));
+        NSCacheElement * element = (NSCacheElement *) OICCalloc(1, sizeof(NSCacheElement));
+        OICStrcpy(subData->id, sizeof(subData->id), id.c_str());
+        subData->messageObId = obId;
+        subData->syncObId = obId;
+        subData->isWhite = true;
+        element->data = (NSCacheData *) subData;
+        return NSProviderStorageWrite(list, element);
+    }
+
+    NSResult writeConsumerTopic(NSCacheList * list, const std::string & id,
+            const std::string & topic)
+    {
+        NSCacheTopicSubData * topicData =
+                (NSCacheTopicSubData *) OICCalloc(1, sizeof(NSCacheTopicSubData));
+        NSCacheElement * element = (NSCacheElement *) OICCalloc(1, sizeof(NSCacheElement));
+        OICStrcpy(topicData->id, sizeof(topicData->id), id.c_str());
+        topicData->topicName = OICStrdup(topic.c_str());
+        element->data = (NSCacheData *) topicData;
+        return NSProviderStorageWrite(list, element);
+    }
+
+    bool isSubscribed(NSCacheList * list, const std::string & id, const std::string & topic)
+    {
+        return NSProviderIsTopicSubScribed(list->head, (char *) id.c_str(),
+                (char *) topic.c_str());
+    }
+
+    // consumer i subscribes topics i .. i + g_topicsPerConsumer - 1, modulo g_topicCount
+    bool isExpectedSubscription(int consumer, int topic)
+    {
+        return (topic - consumer % g_topicCount + g_topicCount) % g_topicCount
+                < g_topicsPerConsumer;
+    }
+}
+
+class NotificationProviderCacheTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        pthread_mutexattr_init(&NSCacheMutexAttr);
+        pthread_mutexattr_settype(&NSCacheMutexAttr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&NSCacheMutex, &NSCacheMutexAttr);
+
+        consumerSubList = createList(NS_PROVIDER_CACHE_SUBSCRIBER);
+        consumerTopicList = createList(NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID);
+        ASSERT_NE(nullptr, consumerSubList);
+        ASSERT_NE(nullptr, consumerTopicList);
+    }
+
+    virtual void TearDown()
+    {
+        NSProviderStorageDestroy(consumerSubList);
+        NSProviderStorageDestroy(consumerTopicList);
+        consumerSubList = NULL;
+        consumerTopicList = NULL;
+
+        pthread_mutex_destroy(&NSCacheMutex);
+        pthread_mutexattr_destroy(&NSCacheMutexAttr);
+    }
+
+    void writeTopicSubscriptions()
+    {
+        for (int i = 0; i < g_consumerCount; i++)
+        {
+            for (int j = 0; j < g_topicsPerConsumer; j++)
+            {
+                ASSERT_EQ(NS_OK, writeConsumerTopic(consumerTopicList, consumerId(i),
+                        topicName((i + j) % g_topicCount)));
+            }
+        }
+    }
+
+    void expectTopicSubscriptions()
+    {
+        for (int i = 0; i < g_consumerCount; i++)
+        {
+            for (int j = 0; j < g_topicCount; j++)
+            {
+                EXPECT_EQ(isExpectedSubscription(i, j),
+                        isSubscribed(consumerTopicList, consumerId(i), topicName(j)));
+            }
+        }
+    }
+};
+
+TEST_F(NotificationProviderCacheTest, ExpectConsumerTopicFoundUntilDeleted)
+{
+    EXPECT_EQ(NS_OK, writeConsumerTopic(consumerTopicList, consumerId(1), "TOPIC"));
+    EXPECT_EQ(NS_OK, writeConsumerTopic(consumerTopicList, consumerId(2), "TOPIC"));
+    EXPECT_EQ(NS_FAIL, writeConsumerTopic(consumerTopicList, consumerId(1), "TOPIC"));
+
+    EXPECT_TRUE(isSubscribed(consumerTopicList, consumerId(1), "TOPIC"));
+    EXPECT_TRUE(isSubscribed(consumerTopicList, consumerId(2), "TOPIC"));
+    EXPECT_FALSE(isSubscribed(consumerTopicList, consumerId(3), "TOPIC"));
+    EXPECT_FALSE(isSubscribed(consumerTopicList, consumerId(1), "OTHER"));
+
+    NSCacheTopicSubData topicData = { { 0 }, (char *) "TOPIC" };
+    OICStrcpy(topicData.id, sizeof(topicData.id), consumerId(1).c_str());
+    EXPECT_EQ(NS_OK, NSProviderDeleteConsumerTopic(consumerTopicList, &topicData));
+
+    EXPECT_FALSE(isSubscribed(consumerTopicList, consumerId(1), "TOPIC"));
+    EXPECT_TRUE(isSubscribed(consumerTopicList, consumerId(2), "TOPIC"));
+}
+
+TEST_F(NotificationProviderCacheTest, ExpectTopicLookupsWalkListWhenIndexIsIncomplete)
+{
+    EXPECT_EQ(NS_OK, writeConsumerTopic(consumerTopicList, consumerId(1), "TOPIC"));
+
+    // the subscription is stored, only its index entry is missing
+    NSCacheTestFailMalloc = true;
+    NSResult result = writeConsumerTopic(consumerTopicList, consumerId(2), "TOPIC");
+    NSCacheTestFailMalloc = false;
+    EXPECT_EQ(NS_OK, result);
+
+    EXPECT_EQ(NS_OK, writeConsumerTopic(consumerTopicList, consumerId(3), "TOPIC"));
+    EXPECT_EQ(NS_FAIL, writeConsumerTopic(consumerTopicList, consumerId(2), "TOPIC"));
+
+    EXPECT_TRUE(isSubscribed(consumerTopicList, consumerId(1), "TOPIC"));
+    EXPECT_TRUE(isSubscribed(consumerTopicList, consumerId(2), "TOPIC"));
+    EXPECT_TRUE(isSubscribed(consumerTopicList, consumerId(3), "TOPIC"));
+    EXPECT_FALSE(isSubscribed(consumerTopicList, consumerId(4), "TOPIC"));
+
+    NSCacheTopicSubData topicData = { { 0 }, (char *) "TOPIC" };
+    OICStrcpy(topicData.id, sizeof(topicData.id), consumerId(2).c_str());
+    EXPECT_EQ(NS_OK, NSProviderDeleteConsumerTopic(consumerTopicList, &topicData));
+    EXPECT_FALSE(isSubscribed(consumerTopicList, consumerId(2), "TOPIC"));
+    EXPECT_TRUE(isSubscribed(consumerTopicList, consumerId(3), "TOPIC"));
+
+    // the index is used again for a new list
+    NSProviderStorageDestroy(consumerTopicList);
+    consumerTopicList = createList(NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID);
+    ASSERT_NE(nullptr, consumerTopicList);
+
+    EXPECT_EQ(NS_OK, writeConsumerTopic(consumerTopicList, consumerId(2), "TOPIC"));
+    EXPECT_TRUE(isSubscribed(consumerTopicList, consumerId(2), "TOPIC"));
+    EXPECT_FALSE(isSubscribed(consumerTopicList, consumerId(1), "TOPIC"));
+}
+
+// Checks the topic subscriptions of every subscriber as NSSendNotification does,
+// for g_consumerCount consumers subscribed to g_topicsPerConsumer of g_topicCount topics.
+TEST_F(NotificationProviderCacheTest, TopicSubscriptionLookupTime)
+{
+    for (int i = 0; i < g_consumerCount; i++)
+    {
+        ASSERT_EQ(NS_OK, writeSubscriber(consumerSubList, consumerId(i), i % UINT8_MAX + 1));
+    }
+    writeTopicSubscriptions();
+
+    auto start = std::chrono::steady_clock::now();
+
+    size_t found = 0;
+    for (int i = 0; i < g_topicCount; i++)
+    {
+        std::string topic = topicName(i);
+        for (NSCacheElement * it = consumerSubList->head; it; it = it->next)
+        {
+            NSCacheSubData * subData = (NSCacheSubData *) it->data;
+            if (NSProviderIsTopicSubScribed(consumerTopicList->head, subData->id,
+                    (char *) topic.c_str()))
+            {
+                found++;
+            }
+        }
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    std::cout << g_topicCount << " topic messages to " << g_consumerCount << " consumers: "
+              << elapsed / g_topicCount << " us per message" << std::endl;
+
+    EXPECT_EQ((size_t) (g_consumerCount * g_topicsPerConsumer), found);
+    expectTopicSubscriptions();
+}
+
+TEST_F(NotificationProviderCacheTest, ExpectTopicMessageSentToSubscribersInBatches)
+{
+    writeTopicSubscriptions();
+
+    // more subscribers than OCNotifyListOfObservers takes at once
+    std::vector<OCObservationId> expected;
+    for (int i = 0; i < g_consumerCount; i++)
+    {
+        OCObservationId obId = (OCObservationId) (i % UINT8_MAX + 1);
+        ASSERT_EQ(NS_OK, writeSubscriber(consumerSubList, consumerId(i), obId));
+        if (isExpectedSubscription(i, 0))
+        {
+            expected.push_back(obId);
+        }
+    }
+    for (int i = 0; i < g_consumerCount; i++)
+    {
+        expected.push_back((OCObservationId) (i % UINT8_MAX + 1));
+    }
+
+    std::vector<OCObservationId> notified;
+    std::vector<uint8_t> batchSizes;
+
+    MockRepository mocks;
+    mocks.OnCallFunc(NSPutMessageResource).Return(NS_OK);
+    mocks.OnCallFunc(OCNotifyListOfObservers).Do(
+        [&notified, &batchSizes](OCResourceHandle, OCObservationId * obIdList,
+                uint8_t numberOfIds, const OCRepPayload *, OCQualityOfService)
+        {
+            notified.insert(notified.end(), obIdList, obIdList + numberOfIds);
+            batchSizes.push_back(numberOfIds);
+            return OC_STACK_OK;
+        });
+
+    NSMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.messageId = 1;
+    msg.topic = (char *) "TOPIC0";
+    EXPECT_EQ(NS_OK, NSSendNotification(&msg));
+
+    // a message without topic goes to every subscriber
+    msg.messageId = 2;
+    msg.topic = NULL;
+    EXPECT_EQ(NS_OK, NSSendNotification(&msg));
+
+    EXPECT_EQ(expected, notified);
+    std::vector<uint8_t> expectedSizes = { 100, UINT8_MAX, UINT8_MAX, UINT8_MAX,
+                                           g_consumerCount - 3 * UINT8_MAX };
+    EXPECT_EQ(expectedSizes, batchSizes);
+}
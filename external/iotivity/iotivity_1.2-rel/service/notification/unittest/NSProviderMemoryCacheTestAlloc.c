@@ -0,0 +1,38 @@
+//******************************************************************
+//
+// Copyright 2017 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+// NSProviderMemoryCache.c built in place of the one of the provider library,
+// with allocations that NSProviderMemoryCacheTest.cpp can make fail.
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include "oic_malloc.h"
+
+bool NSCacheTestFailMalloc = false;
+
+static void * NSCacheTestMalloc(size_t size)
+{
+    return NSCacheTestFailMalloc ? NULL : malloc(size);
+}
+
+#undef OICMalloc
+#define OICMalloc(x) NSCacheTestMalloc(x)
+
+#include "../src/provider/NSProviderMemoryCache.c"
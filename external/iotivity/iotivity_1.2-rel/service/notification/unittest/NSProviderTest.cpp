@@ -476,6 +476,25 @@ TEST_F(NotificationProviderTest, ExpectEqualUnSetConsumerTopicsAndGetConsumerTop
     EXPECT_EQ(isSame, true);
 }
 
+TEST_F(NotificationProviderTest, ExpectSuccessSetSameConsumerTopicForTwoConsumers)
+{
+    std::string str("TEST1");
+    std::string otherConsumerID("00000000-0000-0000-0000-000000000001");
+    NSProviderRegisterTopic(str.c_str());
+
+    ASSERT_NE(nullptr, g_consumerID) << "error: discovery failure";
+
+    EXPECT_EQ(NS_OK, NSProviderSetConsumerTopic(g_consumerID, str.c_str()));
+    EXPECT_EQ(NS_OK, NSProviderSetConsumerTopic(otherConsumerID.c_str(), str.c_str()));
+
+    NSTopicLL * topics = NSProviderGetConsumerTopics(otherConsumerID.c_str());
+
+    ASSERT_NE(nullptr, topics);
+    EXPECT_EQ(NS_TOPIC_SUBSCRIBED, topics->state);
+
+    NSProviderUnregisterTopic(str.c_str());
+}
+
 TEST_F(NotificationProviderTest, ExpectFailAcceptSubscription)
 {
     NSResult result;
@@ -27,6 +27,7 @@
 #ifndef RCSREMOTERESOURCEOBJECT_H
 #define RCSREMOTERESOURCEOBJECT_H
 
+#include <chrono>
 #include <vector>
 
 #include "RCSResourceAttributes.h"
@@ -350,8 +351,12 @@ namespace OIC
              *
              * @param cb If non-empty function, it will be invoked whenever the cache updated.
              * @param mode if CacheMode is OBSERVE_ONLY, it will be invoked when receive observe response only.
+             * @param minReportInterval Minimum time between two invocations of cb. Updates
+             *                          arriving faster are coalesced, and cb gets the latest
+             *                          attributes once the interval has passed.
              *
              * @throws BadRequestException If caching is already started.
+             * @throws InvalidParameterException If minReportInterval is negative.
              *
              * @note The callback will be invoked in an internal thread.
              *
@@ -362,7 +367,8 @@ namespace OIC
              * @see getCachedAttribute(const std::string&) const
              *
              */
-            void startCaching(CacheUpdatedCallback cb, CacheMode mode = CacheMode::OBSERVE_WITH_POLLING);
+            void startCaching(CacheUpdatedCallback cb, CacheMode mode = CacheMode::OBSERVE_WITH_POLLING,
+                    std::chrono::milliseconds minReportInterval = std::chrono::milliseconds::zero());
 
             /**
              * Stops caching.
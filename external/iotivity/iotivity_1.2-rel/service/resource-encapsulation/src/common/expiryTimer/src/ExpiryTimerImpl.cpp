@@ -22,6 +22,8 @@
 
 #include "RCSException.h"
 
+#include "CallbackExecutor.h"
+
 namespace OIC
 {
     namespace Service
@@ -30,6 +32,15 @@ namespace OIC
         namespace
         {
             constexpr ExpiryTimerImpl::Id INVALID_ID{ 0U };
+
+            // Expiries run on their own executor, apart from the client
+            // callbacks, so that busy or blocked callbacks never delay them.
+            // Never destroyed, like the executor of the client callbacks.
+            OC::CallbackExecutor& timerExecutor()
+            {
+                static OC::CallbackExecutor* executor = new OC::CallbackExecutor(1, 0);
+                return *executor;
+            }
         }
 
         ExpiryTimerImpl::ExpiryTimerImpl() :
@@ -209,7 +220,7 @@ namespace OIC
             ExpiryTimerImpl::Id id { m_id };
             m_id = INVALID_ID;
 
-            std::thread(std::move(m_callback), id).detach();
+            timerExecutor().post(std::bind(std::move(m_callback), id));
 
             m_callback = ExpiryTimerImpl::Callback{ };
         }
@@ -21,10 +21,13 @@
 #ifndef RCM_CACHETYPES_H
 #define RCM_CACHETYPES_H
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 #include "logger.h"
 
@@ -38,6 +41,10 @@ namespace OIC
 
         class DataCache;
 
+        // attributes received from the resource, shared by the cache and the
+        // reports to its subscribers instead of being copied for each of them
+        typedef std::shared_ptr<const RCSResourceAttributes> CachedAttributesPtr;
+
 #define CACHE_TAG  "CACHE"
 #define CACHE_DEFAULT_REPORT_MILLITIME 10000
 #define CACHE_DEFAULT_EXPIRED_MILLITIME 15000
@@ -53,8 +60,17 @@ namespace OIC
         {
             REPORT_FREQUENCY rf;
             int reportID;
+            // for UPTODATE, the minimum milliseconds between two reports (0 for no limit)
             long repeatTime;
             unsigned int timerID;
+
+            // UPTODATE reports are coalesced: a subscriber still busy with a report,
+            // or reported less than repeatTime ago, only gets the latest attributes
+            CachedAttributesPtr pending;
+            bool scheduled;
+            std::chrono::steady_clock::time_point lastReport;
+            // the thread calling the subscriber, std::thread::id() when none is
+            std::thread::id delivering;
         };
 
         enum class CACHE_STATE
@@ -83,7 +99,7 @@ namespace OIC
 
         typedef std::function<OCStackResult(std::shared_ptr<PrimitiveResource>,
                                             const RCSResourceAttributes &)> CacheCB;
-        typedef std::map<int, std::pair<Report_Info, CacheCB>> SubscriberInfo;
+        typedef std::unordered_map<int, std::pair<Report_Info, CacheCB>> SubscriberInfo;
         typedef std::pair<int, std::pair<Report_Info, CacheCB>> SubscriberInfoPair;
 
         typedef OC::OCResource BaseResource;
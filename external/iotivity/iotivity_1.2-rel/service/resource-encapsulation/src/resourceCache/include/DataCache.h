@@ -21,6 +21,7 @@
 #ifndef RCM_DATACACHE_H_
 #define RCM_DATACACHE_H_
 
+#include <condition_variable>
 #include <list>
 #include <string>
 #include <memory>
@@ -66,7 +67,7 @@ namespace OIC
                 PrimitiveResourcePtr sResource;
 
                 // cached data info
-                RCSResourceAttributes attributes;
+                CachedAttributesPtr attributes;
                 CACHE_STATE state;
                 CACHE_MODE mode;
                 bool isReady;
@@ -75,9 +76,13 @@ namespace OIC
                 std::unique_ptr<SubscriberInfo> subscriberList;
                 mutable std::mutex m_mutex;
                 mutable std::mutex att_mutex;
+                // signaled under m_mutex when a report has been delivered
+                std::condition_variable m_delivered;
 
                 ExpiryTimer networkTimer;
                 ExpiryTimer pollingTimer;
+                // delays the reports of rate-limited subscribers, used under m_mutex
+                ExpiryTimer reportTimer;
                 TimerID networkTimeOutHandle;
                 TimerID pollingHandle;
 
@@ -92,13 +97,17 @@ namespace OIC
                 void onObserve(const HeaderOptions &_hos,
                                const ResponseStatement &_rep, int _result, unsigned int _seq);
                 void onGet(const HeaderOptions &_hos, const ResponseStatement &_rep, int _result);
+                void onReport(CacheID id);
+                void onReportTime(CacheID id);
             private:
                 void onTimeOut(const unsigned int timerID);
                 void onPollingOut(const unsigned int timerID);
 
                 CacheID generateCacheID();
                 SubscriberInfoPair findSubscriber(CacheID id);
-                void notifyObservers(const RCSResourceAttributes Att);
+                void notifyObservers(const RCSResourceAttributes &Att);
+                void postReport(CacheID id, Report_Info &info);
+                void endDelivery(CacheID id);
         };
     } // namespace Service
 } // namespace OIC
@@ -24,7 +24,7 @@
 #include <list>
 #include <string>
 #include <mutex>
-#include <map>
+#include <unordered_map>
 
 #include "CacheTypes.h"
 #include "DataCache.h"
@@ -72,11 +72,12 @@ namespace OIC
                 static ResourceCacheManager *s_instance;
                 static std::mutex s_mutex;
                 static std::mutex s_mutexForCreation;
-                static std::unique_ptr<std::list<DataCachePtr>> s_cacheDataList;
-                std::map<CacheID, DataCachePtr> cacheIDmap;
+                // data caches by resource host and uri
+                static std::unique_ptr<std::unordered_map<std::string, DataCachePtr>> s_cacheDataMap;
+                std::unordered_map<CacheID, DataCachePtr> cacheIDmap;
 
                 std::list<ObserveCache::Ptr> m_observeCacheList;
-                std::map<CacheID, ObserveCache::Ptr> observeCacheIDmap;
+                std::unordered_map<CacheID, ObserveCache::Ptr> observeCacheIDmap;
 
                 ResourceCacheManager() = default;
                 ~ResourceCacheManager();
@@ -87,6 +88,7 @@ namespace OIC
                 ResourceCacheManager &operator=(ResourceCacheManager && ) const = delete;
 
                 static void initializeResourceCacheManager();
+                static std::string getCacheKey(PrimitiveResourcePtr pResource);
                 DataCachePtr findDataCache(PrimitiveResourcePtr pResource) const;
                 DataCachePtr findDataCache(CacheID id) const;
         };
@@ -30,6 +30,7 @@
 #include "ResponseStatement.h"
 #include "RCSResourceAttributes.h"
 #include "ExpiryTimer.h"
+#include "CallbackExecutor.h"
 
 #include "ocrandom.h"
 
@@ -40,6 +41,12 @@ namespace OIC
 
         namespace
         {
+            // threads delivering the reports: kept alive, and at most
+            constexpr size_t REPORT_THREADS{ 1 };
+            constexpr size_t REPORT_MAX_THREADS{ 4 };
+            // reports waiting in all
+            constexpr size_t REPORT_MAX_QUEUED{ 1024 };
+
             void verifyObserveCB(
                 const HeaderOptions &_hos, const ResponseStatement &_rep,
                 int _result, unsigned int _seq, std::weak_ptr<DataCache> rpPtr)
@@ -75,6 +82,35 @@ namespace OIC
                                  std::placeholders::_1, std::placeholders::_2,
                                  std::placeholders::_3, rpPtr);
             }
+
+            void verifyReportCB(CacheID id, std::weak_ptr<DataCache> rpPtr)
+            {
+                std::shared_ptr<DataCache> ptr = rpPtr.lock();
+                if (ptr)
+                {
+                    ptr->onReport(id);
+                }
+            }
+
+            void verifyReportTimeCB(CacheID id, std::weak_ptr<DataCache> rpPtr)
+            {
+                std::shared_ptr<DataCache> ptr = rpPtr.lock();
+                if (ptr)
+                {
+                    ptr->onReportTime(id);
+                }
+            }
+
+            // Reports run on their own executor, apart from the client callbacks
+            // of the stack. A subscriber has at most one report queued, so the
+            // queue is bounded by the subscribers. Never destroyed, like the
+            // executor of the client callbacks.
+            OC::CallbackExecutor& reportExecutor()
+            {
+                static OC::CallbackExecutor* executor = new OC::CallbackExecutor(
+                        REPORT_THREADS, 0, REPORT_MAX_THREADS, REPORT_MAX_QUEUED);
+                return *executor;
+            }
         }
 
         DataCache::DataCache()
@@ -82,6 +118,7 @@ namespace OIC
             subscriberList = std::unique_ptr<SubscriberInfo>(new SubscriberInfo());
 
             sResource = nullptr;
+            attributes = std::make_shared<const RCSResourceAttributes>();
 
             state = CACHE_STATE::READY_YET;
             mode = CACHE_MODE::FREQUENCY;
@@ -137,6 +174,9 @@ namespace OIC
             newItem.rf = rf;
             newItem.repeatTime = repeatTime;
             newItem.timerID = 0;
+            newItem.scheduled = false;
+            newItem.lastReport =
+                std::chrono::steady_clock::now() - std::chrono::milliseconds(repeatTime);
 
             newItem.reportID = generateCacheID();
 
@@ -152,18 +192,29 @@ namespace OIC
 
         CacheID DataCache::deleteSubscriber(CacheID id)
         {
-            CacheID ret = 0;
+            std::unique_lock<std::mutex> lock(m_mutex);
 
-            SubscriberInfoPair pair = findSubscriber(id);
+            // the subscriber is not called once this returns, so a report being
+            // delivered is waited for, unless the subscriber deletes itself from it
+            auto found = subscriberList->find(id);
+            m_delivered.wait(lock, [&]()
+            {
+                found = subscriberList->find(id);
+                if (found == subscriberList->end())
+                {
+                    return true;
+                }
+                std::thread::id delivering = found->second.first.delivering;
+                return delivering == std::thread::id()
+                       || delivering == std::this_thread::get_id();
+            });
 
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if (pair.first != 0)
+            if (found == subscriberList->end())
             {
-                ret = pair.first;
-                subscriberList->erase(pair.first);
+                return 0;
             }
-
-            return ret;
+            subscriberList->erase(found);
+            return id;
         }
 
         SubscriberInfoPair DataCache::findSubscriber(CacheID id)
@@ -171,14 +222,10 @@ namespace OIC
             SubscriberInfoPair ret;
 
             std::lock_guard<std::mutex> lock(m_mutex);
-            for (auto &i : *subscriberList)
+            auto found = subscriberList->find(id);
+            if (found != subscriberList->end())
             {
-                if (i.first == id)
-                {
-                    ret = std::make_pair(i.first, std::make_pair((Report_Info)i.second.first,
-                                         (CacheCB)i.second.second));
-                    break;
-                }
+                ret = *found;
             }
 
             return ret;
@@ -191,12 +238,16 @@ namespace OIC
 
         const RCSResourceAttributes DataCache::getCachedData() const
         {
-            std::lock_guard<std::mutex> lock(att_mutex);
-            if (state != CACHE_STATE::READY)
+            CachedAttributesPtr attrs;
             {
-                return RCSResourceAttributes();
+                std::lock_guard<std::mutex> lock(att_mutex);
+                if (state != CACHE_STATE::READY)
+                {
+                    return RCSResourceAttributes();
+                }
+                attrs = attributes;
             }
-            return attributes;
+            return *attrs;
         }
 
         bool DataCache::isCachedData() const
@@ -260,25 +311,125 @@ namespace OIC
             notifyObservers(_rep.getAttributes());
         }
 
-        void DataCache::notifyObservers(const RCSResourceAttributes Att)
+        void DataCache::notifyObservers(const RCSResourceAttributes &Att)
         {
+            CachedAttributesPtr attrs;
             {
                 std::lock_guard<std::mutex> lock(att_mutex);
-                if (attributes == Att)
+                attrs = attributes;
+            }
+            if (*attrs == Att)
+            {
+                return;
+            }
+
+            // copied once, outside of the locks, then shared with every report
+            attrs = std::make_shared<const RCSResourceAttributes>(Att);
+            {
+                std::lock_guard<std::mutex> lock(att_mutex);
+                attributes = attrs;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto &i : * subscriberList)
+            {
+                Report_Info &info = i.second.first;
+                if (info.rf != REPORT_FREQUENCY::UPTODATE)
+                {
+                    continue;
+                }
+
+                // a report already posted or running picks up the latest attributes
+                info.pending = attrs;
+                if (!info.scheduled)
                 {
-                    return;
+                    postReport(i.first, info);
                 }
-                attributes = Att;
             }
+        }
+
+        void DataCache::postReport(CacheID id, Report_Info &info)
+        {
+            // when rejected, the next update posts it again
+            info.scheduled = reportExecutor().post(
+                std::bind(verifyReportCB, id, std::weak_ptr<DataCache>(shared_from_this())));
+        }
 
+        void DataCache::onReportTime(CacheID id)
+        {
             std::lock_guard<std::mutex> lock(m_mutex);
-            for (auto &i : * subscriberList)
+            auto found = subscriberList->find(id);
+            if (found != subscriberList->end())
+            {
+                postReport(id, found->second.first);
+            }
+        }
+
+        void DataCache::onReport(CacheID id)
+        {
+            while (true)
+            {
+                CacheCB func;
+                CachedAttributesPtr attrs;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto found = subscriberList->find(id);
+                    if (found == subscriberList->end())
+                    {
+                        return;
+                    }
+
+                    Report_Info &info = found->second.first;
+                    if (!info.pending)
+                    {
+                        info.scheduled = false;
+                        return;
+                    }
+
+                    auto now = std::chrono::steady_clock::now();
+                    auto next = info.lastReport + std::chrono::milliseconds(info.repeatTime);
+                    if (now < next)
+                    {
+                        // reported too recently, the latest attributes go out once
+                        // the interval has passed (rounded up to the next millisecond)
+                        reportTimer.post(
+                            std::chrono::duration_cast<std::chrono::milliseconds>(
+                                next - now).count() + 1,
+                            std::bind(verifyReportTimeCB, id,
+                                      std::weak_ptr<DataCache>(shared_from_this())));
+                        return;
+                    }
+
+                    attrs = std::move(info.pending);
+                    info.lastReport = now;
+                    info.delivering = std::this_thread::get_id();
+                    func = found->second.second;
+                }
+
+                try
+                {
+                    func(sResource, *attrs);
+                }
+                catch (...)
+                {
+                    endDelivery(id);
+                    throw;
+                }
+                endDelivery(id);
+            }
+        }
+
+        void DataCache::endDelivery(CacheID id)
+        {
             {
-                if (i.second.first.rf == REPORT_FREQUENCY::UPTODATE)
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto found = subscriberList->find(id);
+                if (found != subscriberList->end())
                 {
-                    i.second.second(this->sResource, Att);
+                    found->second.first.delivering = std::thread::id();
                 }
             }
+            m_delivered.notify_all();
         }
 
         CACHE_STATE DataCache::getCacheState() const
@@ -29,14 +29,15 @@ namespace OIC
         ResourceCacheManager *ResourceCacheManager::s_instance = NULL;
         std::mutex ResourceCacheManager::s_mutexForCreation;
         std::mutex ResourceCacheManager::s_mutex;
-        std::unique_ptr<std::list<DataCachePtr>> ResourceCacheManager::s_cacheDataList(nullptr);
+        std::unique_ptr<std::unordered_map<std::string, DataCachePtr>>
+            ResourceCacheManager::s_cacheDataMap(nullptr);
 
         ResourceCacheManager::~ResourceCacheManager()
         {
             std::lock_guard<std::mutex> lock(s_mutex);
-            if (s_cacheDataList != nullptr)
+            if (s_cacheDataMap != nullptr)
             {
-                s_cacheDataList->clear();
+                s_cacheDataMap->clear();
             }
         }
 
@@ -94,7 +95,8 @@ namespace OIC
                 {
                     throw RCSInvalidParameterException {"[requestResourceCache] CacheCB is invaild"};
                 }
-                if (!reportTime)
+                // for UPTODATE, the time limits the rate of the reports and 0 means no limit
+                if (!reportTime && rf == REPORT_FREQUENCY::PERIODICTY)
                 {
                     // default setting
                     reportTime = CACHE_DEFAULT_REPORT_MILLITIME;
@@ -107,10 +109,11 @@ namespace OIC
                 std::lock_guard<std::mutex> lock(s_mutex);
                 newHandler.reset(new DataCache());
                 newHandler->initializeDataCache(pResource);
-                s_cacheDataList->push_back(newHandler);
+                s_cacheDataMap->insert(std::make_pair(getCacheKey(pResource), newHandler));
             }
             retID = newHandler->addSubscriber(func, rf, reportTime);
 
+            std::lock_guard<std::mutex> lock(s_mutex);
             cacheIDmap.insert(std::make_pair(retID, newHandler));
 
             return retID;
@@ -138,14 +141,15 @@ namespace OIC
             if (foundCacheHandler != nullptr)
             {
                 CacheID retID = foundCacheHandler->deleteSubscriber(id);
+                std::lock_guard<std::mutex> lock(s_mutex);
                 if (retID == id)
                 {
                     cacheIDmap.erase(id);
                 }
-                std::lock_guard<std::mutex> lock(s_mutex);
                 if (foundCacheHandler->isEmptySubscriber())
                 {
-                    s_cacheDataList->remove(foundCacheHandler);
+                    s_cacheDataMap->erase(
+                        getCacheKey(foundCacheHandler->getPrimitiveResource()));
                 }
             }
         }
@@ -237,25 +241,28 @@ namespace OIC
         void ResourceCacheManager::initializeResourceCacheManager()
         {
             std::lock_guard<std::mutex> lock(s_mutex);
-            if (s_cacheDataList == nullptr)
+            if (s_cacheDataMap == nullptr)
             {
-                s_cacheDataList
-                    = std::unique_ptr<std::list<DataCachePtr>>(new std::list<DataCachePtr>);
+                s_cacheDataMap = std::unique_ptr<std::unordered_map<std::string, DataCachePtr>>(
+                    new std::unordered_map<std::string, DataCachePtr>);
             }
         }
 
+        std::string ResourceCacheManager::getCacheKey(PrimitiveResourcePtr pResource)
+        {
+            // a space, which neither a host nor a URI contains, keeps the pairs distinct
+            return pResource->getHost() + ' ' + pResource->getUri();
+        }
+
         DataCachePtr ResourceCacheManager::findDataCache(PrimitiveResourcePtr pResource) const
         {
             DataCachePtr retHandler = nullptr;
+            std::string key = getCacheKey(pResource);
             std::lock_guard<std::mutex> lock(s_mutex);
-            for (auto &i : * s_cacheDataList)
+            auto found = s_cacheDataMap->find(key);
+            if (found != s_cacheDataMap->end())
             {
-                if (i->getPrimitiveResource()->getUri() == pResource->getUri() &&
-                    i->getPrimitiveResource()->getHost() == pResource->getHost())
-                {
-                    retHandler = i;
-                    break;
-                }
+                retHandler = found->second;
             }
             return retHandler;
         }
@@ -263,13 +270,11 @@ namespace OIC
         DataCachePtr ResourceCacheManager::findDataCache(CacheID id) const
         {
             DataCachePtr retHandler = nullptr;
-            for (auto it : cacheIDmap)
+            std::lock_guard<std::mutex> lock(s_mutex);
+            auto found = cacheIDmap.find(id);
+            if (found != cacheIDmap.end())
             {
-                if (it.first == id)
-                {
-                    retHandler = it.second;
-                    break;
-                }
+                retHandler = found->second;
             }
 
             return retHandler;
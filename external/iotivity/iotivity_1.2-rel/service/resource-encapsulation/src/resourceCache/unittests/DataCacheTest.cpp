@@ -18,7 +18,10 @@
 //
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <thread>
 #include <gtest/gtest.h>
 #include <HippoMocks/hippomocks.h>
 
@@ -269,3 +272,154 @@ TEST_F(DataCacheTest, requestGet_normalCasetest)
 
     cacheHandler->requestGet();
 }
+
+namespace
+{
+    // Sends observe notifications to the cache as fast as possible, with a
+    // subscriber taking reportDelay to handle each report, and returns the
+    // number of reports once the last notification was reported.
+    int observeAtHighRate(std::shared_ptr<DataCache> cacheHandler, long repeatTime,
+                          std::chrono::milliseconds reportDelay, int notifications)
+    {
+        std::atomic<int> reports(0);
+        std::atomic<int> lastValue(-1);
+        CacheID id = cacheHandler->addSubscriber(
+            [&](std::shared_ptr<PrimitiveResource>, const RCSResourceAttributes &attrs)
+            {
+                std::this_thread::sleep_for(reportDelay);
+                reports++;
+                lastValue = attrs.at("value").get<int>();
+                return OC_STACK_OK;
+            }, REPORT_FREQUENCY::UPTODATE, repeatTime);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < notifications; i++)
+        {
+            RCSResourceAttributes attrs;
+            attrs["value"] = i;
+            cacheHandler->onObserve(HeaderOptions(), ResponseStatement(attrs), OC_STACK_OK, i + 1);
+        }
+        std::chrono::duration<double, std::micro> sending =
+            std::chrono::steady_clock::now() - start;
+
+        auto deadline = start + std::chrono::seconds(10);
+        while (lastValue != notifications - 1 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        // waits for a report in flight, the subscriber does not use the locals after it
+        EXPECT_EQ(id, cacheHandler->deleteSubscriber(id));
+
+        std::cout << notifications << " notifications: "
+                  << sending.count() / notifications << " us each to receive, "
+                  << reports << " reports, the last one after " << elapsed.count() << " ms"
+                  << std::endl;
+
+        EXPECT_EQ(notifications - 1, lastValue);
+        return reports;
+    }
+}
+
+TEST_F(DataCacheTest, notifyObservers_coalescesForSlowSubscriber)
+{
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::requestGet);
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::isObservable).Return(true);
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::requestObserve);
+    mocks.OnCall(pResource.get(), PrimitiveResource::cancelObserve);
+
+    cacheHandler->initializeDataCache(pResource);
+
+    const int notifications = 10000;
+    int reports = observeAtHighRate(cacheHandler, 0, std::chrono::milliseconds(1), notifications);
+
+    EXPECT_LT(reports, notifications);
+}
+
+TEST_F(DataCacheTest, notifyObservers_limitsReportRate)
+{
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::requestGet);
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::isObservable).Return(true);
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::requestObserve);
+    mocks.OnCall(pResource.get(), PrimitiveResource::cancelObserve);
+
+    cacheHandler->initializeDataCache(pResource);
+
+    const long repeatTime = 50l;
+    auto start = std::chrono::steady_clock::now();
+    int reports = observeAtHighRate(cacheHandler, repeatTime, std::chrono::milliseconds(0),
+                                    100000);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_LE(reports, elapsed / repeatTime + 2);
+}
+
+TEST_F(DataCacheTest, deleteSubscriber_waitsForReportInFlight)
+{
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::requestGet);
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::isObservable).Return(true);
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::requestObserve);
+    mocks.OnCall(pResource.get(), PrimitiveResource::cancelObserve);
+
+    cacheHandler->initializeDataCache(pResource);
+
+    std::atomic<bool> started(false);
+    std::atomic<bool> finished(false);
+    CacheID id = cacheHandler->addSubscriber(
+        [&](std::shared_ptr<PrimitiveResource>, const RCSResourceAttributes &)
+        {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            finished = true;
+            return OC_STACK_OK;
+        }, REPORT_FREQUENCY::UPTODATE, 0);
+
+    RCSResourceAttributes attrs;
+    attrs["value"] = 1;
+    cacheHandler->onObserve(HeaderOptions(), ResponseStatement(attrs), OC_STACK_OK, 1);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!started && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(started);
+
+    EXPECT_EQ(id, cacheHandler->deleteSubscriber(id));
+    EXPECT_TRUE(finished);
+    EXPECT_EQ(0, cacheHandler->deleteSubscriber(id));
+}
+
+TEST_F(DataCacheTest, deleteSubscriber_fromItsReport)
+{
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::requestGet);
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::isObservable).Return(true);
+    mocks.ExpectCall(pResource.get(), PrimitiveResource::requestObserve);
+    mocks.OnCall(pResource.get(), PrimitiveResource::cancelObserve);
+
+    cacheHandler->initializeDataCache(pResource);
+
+    std::atomic<CacheID> id(0);
+    std::atomic<CacheID> deleted(0);
+    id = cacheHandler->addSubscriber(
+        [&](std::shared_ptr<PrimitiveResource>, const RCSResourceAttributes &)
+        {
+            deleted = cacheHandler->deleteSubscriber(id);
+            return OC_STACK_OK;
+        }, REPORT_FREQUENCY::UPTODATE, 0);
+
+    RCSResourceAttributes attrs;
+    attrs["value"] = 1;
+    cacheHandler->onObserve(HeaderOptions(), ResponseStatement(attrs), OC_STACK_OK, 1);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (deleted == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(id, deleted);
+    EXPECT_TRUE(cacheHandler->isEmptySubscriber());
+}
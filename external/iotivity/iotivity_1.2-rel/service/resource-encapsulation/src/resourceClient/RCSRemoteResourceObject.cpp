@@ -285,7 +285,8 @@ namespace OIC
             startCaching({ });
         }
 
-        void RCSRemoteResourceObject::startCaching(CacheUpdatedCallback cb, CacheMode mode)
+        void RCSRemoteResourceObject::startCaching(CacheUpdatedCallback cb, CacheMode mode,
+                std::chrono::milliseconds minReportInterval)
         {
             SCOPE_LOG_F(DEBUG, TAG);
 
@@ -294,6 +295,11 @@ namespace OIC
                 OIC_LOG(DEBUG, TAG, "startCaching : already Started");
                 throw RCSBadRequestException{ "Caching already started." };
             }
+            if (minReportInterval.count() < 0)
+            {
+                throw RCSInvalidParameterException{ "startCaching : negative report interval" };
+            }
+            const long reportInterval = static_cast< long >(minReportInterval.count());
 
             if (mode == CacheMode::OBSERVE_ONLY)
             {
@@ -301,7 +307,7 @@ namespace OIC
                         m_primitiveResource,
                         std::bind(cachingCallback, std::placeholders::_1, std::placeholders::_2,
                                   std::move(cb)), CACHE_METHOD::OBSERVE_ONLY,
-                                  REPORT_FREQUENCY::UPTODATE, 0);
+                                  REPORT_FREQUENCY::UPTODATE, reportInterval);
             }
 
             else if (cb)
@@ -310,7 +316,7 @@ namespace OIC
                         m_primitiveResource,
                         std::bind(cachingCallback, std::placeholders::_1, std::placeholders::_2,
                                 std::move(cb)), CACHE_METHOD::ITERATED_GET,
-                                REPORT_FREQUENCY::UPTODATE, 0);
+                                REPORT_FREQUENCY::UPTODATE, reportInterval);
             }
             else
             {
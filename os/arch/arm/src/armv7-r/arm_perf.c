@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * arch/arm/src/armv7-r/arm_perf.c
+ *
+ *   Cycle counter of the Performance Monitor Unit
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+
+#include <tinyara/arch.h>
+
+#ifdef CONFIG_ARCH_HAVE_PERF_COUNTER
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define PMCR_E            (1u << 0)	/* Enable all counters */
+#define PMCNTENSET_C      (1u << 31)	/* Enable the cycle counter */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_perf_init
+ *
+ * Description:
+ *   Enable the PMU cycle counter (PMCCNTR).
+ *
+ ****************************************************************************/
+
+void up_perf_init(void)
+{
+	uint32_t pmcr;
+
+	__asm__ __volatile__
+	(
+		"\tmrc p15, 0, %0, c9, c12, 0\n"
+		: "=r"(pmcr)
+		:
+		:
+	);
+
+	__asm__ __volatile__
+	(
+		"\tmcr p15, 0, %0, c9, c12, 0\n"
+		"\tmcr p15, 0, %1, c9, c12, 1\n"
+		:
+		: "r"(pmcr | PMCR_E), "r"(PMCNTENSET_C)
+		:
+	);
+}
+
+/****************************************************************************
+ * Name: up_perf_gettime
+ *
+ * Description:
+ *   Return the free-running CPU cycle count.
+ *
+ ****************************************************************************/
+
+uint32_t up_perf_gettime(void)
+{
+	uint32_t cycles;
+
+	__asm__ __volatile__
+	(
+		"\tmrc p15, 0, %0, c9, c13, 0\n"
+		: "=r"(cycles)
+		:
+		:
+	);
+
+	return cycles;
+}
+
+#endif							/* CONFIG_ARCH_HAVE_PERF_COUNTER */
@@ -204,6 +204,12 @@ void up_initialize(void)
 	up_timer_initialize();
 #endif
 
+#ifdef CONFIG_ARCH_HAVE_PERF_COUNTER
+	/* Start the free-running cycle counter */
+
+	up_perf_init();
+#endif
+
 	/* Register devices */
 
 #if CONFIG_NFILE_DESCRIPTORS > 0
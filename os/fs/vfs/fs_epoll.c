@@ -0,0 +1,739 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * fs/vfs/fs_epoll.c
+ *
+ * An epoll instance keeps its registrations on the waiter lists of the
+ * watched sockets (see lwip_poll_register()).  A socket event only runs the
+ * notification of the instances watching that socket, which puts the
+ * registration on the instance's ready list and wakes up epoll_wait().  So
+ * unlike poll() and select(), neither the cost of an event nor the cost of
+ * a wait grows with the number of watched descriptors.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <sys/types.h>
+#include <sys/epoll.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <tinyara/clock.h>
+#include <tinyara/cancelpt.h>
+#include <tinyara/semaphore.h>
+#include <tinyara/kmalloc.h>
+#include <tinyara/fs/fs.h>
+
+#include <net/lwip/sockets.h>
+
+#include <arch/irq.h>
+
+#include "inode/inode.h"
+
+#if CONFIG_NFILE_DESCRIPTORS > 0 && !defined(CONFIG_DISABLE_POLL) && defined(CONFIG_NET_LWIP)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Events always reported, whether requested or not */
+
+#define EPOLL_ALWAYS   (EPOLLERR | EPOLLHUP)
+
+/* Internal flag of a oneshot registration that has fired */
+
+#define EPOLL_DISABLED (1u << 29)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct epoll_instance_s;
+
+/* One registered socket */
+
+struct epoll_item_s {
+	FAR struct epoll_instance_s *ep;	/* The instance */
+	FAR struct epoll_item_s *rnext;	/* Next on the ready list */
+	FAR void *handle;			/* Registration, NULL once the socket is closed */
+	uint32_t events;			/* Requested events and flags */
+	epoll_data_t data;			/* User data */
+	int fd;						/* The socket descriptor */
+	pollevent_t pending;		/* Events signalled since last reported */
+	bool queued;				/* On the ready list */
+};
+
+/* One epoll instance, the private data of its inode */
+
+struct epoll_instance_s {
+	sem_t exclsem;				/* Serializes epoll_ctl() and epoll_wait() */
+	sem_t waitsem;				/* Posted when the ready list becomes non-empty */
+	bool waiting;				/* epoll_wait() is waiting on waitsem */
+	FAR struct epoll_item_s *rhead;	/* Ready list, protected by sched_lock() */
+	FAR struct epoll_item_s *rtail;
+	FAR struct epoll_item_s *items[CONFIG_NSOCKET_DESCRIPTORS];	/* Registrations by socket */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int epoll_close(FAR struct file *filep);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct file_operations g_epoll_fops = {
+	NULL,						/* open */
+	epoll_close,				/* close */
+	NULL,						/* read */
+	NULL,						/* write */
+	NULL,						/* seek */
+	NULL						/* ioctl */
+#ifndef CONFIG_DISABLE_POLL
+	, NULL						/* poll */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_semtake
+ ****************************************************************************/
+
+static void epoll_semtake(FAR sem_t *sem)
+{
+	/* Take the semaphore (perhaps waiting) */
+
+	while (sem_wait(sem) != 0) {
+		/* The only case that an error should occur here is if the wait was
+		 * awakened by a signal.
+		 */
+
+		ASSERT(get_errno() == EINTR);
+	}
+}
+
+/****************************************************************************
+ * Name: epoll_notify
+ *
+ * Description:
+ *   Called by the network stack with the scheduler locked when an event
+ *   occurs on a watched socket, or with POLLNVAL when it is closed.
+ *
+ ****************************************************************************/
+
+static void epoll_notify(FAR void *arg, pollevent_t revents)
+{
+	FAR struct epoll_item_s *item = (FAR struct epoll_item_s *)arg;
+	FAR struct epoll_instance_s *ep = item->ep;
+
+	item->pending |= revents;
+	if (!item->queued) {
+		item->queued = true;
+		item->rnext = NULL;
+		if (ep->rtail) {
+			ep->rtail->rnext = item;
+		} else {
+			ep->rhead = item;
+		}
+		ep->rtail = item;
+	}
+
+	if (ep->waiting) {
+		ep->waiting = false;
+		sem_post(&ep->waitsem);
+	}
+}
+
+/****************************************************************************
+ * Name: epoll_dequeue
+ *
+ * Description:
+ *   Take an item off the ready list of its instance.
+ *
+ ****************************************************************************/
+
+static void epoll_dequeue(FAR struct epoll_item_s *item)
+{
+	FAR struct epoll_instance_s *ep = item->ep;
+	FAR struct epoll_item_s *prev = NULL;
+	FAR struct epoll_item_s *curr;
+
+	sched_lock();
+	if (item->queued) {
+		for (curr = ep->rhead; curr != item; prev = curr, curr = curr->rnext) ;
+		if (prev) {
+			prev->rnext = item->rnext;
+		} else {
+			ep->rhead = item->rnext;
+		}
+		if (ep->rtail == item) {
+			ep->rtail = prev;
+		}
+		item->queued = false;
+	}
+	sched_unlock();
+}
+
+/****************************************************************************
+ * Name: epoll_remove
+ *
+ * Description:
+ *   Drop a registration.  The caller holds exclsem.
+ *
+ ****************************************************************************/
+
+static void epoll_remove(FAR struct epoll_item_s *item)
+{
+	FAR struct epoll_instance_s *ep = item->ep;
+
+	/* After unregistering, the network stack cannot notify the item anymore */
+
+	lwip_poll_unregister(&item->handle);
+	epoll_dequeue(item);
+	ep->items[item->fd - CONFIG_NFILE_DESCRIPTORS] = NULL;
+	kmm_free(item);
+}
+
+/****************************************************************************
+ * Name: epoll_sockevents
+ *
+ * Description:
+ *   The socket events to ask the network stack for.
+ *
+ ****************************************************************************/
+
+static pollevent_t epoll_sockevents(uint32_t events)
+{
+	if (events & EPOLL_DISABLED) {
+		return 0;
+	}
+
+	return (pollevent_t)((events & (EPOLLIN | EPOLLOUT)) | EPOLL_ALWAYS);
+}
+
+/****************************************************************************
+ * Name: epoll_getinstance
+ ****************************************************************************/
+
+static FAR struct epoll_instance_s *epoll_getinstance(int epfd)
+{
+	FAR struct file *filep;
+
+	if ((unsigned int)epfd >= CONFIG_NFILE_DESCRIPTORS) {
+		set_errno(EBADF);
+		return NULL;
+	}
+
+	filep = fs_getfilep(epfd);
+	if (!filep || !filep->f_inode) {
+		set_errno(EBADF);
+		return NULL;
+	}
+
+	if (filep->f_inode->u.i_ops != &g_epoll_fops) {
+		set_errno(EINVAL);
+		return NULL;
+	}
+
+	return (FAR struct epoll_instance_s *)filep->f_inode->i_private;
+}
+
+/****************************************************************************
+ * Name: epoll_close
+ *
+ * Description:
+ *   Called on each close of a descriptor of the instance.  The instance
+ *   goes away with its last descriptor (dup()'ed descriptors share the
+ *   inode and so the instance).
+ *
+ ****************************************************************************/
+
+static int epoll_close(FAR struct file *filep)
+{
+	FAR struct inode *inode = filep->f_inode;
+	FAR struct epoll_instance_s *ep = (FAR struct epoll_instance_s *)inode->i_private;
+	int i;
+
+	if (inode->i_crefs > 1) {
+		return OK;
+	}
+
+	for (i = 0; i < CONFIG_NSOCKET_DESCRIPTORS; i++) {
+		if (ep->items[i]) {
+			epoll_remove(ep->items[i]);
+		}
+	}
+
+	sem_destroy(&ep->exclsem);
+	sem_destroy(&ep->waitsem);
+	kmm_free(ep);
+	inode->i_private = NULL;
+
+	/* The inode is marked deleted, so inode_release() frees it */
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_collect
+ *
+ * Description:
+ *   Move up to maxevents ready registrations to 'events'.  Level-triggered
+ *   registrations that are still ready go back on the ready list, so that
+ *   the next epoll_wait() reports them again without any socket event.
+ *   The caller holds exclsem.
+ *
+ ****************************************************************************/
+
+static int epoll_collect(FAR struct epoll_instance_s *ep, FAR struct epoll_event *events, int maxevents)
+{
+	FAR struct epoll_item_s *ready;
+	FAR struct epoll_item_s *item;
+	FAR struct epoll_item_s *again = NULL;
+	FAR struct epoll_item_s *againtail = NULL;
+	pollevent_t revents;
+	int nevents = 0;
+
+	/* Take the whole ready list, new events go to a fresh list meanwhile */
+
+	sched_lock();
+	ready = ep->rhead;
+	ep->rhead = NULL;
+	ep->rtail = NULL;
+	sched_unlock();
+
+	while (ready && nevents < maxevents) {
+		item = ready;
+		ready = item->rnext;
+
+		sched_lock();
+		item->queued = false;
+		revents = item->pending;
+		item->pending = 0;
+		sched_unlock();
+
+		if (item->handle == NULL) {
+			/* The socket has been closed: forget it, as Linux does */
+
+			epoll_remove(item);
+			continue;
+		}
+
+		if ((item->events & EPOLLET) == 0) {
+			/* Level-triggered: report the current state */
+
+			revents = lwip_poll_pending(&item->handle);
+			if (revents & POLLNVAL) {
+				epoll_remove(item);
+				continue;
+			}
+		}
+
+		revents &= (pollevent_t)((item->events & (EPOLLIN | EPOLLOUT)) | EPOLL_ALWAYS);
+		if (revents == 0) {
+			continue;
+		}
+
+		events[nevents].events = revents;
+		events[nevents].data = item->data;
+		nevents++;
+
+		if (item->events & EPOLLONESHOT) {
+			/* Disabled until re-armed by EPOLL_CTL_MOD */
+
+			item->events |= EPOLL_DISABLED;
+			(void)lwip_poll_modify(&item->handle, 0);
+		} else if ((item->events & EPOLLET) == 0) {
+			item->rnext = NULL;
+			if (againtail) {
+				againtail->rnext = item;
+			} else {
+				again = item;
+			}
+			againtail = item;
+		}
+	}
+
+	/* Put back what was not reported, in its order and ahead of the events
+	 * that came in meanwhile, then the level-triggered ones behind them.
+	 * Items that were notified again meanwhile are already queued.
+	 */
+
+	sched_lock();
+	if (ready) {
+		FAR struct epoll_item_s *head = NULL;
+		FAR struct epoll_item_s *tail = NULL;
+
+		while (ready) {
+			item = ready;
+			ready = item->rnext;
+			if (!item->queued) {
+				item->queued = true;
+				item->rnext = NULL;
+				if (tail) {
+					tail->rnext = item;
+				} else {
+					head = item;
+				}
+				tail = item;
+			}
+		}
+
+		if (head) {
+			tail->rnext = ep->rhead;
+			ep->rhead = head;
+			if (!ep->rtail) {
+				ep->rtail = tail;
+			}
+		}
+	}
+	while (again) {
+		item = again;
+		again = item->rnext;
+		if (!item->queued) {
+			item->queued = true;
+			item->rnext = NULL;
+			if (ep->rtail) {
+				ep->rtail->rnext = item;
+			} else {
+				ep->rhead = item;
+			}
+			ep->rtail = item;
+		}
+	}
+	sched_unlock();
+
+	return nevents;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_create1
+ *
+ * Description:
+ *   Create an epoll instance.  Each instance gets its own anonymous inode,
+ *   so that dup() and task inheritance share the instance.
+ *
+ ****************************************************************************/
+
+int epoll_create1(int flags)
+{
+	FAR struct epoll_instance_s *ep;
+	FAR struct inode *inode;
+	int errcode;
+	int fd;
+
+	if ((flags & ~EPOLL_CLOEXEC) != 0) {
+		errcode = EINVAL;
+		goto errout;
+	}
+
+	ep = (FAR struct epoll_instance_s *)kmm_zalloc(sizeof(struct epoll_instance_s));
+	if (!ep) {
+		errcode = ENOMEM;
+		goto errout;
+	}
+
+	inode = (FAR struct inode *)kmm_zalloc(FSNODE_SIZE(0));
+	if (!inode) {
+		errcode = ENOMEM;
+		goto errout_with_ep;
+	}
+
+	sem_init(&ep->exclsem, 0, 1);
+	sem_init(&ep->waitsem, 0, 0);
+
+	/* This semaphore is used for signaling and, hence, should not have
+	 * priority inheritance enabled.
+	 */
+
+	sem_setprotocol(&ep->waitsem, SEM_PRIO_NONE);
+
+	inode->i_crefs = 1;
+	inode->i_flags = FSNODEFLAG_TYPE_DRIVER | FSNODEFLAG_DELETED;
+	inode->u.i_ops = &g_epoll_fops;
+	inode->i_private = ep;
+
+	fd = files_allocate(inode, 0, 0, 0);
+	if (fd < 0) {
+		errcode = EMFILE;
+		goto errout_with_inode;
+	}
+
+	return fd;
+
+errout_with_inode:
+	sem_destroy(&ep->exclsem);
+	sem_destroy(&ep->waitsem);
+	kmm_free(inode);
+errout_with_ep:
+	kmm_free(ep);
+errout:
+	set_errno(errcode);
+	return ERROR;
+}
+
+/****************************************************************************
+ * Name: epoll_create
+ ****************************************************************************/
+
+int epoll_create(int size)
+{
+	if (size <= 0) {
+		set_errno(EINVAL);
+		return ERROR;
+	}
+
+	return epoll_create1(0);
+}
+
+/****************************************************************************
+ * Name: epoll_ctl
+ *
+ * Description:
+ *   Add, modify or remove the registration of a socket descriptor.
+ *
+ ****************************************************************************/
+
+int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *event)
+{
+	FAR struct epoll_instance_s *ep;
+	FAR struct epoll_item_s *item;
+	int errcode = 0;
+	int ret;
+
+	ep = epoll_getinstance(epfd);
+	if (!ep) {
+		return ERROR;
+	}
+
+	if (fd < 0 || fd >= CONFIG_NFILE_DESCRIPTORS + CONFIG_NSOCKET_DESCRIPTORS) {
+		set_errno(EBADF);
+		return ERROR;
+	}
+
+	if (fd < CONFIG_NFILE_DESCRIPTORS) {
+		/* Only sockets signal their events to persistent registrations */
+
+		set_errno(fd == epfd ? EINVAL : EPERM);
+		return ERROR;
+	}
+
+	if (op != EPOLL_CTL_DEL && !event) {
+		set_errno(EFAULT);
+		return ERROR;
+	}
+
+	epoll_semtake(&ep->exclsem);
+	item = ep->items[fd - CONFIG_NFILE_DESCRIPTORS];
+	if (item && item->handle == NULL) {
+		/* Left over from a closed socket whose descriptor has been reused */
+
+		epoll_remove(item);
+		item = NULL;
+	}
+
+	switch (op) {
+	case EPOLL_CTL_ADD:
+		if (item) {
+			errcode = EEXIST;
+			break;
+		}
+
+		item = (FAR struct epoll_item_s *)kmm_zalloc(sizeof(struct epoll_item_s));
+		if (!item) {
+			errcode = ENOMEM;
+			break;
+		}
+
+		item->ep = ep;
+		item->fd = fd;
+		item->events = event->events & ~EPOLL_DISABLED;
+		item->data = event->data;
+		ep->items[fd - CONFIG_NFILE_DESCRIPTORS] = item;
+
+		ret = lwip_poll_register(fd, epoll_sockevents(item->events), epoll_notify, item, &item->handle);
+		if (ret < 0) {
+			ep->items[fd - CONFIG_NFILE_DESCRIPTORS] = NULL;
+			kmm_free(item);
+			errcode = -ret;
+		}
+		break;
+
+	case EPOLL_CTL_MOD:
+		if (!item) {
+			errcode = ENOENT;
+			break;
+		}
+
+		item->events = event->events & ~EPOLL_DISABLED;
+		item->data = event->data;
+		ret = lwip_poll_modify(&item->handle, epoll_sockevents(item->events));
+		if (ret < 0) {
+			errcode = -ret;
+		}
+		break;
+
+	case EPOLL_CTL_DEL:
+		if (!item) {
+			errcode = ENOENT;
+			break;
+		}
+
+		epoll_remove(item);
+		break;
+
+	default:
+		errcode = EINVAL;
+		break;
+	}
+
+	sem_post(&ep->exclsem);
+
+	if (errcode != 0) {
+		set_errno(errcode);
+		return ERROR;
+	}
+
+	return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_wait
+ *
+ * Description:
+ *   Wait for events on the registered sockets.  Only the ready list is
+ *   looked at, so the cost does not depend on the number of registrations.
+ *
+ ****************************************************************************/
+
+int epoll_wait(int epfd, FAR struct epoll_event *events, int maxevents, int timeout)
+{
+	FAR struct epoll_instance_s *ep;
+	struct timespec abstime;
+	irqstate_t flags;
+	int nevents = 0;
+	int ret = OK;
+
+	/* epoll_wait() is a cancellation point */
+	(void)enter_cancellation_point();
+
+	ep = epoll_getinstance(epfd);
+	if (!ep) {
+		leave_cancellation_point();
+		return ERROR;
+	}
+
+	if (!events || maxevents <= 0) {
+		leave_cancellation_point();
+		set_errno(EINVAL);
+		return ERROR;
+	}
+
+	if (timeout > 0) {
+		time_t sec = timeout / MSEC_PER_SEC;
+		uint32_t nsec = (timeout - MSEC_PER_SEC * sec) * NSEC_PER_MSEC;
+
+		(void)clock_gettime(CLOCK_REALTIME, &abstime);
+		abstime.tv_sec += sec;
+		abstime.tv_nsec += nsec;
+		if (abstime.tv_nsec >= NSEC_PER_SEC) {
+			abstime.tv_sec++;
+			abstime.tv_nsec -= NSEC_PER_SEC;
+		}
+	}
+
+	for (;;) {
+		epoll_semtake(&ep->exclsem);
+		nevents = epoll_collect(ep, events, maxevents);
+		sem_post(&ep->exclsem);
+
+		if (nevents > 0 || timeout == 0) {
+			break;
+		}
+
+		/* Nothing ready: wait for the next notification.  A notification
+		 * coming in after the check leaves waitsem posted, so it is not lost.
+		 */
+
+		sched_lock();
+		if (ep->rhead) {
+			sched_unlock();
+			continue;
+		}
+		ep->waiting = true;
+		sched_unlock();
+
+		if (timeout > 0) {
+			flags = irqsave();
+			ret = sem_timedwait(&ep->waitsem, &abstime);
+			irqrestore(flags);
+		} else {
+			ret = sem_wait(&ep->waitsem);
+		}
+
+		sched_lock();
+		ep->waiting = false;
+		sched_unlock();
+
+		if (ret < 0) {
+			int err = get_errno();
+
+			if (err == ETIMEDOUT) {
+				/* Return zero (OK) in the event of a timeout */
+
+				ret = OK;
+			} else {
+				/* EINTR is the only other error expected in normal operation */
+
+				ret = -err;
+			}
+			break;
+		}
+	}
+
+	leave_cancellation_point();
+
+	if (ret < 0) {
+		set_errno(-ret);
+		return ERROR;
+	}
+
+	return nevents;
+}
+
+#endif							/* CONFIG_NFILE_DESCRIPTORS > 0 && !CONFIG_DISABLE_POLL && CONFIG_NET_LWIP */
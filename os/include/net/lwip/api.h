@@ -146,6 +146,24 @@ struct api_msg_msg;
 /** A callback prototype to inform about events for a netconn */
 typedef void (*netconn_callback)(struct netconn *, enum netconn_evt, u16_t len);
 
+#if LWIP_NETCONN_ZEROCOPY
+struct netconn_zc_req;
+/** Called from tcpip_thread once the stack no longer references the data of
+    a zero-copy write: err is ERR_OK when the peer acknowledged all of it */
+typedef void (*netconn_zc_sent_fn)(struct netconn_zc_req *req, err_t err);
+
+/** A zero-copy write waiting for the peer's acknowledgement.
+    Owned by the caller of netconn_write_zc() and released by 'sent'. */
+struct netconn_zc_req {
+	/** next pending write of the same netconn */
+	struct netconn_zc_req *next;
+	/** sequence number following the last byte of this write */
+	u32_t end_seq;
+	/** completion function */
+	netconn_zc_sent_fn sent;
+};
+#endif							/* LWIP_NETCONN_ZEROCOPY */
+
 /** A netconn descriptor */
 struct netconn {
 	/** type of the netconn (TCP, UDP or RAW) */
@@ -208,6 +226,11 @@ struct netconn {
 	    Also used during connect and close. */
 	struct api_msg_msg *current_msg;
 #endif							/* LWIP_TCP */
+#if LWIP_NETCONN_ZEROCOPY
+	/** TCP: zero-copy writes not yet acknowledged, oldest first */
+	struct netconn_zc_req *zc_head;
+	struct netconn_zc_req *zc_tail;
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 	/** A callback function that is informed about events for this netconn */
 	netconn_callback callback;
 };
@@ -256,6 +279,9 @@ err_t netconn_send(struct netconn *conn, struct netbuf *buf);
 err_t netconn_write_partly(struct netconn *conn, const void *dataptr, size_t size, u8_t apiflags, size_t *bytes_written);
 #define netconn_write(conn, dataptr, size, apiflags) \
 	netconn_write_partly(conn, dataptr, size, apiflags, NULL)
+#if LWIP_NETCONN_ZEROCOPY
+err_t netconn_write_zc(struct netconn *conn, const void *dataptr, size_t size, u8_t apiflags, size_t *bytes_written, struct netconn_zc_req **req);
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 err_t netconn_close(struct netconn *conn);
 err_t netconn_shutdown(struct netconn *conn, u8_t shut_rx, u8_t shut_tx);
 
@@ -109,6 +109,9 @@ struct api_msg_msg {
 #if LWIP_SO_SNDTIMEO
 			systime_t time_started;
 #endif							/* LWIP_SO_SNDTIMEO */
+#if LWIP_NETCONN_ZEROCOPY
+			struct netconn_zc_req *zc;
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 		} w;
 		/** used for do_recv */
 		struct {
@@ -76,7 +76,7 @@ extern "C" {
 #define IP_HDRINCL  NULL
 
 #if LWIP_NETIF_HWADDRHINT
-#define IP_PCB_ADDRHINT ; u8_t addr_hint
+#define IP_PCB_ADDRHINT ; u16_t addr_hint
 #else
 #define IP_PCB_ADDRHINT
 #endif							/* LWIP_NETIF_HWADDRHINT */
@@ -82,6 +82,14 @@
 #endif
 #endif
 
+#ifdef CONFIG_NET_ARP_HASHSIZE
+#define ETHARP_HASH_SIZE                CONFIG_NET_ARP_HASHSIZE
+#endif
+
+#ifdef CONFIG_NET_ARP_NETIF_MAXENTRIES
+#define ETHARP_NETIF_MAX_ENTRIES        CONFIG_NET_ARP_NETIF_MAXENTRIES
+#endif
+
 #ifdef CONFIG_NET_ARP_QUEUEING
 #define ARP_QUEUEING                    CONFIG_NET_ARP_QUEUEING
 #endif
@@ -498,6 +506,10 @@
 #define SO_REUSE_RXTOALL	CONFIG_NET_SO_REUSE_RXTOALL
 #endif
 
+#ifdef CONFIG_NET_SOCKET_ZEROCOPY
+#define LWIP_NETCONN_ZEROCOPY	CONFIG_NET_SOCKET_ZEROCOPY
+#endif
+
 /* ---------- Socket options ---------- */
 
 
@@ -887,6 +899,10 @@
 #define SYS_STATS	CONFIG_NET_SYS_STATS
 #endif
 
+#ifdef CONFIG_NET_SOCKET_LOCK_STATS
+#define SOCK_LOCK_STATS	CONFIG_NET_SOCKET_LOCK_STATS
+#endif
+
 /* ---------- Stat options ---------- */
 
 
@@ -288,8 +288,14 @@ struct netif {
 	netif_igmp_mac_filter_fn igmp_mac_filter;
 #endif							/* LWIP_IGMP */
 #if LWIP_NETIF_HWADDRHINT
-	u8_t *addr_hint;
+	u16_t *addr_hint;
 #endif							/* LWIP_NETIF_HWADDRHINT */
+#if LWIP_ARP
+	/** number of ARP table entries held by this netif */
+	u16_t arp_entries;
+	/** maximum number of ARP table entries of this netif, 0 for no limit */
+	u16_t arp_max_entries;
+#endif							/* LWIP_ARP */
 #if ENABLE_LOOPBACK
 	/* List of packets to be queued for ourselves. */
 	struct pbuf *loop_first;
@@ -505,6 +511,17 @@ void netif_set_link_callback(struct netif *netif, netif_status_callback_fn link_
 #define netif_get_igmp_mac_filter(netif) (((netif) != NULL) ? ((netif)->igmp_mac_filter) : NULL)
 #endif							/* LWIP_IGMP */
 
+#if LWIP_ARP
+/** Limit the share of the ARP table an interface may take, 0 for no limit.
+ *  When the limit is reached, the interface recycles its own entries. */
+#define netif_set_arp_max_entries(netif, max) \
+	do { \
+		if ((netif) != NULL) { \
+			(netif)->arp_max_entries = (max); \
+		} \
+	} while (0)
+#endif							/* LWIP_ARP */
+
 #if ENABLE_LOOPBACK
 err_t netif_loop_output(struct netif *netif, struct pbuf *p, ip_addr_t *dest_ip);
 void netif_poll(struct netif *netif);
@@ -449,6 +449,22 @@
 #define ARP_TABLE_SIZE                  10
 #endif
 
+/**
+ * ETHARP_HASH_SIZE: Number of hash buckets indexing the ARP table by IP
+ * address. Must be a power of 2.
+ */
+#ifndef ETHARP_HASH_SIZE
+#define ETHARP_HASH_SIZE                16
+#endif
+
+/**
+ * ETHARP_NETIF_MAX_ENTRIES: Default limit of ARP table entries a single
+ * netif may hold, 0 for no limit. See netif_set_arp_max_entries().
+ */
+#ifndef ETHARP_NETIF_MAX_ENTRIES
+#define ETHARP_NETIF_MAX_ENTRIES        0
+#endif
+
 /**
  * ARP_QUEUEING==1: Multiple outgoing packets are queued during hardware address
  * resolution. By default, only the most recent packet is queued per IP address.
@@ -1455,6 +1471,14 @@
 #define LWIP_SO_RCVBUF                  0
 #endif
 
+/**
+ * LWIP_NETCONN_ZEROCOPY==1: Enable zero-copy receive and send for
+ * sockets/netconns (recv_zc, recv_zc_release and send_zc).
+ */
+#ifndef LWIP_NETCONN_ZEROCOPY
+#define LWIP_NETCONN_ZEROCOPY           0
+#endif
+
 /**
  * If LWIP_SO_RCVBUF is used, this is the default value for recv_bufsize.
  */
@@ -1579,6 +1603,13 @@
 #define SYS_STATS                       (NO_SYS == 0)
 #endif
 
+/**
+ * SOCK_LOCK_STATS==1: Enable socket lock stats (acquisitions and hold times).
+ */
+#ifndef SOCK_LOCK_STATS
+#define SOCK_LOCK_STATS                 0
+#endif
+
 #else
 
 #define LINK_STATS                      0
@@ -1591,6 +1622,7 @@
 #define MEM_STATS                       0
 #define MEMP_STATS                      0
 #define SYS_STATS                       0
+#define SOCK_LOCK_STATS                 0
 #define LWIP_STATS_DISPLAY              0
 
 #endif							/* LWIP_STATS */
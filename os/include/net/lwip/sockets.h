@@ -60,6 +60,7 @@
 #if LWIP_TIMEVAL_PRIVATE
 #include <time.h>
 #endif
+#include <poll.h>
 #include <sys/sock_internal.h>
 #include <netinet/in.h>
 
@@ -235,10 +236,26 @@ int lwip_send(int s, const void *dataptr, size_t size, int flags);
 int lwip_sendto(int s, const void *dataptr, size_t size, int flags, const struct sockaddr *to, socklen_t tolen);
 int lwip_socket(int domain, int type, int protocol);
 int lwip_write(int s, const void *dataptr, size_t size);
+#if LWIP_NETCONN_ZEROCOPY
+struct pbuf;
+/** Completion of a zero-copy send: err is 0 or an errno value */
+typedef void (*lwip_zc_sent_fn)(void *arg, int err);
+int lwip_recv_zc(int s, struct pbuf **p, int flags, struct sockaddr *from, socklen_t *fromlen);
+int lwip_recv_zc_release(int s, struct pbuf *p);
+int lwip_send_zc(int s, const void *dataptr, size_t size, int flags, lwip_zc_sent_fn sent, void *arg);
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 #if LWIP_SELECT
 int lwip_select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptset, struct timeval *timeout);
 #endif
 int lwip_poll(int fd, struct pollfd *fds, bool setup);
+#if !LWIP_SELECT
+/** Notification of a persistent poll registration, called with the scheduler locked */
+typedef void (*lwip_poll_notify_t)(void *arg, pollevent_t revents);
+int lwip_poll_register(int fd, pollevent_t events, lwip_poll_notify_t notify, void *arg, void **handle);
+int lwip_poll_modify(void **handle, pollevent_t events);
+void lwip_poll_unregister(void **handle);
+pollevent_t lwip_poll_pending(void **handle);
+#endif
 int lwip_ioctl(int s, long cmd, void *argp);
 int lwip_fcntl(int s, int cmd, int val);
 
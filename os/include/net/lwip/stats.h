@@ -127,6 +127,12 @@ struct stats_sys {
 	struct stats_syselem mbox;
 };
 
+struct stats_lock {
+	u32_t acquired;			/* Number of times the lock was taken. */
+	u32_t hold_max;			/* Longest hold time. */
+	unsigned long long hold_total;	/* Sum of the hold times. */
+};
+
 struct stats_ {
 #if LINK_STATS
 	struct stats_proto link;
@@ -161,6 +167,9 @@ struct stats_ {
 #if SYS_STATS
 	struct stats_sys sys;
 #endif
+#if SOCK_LOCK_STATS
+	struct stats_lock sock_lock;
+#endif
 };
 
 extern struct stats_ lwip_stats;
@@ -287,6 +296,21 @@ void stats_init(void);
 #define SYS_STATS_DISPLAY()
 #endif
 
+#if SOCK_LOCK_STATS
+#define SOCK_LOCK_STATS_HOLD(t) \
+	do { \
+		lwip_stats.sock_lock.acquired++; \
+		lwip_stats.sock_lock.hold_total += (t); \
+		if (lwip_stats.sock_lock.hold_max < (t)) { \
+			lwip_stats.sock_lock.hold_max = (t); \
+		} \
+	} while (0)
+#define SOCK_LOCK_STATS_DISPLAY() stats_display_lock(&lwip_stats.sock_lock, "SOCK_LOCK")
+#else
+#define SOCK_LOCK_STATS_HOLD(t)
+#define SOCK_LOCK_STATS_DISPLAY()
+#endif
+
 /* Display of statistics */
 #if LWIP_STATS_DISPLAY
 int stats_display(void);
@@ -295,6 +319,7 @@ void stats_display_igmp(struct stats_igmp *igmp);
 void stats_display_mem(struct stats_mem *mem, const char *name);
 void stats_display_memp(struct stats_mem *mem, int index);
 void stats_display_sys(struct stats_sys *sys);
+void stats_display_lock(struct stats_lock *lock, const char *name);
 #else							/* LWIP_STATS_DISPLAY */
 #define stats_display()
 #define stats_display_proto(proto, name)
@@ -302,6 +327,7 @@ void stats_display_sys(struct stats_sys *sys);
 #define stats_display_mem(mem, name)
 #define stats_display_memp(mem, index)
 #define stats_display_sys(sys)
+#define stats_display_lock(lock, name)
 #endif							/* LWIP_STATS_DISPLAY */
 
 #ifdef __cplusplus
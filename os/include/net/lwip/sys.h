@@ -315,6 +315,11 @@ void sys_arch_unprotect(sys_prot_t pval);
 
 #endif							/* SYS_ARCH_PROTECT */
 
+#if SOCK_LOCK_STATS
+/** Free-running CPU cycle counter used to time lock hold times. */
+u32_t sys_arch_cycles(void);
+#endif
+
 /*
  * Macros to set/get and increase/decrease variables in a thread-safe way.
  * Use these for accessing variable that are used from more than one thread.
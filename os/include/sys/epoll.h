@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/**
+ * @defgroup EPOLL_KERNEL EPOLL
+ * @brief Provides APIs for epoll
+ * @ingroup KERNEL
+ *
+ * @{
+ */
+
+/// @file epoll.h
+/// @brief scalable I/O event notification APIs
+
+#ifndef __INCLUDE_SYS_EPOLL_H
+#define __INCLUDE_SYS_EPOLL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <tinyara/config.h>
+
+#include <stdint.h>
+#include <poll.h>
+
+#if CONFIG_NFILE_DESCRIPTORS > 0 && !defined(CONFIG_DISABLE_POLL) && defined(CONFIG_NET_LWIP)
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* epoll_ctl() operations */
+
+#define EPOLL_CTL_ADD   1		/* Register a descriptor */
+#define EPOLL_CTL_DEL   2		/* Remove a registered descriptor */
+#define EPOLL_CTL_MOD   3		/* Change the events of a registered descriptor */
+
+/* Event bits, the same values as the poll() events */
+
+#define EPOLLIN         POLLIN
+#define EPOLLOUT        POLLOUT
+#define EPOLLERR        POLLERR
+#define EPOLLHUP        POLLHUP
+
+/* Input flags of epoll_ctl() */
+
+#define EPOLLONESHOT    (1u << 30)	/* Disable the descriptor after one event */
+#define EPOLLET         (1u << 31)	/* Edge-triggered: report state changes only */
+
+/* epoll_create1() flags */
+
+#define EPOLL_CLOEXEC   0x80000		/* Accepted for portability, there is no exec() */
+
+/****************************************************************************
+ * Type Definitions
+ ****************************************************************************/
+
+typedef union epoll_data {
+	void *ptr;
+	int fd;
+	uint32_t u32;
+} epoll_data_t;
+
+struct epoll_event {
+	uint32_t events;			/* Epoll events */
+	epoll_data_t data;			/* User data */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief  Create an epoll instance and return a descriptor referring to it
+ * @details @b #include <sys/epoll.h>
+ * Unlike select() and poll(), the set of watched descriptors is kept in the
+ * instance, and a socket event only touches the instances watching that
+ * socket. Only socket descriptors can be watched.
+ * @param[in] size ignored, but must be greater than zero
+ * @return On success, a descriptor of the instance. On failure, -1 and errno is set.
+ * @since Tizen RT v1.1
+ */
+EXTERN int epoll_create(int size);
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief  Create an epoll instance, see epoll_create()
+ * @details @b #include <sys/epoll.h>
+ * @param[in] flags 0 or EPOLL_CLOEXEC
+ * @return On success, a descriptor of the instance. On failure, -1 and errno is set.
+ * @since Tizen RT v1.1
+ */
+EXTERN int epoll_create1(int flags);
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief  Add, modify or remove the registration of a socket descriptor
+ * @details @b #include <sys/epoll.h>
+ * The registration is removed automatically when the socket is closed.
+ * EPOLLERR and EPOLLHUP are always reported.
+ * @param[in] epfd descriptor of the epoll instance
+ * @param[in] op EPOLL_CTL_ADD, EPOLL_CTL_MOD or EPOLL_CTL_DEL
+ * @param[in] fd the socket descriptor
+ * @param[in] event the events and user data, may be NULL for EPOLL_CTL_DEL
+ * @return On success, 0. On failure, -1 and errno is set (EPERM if fd is not a socket).
+ * @since Tizen RT v1.1
+ */
+EXTERN int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *event);
+
+/**
+ * @ingroup EPOLL_KERNEL
+ * @brief  Wait for events on an epoll instance
+ * @details @b #include <sys/epoll.h>
+ * @param[in] epfd descriptor of the epoll instance
+ * @param[out] events the ready descriptors
+ * @param[in] maxevents size of events, must be greater than zero
+ * @param[in] timeout in milliseconds, -1 waits forever
+ * @return The number of ready descriptors, 0 on timeout. On failure, -1 and errno is set.
+ * @since Tizen RT v1.1
+ */
+EXTERN int epoll_wait(int epfd, FAR struct epoll_event *events, int maxevents, int timeout);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif							/* CONFIG_NFILE_DESCRIPTORS > 0 && !CONFIG_DISABLE_POLL && CONFIG_NET_LWIP */
+
+#endif							/* __INCLUDE_SYS_EPOLL_H */
+/**
+ * @} */
@@ -193,6 +193,50 @@ ssize_t recv(int sockfd, FAR void *buf, size_t len, int flags);
 */
 ssize_t recvfrom(int sockfd, FAR void *buf, size_t len, int flags, FAR struct sockaddr *from, FAR socklen_t *fromlen);
 
+#ifdef CONFIG_NET_SOCKET_ZEROCOPY
+/**
+* @brief   receive a message from a socket without copying it
+*
+* @param[in] sockfd the file descriptor associated with the socket.
+* @param[out] p  receives the pbuf chain holding the message, to be released with recv_zc_release()
+* @param[in] flags the type of message reception (MSG_PEEK is not supported)
+* @param[inout] from  A null pointer, or pointer to  sockaddr structure in which the sending address is to be stored
+* @param[inout] fromlen  null or the length of the sockaddr structure
+* @return On success, returns the length of the message in bytes, 0 if the peer closed the connection, On failure, -1 is returned.
+* @since Tizen RT v1.1
+*/
+int recv_zc(int sockfd, FAR struct pbuf **p, int flags, FAR struct sockaddr *from, FAR socklen_t *fromlen);
+
+/**
+* @brief   release a pbuf chain returned by recv_zc()
+*
+* @param[in] sockfd the file descriptor the chain was received on.
+* @param[in] p  the pbuf chain, unmodified
+* @return On success, 0 is returned. On failure, -1 is returned.
+* @since Tizen RT v1.1
+*/
+int recv_zc_release(int sockfd, FAR struct pbuf *p);
+
+/**
+* @brief   send a message on a socket without copying it
+*
+* The buffer must stay untouched until sent is called with 0 or an errno value.
+* For TCP this happens in the network thread once the peer has acknowledged
+* the data. For datagram sockets, sent is called in the calling thread before
+* send_zc() returns.
+*
+* @param[in] sockfd the file descriptor associated with the socket.
+* @param[in] buf  Pointer to the buffer containing the message to send.
+* @param[in] len the length of the message in bytes.
+* @param[in] flags the type of message transmission
+* @param[in] sent completion function, see above for the thread it is called in
+* @param[in] arg argument passed to sent
+* @return On success, returns the number of bytes queued, On failure, -1 is returned.
+* @since Tizen RT v1.1
+*/
+int send_zc(int sockfd, FAR const void *buf, size_t len, int flags, lwip_zc_sent_fn sent, FAR void *arg);
+#endif
+
 /**
 * @brief   shut down socket send and receive operations
 *
@@ -1468,6 +1468,26 @@ void up_timer_initialize(void);
 int up_timer_gettime(FAR struct timespec *ts);
 #endif
 
+/****************************************************************************
+ * Name: up_perf_init and up_perf_gettime
+ *
+ * Description:
+ *   Free-running hardware counter for measuring short code sections, with
+ *   the resolution of the CPU clock (the PMU cycle counter on Cortex-R).
+ *   up_perf_init() enables the counter and is called from up_initialize().
+ *   up_perf_gettime() returns the current count; it wraps around and only
+ *   differences of two readings are meaningful.
+ *
+ *   Provided by platform-specific code if CONFIG_ARCH_HAVE_PERF_COUNTER is
+ *   selected.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_PERF_COUNTER
+void up_perf_init(void);
+uint32_t up_perf_gettime(void);
+#endif
+
 /****************************************************************************
  * Name: up_alarm_cancel
  *
@@ -107,9 +107,14 @@ typedef uint16_t socktimeo_t;
  * descriptor.
  */
 
+struct lwip_select_cb;			/* Forward reference. Defined in net/lwip/src/api/sockets.c */
+
 struct socket {
 	/** sockets currently are built on netconns, each socket has one netconn */
 	struct netconn *conn;
+	/** bumped each time the socket is allocated or freed, so that lockless
+	    lookups can tell a reused socket from the one they found */
+	uint16_t gen;
 	/** data that was left from the previous read */
 	void *lastdata;
 	/** offset in the data that was left from the previous read */
@@ -126,6 +131,10 @@ struct socket {
 	int err;
 	/** counter of how many threads are waiting for this socket using select */
 	int select_waiting;
+	/** poll() waiters and persistent (epoll) registrations of this socket */
+	struct lwip_select_cb *select_cb;
+	/** protects the events and the waiters of this socket */
+	sem_t lock;
 };
 
 /* This defines a list of sockets indexed by the socket descriptor */
@@ -607,6 +607,29 @@ err_t netconn_send(struct netconn *conn, struct netbuf *buf)
  */
 err_t netconn_write_partly(struct netconn *conn, const void *dataptr, size_t size, u8_t apiflags, size_t *bytes_written)
 {
+#if LWIP_NETCONN_ZEROCOPY
+	return netconn_write_zc(conn, dataptr, size, apiflags, bytes_written, NULL);
+}
+
+/**
+ * Send data over a TCP netconn without copying it.
+ * The data is referenced by the stack until the peer has acknowledged it,
+ * so the application must not touch it before req->sent has been called.
+ *
+ * @param conn the TCP netconn over which to send data
+ * @param dataptr pointer to the application buffer that contains the data to send
+ * @param size size of the application data to send
+ * @param apiflags see netconn_write_partly (NETCONN_COPY should not be set)
+ * @param bytes_written pointer to a location that receives the number of written bytes
+ * @param req if not NULL, points to the completion request for this write.
+ *            If any data has been queued, the stack takes ownership of the
+ *            request and *req is set to NULL; req->sent is then called exactly
+ *            once from tcpip_thread. Otherwise *req is left untouched.
+ * @return ERR_OK if data was sent, any other err_t on error
+ */
+err_t netconn_write_zc(struct netconn *conn, const void *dataptr, size_t size, u8_t apiflags, size_t *bytes_written, struct netconn_zc_req **req)
+{
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 	struct api_msg msg;
 	err_t err;
 	u8_t dontblock;
@@ -629,6 +652,9 @@ err_t netconn_write_partly(struct netconn *conn, const void *dataptr, size_t siz
 	msg.msg.msg.w.dataptr = dataptr;
 	msg.msg.msg.w.apiflags = apiflags;
 	msg.msg.msg.w.len = size;
+#if LWIP_NETCONN_ZEROCOPY
+	msg.msg.msg.w.zc = (req != NULL) ? *req : NULL;
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 #if LWIP_SO_SNDTIMEO
 	if (conn->send_timeout != 0) {
 		/* get the time we started, which is later compared to
@@ -643,6 +669,12 @@ err_t netconn_write_partly(struct netconn *conn, const void *dataptr, size_t siz
 	   but if it is, this is done inside api_msg.c:do_write(), so we can use the
 	   non-blocking version here. */
 	err = TCPIP_APIMSG(&msg);
+#if LWIP_NETCONN_ZEROCOPY
+	if (req != NULL) {
+		/* do_writemore clears the request once it has been queued */
+		*req = msg.msg.msg.w.zc;
+	}
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 	if ((err == ERR_OK) && (bytes_written != NULL)) {
 		if (dontblock
 #if LWIP_SO_SNDTIMEO
@@ -62,6 +62,7 @@
 #include <net/lwip/ipv4/ip.h>
 #include <net/lwip/udp.h>
 #include <net/lwip/tcp.h>
+#include <net/lwip/tcp_impl.h>
 #include <net/lwip/raw.h>
 
 #include <net/lwip/memp.h>
@@ -81,6 +82,9 @@
 static err_t do_writemore(struct netconn *conn);
 static void do_close_internal(struct netconn *conn);
 #endif
+#if LWIP_NETCONN_ZEROCOPY
+static void zc_complete(struct netconn *conn, err_t err);
+#endif
 
 #if LWIP_RAW
 /**
@@ -327,6 +331,12 @@ static err_t sent_tcp(void *arg, struct tcp_pcb *pcb, u16_t len)
 	LWIP_UNUSED_ARG(pcb);
 	LWIP_ASSERT("conn != NULL", (conn != NULL));
 
+#if LWIP_NETCONN_ZEROCOPY
+	/* release zero-copy writes covered by this ACK first, so that
+	   their buffers can be reused before more data is queued */
+	zc_complete(conn, ERR_OK);
+#endif							/* LWIP_NETCONN_ZEROCOPY */
+
 	if (conn->state == NETCONN_WRITE) {
 		do_writemore(conn);
 	} else if (conn->state == NETCONN_CLOSE) {
@@ -372,6 +382,11 @@ static void err_tcp(void *arg, err_t err)
 	old_state = conn->state;
 	conn->state = NETCONN_NONE;
 
+#if LWIP_NETCONN_ZEROCOPY
+	/* the pcb and its segments are gone: zero-copy data is no longer referenced */
+	zc_complete(conn, err);
+#endif							/* LWIP_NETCONN_ZEROCOPY */
+
 	/* Notify the user layer about a connection error. Used to signal
 	   select. */
 	API_EVENT(conn, NETCONN_EVT_ERROR, 0);
@@ -635,6 +650,10 @@ struct netconn *netconn_alloc(enum netconn_type t, netconn_callback callback)
 	conn->current_msg = NULL;
 	conn->write_offset = 0;
 #endif							/* LWIP_TCP */
+#if LWIP_NETCONN_ZEROCOPY
+	conn->zc_head = NULL;
+	conn->zc_tail = NULL;
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 #if LWIP_SO_SNDTIMEO
 	conn->send_timeout = 0;
 #endif							/* LWIP_SO_SNDTIMEO */
@@ -669,6 +688,9 @@ void netconn_free(struct netconn *conn)
 #if LWIP_TCP
 	LWIP_ASSERT("acceptmbox must be deallocated before calling this function", !sys_mbox_valid(&conn->acceptmbox));
 #endif							/* LWIP_TCP */
+#if LWIP_NETCONN_ZEROCOPY
+	LWIP_ASSERT("zero-copy writes must be completed before calling this function", conn->zc_head == NULL);
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 
 	sys_sem_free(&conn->op_completed);
 	sys_sem_set_invalid(&conn->op_completed);
@@ -865,6 +887,15 @@ void do_delconn(struct api_msg_msg *msg)
 #if LWIP_TCP
 			case NETCONN_TCP:
 				LWIP_ASSERT("already writing or closing", msg->conn->current_msg == NULL && msg->conn->write_offset == 0);
+#if LWIP_NETCONN_ZEROCOPY
+				if (msg->conn->zc_head != NULL) {
+					/* A graceful close would keep retransmitting application
+					   memory after the socket is gone: abort instead, err_tcp
+					   completes the pending writes and clears pcb.tcp. */
+					tcp_abort(msg->conn->pcb.tcp);
+					break;
+				}
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 				msg->conn->state = NETCONN_CLOSE;
 				msg->msg.sd.shut = NETCONN_SHUT_RDWR;
 				msg->conn->current_msg = msg;
@@ -1190,6 +1221,57 @@ void do_recv(struct api_msg_msg *msg)
 	TCPIP_APIMSG_ACK(msg);
 }
 
+#if LWIP_NETCONN_ZEROCOPY
+/**
+ * Queue the zero-copy request of the write that is just finishing, if any
+ * of its data made it into the pcb. Ownership passes to the netconn.
+ *
+ * @param conn netconn whose current_msg is a finished write
+ */
+static void zc_queue(struct netconn *conn)
+{
+	struct netconn_zc_req *req = conn->current_msg->msg.w.zc;
+
+	if ((req == NULL) || (conn->pcb.tcp == NULL) || (conn->pcb.tcp->snd_lbb == req->end_seq)) {
+		/* nothing referenced: the caller keeps the request */
+		return;
+	}
+	req->end_seq = conn->pcb.tcp->snd_lbb;
+	req->next = NULL;
+	if (conn->zc_tail != NULL) {
+		conn->zc_tail->next = req;
+	} else {
+		conn->zc_head = req;
+	}
+	conn->zc_tail = req;
+	conn->current_msg->msg.w.zc = NULL;
+}
+
+/**
+ * Complete zero-copy writes. With err == ERR_OK only the writes the peer has
+ * fully acknowledged are completed, otherwise all of them are (the pcb has
+ * released its segments).
+ *
+ * @param conn the TCP netconn
+ * @param err ERR_OK on acknowledgement, the connection error otherwise
+ */
+static void zc_complete(struct netconn *conn, err_t err)
+{
+	struct netconn_zc_req *req;
+
+	while ((req = conn->zc_head) != NULL) {
+		if ((err == ERR_OK) && ((conn->pcb.tcp == NULL) || !TCP_SEQ_GEQ(conn->pcb.tcp->lastack, req->end_seq))) {
+			break;
+		}
+		conn->zc_head = req->next;
+		if (conn->zc_head == NULL) {
+			conn->zc_tail = NULL;
+		}
+		req->sent(req, err);
+	}
+}
+#endif							/* LWIP_NETCONN_ZEROCOPY */
+
 /**
  * See if more data needs to be written from a previous call to netconn_write.
  * Called initially from do_write. If the first call can't send all data
@@ -1305,6 +1387,9 @@ err_mem:
 		}
 	}
 	if (write_finished) {
+#if LWIP_NETCONN_ZEROCOPY
+		zc_queue(conn);
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 		/* everything was written: set back connection state
 		   and back to application task */
 		conn->current_msg->err = err;
@@ -1349,6 +1434,12 @@ void do_write(struct api_msg_msg *msg)
 				LWIP_ASSERT("msg->msg.w.len != 0", msg->msg.w.len != 0);
 				msg->conn->current_msg = msg;
 				msg->conn->write_offset = 0;
+#if LWIP_NETCONN_ZEROCOPY
+				if (msg->msg.w.zc != NULL) {
+					/* start of this write, moved to its end once queued */
+					msg->msg.w.zc->end_seq = msg->conn->pcb.tcp->snd_lbb;
+				}
+#endif							/* LWIP_NETCONN_ZEROCOPY */
 #if LWIP_TCPIP_CORE_LOCKING
 				msg->conn->flags &= ~NETCONN_FLAG_WRITE_DELAYED;
 				if (do_writemore(msg->conn) != ERR_OK) {
@@ -84,6 +84,7 @@
 #include <net/lwip/tcpip.h>
 #include <net/lwip/pbuf.h>
 #include <net/lwip/mem.h>
+#include <net/lwip/stats.h>
 #if LWIP_CHECKSUM_ON_COPY
 #include <net/lwip/ipv4/inet_chksum.h>
 #endif
@@ -91,6 +92,7 @@
 #include <string.h>
 #include <poll.h>
 #include <time.h>
+#include <errno.h>
 
 #define NUM_SOCKETS MEMP_NUM_NETCONN
 
@@ -116,6 +118,16 @@ struct lwip_select_cb {
 	pollevent_t events;
 	/** socket descriptor value */
 	int sfd;
+	/** socket whose waiter list this is on */
+	struct socket *sock;
+	/** pollfd of the waiting poll() call, NULL for a registration */
+	struct pollfd *fds;
+	/** notification function of a persistent registration (epoll) */
+	lwip_poll_notify_t notify;
+	/** argument passed to notify */
+	void *arg;
+	/** owner's reference to this registration, cleared on socket close */
+	void **handle;
 #endif
 	/** don't signal the same semaphore twice: set to 1 when signalled */
 	int sem_signalled;
@@ -143,11 +155,15 @@ struct lwip_setgetsockopt_data {
 	err_t err;
 };
 
+#if LWIP_SELECT
 /** The global list of tasks waiting for select */
 static struct lwip_select_cb *select_cb_list;
 /** This counter is increased from lwip_select when the list is chagned
     and checked in event_callback to see if it has changed. */
 static volatile int select_cb_ctr;
+#else
+static void lwip_poll_release(struct socket *sock);
+#endif
 
 /** Table to quickly map an lwIP error (err_t) to a socket error
   * by using -err as an index */
@@ -193,6 +209,22 @@ static const int err_to_errno_table[] = {
 	set_errno(sk->err); \
 } while (0)
 
+/* Socket lock: protects the events (rcvevent, sendevent, errevent) and the
+ * waiters of one socket. Each socket has its own lock, so delivering events
+ * to one socket never holds off the users of another one. The lock may
+ * block and is never taken under SYS_ARCH protection; select()'s global
+ * select_cb_list keeps SYS_ARCH protection. With SOCK_LOCK_STATS, 'lev'
+ * holds the cycle count at which the lock was taken. */
+#if SOCK_LOCK_STATS
+#define SOCK_LOCK_DECL(lev) u32_t lev
+#define SOCK_LOCK(sock, lev) (lev = sock_lock(sock))
+#define SOCK_UNLOCK(sock, lev) sock_unlock(sock, lev)
+#else
+#define SOCK_LOCK_DECL(lev)
+#define SOCK_LOCK(sock, lev) ((void)sock_lock(sock))
+#define SOCK_UNLOCK(sock, lev) sock_unlock(sock, 0)
+#endif
+
 /* Forward delcaration of some functions */
 static void event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len);
 static void lwip_getsockopt_internal(void *arg);
@@ -202,32 +234,62 @@ static void lwip_setsockopt_internal(void *arg);
  * Private Functions
  */
 
-static void _net_semtake(FAR struct socketlist *list)
+/**
+ * Initialize this module. This function has to be called before any other
+ * functions in this module!
+ */
+void lwip_socket_init(void)
 {
-	/* Take the semaphore (perhaps waiting) */
-
-	while (net_lockedwait(&list->sl_sem) != 0) {
-		/* The only case that an error should occr here is if
-		 * the wait was awakened by a signal.
-		 */
+}
 
-		ASSERT(*get_errno_ptr() == EINTR);
+/**
+ * Take the lock of a socket (see SOCK_LOCK).
+ *
+ * @return the cycle count at which the lock was taken (SOCK_LOCK_STATS)
+ */
+static u32_t sock_lock(struct socket *sock)
+{
+	while (sem_wait(&sock->lock) != 0) {
+		/* The only case that an error should occur here is if the wait was
+		 * awakened by a signal. */
+		LWIP_ASSERT("sock_lock: unexpected error", get_errno() == EINTR);
 	}
+#if SOCK_LOCK_STATS
+	return sys_arch_cycles();
+#else
+	return 0;
+#endif
 }
 
-#define _net_semgive(list) sem_post(&list->sl_sem)
-
 /**
- * Initialize this module. This function has to be called before any other
- * functions in this module!
+ * Give back the lock of a socket and account the hold time.
+ *
+ * @param start value returned by sock_lock()
  */
-void lwip_socket_init(void)
+static void sock_unlock(struct socket *sock, u32_t start)
 {
+#if SOCK_LOCK_STATS
+	u32_t held = sys_arch_cycles() - start;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	/* The stats are shared by all sockets */
+	SYS_ARCH_PROTECT(lev);
+	SOCK_LOCK_STATS_HOLD(held);
+	SYS_ARCH_UNPROTECT(lev);
+#else
+	LWIP_UNUSED_ARG(start);
+#endif
+	sem_post(&sock->lock);
 }
 
 /**
  * Map a externally used socket index to the internal socket representation.
  *
+ * The lookup takes no lock: the socket array of a task group never moves,
+ * and a socket is in use exactly while its conn is set. alloc_socket()
+ * publishes conn after the rest of the socket is set up and free_socket()
+ * clears it last, so a reader sees either a free or a complete socket.
+ *
  * @param s externally used socket index
  * @return struct socket for the socket or NULL if not found / not active
  */
@@ -248,13 +310,29 @@ struct socket *get_socket(int s)
 	return NULL;
 }
 
-struct socket *get_socket_from_list(int s, struct netconn *conn)
+/**
+ * Map the socket index of a netconn to its socket, without locking.
+ *
+ * A netconn may be freed and its memory reused for the next netconn of the
+ * same socket, so matching conn alone cannot tell whether the socket was
+ * closed and allocated again meanwhile. *gen receives the generation the
+ * socket had while conn matched; compare it with sock->gen once the socket
+ * is locked.
+ *
+ * @return the socket, NULL if conn is not the netconn of socket s
+ */
+struct socket *get_socket_from_list(int s, struct netconn *conn, u16_t *gen)
 {
 	s -= LWIP_SOCKET_OFFSET;
 	if (conn && s >= 0 && s < NUM_SOCKETS) {
 		struct socketlist *list = conn->slist;
-		if (list && list->sl_sockets[s].conn) {
-			return &list->sl_sockets[s];
+		if (list) {
+			struct socket *sock = &list->sl_sockets[s];
+
+			*gen = sock->gen;
+			if (sock->conn == conn && sock->gen == *gen) {
+				return sock;
+			}
 		}
 	}
 	LWIP_DEBUGF(SOCKETS_DEBUG, ("get_socket_from_list(%d): invalid\n", s + LWIP_SOCKET_OFFSET));
@@ -316,43 +394,51 @@ static struct socket *tryget_socket(int s)
 int alloc_socket(struct netconn *newconn, int accepted)
 {
 	FAR struct socketlist *list;
+	struct socket *sock;
 	int i;
+	SYS_ARCH_DECL_PROTECT(lev);
 	/* Get the socket list for this task/thread */
 
 	list = sched_getsockets();
 	if (list) {
 		/* lwip task can access task socket descriptor */
 		newconn->slist = list;
-		/* Search for a socket structure with no references */
+		/* Search for a socket structure with no references. The scan is
+		 * short and cannot block, so claim the socket under SYS_ARCH
+		 * protection rather than the socket list semaphore: tasks of the
+		 * group opening sockets at the same time do not queue up. */
 
-		_net_semtake(list);
+		SYS_ARCH_PROTECT(lev);
 		for (i = 0; i < CONFIG_NSOCKET_DESCRIPTORS; i++) {
+			sock = &list->sl_sockets[i];
 			/* Are there references on this socket? */
 
-			if (!list->sl_sockets[i].conn) {
-				/* No take the reference and return the index + an offset
-				 * as the socket descriptor.
+			if (!sock->conn) {
+				/* No, set it up and take the reference last, so that
+				 * lockless lookups never see a half initialized socket.
+				 * Return the index + an offset as the socket descriptor.
 				 */
-				list->sl_sockets[i].conn = newconn;
-				/* The socket is not yet known to anyone, so no need to protect
-				   after having marked it as used. */
-
-				list->sl_sockets[i].lastdata = NULL;
-				list->sl_sockets[i].lastoffset = 0;
-				list->sl_sockets[i].rcvevent = 0;
+				sock->lastdata = NULL;
+				sock->lastoffset = 0;
+				sock->rcvevent = 0;
 				/* TCP sendbuf is empty, but the socket is not yet writable until connected
 				 * (unless it has been created by accept()). */
-				list->sl_sockets[i].sendevent = (newconn->type == NETCONN_TCP ? (accepted != 0) : 1);
-				list->sl_sockets[i].errevent = 0;
-				list->sl_sockets[i].err = 0;
-				list->sl_sockets[i].select_waiting = 0;
-				_net_semgive(list);
+				sock->sendevent = (newconn->type == NETCONN_TCP ? (accepted != 0) : 1);
+				sock->errevent = 0;
+				sock->err = 0;
+				sock->select_waiting = 0;
+#if !LWIP_SELECT
+				sock->select_cb = NULL;
+#endif
+				sock->gen++;
+				sock->conn = newconn;
+				SYS_ARCH_UNPROTECT(lev);
 
 				return i + LWIP_SOCKET_OFFSET;
 			}
 		}
 
-		_net_semgive(list);
+		SYS_ARCH_UNPROTECT(lev);
 	}
 	return ERROR;
 }
@@ -366,17 +452,24 @@ int alloc_socket(struct netconn *newconn, int accepted)
 static void free_socket(struct socket *sock, int is_tcp)
 {
 	void *lastdata;
-	SYS_ARCH_DECL_PROTECT(lev);
+	SOCK_LOCK_DECL(lev);
 
 	lastdata = sock->lastdata;
 	sock->lastdata = NULL;
 	sock->lastoffset = 0;
 	sock->err = 0;
 
+#if !LWIP_SELECT
+	/* Wake up or drop whoever still waits for this socket */
+	lwip_poll_release(sock);
+#endif
+
 	/* Protect socket array */
-	SYS_ARCH_PROTECT(lev);
+	SOCK_LOCK(sock, lev);
+	/* before conn: alloc_socket() may take the socket as soon as conn is clear */
+	sock->gen++;
 	sock->conn = NULL;
-	SYS_ARCH_UNPROTECT(lev);
+	SOCK_UNLOCK(sock, lev);
 	/* don't use 'sock' after this line, as another task might have allocated it */
 
 	if (lastdata != NULL) {
@@ -403,7 +496,7 @@ int lwip_accept(int s, struct sockaddr *addr, socklen_t *addrlen)
 	int newsock;
 	struct sockaddr_in sin;
 	err_t err;
-	SYS_ARCH_DECL_PROTECT(lev);
+	SOCK_LOCK_DECL(lev);
 
 	LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_accept(%d)...\n", s));
 	sock = get_socket(s);
@@ -475,10 +568,10 @@ int lwip_accept(int s, struct sockaddr *addr, socklen_t *addrlen)
 	 * In that case, newconn->socket is counted down (newconn->socket--),
 	 * so nsock->rcvevent is >= 1 here!
 	 */
-	SYS_ARCH_PROTECT(lev);
+	SOCK_LOCK(nsock, lev);
 	nsock->rcvevent += (s16_t)(-1 - newconn->socket);
 	newconn->socket = newsock;
-	SYS_ARCH_UNPROTECT(lev);
+	SOCK_UNLOCK(nsock, lev);
 
 	LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_accept(%d) returning new sock=%d addr=", s, newsock));
 	ip_addr_debug_print(SOCKETS_DEBUG, &naddr);
@@ -828,6 +921,241 @@ int lwip_recv(int s, void *mem, size_t len, int flags)
 	return lwip_recvfrom(s, mem, len, flags, NULL, NULL);
 }
 
+#if LWIP_NETCONN_ZEROCOPY
+/** A zero-copy send waiting for completion, see lwip_send_zc() */
+struct lwip_zc_send {
+	/** netconn level request, must be the first member */
+	struct netconn_zc_req req;
+	/** application completion function and its argument */
+	lwip_zc_sent_fn sent;
+	void *arg;
+};
+
+/** Complete a zero-copy send: called from tcpip_thread */
+static void lwip_zc_sent(struct netconn_zc_req *req, err_t err)
+{
+	struct lwip_zc_send *zc = (struct lwip_zc_send *)req;
+
+	zc->sent(zc->arg, err_to_errno(err));
+	mem_free(zc);
+}
+
+/**
+ * Skip 'offset' bytes of a received TCP pbuf chain without copying.
+ * Fully consumed pbufs are freed; the returned chain starts at the first
+ * unread byte.
+ */
+static struct pbuf *lwip_pbuf_skip(struct pbuf *p, u16_t offset)
+{
+	struct pbuf *q = p;
+
+	while ((q != NULL) && (offset >= q->len)) {
+		offset -= q->len;
+		q = q->next;
+	}
+	LWIP_ASSERT("offset within chain", q != NULL);
+	if (q != p) {
+		/* keep q and its successors when releasing the consumed head */
+		pbuf_ref(q);
+		pbuf_free(p);
+	}
+	pbuf_header(q, -(s16_t)offset);
+	return q;
+}
+
+/**
+ * Receive data without copying it into an application buffer.
+ * The pbuf chain returned in *p is owned by the caller and has to be
+ * given back with lwip_recv_zc_release(). For TCP, the receive window is
+ * only reopened when the chain is released, so holding on to received
+ * data throttles the sender.
+ *
+ * @return the number of bytes in *p, 0 if the connection was closed,
+ *         -1 on error
+ */
+int lwip_recv_zc(int s, struct pbuf **p, int flags, struct sockaddr *from, socklen_t *fromlen)
+{
+	struct socket *sock;
+	void *buf = NULL;
+	struct pbuf *q;
+	ip_addr_t fromaddr;
+	ip_addr_t *addr;
+	u16_t port = 0;
+	err_t err;
+
+	LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_zc(%d, 0x%x)\n", s, flags));
+	sock = get_socket(s);
+	if (!sock) {
+		return -1;
+	}
+
+	if ((p == NULL) || ((flags & MSG_PEEK) != 0)) {
+		sock_set_errno(sock, EINVAL);
+		return -1;
+	}
+	*p = NULL;
+
+	if (sock->lastdata) {
+		/* data left over from a copying recv on this socket */
+		buf = sock->lastdata;
+	} else {
+		if (((flags & MSG_DONTWAIT) || netconn_is_nonblocking(sock->conn)) && (sock->rcvevent <= 0)) {
+			LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_zc(%d): returning EWOULDBLOCK\n", s));
+			sock_set_errno(sock, EWOULDBLOCK);
+			return -1;
+		}
+
+		if (netconn_type(sock->conn) == NETCONN_TCP) {
+			err = netconn_recv_tcp_pbuf(sock->conn, (struct pbuf **)&buf);
+		} else {
+			err = netconn_recv(sock->conn, (struct netbuf **)&buf);
+		}
+		if (err != ERR_OK) {
+			LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_zc(%d): error is \"%s\"!\n", s, lwip_strerr(err)));
+			sock_set_errno(sock, err_to_errno(err));
+			return (err == ERR_CLSD) ? 0 : -1;
+		}
+		LWIP_ASSERT("buf != NULL", buf != NULL);
+	}
+
+	if (netconn_type(sock->conn) == NETCONN_TCP) {
+		q = (struct pbuf *)buf;
+		if (sock->lastoffset > 0) {
+			q = lwip_pbuf_skip(q, sock->lastoffset);
+		}
+		addr = &fromaddr;
+		netconn_getaddr(sock->conn, addr, &port, 0);
+	} else {
+		struct netbuf *nbuf = (struct netbuf *)buf;
+
+		ip_addr_copy(fromaddr, *netbuf_fromaddr(nbuf));
+		addr = &fromaddr;
+		port = netbuf_fromport(nbuf);
+		/* detach the chain so that only the netbuf itself is freed */
+		q = nbuf->p;
+		nbuf->p = nbuf->ptr = NULL;
+		netbuf_delete(nbuf);
+	}
+	sock->lastdata = NULL;
+	sock->lastoffset = 0;
+
+	if (from && fromlen) {
+		struct sockaddr_in sin;
+
+		memset(&sin, 0, sizeof(sin));
+		sin.sin_len = sizeof(sin);
+		sin.sin_family = AF_INET;
+		sin.sin_port = htons(port);
+		inet_addr_from_ipaddr(&sin.sin_addr, addr);
+
+		if (*fromlen > sizeof(sin)) {
+			*fromlen = sizeof(sin);
+		}
+
+		MEMCPY(from, &sin, *fromlen);
+	}
+
+	LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recv_zc(%d): pbuf=%p len=%" U16_F "\n", s, (void *)q, q->tot_len));
+	*p = q;
+	sock_set_errno(sock, 0);
+	return q->tot_len;
+}
+
+/**
+ * Give a pbuf chain obtained from lwip_recv_zc() back to the stack.
+ * The chain must be passed unmodified.
+ */
+int lwip_recv_zc_release(int s, struct pbuf *p)
+{
+	struct socket *sock;
+	u16_t len;
+
+	if (p == NULL) {
+		set_errno(EINVAL);
+		return -1;
+	}
+	len = p->tot_len;
+	pbuf_free(p);
+
+	sock = get_socket(s);
+	if (!sock) {
+		/* the data has been released all the same */
+		return -1;
+	}
+	if (netconn_type(sock->conn) == NETCONN_TCP) {
+		/* update receive window */
+		netconn_recved(sock->conn, (u32_t)len);
+	}
+	sock_set_errno(sock, 0);
+	return 0;
+}
+
+/**
+ * Send data without copying it into stack buffers.
+ * 'sent' is called exactly once for every call that queued data, with 0
+ * or an errno value, after which the application may reuse 'data'. For
+ * TCP this happens from tcpip_thread when the peer has acknowledged the
+ * data; closing the socket before that aborts the connection. Datagrams
+ * are completed before this function returns.
+ *
+ * @return the number of bytes queued, -1 on error
+ */
+int lwip_send_zc(int s, const void *data, size_t size, int flags, lwip_zc_sent_fn sent, void *arg)
+{
+	struct socket *sock;
+	struct lwip_zc_send *zc;
+	struct netconn_zc_req *req;
+	err_t err;
+	u8_t write_flags;
+	size_t written;
+	int ret;
+
+	LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_send_zc(%d, data=%p, size=%" SZT_F ", flags=0x%x)\n", s, data, size, flags));
+
+	sock = get_socket(s);
+	if (!sock) {
+		return -1;
+	}
+
+	if (sent == NULL) {
+		sock_set_errno(sock, EINVAL);
+		return -1;
+	}
+
+	if (sock->conn->type != NETCONN_TCP) {
+		/* the datagram path already sends by reference and the stack
+		   drops its reference before returning */
+		ret = lwip_sendto(s, data, size, flags, NULL, 0);
+		if (ret >= 0) {
+			sent(arg, 0);
+		}
+		return ret;
+	}
+
+	zc = (struct lwip_zc_send *)mem_malloc(sizeof(struct lwip_zc_send));
+	if (zc == NULL) {
+		sock_set_errno(sock, ENOMEM);
+		return -1;
+	}
+	zc->req.sent = lwip_zc_sent;
+	zc->sent = sent;
+	zc->arg = arg;
+	req = &zc->req;
+
+	write_flags = NETCONN_NOCOPY | ((flags & MSG_MORE) ? NETCONN_MORE : 0) | ((flags & MSG_DONTWAIT) ? NETCONN_DONTBLOCK : 0);
+	written = 0;
+	err = netconn_write_zc(sock->conn, data, size, write_flags, &written, &req);
+	if (req != NULL) {
+		/* nothing was queued, the stack did not take the request */
+		mem_free(zc);
+	}
+
+	LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_send_zc(%d) err=%d written=%" SZT_F "\n", s, err, written));
+	sock_set_errno(sock, err_to_errno(err));
+	return (err == ERR_OK ? (int)written : -1);
+}
+#endif							/* LWIP_NETCONN_ZEROCOPY */
+
 int lwip_send(int s, const void *data, size_t size, int flags)
 {
 	struct socket *sock;
@@ -1128,7 +1456,7 @@ static int lwip_selscan(int maxfdp1, fd_set * readset_in, fd_set * writeset_in,
 	int i, nready = 0;
 	fd_set lreadset, lwriteset, lexceptset;
 	struct socket *sock;
-	SYS_ARCH_DECL_PROTECT(lev);
+	SOCK_LOCK_DECL(lev);
 
 	FD_ZERO(&lreadset);
 	FD_ZERO(&lwriteset);
@@ -1142,15 +1470,15 @@ static int lwip_selscan(int maxfdp1, fd_set * readset_in, fd_set * writeset_in,
 		u16_t sendevent = 0;
 		u16_t errevent = 0;
 		/* First get the socket's status (protected)... */
-		SYS_ARCH_PROTECT(lev);
 		sock = tryget_socket(i);
 		if (sock != NULL) {
+			SOCK_LOCK(sock, lev);
 			lastdata = sock->lastdata;
 			rcvevent = sock->rcvevent;
 			sendevent = sock->sendevent;
 			errevent = sock->errevent;
+			SOCK_UNLOCK(sock, lev);
 		}
-		SYS_ARCH_UNPROTECT(lev);
 		/* ... then examine it: */
 		/* See if netconn of this socket is ready for read */
 		if (readset_in && FD_ISSET(i, readset_in) && ((lastdata != NULL) || (rcvevent > 0))) {
@@ -1193,6 +1521,7 @@ int lwip_select(int maxfdp1, fd_set * readset, fd_set * writeset, fd_set * excep
 	int i;
 	int maxfdp2;
 	SYS_ARCH_DECL_PROTECT(lev);
+	SOCK_LOCK_DECL(slev);
 
 	LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_select(%d, %p, %p, %p, tvsec=%" S32_F " tvusec=%" S32_F ")\n", maxfdp1, (void *)readset, (void *)writeset, (void *)exceptset, timeout ? (s32_t)timeout->tv_sec : (s32_t)-1, timeout ? (s32_t)timeout->tv_usec : (s32_t)-1));
 
@@ -1246,19 +1575,18 @@ int lwip_select(int maxfdp1, fd_set * readset, fd_set * writeset, fd_set * excep
 		for (i = LWIP_SOCKET_OFFSET; i < maxfdp1; i++) {
 			if ((readset && FD_ISSET(i, readset)) || (writeset && FD_ISSET(i, writeset)) || (exceptset && FD_ISSET(i, exceptset))) {
 				struct socket *sock;
-				SYS_ARCH_PROTECT(lev);
 				sock = tryget_socket(i);
 				if (sock != NULL) {
+					SOCK_LOCK(sock, slev);
 					sock->select_waiting++;
 					LWIP_ASSERT("sock->select_waiting > 0", sock->select_waiting > 0);
+					SOCK_UNLOCK(sock, slev);
 				} else {
 					/* Not a valid socket */
 					nready = -1;
 					maxfdp2 = i;
-					SYS_ARCH_UNPROTECT(lev);
 					break;
 				}
-				SYS_ARCH_UNPROTECT(lev);
 			}
 		}
 
@@ -1287,21 +1615,21 @@ int lwip_select(int maxfdp1, fd_set * readset, fd_set * writeset, fd_set * excep
 		for (i = LWIP_SOCKET_OFFSET; i < maxfdp2; i++) {
 			if ((readset && FD_ISSET(i, readset)) || (writeset && FD_ISSET(i, writeset)) || (exceptset && FD_ISSET(i, exceptset))) {
 				struct socket *sock;
-				SYS_ARCH_PROTECT(lev);
 				sock = tryget_socket(i);
 				if (sock != NULL) {
 					/* @todo: what if this is a new socket (reallocated?) in this case,
 					   select_waiting-- would be wrong (a global 'sockalloc' counter,
 					   stored per socket could help) */
+					SOCK_LOCK(sock, slev);
 					LWIP_ASSERT("sock->select_waiting > 0", sock->select_waiting > 0);
 					if (sock->select_waiting > 0) {
 						sock->select_waiting--;
 					}
+					SOCK_UNLOCK(sock, slev);
 				} else {
 					/* Not a valid socket */
 					nready = -1;
 				}
-				SYS_ARCH_UNPROTECT(lev);
 			}
 		}
 		/* Take us off the list */
@@ -1356,44 +1684,149 @@ return_copy_fdsets:
 
 #else
 
+/**
+ * Compute the subset of 'events' currently signalled on a socket.
+ * Must be called with the socket locked.
+ */
+static pollevent_t lwip_poll_revents(struct socket *sock, pollevent_t events)
+{
+	pollevent_t revents = 0;
+
+	/* See if netconn of this socket is ready for read */
+	if ((events & POLLIN) && ((sock->lastdata != NULL) || (sock->rcvevent > 0))) {
+		revents |= POLLIN;
+	}
+	/* See if netconn of this socket is ready for write */
+	if ((events & POLLOUT) && (sock->sendevent != 0)) {
+		revents |= POLLOUT;
+	}
+	/* See if netconn of this socket had an error */
+	if ((events & POLLERR) && (sock->errevent != 0)) {
+		revents |= POLLERR;
+	}
+
+	return revents;
+}
+
 static int lwip_poll_scan(int fd, struct socket * sock, struct pollfd * fds)
 {
+	pollevent_t revents;
+	SOCK_LOCK_DECL(lev);
 
-	void *lastdata = NULL;
-	s16_t rcvevent = 0;
-	u16_t sendevent = 0;
-	u16_t errevent = 0;
-	int nready = 0;
-	SYS_ARCH_DECL_PROTECT(lev);
+	SOCK_LOCK(sock, lev);
+	revents = lwip_poll_revents(sock, fds->events);
+	SOCK_UNLOCK(sock, lev);
 
-	SYS_ARCH_PROTECT(lev);
+	fds->revents |= revents;
 
-	lastdata = sock->lastdata;
-	rcvevent = sock->rcvevent;
-	sendevent = sock->sendevent;
-	errevent = sock->errevent;
+	/* one count per event, as select() counts set bits */
+	return ((revents & POLLIN) != 0) + ((revents & POLLOUT) != 0) + ((revents & POLLERR) != 0);
+}
 
-	SYS_ARCH_UNPROTECT(lev);
+/**
+ * Put a waiter on the socket's own waiter list.
+ * Must be called with the socket locked.
+ */
+static void lwip_poll_link(struct socket *sock, struct lwip_select_cb *select_cb)
+{
+	select_cb->prev = NULL;
+	select_cb->next = sock->select_cb;
+	if (sock->select_cb != NULL) {
+		sock->select_cb->prev = select_cb;
+	}
+	sock->select_cb = select_cb;
+	select_cb->sock = sock;
 
-	/* ... then examine it: */
-	/* See if netconn of this socket is ready for read */
-	if ((fds->events & POLLIN) && ((lastdata != NULL) || (rcvevent > 0))) {
-		fds->revents |= POLLIN;
-		nready++;
+	/* Increase select_waiting for the socket */
+	sock->select_waiting++;
+}
+
+/**
+ * Take a waiter off its socket's waiter list.
+ * Must be called with the socket locked.
+ */
+static void lwip_poll_unlink(struct lwip_select_cb *select_cb)
+{
+	struct socket *sock = select_cb->sock;
+
+	if (select_cb->next != NULL) {
+		select_cb->next->prev = select_cb->prev;
 	}
-	/* See if netconn of this socket is ready for write */
-	if ((fds->events & POLLOUT) && (sendevent != 0)) {
-		fds->revents |= POLLOUT;
-		nready++;
+	if (sock->select_cb == select_cb) {
+		LWIP_ASSERT("select_cb.prev == NULL", select_cb->prev == NULL);
+		sock->select_cb = select_cb->next;
+	} else {
+		LWIP_ASSERT("select_cb.prev != NULL", select_cb->prev != NULL);
+		select_cb->prev->next = select_cb->next;
 	}
-	/* See if netconn of this socket had an error */
-	if ((fds->events & POLLERR) && (errevent != 0)) {
-		fds->revents |= POLLERR;
-		nready++;
+	if (sock->select_waiting > 0) {
+		sock->select_waiting--;
 	}
+}
 
-	LWIP_ASSERT("nready >= 0", nready >= 0);
-	return nready;
+/**
+ * Signal a waiter whose events are in effect.
+ * Must be called with the socket locked, so that the waiter cannot take
+ * itself off the list (and invalidate the semaphore) in between.
+ */
+static void lwip_poll_signal(struct lwip_select_cb *scb)
+{
+	pollevent_t revents = lwip_poll_revents(scb->sock, scb->events);
+
+	if (revents == 0) {
+		return;
+	}
+	if (scb->notify != NULL) {
+		SYS_ARCH_DECL_PROTECT(lev);
+
+		/* persistent registration: it keeps its own ready state, which
+		   its owner shares under SYS_ARCH protection */
+		SYS_ARCH_PROTECT(lev);
+		scb->notify(scb->arg, revents);
+		SYS_ARCH_UNPROTECT(lev);
+	} else if (scb->sem_signalled == 0) {
+		scb->sem_signalled = 1;
+		sys_sem_signal(scb->poll_sem);
+	}
+}
+
+/**
+ * Release all waiters of a socket that is being freed: poll() waiters are
+ * woken up and will see EBADF, persistent registrations are notified with
+ * POLLNVAL and forgotten.
+ */
+static void lwip_poll_release(struct socket *sock)
+{
+	struct lwip_select_cb *scb;
+	struct lwip_select_cb *dead = NULL;
+	SOCK_LOCK_DECL(lev);
+
+	SOCK_LOCK(sock, lev);
+	while ((scb = sock->select_cb) != NULL) {
+		lwip_poll_unlink(scb);
+		if (scb->notify != NULL) {
+			SYS_ARCH_DECL_PROTECT(lev);
+
+			/* see lwip_poll_handle_socket() */
+			SYS_ARCH_PROTECT(lev);
+			*scb->handle = NULL;
+			scb->notify(scb->arg, POLLNVAL);
+			SYS_ARCH_UNPROTECT(lev);
+		} else {
+			scb->fds->scb = NULL;
+			if (scb->sem_signalled == 0) {
+				sys_sem_signal(scb->poll_sem);
+			}
+		}
+		scb->next = dead;
+		dead = scb;
+	}
+	SOCK_UNLOCK(sock, lev);
+
+	while ((scb = dead) != NULL) {
+		dead = scb->next;
+		mem_free(scb);
+	}
 }
 
 static int lwip_poll_setup(int fd, struct socket * sock, struct pollfd * fds)
@@ -1408,7 +1841,7 @@ static int lwip_poll_setup(int fd, struct socket * sock, struct pollfd * fds)
 		return -EINVAL;
 	}
 #endif
-	SYS_ARCH_DECL_PROTECT(lev);
+	SOCK_LOCK_DECL(lev);
 	fds->scb = NULL;
 	nready = lwip_poll_scan(fd, sock, fds);
 
@@ -1428,35 +1861,22 @@ static int lwip_poll_setup(int fd, struct socket * sock, struct pollfd * fds)
 
 	memset(select_cb, 0, scb_size);
 
-	/* None ready: add our semaphore to list: */
+	/* None ready: add our semaphore to the socket's list: */
 
-	select_cb->next = NULL;
-	select_cb->prev = NULL;
 	select_cb->sem_signalled = 0;
 	select_cb->poll_sem = fds->sem;
 	select_cb->events = fds->events;
 	select_cb->sfd = fd;
+	select_cb->fds = fds;
 
-	/* Protect the select_cb_list */
-	SYS_ARCH_PROTECT(lev);
-
-	/* Put this select_cb on top of list */
-	select_cb->next = select_cb_list;
-	if (select_cb_list != NULL) {
-		select_cb_list->prev = select_cb;
-	}
+	/* Protect the socket's waiter list */
+	SOCK_LOCK(sock, lev);
 
+	lwip_poll_link(sock, select_cb);
 	fds->scb = (void *)select_cb;
-	select_cb_list = select_cb;
-
-	/* Increasing this counter tells event_callback that the list has changed. */
-	select_cb_ctr++;
-
-	/* Increase select_waiting for the socket */
-	sock->select_waiting++;
 
 	/* Now we can safely unprotect */
-	SYS_ARCH_UNPROTECT(lev);
+	SOCK_UNLOCK(sock, lev);
 
 	/* Call lwip_pollscan again: there could have been events between
 	   the last scan (without us on the list) and putting us on the list! */
@@ -1475,33 +1895,21 @@ static int lwip_poll_setup(int fd, struct socket * sock, struct pollfd * fds)
 static int lwip_poll_teardown(int fd, struct socket * sock, struct pollfd * fds)
 {
 	struct lwip_select_cb *select_cb = NULL;
-	SYS_ARCH_DECL_PROTECT(lev);
+	SOCK_LOCK_DECL(lev);
 
+	SOCK_LOCK(sock, lev);
 	select_cb = (struct lwip_select_cb *)fds->scb;
 
-	SYS_ARCH_PROTECT(lev);
-	if (sock->select_waiting > 0) {
-		sock->select_waiting--;
+	/* Take select_cb off the socket's list */
+	if (select_cb) {
+		lwip_poll_unlink(select_cb);
+		fds->scb = NULL;
 	}
+	SOCK_UNLOCK(sock, lev);
 
-	/* Take select_cb_list off the list */
 	if (select_cb) {
-		if (select_cb->next != NULL) {
-			select_cb->next->prev = select_cb->prev;
-		}
-		if (select_cb_list == select_cb) {
-			LWIP_ASSERT("select_cb.prev == NULL", select_cb->prev == NULL);
-			select_cb_list = select_cb->next;
-		} else {
-			LWIP_ASSERT("select_cb.prev != NULL", select_cb->prev != NULL);
-			select_cb->prev->next = select_cb->next;
-		}
-
 		mem_free((void *)select_cb);
-		/* Increasing this counter tells event_callback that the list has changed. */
-		select_cb_ctr++;
 	}
-	SYS_ARCH_UNPROTECT(lev);
 
 	/* See what's set */
 	lwip_poll_scan(fd, sock, fds);
@@ -1555,6 +1963,203 @@ int lwip_poll(int fd, struct pollfd * fds, bool setup)
 
 }
 
+/**
+ * Find the socket of a persistent registration, which is only known through
+ * its handle. lwip_poll_release() clears the handle before the registration
+ * is freed, so read both under SYS_ARCH protection. The socket itself stays
+ * (the socket array never moves): the caller locks it and then checks with
+ * lwip_poll_handle_valid() that the registration still is the one found.
+ *
+ * @return the socket, NULL if the registration has been released
+ */
+static struct socket *lwip_poll_handle_socket(void **handle, struct lwip_select_cb **select_cb, u16_t *gen)
+{
+	struct socket *sock = NULL;
+	SYS_ARCH_DECL_PROTECT(lev);
+
+	SYS_ARCH_PROTECT(lev);
+	*select_cb = (struct lwip_select_cb *)*handle;
+	if (*select_cb != NULL) {
+		sock = (*select_cb)->sock;
+		*gen = sock->gen;
+	}
+	SYS_ARCH_UNPROTECT(lev);
+
+	return sock;
+}
+
+/**
+ * With the socket locked: is *handle still the registration found by
+ * lwip_poll_handle_socket()? The memory of a released registration may
+ * have been reused for a new one, on another socket or on this socket
+ * after it was closed and allocated again.
+ */
+static int lwip_poll_handle_valid(struct socket *sock, u16_t gen, void **handle, struct lwip_select_cb *select_cb)
+{
+	return *handle == select_cb && select_cb->sock == sock && sock->gen == gen;
+}
+
+/****************************************************************************
+ * Function: lwip_poll_register
+ *
+ * Description:
+ *   Register a persistent interest in events of a socket, as used by
+ *   epoll. Unlike lwip_poll(), the registration stays on the socket's
+ *   waiter list until it is unregistered or the socket is closed, and
+ *   'notify' is called (with the scheduler locked) each time one of the
+ *   requested events is signalled on the socket. When the socket is
+ *   closed, 'notify' is called with POLLNVAL and *handle is cleared.
+ *
+ * Input Parameters:
+ *   fd     - The socket descriptor
+ *   events - The events of interest (POLLIN, POLLOUT, POLLERR)
+ *   notify - The notification function
+ *   arg    - Argument passed to notify
+ *   handle - Receives the registration, owned by the caller until it is
+ *            cleared by lwip_poll_unregister() or by closing the socket
+ *
+ * Returned Value:
+ *  0: Success; Negated errno on failure
+ *
+ ****************************************************************************/
+
+int lwip_poll_register(int fd, pollevent_t events, lwip_poll_notify_t notify, void *arg, void **handle)
+{
+	struct socket *sock;
+	struct lwip_select_cb *select_cb;
+	int scb_size;
+	SOCK_LOCK_DECL(lev);
+
+	sock = tryget_socket(fd);
+	if (!sock) {
+		return -EBADF;
+	}
+
+	scb_size = LWIP_MEM_ALIGN_SIZE(sizeof(struct lwip_select_cb));
+	select_cb = (struct lwip_select_cb *)mem_malloc(scb_size);
+	if (!select_cb) {
+		return -ENOMEM;
+	}
+	memset(select_cb, 0, scb_size);
+
+	select_cb->events = events;
+	select_cb->sfd = fd;
+	select_cb->notify = notify;
+	select_cb->arg = arg;
+	select_cb->handle = handle;
+
+	SOCK_LOCK(sock, lev);
+	lwip_poll_link(sock, select_cb);
+	*handle = select_cb;
+	/* report events that are already in effect */
+	lwip_poll_signal(select_cb);
+	SOCK_UNLOCK(sock, lev);
+
+	return 0;
+}
+
+/****************************************************************************
+ * Function: lwip_poll_modify
+ *
+ * Description:
+ *   Change the events of a registration made by lwip_poll_register().
+ *
+ * Returned Value:
+ *  0: Success; -EBADF if the socket has been closed meanwhile
+ *
+ ****************************************************************************/
+
+int lwip_poll_modify(void **handle, pollevent_t events)
+{
+	struct lwip_select_cb *select_cb;
+	struct socket *sock;
+	u16_t gen;
+	int ret = -EBADF;
+	SOCK_LOCK_DECL(lev);
+
+	sock = lwip_poll_handle_socket(handle, &select_cb, &gen);
+	if (sock == NULL) {
+		return -EBADF;
+	}
+
+	SOCK_LOCK(sock, lev);
+	if (lwip_poll_handle_valid(sock, gen, handle, select_cb)) {
+		select_cb->events = events;
+		lwip_poll_signal(select_cb);
+		ret = 0;
+	}
+	SOCK_UNLOCK(sock, lev);
+
+	return ret;
+}
+
+/****************************************************************************
+ * Function: lwip_poll_unregister
+ *
+ * Description:
+ *   Remove a registration made by lwip_poll_register(). Does nothing if
+ *   the socket has been closed meanwhile.
+ *
+ ****************************************************************************/
+
+void lwip_poll_unregister(void **handle)
+{
+	struct lwip_select_cb *select_cb;
+	struct socket *sock;
+	u16_t gen;
+	SOCK_LOCK_DECL(lev);
+
+	sock = lwip_poll_handle_socket(handle, &select_cb, &gen);
+	if (sock == NULL) {
+		return;
+	}
+
+	SOCK_LOCK(sock, lev);
+	if (!lwip_poll_handle_valid(sock, gen, handle, select_cb)) {
+		/* released by closing the socket meanwhile */
+		select_cb = NULL;
+	} else {
+		lwip_poll_unlink(select_cb);
+		*handle = NULL;
+	}
+	SOCK_UNLOCK(sock, lev);
+
+	if (select_cb != NULL) {
+		mem_free(select_cb);
+	}
+}
+
+/****************************************************************************
+ * Function: lwip_poll_pending
+ *
+ * Description:
+ *   Return the requested events of a registration that are in effect now.
+ *   epoll uses this for level-triggered reporting.
+ *
+ ****************************************************************************/
+
+pollevent_t lwip_poll_pending(void **handle)
+{
+	struct lwip_select_cb *select_cb;
+	struct socket *sock;
+	u16_t gen;
+	pollevent_t revents = POLLNVAL;
+	SOCK_LOCK_DECL(lev);
+
+	sock = lwip_poll_handle_socket(handle, &select_cb, &gen);
+	if (sock == NULL) {
+		return POLLNVAL;
+	}
+
+	SOCK_LOCK(sock, lev);
+	if (lwip_poll_handle_valid(sock, gen, handle, select_cb)) {
+		revents = lwip_poll_revents(sock, select_cb->events);
+	}
+	SOCK_UNLOCK(sock, lev);
+
+	return revents;
+}
+
 #endif							/*LWIP_SELECT */
 
 /**
@@ -1566,8 +2171,12 @@ static void event_callback(struct netconn * conn, enum netconn_evt evt, u16_t le
 	int s;
 	struct socket *sock;
 	struct lwip_select_cb *scb;
+	u16_t gen;
+#if LWIP_SELECT
 	int last_select_cb_ctr;
+#endif
 	SYS_ARCH_DECL_PROTECT(lev);
+	SOCK_LOCK_DECL(slev);
 
 	LWIP_UNUSED_ARG(len);
 
@@ -1595,7 +2204,7 @@ static void event_callback(struct netconn * conn, enum netconn_evt evt, u16_t le
 		/* network task have their own socketlist
 		 * so get the struct socket from socketlist
 		 * that is assigned alloc_socket*/
-		sock = get_socket_from_list(s, conn);
+		sock = get_socket_from_list(s, conn, &gen);
 		if (!sock) {
 			return;
 		}
@@ -1603,7 +2212,12 @@ static void event_callback(struct netconn * conn, enum netconn_evt evt, u16_t le
 		return;
 	}
 
-	SYS_ARCH_PROTECT(lev);
+	SOCK_LOCK(sock, slev);
+	if (sock->conn != conn || sock->gen != gen) {
+		/* closed (and maybe reused) while we waited for the lock */
+		SOCK_UNLOCK(sock, slev);
+		return;
+	}
 	/* Set event as required */
 	switch (evt) {
 	case NETCONN_EVT_RCVPLUS:
@@ -1628,16 +2242,27 @@ static void event_callback(struct netconn * conn, enum netconn_evt evt, u16_t le
 
 	if (sock->select_waiting == 0) {
 		/* none is waiting for this socket, no need to check select_cb_list */
-		SYS_ARCH_UNPROTECT(lev);
+		SOCK_UNLOCK(sock, slev);
 		return;
 	}
 
+#if !LWIP_SELECT
+	/* Only the waiters of this socket are on its list: wake up those whose
+	   events are in effect. The list is short, so keep the socket locked. */
+	for (scb = sock->select_cb; scb != NULL; scb = scb->next) {
+		lwip_poll_signal(scb);
+	}
+	SOCK_UNLOCK(sock, slev);
+#else
+	SOCK_UNLOCK(sock, slev);
+
 	/* Now decide if anyone is waiting for this socket */
 	/* NOTE: This code goes through the select_cb_list list multiple times
 	   ONLY IF a select was actually waiting. We go through the list the number
 	   of waiting select calls + 1. This list is expected to be small. */
 
-	/* At this point, SYS_ARCH is still protected! */
+	/* select_cb_list is shared by all sockets: protect it globally */
+	SYS_ARCH_PROTECT(lev);
 again:
 	for (scb = select_cb_list; scb != NULL; scb = scb->next) {
 
@@ -1646,35 +2271,19 @@ again:
 		if (scb->sem_signalled == 0) {
 			/* semaphore not signalled yet */
 			int do_signal = 0;
-			int check_set = 0;
 			/* Test this select call for our socket */
 			if (sock->rcvevent > 0) {
-#if LWIP_SELECT
-				check_set = scb->readset && FD_ISSET(s, scb->readset);
-#else
-				check_set = (scb->sfd == s) && (scb->events & POLLIN);
-#endif
-				if (check_set) {
+				if (scb->readset && FD_ISSET(s, scb->readset)) {
 					do_signal = 1;
 				}
 			}
 			if (sock->sendevent != 0) {
-#if LWIP_SELECT
-				check_set = scb->writeset && FD_ISSET(s, scb->writeset);
-#else
-				check_set = (scb->sfd == s) && (scb->events & POLLOUT);
-#endif
-				if (!do_signal && check_set) {
+				if (!do_signal && scb->writeset && FD_ISSET(s, scb->writeset)) {
 					do_signal = 1;
 				}
 			}
 			if (sock->errevent != 0) {
-#if LWIP_SELECT
-				check_set = scb->exceptset && FD_ISSET(s, scb->exceptset);
-#else
-				check_set = (scb->sfd == s) && (scb->events & POLLERR);
-#endif
-				if (!do_signal && check_set) {
+				if (!do_signal && scb->exceptset && FD_ISSET(s, scb->exceptset)) {
 					do_signal = 1;
 				}
 			}
@@ -1682,11 +2291,7 @@ again:
 				scb->sem_signalled = 1;
 				/* Don't call SYS_ARCH_UNPROTECT() before signaling the semaphore, as this might
 				   lead to the select thread taking itself off the list, invalidagin the semaphore. */
-#if LWIP_SELECT
 				sys_sem_signal(&scb->sem);
-#else
-				sys_sem_signal(scb->poll_sem);
-#endif
 			}
 		}
 		/* unlock interrupts with each step */
@@ -1699,8 +2304,10 @@ again:
 		}
 	}
 	SYS_ARCH_UNPROTECT(lev);
+#endif							/* !LWIP_SELECT */
 }
 
+
 /**
  * Unimplemented: Close one end of a full-duplex connection.
  * Currently, the full connection is closed.
@@ -843,7 +843,7 @@ err_t ip_output(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest, u8_t ttl, u8_t
  * @return ERR_RTE if no route is found
  *         see ip_output_if() for more return values
  */
-err_t ip_output_hinted(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest, u8_t ttl, u8_t tos, u8_t proto, u8_t *addr_hint)
+err_t ip_output_hinted(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest, u8_t ttl, u8_t tos, u8_t proto, u16_t *addr_hint)
 {
 	struct netif *netif;
 	err_t err;
@@ -327,7 +327,7 @@ err_t ip_output(struct pbuf *p, struct ip_addr *src, struct ip_addr *dest, u8_t
 }
 
 #if LWIP_NETIF_HWADDRHINT
-err_t ip_output_hinted(struct pbuf *p, struct ip_addr *src, struct ip_addr *dest, u8_t ttl, u8_t tos, u8_t proto, u8_t *addr_hint)
+err_t ip_output_hinted(struct pbuf *p, struct ip_addr *src, struct ip_addr *dest, u8_t ttl, u8_t tos, u8_t proto, u16_t *addr_hint)
 {
 	struct netif *netif;
 	err_t err;
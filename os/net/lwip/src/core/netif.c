@@ -202,6 +202,10 @@ struct netif *netif_add(struct netif *netif, ip_addr_t *ipaddr, ip_addr_t *netma
 	netif->loop_first = NULL;
 	netif->loop_last = NULL;
 #endif							/* ENABLE_LOOPBACK */
+#if LWIP_ARP
+	netif->arp_entries = 0;
+	netif->arp_max_entries = ETHARP_NETIF_MAX_ENTRIES;
+#endif							/* LWIP_ARP */
 
 	/* remember netif specific state information data */
 	netif->state = state;
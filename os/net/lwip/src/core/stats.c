@@ -164,6 +164,16 @@ void stats_display_sys(struct stats_sys *sys)
 }
 #endif							/* SYS_STATS */
 
+#if SOCK_LOCK_STATS
+void stats_display_lock(struct stats_lock *lock, const char *name)
+{
+	LWIP_STATS_DIAG(("\n%s\n\t", name));
+	LWIP_STATS_DIAG(("acquired: %" U32_F "\n\t", lock->acquired));
+	LWIP_STATS_DIAG(("hold.max: %" U32_F "\n\t", lock->hold_max));
+	LWIP_STATS_DIAG(("hold.avg: %" U32_F "\n", lock->acquired ? (u32_t)(lock->hold_total / lock->acquired) : 0));
+}
+#endif							/* SOCK_LOCK_STATS */
+
 int stats_display(void)
 {
 	s16_t i;
@@ -181,6 +191,7 @@ int stats_display(void)
 		MEMP_STATS_DISPLAY(i);
 	}
 	SYS_STATS_DISPLAY();
+	SOCK_LOCK_STATS_DISPLAY();
 	return 0;
 }
 #endif							/* LWIP_STATS_DISPLAY */
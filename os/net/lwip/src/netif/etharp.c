@@ -133,13 +133,35 @@ struct etharp_entry {
 	struct netif *netif;
 	struct eth_addr ethaddr;
 	u8_t state;
-	u8_t ctime;
+	u16_t ctime;
+	/** next entry of the hash bucket, or of the free list if empty */
+	u16_t next;
+	/** neighbours in the LRU list of the dynamic (non-static) entries */
+	u16_t lru_prev;
+	u16_t lru_next;
 };
 
+/* The links between entries hold the index + 1, so that 0 ends a list and
+ * the zero initialized table needs no etharp_init(). */
+#define ARP_LINK(i)    ((u16_t)((i) + 1))
+#define ARP_INDEX(l)   ((s16_t)((l) - 1))
+
+#define ARP_HASH(ipaddr) \
+	((u16_t)(etharp_hash_fold(ip4_addr_get_u32(ipaddr)) & (ETHARP_HASH_SIZE - 1)))
+
 static struct etharp_entry arp_table[ARP_TABLE_SIZE];
+/** heads of the hash buckets */
+static u16_t arp_hash[ETHARP_HASH_SIZE];
+/** entries freed after use, linked by next */
+static u16_t arp_free;
+/** entries from this index on have never been used */
+static u16_t arp_unused;
+/** most and least recently used dynamic entries */
+static u16_t arp_lru_head;
+static u16_t arp_lru_tail;
 
 #if !LWIP_NETIF_HWADDRHINT
-static u8_t etharp_cached_entry;
+static u16_t etharp_cached_entry;
 #endif							/* !LWIP_NETIF_HWADDRHINT */
 
 /** Try hard to create a new entry - we want the IP address to appear in
@@ -158,8 +180,11 @@ static u8_t etharp_cached_entry;
 #endif							/* LWIP_NETIF_HWADDRHINT */
 
 /* Some checks, instead of etharp_init(): */
-#if (LWIP_ARP && (ARP_TABLE_SIZE > 0x7f))
-#error "ARP_TABLE_SIZE must fit in an s8_t, you have to reduce it in your lwipopts.h"
+#if (LWIP_ARP && (ARP_TABLE_SIZE > 0x7fff))
+#error "ARP_TABLE_SIZE must fit in an s16_t, you have to reduce it in your lwipopts.h"
+#endif
+#if (ETHARP_HASH_SIZE & (ETHARP_HASH_SIZE - 1)) != 0
+#error "ETHARP_HASH_SIZE must be a power of 2"
 #endif
 
 static err_t etharp_request_dst(struct netif *netif, const ip_addr_t *ipaddr, const struct eth_addr *hw_dst_addr);
@@ -190,6 +215,141 @@ static void free_etharp_q(struct etharp_q_entry *q)
 
 #endif							/* ARP_QUEUEING */
 
+/** Mix all the bytes of an IPv4 address into the low ones */
+static u32_t etharp_hash_fold(u32_t addr)
+{
+	addr ^= addr >> 16;
+	return addr ^ (addr >> 8);
+}
+
+/** Find the entry of an IP address, pending or stable, or -1 */
+static s16_t etharp_lookup(ip_addr_t *ipaddr)
+{
+	u16_t link = arp_hash[ARP_HASH(ipaddr)];
+
+	while (link != 0) {
+		struct etharp_entry *entry = &arp_table[ARP_INDEX(link)];
+		if (ip_addr_cmp(ipaddr, &entry->ipaddr)) {
+			return ARP_INDEX(link);
+		}
+		link = entry->next;
+	}
+	return -1;
+}
+
+static void etharp_hash_remove(s16_t i)
+{
+	u16_t *link = &arp_hash[ARP_HASH(&arp_table[i].ipaddr)];
+
+	while (*link != 0) {
+		if (*link == ARP_LINK(i)) {
+			*link = arp_table[i].next;
+			return;
+		}
+		link = &arp_table[ARP_INDEX(*link)].next;
+	}
+}
+
+static void etharp_lru_remove(s16_t i)
+{
+	struct etharp_entry *entry = &arp_table[i];
+
+	if (entry->lru_prev != 0) {
+		arp_table[ARP_INDEX(entry->lru_prev)].lru_next = entry->lru_next;
+	} else {
+		arp_lru_head = entry->lru_next;
+	}
+	if (entry->lru_next != 0) {
+		arp_table[ARP_INDEX(entry->lru_next)].lru_prev = entry->lru_prev;
+	} else {
+		arp_lru_tail = entry->lru_prev;
+	}
+	entry->lru_prev = 0;
+	entry->lru_next = 0;
+}
+
+static void etharp_lru_insert(s16_t i)
+{
+	struct etharp_entry *entry = &arp_table[i];
+
+	entry->lru_prev = 0;
+	entry->lru_next = arp_lru_head;
+	if (arp_lru_head != 0) {
+		arp_table[ARP_INDEX(arp_lru_head)].lru_prev = ARP_LINK(i);
+	} else {
+		arp_lru_tail = ARP_LINK(i);
+	}
+	arp_lru_head = ARP_LINK(i);
+}
+
+/** Mark a dynamic entry as the most recently used */
+static void etharp_lru_touch(s16_t i)
+{
+	if (arp_lru_head != ARP_LINK(i)) {
+		etharp_lru_remove(i);
+		etharp_lru_insert(i);
+	}
+}
+
+/** Entries of static state are never in the LRU list, the others always are */
+static int etharp_is_dynamic(s16_t i)
+{
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+	return arp_table[i].state != ETHARP_STATE_STATIC;
+#else							/* ETHARP_SUPPORT_STATIC_ENTRIES */
+	LWIP_UNUSED_ARG(i);
+	return 1;
+#endif							/* ETHARP_SUPPORT_STATIC_ENTRIES */
+}
+
+/** Move an entry to another netif, keeping the per-netif counts */
+static void etharp_set_netif(s16_t i, struct netif *netif)
+{
+	if (arp_table[i].netif != NULL) {
+		arp_table[i].netif->arp_entries--;
+	}
+	arp_table[i].netif = netif;
+	if (netif != NULL) {
+		netif->arp_entries++;
+	}
+}
+
+/**
+ * Choose the entry to recycle, walking from the least recently used:
+ * 1) a stable entry
+ * 2) a pending entry without queued packets
+ * 3) a pending entry with queued packets
+ * Static entries are never recycled.
+ *
+ * @param netif only consider the entries of this netif, or NULL for all
+ * @return the entry index, -1 if there is nothing to recycle
+ */
+static s16_t etharp_lru_victim(struct netif *netif)
+{
+	s16_t pending = -1;
+	s16_t queued = -1;
+	u16_t link;
+
+	for (link = arp_lru_tail; link != 0; link = arp_table[ARP_INDEX(link)].lru_prev) {
+		s16_t i = ARP_INDEX(link);
+		if (netif != NULL && arp_table[i].netif != netif) {
+			continue;
+		}
+		if (arp_table[i].state >= ETHARP_STATE_STABLE) {
+			/* no queued packets should exist on stable entries */
+			LWIP_ASSERT("arp_table[i].q == NULL", arp_table[i].q == NULL);
+			return i;
+		} else if (arp_table[i].q == NULL) {
+			if (pending < 0) {
+				pending = i;
+			}
+		} else if (queued < 0) {
+			queued = i;
+		}
+	}
+	return (pending >= 0) ? pending : queued;
+}
+
 /** Clean up ARP table entries */
 static void etharp_free_entry(int i)
 {
@@ -202,17 +362,40 @@ static void etharp_free_entry(int i)
 		free_etharp_q(arp_table[i].q);
 		arp_table[i].q = NULL;
 	}
+	etharp_hash_remove(i);
+	if (etharp_is_dynamic(i)) {
+		etharp_lru_remove(i);
+	}
+	etharp_set_netif(i, NULL);
 	/* recycle entry for re-use */
 	arp_table[i].state = ETHARP_STATE_EMPTY;
+	arp_table[i].next = arp_free;
+	arp_free = ARP_LINK(i);
 #ifdef LWIP_DEBUG
 	/* for debugging, clean out the complete entry */
 	arp_table[i].ctime = 0;
-	arp_table[i].netif = NULL;
 	ip_addr_set_zero(&arp_table[i].ipaddr);
 	arp_table[i].ethaddr = ethzero;
 #endif							/* LWIP_DEBUG */
 }
 
+/** Take an empty entry, or return -1 if the table is full */
+static s16_t etharp_alloc_entry(void)
+{
+	s16_t i;
+
+	if (arp_free != 0) {
+		i = ARP_INDEX(arp_free);
+		arp_free = arp_table[i].next;
+	} else if (arp_unused < ARP_TABLE_SIZE) {
+		i = (s16_t)arp_unused++;
+	} else {
+		return -1;
+	}
+	LWIP_ASSERT("arp_table[i].state == ETHARP_STATE_EMPTY", arp_table[i].state == ETHARP_STATE_EMPTY);
+	return i;
+}
+
 /**
  * Clears expired entries in the ARP table.
  *
@@ -221,17 +404,15 @@ static void etharp_free_entry(int i)
  */
 void etharp_tmr(void)
 {
-	u8_t i;
+	u16_t link;
+	s16_t i;
 
 	LWIP_DEBUGF(ETHARP_DEBUG, ("etharp_timer\n"));
-	/* remove expired entries from the ARP table */
-	for (i = 0; i < ARP_TABLE_SIZE; ++i) {
-		u8_t state = arp_table[i].state;
-		if (state != ETHARP_STATE_EMPTY
-#if ETHARP_SUPPORT_STATIC_ENTRIES
-			&& (state != ETHARP_STATE_STATIC)
-#endif							/* ETHARP_SUPPORT_STATIC_ENTRIES */
-		   ) {
+	/* remove expired entries from the ARP table, static entries are not in the LRU list */
+	for (link = arp_lru_head; link != 0;) {
+		i = ARP_INDEX(link);
+		link = arp_table[i].lru_next;
+		if (arp_table[i].state != ETHARP_STATE_EMPTY) {
 			arp_table[i].ctime++;
 			if ((arp_table[i].ctime >= ARP_MAXAGE) || ((arp_table[i].state == ETHARP_STATE_PENDING) && (arp_table[i].ctime >= ARP_MAXPENDING))) {
 				/* pending or stable entry has become old! */
@@ -264,150 +445,77 @@ void etharp_tmr(void)
  * If ipaddr is NULL, return a initialized new entry in state ETHARP_EMPTY.
  *
  * In all cases, attempt to create new entries from an empty entry. If no
- * empty entries are available and ETHARP_FLAG_TRY_HARD flag is set, recycle
- * old entries. Heuristic choose the least important entry for recycling.
+ * empty entries are available, or netif already holds its maximum number of
+ * entries, and ETHARP_FLAG_TRY_HARD flag is set, recycle the least recently
+ * used entry, preferring stable over pending ones (see etharp_lru_victim()).
  *
  * @param ipaddr IP address to find in ARP cache, or to add if not found.
  * @param flags @see definition of ETHARP_FLAG_*
- * @param netif netif related to this address (used for NETIF_HWADDRHINT)
+ * @param netif netif the new entry is created for, may be NULL
  *
  * @return The ARP entry index that matched or is created, ERR_MEM if no
  * entry is found or could be recycled.
  */
-static s8_t etharp_find_entry(ip_addr_t *ipaddr, u8_t flags)
+static s16_t etharp_find_entry(ip_addr_t *ipaddr, u8_t flags, struct netif *netif)
 {
-	s8_t old_pending = ARP_TABLE_SIZE, old_stable = ARP_TABLE_SIZE;
-	s8_t empty = ARP_TABLE_SIZE;
-	u8_t i = 0;
-	/* oldest entry with packets on queue */
-	s8_t old_queue = ARP_TABLE_SIZE;
-	/* its age */
-	u16_t age_queue = 0, age_pending = 0, age_stable = 0;
-
-	/**
-	 * a) do a search through the cache, remember candidates
-	 * b) select candidate entry
-	 * c) create new entry
-	 */
-
-	/* a) in a single search sweep, do all of this
-	 * 1) remember the first empty entry (if any)
-	 * 2) remember the oldest stable entry (if any)
-	 * 3) remember the oldest pending entry without queued packets (if any)
-	 * 4) remember the oldest pending entry with queued packets (if any)
-	 * 5) search for a matching IP entry, either pending or stable
-	 *    until 5 matches, or all entries are searched for.
-	 */
-
-	for (i = 0; i < ARP_TABLE_SIZE; ++i) {
-		u8_t state = arp_table[i].state;
-		/* no empty entry found yet and now we do find one? */
-		if ((empty == ARP_TABLE_SIZE) && (state == ETHARP_STATE_EMPTY)) {
-			LWIP_DEBUGF(ETHARP_DEBUG, ("etharp_find_entry: found empty entry %" U16_F "\n", (u16_t)i));
-			/* remember first empty entry */
-			empty = i;
-		} else if (state != ETHARP_STATE_EMPTY) {
-			LWIP_ASSERT("state == ETHARP_STATE_PENDING || state >= ETHARP_STATE_STABLE", state == ETHARP_STATE_PENDING || state >= ETHARP_STATE_STABLE);
-			/* if given, does IP address match IP address in ARP entry? */
-			if (ipaddr && ip_addr_cmp(ipaddr, &arp_table[i].ipaddr)) {
-				LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: found matching entry %" U16_F "\n", (u16_t)i));
-				/* found exact IP address match, simply bail out */
-				return i;
-			}
-			/* pending entry? */
-			if (state == ETHARP_STATE_PENDING) {
-				/* pending with queued packets? */
-				if (arp_table[i].q != NULL) {
-					if (arp_table[i].ctime >= age_queue) {
-						old_queue = i;
-						age_queue = arp_table[i].ctime;
-					}
-				} else
-					/* pending without queued packets? */
-				{
-					if (arp_table[i].ctime >= age_pending) {
-						old_pending = i;
-						age_pending = arp_table[i].ctime;
-					}
-				}
-				/* stable entry? */
-			} else if (state >= ETHARP_STATE_STABLE) {
-#if ETHARP_SUPPORT_STATIC_ENTRIES
-				/* don't record old_stable for static entries since they never expire */
-				if (state < ETHARP_STATE_STATIC)
-#endif							/* ETHARP_SUPPORT_STATIC_ENTRIES */
-				{
-					/* remember entry with oldest stable entry in oldest, its age in maxtime */
-					if (arp_table[i].ctime >= age_stable) {
-						old_stable = i;
-						age_stable = arp_table[i].ctime;
-					}
-				}
-			}
+	struct netif *limited = NULL;
+	s16_t i = -1;
+
+	/* search the hash bucket of the address for a pending or stable entry */
+	if (ipaddr != NULL) {
+		i = etharp_lookup(ipaddr);
+		if (i >= 0) {
+			LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: found matching entry %" U16_F "\n", (u16_t)i));
+			return i;
 		}
 	}
 	/* { we have no match } => try to create a new entry */
 
 	/* don't create new entry, only search? */
-	if (((flags & ETHARP_FLAG_FIND_ONLY) != 0) ||
-		/* or no empty entry found and not allowed to recycle? */
-		((empty == ARP_TABLE_SIZE) && ((flags & ETHARP_FLAG_TRY_HARD) == 0))) {
-		LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: no empty entry found and not allowed to recycle\n"));
-		return (s8_t)ERR_MEM;
+	if ((flags & ETHARP_FLAG_FIND_ONLY) != 0) {
+		LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: no matching entry found\n"));
+		return (s16_t)ERR_MEM;
 	}
 
-	/* b) choose the least destructive entry to recycle:
-	 * 1) empty entry
-	 * 2) oldest stable entry
-	 * 3) oldest pending entry without queued packets
-	 * 4) oldest pending entry with queued packets
-	 *
-	 * { ETHARP_FLAG_TRY_HARD is set at this point }
-	 */
-
-	/* 1) empty entry available? */
-	if (empty < ARP_TABLE_SIZE) {
-		i = empty;
-		LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: selecting empty entry %" U16_F "\n", (u16_t)i));
+	/* a netif at its limit may only recycle its own entries */
+	if (netif != NULL && netif->arp_max_entries != 0 && netif->arp_entries >= netif->arp_max_entries) {
+		limited = netif;
 	} else {
-		/* 2) found recyclable stable entry? */
-		if (old_stable < ARP_TABLE_SIZE) {
-			/* recycle oldest stable */
-			i = old_stable;
-			LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: selecting oldest stable entry %" U16_F "\n", (u16_t)i));
-			/* no queued packets should exist on stable entries */
-			LWIP_ASSERT("arp_table[i].q == NULL", arp_table[i].q == NULL);
-			/* 3) found recyclable pending entry without queued packets? */
-		} else if (old_pending < ARP_TABLE_SIZE) {
-			/* recycle oldest pending */
-			i = old_pending;
-			LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: selecting oldest pending entry %" U16_F " (without queue)\n", (u16_t)i));
-			/* 4) found recyclable pending entry with queued packets? */
-		} else if (old_queue < ARP_TABLE_SIZE) {
-			/* recycle oldest pending (queued packets are free in etharp_free_entry) */
-			i = old_queue;
-			LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: selecting oldest pending entry %" U16_F ", freeing packet queue %p\n", (u16_t)i, (void *)(arp_table[i].q)));
-			/* no empty or recyclable entries found */
-		} else {
+		i = etharp_alloc_entry();
+	}
+
+	if (i < 0) {
+		/* not allowed to recycle? */
+		if ((flags & ETHARP_FLAG_TRY_HARD) == 0) {
+			LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: no empty entry found and not allowed to recycle\n"));
+			return (s16_t)ERR_MEM;
+		}
+		i = etharp_lru_victim(limited);
+		if (i < 0) {
 			LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: no empty or recyclable entries found\n"));
-			return (s8_t)ERR_MEM;
+			return (s16_t)ERR_MEM;
 		}
-
-		/* { empty or recyclable entry found } */
-		LWIP_ASSERT("i < ARP_TABLE_SIZE", i < ARP_TABLE_SIZE);
+		LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: recycling %s entry %" U16_F "\n", arp_table[i].state >= ETHARP_STATE_STABLE ? "stable" : "pending", (u16_t)i));
+		/* queued packets are freed in etharp_free_entry */
 		etharp_free_entry(i);
+		i = etharp_alloc_entry();
 	}
 
-	LWIP_ASSERT("i < ARP_TABLE_SIZE", i < ARP_TABLE_SIZE);
-	LWIP_ASSERT("arp_table[i].state == ETHARP_STATE_EMPTY", arp_table[i].state == ETHARP_STATE_EMPTY);
+	LWIP_ASSERT("i < ARP_TABLE_SIZE", i >= 0 && i < ARP_TABLE_SIZE);
 
 	/* IP address given? */
 	if (ipaddr != NULL) {
 		/* set IP address */
 		ip_addr_copy(arp_table[i].ipaddr, *ipaddr);
+	} else {
+		ip_addr_set_zero(&arp_table[i].ipaddr);
 	}
 	arp_table[i].ctime = 0;
-	return (err_t)i;
+	arp_table[i].next = arp_hash[ARP_HASH(&arp_table[i].ipaddr)];
+	arp_hash[ARP_HASH(&arp_table[i].ipaddr)] = ARP_LINK(i);
+	etharp_lru_insert(i);
+	etharp_set_netif(i, netif);
+	return i;
 }
 
 /**
@@ -453,7 +561,7 @@ static err_t etharp_send_ip(struct netif *netif, struct pbuf *p, struct eth_addr
  */
 static err_t etharp_update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr *ethaddr, u8_t flags)
 {
-	s8_t i;
+	s16_t i;
 	LWIP_ASSERT("netif->hwaddr_len == ETHARP_HWADDR_LEN", netif->hwaddr_len == ETHARP_HWADDR_LEN);
 	LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_update_arp_entry: %" U16_F ".%" U16_F ".%" U16_F ".%" U16_F " - %02" X16_F ":%02" X16_F ":%02" X16_F ":%02" X16_F ":%02" X16_F ":%02" X16_F "\n", ip4_addr1_16(ipaddr), ip4_addr2_16(ipaddr), ip4_addr3_16(ipaddr), ip4_addr4_16(ipaddr), ethaddr->addr[0], ethaddr->addr[1], ethaddr->addr[2], ethaddr->addr[3], ethaddr->addr[4], ethaddr->addr[5]));
 	/* non-unicast address? */
@@ -462,14 +570,17 @@ static err_t etharp_update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, str
 		return ERR_ARG;
 	}
 	/* find or create ARP entry */
-	i = etharp_find_entry(ipaddr, flags);
+	i = etharp_find_entry(ipaddr, flags, netif);
 	/* bail out if no entry could be found */
 	if (i < 0) {
 		return (err_t)i;
 	}
 #if ETHARP_SUPPORT_STATIC_ENTRIES
 	if (flags & ETHARP_FLAG_STATIC_ENTRY) {
-		/* record static type */
+		/* record static type, static entries never get recycled */
+		if (etharp_is_dynamic(i)) {
+			etharp_lru_remove(i);
+		}
 		arp_table[i].state = ETHARP_STATE_STATIC;
 	} else if (arp_table[i].state == ETHARP_STATE_STATIC) {
 		/* found entry is a static type, don't overwrite it */
@@ -479,10 +590,13 @@ static err_t etharp_update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, str
 	{
 		/* mark it stable */
 		arp_table[i].state = ETHARP_STATE_STABLE;
+		etharp_lru_touch(i);
 	}
 
 	/* record network interface */
-	arp_table[i].netif = netif;
+	if (arp_table[i].netif != netif) {
+		etharp_set_netif(i, netif);
+	}
 	/* insert in SNMP ARP index tree */
 	snmp_insert_arpidx_tree(netif, &arp_table[i].ipaddr);
 
@@ -548,11 +662,11 @@ err_t etharp_add_static_entry(ip_addr_t *ipaddr, struct eth_addr *ethaddr)
  */
 err_t etharp_remove_static_entry(ip_addr_t *ipaddr)
 {
-	s8_t i;
+	s16_t i;
 	LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_remove_static_entry: %" U16_F ".%" U16_F ".%" U16_F ".%" U16_F "\n", ip4_addr1_16(ipaddr), ip4_addr2_16(ipaddr), ip4_addr3_16(ipaddr), ip4_addr4_16(ipaddr)));
 
 	/* find or create ARP entry */
-	i = etharp_find_entry(ipaddr, ETHARP_FLAG_FIND_ONLY);
+	i = etharp_find_entry(ipaddr, ETHARP_FLAG_FIND_ONLY, NULL);
 	/* bail out if no entry could be found */
 	if (i < 0) {
 		return (err_t)i;
@@ -575,9 +689,9 @@ err_t etharp_remove_static_entry(ip_addr_t *ipaddr)
  */
 void etharp_cleanup_netif(struct netif *netif)
 {
-	u8_t i;
+	u16_t i;
 
-	for (i = 0; i < ARP_TABLE_SIZE; ++i) {
+	for (i = 0; i < arp_unused; ++i) {
 		u8_t state = arp_table[i].state;
 		if ((state != ETHARP_STATE_EMPTY) && (arp_table[i].netif == netif)) {
 			etharp_free_entry(i);
@@ -596,15 +710,15 @@ void etharp_cleanup_netif(struct netif *netif)
  * @param ip_ret points to return pointer
  * @return table index if found, -1 otherwise
  */
-s8_t etharp_find_addr(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr **eth_ret, ip_addr_t **ip_ret)
+s16_t etharp_find_addr(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr **eth_ret, ip_addr_t **ip_ret)
 {
-	s8_t i;
+	s16_t i;
 
 	LWIP_ASSERT("eth_ret != NULL && ip_ret != NULL", eth_ret != NULL && ip_ret != NULL);
 
 	LWIP_UNUSED_ARG(netif);
 
-	i = etharp_find_entry(ipaddr, ETHARP_FLAG_FIND_ONLY);
+	i = etharp_find_entry(ipaddr, ETHARP_FLAG_FIND_ONLY, netif);
 	if ((i >= 0) && (arp_table[i].state >= ETHARP_STATE_STABLE)) {
 		*eth_ret = &arp_table[i].ethaddr;
 		*ip_ret = &arp_table[i].ipaddr;
@@ -827,9 +941,12 @@ static void etharp_arp_input(struct netif *netif, struct eth_addr *ethaddr, stru
 /** Just a small helper function that sends a pbuf to an ethernet address
  * in the arp_table specified by the index 'arp_idx'.
  */
-static err_t etharp_output_to_arp_index(struct netif *netif, struct pbuf *q, u8_t arp_idx)
+static err_t etharp_output_to_arp_index(struct netif *netif, struct pbuf *q, u16_t arp_idx)
 {
 	LWIP_ASSERT("arp_table[arp_idx].state >= ETHARP_STATE_STABLE", arp_table[arp_idx].state >= ETHARP_STATE_STABLE);
+	if (etharp_is_dynamic(arp_idx)) {
+		etharp_lru_touch(arp_idx);
+	}
 	/* if arp table entry is about to expire: re-request it,
 	   but only if its state is ETHARP_STATE_STABLE to prevent flooding the
 	   network with ARP requests if this address is used frequently. */
@@ -906,7 +1023,7 @@ err_t etharp_output(struct netif *netif, struct pbuf *q, ip_addr_t *ipaddr)
 		dest = &mcastaddr;
 		/* unicast destination IP address? */
 	} else {
-		s8_t i;
+		s16_t i;
 		/* outside local network? if so, this can neither be a global broadcast nor
 		   a subnet broadcast. */
 		if (!ip_addr_netcmp(ipaddr, &(netif->ip_addr), &(netif->netmask)) && !ip_addr_islinklocal(ipaddr)) {
@@ -933,7 +1050,7 @@ err_t etharp_output(struct netif *netif, struct pbuf *q, ip_addr_t *ipaddr)
 #if LWIP_NETIF_HWADDRHINT
 		if (netif->addr_hint != NULL) {
 			/* per-pcb cached entry was given */
-			u8_t etharp_cached_entry = *(netif->addr_hint);
+			u16_t etharp_cached_entry = *(netif->addr_hint);
 			if (etharp_cached_entry < ARP_TABLE_SIZE) {
 #endif							/* LWIP_NETIF_HWADDRHINT */
 				if ((arp_table[etharp_cached_entry].state >= ETHARP_STATE_STABLE) && (ip_addr_cmp(dst_addr, &arp_table[etharp_cached_entry].ipaddr))) {
@@ -947,13 +1064,12 @@ err_t etharp_output(struct netif *netif, struct pbuf *q, ip_addr_t *ipaddr)
 #endif							/* LWIP_NETIF_HWADDRHINT */
 
 		/* find stable entry: do this here since this is a critical path for
-		   throughput and etharp_find_entry() is kind of slow */
-		for (i = 0; i < ARP_TABLE_SIZE; i++) {
-			if ((arp_table[i].state >= ETHARP_STATE_STABLE) && (ip_addr_cmp(dst_addr, &arp_table[i].ipaddr))) {
-				/* found an existing, stable entry */
-				ETHARP_SET_HINT(netif, i);
-				return etharp_output_to_arp_index(netif, q, i);
-			}
+		   throughput, only the hash bucket of the address is searched */
+		i = etharp_lookup(dst_addr);
+		if ((i >= 0) && (arp_table[i].state >= ETHARP_STATE_STABLE)) {
+			/* found an existing, stable entry */
+			ETHARP_SET_HINT(netif, i);
+			return etharp_output_to_arp_index(netif, q, i);
 		}
 		/* no stable entry found, use the (slower) query function:
 		   queue on destination Ethernet address belonging to ipaddr */
@@ -1004,7 +1120,7 @@ err_t etharp_query(struct netif *netif, ip_addr_t *ipaddr, struct pbuf *q)
 	struct eth_addr *srcaddr = (struct eth_addr *)netif->hwaddr;
 	err_t result = ERR_MEM;
 	int is_new_entry = 0;
-	s8_t i;						/* ARP entry index */
+	s16_t i;					/* ARP entry index */
 
 	/* non-unicast address? */
 	if (ip_addr_isbroadcast(ipaddr, netif) || ip_addr_ismulticast(ipaddr) || ip_addr_isany(ipaddr)) {
@@ -1013,7 +1129,7 @@ err_t etharp_query(struct netif *netif, ip_addr_t *ipaddr, struct pbuf *q)
 	}
 
 	/* find entry in ARP cache, ask to create entry if queueing packet */
-	i = etharp_find_entry(ipaddr, ETHARP_FLAG_TRY_HARD);
+	i = etharp_find_entry(ipaddr, ETHARP_FLAG_TRY_HARD, netif);
 
 	/* could not find or create entry? */
 	if (i < 0) {
@@ -1029,8 +1145,8 @@ err_t etharp_query(struct netif *netif, ip_addr_t *ipaddr, struct pbuf *q)
 	if (arp_table[i].state == ETHARP_STATE_EMPTY) {
 		is_new_entry = 1;
 		arp_table[i].state = ETHARP_STATE_PENDING;
-		/* record network interface for re-sending arp request in etharp_tmr */
-		arp_table[i].netif = netif;
+		/* the network interface for re-sending arp request in etharp_tmr
+		   was recorded by etharp_find_entry */
 	}
 
 	/* { i is either a STABLE or (new or existing) PENDING entry } */
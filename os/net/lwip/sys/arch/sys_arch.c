@@ -590,6 +590,13 @@ void sys_init(void)
 	return;
 }
 
+#if SOCK_LOCK_STATS
+u32_t sys_arch_cycles(void)
+{
+	return up_perf_gettime();
+}
+#endif
+
 /*-----------------------------------------------------------------------------------*/
 
 /* Mutexes*/
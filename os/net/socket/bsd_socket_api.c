@@ -129,6 +129,23 @@ int sendto(int s, const void *data, size_t size, int flags, const struct sockadd
 	return lwip_sendto(s, data, size, flags, to, tolen);
 }
 
+#ifdef CONFIG_NET_SOCKET_ZEROCOPY
+int recv_zc(int s, struct pbuf **p, int flags, struct sockaddr *from, socklen_t *fromlen)
+{
+	return lwip_recv_zc(s, p, flags, from, fromlen);
+}
+
+int recv_zc_release(int s, struct pbuf *p)
+{
+	return lwip_recv_zc_release(s, p);
+}
+
+int send_zc(int s, const void *data, size_t size, int flags, lwip_zc_sent_fn sent, void *arg)
+{
+	return lwip_send_zc(s, data, size, flags, sent, arg);
+}
+#endif
+
 int socket(int domain, int type, int protocol)
 {
 	return lwip_socket(domain, type, protocol);
@@ -118,6 +118,7 @@ void net_initlist(FAR struct socketlist *list)
 	int i = 0;
 	for (; i < CONFIG_NSOCKET_DESCRIPTORS; i++) {
 		list->sl_sockets[i].conn = NULL;
+		(void)sem_init(&list->sl_sockets[i].lock, 0, 1);
 	}
 }
 
@@ -144,6 +145,7 @@ void net_releaselist(FAR struct socketlist *list)
 		if (list->sl_sockets[idx].conn) {
 			lwip_sock_close(&list->sl_sockets[idx]);
 		}
+		(void)sem_destroy(&list->sl_sockets[idx].lock);
 	}
 
 	/* Destroy the semaphore */
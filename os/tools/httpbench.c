@@ -0,0 +1,323 @@
+/****************************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+/****************************************************************************
+ * tools/httpbench.c
+ *
+ * HTTP load generator for the webserver of apps/netutils/webserver, run on
+ * the host against a board (or a simulator) serving the given address.
+ *
+ *   httpbench [-c connections] [-n requests] [-p pipeline] [-k] [-u url] ip port
+ *
+ * Each connection is driven by its own thread and sends n requests, keeping
+ * up to 'pipeline' of them in flight. Without -k every request uses a new
+ * connection, as the server required before it supported keep-alive.
+ * Reports the requests per second and the 50th/99th percentile latency.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MAX_PIPELINE  64
+#define RXBUF_SIZE    4096
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_conn_s {
+	pthread_t tid;
+	int nreq;
+	int done;
+	int errors;
+	double *latency;			/* msec, one per request */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct sockaddr_in g_addr;
+static const char *g_url = "/";
+static int g_pipeline = 1;
+static int g_keepalive;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static double now_msec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int bench_connect(void)
+{
+	int one = 1;
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+	if (fd < 0) {
+		return -1;
+	}
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	if (connect(fd, (struct sockaddr *)&g_addr, sizeof(g_addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int bench_send(int fd, const char *req, int len)
+{
+	int ret;
+
+	while (len > 0) {
+		ret = send(fd, req, len, 0);
+		if (ret <= 0) {
+			return -1;
+		}
+		req += ret;
+		len -= ret;
+	}
+	return 0;
+}
+
+/* Return the length of the first complete response in buf, 0 if incomplete */
+
+static int bench_response_len(const char *buf, int len)
+{
+	const char *end;
+	const char *cl;
+	int hdrlen;
+	int bodylen = 0;
+
+	end = memmem(buf, len, "\r\n\r\n", 4);
+	if (end == NULL) {
+		return 0;
+	}
+	hdrlen = end - buf + 4;
+
+	cl = memmem(buf, hdrlen, "Content-Length:", 15);
+	if (cl != NULL) {
+		bodylen = atoi(cl + 15);
+	}
+	if (len < hdrlen + bodylen) {
+		return 0;
+	}
+	return hdrlen + bodylen;
+}
+
+static void *bench_thread(void *arg)
+{
+	struct bench_conn_s *conn = arg;
+	double sent[MAX_PIPELINE];
+	char req[512];
+	char buf[RXBUF_SIZE + 1];
+	int reqlen;
+	int buflen = 0;
+	int inflight = 0;
+	int issued = 0;
+	int acked = 0;				/* answered or lost */
+	int fd = -1;
+	int rsplen;
+	int ret;
+
+	reqlen = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: bench\r\nConnection: %s\r\n\r\n",
+					  g_url, g_keepalive ? "keep-alive" : "close");
+
+	while (acked < conn->nreq) {
+		if (fd < 0) {
+			fd = bench_connect();
+			if (fd < 0) {
+				conn->errors++;
+				issued++;
+				acked++;
+				continue;
+			}
+			buflen = 0;
+		}
+
+		/* Fill the pipeline */
+		while (issued < conn->nreq && inflight < (g_keepalive ? g_pipeline : 1)) {
+			if (bench_send(fd, req, reqlen) < 0) {
+				break;
+			}
+			sent[(issued++) % MAX_PIPELINE] = now_msec();
+			inflight++;
+		}
+
+		ret = recv(fd, buf + buflen, RXBUF_SIZE - buflen, 0);
+		if (ret <= 0) {
+			/* Requests in flight on a broken connection are lost */
+			conn->errors += inflight;
+			acked += inflight;
+			inflight = 0;
+			close(fd);
+			fd = -1;
+			continue;
+		}
+		buflen += ret;
+
+		while (inflight > 0 && (rsplen = bench_response_len(buf, buflen)) > 0) {
+			conn->latency[conn->done++] = now_msec() - sent[(acked++) % MAX_PIPELINE];
+			inflight--;
+			buflen -= rsplen;
+			memmove(buf, buf + rsplen, buflen);
+		}
+
+		if (!g_keepalive && inflight == 0) {
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	if (fd >= 0) {
+		close(fd);
+	}
+	return NULL;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void show_usage(const char *progname)
+{
+	fprintf(stderr, "USAGE: %s [-c connections] [-n requests] [-p pipeline] [-k] [-u url] <ip> <port>\n", progname);
+	fprintf(stderr, "  -c: concurrent connections (default 4)\n");
+	fprintf(stderr, "  -n: requests per connection (default 1000)\n");
+	fprintf(stderr, "  -p: requests in flight per connection with -k (default 1, max %d)\n", MAX_PIPELINE);
+	fprintf(stderr, "  -k: keep the connections alive between requests\n");
+	fprintf(stderr, "  -u: requested url (default /)\n");
+	exit(EXIT_FAILURE);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+	struct bench_conn_s *conns;
+	double *all;
+	double start;
+	double elapsed;
+	int nconn = 4;
+	int nreq = 1000;
+	int total = 0;
+	int errors = 0;
+	int opt;
+	int i;
+
+	while ((opt = getopt(argc, argv, "c:n:p:ku:h")) != -1) {
+		switch (opt) {
+		case 'c':
+			nconn = atoi(optarg);
+			break;
+		case 'n':
+			nreq = atoi(optarg);
+			break;
+		case 'p':
+			g_pipeline = atoi(optarg);
+			break;
+		case 'k':
+			g_keepalive = 1;
+			break;
+		case 'u':
+			g_url = optarg;
+			break;
+		default:
+			show_usage(argv[0]);
+		}
+	}
+
+	if (argc - optind != 2 || nconn < 1 || nreq < 1 || g_pipeline < 1 || g_pipeline > MAX_PIPELINE) {
+		show_usage(argv[0]);
+	}
+
+	memset(&g_addr, 0, sizeof(g_addr));
+	g_addr.sin_family = AF_INET;
+	g_addr.sin_port = htons(atoi(argv[optind + 1]));
+	if (inet_pton(AF_INET, argv[optind], &g_addr.sin_addr) != 1) {
+		fprintf(stderr, "ERROR: invalid address %s\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+
+	conns = calloc(nconn, sizeof(struct bench_conn_s));
+	all = malloc(sizeof(double) * nconn * nreq);
+	if (conns == NULL || all == NULL) {
+		fprintf(stderr, "ERROR: out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	start = now_msec();
+	for (i = 0; i < nconn; i++) {
+		conns[i].nreq = nreq;
+		conns[i].latency = all + i * nreq;
+		pthread_create(&conns[i].tid, NULL, bench_thread, &conns[i]);
+	}
+
+	for (i = 0; i < nconn; i++) {
+		pthread_join(conns[i].tid, NULL);
+	}
+	elapsed = now_msec() - start;
+
+	/* Pack the latencies of all connections together */
+	for (i = 0; i < nconn; i++) {
+		memmove(all + total, conns[i].latency, sizeof(double) * conns[i].done);
+		total += conns[i].done;
+		errors += conns[i].errors;
+	}
+
+	printf("connections %d, keep-alive %s, pipeline %d\n", nconn, g_keepalive ? "on" : "off", g_keepalive ? g_pipeline : 1);
+	printf("requests %d, errors %d, %.1f sec\n", total, errors, elapsed / 1000.0);
+	if (total > 0) {
+		qsort(all, total, sizeof(double), compare_double);
+		printf("%.1f requests/sec\n", total * 1000.0 / elapsed);
+		printf("latency p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+			   all[total / 2], all[(total * 99) / 100], all[total - 1]);
+	}
+
+	free(all);
+	free(conns);
+	return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}